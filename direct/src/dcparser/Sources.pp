@@ -31,6 +31,7 @@
      dcPacker.h dcPacker.I \
      dcPackerCatalog.h dcPackerCatalog.I \
      dcPackerInterface.h dcPackerInterface.I \
+     dcPackPlan.h dcPackPlan.I \
      dcParameter.h dcClassParameter.h dcArrayParameter.h \
      dcSimpleParameter.h dcSwitchParameter.h \
      dcNumericRange.h dcNumericRange.I \
@@ -50,6 +51,7 @@
      dcPacker.cxx \
      dcPackerCatalog.cxx \
      dcPackerInterface.cxx \
+     dcPackPlan.cxx \
      dcParameter.cxx dcClassParameter.cxx dcArrayParameter.cxx \
      dcSimpleParameter.cxx dcSwitchParameter.cxx \
      dcSwitch.cxx \
@@ -62,3 +64,12 @@
 
   #define IGATESCAN all
 #end lib_target
+
+#begin test_bin_target
+  #define TARGET test_dc_pack_plan
+  #define LOCAL_LIBS $[LOCAL_LIBS] p3dcparser
+
+  #define SOURCES \
+    test_dc_pack_plan.cxx
+
+#end test_bin_target
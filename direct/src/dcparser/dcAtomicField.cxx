@@ -17,6 +17,7 @@
 #include "dcindent.h"
 #include "dcSimpleParameter.h"
 #include "dcPacker.h"
+#include "dcPackPlan.h"
 
 #include <math.h>
 
@@ -283,6 +284,10 @@ add_element(DCParameter *element) {
     _has_default_value = element->has_default_value();
   }
   _default_value_stale = true;
+
+  // Recompile the pack plan to take in the new element.
+  delete _pack_plan;
+  _pack_plan = DCPackPlan::make_plan(this);
 }
 
 ////////////////////////////////////////////////////////////////////
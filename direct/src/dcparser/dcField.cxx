@@ -18,6 +18,7 @@
 #include "dcClass.h"
 #include "hashGenerator.h"
 #include "dcmsgtypes.h"
+#include "dcPackPlan.h"
 
 #ifdef WITHIN_PANDA
 #include "pStatTimer.h"
@@ -41,6 +42,7 @@ DCField() :
   _has_default_value = false;
 
   _bogus_field = false;
+  _pack_plan = NULL;
 
   _has_nested_fields = true;
   _num_nested_fields = 0;
@@ -70,6 +72,7 @@ DCField(const string &name, DCClass *dclass) :
   _default_value_stale = true;
 
   _bogus_field = false;
+  _pack_plan = NULL;
 
   _has_nested_fields = true;
   _num_nested_fields = 0;
@@ -87,6 +90,7 @@ DCField(const string &name, DCClass *dclass) :
 ////////////////////////////////////////////////////////////////////
 DCField::
 ~DCField() {
+  delete _pack_plan;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -258,6 +262,11 @@ pack_args(DCPacker &packer, PyObject *sequence) const {
   nassertr(!packer.had_error(), false);
   nassertr(packer.get_current_field() == this, false);
 
+  if (_pack_plan != (DCPackPlan *)NULL && dc_pack_plans &&
+      packer.pack_plan(_pack_plan, sequence)) {
+    return true;
+  }
+
   packer.pack_object(sequence);
   if (!packer.had_error()) {
     /*
@@ -331,6 +340,13 @@ unpack_args(DCPacker &packer) const {
   nassertr(!packer.had_error(), NULL);
   nassertr(packer.get_current_field() == this, NULL);
 
+  if (_pack_plan != (DCPackPlan *)NULL && dc_pack_plans) {
+    PyObject *object = packer.unpack_plan(_pack_plan);
+    if (object != (PyObject *)NULL) {
+      return object;
+    }
+  }
+
   size_t start_byte = packer.get_num_unpacked_bytes();
   PyObject *object = packer.unpack_object();
 
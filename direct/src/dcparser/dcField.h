@@ -29,6 +29,7 @@ class DCAtomicField;
 class DCMolecularField;
 class DCParameter;
 class DCSwitch;
+class DCPackPlan;
 class DCClass;
 class HashGenerator;
 
@@ -103,6 +104,8 @@ public:
   INLINE void set_class(DCClass *dclass);
   INLINE void set_default_value(const string &default_value);
 
+  INLINE const DCPackPlan *get_pack_plan() const;
+
 #ifdef HAVE_PYTHON
   static string get_pystr(PyObject *value);
 #endif
@@ -116,6 +119,7 @@ protected:
   bool _default_value_stale;
   bool _has_default_value;
   bool _bogus_field;
+  DCPackPlan *_pack_plan;
 
 private:
   string _default_value;
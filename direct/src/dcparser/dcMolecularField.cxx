@@ -16,6 +16,7 @@
 #include "dcAtomicField.h"
 #include "hashGenerator.h"
 #include "dcindent.h"
+#include "dcPackPlan.h"
 
 
 
@@ -122,6 +123,10 @@ add_atomic(DCAtomicField *atomic) {
     _has_default_value = atomic->has_default_value();
   }
   _default_value_stale = true;
+
+  // Recompile the pack plan to take in the new atomic field.
+  delete _pack_plan;
+  _pack_plan = DCPackPlan::make_plan(this);
 }
 
 ////////////////////////////////////////////////////////////////////
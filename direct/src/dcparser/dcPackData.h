@@ -35,6 +35,7 @@ public:
   INLINE void append_junk(size_t size);
   INLINE void rewrite_data(size_t position, const char *buffer, size_t size);
   INLINE char *get_rewrite_pointer(size_t position, size_t size);
+  INLINE void truncate(size_t size);
 
 PUBLISHED:
   INLINE string get_string() const;
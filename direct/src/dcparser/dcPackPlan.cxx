@@ -0,0 +1,561 @@
+// Filename: dcPackPlan.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "dcPackPlan.h"
+#include "dcAtomicField.h"
+#include "dcMolecularField.h"
+#include "dcSimpleParameter.h"
+#include "dcPackData.h"
+
+#include <math.h>
+#include <limits.h>
+
+#ifdef WITHIN_PANDA
+ConfigVariableBool dc_pack_plans
+("dc-pack-plans", true,
+ PRC_DESC("Set this true to pack and unpack atomic fields whose elements "
+          "are all fixed-size numbers with a plan precompiled from the "
+          "dc file, rather than walking the DCPacker through each "
+          "element.  The results are the same either way; this is "
+          "provided so the two paths can be compared."));
+#endif  // WITHIN_PANDA
+
+////////////////////////////////////////////////////////////////////
+//     Function: DCPackPlan::Constructor
+//       Access: Private
+//  Description: Use make_plan() to create a DCPackPlan.
+////////////////////////////////////////////////////////////////////
+DCPackPlan::
+DCPackPlan() :
+  _fixed_byte_size(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: DCPackPlan::make_plan
+//       Access: Public, Static
+//  Description: Compiles a plan for the indicated field, and returns
+//               a newly-allocated DCPackPlan, which the caller must
+//               eventually delete.  Returns NULL if the field has any
+//               element that is not a plain fixed-size number; a
+//               plan is not made for elements with a range, for
+//               strings, arrays or structs.
+////////////////////////////////////////////////////////////////////
+DCPackPlan *DCPackPlan::
+make_plan(const DCAtomicField *field) {
+  int num_elements = field->get_num_elements();
+  if (num_elements == 0 || !field->has_fixed_byte_size() ||
+      field->has_range_limits()) {
+    return NULL;
+  }
+
+  DCPackPlan *plan = new DCPackPlan;
+  plan->_ops.reserve(num_elements);
+
+  for (int i = 0; i < num_elements; ++i) {
+    const DCSimpleParameter *simple =
+      field->get_element(i)->as_simple_parameter();
+    if (simple == (DCSimpleParameter *)NULL) {
+      delete plan;
+      return NULL;
+    }
+
+    switch (simple->get_type()) {
+    case ST_int8:
+    case ST_int16:
+    case ST_int32:
+    case ST_int64:
+    case ST_uint8:
+    case ST_uint16:
+    case ST_uint32:
+    case ST_uint64:
+    case ST_float64:
+      break;
+
+    default:
+      delete plan;
+      return NULL;
+    }
+
+    Op op;
+    op._type = simple->get_type();
+    op._pack_type = simple->get_pack_type();
+    op._divisor = simple->get_divisor();
+    op._modulus = 0.0;
+    op._int_modulus = 0;
+    if (simple->has_modulus()) {
+      // This is the same arithmetic as DCSimpleParameter::set_modulus().
+      // We only take moduli that each of the pack_*() methods will
+      // apply alike.
+      op._modulus = simple->get_modulus() * op._divisor;
+      op._int_modulus = (PN_int64)floor(op._modulus + 0.5);
+      if (op._int_modulus <= 0 || op._int_modulus > INT_MAX) {
+        delete plan;
+        return NULL;
+      }
+    }
+    op._offset = plan->_fixed_byte_size;
+    plan->_ops.push_back(op);
+    plan->_fixed_byte_size += simple->get_fixed_byte_size();
+  }
+
+  nassertr(plan->_fixed_byte_size == field->get_fixed_byte_size(), plan);
+  return plan;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: DCPackPlan::make_plan
+//       Access: Public, Static
+//  Description: Compiles a plan for the indicated molecular field by
+//               joining the plans of its atomic fields, and returns
+//               a newly-allocated DCPackPlan, which the caller must
+//               eventually delete.  Returns NULL if any of the
+//               atomic fields has no plan.
+////////////////////////////////////////////////////////////////////
+DCPackPlan *DCPackPlan::
+make_plan(const DCMolecularField *field) {
+  int num_atomics = field->get_num_atomics();
+  if (num_atomics == 0) {
+    return NULL;
+  }
+
+  DCPackPlan *plan = new DCPackPlan;
+  for (int i = 0; i < num_atomics; ++i) {
+    const DCPackPlan *atomic_plan = field->get_atomic(i)->get_pack_plan();
+    if (atomic_plan == (DCPackPlan *)NULL) {
+      delete plan;
+      return NULL;
+    }
+
+    Ops::const_iterator oi;
+    for (oi = atomic_plan->_ops.begin(); oi != atomic_plan->_ops.end(); ++oi) {
+      Op op = (*oi);
+      op._offset += plan->_fixed_byte_size;
+      plan->_ops.push_back(op);
+    }
+    plan->_fixed_byte_size += atomic_plan->_fixed_byte_size;
+  }
+
+  nassertr(plan->_fixed_byte_size == field->get_fixed_byte_size(), plan);
+  return plan;
+}
+
+#ifdef HAVE_PYTHON
+////////////////////////////////////////////////////////////////////
+//     Function: DCPackPlan::pack_args
+//       Access: Public
+//  Description: Packs the values of the indicated tuple or list onto
+//               the end of the pack_data.  Returns true on success,
+//               or false if the arguments could not be packed by the
+//               plan, in which case nothing has been added to the
+//               pack_data, and the caller should pack the arguments
+//               with the DCPacker instead.
+//
+//               Only exact Python ints and floats are accepted, and
+//               only when they are within the limits of their
+//               elements; anything else is left for the DCPacker, so
+//               that the results are always the same as it would
+//               produce.
+////////////////////////////////////////////////////////////////////
+bool DCPackPlan::
+pack_args(DCPackData &pack_data, PyObject *sequence) const {
+  if (!PyTuple_CheckExact(sequence) && !PyList_CheckExact(sequence)) {
+    return false;
+  }
+  if (PySequence_Fast_GET_SIZE(sequence) != (Py_ssize_t)_ops.size()) {
+    return false;
+  }
+  PyObject **items = PySequence_Fast_ITEMS(sequence);
+
+  size_t start = pack_data.get_length();
+  char *buffer = pack_data.get_write_pointer(_fixed_byte_size);
+
+  Ops::const_iterator oi;
+  for (oi = _ops.begin(); oi != _ops.end(); ++oi, ++items) {
+    const Op &op = (*oi);
+    bool packed;
+    if (PyFloat_CheckExact(*items)) {
+      packed = pack_real(buffer + op._offset, op, PyFloat_AS_DOUBLE(*items));
+    } else {
+      PN_int64 value;
+      packed = get_integer(op, *items, value) &&
+        pack_integer(buffer + op._offset, op._type, value);
+    }
+
+    if (!packed) {
+      pack_data.truncate(start);
+      return false;
+    }
+  }
+
+  return true;
+}
+#endif  // HAVE_PYTHON
+
+#ifdef HAVE_PYTHON
+////////////////////////////////////////////////////////////////////
+//     Function: DCPackPlan::unpack_args
+//       Access: Public
+//  Description: Unpacks the field's values from the data, beginning
+//               at byte p, into a new Python tuple, and advances p
+//               past them.  Returns NULL, leaving p unchanged, if
+//               there are not enough bytes remaining; the caller
+//               should then unpack with the DCPacker, which will
+//               report the error.
+////////////////////////////////////////////////////////////////////
+PyObject *DCPackPlan::
+unpack_args(const char *data, size_t length, size_t &p) const {
+  if (p + _fixed_byte_size > length) {
+    return NULL;
+  }
+  const char *buffer = data + p;
+
+  PyObject *tuple = PyTuple_New(_ops.size());
+  if (tuple == (PyObject *)NULL) {
+    return NULL;
+  }
+
+  Py_ssize_t i = 0;
+  Ops::const_iterator oi;
+  for (oi = _ops.begin(); oi != _ops.end(); ++oi, ++i) {
+    PyObject *item = unpack_op(*oi, buffer + (*oi)._offset);
+    if (item == (PyObject *)NULL) {
+      Py_DECREF(tuple);
+      return NULL;
+    }
+    PyTuple_SET_ITEM(tuple, i, item);
+  }
+
+  p += _fixed_byte_size;
+  return tuple;
+}
+#endif  // HAVE_PYTHON
+
+////////////////////////////////////////////////////////////////////
+//     Function: DCPackPlan::pack_integer
+//       Access: Private, Static
+//  Description: Packs the integer into the buffer as the indicated
+//               type.  Returns true on success, or false if the value
+//               does not fit.  The value has already been scaled by
+//               the divisor and wrapped to the modulus.
+////////////////////////////////////////////////////////////////////
+bool DCPackPlan::
+pack_integer(char *buffer, DCSubatomicType type, PN_int64 value) {
+  switch (type) {
+  case ST_int8:
+    if (value < -0x80 || value > 0x7f) {
+      return false;
+    }
+    DCPackerInterface::do_pack_int8(buffer, (int)value);
+    return true;
+
+  case ST_int16:
+    if (value < -0x8000 || value > 0x7fff) {
+      return false;
+    }
+    DCPackerInterface::do_pack_int16(buffer, (int)value);
+    return true;
+
+  case ST_int32:
+    if (value < INT_MIN || value > INT_MAX) {
+      return false;
+    }
+    DCPackerInterface::do_pack_int32(buffer, (int)value);
+    return true;
+
+  case ST_int64:
+    DCPackerInterface::do_pack_int64(buffer, value);
+    return true;
+
+  case ST_uint8:
+    if (value < 0 || value > 0xff) {
+      return false;
+    }
+    DCPackerInterface::do_pack_uint8(buffer, (unsigned int)value);
+    return true;
+
+  case ST_uint16:
+    if (value < 0 || value > 0xffff) {
+      return false;
+    }
+    DCPackerInterface::do_pack_uint16(buffer, (unsigned int)value);
+    return true;
+
+  case ST_uint32:
+    if (value < 0 || value > (PN_int64)UINT_MAX) {
+      return false;
+    }
+    DCPackerInterface::do_pack_uint32(buffer, (unsigned int)value);
+    return true;
+
+  case ST_uint64:
+    if (value < 0) {
+      return false;
+    }
+    DCPackerInterface::do_pack_uint64(buffer, (PN_uint64)value);
+    return true;
+
+  case ST_float64:
+    DCPackerInterface::do_pack_float64(buffer, (double)value);
+    return true;
+
+  default:
+    return false;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: DCPackPlan::pack_real
+//       Access: Private, Static
+//  Description: Packs the floating-point value into the buffer for
+//               the indicated op, scaling it by the divisor, wrapping
+//               it to the modulus and rounding it to the nearest
+//               integer for the integer types, as
+//               DCSimpleParameter::pack_double() does.  Returns true
+//               on success, or false if the value does not fit.
+////////////////////////////////////////////////////////////////////
+bool DCPackPlan::
+pack_real(char *buffer, const Op &op, double value) {
+  double real_value = value * op._divisor;
+  if (op._modulus != 0.0) {
+    if (real_value < 0.0) {
+      real_value = op._modulus - fmod(-real_value, op._modulus);
+      if (real_value == op._modulus) {
+        real_value = 0.0;
+      }
+    } else {
+      real_value = fmod(real_value, op._modulus);
+    }
+  }
+
+  if (op._type == ST_float64) {
+    DCPackerInterface::do_pack_float64(buffer, real_value);
+    return true;
+  }
+
+  // The comparisons are written so that a NaN fails them.
+  double int_value = floor(real_value + 0.5);
+  if (op._type == ST_uint64) {
+    if (!(int_value >= 0.0 && int_value < 18446744073709551616.0)) {
+      return false;
+    }
+    DCPackerInterface::do_pack_uint64(buffer, (PN_uint64)int_value);
+    return true;
+  }
+
+  if (!(int_value >= -9223372036854775808.0 &&
+        int_value < 9223372036854775808.0)) {
+    return false;
+  }
+  return pack_integer(buffer, op._type, (PN_int64)int_value);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: DCPackPlan::unpack_integer
+//       Access: Private, Static
+//  Description: Unpacks an integer of the indicated type, other than
+//               uint64, from the buffer.
+////////////////////////////////////////////////////////////////////
+PN_int64 DCPackPlan::
+unpack_integer(const char *buffer, DCSubatomicType type) {
+  switch (type) {
+  case ST_int8:
+    return DCPackerInterface::do_unpack_int8(buffer);
+
+  case ST_int16:
+    return DCPackerInterface::do_unpack_int16(buffer);
+
+  case ST_int32:
+    return DCPackerInterface::do_unpack_int32(buffer);
+
+  case ST_int64:
+    return DCPackerInterface::do_unpack_int64(buffer);
+
+  case ST_uint8:
+    return DCPackerInterface::do_unpack_uint8(buffer);
+
+  case ST_uint16:
+    return DCPackerInterface::do_unpack_uint16(buffer);
+
+  case ST_uint32:
+    return DCPackerInterface::do_unpack_uint32(buffer);
+
+  default:
+    nassertr(false, 0);
+    return 0;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: DCPackPlan::unpack_real
+//       Access: Private, Static
+//  Description: Unpacks a number of the indicated type from the
+//               buffer, as a double.  The caller must still apply the
+//               divisor.
+////////////////////////////////////////////////////////////////////
+double DCPackPlan::
+unpack_real(const char *buffer, DCSubatomicType type) {
+  switch (type) {
+  case ST_float64:
+    return DCPackerInterface::do_unpack_float64(buffer);
+
+  case ST_uint64:
+    return (double)DCPackerInterface::do_unpack_uint64(buffer);
+
+  default:
+    return (double)unpack_integer(buffer, type);
+  }
+}
+
+#ifdef HAVE_PYTHON
+////////////////////////////////////////////////////////////////////
+//     Function: DCPackPlan::get_integer
+//       Access: Private, Static
+//  Description: Extracts the value of an exact Python int for the
+//               indicated op, scaled by the op's divisor and wrapped
+//               to its modulus.  Returns true on success, or false if
+//               the object is not an int, or if the DCPacker would
+//               not pack this value exactly.
+//
+//               The DCPacker passes an int to the element through
+//               pack_int(), pack_uint(), pack_int64() or
+//               pack_uint64(), according to the element's pack type,
+//               so we only take the values that survive the
+//               conversion to that method's parameter.
+////////////////////////////////////////////////////////////////////
+bool DCPackPlan::
+get_integer(const Op &op, PyObject *object, PN_int64 &value) {
+#if PY_MAJOR_VERSION < 3
+  if (PyInt_CheckExact(object)) {
+    value = PyInt_AS_LONG(object);
+
+    // Python 2 passes an int for a uint64 through pack_int().
+    if (op._pack_type == PT_uint64 && value > INT_MAX) {
+      return false;
+    }
+  } else
+#endif
+  if (PyLong_CheckExact(object)) {
+    int overflow;
+    value = PyLong_AsLongLongAndOverflow(object, &overflow);
+    if (overflow != 0) {
+      return false;
+    }
+  } else {
+    return false;
+  }
+
+  switch (op._pack_type) {
+  case PT_int:
+    if (value < INT_MIN || value > INT_MAX) {
+      return false;
+    }
+    break;
+
+  case PT_uint:
+    if (value < 0 || value > (PN_int64)UINT_MAX) {
+      return false;
+    }
+    break;
+
+  case PT_uint64:
+    if (value < 0) {
+      return false;
+    }
+    break;
+
+  case PT_double:
+    // A float64 or fixed-point element is given an int through
+    // pack_int(), which applies the divisor itself.
+    if (value < INT_MIN || value > INT_MAX) {
+      return false;
+    }
+    value *= op._divisor;
+    if (value < INT_MIN || value > INT_MAX) {
+      return false;
+    }
+    break;
+
+  default:
+    break;
+  }
+
+  if (op._int_modulus != 0) {
+    if (value < 0) {
+      value = op._int_modulus - 1 - (-value - 1) % op._int_modulus;
+    } else {
+      value = value % op._int_modulus;
+    }
+  }
+
+  return true;
+}
+#endif  // HAVE_PYTHON
+
+#ifdef HAVE_PYTHON
+////////////////////////////////////////////////////////////////////
+//     Function: DCPackPlan::unpack_op
+//       Access: Private, Static
+//  Description: Unpacks the indicated op's value from the buffer and
+//               returns a new Python object of the same type that
+//               DCPacker::unpack_object() would return.
+////////////////////////////////////////////////////////////////////
+PyObject *DCPackPlan::
+unpack_op(const Op &op, const char *buffer) {
+  switch (op._pack_type) {
+  case PT_int:
+    {
+      int value = (int)unpack_integer(buffer, op._type);
+#if PY_MAJOR_VERSION >= 3
+      return PyLong_FromLong(value);
+#else
+      return PyInt_FromLong(value);
+#endif
+    }
+
+  case PT_uint:
+    {
+      unsigned int value = (unsigned int)unpack_integer(buffer, op._type);
+#if PY_MAJOR_VERSION >= 3
+      return PyLong_FromLong(value);
+#else
+      if (value & 0x80000000) {
+        return PyLong_FromUnsignedLong(value);
+      } else {
+        return PyInt_FromLong(value);
+      }
+#endif
+    }
+
+  case PT_int64:
+    return PyLong_FromLongLong(DCPackerInterface::do_unpack_int64(buffer));
+
+  case PT_uint64:
+    return PyLong_FromUnsignedLongLong(DCPackerInterface::do_unpack_uint64(buffer));
+
+  case PT_double:
+    {
+      double value = unpack_real(buffer, op._type);
+      if (op._divisor != 1) {
+        value = value / op._divisor;
+      }
+      return PyFloat_FromDouble(value);
+    }
+
+  default:
+    nassertr(false, NULL);
+    return NULL;
+  }
+}
+#endif  // HAVE_PYTHON
@@ -0,0 +1,109 @@
+// Filename: dcPackPlan.h
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef DCPACKPLAN_H
+#define DCPACKPLAN_H
+
+#include "dcbase.h"
+#include "dcPackerInterface.h"
+#include "dcSubatomicType.h"
+#include "dcPython.h"
+
+#ifdef WITHIN_PANDA
+#include "configVariableBool.h"
+
+extern ConfigVariableBool dc_pack_plans;
+
+#else  // WITHIN_PANDA
+
+static const bool dc_pack_plans = true;
+
+#endif  // WITHIN_PANDA
+
+class DCAtomicField;
+class DCMolecularField;
+class DCPackData;
+
+////////////////////////////////////////////////////////////////////
+//       Class : DCPackPlan
+// Description : A precompiled layout for an atomic field whose
+//               elements are all fixed-size numbers, which covers
+//               most of the position and state updates sent every
+//               frame, or for a molecular field made up of such
+//               atomic fields.  The field is flattened into a linear
+//               list of ops, each with its byte offset within the
+//               field, so that a Python tuple can be packed into (or
+//               unpacked from) the field in a single pass, without
+//               walking the DCPacker through push(), pop() and a
+//               virtual call for each element.
+//
+//               The plan only handles the common case.  If it meets a
+//               value that it cannot convert exactly as the DCPacker
+//               would, it declines, having packed nothing, and the
+//               caller falls back to the DCPacker; so any error is
+//               still reported in the usual way.
+////////////////////////////////////////////////////////////////////
+class EXPCL_DIRECT DCPackPlan {
+private:
+  DCPackPlan();
+
+public:
+  static DCPackPlan *make_plan(const DCAtomicField *field);
+  static DCPackPlan *make_plan(const DCMolecularField *field);
+
+  INLINE int get_num_ops() const;
+  INLINE DCSubatomicType get_op_type(int n) const;
+  INLINE unsigned int get_op_divisor(int n) const;
+  INLINE bool has_op_modulus(int n) const;
+  INLINE size_t get_op_offset(int n) const;
+  INLINE size_t get_fixed_byte_size() const;
+
+#ifdef HAVE_PYTHON
+  bool pack_args(DCPackData &pack_data, PyObject *sequence) const;
+  PyObject *unpack_args(const char *data, size_t length, size_t &p) const;
+#endif
+
+private:
+  class Op {
+  public:
+    DCSubatomicType _type;
+    DCPackType _pack_type;
+    unsigned int _divisor;
+
+    // The modulus, scaled by the divisor, or 0 if there is none; and
+    // the same, rounded to an integer.
+    double _modulus;
+    PN_int64 _int_modulus;
+
+    size_t _offset;
+  };
+
+  static bool pack_integer(char *buffer, DCSubatomicType type, PN_int64 value);
+  static bool pack_real(char *buffer, const Op &op, double value);
+  static PN_int64 unpack_integer(const char *buffer, DCSubatomicType type);
+  static double unpack_real(const char *buffer, DCSubatomicType type);
+
+#ifdef HAVE_PYTHON
+  static bool get_integer(const Op &op, PyObject *object, PN_int64 &value);
+  static PyObject *unpack_op(const Op &op, const char *buffer);
+#endif
+
+  typedef pvector<Op> Ops;
+  Ops _ops;
+  size_t _fixed_byte_size;
+};
+
+#include "dcPackPlan.I"
+
+#endif
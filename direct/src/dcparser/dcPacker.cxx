@@ -19,6 +19,7 @@
 #include "dcClassParameter.h"
 #include "dcSwitchParameter.h"
 #include "dcClass.h"
+#include "dcPackPlan.h"
 
 #ifdef HAVE_PYTHON
 #include "py_panda.h"
@@ -1010,6 +1011,58 @@ unpack_object() {
 }
 #endif  // HAVE_PYTHON
 
+#ifdef HAVE_PYTHON
+////////////////////////////////////////////////////////////////////
+//     Function: DCPacker::pack_plan
+//       Access: Public
+//  Description: Packs the tuple or list of arguments for the current
+//               field all at once, using the precompiled plan for the
+//               field, and advances past the field.  Returns true on
+//               success, or false if the plan could not pack these
+//               arguments; in this case nothing has been packed, and
+//               the caller should use pack_object() instead.
+////////////////////////////////////////////////////////////////////
+bool DCPacker::
+pack_plan(const DCPackPlan *plan, PyObject *sequence) {
+  nassertr(_mode == M_pack || _mode == M_repack, false);
+  if (_mode != M_pack || _current_field == NULL) {
+    return false;
+  }
+
+  if (!plan->pack_args(_pack_data, sequence)) {
+    return false;
+  }
+  advance();
+  return true;
+}
+#endif  // HAVE_PYTHON
+
+#ifdef HAVE_PYTHON
+////////////////////////////////////////////////////////////////////
+//     Function: DCPacker::unpack_plan
+//       Access: Public
+//  Description: Unpacks the current field all at once into a Python
+//               tuple, using the precompiled plan for the field, and
+//               advances past the field.  Returns NULL if the plan
+//               could not unpack the field; in this case nothing has
+//               been unpacked, and the caller should use
+//               unpack_object() instead.
+////////////////////////////////////////////////////////////////////
+PyObject *DCPacker::
+unpack_plan(const DCPackPlan *plan) {
+  nassertr(_mode == M_unpack, NULL);
+  if (_current_field == NULL) {
+    return NULL;
+  }
+
+  PyObject *object = plan->unpack_args(_unpack_data, _unpack_length, _unpack_p);
+  if (object != (PyObject *)NULL) {
+    advance();
+  }
+  return object;
+}
+#endif  // HAVE_PYTHON
+
 
 ////////////////////////////////////////////////////////////////////
 //     Function: DCPacker::parse_and_pack
@@ -24,6 +24,7 @@
 
 class DCClass;
 class DCSwitchParameter;
+class DCPackPlan;
 
 ////////////////////////////////////////////////////////////////////
 //       Class : DCPacker
@@ -110,6 +111,13 @@ PUBLISHED:
   PyObject *unpack_object();
 #endif
 
+public:
+#ifdef HAVE_PYTHON
+  bool pack_plan(const DCPackPlan *plan, PyObject *sequence);
+  PyObject *unpack_plan(const DCPackPlan *plan);
+#endif
+
+PUBLISHED:
   bool parse_and_pack(const string &formatted_object);
   bool parse_and_pack(istream &in);
   string unpack_and_format(bool show_field_names = true);
@@ -0,0 +1,247 @@
+// Filename: test_dc_pack_plan.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "dcbase.h"
+#include "dcFile.h"
+#include "dcClass.h"
+#include "dcField.h"
+#include "dcPacker.h"
+#include "dcPackPlan.h"
+#include "executionEnvironment.h"
+#include "trueClock.h"
+
+// This program reads a dc file (by default, direct.dc from the direct
+// source tree) and, for every field that has a precompiled pack plan,
+// formats an update message from a tuple of sample values and
+// unpacks it again, many times over.  It does this once through the
+// DCPacker alone, with dc-pack-plans disabled, and once with the
+// plans, and reports the time taken for each.  It checks that both
+// produce the same messages and the same unpacked values, and that a
+// plan still lets the DCPacker report bad arguments.
+
+#ifdef HAVE_PYTHON
+
+static const int num_iterations = 10000;
+static const DOID_TYPE do_id = 1234;
+
+typedef pvector<const DCField *> Fields;
+typedef pvector<PyObject *> Objects;
+typedef pvector<Datagram> Datagrams;
+
+// Makes a tuple of sample values for the field: an int for each
+// integer element, and a float for each fixed-point or float64
+// element.  Some of the floats are negative, to exercise the moduli.
+static PyObject *
+make_args(const DCPackPlan *plan, int seed) {
+  PyObject *args = PyTuple_New(plan->get_num_ops());
+  for (int i = 0; i < plan->get_num_ops(); ++i) {
+    PyObject *item;
+    if (plan->get_op_type(i) == ST_float64 || plan->get_op_divisor(i) != 1) {
+      item = PyFloat_FromDouble(((seed * 7 + i * 3) % 40) * 2.5 - 50.0);
+    } else {
+      item = PyLong_FromLong((seed + i) % 100);
+    }
+    PyTuple_SET_ITEM(args, i, item);
+  }
+  return args;
+}
+
+// Unpacks the arguments from an update message, the way
+// DCClass::receive_update() does.  Returns NULL if the message could
+// not be unpacked.
+static PyObject *
+unpack_update(const DCField *field, const Datagram &datagram) {
+  if (datagram.get_length() == 0) {
+    return NULL;
+  }
+
+  DCPacker packer;
+  packer.set_unpack_data((const char *)datagram.get_data(),
+                         datagram.get_length(), false);
+  packer.raw_unpack_uint16();
+  packer.raw_unpack_uint32();
+  packer.raw_unpack_uint16();
+
+  packer.begin_unpack(field);
+  PyObject *args = field->unpack_args(packer);
+  if (!packer.end_unpack()) {
+    Py_XDECREF(args);
+    PyErr_Clear();
+    return NULL;
+  }
+  return args;
+}
+
+// Formats and unpacks an update for each field num_iterations times,
+// and keeps the last message and unpacked arguments for each.
+// Returns the number of milliseconds taken to format the messages,
+// and fills in the time taken to unpack them.
+static double
+run_benchmark(const Fields &fields, const Objects &args, bool use_plans,
+              Datagrams &updates, Objects &results, double &unpack_ms) {
+  dc_pack_plans = use_plans;
+  TrueClock *true_clock = TrueClock::get_global_ptr();
+  size_t num_fields = fields.size();
+
+  updates.assign(num_fields, Datagram());
+  double start = true_clock->get_short_time();
+  for (int i = 0; i < num_iterations; ++i) {
+    for (size_t fi = 0; fi < num_fields; ++fi) {
+      updates[fi] = fields[fi]->client_format_update(do_id, args[fi]);
+    }
+  }
+  double pack_ms = (true_clock->get_short_time() - start) * 1000.0;
+  PyErr_Clear();
+
+  results.assign(num_fields, (PyObject *)NULL);
+  start = true_clock->get_short_time();
+  for (int i = 0; i < num_iterations; ++i) {
+    for (size_t fi = 0; fi < num_fields; ++fi) {
+      Py_XDECREF(results[fi]);
+      results[fi] = unpack_update(fields[fi], updates[fi]);
+    }
+  }
+  unpack_ms = (true_clock->get_short_time() - start) * 1000.0;
+
+  return pack_ms;
+}
+
+// Returns true if the DCPacker still rejects a tuple of strings for
+// the field, with a TypeError, when the field has a plan.
+static bool
+check_bad_args(const DCField *field, const DCPackPlan *plan) {
+  dc_pack_plans = true;
+  PyObject *args = PyTuple_New(plan->get_num_ops());
+  for (int i = 0; i < plan->get_num_ops(); ++i) {
+#if PY_MAJOR_VERSION >= 3
+    PyTuple_SET_ITEM(args, i, PyUnicode_FromString("bad"));
+#else
+    PyTuple_SET_ITEM(args, i, PyString_FromString("bad"));
+#endif
+  }
+
+  Datagram update = field->client_format_update(do_id, args);
+  bool rejected = (update.get_length() == 0 &&
+                   PyErr_Occurred() != (PyObject *)NULL &&
+                   PyErr_ExceptionMatches(PyExc_TypeError));
+  PyErr_Clear();
+  Py_DECREF(args);
+  return rejected;
+}
+
+int
+main(int argc, char *argv[]) {
+  Filename filename = (argc > 1) ? Filename::from_os_specific(argv[1]) :
+    Filename(ExecutionEnvironment::expand_string("$DIRECT/src/distributed/direct.dc"));
+
+  Py_Initialize();
+
+  DCFile dc_file;
+  if (!dc_file.read(filename)) {
+    nout << "Unable to read " << filename << ".\n";
+    return 1;
+  }
+
+  // Collect the fields that have a plan, and make some arguments for
+  // each.
+  Fields fields;
+  Objects args;
+  int num_fields = 0;
+  for (int ci = 0; ci < dc_file.get_num_classes(); ++ci) {
+    DCClass *dclass = dc_file.get_class(ci);
+    for (int fi = 0; fi < dclass->get_num_fields(); ++fi) {
+      const DCField *field = dclass->get_field(fi);
+      if (field->as_parameter() != (DCParameter *)NULL) {
+        continue;
+      }
+      ++num_fields;
+      const DCPackPlan *plan = field->get_pack_plan();
+      if (plan != (DCPackPlan *)NULL) {
+        fields.push_back(field);
+        args.push_back(make_args(plan, (int)fields.size()));
+      }
+    }
+  }
+
+  nout << filename.get_basename() << ": " << fields.size() << " of "
+       << num_fields << " fields have a pack plan, "
+       << num_iterations << " iterations:\n";
+  if (fields.empty()) {
+    return 1;
+  }
+
+  Datagrams generic_updates, plan_updates;
+  Objects generic_results, plan_results;
+  double generic_unpack_ms, plan_unpack_ms;
+  double generic_pack_ms =
+    run_benchmark(fields, args, false, generic_updates, generic_results,
+                  generic_unpack_ms);
+  double plan_pack_ms =
+    run_benchmark(fields, args, true, plan_updates, plan_results,
+                  plan_unpack_ms);
+
+  nout << "  packer: " << generic_pack_ms << " ms to pack, "
+       << generic_unpack_ms << " ms to unpack\n"
+       << "  plans:  " << plan_pack_ms << " ms to pack, "
+       << plan_unpack_ms << " ms to unpack\n";
+
+  bool ok = true;
+  int num_unpacked = 0;
+  for (size_t fi = 0; fi < fields.size(); ++fi) {
+    bool same = (plan_updates[fi] == generic_updates[fi]);
+    if (generic_results[fi] == (PyObject *)NULL ||
+        plan_results[fi] == (PyObject *)NULL) {
+      same = same && (generic_results[fi] == plan_results[fi]);
+    } else {
+      ++num_unpacked;
+      same = same &&
+        (PyObject_RichCompareBool(generic_results[fi], plan_results[fi], Py_EQ) == 1);
+    }
+
+    if (!same) {
+      nout << "  " << fields[fi]->get_class()->get_name() << "."
+           << fields[fi]->get_name() << " differs!\n";
+      ok = false;
+    }
+    Py_XDECREF(generic_results[fi]);
+    Py_XDECREF(plan_results[fi]);
+  }
+
+  if (num_unpacked != (int)fields.size()) {
+    nout << "  " << fields.size() - num_unpacked
+         << " fields could not be packed with the sample values.\n";
+  }
+
+  if (!check_bad_args(fields[0], fields[0]->get_pack_plan())) {
+    nout << "  Bad arguments to " << fields[0]->get_name()
+         << " were not rejected!\n";
+    ok = false;
+  }
+
+  for (size_t fi = 0; fi < args.size(); ++fi) {
+    Py_DECREF(args[fi]);
+  }
+
+  return ok ? 0 : 1;
+}
+
+#else  // HAVE_PYTHON
+
+int
+main(int argc, char *argv[]) {
+  nout << "This program requires Python.\n";
+  return 0;
+}
+
+#endif  // HAVE_PYTHON
@@ -513,19 +513,29 @@ send_message_bundle(unsigned int channel, unsigned int sender_channel) {
 
   // if _bundling_msgs ref count is zero, send the bundle out
   if (_bundling_msgs == 0 && get_want_message_bundling()) {
-    Datagram dg;
+    // The bundle is sent as one datagram, but we build it in pieces,
+    // so that each bundled message goes out straight from its own
+    // buffer.  Each message is preceded by its length, as if it had
+    // been added with add_string().
+    pvector<Datagram> pieces;
+    pieces.reserve(_bundle_msgs.size() * 2 + 1);
+    pieces.push_back(Datagram());
+    Datagram &header = pieces.back();
     // add server header (see PyDatagram.addServerHeader)
-    dg.add_int8(1);
-    dg.add_uint64(channel);
-    dg.add_uint64(sender_channel);
-    dg.add_uint16(STATESERVER_BOUNCE_MESSAGE);
+    header.add_int8(1);
+    header.add_uint64(channel);
+    header.add_uint64(sender_channel);
+    header.add_uint16(STATESERVER_BOUNCE_MESSAGE);
     // add each bundled message
     BundledMsgVector::const_iterator bmi;
     for (bmi = _bundle_msgs.begin(); bmi != _bundle_msgs.end(); bmi++) {
-      dg.add_string(*bmi);
+      nassertv((*bmi).get_length() <= (PN_uint16)0xffff);
+      pieces.back().add_uint16((PN_uint16)(*bmi).get_length());
+      pieces.push_back(*bmi);
+      pieces.push_back(Datagram());
     }
 
-    send_datagram(dg);
+    send_datagram_pieces(pieces);
   }
 }
 
@@ -554,7 +564,8 @@ bundle_msg(const Datagram &dg) {
   ReMutexHolder holder(_lock);
 
   nassertv(is_bundling_messages());
-  _bundle_msgs.push_back(dg.get_message());
+  // This shares the datagram's buffer, rather than copying it.
+  _bundle_msgs.push_back(dg);
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -925,6 +936,38 @@ handle_update_field_owner() {
   return true;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: CConnectionRepository::send_datagram_pieces
+//       Access: Private
+//  Description: Sends a single datagram, made up of the indicated
+//               pieces one after another.  Over a normal network
+//               connection, the pieces are handed to the
+//               ConnectionWriter to be written without being copied
+//               together; otherwise, they are appended into one
+//               datagram and passed to send_datagram().
+////////////////////////////////////////////////////////////////////
+bool CConnectionRepository::
+send_datagram_pieces(const pvector<Datagram> &pieces) {
+  ReMutexHolder holder(_lock);
+
+#ifdef HAVE_NET
+  bool native = false;
+#ifdef WANT_NATIVE_NET
+  native = _native;
+#endif
+  if (_net_conn && !native && !_simulated_disconnect && !get_verbose()) {
+    return _cw.send_gathered(pieces, _net_conn);
+  }
+#endif  // HAVE_NET
+
+  Datagram dg;
+  pvector<Datagram>::const_iterator pi;
+  for (pi = pieces.begin(); pi != pieces.end(); ++pi) {
+    dg.append_data((*pi).get_data(), (*pi).get_length());
+  }
+  return send_datagram(dg);
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: CConnectionRepository::describe_message
 //       Access: Private
@@ -26,6 +26,7 @@
 #include "clockObject.h"
 #include "reMutex.h"
 #include "reMutexHolder.h"
+#include "pvector.h"
 
 #ifdef HAVE_NET
 #include "queuedConnectionManager.h"
@@ -164,6 +165,7 @@ private:
   bool do_check_datagram();
   bool handle_update_field();
   bool handle_update_field_owner();
+  bool send_datagram_pieces(const pvector<Datagram> &pieces);
 
   void describe_message(ostream &out, const string &prefix,
                         const Datagram &dg) const;
@@ -213,7 +215,7 @@ private:
 
   bool _want_message_bundling;
   unsigned int _bundling_msgs;
-  typedef std::vector< string > BundledMsgVector;
+  typedef pvector<Datagram> BundledMsgVector;
   BundledMsgVector _bundle_msgs;
 
   static PStatCollector _update_pcollector;
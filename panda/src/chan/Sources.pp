@@ -16,6 +16,7 @@
     animChannelMatrixDynamic.I animChannelMatrixDynamic.h \
     animChannelMatrixFixed.I animChannelMatrixFixed.h \
     animChannelMatrixXfmTable.I animChannelMatrixXfmTable.h \
+    animChannelMatrixQuantizedTable.I animChannelMatrixQuantizedTable.h \
     animChannelScalarDynamic.I animChannelScalarDynamic.h \
     animChannelScalarTable.I animChannelScalarTable.h \
     animControl.I animControl.N  \
@@ -29,6 +30,7 @@
     movingPartBase.I movingPartBase.h  \
     movingPartMatrix.I movingPartMatrix.h movingPartScalar.I  \
     movingPartScalar.h partBundle.I partBundle.N partBundle.h  \
+    partBundleBatch.I partBundleBatch.h \
     partBundleHandle.I partBundleHandle.h \
     partBundleNode.I partBundleNode.h \
     partGroup.I partGroup.h  \
@@ -43,6 +45,7 @@
     animChannelMatrixDynamic.cxx  \
     animChannelMatrixFixed.cxx  \
     animChannelMatrixXfmTable.cxx  \
+    animChannelMatrixQuantizedTable.cxx \
     animChannelScalarDynamic.cxx \
     animChannelScalarTable.cxx \
     animControl.cxx  \
@@ -52,6 +55,7 @@
     bindAnimRequest.cxx \
     config_chan.cxx movingPartBase.cxx movingPartMatrix.cxx  \
     movingPartScalar.cxx partBundle.cxx \
+    partBundleBatch.cxx \
     partBundleHandle.cxx \
     partBundleNode.cxx \
     partGroup.cxx \
@@ -66,6 +70,7 @@
     animChannelMatrixDynamic.I animChannelMatrixDynamic.h \
     animChannelMatrixFixed.I animChannelMatrixFixed.h \
     animChannelMatrixXfmTable.I animChannelMatrixXfmTable.h \
+    animChannelMatrixQuantizedTable.I animChannelMatrixQuantizedTable.h \
     animChannelScalarDynamic.I animChannelScalarDynamic.h \
     animChannelScalarTable.I animChannelScalarTable.h \
     animControl.I animControl.h \
@@ -78,6 +83,7 @@
     movingPart.I movingPart.h movingPartBase.I \
     movingPartBase.h movingPartMatrix.I movingPartMatrix.h \
     movingPartScalar.I movingPartScalar.h partBundle.I partBundle.h \
+    partBundleBatch.I partBundleBatch.h \
     partBundleHandle.I partBundleHandle.h \
     partBundleNode.I partBundleNode.h \
     partGroup.I partGroup.h \
@@ -88,3 +94,24 @@
 
 #end lib_target
 
+#begin test_bin_target
+  #define TARGET test_anim_crowd
+  #define LOCAL_LIBS \
+    p3chan
+  #define OTHER_LIBS $[OTHER_LIBS] p3pystub
+
+  #define SOURCES \
+    test_anim_crowd.cxx
+
+#end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_anim_quantize
+  #define LOCAL_LIBS \
+    p3chan
+  #define OTHER_LIBS $[OTHER_LIBS] p3pystub
+
+  #define SOURCES \
+    test_anim_quantize.cxx
+
+#end test_bin_target
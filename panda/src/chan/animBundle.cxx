@@ -56,6 +56,30 @@ copy_bundle() const {
   return DCAST(AnimBundle, group.p());
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: AnimBundle::copy_bundle_quantized
+//       Access: Published
+//  Description: Returns a full copy of the bundle and its entire tree
+//               of nested AnimGroups, like copy_bundle(), except
+//               that each AnimChannelMatrixXfmTable is replaced with
+//               an AnimChannelMatrixQuantizedTable, which holds the
+//               same animation in much less memory.
+//
+//               No component of any joint will differ from the
+//               original by more than tolerance, apart from the
+//               error of quantizing each key to 16 bits; rotations
+//               are measured in degrees.  A tolerance of 0 still
+//               drops constant and default-valued tables, and
+//               replaces straight-line runs of frames with a pair of
+//               keys.  A channel with more than 65535 frames is
+//               copied unquantized, with a warning.
+////////////////////////////////////////////////////////////////////
+PT(AnimBundle) AnimBundle::
+copy_bundle_quantized(PN_stdfloat tolerance) const {
+  PT(AnimGroup) group = copy_subtree_quantized((AnimGroup *)NULL, tolerance);
+  return DCAST(AnimBundle, group.p());
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: AnimBundle::output
 //       Access: Public, Virtual
@@ -36,6 +36,7 @@ PUBLISHED:
   INLINE AnimBundle(const string &name, PN_stdfloat fps, int num_frames);
 
   PT(AnimBundle) copy_bundle() const;
+  PT(AnimBundle) copy_bundle_quantized(PN_stdfloat tolerance) const;
 
   INLINE double get_base_frame_rate() const;
   INLINE int get_num_frames() const;
@@ -0,0 +1,567 @@
+// Filename: animChannelMatrixQuantizedTable.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "animChannelMatrixQuantizedTable.h"
+#include "animBundle.h"
+#include "config_chan.h"
+
+#include "compose_matrix.h"
+#include "indent.h"
+#include "datagram.h"
+#include "datagramIterator.h"
+#include "bamReader.h"
+#include "bamWriter.h"
+
+TypeHandle AnimChannelMatrixQuantizedTable::_type_handle;
+
+////////////////////////////////////////////////////////////////////
+//     Function: lerp_key
+//  Description: Returns the value at frame f, which is between the
+//               keys (f0, v0) and (f1, v1).  The same arithmetic is
+//               used to choose the keys and to decode them, so that
+//               the tolerance is honored exactly.
+////////////////////////////////////////////////////////////////////
+static INLINE PN_stdfloat
+lerp_key(int f0, PN_stdfloat v0, int f1, PN_stdfloat v1, int f) {
+  return v0 + (v1 - v0) * (PN_stdfloat)(f - f0) / (PN_stdfloat)(f1 - f0);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AnimChannelMatrixQuantizedTable::Constructor
+//       Access: Protected
+//  Description: Used only for bam loader.
+////////////////////////////////////////////////////////////////////
+AnimChannelMatrixQuantizedTable::
+AnimChannelMatrixQuantizedTable() :
+  _tolerance(0.0f)
+{
+  for (int i = 0; i < num_matrix_components; ++i) {
+    _components[i]._base = 0.0f;
+    _components[i]._scale = 0.0f;
+    _components[i]._first_key = 0;
+    _components[i]._num_keys = 0;
+    _components[i]._num_frames = 0;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AnimChannelMatrixQuantizedTable::Copy Constructor
+//       Access: Protected
+//  Description: Creates a new AnimChannelMatrixQuantizedTable, just
+//               like this one, without copying any children.  The
+//               new copy is added to the indicated parent.  Intended
+//               to be called by make_copy() only.
+////////////////////////////////////////////////////////////////////
+AnimChannelMatrixQuantizedTable::
+AnimChannelMatrixQuantizedTable(AnimGroup *parent, const AnimChannelMatrixQuantizedTable &copy) :
+  AnimChannelMatrix(parent, copy),
+  _keys(copy._keys),
+  _tolerance(copy._tolerance)
+{
+  for (int i = 0; i < num_matrix_components; ++i) {
+    _components[i] = copy._components[i];
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AnimChannelMatrixQuantizedTable::Constructor
+//       Access: Published
+//  Description: Creates a new channel that compresses the tables of
+//               the indicated AnimChannelMatrixXfmTable, and adds it
+//               to the indicated parent.  No decoded value of any
+//               component will differ from the original table by
+//               more than tolerance, apart from the small error of
+//               quantizing each key to 16 bits.  Rotations are
+//               measured in degrees.
+//
+//               This does not copy the source channel's children.
+////////////////////////////////////////////////////////////////////
+AnimChannelMatrixQuantizedTable::
+AnimChannelMatrixQuantizedTable(AnimGroup *parent,
+                                const AnimChannelMatrixXfmTable &source,
+                                PN_stdfloat tolerance) :
+  AnimChannelMatrix(parent, source),
+  _tolerance(max(tolerance, (PN_stdfloat)0.0f))
+{
+  for (int i = 0; i < num_matrix_components; ++i) {
+    quantize_table(i, source.get_table(matrix_component_letters[i]));
+  }
+
+  // Release the memory left over from growing the table.
+  Keys(_keys).swap(_keys);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AnimChannelMatrixQuantizedTable::Destructor
+//       Access: Published, Virtual
+//  Description:
+////////////////////////////////////////////////////////////////////
+AnimChannelMatrixQuantizedTable::
+~AnimChannelMatrixQuantizedTable() {
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AnimChannelMatrixQuantizedTable::has_changed
+//       Access: Public, Virtual
+//  Description: Returns true if the value has changed since the last
+//               call to has_changed().  last_frame is the frame
+//               number of the last call; this_frame is the current
+//               frame number.
+////////////////////////////////////////////////////////////////////
+bool AnimChannelMatrixQuantizedTable::
+has_changed(int last_frame, double last_frac,
+            int this_frame, double this_frac) {
+  if (last_frame != this_frame) {
+    for (int i = 0; i < num_matrix_components; ++i) {
+      if (_components[i]._num_keys > 1) {
+        if (interpolate(i, last_frame) != interpolate(i, this_frame)) {
+          return true;
+        }
+      }
+    }
+  }
+
+  if (last_frac != this_frac) {
+    // If we have some fractional changes, also check the next
+    // subsequent frame (since we'll be blending with that).
+    for (int i = 0; i < num_matrix_components; ++i) {
+      if (_components[i]._num_keys > 1) {
+        if (interpolate(i, last_frame) != interpolate(i, this_frame + 1)) {
+          return true;
+        }
+      }
+    }
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AnimChannelMatrixQuantizedTable::get_value
+//       Access: Public, Virtual
+//  Description: Gets the value of the channel at the indicated frame.
+////////////////////////////////////////////////////////////////////
+void AnimChannelMatrixQuantizedTable::
+get_value(int frame, LMatrix4 &mat) {
+  PN_stdfloat components[num_matrix_components];
+  for (int i = 0; i < num_matrix_components; ++i) {
+    components[i] = get_component(i, frame);
+  }
+
+  compose_matrix(mat, components);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AnimChannelMatrixQuantizedTable::get_value_no_scale_shear
+//       Access: Public, Virtual
+//  Description: Gets the value of the channel at the indicated frame,
+//               without any scale or shear information.
+////////////////////////////////////////////////////////////////////
+void AnimChannelMatrixQuantizedTable::
+get_value_no_scale_shear(int frame, LMatrix4 &mat) {
+  PN_stdfloat components[num_matrix_components];
+  components[0] = 1.0f;
+  components[1] = 1.0f;
+  components[2] = 1.0f;
+  components[3] = 0.0f;
+  components[4] = 0.0f;
+  components[5] = 0.0f;
+
+  for (int i = 6; i < num_matrix_components; ++i) {
+    components[i] = get_component(i, frame);
+  }
+
+  compose_matrix(mat, components);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AnimChannelMatrixQuantizedTable::get_scale
+//       Access: Public, Virtual
+//  Description: Gets the scale value at the indicated frame.
+////////////////////////////////////////////////////////////////////
+void AnimChannelMatrixQuantizedTable::
+get_scale(int frame, LVecBase3 &scale) {
+  for (int i = 0; i < 3; ++i) {
+    scale[i] = get_component(i, frame);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AnimChannelMatrixQuantizedTable::get_hpr
+//       Access: Public, Virtual
+//  Description: Returns the h, p, and r components associated
+//               with the current frame.
+////////////////////////////////////////////////////////////////////
+void AnimChannelMatrixQuantizedTable::
+get_hpr(int frame, LVecBase3 &hpr) {
+  for (int i = 0; i < 3; ++i) {
+    hpr[i] = get_component(i + 6, frame);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AnimChannelMatrixQuantizedTable::get_quat
+//       Access: Public, Virtual
+//  Description: Returns the rotation component associated with the
+//               current frame, expressed as a quaternion.
+////////////////////////////////////////////////////////////////////
+void AnimChannelMatrixQuantizedTable::
+get_quat(int frame, LQuaternion &quat) {
+  LVecBase3 hpr;
+  get_hpr(frame, hpr);
+  quat.set_hpr(hpr);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AnimChannelMatrixQuantizedTable::get_pos
+//       Access: Public, Virtual
+//  Description: Returns the x, y, and z translation components
+//               associated with the current frame.
+////////////////////////////////////////////////////////////////////
+void AnimChannelMatrixQuantizedTable::
+get_pos(int frame, LVecBase3 &pos) {
+  for (int i = 0; i < 3; ++i) {
+    pos[i] = get_component(i + 9, frame);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AnimChannelMatrixQuantizedTable::get_shear
+//       Access: Public, Virtual
+//  Description: Returns the a, b, and c shear components associated
+//               with the current frame.
+////////////////////////////////////////////////////////////////////
+void AnimChannelMatrixQuantizedTable::
+get_shear(int frame, LVecBase3 &shear) {
+  for (int i = 0; i < 3; ++i) {
+    shear[i] = get_component(i + 3, frame);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AnimChannelMatrixQuantizedTable::get_num_keys
+//       Access: Published
+//  Description: Returns the number of keys stored for the indicated
+//               table: 0 if the component always has its default
+//               value, 1 if it is constant, or the number of
+//               keyframes otherwise.  table_id is one of the letters
+//               accepted by AnimChannelMatrixXfmTable::set_table().
+////////////////////////////////////////////////////////////////////
+int AnimChannelMatrixQuantizedTable::
+get_num_keys(char table_id) const {
+  for (int i = 0; i < num_matrix_components; ++i) {
+    if (table_id == matrix_component_letters[i]) {
+      return _components[i]._num_keys;
+    }
+  }
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AnimChannelMatrixQuantizedTable::get_data_size
+//       Access: Published
+//  Description: Returns the number of bytes of memory used by the
+//               channel's tables, including the per-component
+//               headers.
+////////////////////////////////////////////////////////////////////
+size_t AnimChannelMatrixQuantizedTable::
+get_data_size() const {
+  return sizeof(_components) + _keys.capacity() * sizeof(PN_uint16);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AnimChannelMatrixQuantizedTable::write
+//       Access: Public, Virtual
+//  Description: Writes a brief description of the table and all of
+//               its descendants.
+////////////////////////////////////////////////////////////////////
+void AnimChannelMatrixQuantizedTable::
+write(ostream &out, int indent_level) const {
+  indent(out, indent_level)
+    << get_type() << " " << get_name() << " ";
+
+  // Write a list of all the sub-tables that have data, with the
+  // number of keys in each.
+  bool found_any = false;
+  for (int i = 0; i < num_matrix_components; ++i) {
+    if (_components[i]._num_keys != 0) {
+      out << matrix_component_letters[i] << _components[i]._num_keys;
+      found_any = true;
+    }
+  }
+
+  if (!found_any) {
+    out << "(no data)";
+  }
+
+  if (!_children.empty()) {
+    out << " {\n";
+    write_descendants(out, indent_level + 2);
+    indent(out, indent_level) << "}";
+  }
+
+  out << "\n";
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AnimChannelMatrixQuantizedTable::make_copy
+//       Access: Protected, Virtual
+//  Description: Returns a copy of this object, and attaches it to the
+//               indicated parent (which may be NULL only if this is
+//               an AnimBundle).  Intended to be called by
+//               copy_subtree() only.
+////////////////////////////////////////////////////////////////////
+AnimGroup *AnimChannelMatrixQuantizedTable::
+make_copy(AnimGroup *parent) const {
+  return new AnimChannelMatrixQuantizedTable(parent, *this);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AnimChannelMatrixQuantizedTable::quantize_table
+//       Access: Private
+//  Description: Compresses the indicated table into the ith
+//               component, appending its keys to _keys.
+////////////////////////////////////////////////////////////////////
+void AnimChannelMatrixQuantizedTable::
+quantize_table(int i, const CPTA_stdfloat &table) {
+  Component &comp = _components[i];
+  comp._base = 0.0f;
+  comp._scale = 0.0f;
+  comp._first_key = _keys.size();
+  comp._num_keys = 0;
+  comp._num_frames = 0;
+
+  int num_frames = table.size();
+  if (num_frames == 0) {
+    return;
+  }
+  nassertv(num_frames <= 0xffff);
+
+  PN_stdfloat min_value = table[0];
+  PN_stdfloat max_value = table[0];
+  int f;
+  for (f = 1; f < num_frames; ++f) {
+    min_value = min(min_value, table[f]);
+    max_value = max(max_value, table[f]);
+  }
+
+  PN_stdfloat default_value = (PN_stdfloat)matrix_component_defaults[i];
+  if (min_value >= default_value - _tolerance &&
+      max_value <= default_value + _tolerance) {
+    // The component never strays from its default value.
+    return;
+  }
+
+  comp._num_frames = num_frames;
+  if (max_value - min_value <= _tolerance * 2.0f) {
+    // The component is constant, near enough.
+    comp._base = (min_value == max_value) ? min_value : (min_value + max_value) * 0.5f;
+    comp._num_keys = 1;
+    _keys.push_back(0);
+    return;
+  }
+
+  // Quantize every frame to 16 bits within the component's range.
+  comp._base = min_value;
+  comp._scale = (max_value - min_value) / 65535.0f;
+  pvector<PN_uint16> quantized(num_frames);
+  for (f = 0; f < num_frames; ++f) {
+    PN_stdfloat q = cfloor((table[f] - min_value) / comp._scale + 0.5f);
+    quantized[f] = (PN_uint16)max((PN_stdfloat)0.0f, min(q, (PN_stdfloat)65535.0f));
+  }
+
+  // Now choose keyframes greedily: extend each segment as far as it
+  // will go while every frame it spans still decodes to within the
+  // tolerance of the original value.
+  pvector<int> key_frames;
+  key_frames.push_back(0);
+  int key = 0;
+  while (key < num_frames - 1) {
+    PN_stdfloat v0 = comp._base + comp._scale * quantized[key];
+    int next = key + 1;
+    for (int candidate = key + 2; candidate < num_frames; ++candidate) {
+      PN_stdfloat v1 = comp._base + comp._scale * quantized[candidate];
+      bool ok = true;
+      for (f = key + 1; f < candidate && ok; ++f) {
+        PN_stdfloat value = lerp_key(key, v0, candidate, v1, f);
+        ok = (cabs(value - table[f]) <= _tolerance);
+      }
+      if (!ok) {
+        break;
+      }
+      next = candidate;
+    }
+    key_frames.push_back(next);
+    key = next;
+  }
+
+  if (key_frames.size() * 2 >= (size_t)num_frames) {
+    // Storing the frame number of each key would cost more than
+    // storing every frame.
+    comp._num_keys = num_frames;
+    _keys.insert(_keys.end(), quantized.begin(), quantized.end());
+
+  } else {
+    comp._num_keys = key_frames.size();
+    pvector<int>::const_iterator ki;
+    for (ki = key_frames.begin(); ki != key_frames.end(); ++ki) {
+      _keys.push_back((PN_uint16)(*ki));
+      _keys.push_back(quantized[*ki]);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AnimChannelMatrixQuantizedTable::interpolate
+//       Access: Private
+//  Description: Decodes the value of the ith component, which must
+//               have at least two keys, at the indicated frame.
+////////////////////////////////////////////////////////////////////
+PN_stdfloat AnimChannelMatrixQuantizedTable::
+interpolate(int i, int frame) const {
+  const Component &comp = _components[i];
+  nassertr(comp._num_keys > 1, comp._base);
+  const PN_uint16 *keys = &_keys[comp._first_key];
+
+  // The table repeats after its last frame, like the tables of an
+  // AnimChannelMatrixXfmTable.
+  frame = frame % comp._num_frames;
+  if (comp._num_keys == comp._num_frames) {
+    // There is a key on every frame.
+    return comp._base + comp._scale * keys[frame];
+  }
+
+  int last = comp._num_keys - 1;
+  if (frame >= keys[last * 2]) {
+    return comp._base + comp._scale * keys[last * 2 + 1];
+  }
+
+  // Binary search for the pair of keys on either side of the frame.
+  int lo = 0;
+  int hi = last;
+  while (hi - lo > 1) {
+    int mid = (lo + hi) / 2;
+    if (keys[mid * 2] <= frame) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+
+  int f0 = keys[lo * 2];
+  PN_stdfloat v0 = comp._base + comp._scale * keys[lo * 2 + 1];
+  if (frame == f0) {
+    return v0;
+  }
+  int f1 = keys[hi * 2];
+  PN_stdfloat v1 = comp._base + comp._scale * keys[hi * 2 + 1];
+  return lerp_key(f0, v0, f1, v1, frame);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AnimChannelMatrixQuantizedTable::write_datagram
+//       Access: Public
+//  Description: Function to write the important information in
+//               the particular object to a Datagram
+////////////////////////////////////////////////////////////////////
+void AnimChannelMatrixQuantizedTable::
+write_datagram(BamWriter *manager, Datagram &me) {
+  AnimChannelMatrix::write_datagram(manager, me);
+
+  me.add_stdfloat(_tolerance);
+  for (int i = 0; i < num_matrix_components; ++i) {
+    const Component &comp = _components[i];
+    me.add_uint16(comp._num_keys);
+    if (comp._num_keys == 0) {
+      continue;
+    }
+    me.add_uint16(comp._num_frames);
+    me.add_stdfloat(comp._base);
+    if (comp._num_keys > 1) {
+      me.add_stdfloat(comp._scale);
+      size_t num_values = get_num_values(comp);
+      const PN_uint16 *keys = &_keys[comp._first_key];
+      for (size_t k = 0; k < num_values; ++k) {
+        me.add_uint16(keys[k]);
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AnimChannelMatrixQuantizedTable::fillin
+//       Access: Protected
+//  Description: Function that reads out of the datagram (or asks
+//               manager to read) all of the data that is needed to
+//               re-create this object and stores it in the appropiate
+//               place
+////////////////////////////////////////////////////////////////////
+void AnimChannelMatrixQuantizedTable::
+fillin(DatagramIterator &scan, BamReader *manager) {
+  AnimChannelMatrix::fillin(scan, manager);
+
+  _tolerance = scan.get_stdfloat();
+  _keys.clear();
+  for (int i = 0; i < num_matrix_components; ++i) {
+    Component &comp = _components[i];
+    comp._base = 0.0f;
+    comp._scale = 0.0f;
+    comp._first_key = _keys.size();
+    comp._num_keys = scan.get_uint16();
+    comp._num_frames = 0;
+    if (comp._num_keys == 0) {
+      continue;
+    }
+    comp._num_frames = scan.get_uint16();
+    comp._base = scan.get_stdfloat();
+    if (comp._num_keys == 1) {
+      _keys.push_back(0);
+    } else {
+      comp._scale = scan.get_stdfloat();
+      size_t num_values = get_num_values(comp);
+      for (size_t k = 0; k < num_values; ++k) {
+        _keys.push_back(scan.get_uint16());
+      }
+    }
+  }
+  Keys(_keys).swap(_keys);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AnimChannelMatrixQuantizedTable::make_AnimChannelMatrixQuantizedTable
+//       Access: Protected
+//  Description: Factory method to generate an
+//               AnimChannelMatrixQuantizedTable object.
+////////////////////////////////////////////////////////////////////
+TypedWritable *AnimChannelMatrixQuantizedTable::
+make_AnimChannelMatrixQuantizedTable(const FactoryParams &params) {
+  AnimChannelMatrixQuantizedTable *me = new AnimChannelMatrixQuantizedTable;
+  DatagramIterator scan;
+  BamReader *manager;
+
+  parse_params(params, scan, manager);
+  me->fillin(scan, manager);
+  return me;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AnimChannelMatrixQuantizedTable::register_with_read_factory
+//       Access: Public, Static
+//  Description: Factory method to generate an
+//               AnimChannelMatrixQuantizedTable object.
+////////////////////////////////////////////////////////////////////
+void AnimChannelMatrixQuantizedTable::
+register_with_read_factory() {
+  BamReader::get_factory()->register_factory(get_class_type(), make_AnimChannelMatrixQuantizedTable);
+}
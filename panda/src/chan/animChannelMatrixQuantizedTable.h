@@ -0,0 +1,144 @@
+// Filename: animChannelMatrixQuantizedTable.h
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef ANIMCHANNELMATRIXQUANTIZEDTABLE_H
+#define ANIMCHANNELMATRIXQUANTIZEDTABLE_H
+
+#include "pandabase.h"
+
+#include "animChannel.h"
+#include "animChannelMatrixXfmTable.h"
+#include "pvector.h"
+#include "compose_matrix.h"
+
+////////////////////////////////////////////////////////////////////
+//       Class : AnimChannelMatrixQuantizedTable
+// Description : An animation channel that issues a matrix each frame,
+//               like AnimChannelMatrixXfmTable, but which keeps its
+//               tables compressed in memory.
+//
+//               Each of the twelve components is stored either not
+//               at all, if it never departs from its default value;
+//               as a single value, if it is constant; or as a list of
+//               keyframes, between which the value is linearly
+//               interpolated.  The keyframes are chosen so that the
+//               interpolated value is never more than a given
+//               tolerance from the original table, and each keyframe
+//               value is quantized to 16 bits within the range of
+//               that component.  A component that needs a keyframe
+//               on most frames simply stores the quantized value of
+//               every frame instead.  The values are decoded on
+//               demand, each time get_value() is called.
+//
+//               These are normally created from an existing
+//               AnimChannelMatrixXfmTable; see
+//               AnimBundle::copy_bundle_quantized().
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDA_CHAN AnimChannelMatrixQuantizedTable : public AnimChannelMatrix {
+protected:
+  AnimChannelMatrixQuantizedTable();
+  AnimChannelMatrixQuantizedTable(AnimGroup *parent, const AnimChannelMatrixQuantizedTable &copy);
+
+PUBLISHED:
+  AnimChannelMatrixQuantizedTable(AnimGroup *parent,
+                                  const AnimChannelMatrixXfmTable &source,
+                                  PN_stdfloat tolerance);
+  virtual ~AnimChannelMatrixQuantizedTable();
+
+public:
+  virtual bool has_changed(int last_frame, double last_frac,
+                           int this_frame, double this_frac);
+  virtual void get_value(int frame, LMatrix4 &mat);
+
+  virtual void get_value_no_scale_shear(int frame, LMatrix4 &value);
+  virtual void get_scale(int frame, LVecBase3 &scale);
+  virtual void get_hpr(int frame, LVecBase3 &hpr);
+  virtual void get_quat(int frame, LQuaternion &quat);
+  virtual void get_pos(int frame, LVecBase3 &pos);
+  virtual void get_shear(int frame, LVecBase3 &shear);
+
+PUBLISHED:
+  INLINE PN_stdfloat get_tolerance() const;
+  int get_num_keys(char table_id) const;
+  size_t get_data_size() const;
+
+public:
+  virtual void write(ostream &out, int indent_level) const;
+
+protected:
+  virtual AnimGroup *make_copy(AnimGroup *parent) const;
+
+private:
+  void quantize_table(int i, const CPTA_stdfloat &table);
+  INLINE PN_stdfloat get_component(int i, int frame) const;
+  PN_stdfloat interpolate(int i, int frame) const;
+
+  class Component {
+  public:
+    // The value is _base + _scale * q, for each 16-bit quantized
+    // value q.  If there is only one key, its value is _base.
+    PN_stdfloat _base;
+    PN_stdfloat _scale;
+
+    // The index within _keys of this component's first key, the
+    // number of keys, and the number of frames in the original table.
+    // If there are no keys, the component always has its default
+    // value.
+    PN_uint32 _first_key;
+    PN_uint16 _num_keys;
+    PN_uint16 _num_frames;
+  };
+  Component _components[num_matrix_components];
+
+  INLINE static size_t get_num_values(const Component &comp);
+
+  // If a component has a key on every frame, its keys are simply the
+  // quantized value of each frame.  Otherwise, each key is a pair of
+  // uint16's: the frame number, followed by the quantized value; and
+  // the last key is always on the last frame.
+  typedef pvector<PN_uint16> Keys;
+  Keys _keys;
+
+  PN_stdfloat _tolerance;
+
+public:
+  static void register_with_read_factory();
+  virtual void write_datagram(BamWriter* manager, Datagram &me);
+
+  static TypedWritable *make_AnimChannelMatrixQuantizedTable(const FactoryParams &params);
+
+protected:
+  void fillin(DatagramIterator& scan, BamReader* manager);
+
+public:
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    AnimChannelMatrix::init_type();
+    register_type(_type_handle, "AnimChannelMatrixQuantizedTable",
+                  AnimChannelMatrix::get_class_type());
+  }
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "animChannelMatrixQuantizedTable.I"
+
+#endif
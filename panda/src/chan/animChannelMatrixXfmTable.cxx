@@ -14,6 +14,7 @@
 
 
 #include "animChannelMatrixXfmTable.h"
+#include "animChannelMatrixQuantizedTable.h"
 #include "animBundle.h"
 #include "config_chan.h"
 
@@ -283,6 +284,7 @@ set_table(char table_id, const CPTA_stdfloat &table) {
   }
 
   _tables[i] = table;
+  ++_tables_modified;
 }
 
 
@@ -297,6 +299,7 @@ clear_all_tables() {
   for (int i = 0; i < num_matrix_components; i++) {
     _tables[i] = CPTA_stdfloat(get_class_type());
   }
+  ++_tables_modified;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -345,6 +348,34 @@ make_copy(AnimGroup *parent) const {
   return new AnimChannelMatrixXfmTable(parent, *this);
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: AnimChannelMatrixXfmTable::make_quantized_copy
+//       Access: Protected, Virtual
+//  Description: Returns an AnimChannelMatrixQuantizedTable that
+//               compresses this channel's tables to within the
+//               indicated tolerance, and attaches it to the
+//               indicated parent.  Intended to be called by
+//               copy_subtree_quantized() only.
+//
+//               The quantized table numbers its keys with 16 bits, so
+//               a channel with more frames than that is copied
+//               unquantized instead.
+////////////////////////////////////////////////////////////////////
+AnimGroup *AnimChannelMatrixXfmTable::
+make_quantized_copy(AnimGroup *parent, PN_stdfloat tolerance) const {
+  for (int i = 0; i < num_matrix_components; ++i) {
+    if (_tables[i].size() > 0xffff) {
+      chan_cat.warning()
+        << "Not quantizing " << get_name() << ": table "
+        << matrix_component_letters[i] << " has " << _tables[i].size()
+        << " frames, more than 65535.\n";
+      return make_copy(parent);
+    }
+  }
+
+  return new AnimChannelMatrixQuantizedTable(parent, *this, tolerance);
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: AnimChannelMatrixXfmTable::get_table_index
 //       Access: Protected, Static
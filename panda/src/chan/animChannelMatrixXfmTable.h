@@ -22,6 +22,7 @@
 #include "pointerToArray.h"
 #include "pta_stdfloat.h"
 #include "compose_matrix.h"
+#include "updateSeq.h"
 
 ////////////////////////////////////////////////////////////////////
 //       Class : AnimChannelMatrixXfmTable
@@ -67,6 +68,8 @@ public:
 
 protected:
   virtual AnimGroup *make_copy(AnimGroup *parent) const;
+  virtual AnimGroup *make_quantized_copy(AnimGroup *parent,
+                                         PN_stdfloat tolerance) const;
 
   INLINE static char get_table_id(int table_index);
   static int get_table_index(char table_id);
@@ -74,6 +77,11 @@ protected:
 
   CPTA_stdfloat _tables[num_matrix_components];
 
+  // This is incremented whenever any of this channel's tables is
+  // replaced, so that a PartBundleBatch that has recorded them can
+  // tell when it must look them up again.
+  UpdateSeq _tables_modified;
+
 public:
   static void register_with_read_factory();
   virtual void write_datagram(BamWriter* manager, Datagram &me);
@@ -99,6 +107,8 @@ public:
 
 private:
   static TypeHandle _type_handle;
+
+  friend class PartBundleBatch;
 };
 
 #include "animChannelMatrixXfmTable.I"
@@ -280,6 +280,39 @@ copy_subtree(AnimGroup *parent) const {
   return new_group;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: AnimGroup::make_quantized_copy
+//       Access: Protected, Virtual
+//  Description: Returns a copy of this object whose tables, if it
+//               has any, are compressed to within the indicated
+//               tolerance, and attaches it to the indicated parent.
+//               Intended to be called by copy_subtree_quantized()
+//               only.  The default is simply to call make_copy().
+////////////////////////////////////////////////////////////////////
+AnimGroup *AnimGroup::
+make_quantized_copy(AnimGroup *parent, PN_stdfloat tolerance) const {
+  return make_copy(parent);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: AnimGroup::copy_subtree_quantized
+//       Access: Protected
+//  Description: Returns a full copy of the subtree at this node and
+//               below, with each channel that supports it replaced
+//               by a compressed equivalent.
+////////////////////////////////////////////////////////////////////
+PT(AnimGroup) AnimGroup::
+copy_subtree_quantized(AnimGroup *parent, PN_stdfloat tolerance) const {
+  PT(AnimGroup) new_group = make_quantized_copy(parent, tolerance);
+
+  Children::const_iterator ci;
+  for (ci = _children.begin(); ci != _children.end(); ++ci) {
+    (*ci)->copy_subtree_quantized(new_group, tolerance);
+  }
+
+  return new_group;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: AnimGroup::write_datagram
 //       Access: Public
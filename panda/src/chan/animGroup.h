@@ -62,7 +62,11 @@ protected:
   void write_descendants(ostream &out, int indent_level) const;
 
   virtual AnimGroup *make_copy(AnimGroup *parent) const;
+  virtual AnimGroup *make_quantized_copy(AnimGroup *parent,
+                                         PN_stdfloat tolerance) const;
   PT(AnimGroup) copy_subtree(AnimGroup *parent) const;
+  PT(AnimGroup) copy_subtree_quantized(AnimGroup *parent,
+                                       PN_stdfloat tolerance) const;
   
 protected:
   typedef pvector< PT(AnimGroup) > Children;
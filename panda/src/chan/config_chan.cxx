@@ -18,6 +18,7 @@
 #include "animBundleNode.h"
 #include "animChannelBase.h"
 #include "animChannelMatrixXfmTable.h"
+#include "animChannelMatrixQuantizedTable.h"
 #include "animChannelMatrixDynamic.h"
 #include "animChannelMatrixFixed.h"
 #include "animChannelScalarTable.h"
@@ -104,11 +105,23 @@ PRC_DESC("This specifies the priority assign to an asynchronous bind "
          "model loads).  A higher number here makes the animations "
          "load sooner."));
 
+ConfigVariableBool anim_batch_evaluate
+("anim-batch-evaluate", false,
+PRC_DESC("Set this true to compute the animated values of all of a "
+         "character's joints together, in a single pass over tables "
+         "laid out for SIMD arithmetic, before walking the joint "
+         "hierarchy.  The results are the same either way, apart from "
+         "rounding; this only affects performance.  The default, "
+         "false, computes each joint separately as it is visited, "
+         "which may be faster for characters that have few animated "
+         "joints."));
+
 ConfigureFn(config_chan) {
   AnimBundle::init_type();
   AnimBundleNode::init_type();
   AnimChannelBase::init_type();
   AnimChannelMatrixXfmTable::init_type();
+  AnimChannelMatrixQuantizedTable::init_type();
   AnimChannelMatrixDynamic::init_type();
   AnimChannelMatrixFixed::init_type();
   AnimChannelScalarTable::init_type();
@@ -141,6 +154,7 @@ ConfigureFn(config_chan) {
   AnimBundle::register_with_read_factory();
   AnimBundleNode::register_with_read_factory();
   AnimChannelMatrixXfmTable::register_with_read_factory();
+  AnimChannelMatrixQuantizedTable::register_with_read_factory();
   AnimChannelMatrixDynamic::register_with_read_factory();
   AnimChannelMatrixFixed::register_with_read_factory();
   AnimChannelScalarTable::register_with_read_factory();
@@ -97,6 +97,8 @@ protected:
   // via set_forced_channel().  It overrides all of the above if set.
   PT(AnimChannelBase) _forced_channel;
 
+  friend class PartBundleBatch;
+
 public:
   virtual void write_datagram(BamWriter *manager, Datagram &dg);
   virtual int complete_pointers(TypedWritable **plist, BamReader *manager);
@@ -14,6 +14,7 @@
 
 
 #include "movingPartMatrix.h"
+#include "partBundleBatch.h"
 #include "animChannelMatrixDynamic.h"
 #include "animChannelMatrixFixed.h"
 #include "compose_matrix.h"
@@ -74,6 +75,13 @@ get_blend_value(const PartBundle *root) {
     return;
   }
 
+  // If the bundle has already computed this joint's value along with
+  // all of the others, we need only collect it.
+  if (root->_batch != (PartBundleBatch *)NULL &&
+      root->_batch->get_value(this, _value)) {
+    return;
+  }
+
   PartBundle::CDReader cdata(root->_cycler);
 
   if (cdata->_blend.empty()) {
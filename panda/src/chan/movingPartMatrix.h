@@ -47,6 +47,11 @@ public:
 protected:
   INLINE MovingPartMatrix();
 
+private:
+  // This is the index of this joint within its PartBundle's
+  // PartBundleBatch, or -1 if it is not batched.
+  int _batch_index;
+
 public:
   static void register_with_read_factory();
 
@@ -71,6 +76,8 @@ public:
 
 private:
   static TypeHandle _type_handle;
+
+  friend class PartBundleBatch;
 };
 
 #include "movingPartMatrix.I"
@@ -6,6 +6,7 @@
 #include "animChannelMatrixDynamic.cxx"
 #include "animChannelMatrixFixed.cxx"
 #include "animChannelMatrixXfmTable.cxx"
+#include "animChannelMatrixQuantizedTable.cxx"
 #include "animChannelScalarDynamic.cxx"
 #include "animChannelScalarTable.cxx"
 #include "animControl.cxx"
@@ -5,6 +5,7 @@
 #include "movingPartMatrix.cxx"
 #include "movingPartScalar.cxx"
 #include "partBundle.cxx"
+#include "partBundleBatch.cxx"
 #include "partBundleNode.cxx"
 #include "partGroup.cxx"
 #include "partSubset.cxx"
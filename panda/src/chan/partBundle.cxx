@@ -30,6 +30,7 @@
 #include "configVariableEnum.h"
 #include "loaderOptions.h"
 #include "bindAnimRequest.h"
+#include "partBundleBatch.h"
 
 #include <algorithm>
 
@@ -52,7 +53,8 @@ static ConfigVariableEnum<PartBundle::BlendType> anim_blend_type
 ////////////////////////////////////////////////////////////////////
 PartBundle::
 PartBundle(const PartBundle &copy) :
-  PartGroup(copy)
+  PartGroup(copy),
+  _batch(NULL)
 {
   _anim_preload = copy._anim_preload;
   _update_delay = 0.0;
@@ -74,11 +76,25 @@ PartBundle(const PartBundle &copy) :
 ////////////////////////////////////////////////////////////////////
 PartBundle::
 PartBundle(const string &name) : 
-  PartGroup(name)
+  PartGroup(name),
+  _batch(NULL)
 {
   _update_delay = 0.0;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: PartBundle::Destructor
+//       Access: Published, Virtual
+//  Description:
+////////////////////////////////////////////////////////////////////
+PartBundle::
+~PartBundle() {
+  if (_batch != (PartBundleBatch *)NULL) {
+    delete _batch;
+    _batch = NULL;
+  }
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: PartBundle::make_copy
 //       Access: Public, Virtual
@@ -552,8 +568,14 @@ update() {
     bool anim_changed = cdata->_anim_changed;
     bool frame_blend_flag = cdata->_frame_blend_flag;
 
+    if (anim_batch_evaluate) {
+      evaluate_batch(cdata, anim_changed);
+    }
     any_changed = do_update(this, cdata, NULL, false, anim_changed, 
                             current_thread);
+    if (_batch != (PartBundleBatch *)NULL) {
+      _batch->set_active(false);
+    }
     
     // Now update all the controls for next time.
     ChannelBlend::const_iterator cbi;
@@ -580,7 +602,13 @@ bool PartBundle::
 force_update() {
   Thread *current_thread = Thread::get_current_thread();
   CDWriter cdata(_cycler, false, current_thread);
+  if (anim_batch_evaluate) {
+    evaluate_batch(cdata, true);
+  }
   bool any_changed = do_update(this, cdata, NULL, true, true, current_thread);
+  if (_batch != (PartBundleBatch *)NULL) {
+    _batch->set_active(false);
+  }
 
   // Now update all the controls for next time.
   ChannelBlend::const_iterator cbi;
@@ -671,6 +699,10 @@ do_bind_anim(AnimControl *control, AnimBundle *anim,
   CDReader cdata(_cycler);
   determine_effective_channels(cdata);
 
+  if (_batch != (PartBundleBatch *)NULL) {
+    _batch->mark_stale();
+  }
+
   return true;
 }
 
@@ -817,6 +849,32 @@ clear_and_stop_intersecting(AnimControl *control, CData *cdata) {
   }
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: PartBundle::evaluate_batch
+//       Access: Private
+//  Description: Computes the values of all of the joints that can be
+//               evaluated together, in preparation for a call to
+//               do_update(), which will then pick them up in
+//               MovingPartMatrix::get_blend_value().  See
+//               anim-batch-evaluate.
+////////////////////////////////////////////////////////////////////
+void PartBundle::
+evaluate_batch(const CData *cdata, bool anim_changed) {
+  if (_batch == (PartBundleBatch *)NULL) {
+    _batch = new PartBundleBatch;
+  }
+
+  bool full = false;
+  if (anim_changed ||
+      _batch->is_stale(cdata->_blend_type, cdata->_frame_blend_flag)) {
+    _batch->build(this, cdata->_blend, cdata->_blend_type,
+                  cdata->_frame_blend_flag);
+    full = true;
+  }
+  _batch->evaluate(full);
+  _batch->set_active(true);
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: PartBundle::finalize
 //       Access: Public, Virtual
@@ -39,6 +39,7 @@ class PartBundleNode;
 class PartBundleNode;
 class TransformState;
 class AnimPreloadTable;
+class PartBundleBatch;
 
 ////////////////////////////////////////////////////////////////////
 //       Class : PartBundle
@@ -59,6 +60,7 @@ protected:
 
 PUBLISHED:
   PartBundle(const string &name = "");
+  virtual ~PartBundle();
   virtual PartGroup *make_copy() const;
 
   INLINE CPT(AnimPreloadTable) get_anim_preload() const;
@@ -165,6 +167,7 @@ private:
   PN_stdfloat do_get_control_effect(AnimControl *control, const CData *cdata) const;
   void recompute_net_blend(CData *cdata);
   void clear_and_stop_intersecting(AnimControl *control, CData *cdata);
+  void evaluate_batch(const CData *cdata, bool anim_changed);
 
   COWPT(AnimPreloadTable) _anim_preload;
 
@@ -205,6 +208,10 @@ private:
   typedef CycleDataReader<CData> CDReader;
   typedef CycleDataWriter<CData> CDWriter;
 
+  // This evaluates all of the joints together when
+  // anim-batch-evaluate is true.  It is created on first use.
+  PartBundleBatch *_batch;
+
 public:
   static void register_with_read_factory();
   virtual void finalize(BamReader *manager);
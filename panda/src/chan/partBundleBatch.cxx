@@ -0,0 +1,689 @@
+// Filename: partBundleBatch.cxx
+// Created by:  agent (17Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "partBundleBatch.h"
+#include "animControl.h"
+
+// The SSE2 versions of the blending loops are only used when
+// PN_stdfloat is a float.  They perform exactly the same IEEE
+// operations, in the same order, as the scalar versions.
+#if !defined(STDFLOAT_DOUBLE) && (defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64))
+#define PARTBUNDLEBATCH_SSE2
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#endif
+
+////////////////////////////////////////////////////////////////////
+//     Function: accumulate
+//  Description: Adds values[j] * effect to sums[j], for each j in [0,
+//               count) whose mask[j] is nonzero.  count must be a
+//               multiple of 4.
+//
+//               Since the sums never hold -0, adding the +0 of a
+//               masked-off lane leaves them exactly unchanged.
+////////////////////////////////////////////////////////////////////
+static INLINE void
+accumulate(PN_stdfloat *sums, const PN_stdfloat *values,
+           const PN_uint32 *mask, PN_stdfloat effect, int count) {
+#ifdef PARTBUNDLEBATCH_SSE2
+  __m128 e = _mm_set1_ps(effect);
+  for (int j = 0; j < count; j += 4) {
+    __m128 v = _mm_mul_ps(_mm_loadu_ps(values + j), e);
+    v = _mm_and_ps(v, _mm_loadu_ps((const float *)(mask + j)));
+    _mm_storeu_ps(sums + j, _mm_add_ps(_mm_loadu_ps(sums + j), v));
+  }
+#else
+  for (int j = 0; j < count; ++j) {
+    if (mask[j]) {
+      sums[j] += values[j] * effect;
+    }
+  }
+#endif  // PARTBUNDLEBATCH_SSE2
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: accumulate_effect
+//  Description: Adds effect to sums[j], for each j in [0, count)
+//               whose mask[j] is nonzero.  count must be a multiple
+//               of 4.
+////////////////////////////////////////////////////////////////////
+static INLINE void
+accumulate_effect(PN_stdfloat *sums, const PN_uint32 *mask,
+                  PN_stdfloat effect, int count) {
+#ifdef PARTBUNDLEBATCH_SSE2
+  __m128 e = _mm_set1_ps(effect);
+  for (int j = 0; j < count; j += 4) {
+    __m128 v = _mm_and_ps(e, _mm_loadu_ps((const float *)(mask + j)));
+    _mm_storeu_ps(sums + j, _mm_add_ps(_mm_loadu_ps(sums + j), v));
+  }
+#else
+  for (int j = 0; j < count; ++j) {
+    if (mask[j]) {
+      sums[j] += effect;
+    }
+  }
+#endif  // PARTBUNDLEBATCH_SSE2
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: accumulate_matrix
+//  Description: Performs sum += value * effect.
+////////////////////////////////////////////////////////////////////
+static INLINE void
+accumulate_matrix(LMatrix4 &sum, const LMatrix4 &value, PN_stdfloat effect) {
+#ifdef PARTBUNDLEBATCH_SSE2
+  __m128 e = _mm_set1_ps(effect);
+  float *s = &sum(0, 0);
+  const float *v = value.get_data();
+  for (int i = 0; i < 16; i += 4) {
+    __m128 p = _mm_mul_ps(_mm_loadu_ps(v + i), e);
+    _mm_storeu_ps(s + i, _mm_add_ps(_mm_loadu_ps(s + i), p));
+  }
+#else
+  sum += value * effect;
+#endif  // PARTBUNDLEBATCH_SSE2
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: scale_matrix
+//  Description: Performs mat *= scale.
+////////////////////////////////////////////////////////////////////
+static INLINE void
+scale_matrix(LMatrix4 &mat, PN_stdfloat scale) {
+#ifdef PARTBUNDLEBATCH_SSE2
+  __m128 e = _mm_set1_ps(scale);
+  float *m = &mat(0, 0);
+  for (int i = 0; i < 16; i += 4) {
+    _mm_storeu_ps(m + i, _mm_mul_ps(_mm_loadu_ps(m + i), e));
+  }
+#else
+  mat *= scale;
+#endif  // PARTBUNDLEBATCH_SSE2
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PartBundleBatch::Constructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+PartBundleBatch::
+PartBundleBatch() :
+  _num_padded(0),
+  _blend_type(PartBundle::BT_linear),
+  _frame_blend_flag(false),
+  _stale(true),
+  _active(false)
+{
+  for (int k = 0; k < num_matrix_components; ++k) {
+    _defaults[k] = (PN_stdfloat)matrix_component_defaults[k];
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PartBundleBatch::Destructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+PartBundleBatch::
+~PartBundleBatch() {
+  clear();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PartBundleBatch::clear
+//       Access: Public
+//  Description: Forgets all of the joints and controls, so that
+//               get_value() will return false for every joint.
+////////////////////////////////////////////////////////////////////
+void PartBundleBatch::
+clear() {
+  Joints::iterator ji;
+  for (ji = _joints.begin(); ji != _joints.end(); ++ji) {
+    (*ji)->_batch_index = -1;
+  }
+  _joints.clear();
+  _controls.clear();
+  _num_padded = 0;
+
+  _modes.clear();
+  _single_slot.clear();
+  _animated.clear();
+  _ready.clear();
+  _single_joints.clear();
+  _blend_joints.clear();
+  _animated_single_joints.clear();
+  _animated_blend_joints.clear();
+
+  _components.clear();
+  _sums.clear();
+  _net_effect.clear();
+  _matrix_sums.clear();
+  _values.clear();
+
+  _stale = true;
+  _active = false;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PartBundleBatch::build
+//       Access: Public
+//  Description: Examines all of the joints of the bundle to decide
+//               which of them can be evaluated by the batch, given
+//               the indicated blend of AnimControls, and records the
+//               tables they are to be evaluated from.  This must be
+//               called again whenever the blend or the bindings
+//               change.
+////////////////////////////////////////////////////////////////////
+void PartBundleBatch::
+build(PartBundle *bundle, const PartBundle::ChannelBlend &blend,
+      PartBundle::BlendType blend_type, bool frame_blend_flag) {
+  clear();
+  _blend_type = blend_type;
+  _frame_blend_flag = frame_blend_flag;
+  _stale = false;
+
+  if (blend.empty()) {
+    // Nothing is animated; every joint gets its default value.
+    return;
+  }
+
+  r_collect(bundle);
+  int num_joints = (int)_joints.size();
+  _num_padded = (num_joints + 3) & ~3;
+
+  // We use the same order of controls as get_blend_value(), so that
+  // the sums are accumulated in the same order.
+  PartBundle::ChannelBlend::const_iterator cbi;
+  for (cbi = blend.begin(); cbi != blend.end(); ++cbi) {
+    _controls.push_back(ControlSlot());
+    ControlSlot &slot = _controls.back();
+    slot._control = (*cbi).first;
+    slot._effect = (*cbi).second;
+    slot._frame = -1;
+    slot._next_frame = -1;
+    slot._frac = 0.0f;
+    slot._bound.insert(slot._bound.end(), _num_padded, 0);
+    slot._channels.insert(slot._channels.end(), num_joints, NULL);
+    slot._channels_modified.insert(slot._channels_modified.end(), num_joints, UpdateSeq());
+
+    slot._tables.reserve(num_matrix_components * _num_padded);
+    for (int k = 0; k < num_matrix_components; ++k) {
+      TableRef unbound;
+      unbound._data = &_defaults[k];
+      unbound._size = 1;
+      slot._tables.insert(slot._tables.end(), _num_padded, unbound);
+    }
+  }
+
+  _modes.insert(_modes.end(), num_joints, (unsigned char)JM_none);
+  _single_slot.insert(_single_slot.end(), num_joints, -1);
+  _animated.insert(_animated.end(), num_joints, 0);
+  _ready.insert(_ready.end(), num_joints, 0);
+  _values.insert(_values.end(), num_joints, LMatrix4::ident_mat());
+
+  for (int j = 0; j < num_joints; ++j) {
+    classify_joint(j);
+  }
+
+  if (!_blend_joints.empty()) {
+    _components.insert(_components.end(), _controls.size() * 2 * num_matrix_components * _num_padded, 0.0f);
+    _sums.insert(_sums.end(), num_matrix_components * _num_padded, 0.0f);
+    _net_effect.insert(_net_effect.end(), _num_padded, 0.0f);
+    _matrix_sums.insert(_matrix_sums.end(), num_joints, LMatrix4::zeros_mat());
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PartBundleBatch::evaluate
+//       Access: Public
+//  Description: Computes the values of all of the batched joints for
+//               the current frame of each control.  If full is
+//               false, only the joints whose values can have changed
+//               since the last call are recomputed, and if none of
+//               the controls have changed frame, nothing is done at
+//               all.  full must be true on the first call after
+//               build().
+////////////////////////////////////////////////////////////////////
+void PartBundleBatch::
+evaluate(bool full) {
+  if (_single_joints.empty() && _blend_joints.empty()) {
+    // None of the joints could be batched.
+    return;
+  }
+
+  bool any_changed = full;
+  ControlSlots::iterator csi;
+  for (csi = _controls.begin(); csi != _controls.end(); ++csi) {
+    ControlSlot &slot = (*csi);
+    int frame = slot._control->get_frame();
+    int next_frame = slot._control->get_next_frame();
+    PN_stdfloat frac = (PN_stdfloat)slot._control->get_frac();
+    if (frame != slot._frame || next_frame != slot._next_frame ||
+        (_frame_blend_flag && frac != slot._frac)) {
+      any_changed = true;
+    }
+    slot._frame = frame;
+    slot._next_frame = next_frame;
+    slot._frac = frac;
+  }
+
+  if (!any_changed) {
+    // The values computed last time are still good.
+    return;
+  }
+
+  if (full) {
+    eval_single(_single_joints);
+    eval_blend(_blend_joints);
+  } else {
+    eval_single(_animated_single_joints);
+    eval_blend(_animated_blend_joints);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PartBundleBatch::any_tables_modified
+//       Access: Private
+//  Description: Returns true if any of the channels whose tables were
+//               recorded by build() has had a table replaced since.
+////////////////////////////////////////////////////////////////////
+bool PartBundleBatch::
+any_tables_modified() const {
+  ControlSlots::const_iterator csi;
+  for (csi = _controls.begin(); csi != _controls.end(); ++csi) {
+    const ControlSlot &slot = (*csi);
+    size_t num_channels = slot._channels.size();
+    for (size_t j = 0; j < num_channels; ++j) {
+      const AnimChannelMatrixXfmTable *channel = slot._channels[j];
+      if (channel != (AnimChannelMatrixXfmTable *)NULL &&
+          channel->_tables_modified != slot._channels_modified[j]) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PartBundleBatch::r_collect
+//       Access: Private
+//  Description: Walks the hierarchy in the same order as do_update(),
+//               recording every MovingPartMatrix.
+////////////////////////////////////////////////////////////////////
+void PartBundleBatch::
+r_collect(PartGroup *part) {
+  if (part->is_of_type(MovingPartMatrix::get_class_type())) {
+    MovingPartMatrix *joint = DCAST(MovingPartMatrix, part);
+    joint->_batch_index = (int)_joints.size();
+    _joints.push_back(joint);
+  }
+
+  int num_children = part->get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    r_collect(part->get_child(i));
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PartBundleBatch::classify_joint
+//       Access: Private
+//  Description: Decides how the jth joint will be evaluated, by
+//               following the same decisions get_blend_value() makes,
+//               and records its tables.
+////////////////////////////////////////////////////////////////////
+void PartBundleBatch::
+classify_joint(int j) {
+  MovingPartMatrix *joint = _joints[j];
+  if (joint->_forced_channel != (AnimChannelBase *)NULL) {
+    return;
+  }
+
+  TypeHandle xfm_type = AnimChannelMatrixXfmTable::get_class_type();
+  int num_controls = (int)_controls.size();
+
+  if (joint->_effective_control != (AnimControl *)NULL && !_frame_blend_flag) {
+    // The normal case: a single channel.
+    AnimChannelBase *channel = joint->_effective_channel;
+    if (channel == (AnimChannelBase *)NULL || channel->get_type() != xfm_type) {
+      return;
+    }
+    for (int ci = 0; ci < num_controls; ++ci) {
+      if (_controls[ci]._control == joint->_effective_control) {
+        set_channel(ci, j, DCAST(AnimChannelMatrixXfmTable, channel));
+        _modes[j] = JM_single;
+        _single_slot[j] = ci;
+        _single_joints.push_back(j);
+        if (_animated[j]) {
+          _animated_single_joints.push_back(j);
+        }
+        return;
+      }
+    }
+    return;
+  }
+
+  if (_blend_type == PartBundle::BT_componentwise_quat) {
+    return;
+  }
+
+  // A blend.  First make sure that every bound channel is one we know
+  // how to evaluate.
+  bool any_bound = false;
+  for (int ci = 0; ci < num_controls; ++ci) {
+    int channel_index = _controls[ci]._control->get_channel_index();
+    if (channel_index < 0 || channel_index >= (int)joint->_channels.size()) {
+      if (_blend_type == PartBundle::BT_linear) {
+        // get_blend_value() treats this as an error.
+        return;
+      }
+      continue;
+    }
+    AnimChannelBase *channel = joint->_channels[channel_index];
+    if (channel != (AnimChannelBase *)NULL) {
+      if (channel->get_type() != xfm_type) {
+        return;
+      }
+      any_bound = true;
+    }
+  }
+  if (!any_bound) {
+    // No channels at all; leave get_blend_value() to supply the
+    // default value.
+    return;
+  }
+
+  for (int ci = 0; ci < num_controls; ++ci) {
+    int channel_index = _controls[ci]._control->get_channel_index();
+    if (channel_index >= 0 && channel_index < (int)joint->_channels.size()) {
+      AnimChannelBase *channel = joint->_channels[channel_index];
+      if (channel != (AnimChannelBase *)NULL) {
+        set_channel(ci, j, DCAST(AnimChannelMatrixXfmTable, channel));
+      }
+    }
+  }
+  _modes[j] = JM_blend;
+  _blend_joints.push_back(j);
+  if (_animated[j]) {
+    _animated_blend_joints.push_back(j);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PartBundleBatch::set_channel
+//       Access: Private
+//  Description: Records that the jth joint is animated by the
+//               indicated channel in control slot ci.
+////////////////////////////////////////////////////////////////////
+void PartBundleBatch::
+set_channel(int ci, int j, AnimChannelMatrixXfmTable *channel) {
+  ControlSlot &slot = _controls[ci];
+  slot._bound[j] = 0xffffffff;
+  slot._channels[j] = channel;
+  slot._channels_modified[j] = channel->_tables_modified;
+
+  for (int k = 0; k < num_matrix_components; ++k) {
+    const CPTA_stdfloat &table = channel->_tables[k];
+    if (!table.empty()) {
+      TableRef &ref = slot._tables[k * _num_padded + j];
+      ref._table = table;
+      ref._data = table.p();
+      ref._size = (int)table.size();
+      if (ref._size > 1) {
+        _animated[j] = 1;
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PartBundleBatch::gather
+//       Access: Private
+//  Description: Looks up the table values of the indicated joints for
+//               the indicated frame of the control in slot ci, and
+//               stores them in the components arrays for fi.
+////////////////////////////////////////////////////////////////////
+void PartBundleBatch::
+gather(int ci, int fi, int frame, const vector_int &joints) {
+  const ControlSlot &slot = _controls[ci];
+  vector_int::const_iterator ji;
+  for (int k = 0; k < num_matrix_components; ++k) {
+    PN_stdfloat *dest = get_components(ci, fi, k);
+    const TableRef *refs = &slot._tables[k * _num_padded];
+    for (ji = joints.begin(); ji != joints.end(); ++ji) {
+      const TableRef &ref = refs[*ji];
+      dest[*ji] = ref._data[frame % ref._size];
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PartBundleBatch::eval_single
+//       Access: Private
+//  Description: Computes the values of the indicated joints, each of
+//               which is animated by a single channel, without frame
+//               blending.  This is the equivalent of
+//               AnimChannelMatrixXfmTable::get_value().
+////////////////////////////////////////////////////////////////////
+void PartBundleBatch::
+eval_single(const vector_int &joints) {
+  PN_stdfloat components[num_matrix_components];
+
+  vector_int::const_iterator ji;
+  for (ji = joints.begin(); ji != joints.end(); ++ji) {
+    int j = (*ji);
+    const ControlSlot &slot = _controls[_single_slot[j]];
+    int frame = slot._frame;
+    for (int k = 0; k < num_matrix_components; ++k) {
+      const TableRef &ref = slot._tables[k * _num_padded + j];
+      components[k] = ref._data[frame % ref._size];
+    }
+    compose_matrix(_values[j], components);
+    _ready[j] = 1;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PartBundleBatch::eval_blend
+//       Access: Private
+//  Description: Computes the values of the indicated joints, each of
+//               which is a blend of several channels, or of two
+//               frames of one channel, according to the blend type.
+////////////////////////////////////////////////////////////////////
+void PartBundleBatch::
+eval_blend(const vector_int &joints) {
+  if (joints.empty()) {
+    return;
+  }
+
+  int num_controls = (int)_controls.size();
+  for (int ci = 0; ci < num_controls; ++ci) {
+    const ControlSlot &slot = _controls[ci];
+    gather(ci, 0, slot._frame, joints);
+    if (_frame_blend_flag) {
+      gather(ci, 1, slot._next_frame, joints);
+    }
+  }
+
+  memset(&_net_effect[0], 0, _num_padded * sizeof(PN_stdfloat));
+  for (int ci = 0; ci < num_controls; ++ci) {
+    const ControlSlot &slot = _controls[ci];
+    accumulate_effect(&_net_effect[0], &slot._bound[0], slot._effect, _num_padded);
+  }
+
+  vector_int::const_iterator ji;
+
+  switch (_blend_type) {
+  case PartBundle::BT_linear:
+    sum_matrices(joints, false);
+    for (ji = joints.begin(); ji != joints.end(); ++ji) {
+      int j = (*ji);
+      PN_stdfloat net_effect = _net_effect[j];
+      _ready[j] = (net_effect != 0.0f);
+      if (net_effect != 0.0f) {
+        // This is LMatrix4::operator / ().
+        _values[j] = _matrix_sums[j];
+        scale_matrix(_values[j], 1.0f / net_effect);
+      }
+    }
+    break;
+
+  case PartBundle::BT_normalized_linear:
+    sum_matrices(joints, true);
+    sum_components(0, 6);
+    for (ji = joints.begin(); ji != joints.end(); ++ji) {
+      int j = (*ji);
+      PN_stdfloat net_effect = _net_effect[j];
+      _ready[j] = (net_effect != 0.0f);
+      if (net_effect != 0.0f) {
+        PN_stdfloat recip = 1.0f / net_effect;
+        LMatrix4 net_value = _matrix_sums[j];
+        scale_matrix(net_value, recip);
+        LVecBase3 scale(get_sums(0)[j], get_sums(1)[j], get_sums(2)[j]);
+        LVecBase3 shear(get_sums(3)[j], get_sums(4)[j], get_sums(5)[j]);
+        scale *= recip;
+        shear *= recip;
+
+        LVector3 false_scale, false_shear, hpr, translate;
+        decompose_matrix(net_value, false_scale, false_shear, hpr, translate);
+        compose_matrix(_values[j], scale, shear, hpr, translate);
+      }
+    }
+    break;
+
+  case PartBundle::BT_componentwise:
+    sum_components(0, num_matrix_components);
+    for (ji = joints.begin(); ji != joints.end(); ++ji) {
+      int j = (*ji);
+      PN_stdfloat net_effect = _net_effect[j];
+      _ready[j] = (net_effect != 0.0f);
+      if (net_effect != 0.0f) {
+        PN_stdfloat recip = 1.0f / net_effect;
+        LVecBase3 scale(get_sums(0)[j], get_sums(1)[j], get_sums(2)[j]);
+        LVecBase3 shear(get_sums(3)[j], get_sums(4)[j], get_sums(5)[j]);
+        LVecBase3 hpr(get_sums(6)[j], get_sums(7)[j], get_sums(8)[j]);
+        LVecBase3 pos(get_sums(9)[j], get_sums(10)[j], get_sums(11)[j]);
+        scale *= recip;
+        hpr *= recip;
+        pos *= recip;
+        shear *= recip;
+        compose_matrix(_values[j], scale, shear, hpr, pos);
+      }
+    }
+    break;
+
+  default:
+    // classify_joint() doesn't batch any other kind of blend.
+    nassertv(false);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PartBundleBatch::sum_matrices
+//       Access: Private
+//  Description: Composes the matrix of each of the indicated joints
+//               for each control (and frame), and accumulates their
+//               weighted sum in _matrix_sums.  If no_scale_shear is
+//               true, the matrices are composed without their scale
+//               and shear, as by get_value_no_scale_shear().
+////////////////////////////////////////////////////////////////////
+void PartBundleBatch::
+sum_matrices(const vector_int &joints, bool no_scale_shear) {
+  PN_stdfloat components[num_matrix_components];
+  int first_k = 0;
+  if (no_scale_shear) {
+    components[0] = 1.0f;
+    components[1] = 1.0f;
+    components[2] = 1.0f;
+    components[3] = 0.0f;
+    components[4] = 0.0f;
+    components[5] = 0.0f;
+    first_k = 6;
+  }
+
+  vector_int::const_iterator ji;
+  for (ji = joints.begin(); ji != joints.end(); ++ji) {
+    _matrix_sums[*ji] = LMatrix4::zeros_mat();
+  }
+
+  int num_controls = (int)_controls.size();
+  for (int ci = 0; ci < num_controls; ++ci) {
+    const ControlSlot &slot = _controls[ci];
+    PN_stdfloat effect = slot._effect;
+    PN_stdfloat e0 = effect * (1.0f - slot._frac);
+    PN_stdfloat e1 = effect * slot._frac;
+
+    for (ji = joints.begin(); ji != joints.end(); ++ji) {
+      int j = (*ji);
+      if (!slot._bound[j]) {
+        continue;
+      }
+
+      LMatrix4 v;
+      for (int k = first_k; k < num_matrix_components; ++k) {
+        components[k] = get_components(ci, 0, k)[j];
+      }
+      compose_matrix(v, components);
+
+      if (!_frame_blend_flag) {
+        // Hold the current frame until the next one is ready.
+        accumulate_matrix(_matrix_sums[j], v, effect);
+      } else {
+        // Blend between successive frames.
+        accumulate_matrix(_matrix_sums[j], v, e0);
+
+        for (int k = first_k; k < num_matrix_components; ++k) {
+          components[k] = get_components(ci, 1, k)[j];
+        }
+        compose_matrix(v, components);
+        accumulate_matrix(_matrix_sums[j], v, e1);
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: PartBundleBatch::sum_components
+//       Access: Private
+//  Description: Accumulates the weighted sum of components [first,
+//               last) for all joints, four joints at a time, in
+//               _sums.
+////////////////////////////////////////////////////////////////////
+void PartBundleBatch::
+sum_components(int first, int last) {
+  memset(get_sums(first), 0, (last - first) * _num_padded * sizeof(PN_stdfloat));
+
+  int num_controls = (int)_controls.size();
+  for (int ci = 0; ci < num_controls; ++ci) {
+    const ControlSlot &slot = _controls[ci];
+    const PN_uint32 *mask = &slot._bound[0];
+    PN_stdfloat effect = slot._effect;
+
+    if (!_frame_blend_flag) {
+      // Hold the current frame until the next one is ready.
+      for (int k = first; k < last; ++k) {
+        accumulate(get_sums(k), get_components(ci, 0, k), mask, effect, _num_padded);
+      }
+    } else {
+      // Blend between successive frames.
+      PN_stdfloat e0 = effect * (1.0f - slot._frac);
+      PN_stdfloat e1 = effect * slot._frac;
+      for (int k = first; k < last; ++k) {
+        accumulate(get_sums(k), get_components(ci, 0, k), mask, e0, _num_padded);
+      }
+      for (int k = first; k < last; ++k) {
+        accumulate(get_sums(k), get_components(ci, 1, k), mask, e1, _num_padded);
+      }
+    }
+  }
+}
@@ -0,0 +1,177 @@
+// Filename: partBundleBatch.h
+// Created by:  agent (17Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef PARTBUNDLEBATCH_H
+#define PARTBUNDLEBATCH_H
+
+#include "pandabase.h"
+
+#include "partBundle.h"
+#include "movingPartMatrix.h"
+#include "animChannelMatrixXfmTable.h"
+#include "compose_matrix.h"
+#include "pointerTo.h"
+#include "pvector.h"
+#include "epvector.h"
+#include "luse.h"
+#include "numeric_types.h"
+#include "vector_int.h"
+#include "vector_uchar.h"
+#include "updateSeq.h"
+
+////////////////////////////////////////////////////////////////////
+//       Class : PartBundleBatch
+// Description : This is an internal helper for PartBundle that
+//               evaluates the animation of all of the bundle's joints
+//               at once, before PartBundle::do_update() walks the
+//               hierarchy.  It is used only when anim-batch-evaluate
+//               is true.
+//
+//               The per-frame table values of every joint are
+//               gathered into structure-of-arrays form, one array
+//               per matrix component, and the blends between
+//               animations and between frames are then computed
+//               across all of the joints together, four at a time
+//               using SSE2 where it is available.
+//
+//               The results are the same as those computed by
+//               MovingPartMatrix::get_blend_value(), because the
+//               same arithmetic is performed in the same order, and
+//               the matrices themselves are still built by
+//               compose_matrix(); though in a build with -ffast-math,
+//               the compiler may round the two differently in the
+//               last bit.  Joints that are animated by
+//               anything other than an AnimChannelMatrixXfmTable, or
+//               with BT_componentwise_quat blending, are left for
+//               get_blend_value() to compute in the usual way.
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDA_CHAN PartBundleBatch {
+public:
+  PartBundleBatch();
+  ~PartBundleBatch();
+
+  void clear();
+  INLINE void mark_stale();
+  INLINE bool is_stale(const PartBundle::BlendType blend_type,
+                       bool frame_blend_flag) const;
+
+  void build(PartBundle *bundle, const PartBundle::ChannelBlend &blend,
+             PartBundle::BlendType blend_type, bool frame_blend_flag);
+  void evaluate(bool full);
+  INLINE void set_active(bool active);
+
+  INLINE int get_num_joints() const;
+  INLINE bool get_value(const MovingPartMatrix *part, LMatrix4 &value) const;
+
+private:
+  bool any_tables_modified() const;
+  void r_collect(PartGroup *part);
+  void classify_joint(int j);
+  void set_channel(int ci, int j, AnimChannelMatrixXfmTable *channel);
+
+  void gather(int ci, int fi, int frame, const vector_int &joints);
+  void eval_single(const vector_int &joints);
+  void eval_blend(const vector_int &joints);
+  void sum_matrices(const vector_int &joints, bool no_scale_shear);
+  void sum_components(int first, int last);
+
+  INLINE PN_stdfloat *get_components(int ci, int fi, int k);
+  INLINE PN_stdfloat *get_sums(int k);
+
+  // One value from an AnimChannelMatrixXfmTable sub-table, for each
+  // joint.  An empty table is represented by a one-entry table
+  // holding the default value.  _table keeps the channel's table
+  // alive even if the channel replaces it; _data points into it (or
+  // into _defaults, if _table is NULL).
+  class TableRef {
+  public:
+    CPTA_stdfloat _table;
+    const PN_stdfloat *_data;
+    int _size;
+  };
+  typedef pvector<TableRef> TableRefs;
+
+  // One of these for each AnimControl in the bundle's blend.
+  class ControlSlot {
+  public:
+    AnimControl *_control;
+    PN_stdfloat _effect;
+
+    // These record the frame last evaluated.
+    int _frame;
+    int _next_frame;
+    PN_stdfloat _frac;
+
+    // These are indexed by joint.  _bound is all bits on for a joint
+    // that has a channel bound for this control, or 0 otherwise; it
+    // is used as a mask by the blending arithmetic.  _tables is
+    // indexed by component * _num_padded + joint.  _channels_modified
+    // records each channel's _tables_modified when its tables were
+    // recorded.
+    pvector<PN_uint32> _bound;
+    TableRefs _tables;
+    pvector< PT(AnimChannelMatrixXfmTable) > _channels;
+    pvector<UpdateSeq> _channels_modified;
+  };
+  typedef pvector<ControlSlot> ControlSlots;
+  ControlSlots _controls;
+
+  enum JointMode {
+    JM_none,    // Left to MovingPartMatrix::get_blend_value().
+    JM_single,  // A single channel, no frame blending.
+    JM_blend,   // A blend among channels, or between frames.
+  };
+
+  typedef pvector< PT(MovingPartMatrix) > Joints;
+  Joints _joints;
+  int _num_padded;
+
+  vector_uchar _modes;
+  vector_int _single_slot;
+  vector_uchar _animated;
+  vector_uchar _ready;
+
+  // The lists of joint indices in each mode; the "animated" lists
+  // contain only those joints with at least one table of more than
+  // one frame, which are the only ones that need to be recomputed
+  // when the frame changes.
+  vector_int _single_joints;
+  vector_int _blend_joints;
+  vector_int _animated_single_joints;
+  vector_int _animated_blend_joints;
+
+  // The gathered table values, in structure-of-arrays form: for each
+  // control slot, for this frame and the next, for each component,
+  // an array of _num_padded values.
+  pvector<PN_stdfloat> _components;
+
+  // Scratch space for blending: the weighted sums of the above, one
+  // array per component, and of the composed matrices.
+  pvector<PN_stdfloat> _sums;
+  pvector<PN_stdfloat> _net_effect;
+  epvector<LMatrix4> _matrix_sums;
+
+  epvector<LMatrix4> _values;
+
+  PartBundle::BlendType _blend_type;
+  bool _frame_blend_flag;
+  bool _stale;
+  bool _active;
+
+  PN_stdfloat _defaults[num_matrix_components];
+};
+
+#include "partBundleBatch.I"
+
+#endif
@@ -0,0 +1,255 @@
+// Filename: test_anim_crowd.cxx
+// Created by:  agent (17Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pandabase.h"
+#include "partBundle.h"
+#include "partGroup.h"
+#include "movingPartMatrix.h"
+#include "animBundle.h"
+#include "animGroup.h"
+#include "animControl.h"
+#include "animChannelMatrixXfmTable.h"
+#include "clockObject.h"
+#include "trueClock.h"
+#include "randomizer.h"
+#include "config_chan.h"
+#include "epvector.h"
+
+// This program measures the time spent in PartBundle::update() for a
+// crowd of identically-skeletoned characters, each playing a pair of
+// animations at a slightly different rate, with anim-batch-evaluate
+// off and then on.  It also checks that both settings produce the same
+// joint transforms on every frame, to within rounding error, for each
+// of the blend types.
+
+static const int num_characters = 300;
+static const int num_joints = 60;
+static const int num_anim_frames = 48;
+static const int num_frames = 60;
+static const PN_stdfloat tolerance = 1.0e-5f;
+
+typedef pvector< PT(MovingPartMatrix) > Joints;
+
+class Character {
+public:
+  PT(PartBundle) _bundle;
+  Joints _joints;
+  pvector< PT(AnimControl) > _controls;
+};
+typedef pvector<Character> Characters;
+
+static PT(PartBundle)
+make_bundle(Joints &joints) {
+  PT(PartBundle) bundle = new PartBundle("crowd");
+  PartGroup *skeleton = new PartGroup(bundle, "<skeleton>");
+
+  // A simple branching hierarchy: each joint is parented to one of the
+  // joints created shortly before it.
+  for (int j = 0; j < num_joints; ++j) {
+    PartGroup *parent = skeleton;
+    if (j != 0) {
+      parent = joints[(j - 1) - (j % 3 == 0 ? min(j - 1, 4) : 0)];
+    }
+    LMatrix4 default_value = LMatrix4::translate_mat(0, 0, 1);
+    ostringstream strm;
+    strm << "joint" << j;
+    joints.push_back(new MovingPartMatrix(parent, strm.str(), default_value));
+  }
+  return bundle;
+}
+
+static PT(AnimBundle)
+make_anim(int seed) {
+  Randomizer random(seed);
+  PT(AnimBundle) anim = new AnimBundle("crowd", 24.0f, num_anim_frames);
+  AnimGroup *skeleton = new AnimGroup(anim, "<skeleton>");
+
+  // The channel hierarchy must match the joint hierarchy built above.
+  pvector<AnimGroup *> channels;
+  for (int j = 0; j < num_joints; ++j) {
+    AnimGroup *parent = skeleton;
+    if (j != 0) {
+      parent = channels[(j - 1) - (j % 3 == 0 ? min(j - 1, 4) : 0)];
+    }
+    ostringstream strm;
+    strm << "joint" << j;
+    AnimChannelMatrixXfmTable *channel =
+      new AnimChannelMatrixXfmTable(parent, strm.str());
+    channels.push_back(channel);
+
+    // Most joints only rotate; a few also translate and scale, and
+    // some are held still, as in typical character animation.
+    static const char rotate_tables[] = "hpr";
+    static const char other_tables[] = "xyzijk";
+    if (j % 7 != 6) {
+      for (int t = 0; t < 3; ++t) {
+        PTA_stdfloat table = PTA_stdfloat::empty_array(num_anim_frames);
+        for (int f = 0; f < num_anim_frames; ++f) {
+          table[f] = random.random_real(90.0) - 45.0;
+        }
+        channel->set_table(rotate_tables[t], table);
+      }
+    }
+    if (j % 5 == 0) {
+      for (int t = 0; t < 6; ++t) {
+        PTA_stdfloat table = PTA_stdfloat::empty_array(num_anim_frames);
+        for (int f = 0; f < num_anim_frames; ++f) {
+          table[f] = (t < 3) ? random.random_real(2.0) : 1.0 + random.random_real(0.5);
+        }
+        channel->set_table(other_tables[t], table);
+      }
+    } else {
+      PTA_stdfloat table = PTA_stdfloat::empty_array(1);
+      table[0] = 1.0;
+      channel->set_table('z', table);
+    }
+  }
+  return anim;
+}
+
+// Builds the crowd.  The same crowd is animated with and without the
+// batch, so that each bundle blends its controls in the same order
+// both times.
+static void
+make_crowd(Characters &crowd, PartBundle::BlendType blend_type,
+           bool frame_blend, AnimBundle *walk, AnimBundle *run_anim) {
+  crowd.clear();
+  crowd.insert(crowd.end(), num_characters, Character());
+  for (int i = 0; i < num_characters; ++i) {
+    Character &ch = crowd[i];
+    ch._bundle = make_bundle(ch._joints);
+    ch._bundle->set_blend_type(blend_type);
+    ch._bundle->set_frame_blend_flag(frame_blend);
+
+    // Half of the crowd blends the two animations; the rest plays just
+    // one of them.
+    bool blend = (i % 2 == 0);
+    ch._bundle->set_anim_blend_flag(blend);
+    PT(AnimControl) b = ch._bundle->bind_anim(run_anim);
+    PT(AnimControl) a = ch._bundle->bind_anim(walk);
+    nassertv(a != (AnimControl *)NULL && b != (AnimControl *)NULL);
+    a->set_play_rate(1.0 + 0.01 * i);
+    ch._controls.push_back(a);
+
+    if (blend) {
+      b->set_play_rate(0.5 + 0.02 * i);
+      ch._bundle->set_control_effect(a, 0.3f + 0.001f * i);
+      ch._bundle->set_control_effect(b, 0.7f);
+      ch._controls.push_back(b);
+    }
+  }
+}
+
+// Animates the crowd from the beginning over num_frames frames,
+// appending every joint's transform after each frame to results.
+// Returns the average number of milliseconds per frame spent in
+// update().
+static double
+run(Characters &crowd, bool batch, epvector<LMatrix4> &results) {
+  anim_batch_evaluate = batch;
+
+  // The animations are restarted at the current time, which is always
+  // a whole number of clock frames.  Since each clock frame is a power
+  // of two fraction of a second, every run sees exactly the same
+  // elapsed times.
+  ClockObject *clock = ClockObject::get_global_clock();
+  clock->tick();
+
+  Characters::iterator ci;
+  for (ci = crowd.begin(); ci != crowd.end(); ++ci) {
+    pvector< PT(AnimControl) >::iterator ai;
+    for (ai = (*ci)._controls.begin(); ai != (*ci)._controls.end(); ++ai) {
+      (*ai)->loop(true);
+    }
+    (*ci)._bundle->force_update();
+  }
+
+  TrueClock *true_clock = TrueClock::get_global_ptr();
+  double total_time = 0.0;
+  for (int frame = 0; frame < num_frames; ++frame) {
+    clock->tick();
+
+    double start = true_clock->get_short_time();
+    for (ci = crowd.begin(); ci != crowd.end(); ++ci) {
+      (*ci)._bundle->update();
+    }
+    total_time += true_clock->get_short_time() - start;
+
+    for (ci = crowd.begin(); ci != crowd.end(); ++ci) {
+      Joints::const_iterator ji;
+      for (ji = (*ci)._joints.begin(); ji != (*ci)._joints.end(); ++ji) {
+        results.push_back((*ji)->get_value());
+      }
+    }
+  }
+
+  return total_time * 1000.0 / num_frames;
+}
+
+static bool
+compare(const epvector<LMatrix4> &a, const epvector<LMatrix4> &b) {
+  nassertr(a.size() == b.size(), false);
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (!a[i].almost_equal(b[i], tolerance)) {
+      int frame_size = num_joints * num_characters;
+      nout << "  Joint " << i % num_joints << " of character "
+           << (i % frame_size) / num_joints << " differs on frame "
+           << i / frame_size << ":\n" << a[i] << "  vs.\n" << b[i];
+      return false;
+    }
+  }
+  return true;
+}
+
+int
+main(int argc, char *argv[]) {
+  ClockObject *clock = ClockObject::get_global_clock();
+  clock->set_mode(ClockObject::M_non_real_time);
+  clock->set_frame_rate(64.0);
+
+  PT(AnimBundle) walk = make_anim(1);
+  PT(AnimBundle) run_anim = make_anim(2);
+
+  static const PartBundle::BlendType blend_types[] = {
+    PartBundle::BT_linear,
+    PartBundle::BT_normalized_linear,
+    PartBundle::BT_componentwise,
+    PartBundle::BT_componentwise_quat,
+  };
+  static const char *blend_names[] = {
+    "linear", "normalized_linear", "componentwise", "componentwise_quat",
+  };
+
+  bool ok = true;
+  for (int bi = 0; bi < 4; ++bi) {
+    for (int fb = 0; fb < 2; ++fb) {
+      Characters crowd;
+      make_crowd(crowd, blend_types[bi], fb != 0, walk, run_anim);
+
+      epvector<LMatrix4> reference, results;
+      double base_ms = run(crowd, false, reference);
+      double ms = run(crowd, true, results);
+
+      nout << blend_names[bi] << (fb ? ", interpolated" : "") << ": "
+           << base_ms << " ms per frame unbatched, "
+           << ms << " ms batched, " << base_ms / ms << "x\n";
+      if (!compare(reference, results)) {
+        nout << "  Batched results differ from the unbatched results!\n";
+        ok = false;
+      }
+    }
+  }
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,258 @@
+// Filename: test_anim_quantize.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pandabase.h"
+#include "animBundle.h"
+#include "animGroup.h"
+#include "animChannelMatrixXfmTable.h"
+#include "animChannelMatrixQuantizedTable.h"
+#include "trueClock.h"
+#include "randomizer.h"
+#include "cmath.h"
+
+// This program compares an animation stored in
+// AnimChannelMatrixXfmTables with the same animation compressed by
+// AnimBundle::copy_bundle_quantized(), at several tolerances.  It
+// reports the memory used by the tables and the time to decode every
+// joint on every frame, and checks that no component of any joint
+// strays further from the original than the tolerance allows, both
+// before and after a round trip through a bam stream.  It also checks
+// that a channel too long to quantize is copied as it is.
+
+static const int num_joints = 60;
+static const int num_frames = 240;
+static const int num_passes = 20;
+
+typedef pvector<AnimChannelMatrix *> Channels;
+
+// Builds a skeleton animation that moves smoothly, as motion capture
+// or keyframed animation would.  Many of the joints only rotate, a
+// few components are constant, and some are never animated at all.
+static PT(AnimBundle)
+make_anim() {
+  Randomizer random(1);
+  PT(AnimBundle) anim = new AnimBundle("walk", 30.0f, num_frames);
+  AnimGroup *skeleton = new AnimGroup(anim, "<skeleton>");
+
+  pvector<AnimGroup *> channels;
+  for (int j = 0; j < num_joints; ++j) {
+    AnimGroup *parent = (j == 0) ? skeleton : channels[(j - 1) / 2];
+    ostringstream strm;
+    strm << "joint" << j;
+    AnimChannelMatrixXfmTable *channel =
+      new AnimChannelMatrixXfmTable(parent, strm.str());
+    channels.push_back(channel);
+
+    static const char rotate_tables[] = "hpr";
+    for (int t = 0; t < 3; ++t) {
+      if ((j + t) % 5 == 4) {
+        // Never animated.
+        continue;
+      }
+      PN_stdfloat amplitude = random.random_real(60.0);
+      PN_stdfloat phase = random.random_real(2.0 * MathNumbers::pi);
+      PN_stdfloat offset = random.random_real(90.0) - 45.0;
+      PTA_stdfloat table = PTA_stdfloat::empty_array(num_frames);
+      for (int f = 0; f < num_frames; ++f) {
+        PN_stdfloat t = (PN_stdfloat)f / (PN_stdfloat)num_frames * 2.0f * MathNumbers::pi;
+        table[f] = offset + amplitude * csin(t * 2.0f + phase) +
+          random.random_real(0.002);
+      }
+      channel->set_table(rotate_tables[t], table);
+    }
+
+    // Each joint is offset from its parent by a constant amount, and
+    // the root also travels.
+    PTA_stdfloat y = PTA_stdfloat::empty_array(1);
+    y[0] = 1.0f;
+    channel->set_table('y', y);
+    if (j == 0) {
+      PTA_stdfloat x = PTA_stdfloat::empty_array(num_frames);
+      PTA_stdfloat z = PTA_stdfloat::empty_array(num_frames);
+      for (int f = 0; f < num_frames; ++f) {
+        x[f] = f * 0.05f;
+        z[f] = 0.1f * csin(f * 0.2f);
+      }
+      channel->set_table('x', x);
+      channel->set_table('z', z);
+    }
+  }
+  return anim;
+}
+
+// Appends all of the matrix channels at or below the indicated group
+// to channels, in depth-first order.
+static void
+collect_channels(AnimGroup *group, Channels &channels) {
+  if (group->is_of_type(AnimChannelMatrix::get_class_type())) {
+    channels.push_back(DCAST(AnimChannelMatrix, group));
+  }
+  for (int i = 0; i < group->get_num_children(); ++i) {
+    collect_channels(group->get_child(i), channels);
+  }
+}
+
+// Returns the number of bytes used by the tables of the channels.
+static size_t
+get_table_size(const Channels &channels) {
+  size_t size = 0;
+  Channels::const_iterator ci;
+  for (ci = channels.begin(); ci != channels.end(); ++ci) {
+    if ((*ci)->is_exact_type(AnimChannelMatrixQuantizedTable::get_class_type())) {
+      size += DCAST(AnimChannelMatrixQuantizedTable, *ci)->get_data_size();
+    } else {
+      AnimChannelMatrixXfmTable *table = DCAST(AnimChannelMatrixXfmTable, *ci);
+      for (int i = 0; i < num_matrix_components; ++i) {
+        size += table->get_table(matrix_component_letters[i]).size() * sizeof(PN_stdfloat);
+      }
+    }
+  }
+  return size;
+}
+
+// Returns the average number of microseconds to decode every channel
+// on one frame.
+static double
+time_decode(const Channels &channels) {
+  TrueClock *true_clock = TrueClock::get_global_ptr();
+  LMatrix4 sum = LMatrix4::zeros_mat();
+  double start = true_clock->get_short_time();
+  for (int pass = 0; pass < num_passes; ++pass) {
+    for (int f = 0; f < num_frames; ++f) {
+      Channels::const_iterator ci;
+      for (ci = channels.begin(); ci != channels.end(); ++ci) {
+        LMatrix4 mat;
+        (*ci)->get_value(f, mat);
+        sum += mat;
+      }
+    }
+  }
+  double elapsed = true_clock->get_short_time() - start;
+
+  // Make sure the compiler can't discard the work.
+  if (sum(0, 0) == 12345.0f) {
+    nout << sum;
+  }
+  return elapsed * 1000000.0 / (num_passes * num_frames);
+}
+
+// Returns the largest difference between any component of the two
+// sets of channels, on any frame.
+static PN_stdfloat
+get_max_error(const Channels &a, const Channels &b) {
+  nassertr(a.size() == b.size(), 1.0e30f);
+  PN_stdfloat max_error = 0.0f;
+  for (size_t c = 0; c < a.size(); ++c) {
+    for (int f = 0; f < num_frames + 5; ++f) {
+      LVecBase3 va[4], vb[4];
+      a[c]->get_scale(f, va[0]);
+      a[c]->get_shear(f, va[1]);
+      a[c]->get_hpr(f, va[2]);
+      a[c]->get_pos(f, va[3]);
+      b[c]->get_scale(f, vb[0]);
+      b[c]->get_shear(f, vb[1]);
+      b[c]->get_hpr(f, vb[2]);
+      b[c]->get_pos(f, vb[3]);
+      for (int v = 0; v < 4; ++v) {
+        for (int i = 0; i < 3; ++i) {
+          max_error = max(max_error, cabs(va[v][i] - vb[v][i]));
+        }
+      }
+    }
+  }
+  return max_error;
+}
+
+// Writes the bundle to a bam stream and reads it back again.
+static PT(AnimBundle)
+round_trip(AnimBundle *anim) {
+  string data = anim->encode_to_bam_stream();
+  TypedWritable *object;
+  ReferenceCount *ref_ptr;
+  if (!TypedWritable::decode_raw_from_bam_stream(object, ref_ptr, data)) {
+    return NULL;
+  }
+  return DCAST(AnimBundle, object);
+}
+
+int
+main(int argc, char *argv[]) {
+  PT(AnimBundle) anim = make_anim();
+  Channels original;
+  collect_channels(anim, original);
+
+  size_t base_size = get_table_size(original);
+  double base_us = time_decode(original);
+  nout << "uncompressed: " << base_size << " bytes, "
+       << base_us << " us to decode each frame\n";
+
+  bool ok = true;
+  static const PN_stdfloat tolerances[] = { 0.0f, 0.01f, 0.1f, 0.5f };
+  for (int ti = 0; ti < 4; ++ti) {
+    PN_stdfloat tolerance = tolerances[ti];
+    PT(AnimBundle) quantized = anim->copy_bundle_quantized(tolerance);
+    Channels channels;
+    collect_channels(quantized, channels);
+
+    size_t size = get_table_size(channels);
+    double us = time_decode(channels);
+    PN_stdfloat error = get_max_error(original, channels);
+    nout << "tolerance " << tolerance << ": " << size << " bytes ("
+         << (double)base_size / (double)size << "x smaller), "
+         << us << " us to decode each frame, max error " << error << "\n";
+
+    // Each key may also be off by half of a 16-bit quantization step
+    // of its component's range, which is less than 360 degrees here.
+    PN_stdfloat allowed = tolerance + 360.0f / 65535.0f;
+    if (error > allowed) {
+      nout << "  Error exceeds " << allowed << "!\n";
+      ok = false;
+    }
+
+    PT(AnimBundle) reread = round_trip(quantized);
+    Channels reread_channels;
+    if (reread != (AnimBundle *)NULL) {
+      collect_channels(reread, reread_channels);
+    }
+    if (reread_channels.size() != channels.size() ||
+        get_max_error(channels, reread_channels) != 0.0f) {
+      nout << "  Channels differ after reading back from bam!\n";
+      ok = false;
+    }
+  }
+
+  // A channel with more frames than the quantized table can number
+  // is kept unquantized, rather than losing its animation.
+  PT(AnimBundle) long_anim = new AnimBundle("long", 30.0f, 0x10000);
+  AnimChannelMatrixXfmTable *long_channel =
+    new AnimChannelMatrixXfmTable(long_anim, "joint");
+  PTA_stdfloat long_table = PTA_stdfloat::empty_array(0x10000);
+  for (int f = 0; f < 0x10000; ++f) {
+    long_table[f] = (PN_stdfloat)(f % 360);
+  }
+  long_channel->set_table('h', long_table);
+
+  PT(AnimBundle) long_quantized = long_anim->copy_bundle_quantized(0.1f);
+  Channels long_original, long_channels;
+  collect_channels(long_anim, long_original);
+  collect_channels(long_quantized, long_channels);
+  if (long_channels.size() != 1 ||
+      !long_channels[0]->is_exact_type(AnimChannelMatrixXfmTable::get_class_type()) ||
+      get_max_error(long_original, long_channels) != 0.0f) {
+    nout << "A channel of 65536 frames was not copied unquantized!\n";
+    ok = false;
+  }
+
+  return ok ? 0 : 1;
+}
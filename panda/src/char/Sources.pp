@@ -15,6 +15,8 @@
     characterJointBundle.I characterJointBundle.h \
     characterJointEffect.h characterJointEffect.I \
     characterSlider.h \
+    characterUpdater.I characterUpdater.h \
+    characterUpdaterWorker.I characterUpdaterWorker.h \
     characterVertexSlider.I characterVertexSlider.h \
     config_char.h \
     jointVertexTransform.I jointVertexTransform.h
@@ -24,6 +26,7 @@
     characterJoint.cxx characterJointBundle.cxx  \
     characterJointEffect.cxx \
     characterSlider.cxx \
+    characterUpdater.cxx characterUpdaterWorker.cxx \
     characterVertexSlider.cxx \
     config_char.cxx  \
     jointVertexTransform.cxx
@@ -34,6 +37,8 @@
     characterJointBundle.I characterJointBundle.h \
     characterJointEffect.h characterJointEffect.I \
     characterSlider.h \
+    characterUpdater.I characterUpdater.h \
+    characterUpdaterWorker.I characterUpdaterWorker.h \
     characterVertexSlider.I characterVertexSlider.h \
     config_char.h \
     jointVertexTransform.I jointVertexTransform.h
@@ -42,3 +47,13 @@
 
 #end lib_target
 
+#begin test_bin_target
+  #define TARGET test_character_threads
+  #define LOCAL_LIBS \
+    p3char p3chan p3pgraph p3gobj
+  #define OTHER_LIBS $[OTHER_LIBS] p3pystub
+
+  #define SOURCES \
+    test_character_threads.cxx
+
+#end test_bin_target
@@ -0,0 +1,260 @@
+// Filename: characterUpdater.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "characterUpdater.h"
+#include "characterUpdaterWorker.h"
+#include "config_char.h"
+#include "asyncTaskManager.h"
+#include "asyncTaskChain.h"
+#include "pStatTimer.h"
+
+#include <algorithm>
+
+AtomicAdjust::Integer CharacterUpdater::_next_task_chain_id;
+
+////////////////////////////////////////////////////////////////////
+//     Function: CharacterUpdater::Constructor
+//       Access: Published
+//  Description:
+////////////////////////////////////////////////////////////////////
+CharacterUpdater::
+CharacterUpdater(const string &name) :
+  Namable(name),
+  _num_threads(0),
+  _next_character(0),
+  _update_pcollector("App:Animation:" + name)
+{
+  // Each updater needs a task chain of its own, even if it shares its
+  // name with another, since the chain is removed again when the
+  // updater is destroyed.
+  AtomicAdjust::Integer current_id = _next_task_chain_id;
+  while (AtomicAdjust::compare_and_exchange(_next_task_chain_id, current_id, current_id + 1) != current_id) {
+    current_id = _next_task_chain_id;
+  }
+  ostringstream strm;
+  strm << "char:" << name << ":" << current_id;
+  _task_chain = strm.str();
+
+  set_num_threads(character_updater_threads);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CharacterUpdater::Destructor
+//       Access: Published
+//  Description:
+////////////////////////////////////////////////////////////////////
+CharacterUpdater::
+~CharacterUpdater() {
+  if (_num_threads > 1) {
+    // Stop the threads on our task chain; the workers point back to
+    // this object.
+    AsyncTaskManager *task_mgr = AsyncTaskManager::get_global_ptr();
+    task_mgr->remove_task_chain(_task_chain);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CharacterUpdater::add_character
+//       Access: Published
+//  Description: Adds a new Character to the set updated by update().
+//               If the Character is already in the set, this does
+//               nothing.
+////////////////////////////////////////////////////////////////////
+void CharacterUpdater::
+add_character(Character *character) {
+  nassertv(character != (Character *)NULL);
+  if (!has_character(character)) {
+    _characters.push_back(character);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CharacterUpdater::remove_character
+//       Access: Published
+//  Description: Removes the indicated Character from the set.
+//               Returns true if it was removed, false if it was not
+//               in the set.
+////////////////////////////////////////////////////////////////////
+bool CharacterUpdater::
+remove_character(Character *character) {
+  Characters::iterator ci =
+    find(_characters.begin(), _characters.end(), character);
+  if (ci == _characters.end()) {
+    return false;
+  }
+  _characters.erase(ci);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CharacterUpdater::has_character
+//       Access: Published
+//  Description: Returns true if the indicated Character is in the
+//               set, false otherwise.
+////////////////////////////////////////////////////////////////////
+bool CharacterUpdater::
+has_character(Character *character) const {
+  return find(_characters.begin(), _characters.end(), character) !=
+    _characters.end();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CharacterUpdater::clear_characters
+//       Access: Published
+//  Description: Removes all Characters from the set.
+////////////////////////////////////////////////////////////////////
+void CharacterUpdater::
+clear_characters() {
+  _characters.clear();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CharacterUpdater::set_num_threads
+//       Access: Published
+//  Description: Specifies the number of threads across which update()
+//               should divide the Characters.  If this is 0 or 1,
+//               all of the Characters are updated in the calling
+//               thread, one at a time.
+//
+//               Otherwise, the Characters are handed out to this many
+//               task threads, on a task chain of their own, as each
+//               thread finishes its previous Character; update()
+//               returns when all of them have been updated.  It is
+//               safe for several Characters to share the same
+//               AnimBundles, or even the same PartBundle, since each
+//               PartBundle holds its own lock while it is updated;
+//               but the joint hierarchies must not be modified by
+//               another thread during update().
+////////////////////////////////////////////////////////////////////
+void CharacterUpdater::
+set_num_threads(int num_threads) {
+  nassertv(num_threads >= 0);
+  if (num_threads == _num_threads) {
+    return;
+  }
+  if (_num_threads > 1 && num_threads <= 1) {
+    // We won't be needing our task chain any more.
+    AsyncTaskManager *task_mgr = AsyncTaskManager::get_global_ptr();
+    task_mgr->remove_task_chain(_task_chain);
+  }
+  _num_threads = num_threads;
+
+  int num_workers = (_num_threads > 1) ? _num_threads : 0;
+  while ((int)_workers.size() < num_workers) {
+    ostringstream strm;
+    strm << get_name() << "-" << _workers.size();
+    _workers.push_back(new CharacterUpdaterWorker(this, strm.str()));
+  }
+  _workers.resize(num_workers);
+
+  if (_num_threads > 1) {
+    AsyncTaskManager *task_mgr = AsyncTaskManager::get_global_ptr();
+    PT(AsyncTaskChain) chain = task_mgr->make_task_chain(_task_chain);
+    chain->set_num_threads(_num_threads);
+    chain->set_thread_priority(TP_high);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CharacterUpdater::update
+//       Access: Published
+//  Description: Recalculates the joints of all of the Characters for
+//               the current frame, as Character::update() would.
+//               The Characters will not be updated again when they
+//               are culled this frame.
+////////////////////////////////////////////////////////////////////
+void CharacterUpdater::
+update() {
+  do_update(false);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CharacterUpdater::force_update
+//       Access: Published
+//  Description: Recalculates the joints of all of the Characters,
+//               even if they don't appear to need it, as
+//               Character::force_update() would.
+////////////////////////////////////////////////////////////////////
+void CharacterUpdater::
+force_update() {
+  do_update(true);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CharacterUpdater::update_next
+//       Access: Public
+//  Description: Called by each CharacterUpdaterWorker, in its own
+//               thread, to claim and update Characters one at a time
+//               until all of them have been claimed.
+////////////////////////////////////////////////////////////////////
+void CharacterUpdater::
+update_next(bool force) {
+  int num_characters = (int)_characters.size();
+  while (true) {
+    AtomicAdjust::Integer n = AtomicAdjust::get(_next_character);
+    if (n >= num_characters) {
+      return;
+    }
+    if (AtomicAdjust::compare_and_exchange(_next_character, n, n + 1) == n) {
+      update_character(_characters[n], force);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CharacterUpdater::do_update
+//       Access: Private
+//  Description: The implementation of update() and force_update().
+////////////////////////////////////////////////////////////////////
+void CharacterUpdater::
+do_update(bool force) {
+  PStatTimer timer(_update_pcollector);
+
+  if (_workers.empty() || _characters.size() <= 1) {
+    Characters::const_iterator ci;
+    for (ci = _characters.begin(); ci != _characters.end(); ++ci) {
+      update_character(*ci, force);
+    }
+    return;
+  }
+
+  AtomicAdjust::set(_next_character, 0);
+
+  AsyncTaskManager *task_mgr = AsyncTaskManager::get_global_ptr();
+  AsyncTaskChain *chain = task_mgr->make_task_chain(_task_chain);
+
+  Workers::iterator wi;
+  for (wi = _workers.begin(); wi != _workers.end(); ++wi) {
+    CharacterUpdaterWorker *worker = (*wi);
+    worker->set_force(force);
+    worker->set_task_chain(_task_chain);
+    task_mgr->add(worker);
+  }
+
+  chain->wait_for_tasks();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CharacterUpdater::update_character
+//       Access: Private
+//  Description: Updates a single Character, in the current thread.
+////////////////////////////////////////////////////////////////////
+void CharacterUpdater::
+update_character(Character *character, bool force) {
+  if (force) {
+    character->force_update();
+  } else {
+    character->update();
+  }
+}
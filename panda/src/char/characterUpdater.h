@@ -0,0 +1,93 @@
+// Filename: characterUpdater.h
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef CHARACTERUPDATER_H
+#define CHARACTERUPDATER_H
+
+#include "pandabase.h"
+
+#include "character.h"
+#include "referenceCount.h"
+#include "namable.h"
+#include "pointerTo.h"
+#include "pvector.h"
+#include "atomicAdjust.h"
+#include "pStatCollector.h"
+
+class CharacterUpdaterWorker;
+
+////////////////////////////////////////////////////////////////////
+//       Class : CharacterUpdater
+// Description : This object updates the animation of a whole set of
+//               Characters at once, ahead of the cull traversal that
+//               would otherwise update them one at a time as they
+//               are encountered.
+//
+//               Since each Character's joints are independent of all
+//               the others, the Characters may be spread across a
+//               number of threads; see set_num_threads().  This is
+//               worthwhile when there are many animated Characters
+//               in the scene, for instance a crowd.
+//
+//               Characters that have been updated by a
+//               CharacterUpdater are not updated again during cull
+//               in the same frame.
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDA_CHAR CharacterUpdater : public ReferenceCount, public Namable {
+PUBLISHED:
+  CharacterUpdater(const string &name = "characters");
+  ~CharacterUpdater();
+
+  void add_character(Character *character);
+  bool remove_character(Character *character);
+  bool has_character(Character *character) const;
+  INLINE int get_num_characters() const;
+  INLINE Character *get_character(int n) const;
+  MAKE_SEQ(get_characters, get_num_characters, get_character);
+  void clear_characters();
+
+  void set_num_threads(int num_threads);
+  INLINE int get_num_threads() const;
+
+  void update();
+  void force_update();
+
+public:
+  void update_next(bool force);
+
+private:
+  void do_update(bool force);
+  void update_character(Character *character, bool force);
+
+  typedef pvector< PT(Character) > Characters;
+  Characters _characters;
+
+  int _num_threads;
+
+  // These are used only when _num_threads is greater than 1.  The
+  // workers take the Characters in turn, by incrementing
+  // _next_character, so that the load is shared evenly even if some
+  // Characters are much more expensive than others.
+  string _task_chain;
+  static AtomicAdjust::Integer _next_task_chain_id;
+  typedef pvector< PT(CharacterUpdaterWorker) > Workers;
+  Workers _workers;
+  TVOLATILE AtomicAdjust::Integer _next_character;
+
+  PStatCollector _update_pcollector;
+};
+
+#include "characterUpdater.I"
+
+#endif
@@ -0,0 +1,42 @@
+// Filename: characterUpdaterWorker.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "characterUpdaterWorker.h"
+#include "characterUpdater.h"
+
+TypeHandle CharacterUpdaterWorker::_type_handle;
+
+////////////////////////////////////////////////////////////////////
+//     Function: CharacterUpdaterWorker::Constructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+CharacterUpdaterWorker::
+CharacterUpdaterWorker(CharacterUpdater *updater, const string &name) :
+  AsyncTask(name),
+  _updater(updater),
+  _force(false)
+{
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CharacterUpdaterWorker::do_task
+//       Access: Protected, Virtual
+//  Description: Updates Characters until the updater has none left.
+////////////////////////////////////////////////////////////////////
+AsyncTask::DoneStatus CharacterUpdaterWorker::
+do_task() {
+  _updater->update_next(_force);
+  return DS_done;
+}
@@ -0,0 +1,67 @@
+// Filename: characterUpdaterWorker.h
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef CHARACTERUPDATERWORKER_H
+#define CHARACTERUPDATERWORKER_H
+
+#include "pandabase.h"
+
+#include "asyncTask.h"
+
+class CharacterUpdater;
+
+////////////////////////////////////////////////////////////////////
+//       Class : CharacterUpdaterWorker
+// Description : This is an internal class used by a CharacterUpdater
+//               that has been asked to use more than one thread.
+//               Each worker runs in a task thread, and updates
+//               Characters from the updater's list until there are
+//               none left.
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDA_CHAR CharacterUpdaterWorker : public AsyncTask {
+public:
+  ALLOC_DELETED_CHAIN(CharacterUpdaterWorker);
+
+  CharacterUpdaterWorker(CharacterUpdater *updater, const string &name);
+
+  INLINE void set_force(bool force);
+
+protected:
+  virtual DoneStatus do_task();
+
+private:
+  CharacterUpdater *_updater;
+  bool _force;
+
+public:
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    AsyncTask::init_type();
+    register_type(_type_handle, "CharacterUpdaterWorker",
+                  AsyncTask::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "characterUpdaterWorker.I"
+
+#endif
@@ -19,6 +19,7 @@
 #include "characterJointBundle.h"
 #include "characterJointEffect.h"
 #include "characterSlider.h"
+#include "characterUpdaterWorker.h"
 #include "characterVertexSlider.h"
 #include "jointVertexTransform.h"
 #include "dconfig.h"
@@ -38,6 +39,13 @@ ConfigVariableBool even_animation
           "The default is to compute vertices only when they need to be "
           "computed, which can lead to an uneven frame rate."));
 
+ConfigVariableInt character_updater_threads
+("character-updater-threads", 0,
+ PRC_DESC("The default number of threads across which each new "
+          "CharacterUpdater divides its Characters.  If this is 0 or 1, "
+          "the Characters are updated in the calling thread only.  See "
+          "CharacterUpdater::set_num_threads()."));
+
 
 ////////////////////////////////////////////////////////////////////
 //     Function: init_libchar
@@ -60,6 +68,7 @@ init_libchar() {
   CharacterJointBundle::init_type();
   CharacterJointEffect::init_type();
   CharacterSlider::init_type();
+  CharacterUpdaterWorker::init_type();
   CharacterVertexSlider::init_type();
   JointVertexTransform::init_type();
 
@@ -1,5 +1,7 @@
 #include "characterJointEffect.cxx"
 #include "characterSlider.cxx"
+#include "characterUpdater.cxx"
+#include "characterUpdaterWorker.cxx"
 #include "characterVertexSlider.cxx"
 #include "jointVertexTransform.cxx"
 
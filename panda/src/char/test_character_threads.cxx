@@ -0,0 +1,219 @@
+// Filename: test_character_threads.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pandabase.h"
+#include "character.h"
+#include "characterJoint.h"
+#include "characterJointBundle.h"
+#include "characterUpdater.h"
+#include "jointVertexTransform.h"
+#include "animBundle.h"
+#include "animGroup.h"
+#include "animControl.h"
+#include "animChannelMatrixXfmTable.h"
+#include "clockObject.h"
+#include "trueClock.h"
+#include "randomizer.h"
+#include "thread.h"
+#include "epvector.h"
+
+// This program measures how CharacterUpdater::update() scales with
+// set_num_threads(), for a crowd of several hundred Characters all
+// playing the same animation at different rates.  It also checks
+// that every thread count produces exactly the same joint and vertex
+// transforms as the single-threaded update.
+
+static const int num_characters = 500;
+static const int num_joints = 40;
+static const int num_anim_frames = 48;
+static const int num_frames = 30;
+
+class Actor {
+public:
+  PT(Character) _character;
+  pvector< PT(CharacterJoint) > _joints;
+  pvector< PT(JointVertexTransform) > _transforms;
+  PT(AnimControl) _control;
+};
+typedef pvector<Actor> Actors;
+
+// The parent of joint j, or -1 for the root joint.
+static int
+get_parent(int j) {
+  if (j == 0) {
+    return -1;
+  }
+  return (j - 1) - (j % 3 == 0 ? min(j - 1, 4) : 0);
+}
+
+static string
+get_joint_name(int j) {
+  ostringstream strm;
+  strm << "joint" << j;
+  return strm.str();
+}
+
+static PT(AnimBundle)
+make_anim() {
+  Randomizer random(1);
+  PT(AnimBundle) anim = new AnimBundle("actor", 24.0f, num_anim_frames);
+  AnimGroup *skeleton = new AnimGroup(anim, "<skeleton>");
+
+  pvector<AnimGroup *> channels;
+  for (int j = 0; j < num_joints; ++j) {
+    int p = get_parent(j);
+    AnimGroup *parent = (p < 0) ? skeleton : channels[p];
+    AnimChannelMatrixXfmTable *channel =
+      new AnimChannelMatrixXfmTable(parent, get_joint_name(j));
+    channels.push_back(channel);
+
+    static const char tables[] = "hprxyz";
+    for (int t = 0; t < 6; ++t) {
+      PTA_stdfloat table = PTA_stdfloat::empty_array(num_anim_frames);
+      for (int f = 0; f < num_anim_frames; ++f) {
+        table[f] = (t < 3) ? random.random_real(90.0) - 45.0 : random.random_real(1.0);
+      }
+      channel->set_table(tables[t], table);
+    }
+  }
+  return anim;
+}
+
+static void
+make_actors(Actors &actors, AnimBundle *anim) {
+  actors.insert(actors.end(), num_characters, Actor());
+  for (int i = 0; i < num_characters; ++i) {
+    Actor &actor = actors[i];
+    actor._character = new Character("actor");
+    PartBundle *bundle = actor._character->get_bundle(0);
+    PartGroup *skeleton = new PartGroup(bundle, "<skeleton>");
+
+    for (int j = 0; j < num_joints; ++j) {
+      int p = get_parent(j);
+      PartGroup *parent = (p < 0) ? skeleton : (PartGroup *)actor._joints[p];
+      CharacterJoint *joint =
+        new CharacterJoint(actor._character, bundle, parent, get_joint_name(j),
+                           LMatrix4::translate_mat(0, 0, 1));
+      actor._joints.push_back(joint);
+
+      // Each joint drives some vertices, as it would in a real model.
+      actor._transforms.push_back(new JointVertexTransform(joint));
+    }
+
+    actor._control = bundle->bind_anim(anim);
+    nassertv(actor._control != (AnimControl *)NULL);
+    actor._control->set_play_rate(0.5 + 0.002 * i);
+  }
+}
+
+// Animates the actors from the beginning over num_frames frames,
+// appending every joint's net transform and vertex transform after
+// each frame to results.  Returns the average number of milliseconds
+// per frame spent in update().
+static double
+run(Actors &actors, int num_threads, epvector<LMatrix4> &results) {
+  CharacterUpdater updater("actors");
+  updater.set_num_threads(num_threads);
+
+  // The animations are restarted at the current time, which is always
+  // a whole number of clock frames.  Since each clock frame is a power
+  // of two fraction of a second, every run sees exactly the same
+  // elapsed times.
+  ClockObject *clock = ClockObject::get_global_clock();
+  clock->tick();
+
+  Actors::iterator ai;
+  for (ai = actors.begin(); ai != actors.end(); ++ai) {
+    (*ai)._control->loop(true);
+    updater.add_character((*ai)._character);
+  }
+  updater.force_update();
+
+  TrueClock *true_clock = TrueClock::get_global_ptr();
+  double total_time = 0.0;
+  for (int frame = 0; frame < num_frames; ++frame) {
+    clock->tick();
+
+    double start = true_clock->get_short_time();
+    updater.update();
+    total_time += true_clock->get_short_time() - start;
+
+    for (ai = actors.begin(); ai != actors.end(); ++ai) {
+      for (int j = 0; j < num_joints; ++j) {
+        LMatrix4 mat;
+        (*ai)._joints[j]->get_net_transform(mat);
+        results.push_back(mat);
+        (*ai)._transforms[j]->get_matrix(mat);
+        results.push_back(mat);
+      }
+    }
+  }
+
+  return total_time * 1000.0 / num_frames;
+}
+
+static bool
+compare(const epvector<LMatrix4> &a, const epvector<LMatrix4> &b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); ++i) {
+    for (int r = 0; r < 4; ++r) {
+      for (int c = 0; c < 4; ++c) {
+        if (a[i](r, c) != b[i](r, c)) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+int
+main(int argc, char *argv[]) {
+  int max_threads = 8;
+  if (argc > 1) {
+    max_threads = atoi(argv[1]);
+  }
+  if (!Thread::is_threading_supported()) {
+    nout << "Threading support is not compiled in; results will not scale.\n";
+  }
+
+  ClockObject *clock = ClockObject::get_global_clock();
+  clock->set_mode(ClockObject::M_non_real_time);
+  clock->set_frame_rate(64.0);
+
+  PT(AnimBundle) anim = make_anim();
+  Actors actors;
+  make_actors(actors, anim);
+
+  epvector<LMatrix4> reference;
+  double base_ms = run(actors, 1, reference);
+  nout << "1 thread: " << base_ms << " ms per frame\n";
+
+  bool ok = true;
+  for (int num_threads = 2; num_threads <= max_threads; num_threads *= 2) {
+    epvector<LMatrix4> results;
+    double ms = run(actors, num_threads, results);
+    nout << num_threads << " threads: " << ms << " ms per frame, "
+         << base_ms / ms << "x\n";
+    if (!compare(reference, results)) {
+      nout << "  Results differ from the single-threaded update!\n";
+      ok = false;
+    }
+  }
+
+  Thread::prepare_for_exit();
+  return ok ? 0 : 1;
+}
@@ -11,6 +11,7 @@
 
   #define SOURCES \
     collisionBox.I collisionBox.h \
+    collisionBVH.I collisionBVH.h \
     collisionEntry.I collisionEntry.h \
     collisionGeom.I collisionGeom.h \
     collisionHandler.I collisionHandler.h  \
@@ -37,12 +38,14 @@
     collisionSolid.I collisionSolid.h \
     collisionSphere.I collisionSphere.h \
     collisionTraverser.I collisionTraverser.h  \
+    collisionTraverserWorker.I collisionTraverserWorker.h \
     collisionTube.I collisionTube.h \
     collisionVisualizer.I collisionVisualizer.h \
     config_collide.h
 
  #define INCLUDED_SOURCES \
     collisionBox.cxx \
+    collisionBVH.cxx \
     collisionEntry.cxx \
     collisionGeom.cxx \
     collisionHandler.cxx \
@@ -69,12 +72,14 @@
     collisionSolid.cxx \
     collisionSphere.cxx  \
     collisionTraverser.cxx \
+    collisionTraverserWorker.cxx \
     collisionTube.cxx \
     collisionVisualizer.cxx \
     config_collide.cxx
 
   #define INSTALL_HEADERS \
     collisionBox.I collisionBox.h \
+    collisionBVH.I collisionBVH.h \
     collisionEntry.I collisionEntry.h \
     collisionGeom.I collisionGeom.h \
     collisionHandler.I collisionHandler.h \
@@ -101,6 +106,7 @@
     collisionSolid.I collisionSolid.h \
     collisionSphere.I collisionSphere.h \
     collisionTraverser.I collisionTraverser.h \
+    collisionTraverserWorker.I collisionTraverserWorker.h \
     collisionTube.I collisionTube.h \
     collisionVisualizer.I collisionVisualizer.h \
     config_collide.h
@@ -120,3 +126,25 @@
     test_collide.cxx
 
 #end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_collision_bvh
+  #define LOCAL_LIBS \
+    p3collide
+  #define OTHER_LIBS $[OTHER_LIBS] p3pystub
+
+  #define SOURCES \
+    test_collision_bvh.cxx
+
+#end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_collision_threads
+  #define LOCAL_LIBS \
+    p3collide
+  #define OTHER_LIBS $[OTHER_LIBS] p3pystub
+
+  #define SOURCES \
+    test_collision_threads.cxx
+
+#end test_bin_target
@@ -0,0 +1,206 @@
+// Filename: collisionBVH.cxx
+// Created by:  agent (17Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "collisionBVH.h"
+#include "finiteBoundingVolume.h"
+
+#include <algorithm>
+
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionBVH::Constructor
+//       Access: Public
+//  Description: Builds a new hierarchy over the indicated list of
+//               bounding volumes, one per solid, in the order the
+//               solids appear in the CollisionNode.  Each leaf of the
+//               hierarchy will hold no more than leaf_size solids.
+////////////////////////////////////////////////////////////////////
+CollisionBVH::
+CollisionBVH(const Bounds &bounds, int leaf_size) :
+  _leaf_size(max(leaf_size, 1))
+{
+  Items items;
+  items.reserve(bounds.size());
+
+  int num_bounds = (int)bounds.size();
+  for (int i = 0; i < num_bounds; ++i) {
+    const BoundingVolume *volume = bounds[i];
+    if (volume == (BoundingVolume *)NULL) {
+      _unbounded.push_back(i);
+      continue;
+    }
+    if (volume->is_empty()) {
+      // An empty solid can never be collided with; leave it out
+      // altogether.
+      continue;
+    }
+    const FiniteBoundingVolume *fbv = volume->as_finite_bounding_volume();
+    if (volume->is_infinite() || fbv == (FiniteBoundingVolume *)NULL) {
+      _unbounded.push_back(i);
+      continue;
+    }
+
+    Item item;
+    item._min = fbv->get_min();
+    item._max = fbv->get_max();
+    item._center = (item._min + item._max) * 0.5f;
+    item._index = i;
+    items.push_back(item);
+  }
+
+  if (!items.empty()) {
+    // A balanced binary tree with leaves of at most _leaf_size items
+    // needs fewer than 2 * n / _leaf_size + 1 nodes.
+    _nodes.reserve(2 * (items.size() / _leaf_size) + 1);
+    _indices.reserve(items.size());
+    _nodes.push_back(Node());
+    r_build(0, items, 0, items.size());
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionBVH::query
+//       Access: Public
+//  Description: Fills result with the indices of all solids whose
+//               bounding box might intersect the indicated volume,
+//               plus all solids that have no finite bounding volume.
+//               The indices are returned in increasing order, so that
+//               the caller visits the solids in the same order it
+//               would have without the hierarchy.
+//
+//               If volume is NULL or infinite, all solids are
+//               returned.
+////////////////////////////////////////////////////////////////////
+void CollisionBVH::
+query(const GeometricBoundingVolume *volume, vector_int &result) const {
+  result.clear();
+
+  const FiniteBoundingVolume *fbv = NULL;
+  if (volume != (GeometricBoundingVolume *)NULL && !volume->is_infinite()) {
+    if (volume->is_empty()) {
+      return;
+    }
+    fbv = volume->as_finite_bounding_volume();
+  }
+
+  if (fbv == (FiniteBoundingVolume *)NULL) {
+    result = _indices;
+    result.insert(result.end(), _unbounded.begin(), _unbounded.end());
+    sort(result.begin(), result.end());
+    return;
+  }
+
+  result = _unbounded;
+
+  if (!_nodes.empty()) {
+    LPoint3 min_point = fbv->get_min();
+    LPoint3 max_point = fbv->get_max();
+
+    // The tree is built by median splits, so its depth is bounded by
+    // the number of bits in an int; a small fixed stack is plenty.
+    int stack[64];
+    int sp = 0;
+    stack[sp++] = 0;
+    while (sp > 0) {
+      const Node &node = _nodes[stack[--sp]];
+      if (!overlaps(node, min_point, max_point)) {
+        continue;
+      }
+      if (node._count != 0) {
+        vector_int::const_iterator begin = _indices.begin() + node._first;
+        result.insert(result.end(), begin, begin + node._count);
+      } else {
+        nassertv(sp + 2 <= 64);
+        stack[sp++] = node._first + 1;
+        stack[sp++] = node._first;
+      }
+    }
+  }
+
+  sort(result.begin(), result.end());
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionBVH::output
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+void CollisionBVH::
+output(ostream &out) const {
+  out << "CollisionBVH, " << _indices.size() << " bounded solids in "
+      << _nodes.size() << " nodes, " << _unbounded.size()
+      << " unbounded solids";
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionBVH::r_build
+//       Access: Private
+//  Description: Recursively fills in the node with the indicated
+//               index to cover items [begin, end), splitting at the
+//               median along the longest axis of the item centers.
+////////////////////////////////////////////////////////////////////
+void CollisionBVH::
+r_build(int node_index, Items &items, int begin, int end) {
+  nassertv(begin < end);
+
+  LPoint3 min_point = items[begin]._min;
+  LPoint3 max_point = items[begin]._max;
+  LPoint3 min_center = items[begin]._center;
+  LPoint3 max_center = items[begin]._center;
+  for (int i = begin + 1; i < end; ++i) {
+    const Item &item = items[i];
+    for (int j = 0; j < 3; ++j) {
+      min_point[j] = min(min_point[j], item._min[j]);
+      max_point[j] = max(max_point[j], item._max[j]);
+      min_center[j] = min(min_center[j], item._center[j]);
+      max_center[j] = max(max_center[j], item._center[j]);
+    }
+  }
+
+  // Note that _nodes may be reallocated by the recursive calls below,
+  // so we mustn't hold a reference to this node across them.
+  _nodes[node_index]._min = min_point;
+  _nodes[node_index]._max = max_point;
+
+  int count = end - begin;
+  if (count <= _leaf_size) {
+    _nodes[node_index]._first = _indices.size();
+    _nodes[node_index]._count = count;
+    for (int i = begin; i < end; ++i) {
+      _indices.push_back(items[i]._index);
+    }
+    return;
+  }
+
+  LVector3 extent = max_center - min_center;
+  int axis = 0;
+  if (extent[1] > extent[axis]) {
+    axis = 1;
+  }
+  if (extent[2] > extent[axis]) {
+    axis = 2;
+  }
+
+  int mid = begin + count / 2;
+  nth_element(items.begin() + begin, items.begin() + mid,
+              items.begin() + end, CompareCenter(axis));
+
+  int child = _nodes.size();
+  _nodes.push_back(Node());
+  _nodes.push_back(Node());
+  _nodes[node_index]._first = child;
+  _nodes[node_index]._count = 0;
+
+  r_build(child, items, begin, mid);
+  r_build(child + 1, items, mid, end);
+}
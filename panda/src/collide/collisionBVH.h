@@ -0,0 +1,113 @@
+// Filename: collisionBVH.h
+// Created by:  agent (17Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef COLLISIONBVH_H
+#define COLLISIONBVH_H
+
+#include "pandabase.h"
+
+#include "referenceCount.h"
+#include "boundingVolume.h"
+#include "geometricBoundingVolume.h"
+#include "pointerTo.h"
+#include "pvector.h"
+#include "vector_int.h"
+#include "luse.h"
+
+////////////////////////////////////////////////////////////////////
+//       Class : CollisionBVH
+// Description : An axis-aligned bounding-box hierarchy over the
+//               solids of a single CollisionNode.  This is built
+//               lazily by the CollisionNode when it contains many
+//               solids, and allows the CollisionTraverser to skip
+//               directly to the handful of solids whose bounding
+//               volumes might intersect a particular collider,
+//               instead of testing each solid's bounding volume in
+//               turn.
+//
+//               The BVH stores only solid indices; it does not hold
+//               pointers to the solids themselves.  It must be
+//               rebuilt whenever the node's list of solids changes.
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDA_COLLIDE CollisionBVH : public ReferenceCount {
+public:
+  typedef pvector< CPT(BoundingVolume) > Bounds;
+
+  CollisionBVH(const Bounds &bounds, int leaf_size);
+
+  INLINE int get_num_nodes() const;
+  INLINE int get_num_bounded() const;
+  INLINE int get_num_unbounded() const;
+
+  void query(const GeometricBoundingVolume *volume,
+             vector_int &result) const;
+
+  void output(ostream &out) const;
+
+private:
+  class Node {
+  public:
+    LPoint3 _min;
+    LPoint3 _max;
+
+    // If _count is nonzero, this is a leaf node that covers
+    // _indices[_first .. _first + _count).  Otherwise, it is an
+    // interior node whose children are _first and _first + 1.
+    int _first;
+    int _count;
+  };
+
+  class Item {
+  public:
+    LPoint3 _min;
+    LPoint3 _max;
+    LPoint3 _center;
+    int _index;
+  };
+  typedef pvector<Item> Items;
+
+  class CompareCenter {
+  public:
+    INLINE CompareCenter(int axis);
+    INLINE bool operator () (const Item &a, const Item &b) const;
+    int _axis;
+  };
+
+  void r_build(int node_index, Items &items, int begin, int end);
+  INLINE static bool overlaps(const Node &node,
+                              const LPoint3 &min_point,
+                              const LPoint3 &max_point);
+
+  typedef pvector<Node> Nodes;
+  Nodes _nodes;
+
+  // The solid indices, grouped by leaf.
+  vector_int _indices;
+
+  // Solids whose bounding volume is infinite or otherwise not a
+  // FiniteBoundingVolume (for instance, a CollisionPlane).  These
+  // are always returned by query().
+  vector_int _unbounded;
+
+  int _leaf_size;
+};
+
+INLINE ostream &operator << (ostream &out, const CollisionBVH &bvh) {
+  bvh.output(out);
+  return out;
+}
+
+#include "collisionBVH.I"
+
+#endif
@@ -30,6 +30,7 @@
 #include "boundingSphere.h"
 #include "boundingBox.h"
 #include "config_mathutil.h"
+#include "lightMutexHolder.h"
 
 TypeHandle CollisionNode::_type_handle;
 
@@ -122,6 +123,7 @@ xform(const LMatrix4 &mat) {
     solid->xform(mat);
   }
   mark_internal_bounds_stale();
+  mark_bvh_stale();
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -155,6 +157,7 @@ combine_with(PandaNode *other) {
         const COWPT(CollisionSolid) *solids_end = solids_begin + cother->_solids.size();
         _solids.insert(_solids.end(), solids_begin, solids_end);
         mark_internal_bounds_stale();
+        mark_bvh_stale();
         return this;
       }
       
@@ -313,6 +316,72 @@ set_from_collide_mask(CollideMask mask) {
   _from_collide_mask = mask;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionNode::get_bvh
+//       Access: Public
+//  Description: Returns the bounding-volume hierarchy built over this
+//               node's solids, building it first if necessary.  This
+//               is used by the CollisionTraverser to quickly find the
+//               solids that a collider might intersect.
+//
+//               Returns NULL if the node has fewer than
+//               collision-node-bvh-threshold solids, in which case
+//               it is cheaper to simply test each solid in turn.
+//
+//               A solid may be modified directly by whoever created
+//               it, without the node knowing.  So this also checks
+//               whether the bounding volume of any of its solids has
+//               changed since the hierarchy was built, and if so
+//               rebuilds it.
+////////////////////////////////////////////////////////////////////
+CPT(CollisionBVH) CollisionNode::
+get_bvh() const {
+  int threshold = collision_node_bvh_threshold;
+  if (threshold <= 0 || (int)_solids.size() < threshold) {
+    return NULL;
+  }
+
+  LightMutexHolder holder(_bvh_lock);
+
+  if (_bvh != (CollisionBVH *)NULL) {
+    nassertr(_bvh_seqs.size() == _bvh_solids.size(), NULL);
+    for (size_t i = 0; i < _bvh_solids.size(); ++i) {
+      if (_bvh_solids[i]->get_bounds_seq() != _bvh_seqs[i]) {
+        // This solid has moved or changed shape.
+        _bvh = NULL;
+        break;
+      }
+    }
+  }
+
+  if (_bvh == (CollisionBVH *)NULL) {
+    CollisionBVH::Bounds bounds;
+    bounds.reserve(_solids.size());
+    _bvh_solids.clear();
+    _bvh_solids.reserve(_solids.size());
+    _bvh_seqs.clear();
+    _bvh_seqs.reserve(_solids.size());
+    Solids::const_iterator si;
+    for (si = _solids.begin(); si != _solids.end(); ++si) {
+      CPT(CollisionSolid) solid = (*si).get_read_pointer();
+
+      // Read the sequence number before the bounds, so that a change
+      // made while we are building will be caught next time.
+      _bvh_seqs.push_back(solid->get_bounds_seq());
+      bounds.push_back(solid->get_bounds());
+      _bvh_solids.push_back(solid);
+    }
+    _bvh = new CollisionBVH(bounds, collision_node_bvh_leaf_size);
+
+    if (collide_cat.is_debug()) {
+      collide_cat.debug()
+        << "Built " << *_bvh << " for " << *this << "\n";
+    }
+  }
+
+  return _bvh;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: CollisionNode::compute_internal_bounds
 //       Access: Protected, Virtual
@@ -20,7 +20,10 @@
 #include "collisionSolid.h"
 
 #include "collideMask.h"
+#include "collisionBVH.h"
 #include "pandaNode.h"
+#include "lightMutex.h"
+#include "lightMutexHolder.h"
 
 ////////////////////////////////////////////////////////////////////
 //       Class : CollisionNode
@@ -72,6 +75,9 @@ PUBLISHED:
 
   INLINE static CollideMask get_default_collide_mask();
 
+public:
+  CPT(CollisionBVH) get_bvh() const;
+
 protected:
   virtual void compute_internal_bounds(CPT(BoundingVolume) &internal_bounds,
                                        int &internal_vertices,
@@ -80,6 +86,7 @@ protected:
 
 private:
   CPT(RenderState) get_last_pos_state();
+  INLINE void mark_bvh_stale();
 
   // This data is not cycled, for now.  We assume the collision
   // traversal will take place in App only.  Perhaps we will revisit
@@ -89,6 +96,18 @@ private:
 
   typedef pvector< COWPT(CollisionSolid) > Solids;
   Solids _solids;
+
+  // The bounding-volume hierarchy over _solids, built on demand by
+  // get_bvh() and thrown away whenever the list of solids changes.
+  // _bvh_solids records the solids it was built from, and _bvh_seqs
+  // the value of each one's get_bounds_seq() at the time; get_bvh()
+  // compares them to catch a solid that has been modified directly.
+  typedef pvector< CPT(CollisionSolid) > BVHSolids;
+  typedef pvector<AtomicAdjust::Integer> BVHSeqs;
+  mutable LightMutex _bvh_lock;
+  mutable CPT(CollisionBVH) _bvh;
+  mutable BVHSolids _bvh_solids;
+  mutable BVHSeqs _bvh_seqs;
   
 public:
   static void register_with_read_factory();
@@ -45,7 +45,7 @@ TypeHandle CollisionSolid::_type_handle;
 //  Description:
 ////////////////////////////////////////////////////////////////////
 CollisionSolid::
-CollisionSolid() : _lock("CollisionSolid") {
+CollisionSolid() : _lock("CollisionSolid"), _bounds_seq(0) {
   _flags = F_viz_geom_stale | F_tangible | F_internal_bounds_stale;
 }
 
@@ -60,7 +60,8 @@ CollisionSolid(const CollisionSolid &copy) :
   _effective_normal(copy._effective_normal),
   _internal_bounds(copy._internal_bounds),
   _flags(copy._flags),
-  _lock("CollisionSolid")
+  _lock("CollisionSolid"),
+  _bounds_seq(0)
 {
   _flags |= F_viz_geom_stale;
 }
@@ -109,6 +110,7 @@ set_bounds(const BoundingVolume &bounding_volume) {
   LightMutexHolder holder(_lock);
   ((CollisionSolid *)this)->_internal_bounds = bounding_volume.make_copy();
   ((CollisionSolid *)this)->_flags &= ~F_internal_bounds_stale;
+  AtomicAdjust::inc(_bounds_seq);
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -140,6 +142,7 @@ xform(const LMatrix4 &mat) {
   }
 
   _flags |= F_viz_geom_stale | F_internal_bounds_stale;
+  AtomicAdjust::inc(_bounds_seq);
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -26,6 +26,7 @@
 #include "lightMutex.h"
 #include "lightMutexHolder.h"
 #include "pStatCollector.h"
+#include "atomicAdjust.h"
 
 class CollisionHandler;
 class CollisionEntry;
@@ -75,6 +76,8 @@ PUBLISHED:
   void set_bounds(const BoundingVolume &bounding_volume);
   
 public:
+  INLINE AtomicAdjust::Integer get_bounds_seq() const;
+
   virtual PT(CollisionEntry)
   test_intersection(const CollisionEntry &entry) const;
 
@@ -145,6 +148,10 @@ private:
 
   LightMutex _lock;
 
+  // This is incremented whenever the bounding volume of this solid
+  // goes stale; see get_bounds_seq().
+  AtomicAdjust::Integer _bounds_seq;
+
   static PStatCollector _volume_pcollector;
   static PStatCollector _test_pcollector;
 
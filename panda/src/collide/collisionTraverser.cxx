@@ -13,6 +13,7 @@
 ////////////////////////////////////////////////////////////////////
 
 #include "collisionTraverser.h"
+#include "collisionTraverserWorker.h"
 #include "collisionNode.h"
 #include "collisionEntry.h"
 #include "collisionPolygon.h"
@@ -34,6 +35,9 @@
 #include "geomVertexReader.h"
 #include "lodNode.h"
 #include "nodePath.h"
+#include "asyncTaskManager.h"
+#include "asyncTaskChain.h"
+#include "thread.h"
 #include "pStatTimer.h"
 #include "indent.h"
 
@@ -44,6 +48,9 @@ PStatCollector CollisionTraverser::_collisions_pcollector("App:Collisions");
 PStatCollector CollisionTraverser::_cnode_volume_pcollector("Collision Volumes:CollisionNode");
 PStatCollector CollisionTraverser::_gnode_volume_pcollector("Collision Volumes:GeomNode");
 PStatCollector CollisionTraverser::_geom_volume_pcollector("Collision Volumes:Geom");
+PStatCollector CollisionTraverser::_bvh_solids_pcollector("Collision Volumes:BVH candidates");
+
+AtomicAdjust::Integer CollisionTraverser::_next_task_chain_id;
 
 TypeHandle CollisionTraverser::_type_handle;
 
@@ -72,12 +79,27 @@ public:
 CollisionTraverser::
 CollisionTraverser(const string &name) : 
   Namable(name),
+  _num_threads(0),
+  _workers_stale(true),
   _this_pcollector(_collisions_pcollector, name)
 {
   _respect_prev_transform = respect_prev_transform;
   #ifdef DO_COLLISION_RECORDING
   _recorder = (CollisionRecorder *)NULL;
   #endif
+
+  // Each traverser needs a task chain of its own, even if it shares
+  // its name with another, since the chain is removed again when the
+  // traverser is destroyed.
+  AtomicAdjust::Integer current_id = _next_task_chain_id;
+  while (AtomicAdjust::compare_and_exchange(_next_task_chain_id, current_id, current_id + 1) != current_id) {
+    current_id = _next_task_chain_id;
+  }
+  ostringstream strm;
+  strm << "collide:" << name << ":" << current_id;
+  _task_chain = strm.str();
+
+  set_num_threads(collision_traverser_threads);
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -90,6 +112,12 @@ CollisionTraverser::
   #ifdef DO_COLLISION_RECORDING
   clear_recorder();
   #endif
+
+  if (_num_threads > 1) {
+    // Stop the threads on our task chain, if we started any.
+    AsyncTaskManager *task_mgr = AsyncTaskManager::get_global_ptr();
+    task_mgr->remove_task_chain(_task_chain);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -153,6 +181,7 @@ add_collider(const NodePath &collider, CollisionHandler *handler) {
     }
   }
 
+  _workers_stale = true;
   nassertv(_ordered_colliders.size() == _colliders.size());
 }
 
@@ -197,6 +226,7 @@ remove_collider(const NodePath &collider) {
 
   nassertr(oci != _ordered_colliders.end(), false);
   _ordered_colliders.erase(oci);
+  _workers_stale = true;
 
   nassertr(_ordered_colliders.size() == _colliders.size(), false);
   return true;
@@ -267,6 +297,47 @@ clear_colliders() {
   _colliders.clear();
   _ordered_colliders.clear();
   _handlers.clear();
+  _workers_stale = true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionTraverser::set_num_threads
+//       Access: Published
+//  Description: Specifies the number of threads across which the
+//               colliders will be divided during traverse().  If
+//               this is 0 or 1 (the default), all colliders are
+//               tested in the calling thread, as always.
+//
+//               If it is greater than 1, the colliders are split into
+//               that many groups, and each group is traversed in
+//               parallel by a thread on this traverser's own
+//               AsyncTaskChain.  The detected collisions are held
+//               until all of the threads have finished, and are then
+//               delivered to the handlers in the calling thread, in
+//               a deterministic order.  Each collider's entries
+//               arrive in the same order they would have in the
+//               single-threaded traversal, so the results of
+//               CollisionHandlerQueue::sort_entries() and the
+//               physical handlers are unchanged.
+//
+//               Threaded traversal is not used while a
+//               CollisionRecorder is attached.  It is only safe if
+//               the scene graph is not modified by another thread
+//               during traverse().
+////////////////////////////////////////////////////////////////////
+void CollisionTraverser::
+set_num_threads(int num_threads) {
+  nassertv(num_threads >= 0);
+  if (num_threads == _num_threads) {
+    return;
+  }
+  if (_num_threads > 1 && num_threads <= 1) {
+    // We won't be needing our task chain any more.
+    AsyncTaskManager *task_mgr = AsyncTaskManager::get_global_ptr();
+    task_mgr->remove_task_chain(_task_chain);
+  }
+  _num_threads = num_threads;
+  _workers_stale = true;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -292,6 +363,59 @@ traverse(const NodePath &root) {
     (*hi).first->begin_group();
   }
 
+  bool threaded = (_num_threads > 1 && _ordered_colliders.size() > 1);
+#ifdef DO_COLLISION_RECORDING
+  if (has_recorder()) {
+    threaded = false;
+  }
+#endif  // DO_COLLISION_RECORDING
+
+  if (threaded) {
+    do_traverse_threaded(root);
+  } else {
+    do_traverse(root);
+  }
+
+  hi = _handlers.begin();
+  while (hi != _handlers.end()) {
+    if (!(*hi).first->end_group()) {
+      // This handler wants to remove itself from the traversal list.
+      hi = remove_handler(hi);
+    } else {
+      ++hi;
+    }
+  }
+
+  #ifdef DO_COLLISION_RECORDING
+  if (has_recorder()) {
+    get_recorder()->end_traversal();
+  }
+  #endif  // DO_COLLISION_RECORDING
+
+  CollisionLevelStateBase::_node_volume_pcollector.flush_level();
+  _cnode_volume_pcollector.flush_level();
+  _gnode_volume_pcollector.flush_level();
+  _geom_volume_pcollector.flush_level();
+  _bvh_solids_pcollector.flush_level();
+
+  CollisionSphere::flush_level();
+  CollisionTube::flush_level();
+  CollisionPolygon::flush_level();
+  CollisionPlane::flush_level();
+  CollisionBox::flush_level();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionTraverser::do_traverse
+//       Access: Private
+//  Description: Tests all of the colliders against the scene graph
+//               at root, in the current thread, and passes detected
+//               collisions to the handlers.  The caller is
+//               responsible for calling begin_group() and
+//               end_group() on the handlers.
+////////////////////////////////////////////////////////////////////
+void CollisionTraverser::
+do_traverse(const NodePath &root) {
   bool traversal_done = false;
   if ((int)_colliders.size() <= CollisionLevelStateSingle::get_max_colliders() ||
       !allow_collider_multiple) {
@@ -346,33 +470,93 @@ traverse(const NodePath &root) {
       r_traverse_quad(level_states[pass], pass);
     }
   }
+}
 
-  hi = _handlers.begin();
-  while (hi != _handlers.end()) {
-    if (!(*hi).first->end_group()) {
-      // This handler wants to remove itself from the traversal list.
-      hi = remove_handler(hi);
-    } else {
-      ++hi;
-    }
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionTraverser::do_traverse_threaded
+//       Access: Private
+//  Description: Divides the colliders among a number of
+//               CollisionTraverserWorkers, runs them in parallel on
+//               the task chain, and then passes the collisions they
+//               detected to the handlers, in order.  See
+//               set_num_threads().
+////////////////////////////////////////////////////////////////////
+void CollisionTraverser::
+do_traverse_threaded(const NodePath &root) {
+  if (_workers_stale) {
+    setup_workers();
   }
 
-  #ifdef DO_COLLISION_RECORDING
-  if (has_recorder()) {
-    get_recorder()->end_traversal();
+  // The task chain is created the first time it is needed, so that a
+  // traverser that never has more than one collider doesn't start any
+  // threads.
+  AsyncTaskManager *task_mgr = AsyncTaskManager::get_global_ptr();
+  AsyncTaskChain *chain = task_mgr->make_task_chain(_task_chain);
+  if (chain->get_num_threads() != _num_threads) {
+    chain->set_num_threads(_num_threads);
+    chain->set_thread_priority(TP_high);
   }
-  #endif  // DO_COLLISION_RECORDING
 
-  CollisionLevelStateBase::_node_volume_pcollector.flush_level();
-  _cnode_volume_pcollector.flush_level();
-  _gnode_volume_pcollector.flush_level();
-  _geom_volume_pcollector.flush_level();
+  Workers::iterator wi;
+  for (wi = _workers.begin(); wi != _workers.end(); ++wi) {
+    CollisionTraverserWorker *worker = (*wi);
+    worker->set_root(root, _respect_prev_transform);
+    worker->set_task_chain(_task_chain);
+    task_mgr->add(worker);
+  }
 
-  CollisionSphere::flush_level();
-  CollisionTube::flush_level();
-  CollisionPolygon::flush_level();
-  CollisionPlane::flush_level();
-  CollisionBox::flush_level();
+  chain->wait_for_tasks();
+
+  // Now deliver the entries in worker order.  Since each collider
+  // belongs to exactly one worker, and each worker visits the scene
+  // graph in the same order we would have, this gives each collider
+  // its entries in the same order as the single-threaded traversal.
+  for (wi = _workers.begin(); wi != _workers.end(); ++wi) {
+    (*wi)->deliver_entries();
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionTraverser::setup_workers
+//       Access: Private
+//  Description: Divides the current set of colliders, sorted by
+//               collider_sort, into _num_threads contiguous groups,
+//               one per CollisionTraverserWorker.
+////////////////////////////////////////////////////////////////////
+void CollisionTraverser::
+setup_workers() {
+  int num_colliders = _ordered_colliders.size();
+  int num_workers = min(_num_threads, num_colliders);
+
+  while ((int)_workers.size() < num_workers) {
+    ostringstream strm;
+    strm << get_name() << "-" << _workers.size();
+    _workers.push_back(new CollisionTraverserWorker(strm.str()));
+  }
+  _workers.resize(num_workers);
+
+  int *indirect = (int *)alloca(sizeof(int) * num_colliders);
+  int i;
+  for (i = 0; i < num_colliders; ++i) {
+    indirect[i] = i;
+  }
+  sort(indirect, indirect + num_colliders, SortByColliderSort(*this));
+
+  i = 0;
+  for (int w = 0; w < num_workers; ++w) {
+    CollisionTraverserWorker *worker = _workers[w];
+    worker->clear_colliders();
+
+    int end = (int)(((long long)num_colliders * (w + 1)) / num_workers);
+    for (; i < end; ++i) {
+      const NodePath &collider = _ordered_colliders[indirect[i]]._node_path;
+      Colliders::const_iterator ci = _colliders.find(collider);
+      nassertv(ci != _colliders.end());
+      worker->add_collider(collider, (*ci).second);
+    }
+  }
+
+  _workers_stale = false;
 }
 
 #ifdef DO_COLLISION_RECORDING
@@ -1192,6 +1376,30 @@ compare_collider_to_node(CollisionEntry &entry,
     collide_cat.spam()
       << "Colliding against CollisionNode " << entry._into_node
       << " which has " << num_solids << " collision solids.\n";
+
+    CPT(CollisionBVH) bvh = cnode->get_bvh();
+    if (bvh != (CollisionBVH *)NULL) {
+      // The node has many solids; let its bounding-volume hierarchy
+      // tell us which of them are worth looking at.  The candidates
+      // are still tested against their own bounding volumes, since
+      // the hierarchy only knows their axis-aligned boxes.
+      vector_int candidates;
+      bvh->query(from_node_gbv, candidates);
+      _bvh_solids_pcollector.add_level(candidates.size());
+
+      vector_int::const_iterator ci;
+      for (ci = candidates.begin(); ci != candidates.end(); ++ci) {
+        entry._into = cnode->get_solid(*ci);
+        CPT(BoundingVolume) solid_bv = entry._into->get_bounds();
+        const GeometricBoundingVolume *solid_gbv = NULL;
+        if (solid_bv->is_of_type(GeometricBoundingVolume::get_class_type())) {
+          DCAST_INTO_V(solid_gbv, solid_bv);
+        }
+        compare_collider_to_solid(entry, from_node_gbv, solid_gbv);
+      }
+      return;
+    }
+
     for (int s = 0; s < num_solids; ++s) {
       entry._into = cnode->get_solid(s);
 
@@ -1407,6 +1615,8 @@ CollisionTraverser::Handlers::iterator CollisionTraverser::
 remove_handler(CollisionTraverser::Handlers::iterator hi) {
   nassertr(hi != _handlers.end(), hi);
 
+  _workers_stale = true;
+
   CollisionHandler *handler = (*hi).first;
   Handlers::iterator hnext = hi;
   ++hnext;
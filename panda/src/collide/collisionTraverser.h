@@ -24,9 +24,11 @@
 #include "pStatCollector.h"
 
 #include "pset.h"
+#include "atomicAdjust.h"
 #include "register_type.h"
 
 class CollisionNode;
+class CollisionTraverserWorker;
 class CollisionRecorder;
 class CollisionVisualizer;
 class Geom;
@@ -63,6 +65,9 @@ PUBLISHED:
   CollisionHandler *get_handler(const NodePath &collider) const;
   void clear_colliders();
 
+  void set_num_threads(int num_threads);
+  INLINE int get_num_threads() const;
+
   void traverse(const NodePath &root);
 
 #ifdef DO_COLLISION_RECORDING
@@ -79,6 +84,10 @@ PUBLISHED:
   void write(ostream &out, int indent_level) const;
 
 private:
+  void do_traverse(const NodePath &root);
+  void do_traverse_threaded(const NodePath &root);
+  void setup_workers();
+
   typedef pvector<CollisionLevelStateSingle> LevelStatesSingle;
   void prepare_colliders_single(LevelStatesSingle &level_states, const NodePath &root);
   void r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass);
@@ -129,6 +138,16 @@ private:
   Handlers::iterator remove_handler(Handlers::iterator hi);
 
   bool _respect_prev_transform;
+
+  // These are used only when _num_threads is greater than 1; see
+  // set_num_threads().
+  int _num_threads;
+  string _task_chain;
+  static AtomicAdjust::Integer _next_task_chain_id;
+  typedef pvector< PT(CollisionTraverserWorker) > Workers;
+  Workers _workers;
+  bool _workers_stale;
+
 #ifdef DO_COLLISION_RECORDING
   CollisionRecorder *_recorder;
   NodePath _collision_visualizer_np;
@@ -140,6 +159,7 @@ private:
   static PStatCollector _cnode_volume_pcollector;
   static PStatCollector _gnode_volume_pcollector;
   static PStatCollector _geom_volume_pcollector;
+  static PStatCollector _bvh_solids_pcollector;
 
   PStatCollector _this_pcollector;
   typedef pvector<PStatCollector> PassCollectors;
@@ -160,6 +180,7 @@ private:
   static TypeHandle _type_handle;
 
   friend class SortByColliderSort;
+  friend class CollisionTraverserWorker;
 };
 
 INLINE ostream &operator << (ostream &out, const CollisionTraverser &trav) {
@@ -0,0 +1,138 @@
+// Filename: collisionTraverserWorker.cxx
+// Created by:  agent (17Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "collisionTraverserWorker.h"
+
+TypeHandle CollisionTraverserWorker::_type_handle;
+
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionTraverserWorker::Constructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+CollisionTraverserWorker::
+CollisionTraverserWorker(const string &name) :
+  AsyncTask(name),
+  _trav(name)
+{
+  // Our private traverser must never try to spread its own work
+  // across threads.
+  _trav.set_num_threads(0);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionTraverserWorker::clear_colliders
+//       Access: Public
+//  Description: Removes all colliders from this worker.
+////////////////////////////////////////////////////////////////////
+void CollisionTraverserWorker::
+clear_colliders() {
+  _trav.clear_colliders();
+  _buffers.clear();
+  _deliveries.clear();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionTraverserWorker::add_collider
+//       Access: Public
+//  Description: Assigns the indicated collider to this worker.  Its
+//               collisions will eventually be delivered to the
+//               indicated handler.
+////////////////////////////////////////////////////////////////////
+void CollisionTraverserWorker::
+add_collider(const NodePath &collider, CollisionHandler *handler) {
+  Buffers::iterator bi = _buffers.find(handler);
+  if (bi == _buffers.end()) {
+    PT(BufferHandler) buffer = new BufferHandler(this, handler);
+    bi = _buffers.insert(Buffers::value_type(handler, buffer)).first;
+  }
+  _trav.add_collider(collider, (*bi).second);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionTraverserWorker::deliver_entries
+//       Access: Public
+//  Description: Passes all of the entries detected by the last run
+//               of the task on to their real handlers, in the order
+//               they were detected, and empties the buffer.  This
+//               must be called in the thread that owns the handlers,
+//               after the task has finished.
+////////////////////////////////////////////////////////////////////
+void CollisionTraverserWorker::
+deliver_entries() {
+  Deliveries::const_iterator di;
+  for (di = _deliveries.begin(); di != _deliveries.end(); ++di) {
+    (*di)._target->add_entry((*di)._entry);
+  }
+  _deliveries.clear();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionTraverserWorker::do_task
+//       Access: Protected, Virtual
+//  Description: Traverses the scene graph with this worker's subset
+//               of the colliders.
+////////////////////////////////////////////////////////////////////
+AsyncTask::DoneStatus CollisionTraverserWorker::
+do_task() {
+  Buffers::iterator bi;
+  for (bi = _buffers.begin(); bi != _buffers.end(); ++bi) {
+    (*bi).second->update(_root);
+  }
+
+  _trav.do_traverse(_root);
+  _root.clear();
+
+  return DS_done;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionTraverserWorker::BufferHandler::Constructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+CollisionTraverserWorker::BufferHandler::
+BufferHandler(CollisionTraverserWorker *worker, CollisionHandler *target) :
+  _worker(worker),
+  _target(target)
+{
+  _wants_all_potential_collidees = target->wants_all_potential_collidees();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionTraverserWorker::BufferHandler::update
+//       Access: Public
+//  Description: Copies the relevant settings from the real handler
+//               before a traversal.
+////////////////////////////////////////////////////////////////////
+void CollisionTraverserWorker::BufferHandler::
+update(const NodePath &root) {
+  _wants_all_potential_collidees = _target->wants_all_potential_collidees();
+  set_root(root);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: CollisionTraverserWorker::BufferHandler::add_entry
+//       Access: Public, Virtual
+//  Description: Called by the worker's traverser, in the task thread,
+//               for each collision detected.  Records the entry for
+//               later delivery.
+////////////////////////////////////////////////////////////////////
+void CollisionTraverserWorker::BufferHandler::
+add_entry(CollisionEntry *entry) {
+  Delivery delivery;
+  delivery._target = _target;
+  delivery._entry = entry;
+  _worker->_deliveries.push_back(delivery);
+}
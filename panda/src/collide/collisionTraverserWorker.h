@@ -0,0 +1,106 @@
+// Filename: collisionTraverserWorker.h
+// Created by:  agent (17Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef COLLISIONTRAVERSERWORKER_H
+#define COLLISIONTRAVERSERWORKER_H
+
+#include "pandabase.h"
+
+#include "asyncTask.h"
+#include "collisionTraverser.h"
+#include "collisionHandler.h"
+#include "collisionEntry.h"
+#include "nodePath.h"
+#include "pointerTo.h"
+#include "pvector.h"
+#include "pmap.h"
+
+////////////////////////////////////////////////////////////////////
+//       Class : CollisionTraverserWorker
+// Description : This is an internal class used by a
+//               CollisionTraverser that has been asked to use more
+//               than one thread.  Each worker owns a subset of the
+//               traverser's colliders, and traverses the scene graph
+//               with just those colliders in a task thread.
+//
+//               The collisions it detects are not delivered to the
+//               real handlers right away, since the handlers are not
+//               thread-safe; instead, they are saved in the order
+//               they were detected, to be passed on by
+//               deliver_entries() once all workers are done.
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDA_COLLIDE CollisionTraverserWorker : public AsyncTask {
+public:
+  ALLOC_DELETED_CHAIN(CollisionTraverserWorker);
+
+  CollisionTraverserWorker(const string &name);
+
+  void clear_colliders();
+  void add_collider(const NodePath &collider, CollisionHandler *handler);
+  INLINE void set_root(const NodePath &root, bool respect_prev_transform);
+
+  void deliver_entries();
+
+protected:
+  virtual DoneStatus do_task();
+
+private:
+  // This handler stands in for a real handler within our private
+  // traverser, and simply records each entry for later delivery.
+  class BufferHandler : public CollisionHandler {
+  public:
+    BufferHandler(CollisionTraverserWorker *worker,
+                  CollisionHandler *target);
+    void update(const NodePath &root);
+    virtual void add_entry(CollisionEntry *entry);
+
+    CollisionTraverserWorker *_worker;
+    CollisionHandler *_target;
+  };
+
+  class Delivery {
+  public:
+    CollisionHandler *_target;
+    PT(CollisionEntry) _entry;
+  };
+  typedef pvector<Delivery> Deliveries;
+  Deliveries _deliveries;
+
+  typedef pmap<CollisionHandler *, PT(BufferHandler) > Buffers;
+  Buffers _buffers;
+
+  CollisionTraverser _trav;
+  NodePath _root;
+
+public:
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    AsyncTask::init_type();
+    register_type(_type_handle, "CollisionTraverserWorker",
+                  AsyncTask::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "collisionTraverserWorker.I"
+
+#endif
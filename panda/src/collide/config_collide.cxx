@@ -39,6 +39,7 @@
 #include "collisionSolid.h"
 #include "collisionSphere.h"
 #include "collisionTraverser.h"
+#include "collisionTraverserWorker.h"
 #include "collisionTube.h"
 #include "collisionVisualizer.h"
 #include "dconfig.h"
@@ -108,6 +109,29 @@ ConfigVariableBool pushers_horizontal
           "set_horizontal() flag by default, false to let the move "
           "in three dimensions by default."));
 
+ConfigVariableInt collision_node_bvh_threshold
+("collision-node-bvh-threshold", 16,
+ PRC_DESC("A CollisionNode with at least this many solids will build an "
+          "internal bounding-volume hierarchy over its solids, so that the "
+          "CollisionTraverser need only visit those solids whose bounding "
+          "boxes overlap each collider, rather than testing every solid in "
+          "turn.  The hierarchy is rebuilt lazily whenever solids are "
+          "added, removed, or modified.  Set this to 0 to disable the "
+          "hierarchy altogether."));
+
+ConfigVariableInt collision_node_bvh_leaf_size
+("collision-node-bvh-leaf-size", 4,
+ PRC_DESC("The maximum number of solids stored in each leaf of a "
+          "CollisionNode's bounding-volume hierarchy.  See "
+          "collision-node-bvh-threshold."));
+
+ConfigVariableInt collision_traverser_threads
+("collision-traverser-threads", 0,
+ PRC_DESC("The default number of threads across which each new "
+          "CollisionTraverser divides its colliders.  If this is 0 or 1, "
+          "collisions are detected in the calling thread only.  See "
+          "CollisionTraverser::set_num_threads()."));
+
 ////////////////////////////////////////////////////////////////////
 //     Function: init_libcollide
 //  Description: Initializes the library.  This must be called at
@@ -149,6 +173,7 @@ init_libcollide() {
   CollisionSolid::init_type();
   CollisionSphere::init_type();
   CollisionTraverser::init_type();
+  CollisionTraverserWorker::init_type();
   CollisionTube::init_type();
 
 #ifdef DO_COLLISION_RECORDING
@@ -31,6 +31,9 @@ extern EXPCL_PANDA_COLLIDE ConfigVariableDouble collision_parabola_bounds_thresh
 extern EXPCL_PANDA_COLLIDE ConfigVariableInt collision_parabola_bounds_sample;
 extern EXPCL_PANDA_COLLIDE ConfigVariableInt fluid_cap_amount;
 extern EXPCL_PANDA_COLLIDE ConfigVariableBool pushers_horizontal;
+extern EXPCL_PANDA_COLLIDE ConfigVariableInt collision_node_bvh_threshold;
+extern EXPCL_PANDA_COLLIDE ConfigVariableInt collision_node_bvh_leaf_size;
+extern EXPCL_PANDA_COLLIDE ConfigVariableInt collision_traverser_threads;
 
 extern EXPCL_PANDA_COLLIDE void init_libcollide();
 
@@ -1,5 +1,6 @@
 #include "config_collide.cxx"
 #include "collisionBox.cxx"
+#include "collisionBVH.cxx"
 #include "collisionEntry.cxx"
 #include "collisionGeom.cxx"
 #include "collisionHandler.cxx"
@@ -10,5 +10,6 @@
 #include "collisionSolid.cxx"
 #include "collisionSphere.cxx"
 #include "collisionTraverser.cxx"
+#include "collisionTraverserWorker.cxx"
 #include "collisionTube.cxx"
 #include "collisionVisualizer.cxx"
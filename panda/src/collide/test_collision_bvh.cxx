@@ -0,0 +1,209 @@
+// Filename: test_collision_bvh.cxx
+// Created by:  agent (17Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pandabase.h"
+#include "collisionTraverser.h"
+#include "collisionNode.h"
+#include "collisionPolygon.h"
+#include "collisionSphere.h"
+#include "collisionRay.h"
+#include "collisionHandlerQueue.h"
+#include "config_collide.h"
+#include "nodePath.h"
+#include "pandaNode.h"
+#include "load_prc_file.h"
+#include "trueClock.h"
+#include "randomizer.h"
+
+#include <algorithm>
+
+// This program measures the cost of colliding a number of moving
+// spheres and rays with a single CollisionNode containing a large
+// grid of polygons, first with the CollisionNode's bounding-volume
+// hierarchy disabled, and then with it enabled.  It also verifies
+// that both modes detect exactly the same collisions, in the same
+// order: the same from node, into solid and surface point for each
+// entry.
+//
+// The CollisionNode also contains a number of spheres, which are
+// moved each frame with CollisionSphere::set_center(), through the
+// pointers kept when they were added, to check that the hierarchy
+// notices when its solids are modified directly, and that the
+// hierarchies of other nodes don't.
+
+// The grid is grid_size x grid_size cells, each of which is split
+// into two triangles.
+static const int grid_size = 71;
+
+static const int num_balls = 20;
+static const int num_spheres = 50;
+static const int num_rays = 50;
+static const int num_frames = 50;
+
+typedef pvector< PT(CollisionSphere) > Balls;
+
+// One detected collision.  The from node is identified by its index
+// among the movers, since each run makes its own.
+class EntryRecord {
+public:
+  int _from_index;
+  const CollisionSolid *_into;
+  bool _has_point;
+  LPoint3 _point;
+
+  bool operator == (const EntryRecord &other) const {
+    return (_from_index == other._from_index &&
+            _into == other._into &&
+            _has_point == other._has_point &&
+            (!_has_point || _point.almost_equal(other._point)));
+  }
+};
+typedef pvector<EntryRecord> EntryRecords;
+
+static NodePath
+make_world(Balls &balls) {
+  PT(CollisionNode) cnode = new CollisionNode("world");
+  for (int yi = 0; yi < grid_size; ++yi) {
+    for (int xi = 0; xi < grid_size; ++xi) {
+      LPoint3 a(xi, yi, 0), b(xi + 1, yi, 0);
+      LPoint3 c(xi + 1, yi + 1, 0), d(xi, yi + 1, 0);
+      cnode->add_solid(new CollisionPolygon(a, b, c));
+      cnode->add_solid(new CollisionPolygon(a, c, d));
+    }
+  }
+  for (int i = 0; i < num_balls; ++i) {
+    PT(CollisionSphere) ball = new CollisionSphere(0, 0, -10, 1.5f);
+    cnode->add_solid(ball);
+    balls.push_back(ball);
+  }
+  cnode->set_from_collide_mask(CollideMask::all_off());
+
+  NodePath render("render");
+  render.attach_new_node(cnode);
+  return render;
+}
+
+static void
+run(NodePath render, Balls &balls, const char *label,
+    EntryRecords &records) {
+  CollisionTraverser trav("bvh");
+  PT(CollisionHandlerQueue) queue = new CollisionHandlerQueue;
+
+  Randomizer random(1);
+  pvector<NodePath> movers;
+  for (int i = 0; i < num_spheres + num_rays; ++i) {
+    PT(CollisionNode) cnode = new CollisionNode("mover");
+    if (i < num_spheres) {
+      cnode->add_solid(new CollisionSphere(0, 0, 0, 0.75f));
+    } else {
+      cnode->add_solid(new CollisionRay(0, 0, 1, 0, 0, -1));
+    }
+    cnode->set_into_collide_mask(CollideMask::all_off());
+    NodePath np = render.attach_new_node(cnode);
+    movers.push_back(np);
+    trav.add_collider(np, queue);
+  }
+
+  TrueClock *clock = TrueClock::get_global_ptr();
+  double total_time = 0.0;
+
+  for (int frame = 0; frame < num_frames; ++frame) {
+    pvector<NodePath>::iterator mi;
+    for (mi = movers.begin(); mi != movers.end(); ++mi) {
+      (*mi).set_pos(random.random_real(grid_size),
+                    random.random_real(grid_size),
+                    random.random_real(1.0));
+    }
+    Balls::iterator bi;
+    for (bi = balls.begin(); bi != balls.end(); ++bi) {
+      (*bi)->set_center(random.random_real(grid_size),
+                        random.random_real(grid_size),
+                        random.random_real(2.0));
+    }
+
+    double start = clock->get_short_time();
+    trav.traverse(render);
+    total_time += clock->get_short_time() - start;
+
+    for (int i = 0; i < queue->get_num_entries(); ++i) {
+      CollisionEntry *entry = queue->get_entry(i);
+      EntryRecord record;
+      NodePath from = entry->get_from_node_path();
+      record._from_index = (int)(find(movers.begin(), movers.end(), from) - movers.begin());
+      record._into = entry->get_into();
+      record._has_point = entry->has_surface_point();
+      if (record._has_point) {
+        record._point = entry->get_surface_point(render);
+      }
+      records.push_back(record);
+    }
+  }
+
+  // Clean up the colliders, so that the world can be reused.
+  pvector<NodePath>::iterator mi;
+  for (mi = movers.begin(); mi != movers.end(); ++mi) {
+    (*mi).remove_node();
+  }
+
+  nout << label << ": " << total_time * 1000.0 / num_frames
+       << " ms per traversal, " << records.size() << " entries.\n";
+}
+
+int
+main(int argc, char *argv[]) {
+  Balls balls;
+  NodePath render = make_world(balls);
+  nout << grid_size * grid_size * 2 << " polygons, " << num_balls
+       << " moving balls, " << num_spheres << " spheres, " << num_rays
+       << " rays, " << num_frames << " frames.\n";
+
+  EntryRecords linear_records, bvh_records;
+  load_prc_file_data("", "collision-node-bvh-threshold 0");
+  run(render, balls, "linear", linear_records);
+
+  load_prc_file_data("", "collision-node-bvh-threshold 16");
+  run(render, balls, "bvh", bvh_records);
+
+  if (linear_records.size() != bvh_records.size()) {
+    nout << "Mismatch: " << linear_records.size() << " entries vs. "
+         << bvh_records.size() << "\n";
+    return 1;
+  }
+  for (size_t i = 0; i < linear_records.size(); ++i) {
+    if (!(linear_records[i] == bvh_records[i])) {
+      nout << "Mismatch at entry " << i << "\n";
+      return 1;
+    }
+  }
+
+  // Moving a solid should rebuild the hierarchy of the node that owns
+  // it, but not that of any other node.
+  CollisionNode *world = DCAST(CollisionNode, render.find("world").node());
+  PT(CollisionNode) bystander = new CollisionNode("bystander");
+  for (int i = 0; i < 32; ++i) {
+    bystander->add_solid(new CollisionSphere(i * 4, 0, 0, 1));
+  }
+  CPT(CollisionBVH) world_bvh = world->get_bvh();
+  CPT(CollisionBVH) bystander_bvh = bystander->get_bvh();
+  balls[0]->set_center(1, 1, 1);
+  if (world->get_bvh() == world_bvh) {
+    nout << "Hierarchy not rebuilt after its solid moved\n";
+    return 1;
+  }
+  if (bystander->get_bvh() != bystander_bvh) {
+    nout << "Hierarchy rebuilt after another node's solid moved\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,167 @@
+// Filename: test_collision_threads.cxx
+// Created by:  agent (17Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pandabase.h"
+#include "collisionTraverser.h"
+#include "collisionNode.h"
+#include "collisionPolygon.h"
+#include "collisionSphere.h"
+#include "collisionRay.h"
+#include "collisionHandlerQueue.h"
+#include "nodePath.h"
+#include "pandaNode.h"
+#include "thread.h"
+#include "trueClock.h"
+#include "randomizer.h"
+#include "pmap.h"
+
+// This program measures how CollisionTraverser::traverse() scales
+// with set_num_threads(), using several hundred spheres and rays
+// against a field of polygon-filled CollisionNodes.  It also checks
+// that, with every thread count, each collider receives exactly the
+// same collisions, in the same order, as in the single-threaded
+// traversal.  (The entries of different colliders may be interleaved
+// differently, so the queue as a whole is not compared.)
+
+static const int grid_size = 8;
+static const int polys_per_cell = 200;
+static const int num_colliders = 400;
+static const int num_frames = 20;
+
+static NodePath
+make_world() {
+  NodePath render("render");
+  Randomizer random(2);
+  for (int yi = 0; yi < grid_size; ++yi) {
+    for (int xi = 0; xi < grid_size; ++xi) {
+      PT(CollisionNode) cnode = new CollisionNode("cell");
+      for (int i = 0; i < polys_per_cell; ++i) {
+        LPoint3 a(xi * 10 + random.random_real(10),
+                  yi * 10 + random.random_real(10),
+                  random.random_real(2));
+        cnode->add_solid(new CollisionPolygon(a, a + LVector3(1, 0, 0),
+                                              a + LVector3(0, 1, 0)));
+      }
+      cnode->set_from_collide_mask(CollideMask::all_off());
+      render.attach_new_node(cnode);
+    }
+  }
+  return render;
+}
+
+typedef pmap<PandaNode *, int> MoverIndex;
+
+// Returns a printable digest of one frame's collisions, for
+// comparing the results of different thread counts.  The entries are
+// listed in the order they were delivered, grouped by collider.
+static string
+describe(CollisionHandlerQueue *queue, const MoverIndex &mover_index) {
+  pvector<string> by_mover(mover_index.size());
+  int num_entries = queue->get_num_entries();
+  for (int i = 0; i < num_entries; ++i) {
+    CollisionEntry *entry = queue->get_entry(i);
+    MoverIndex::const_iterator mi = mover_index.find(entry->get_from_node());
+    nassertr(mi != mover_index.end(), string());
+
+    ostringstream strm;
+    strm << (*mi).second << " " << entry->get_into() << " "
+         << entry->get_surface_point(entry->get_into_node_path()) << "\n";
+    by_mover[(*mi).second] += strm.str();
+  }
+
+  string result;
+  for (size_t i = 0; i < by_mover.size(); ++i) {
+    result += by_mover[i];
+  }
+  return result;
+}
+
+static double
+run(NodePath render, int num_threads, pvector<string> &results) {
+  CollisionTraverser trav("threads");
+  trav.set_num_threads(num_threads);
+  PT(CollisionHandlerQueue) queue = new CollisionHandlerQueue;
+
+  Randomizer random(1);
+  pvector<NodePath> movers;
+  MoverIndex mover_index;
+  for (int i = 0; i < num_colliders; ++i) {
+    PT(CollisionNode) cnode = new CollisionNode("mover");
+    if ((i & 1) == 0) {
+      cnode->add_solid(new CollisionSphere(0, 0, 0, 1.0f));
+    } else {
+      cnode->add_solid(new CollisionRay(0, 0, 3, 0, 0, -1));
+    }
+    cnode->set_into_collide_mask(CollideMask::all_off());
+    NodePath np = render.attach_new_node(cnode);
+    mover_index[cnode] = i;
+    movers.push_back(np);
+    trav.add_collider(np, queue);
+  }
+
+  TrueClock *clock = TrueClock::get_global_ptr();
+  double total_time = 0.0;
+  for (int frame = 0; frame < num_frames; ++frame) {
+    pvector<NodePath>::iterator mi;
+    for (mi = movers.begin(); mi != movers.end(); ++mi) {
+      (*mi).set_pos(random.random_real(grid_size * 10),
+                    random.random_real(grid_size * 10),
+                    random.random_real(2));
+    }
+
+    double start = clock->get_short_time();
+    trav.traverse(render);
+    total_time += clock->get_short_time() - start;
+    results.push_back(describe(queue, mover_index));
+  }
+
+  pvector<NodePath>::iterator mi;
+  for (mi = movers.begin(); mi != movers.end(); ++mi) {
+    (*mi).remove_node();
+  }
+
+  return total_time * 1000.0 / num_frames;
+}
+
+int
+main(int argc, char *argv[]) {
+  int max_threads = 8;
+  if (argc > 1) {
+    max_threads = atoi(argv[1]);
+  }
+  if (!Thread::is_threading_supported()) {
+    nout << "Threading support is not compiled in; results will not scale.\n";
+  }
+
+  NodePath render = make_world();
+
+  pvector<string> reference;
+  double base_ms = run(render, 1, reference);
+  nout << "1 thread: " << base_ms << " ms per traversal\n";
+
+  bool ok = true;
+  for (int num_threads = 2; num_threads <= max_threads; num_threads *= 2) {
+    pvector<string> results;
+    double ms = run(render, num_threads, results);
+    nout << num_threads << " threads: " << ms << " ms per traversal, "
+         << base_ms / ms << "x\n";
+    if (results != reference) {
+      nout << "  Results differ from the single-threaded traversal!\n";
+      ok = false;
+    }
+  }
+
+  Thread::prepare_for_exit();
+  return ok ? 0 : 1;
+}
@@ -30,6 +30,17 @@ ConfigureFn(config_cull) {
   init_libcull();
 }
 
+ConfigVariableBool cull_instancing
+("cull-instancing", false,
+ PRC_DESC("Set this true to have the state-sorted cull bins collect "
+          "objects that share the same Geom and the same state, and "
+          "differ only in their transform, so that the GSG can draw "
+          "all of them with a single call.  This can greatly reduce "
+          "the per-object overhead of drawing scenes with many copies "
+          "of the same model, such as forests and crowds.  Note that the "
+          "objects within a bin are then sorted by state before "
+          "transform, which changes the order in which they are drawn."));
+
 ////////////////////////////////////////////////////////////////////
 //     Function: init_libcull
 //  Description: Initializes the library.  This must be called at
@@ -71,7 +71,11 @@ add_object(CullableObject *object, Thread *current_thread) {
 void CullBinStateSorted::
 finish_cull(SceneSetup *, Thread *current_thread) {
   PStatTimer timer(_cull_this_pcollector, current_thread);
-  sort(_objects.begin(), _objects.end());
+  if (_instancing) {
+    sort(_objects.begin(), _objects.end(), CompareInstances());
+  } else {
+    sort(_objects.begin(), _objects.end());
+  }
 }
 
 
@@ -84,10 +88,45 @@ finish_cull(SceneSetup *, Thread *current_thread) {
 void CullBinStateSorted::
 draw(bool force, Thread *current_thread) {
   PStatTimer timer(_draw_this_pcollector, current_thread);
-  Objects::const_iterator oi;
-  for (oi = _objects.begin(); oi != _objects.end(); ++oi) {
+  if (!_instancing) {
+    Objects::const_iterator oi;
+    for (oi = _objects.begin(); oi != _objects.end(); ++oi) {
+      CullableObject *object = (*oi)._object;
+      CullHandler::draw(object, _gsg, force, current_thread);
+    }
+    return;
+  }
+
+  // The objects have been sorted so that all of the instances of a
+  // particular Geom are adjacent; draw each run of them at once.
+  Objects::const_iterator oi = _objects.begin();
+  while (oi != _objects.end()) {
+    Objects::const_iterator oj = oi + 1;
+    while (oj != _objects.end() && (*oi).can_instance(*oj)) {
+      ++oj;
+    }
+
     CullableObject *object = (*oi)._object;
-    CullHandler::draw(object, _gsg, force, current_thread);
+    bool drawn = false;
+    if (oj - oi > 1) {
+      _transforms.clear();
+      Objects::const_iterator ok;
+      for (ok = oi; ok != oj; ++ok) {
+        _transforms.push_back((*ok)._object->_internal_transform);
+      }
+      drawn = _gsg->draw_geom_instances(object->_geom, object->_munger,
+                                        object->_munged_data, object->_state,
+                                        &_transforms[0], (int)_transforms.size(),
+                                        force, current_thread);
+    }
+
+    if (!drawn) {
+      // The GSG can't draw these together; draw them one at a time.
+      for (; oi != oj; ++oi) {
+        CullHandler::draw((*oi)._object, _gsg, force, current_thread);
+      }
+    }
+    oi = oj;
   }
 }
 
@@ -23,6 +23,7 @@
 #include "transformState.h"
 #include "renderState.h"
 #include "pointerTo.h"
+#include "config_cull.h"
 
 ////////////////////////////////////////////////////////////////////
 //       Class : CullBinStateSorted
@@ -35,6 +36,11 @@
 //               particular state, to take advantage of hierarchical
 //               Z-buffer algorithms which can early-out when an
 //               object appears behind another one.
+//
+//               If cull-instancing is enabled, objects that share
+//               the same Geom and state are also collected together,
+//               and each such group is drawn with a single call to
+//               GraphicsStateGuardianBase::draw_geom_instances().
 ////////////////////////////////////////////////////////////////////
 class EXPCL_PANDA_CULL CullBinStateSorted : public CullBin {
 public:
@@ -59,13 +65,24 @@ private:
   public:
     INLINE ObjectData(CullableObject *object);
     INLINE bool operator < (const ObjectData &other) const;
+    INLINE bool can_instance(const ObjectData &other) const;
     
     CullableObject *_object;
   };
 
+  class CompareInstances {
+  public:
+    INLINE bool operator () (const ObjectData &a, const ObjectData &b) const;
+  };
+
   typedef pvector<ObjectData> Objects;
   Objects _objects;
 
+  typedef pvector<const TransformState *> Transforms;
+  Transforms _transforms;
+
+  bool _instancing;
+
 public:
   static TypeHandle get_class_type() {
     return _type_handle;
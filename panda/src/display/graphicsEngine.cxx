@@ -131,6 +131,16 @@ GraphicsEngine::
 GraphicsEngine(Pipeline *pipeline) :
   _pipeline(pipeline),
   _app("app"),
+  _cull_batch_lock("GraphicsEngine::_cull_batch_lock"),
+  _cull_jobs_lock("GraphicsEngine::_cull_jobs_lock"),
+  _cv_cull_jobs(_cull_jobs_lock),
+  _cv_cull_done(_cull_jobs_lock),
+  _cull_jobs(NULL),
+  _next_cull_job(0),
+  _cull_jobs_pending(0),
+  _cull_jobs_stage(0),
+  _cull_jobs_num_workers(0),
+  _cull_workers_terminate(false),
   _lock("GraphicsEngine::_lock"),
   _loaded_textures_lock("GraphicsEngine::_loaded_textures_lock")
 {
@@ -152,7 +162,7 @@ GraphicsEngine(Pipeline *pipeline) :
   _flip_state = FS_flip;
 
   _singular_warning_last_frame = false;
-  _singular_warning_this_frame = false;
+  _singular_warning_this_frame = 0;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -1477,16 +1487,35 @@ void GraphicsEngine::
 cull_to_bins(const GraphicsEngine::Windows &wlist, Thread *current_thread) {
   PStatTimer timer(_cull_pcollector, current_thread);
 
-  _singular_warning_last_frame = _singular_warning_this_frame;
-  _singular_warning_this_frame = false;
+  _singular_warning_last_frame =
+    (AtomicAdjust::set(_singular_warning_this_frame, 0) != 0);
 
   // Keep track of the cameras we have already used in this thread to
   // render DisplayRegions.
   typedef pmap<NodePath, DisplayRegion *> AlreadyCulled;
   AlreadyCulled already_culled;
 
+  // If any of the windows wants to be culled by more than one thread,
+  // we collect the DisplayRegions first and cull them all at once
+  // below.  Otherwise, we cull each one as we come to it.
+  int num_threads = 1;
   size_t wlist_size = wlist.size();
-  for (size_t wi = 0; wi < wlist_size; ++wi) {
+  size_t wi;
+  for (wi = 0; wi < wlist_size; ++wi) {
+    GraphicsOutput *win = wlist[wi];
+    if (win->is_active() && win->get_gsg()->is_active()) {
+      num_threads = max(num_threads, win->get_gsg()->get_threading_model().get_cull_num_threads());
+    }
+  }
+  bool parallel = (num_threads > 1 && Thread::is_threading_supported());
+  CullJobs jobs;
+
+  // These DisplayRegions share a camera with one that is culled in
+  // this thread; they will share its result once it is ready.
+  typedef pvector<CullJob> SharedJobs;
+  SharedJobs shared;
+
+  for (wi = 0; wi < wlist_size; ++wi) {
     GraphicsOutput *win = wlist[wi];
     if (win->is_active() && win->get_gsg()->is_active()) {
       PStatTimer timer(win->get_cull_window_pcollector(), current_thread);
@@ -1494,17 +1523,24 @@ cull_to_bins(const GraphicsEngine::Windows &wlist, Thread *current_thread) {
       for (int i = 0; i < num_display_regions; ++i) {
         DisplayRegion *dr = win->get_active_display_region(i);
         if (dr != (DisplayRegion *)NULL) {
-          DisplayRegionPipelineReader *dr_reader =
-            new DisplayRegionPipelineReader(dr, current_thread);
-          NodePath camera = dr_reader->get_camera();
+          NodePath camera;
+          {
+            DisplayRegionPipelineReader dr_reader(dr, current_thread);
+            camera = dr_reader.get_camera();
+          }
           AlreadyCulled::iterator aci = already_culled.insert(AlreadyCulled::value_type(camera, (DisplayRegion *)NULL)).first;
+          CullJob job;
+          job._win = win;
+          job._dr = dr;
           if ((*aci).second == NULL) {
             // We have not used this camera already in this thread.
             // Perform the cull operation.
-            delete dr_reader;
-            dr_reader = NULL;
             (*aci).second = dr;
-            cull_to_bins(win, dr, current_thread);
+            if (parallel) {
+              jobs.push_back(job);
+            } else {
+              cull_to_bins(win, dr, current_thread);
+            }
 
           } else {
             // We have already culled a scene using this camera in
@@ -1513,20 +1549,30 @@ cull_to_bins(const GraphicsEngine::Windows &wlist, Thread *current_thread) {
             // two different DisplayRegions for the left and right
             // channels of a stereo image.)  Of course, the cull
             // result will be the same, so just use the result from
-            // the other DisplayRegion.
-            DisplayRegion *other_dr = (*aci).second;
-            dr->set_cull_result(other_dr->get_cull_result(current_thread),
-                                setup_scene(win->get_gsg(), dr_reader),
-                                current_thread);
-          }
-
-          if (dr_reader != (DisplayRegionPipelineReader *)NULL) {
-            delete dr_reader;
+            // the other DisplayRegion, once it is available.
+            shared.push_back(job);
           }
         }
       }
     }
   }
+
+  if (jobs.size() == 1) {
+    cull_to_bins(jobs[0]._win, jobs[0]._dr, current_thread);
+  } else if (!jobs.empty()) {
+    parallel_cull(jobs, num_threads, current_thread);
+  }
+
+  SharedJobs::const_iterator si;
+  for (si = shared.begin(); si != shared.end(); ++si) {
+    GraphicsOutput *win = (*si)._win;
+    DisplayRegion *dr = (*si)._dr;
+    DisplayRegionPipelineReader dr_reader(dr, current_thread);
+    DisplayRegion *other_dr = already_culled[dr_reader.get_camera()];
+    dr->set_cull_result(other_dr->get_cull_result(current_thread),
+                        setup_scene(win->get_gsg(), &dr_reader),
+                        current_thread);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -1582,6 +1628,107 @@ cull_to_bins(GraphicsOutput *win, DisplayRegion *dr, Thread *current_thread) {
   dr->set_cull_result(MOVE(cull_result), MOVE(scene_setup), current_thread);
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: GraphicsEngine::parallel_cull
+//       Access: Private
+//  Description: Called by cull_to_bins() when the threading model
+//               requests more than one cull thread.  Culls each of
+//               the indicated DisplayRegions, using the current
+//               thread and up to num_threads - 1 CullWorker threads,
+//               and returns when all of them are done.
+//
+//               Each DisplayRegion has its own CullTraverser and
+//               CullResult, so the jobs need not coordinate with each
+//               other beyond pulling the next job off the list.
+////////////////////////////////////////////////////////////////////
+void GraphicsEngine::
+parallel_cull(const CullJobs &jobs, int num_threads, Thread *current_thread) {
+  // Only one cull thread may farm out jobs at a time.
+  MutexHolder batch_holder(_cull_batch_lock, current_thread);
+
+  int num_workers = min(num_threads, (int)jobs.size()) - 1;
+  while ((int)_cull_workers.size() < num_workers) {
+    ostringstream strm;
+    strm << "CullWorker-" << _cull_workers.size();
+    PT(CullWorker) worker = new CullWorker(strm.str(), this, _cull_workers.size());
+    if (!worker->start(TP_normal, true)) {
+      // Couldn't start a thread; do with what we have.
+      break;
+    }
+    _cull_workers.push_back(worker);
+  }
+
+  MutexHolder holder(_cull_jobs_lock, current_thread);
+  _cull_jobs = &jobs;
+  _next_cull_job = 0;
+  _cull_jobs_pending = jobs.size();
+  _cull_jobs_stage = current_thread->get_pipeline_stage();
+  _cull_jobs_num_workers = num_workers;
+  _cv_cull_jobs.notify_all();
+
+  // This thread takes jobs too, rather than sitting idle.
+  do_cull_jobs(current_thread);
+
+  while (_cull_jobs_pending > 0) {
+    PStatTimer timer(_wait_pcollector, current_thread);
+    _cv_cull_done.wait();
+  }
+  _cull_jobs = NULL;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GraphicsEngine::do_cull_jobs
+//       Access: Private
+//  Description: Culls DisplayRegions from the current job list until
+//               there are none left to start.  Assumes
+//               _cull_jobs_lock is held; it is released while each
+//               DisplayRegion is culled.
+////////////////////////////////////////////////////////////////////
+void GraphicsEngine::
+do_cull_jobs(Thread *current_thread) {
+  nassertv(_cull_jobs_lock.debug_is_locked());
+
+  while (_cull_jobs != (CullJobs *)NULL &&
+         _next_cull_job < _cull_jobs->size()) {
+    CullJob job = (*_cull_jobs)[_next_cull_job];
+    ++_next_cull_job;
+
+    _cull_jobs_lock.release();
+    cull_to_bins(job._win, job._dr, current_thread);
+    _cull_jobs_lock.acquire();
+
+    --_cull_jobs_pending;
+    nassertv(_cull_jobs_pending >= 0);
+    if (_cull_jobs_pending == 0) {
+      _cv_cull_done.notify_all();
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GraphicsEngine::terminate_cull_workers
+//       Access: Private
+//  Description: Stops and joins all of the CullWorker threads
+//               started by parallel_cull().
+////////////////////////////////////////////////////////////////////
+void GraphicsEngine::
+terminate_cull_workers() {
+  {
+    MutexHolder holder(_cull_jobs_lock);
+    _cull_workers_terminate = true;
+    _cv_cull_jobs.notify_all();
+  }
+
+  CullWorkers::iterator wi;
+  for (wi = _cull_workers.begin(); wi != _cull_workers.end(); ++wi) {
+    (*wi)->join();
+  }
+  _cull_workers.clear();
+
+  MutexHolder holder(_cull_jobs_lock);
+  _cull_workers_terminate = false;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: GraphicsEngine::draw_bins
 //       Access: Private
@@ -1951,7 +2098,7 @@ setup_scene(GraphicsStateGuardian *gsg, DisplayRegionPipelineReader *dr) {
       display_cat.warning()
         << "Scene " << scene_root << " has net scale ("
         << scene_root.get_scale(NodePath()) << "); cannot render.\n";
-      _singular_warning_this_frame = true;
+      AtomicAdjust::set(_singular_warning_this_frame, 1);
     }
     return NULL;
   }
@@ -1963,7 +2110,7 @@ setup_scene(GraphicsStateGuardian *gsg, DisplayRegionPipelineReader *dr) {
         << "Camera " << camera << " has net scale ("
         << camera.get_scale(NodePath()) << "); cannot render.\n";
     }
-    _singular_warning_this_frame = true;
+    AtomicAdjust::set(_singular_warning_this_frame, 1);
     return NULL;
   }
 
@@ -2416,6 +2563,8 @@ terminate_threads(Thread *current_thread) {
   }
 
   _threads.clear();
+
+  terminate_cull_workers();
 }
 
 
@@ -2871,3 +3020,49 @@ thread_main() {
     }
   }
 }
+
+////////////////////////////////////////////////////////////////////
+//     Function: GraphicsEngine::CullWorker::Constructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+GraphicsEngine::CullWorker::
+CullWorker(const string &name, GraphicsEngine *engine, int index) :
+  Thread(name, "CullWorker"),
+  _engine(engine),
+  _index(index)
+{
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GraphicsEngine::CullWorker::thread_main
+//       Access: Public, Virtual
+//  Description: The main loop for a cull helper thread.  It waits for
+//               the cull thread to publish a list of DisplayRegions
+//               and helps to cull them.  Each worker shows up as its
+//               own thread in PStats.
+////////////////////////////////////////////////////////////////////
+void GraphicsEngine::CullWorker::
+thread_main() {
+  Thread *current_thread = Thread::get_current_thread();
+
+  MutexHolder holder(_engine->_cull_jobs_lock);
+  while (!_engine->_cull_workers_terminate) {
+    // Only the first _cull_jobs_num_workers workers take part in any
+    // given batch, so that the number of threads requested by the
+    // threading model is respected.
+    if (_index < _engine->_cull_jobs_num_workers &&
+        _engine->_cull_jobs != (CullJobs *)NULL &&
+        _engine->_next_cull_job < _engine->_cull_jobs->size()) {
+      // We must read the scene graph from the same pipeline stage as
+      // the cull thread that handed us the jobs.
+      current_thread->set_pipeline_stage(_engine->_cull_jobs_stage);
+      PStatTimer timer(_cull_pcollector, current_thread);
+      _engine->do_cull_jobs(current_thread);
+
+    } else {
+      PStatTimer timer(_wait_pcollector, current_thread);
+      _engine->_cv_cull_jobs.wait();
+    }
+  }
+}
@@ -27,12 +27,14 @@
 #include "reMutex.h"
 #include "lightReMutex.h"
 #include "conditionVar.h"
+#include "conditionVarFull.h"
 #include "pStatCollector.h"
 #include "pset.h"
 #include "ordered_vector.h"
 #include "indirectLess.h"
 #include "loader.h"
 #include "referenceCount.h"
+#include "atomicAdjust.h"
 
 class Pipeline;
 class DisplayRegion;
@@ -171,6 +173,7 @@ private:
   void do_remove_window(GraphicsOutput *window, Thread *current_thread);
   void do_resort_windows();
   void terminate_threads(Thread *current_thread);
+  void terminate_cull_workers();
   void auto_adjust_capabilities(GraphicsStateGuardian *gsg);
 
 #ifdef DO_PSTATS
@@ -306,6 +309,43 @@ private:
 
   WindowRenderer *get_window_renderer(const string &name, int pipeline_stage);
 
+  // These are used to cull several DisplayRegions at once, when the
+  // threading model asks for more than one cull thread.  The thread
+  // calling cull_to_bins() publishes a list of CullJobs, then helps
+  // the CullWorkers pull jobs off the list until it is exhausted.
+  class CullJob {
+  public:
+    GraphicsOutput *_win;
+    DisplayRegion *_dr;
+  };
+  typedef pvector<CullJob> CullJobs;
+
+  class CullWorker : public Thread {
+  public:
+    CullWorker(const string &name, GraphicsEngine *engine, int index);
+    virtual void thread_main();
+
+    GraphicsEngine *_engine;
+    int _index;
+  };
+  typedef pvector< PT(CullWorker) > CullWorkers;
+
+  void parallel_cull(const CullJobs &jobs, int num_threads,
+                     Thread *current_thread);
+  void do_cull_jobs(Thread *current_thread);
+
+  CullWorkers _cull_workers;
+  Mutex _cull_batch_lock;
+  Mutex _cull_jobs_lock;
+  ConditionVarFull _cv_cull_jobs;
+  ConditionVarFull _cv_cull_done;
+  const CullJobs *_cull_jobs;
+  size_t _next_cull_job;
+  int _cull_jobs_pending;
+  int _cull_jobs_stage;
+  int _cull_jobs_num_workers;
+  bool _cull_workers_terminate;
+
   Pipeline *_pipeline;
   Windows _windows;
   bool _windows_sorted;
@@ -327,8 +367,10 @@ private:
   };
   FlipState _flip_state;
 
+  // The cull threads may all set _singular_warning_this_frame at
+  // once.
   bool _singular_warning_last_frame;
-  bool _singular_warning_this_frame;
+  AtomicAdjust::Integer _singular_warning_this_frame;
 
   ReMutex _lock;
   ReMutex _public_lock;
@@ -402,6 +444,7 @@ private:
   static PStatCollector _occlusion_tests_pcollector;
 
   friend class WindowRenderer;
+  friend class CullWorker;
   friend class GraphicsOutput;
 };
 
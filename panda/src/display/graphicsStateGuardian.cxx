@@ -32,6 +32,7 @@
 #include "geomTristrips.h"
 #include "geomTrifans.h"
 #include "geomLinestrips.h"
+#include "geom.h"
 #include "colorWriteAttrib.h"
 #include "shader.h"
 #include "pnotify.h"
@@ -58,6 +59,7 @@
 #include "clipPlaneAttrib.h"
 #include "fogAttrib.h"
 #include "config_pstats.h"
+#include "lightMutexHolder.h"
 
 #include <algorithm>
 #include <limits.h>
@@ -87,6 +89,7 @@ PStatCollector GraphicsStateGuardian::_state_pcollector("State changes");
 PStatCollector GraphicsStateGuardian::_transform_state_pcollector("State changes:Transforms");
 PStatCollector GraphicsStateGuardian::_texture_state_pcollector("State changes:Textures");
 PStatCollector GraphicsStateGuardian::_draw_primitive_pcollector("Draw:Primitive:Draw");
+PStatCollector GraphicsStateGuardian::_draw_primitive_setup_pcollector("Draw:Primitive:Setup");
 PStatCollector GraphicsStateGuardian::_draw_set_state_pcollector("Draw:Set State");
 PStatCollector GraphicsStateGuardian::_clear_pcollector("Draw:Clear");
 PStatCollector GraphicsStateGuardian::_flush_pcollector("Draw:Flush");
@@ -818,39 +821,50 @@ PT(GeomMunger) GraphicsStateGuardian::
 get_geom_munger(const RenderState *state, Thread *current_thread) {
   RenderState::Mungers &mungers = state->_mungers;
 
-  if (!mungers.is_empty()) {
-    // Before we even look up the map, see if the _last_mi value points
-    // to this GSG.  This is likely because we tend to visit the same
-    // state multiple times during a frame.  Also, this might well be
-    // the only GSG in the world anyway.
-    int mi = state->_last_mi;
-    if (mi >= 0 && mungers.has_element(mi) && mungers.get_key(mi) == this) {
-      PT(GeomMunger) munger = mungers.get_data(mi);
-      if (munger->is_registered()) {
-        return munger;
+  {
+    // Several cull threads may look up mungers on the same state at
+    // once, so the cache is protected by the state's lock.  A munger
+    // removed from the cache is released after the lock is.
+    PT(GeomMunger) stale_munger;
+    LightMutexHolder holder(state->_lock);
+
+    if (!mungers.is_empty()) {
+      // Before we even look up the map, see if the _last_mi value points
+      // to this GSG.  This is likely because we tend to visit the same
+      // state multiple times during a frame.  Also, this might well be
+      // the only GSG in the world anyway.
+      int mi = state->_last_mi;
+      if (mi >= 0 && mungers.has_element(mi) && mungers.get_key(mi) == this) {
+        PT(GeomMunger) munger = mungers.get_data(mi);
+        if (munger->is_registered()) {
+          return munger;
+        }
       }
-    }
 
-    // Nope, we have to look it up in the map.
-    mi = mungers.find(this);
-    if (mi >= 0) {
-      PT(GeomMunger) munger = mungers.get_data(mi);
-      if (munger->is_registered()) {
-        state->_last_mi = mi;
-        return munger;
-      } else {
-        // This GeomMunger is no longer registered.  Remove it from
-        // the map.
-        mungers.remove_element(mi);
+      // Nope, we have to look it up in the map.
+      mi = mungers.find(this);
+      if (mi >= 0) {
+        PT(GeomMunger) munger = mungers.get_data(mi);
+        if (munger->is_registered()) {
+          state->_last_mi = mi;
+          return munger;
+        } else {
+          // This GeomMunger is no longer registered.  Remove it from
+          // the map.
+          stale_munger = munger;
+          mungers.remove_element(mi);
+        }
       }
     }
   }
 
-  // Nothing in the map; create a new entry.
+  // Nothing in the map; create a new entry.  This is done without
+  // the lock, since making the munger may query the state.
   PT(GeomMunger) munger = make_geom_munger(state, current_thread);
   nassertr(munger != (GeomMunger *)NULL && munger->is_registered(), munger);
   nassertr(munger->is_of_type(StateMunger::get_class_type()), munger);
 
+  LightMutexHolder holder(state->_lock);
   state->_last_mi = mungers.store(this, munger);
   return munger;
 }
@@ -2258,6 +2272,91 @@ end_draw_primitives() {
   _data_reader = NULL;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: GraphicsStateGuardian::draw_geom_instances
+//       Access: Public, Virtual
+//  Description: Draws num_instances copies of the same Geom, all with
+//               the same state, but each with the corresponding
+//               transform from the transforms array.  This is called
+//               by the cull bins when they find several objects that
+//               differ only in their transform.
+//
+//               This implementation simply draws each instance in
+//               turn, but it needs to look up the vertex data and
+//               validate the primitives only once for the whole
+//               batch.  A GSG that can send the transforms to the
+//               graphics hardware as instance data may override this
+//               to issue a single draw call.
+//
+//               The time spent is counted under Draw:Primitive:Setup,
+//               as it is when each Geom is drawn separately.  Returns
+//               true, since the instances are always drawn.
+////////////////////////////////////////////////////////////////////
+bool GraphicsStateGuardian::
+draw_geom_instances(const Geom *geom, const GeomMunger *munger,
+                    const GeomVertexData *vertex_data,
+                    const RenderState *state,
+                    const TransformState * const *transforms,
+                    int num_instances, bool force,
+                    Thread *current_thread) {
+  if (num_instances <= 0) {
+    return true;
+  }
+
+  _draw_primitive_setup_pcollector.start(current_thread);
+
+  GeomPipelineReader geom_reader(geom, current_thread);
+  geom_reader.check_usage_hint();
+
+  GeomVertexDataPipelineReader data_reader(vertex_data, current_thread);
+  data_reader.check_array_readers();
+
+  typedef pvector<GeomPrimitivePipelineReader *> Readers;
+  Readers readers;
+  int num_primitives = geom_reader.get_num_primitives();
+  readers.reserve(num_primitives);
+  for (int pi = 0; pi < num_primitives; ++pi) {
+    CPT(GeomPrimitive) primitive = geom_reader.get_primitive(pi);
+    GeomPrimitivePipelineReader *reader =
+      new GeomPrimitivePipelineReader(primitive, current_thread);
+    if (reader->get_num_vertices() == 0) {
+      delete reader;
+      continue;
+    }
+    reader->check_minmax();
+    nassertd(reader->check_valid(&data_reader)) {
+      delete reader;
+      continue;
+    }
+    readers.push_back(reader);
+  }
+
+  _draw_primitive_setup_pcollector.stop(current_thread);
+
+  for (int i = 0; i < num_instances; ++i) {
+    // As in the normal path, setting the state is counted separately
+    // from the primitive setup.
+    set_state_and_transform(state, transforms[i]);
+
+    PStatTimer timer(_draw_primitive_setup_pcollector, current_thread);
+    if (begin_draw_primitives(&geom_reader, munger, &data_reader, force)) {
+      Readers::const_iterator ri;
+      for (ri = readers.begin(); ri != readers.end(); ++ri) {
+        GeomPrimitivePipelineReader *reader = (*ri);
+        reader->get_object()->draw(this, reader, force);
+      }
+      end_draw_primitives();
+    }
+  }
+
+  Readers::iterator ri;
+  for (ri = readers.begin(); ri != readers.end(); ++ri) {
+    delete (*ri);
+  }
+
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: GraphicsStateGuardian::reset
 //       Access: Public, Virtual
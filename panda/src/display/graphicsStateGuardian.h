@@ -309,6 +309,13 @@ public:
                            bool force);
   virtual void end_draw_primitives();
 
+  virtual bool draw_geom_instances(const Geom *geom, const GeomMunger *munger,
+                                   const GeomVertexData *vertex_data,
+                                   const RenderState *state,
+                                   const TransformState * const *transforms,
+                                   int num_instances, bool force,
+                                   Thread *current_thread);
+
   INLINE bool reset_if_new();
   INLINE void mark_new();
   virtual void reset();
@@ -592,6 +599,7 @@ public:
   static PStatCollector _transform_state_pcollector;
   static PStatCollector _texture_state_pcollector;
   static PStatCollector _draw_primitive_pcollector;
+  static PStatCollector _draw_primitive_setup_pcollector;
   static PStatCollector _draw_set_state_pcollector;
   static PStatCollector _clear_pcollector;
   static PStatCollector _flush_pcollector;
@@ -13,6 +13,8 @@
 ////////////////////////////////////////////////////////////////////
 
 #include "graphicsThreadingModel.h"
+#include "config_display.h"
+#include "string_utils.h"
 
 ////////////////////////////////////////////////////////////////////
 //     Function: GraphicsThreadingModel::Constructor
@@ -43,10 +45,17 @@
 //               It simplifies the cull process but it forces the
 //               scene to render in scene graph order; state sorting
 //               and alpha sorting is lost.
+//
+//               The cull thread name may be followed by ":n", where n
+//               is a number greater than 1, to cull several
+//               DisplayRegions at once in that many threads; see
+//               set_cull_num_threads().  For instance, "Cull:4/Draw"
+//               culls in up to four threads.
 ////////////////////////////////////////////////////////////////////
 GraphicsThreadingModel::
 GraphicsThreadingModel(const string &model) {
   _cull_sorting = true;
+  _cull_num_threads = 1;
   size_t start = 0;
   if (!model.empty() && model[0] == '-') {
     start = 1;
@@ -61,6 +70,19 @@ GraphicsThreadingModel(const string &model) {
     _draw_name = model.substr(slash + 1);
   }
 
+  size_t colon = _cull_name.find(':');
+  if (colon != string::npos) {
+    string count = _cull_name.substr(colon + 1);
+    _cull_name = _cull_name.substr(0, colon);
+    int cull_num_threads;
+    if (string_to_int(count, cull_num_threads)) {
+      set_cull_num_threads(cull_num_threads);
+    } else {
+      display_cat.error()
+        << "Invalid cull thread count in threading model: " << model << "\n";
+    }
+  }
+
   update_stages();
 }
 
@@ -73,6 +95,10 @@ GraphicsThreadingModel(const string &model) {
 string GraphicsThreadingModel::
 get_model() const {
   if (get_cull_sorting()) {
+    if (get_cull_num_threads() > 1) {
+      return get_cull_name() + ":" + format_string(get_cull_num_threads()) +
+        "/" + get_draw_name();
+    }
     return get_cull_name() + "/" + get_draw_name();
   } else {
     return string("-") + get_cull_name();
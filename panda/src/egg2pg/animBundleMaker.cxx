@@ -75,9 +75,9 @@ make_node() {
 //       Access: Private
 //  Description:
 ////////////////////////////////////////////////////////////////////
-AnimBundle *AnimBundleMaker::
+PT(AnimBundle) AnimBundleMaker::
 make_bundle() {
-  AnimBundle *bundle = new AnimBundle(_root->get_name(), _fps, _num_frames);
+  PT(AnimBundle) bundle = new AnimBundle(_root->get_name(), _fps, _num_frames);
 
   EggTable::const_iterator ci;
   for (ci = _root->begin(); ci != _root->end(); ++ci) {
@@ -89,6 +89,10 @@ make_bundle() {
 
   bundle->sort_descendants();
 
+  if (egg_quantize_anim) {
+    bundle = bundle->copy_bundle_quantized(egg_quantize_anim_tolerance);
+  }
+
   return bundle;
 }
 
@@ -17,6 +17,7 @@
 
 #include "pandabase.h"
 #include "typedef.h"
+#include "pointerTo.h"
 
 class EggNode;
 class EggGroupNode;
@@ -41,7 +42,7 @@ public:
   AnimBundleNode *make_node();
 
 private:
-  AnimBundle *make_bundle();
+  PT(AnimBundle) make_bundle();
 
   void inspect_tree(EggNode *node);
   void build_hierarchy(EggTable *egg_table, AnimGroup *parent);
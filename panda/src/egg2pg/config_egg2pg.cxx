@@ -191,6 +191,20 @@ ConfigVariableBool egg_implicit_alpha_binary
           "will automatically be downgraded to alpha type \"binary\" instead of "
           "whatever appears in the egg file."));
 
+ConfigVariableBool egg_quantize_anim
+("egg-quantize-anim", false,
+ PRC_DESC("Set this true to store the joint animation tables loaded from egg "
+          "files in compressed form, as AnimChannelMatrixQuantizedTable "
+          "channels, which use much less memory.  Tables that never change "
+          "are collapsed to a single value, and the remaining tables are "
+          "reduced to quantized keyframes.  See egg-quantize-anim-tolerance."));
+
+ConfigVariableDouble egg_quantize_anim_tolerance
+("egg-quantize-anim-tolerance", 0.01,
+ PRC_DESC("The largest error allowed in any component of a joint's animation "
+          "when egg-quantize-anim is true.  Rotations are measured in "
+          "degrees, and translations in model units."));
+
 ConfigureFn(config_egg2pg) {
   init_libegg2pg();
 }
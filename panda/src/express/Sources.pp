@@ -16,7 +16,8 @@
     compress_string.h \
     config_express.h \
     copy_stream.h \
-    datagram.I datagram.h datagramGenerator.I \
+    datagram.I datagram.h datagramBufferPool.I datagramBufferPool.h \
+    datagramGenerator.I \
     datagramGenerator.h \
     datagramIterator.I datagramIterator.h datagramSink.I datagramSink.h \
     dcast.T dcast.h \
@@ -29,6 +30,8 @@
     hashGeneratorBase.I hashGeneratorBase.h \
     hashVal.I hashVal.h \
     indirectLess.I indirectLess.h \
+    mappedFile.I mappedFile.h \
+    mappedStream.I mappedStream.h mappedStreamBuf.h \
     memoryInfo.I memoryInfo.h \
     memoryUsage.I memoryUsage.h \
     memoryUsagePointerCounts.I memoryUsagePointerCounts.h \
@@ -90,13 +93,14 @@
     compress_string.cxx \
     config_express.cxx \
     copy_stream.cxx \
-    datagram.cxx datagramGenerator.cxx \
+    datagram.cxx datagramBufferPool.cxx datagramGenerator.cxx \
     datagramIterator.cxx \
     datagramSink.cxx dcast.cxx \
     encrypt_string.cxx \
     error_utils.cxx \
     fileReference.cxx \
     hashGeneratorBase.cxx hashVal.cxx \
+    mappedFile.cxx mappedStreamBuf.cxx \
     memoryInfo.cxx memoryUsage.cxx memoryUsagePointerCounts.cxx \
     memoryUsagePointers_ext.cxx \
     memoryUsagePointers.cxx multifile.cxx \
@@ -151,7 +155,8 @@
     compress_string.h \
     config_express.h \
     copy_stream.h \
-    datagram.I datagram.h datagramGenerator.I \
+    datagram.I datagram.h datagramBufferPool.I datagramBufferPool.h \
+    datagramGenerator.I \
     datagramGenerator.h \
     datagramIterator.I datagramIterator.h datagramSink.I datagramSink.h \
     dcast.T dcast.h \
@@ -161,6 +166,8 @@
     hashGeneratorBase.I hashGeneratorBase.h \
     hashVal.I hashVal.h \
     indirectLess.I indirectLess.h \
+    mappedFile.I mappedFile.h \
+    mappedStream.I mappedStream.h mappedStreamBuf.h \
     memoryInfo.I memoryInfo.h \
     memoryUsage.I memoryUsage.h \
     memoryUsagePointerCounts.I memoryUsagePointerCounts.h \
@@ -275,3 +282,14 @@
 
 #end test_bin_target
 #endif
+
+
+#begin test_bin_target
+  #define TARGET test_multifile_mmap
+  #define LOCAL_LIBS $[LOCAL_LIBS] p3express
+  #define OTHER_LIBS p3dtoolutil:c p3dtool:m p3prc:c p3dtoolconfig:m p3pystub
+
+  #define SOURCES \
+    test_multifile_mmap.cxx
+
+#end test_bin_target
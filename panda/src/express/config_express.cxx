@@ -73,6 +73,40 @@ ConfigVariableBool multifile_always_binary
           "or extracted in either binary or text mode, according to the "
           "set_binary() or set_text() flag on the Filename."));
 
+ConfigVariableBool multifile_mmap
+("multifile-mmap", false,
+ PRC_DESC("Set this true to map each Multifile that is opened for reading "
+          "from a file on disk into memory.  Subfiles that are neither "
+          "compressed nor encrypted are then read directly from memory, and "
+          "streams opened on any subfile no longer share a file pointer and "
+          "lock, so that several threads may read from the same Multifile "
+          "at once.  If the file cannot be mapped, for instance because it "
+          "does not fit in the address space, it is read normally.  "
+          "Only enable this if the Multifile will not be truncated or "
+          "rewritten in place while it is open, for instance by a patcher "
+          "or downloader: on POSIX systems, reading a mapped page beyond "
+          "the new end of the file raises SIGBUS and kills the process.  "
+          "The file size is checked each time a subfile is opened or read, "
+          "and the stream is used instead if it has shrunk, but a stream "
+          "already open on a subfile is not protected.  Replacing the file "
+          "by renaming a new one over it is safe."));
+
+ConfigVariableBool datagram_buffer_pool
+("datagram-buffer-pool", false,
+ PRC_DESC("Set this true to keep the storage of discarded Datagrams of up "
+          "to 64 KB in a pool, sorted by size, for reuse by new Datagrams, "
+          "instead of freeing it.  This saves an allocation, and the "
+          "reallocations as it grows, for each Datagram built by a program "
+          "that sends and receives many of them.  This is read only once, "
+          "when the first Datagram is filled."));
+
+ConfigVariableInt datagram_buffer_pool_limit
+("datagram-buffer-pool-limit", 16,
+ PRC_DESC("The maximum number of buffers of each size that the "
+          "datagram-buffer-pool keeps for reuse.  Beyond this, discarded "
+          "buffers are freed as usual.  The pool holds at most about "
+          "128 KB times this number."));
+
 ConfigVariableBool collect_tcp
 ("collect-tcp", false,
  PRC_DESC("Set this true to enable accumulation of several small consecutive "
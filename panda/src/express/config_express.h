@@ -56,6 +56,10 @@ extern ConfigVariableInt patchfile_zone_size;
 
 extern ConfigVariableBool keep_temporary_files;
 extern ConfigVariableBool multifile_always_binary;
+extern ConfigVariableBool multifile_mmap;
+
+extern EXPCL_PANDAEXPRESS ConfigVariableBool datagram_buffer_pool;
+extern EXPCL_PANDAEXPRESS ConfigVariableInt datagram_buffer_pool_limit;
 
 extern EXPCL_PANDAEXPRESS ConfigVariableBool collect_tcp;
 extern EXPCL_PANDAEXPRESS ConfigVariableDouble collect_tcp_interval;
@@ -29,6 +29,7 @@ TypeHandle Datagram::_type_handle;
 ////////////////////////////////////////////////////////////////////
 Datagram::
 ~Datagram() {
+  DatagramBufferPool::release_buffer(_data);
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -39,7 +40,7 @@ Datagram::
 ////////////////////////////////////////////////////////////////////
 void Datagram::
 clear() {
-  _data.clear();
+  DatagramBufferPool::release_buffer(_data);
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -111,16 +112,7 @@ void Datagram::
 pad_bytes(size_t size) {
   nassertv((int)size >= 0);
 
-  if (_data == (uchar *)NULL) {
-    // Create a new array.
-    _data = PTA_uchar::empty_array(0);
-
-  } else if (_data.get_ref_count() != 1) {
-    // Copy on write.
-    PTA_uchar new_data = PTA_uchar::empty_array(0);
-    new_data.v() = _data.v();
-    _data = new_data;
-  }
+  prepare_append(size);
 
   // Now append the data.
 
@@ -144,16 +136,7 @@ void Datagram::
 append_data(const void *data, size_t size) {
   nassertv((int)size >= 0);
 
-  if (_data == (uchar *)NULL) {
-    // Create a new array.
-    _data = PTA_uchar::empty_array(0);
-
-  } else if (_data.get_ref_count() != 1) {
-    // Copy on write.
-    PTA_uchar new_data = PTA_uchar::empty_array(0);
-    new_data.v() = _data.v();
-    _data = new_data;
-  }
+  prepare_append(size);
 
   // Now append the data.
 
@@ -178,11 +161,40 @@ void Datagram::
 assign(const void *data, size_t size) {
   nassertv((int)size >= 0);
   
-  _data = PTA_uchar::empty_array(0);
+  DatagramBufferPool::release_buffer(_data);
+  _data = DatagramBufferPool::get_buffer(size);
   _data.v().insert(_data.v().end(), (const unsigned char *)data,
                    (const unsigned char *)data + size);
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: Datagram::prepare_append
+//       Access: Private
+//  Description: Ensures the datagram has a buffer of its own, with
+//               room to append the indicated number of bytes, taking
+//               one from the DatagramBufferPool if it needs a new
+//               one.
+////////////////////////////////////////////////////////////////////
+void Datagram::
+prepare_append(size_t size) {
+  if (_data == (uchar *)NULL) {
+    // Create a new array.
+    _data = DatagramBufferPool::get_buffer(size);
+
+  } else if (_data.get_ref_count() != 1) {
+    // Copy on write.
+    PTA_uchar new_data = DatagramBufferPool::get_buffer(_data.size() + size);
+    new_data.v().insert(new_data.v().end(), _data.v().begin(), _data.v().end());
+    _data = new_data;
+    DatagramBufferPool::note_copy();
+
+  } else if (_data.size() + size > _data.v().capacity()) {
+    // Move up to a larger buffer from the pool, rather than letting
+    // the vector reallocate itself.
+    DatagramBufferPool::grow_buffer(_data, _data.size() + size);
+  }
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function : Datagram::output
 //       Access : Public
@@ -22,6 +22,7 @@
 #include "littleEndian.h"
 #include "bigEndian.h"
 #include "pta_uchar.h"
+#include "datagramBufferPool.h"
 
 ////////////////////////////////////////////////////////////////////
 //       Class : Datagram
@@ -115,6 +116,8 @@ PUBLISHED:
   void write(ostream &out, unsigned int indent=0) const;
 
 private:
+  void prepare_append(size_t size);
+
   PTA_uchar _data;
   bool _stdfloat_double;
 
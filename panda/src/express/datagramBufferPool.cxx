@@ -0,0 +1,248 @@
+// Filename: datagramBufferPool.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "datagramBufferPool.h"
+#include "config_express.h"
+
+AtomicAdjust::Pointer DatagramBufferPool::_global_ptr = NULL;
+AtomicAdjust::Integer DatagramBufferPool::_num_allocs = 0;
+AtomicAdjust::Integer DatagramBufferPool::_num_reuses = 0;
+AtomicAdjust::Integer DatagramBufferPool::_num_copies = 0;
+AtomicAdjust::Integer DatagramBufferPool::_enabled = -1;
+AtomicAdjust::Integer DatagramBufferPool::_limit = 0;
+
+////////////////////////////////////////////////////////////////////
+//     Function: DatagramBufferPool::Constructor
+//       Access: Private
+//  Description: The pool is a singleton; see get_global_ptr().
+////////////////////////////////////////////////////////////////////
+DatagramBufferPool::
+DatagramBufferPool() {
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: DatagramBufferPool::get_num_pooled
+//       Access: Published, Static
+//  Description: Returns the number of buffers currently waiting in
+//               the pool to be reused.
+////////////////////////////////////////////////////////////////////
+int DatagramBufferPool::
+get_num_pooled() {
+  DatagramBufferPool *pool = get_global_ptr();
+  int count = 0;
+  for (int i = 0; i < num_size_classes; ++i) {
+    SizeClass &sc = pool->_classes[i];
+    sc._lock.acquire();
+    count += (int)sc._buffers.size();
+    sc._lock.release();
+  }
+  return count;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: DatagramBufferPool::reset_stats
+//       Access: Published, Static
+//  Description: Resets the counts of allocations, reuses and copies
+//               to zero.
+////////////////////////////////////////////////////////////////////
+void DatagramBufferPool::
+reset_stats() {
+  AtomicAdjust::set(_num_allocs, 0);
+  AtomicAdjust::set(_num_reuses, 0);
+  AtomicAdjust::set(_num_copies, 0);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: DatagramBufferPool::release_all
+//       Access: Published, Static
+//  Description: Frees all of the buffers waiting in the pool.
+////////////////////////////////////////////////////////////////////
+void DatagramBufferPool::
+release_all() {
+  DatagramBufferPool *pool = get_global_ptr();
+  for (int i = 0; i < num_size_classes; ++i) {
+    SizeClass &sc = pool->_classes[i];
+    // Swap the buffers out, so they are freed outside the lock.
+    pvector<PTA_uchar> buffers;
+    sc._lock.acquire();
+    buffers.swap(sc._buffers);
+    sc._lock.release();
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: DatagramBufferPool::write
+//       Access: Published, Static
+//  Description: Writes the pool's statistics to the indicated
+//               stream.
+////////////////////////////////////////////////////////////////////
+void DatagramBufferPool::
+write(ostream &out) {
+  out << get_num_allocs() << " datagram buffers allocated, "
+      << get_num_reuses() << " reused, "
+      << get_num_copies() << " copied on write, "
+      << get_num_pooled() << " pooled\n";
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: DatagramBufferPool::get_buffer
+//       Access: Public, Static
+//  Description: Returns a new, empty buffer with room for at least
+//               the indicated number of bytes, from the pool if one
+//               is available.  If the size is beyond the largest
+//               size class, or the pool is disabled, returns a new
+//               empty buffer with no room reserved.
+////////////////////////////////////////////////////////////////////
+PTA_uchar DatagramBufferPool::
+get_buffer(size_t min_capacity) {
+  int ci = is_enabled() ? get_size_class(min_capacity) : -1;
+  if (ci < 0) {
+    AtomicAdjust::inc(_num_allocs);
+    return PTA_uchar::empty_array(0);
+  }
+
+  DatagramBufferPool *pool = get_global_ptr();
+  SizeClass &sc = pool->_classes[ci];
+  sc._lock.acquire();
+  if (!sc._buffers.empty()) {
+    PTA_uchar buffer = sc._buffers.back();
+    sc._buffers.pop_back();
+    sc._lock.release();
+    AtomicAdjust::inc(_num_reuses);
+    return buffer;
+  }
+  sc._lock.release();
+
+  AtomicAdjust::inc(_num_allocs);
+  PTA_uchar buffer = PTA_uchar::empty_array(0);
+  buffer.v().reserve((size_t)1 << (ci + min_size_bits));
+  return buffer;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: DatagramBufferPool::grow_buffer
+//       Access: Public, Static
+//  Description: Makes room in the indicated buffer, which must not be
+//               shared, for at least the indicated number of bytes,
+//               by moving its contents to a buffer of a larger size
+//               class and returning the old one to the pool.  If the
+//               new size is beyond the largest size class, the buffer
+//               is left alone to grow itself.
+////////////////////////////////////////////////////////////////////
+void DatagramBufferPool::
+grow_buffer(PTA_uchar &buffer, size_t min_capacity) {
+  nassertv(buffer.get_ref_count() == 1);
+  if (!is_enabled() || get_size_class(min_capacity) < 0) {
+    return;
+  }
+
+  PTA_uchar new_buffer = get_buffer(min_capacity);
+  new_buffer.v().insert(new_buffer.v().end(), buffer.v().begin(),
+                        buffer.v().end());
+  release_buffer(buffer);
+  buffer = new_buffer;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: DatagramBufferPool::release_buffer
+//       Access: Public, Static
+//  Description: Lets go of the indicated buffer, and clears the
+//               pointer.  If no one else shares it, and its size fits
+//               one of the size classes, it goes back into the pool
+//               to be reused; otherwise it is freed as usual when its
+//               last reference goes away.
+////////////////////////////////////////////////////////////////////
+void DatagramBufferPool::
+release_buffer(PTA_uchar &buffer) {
+  if (buffer == (uchar *)NULL) {
+    return;
+  }
+
+  // We don't call is_enabled() here, since this may be called during
+  // static destruction.  If the config hasn't been read yet, no
+  // buffer has come from the pool anyway.
+  if (AtomicAdjust::get(_enabled) > 0 && buffer.get_ref_count() == 1) {
+    // A buffer goes into the largest class it can fully serve.
+    size_t capacity = buffer.v().capacity();
+    int ci = get_size_class(capacity);
+    if (ci >= 0 && ((size_t)1 << (ci + min_size_bits)) > capacity) {
+      --ci;
+    }
+    if (ci >= 0) {
+      buffer.v().clear();
+      DatagramBufferPool *pool = get_global_ptr();
+      SizeClass &sc = pool->_classes[ci];
+      sc._lock.acquire();
+      if ((int)sc._buffers.size() < AtomicAdjust::get(_limit)) {
+        sc._buffers.push_back(buffer);
+      }
+      sc._lock.release();
+    }
+  }
+
+  buffer.clear();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: DatagramBufferPool::make_global_ptr
+//       Access: Private, Static
+//  Description: Creates the one pool, the first time it is needed.
+////////////////////////////////////////////////////////////////////
+DatagramBufferPool *DatagramBufferPool::
+make_global_ptr() {
+  DatagramBufferPool *ptr = new DatagramBufferPool;
+  void *result = AtomicAdjust::compare_and_exchange_ptr(_global_ptr, (void *)NULL, (void *)ptr);
+  if (result != NULL) {
+    // Someone else must have created the pool first.  OK.
+    delete ptr;
+  }
+  return (DatagramBufferPool *)AtomicAdjust::get_ptr(_global_ptr);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: DatagramBufferPool::read_config
+//       Access: Private, Static
+//  Description: Reads datagram-buffer-pool and
+//               datagram-buffer-pool-limit into _enabled and _limit,
+//               the first time the pool is used, and returns the
+//               former.
+////////////////////////////////////////////////////////////////////
+bool DatagramBufferPool::
+read_config() {
+  AtomicAdjust::set(_limit, max((int)datagram_buffer_pool_limit, 0));
+  bool enabled = datagram_buffer_pool;
+  AtomicAdjust::set(_enabled, enabled ? 1 : 0);
+  return enabled;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: DatagramBufferPool::get_size_class
+//       Access: Private, Static
+//  Description: Returns the index of the smallest size class that
+//               holds the indicated number of bytes, or -1 if it is
+//               too large for any of them.
+////////////////////////////////////////////////////////////////////
+int DatagramBufferPool::
+get_size_class(size_t size) {
+  int ci = 0;
+  size_t class_size = (size_t)1 << min_size_bits;
+  while (class_size < size) {
+    ++ci;
+    if (ci >= num_size_classes) {
+      return -1;
+    }
+    class_size <<= 1;
+  }
+  return ci;
+}
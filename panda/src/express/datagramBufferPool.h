@@ -0,0 +1,96 @@
+// Filename: datagramBufferPool.h
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef DATAGRAMBUFFERPOOL_H
+#define DATAGRAMBUFFERPOOL_H
+
+#include "pandabase.h"
+#include "pta_uchar.h"
+#include "pvector.h"
+#include "mutexImpl.h"
+#include "atomicAdjust.h"
+
+////////////////////////////////////////////////////////////////////
+//       Class : DatagramBufferPool
+// Description : Keeps the storage of discarded Datagrams for reuse by
+//               new ones, so that a program that builds and discards
+//               many Datagrams, such as a network server, need not
+//               go to the memory allocator for each one.
+//
+//               Buffers are kept in size classes, each twice the size
+//               of the last, from 64 bytes up to 64 KB.  A Datagram
+//               takes a buffer of the smallest class that holds what
+//               it is about to add, and moves to a buffer of a larger
+//               class when it outgrows it.  A buffer returns to the
+//               pool only when the last Datagram sharing it lets it
+//               go.  Larger buffers are allocated and freed as usual.
+//
+//               The pool is enabled with datagram-buffer-pool, and its
+//               size limited with datagram-buffer-pool-limit.  Both
+//               are read once, when the first Datagram is filled.
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDAEXPRESS DatagramBufferPool {
+PUBLISHED:
+  INLINE static int get_num_allocs();
+  INLINE static int get_num_reuses();
+  INLINE static int get_num_copies();
+  static int get_num_pooled();
+
+  static void reset_stats();
+  static void release_all();
+  static void write(ostream &out);
+
+public:
+  static PTA_uchar get_buffer(size_t min_capacity);
+  static void grow_buffer(PTA_uchar &buffer, size_t min_capacity);
+  static void release_buffer(PTA_uchar &buffer);
+  INLINE static void note_copy();
+
+private:
+  DatagramBufferPool();
+  INLINE static DatagramBufferPool *get_global_ptr();
+  static DatagramBufferPool *make_global_ptr();
+  INLINE static bool is_enabled();
+  static bool read_config();
+  static int get_size_class(size_t size);
+
+  enum {
+    min_size_bits = 6,
+    num_size_classes = 11,
+  };
+
+  class SizeClass {
+  public:
+    MutexImpl _lock;
+    pvector<PTA_uchar> _buffers;
+  };
+  SizeClass _classes[num_size_classes];
+
+  static AtomicAdjust::Pointer _global_ptr;
+
+  // These cache datagram-buffer-pool and datagram-buffer-pool-limit.
+  // _enabled is -1 until the config has been read.  They are plain
+  // integers, rather than the config variables themselves, because
+  // release_buffer() may be called by a Datagram destructor during
+  // static destruction.
+  static AtomicAdjust::Integer _enabled;
+  static AtomicAdjust::Integer _limit;
+  static AtomicAdjust::Integer _num_allocs;
+  static AtomicAdjust::Integer _num_reuses;
+  static AtomicAdjust::Integer _num_copies;
+};
+
+#include "datagramBufferPool.I"
+
+#endif
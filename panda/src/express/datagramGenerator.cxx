@@ -115,3 +115,23 @@ streampos DatagramGenerator::
 get_file_pos() {
   return 0;
 }
+
+////////////////////////////////////////////////////////////////////
+//     Function: DatagramGenerator::map_datagram
+//       Access: Public, Virtual
+//  Description: Skips over the next datagram without extracting it,
+//               and instead returns a pointer to its contents within
+//               a memory-mapped view of the file it is read from.  The
+//               caller should keep a reference to the mapping for as
+//               long as it uses the pointer.
+//
+//               Returns true on success, or false if the datagram
+//               source cannot be mapped, in which case nothing is
+//               consumed, and the datagram should be read with
+//               get_datagram() instead.
+////////////////////////////////////////////////////////////////////
+bool DatagramGenerator::
+map_datagram(PT(MappedFile) &mapping, const unsigned char *&data,
+             size_t &size) {
+  return false;
+}
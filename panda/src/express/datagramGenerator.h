@@ -18,6 +18,8 @@
 #include "pandabase.h"
 
 #include "datagram.h"
+#include "mappedFile.h"
+#include "pointerTo.h"
 
 class SubfileInfo;
 class FileReference;
@@ -45,6 +47,10 @@ PUBLISHED:
   virtual const FileReference *get_file();
   virtual VirtualFile *get_vfile();
   virtual streampos get_file_pos();
+
+public:
+  virtual bool map_datagram(PT(MappedFile) &mapping,
+                            const unsigned char *&data, size_t &size);
 };
 
 #include "datagramGenerator.I"
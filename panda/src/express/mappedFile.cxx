@@ -0,0 +1,188 @@
+// Filename: mappedFile.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "mappedFile.h"
+#include "config_express.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN 1
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+////////////////////////////////////////////////////////////////////
+//     Function: MappedFile::Constructor
+//       Access: Published
+//  Description:
+////////////////////////////////////////////////////////////////////
+MappedFile::
+MappedFile() :
+  _data(NULL),
+  _size(0)
+{
+#ifndef _WIN32
+  _fd = -1;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MappedFile::Destructor
+//       Access: Published
+//  Description:
+////////////////////////////////////////////////////////////////////
+MappedFile::
+~MappedFile() {
+  close();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MappedFile::open
+//       Access: Published
+//  Description: Maps the indicated file, which must be a regular
+//               file on disk, not one within the virtual file
+//               system, into memory.  Returns true on success, false
+//               on failure; an empty file cannot be mapped.
+////////////////////////////////////////////////////////////////////
+bool MappedFile::
+open(const Filename &filename) {
+  close();
+  _filename = filename;
+
+#ifdef _WIN32
+  wstring os_specific = filename.to_os_specific_w();
+  HANDLE file = CreateFileW(os_specific.c_str(), GENERIC_READ,
+                            FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0 ||
+      (ULONGLONG)file_size.QuadPart != (ULONGLONG)(size_t)file_size.QuadPart) {
+    CloseHandle(file);
+    return false;
+  }
+
+  HANDLE mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  CloseHandle(file);
+  if (mapping == NULL) {
+    return false;
+  }
+
+  // The view keeps the mapping object alive until it is unmapped.
+  void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);
+  if (data == NULL) {
+    return false;
+  }
+
+  _size = (size_t)file_size.QuadPart;
+
+#else  // _WIN32
+  string os_specific = filename.to_os_specific();
+  int fd = ::open(os_specific.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0 ||
+      (off_t)(size_t)st.st_size != st.st_size) {
+    ::close(fd);
+    return false;
+  }
+
+  void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    ::close(fd);
+    return false;
+  }
+
+  _size = (size_t)st.st_size;
+  _fd = fd;
+#endif  // _WIN32
+
+  _data = (unsigned char *)data;
+
+  if (express_cat.is_debug()) {
+    express_cat.debug()
+      << "Mapped " << _size << " bytes of " << _filename << "\n";
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MappedFile::close
+//       Access: Published
+//  Description: Unmaps the file, if it is mapped.  Any pointers into
+//               it become invalid.
+////////////////////////////////////////////////////////////////////
+void MappedFile::
+close() {
+  if (_data != (unsigned char *)NULL) {
+#ifdef _WIN32
+    UnmapViewOfFile(_data);
+#else
+    munmap(_data, _size);
+#endif
+    _data = NULL;
+  }
+  _size = 0;
+
+#ifndef _WIN32
+  if (_fd != -1) {
+    ::close(_fd);
+    _fd = -1;
+  }
+#endif
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MappedFile::check_size
+//       Access: Published
+//  Description: Returns true if the file on disk still holds at
+//               least the first size bytes of the mapping, so that
+//               they may safely be read; or false if it has been
+//               truncated since it was mapped, or is not open.
+//
+//               This costs a system call, so it is meant to be
+//               called once before handing out a range of the
+//               mapping, not on each read.  It cannot protect a
+//               range that is truncated after it has been checked.
+////////////////////////////////////////////////////////////////////
+bool MappedFile::
+check_size(size_t size) const {
+  if (_data == (unsigned char *)NULL || size > _size) {
+    return false;
+  }
+
+#ifdef _WIN32
+  // Windows refuses to truncate a file while a view of it is mapped.
+  return true;
+
+#else  // _WIN32
+  struct stat st;
+  if (fstat(_fd, &st) != 0) {
+    return false;
+  }
+  return (size_t)st.st_size >= size;
+#endif  // _WIN32
+}
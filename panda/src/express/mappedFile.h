@@ -0,0 +1,78 @@
+// Filename: mappedFile.h
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include "pandabase.h"
+#include "referenceCount.h"
+#include "filename.h"
+
+////////////////////////////////////////////////////////////////////
+//       Class : MappedFile
+// Description : A read-only view of an entire file on disk, mapped
+//               into the address space of the process with mmap()
+//               (or MapViewOfFile() on Windows).  The file's contents
+//               may then be read directly from memory, by any number
+//               of threads at once, and the operating system pages
+//               them in on demand.
+//
+//               The mapping remains valid for as long as the
+//               MappedFile is open, so anything that hands out
+//               pointers into it should hold a reference to it.
+//
+//               On POSIX systems, the file must not be truncated
+//               while it is mapped: reading a page of the mapping
+//               that lies beyond the new end of the file raises
+//               SIGBUS, which kills the process.  Replacing the file
+//               by renaming a new one over it is safe.  See
+//               check_size().
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDAEXPRESS MappedFile : public ReferenceCount {
+PUBLISHED:
+  MappedFile();
+  ~MappedFile();
+
+private:
+  MappedFile(const MappedFile &copy);
+  void operator = (const MappedFile &copy);
+
+PUBLISHED:
+  BLOCKING bool open(const Filename &filename);
+  void close();
+
+  INLINE bool is_valid() const;
+  INLINE const Filename &get_filename() const;
+  INLINE size_t get_size() const;
+  bool check_size(size_t size) const;
+
+public:
+  INLINE const unsigned char *get_data() const;
+
+private:
+  Filename _filename;
+  unsigned char *_data;
+  size_t _size;
+
+#ifndef _WIN32
+  // The file is kept open so that check_size() can ask after the
+  // file that is actually mapped, even if another has since been
+  // renamed over it.
+  int _fd;
+#endif
+};
+
+#include "mappedFile.I"
+
+#endif
@@ -0,0 +1,47 @@
+// Filename: mappedStream.h
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef MAPPEDSTREAM_H
+#define MAPPEDSTREAM_H
+
+#include "pandabase.h"
+#include "mappedStreamBuf.h"
+
+////////////////////////////////////////////////////////////////////
+//       Class : IMappedStream
+// Description : An istream object that reads a range of bytes
+//               directly out of a MappedFile.  Unlike an ISubStream,
+//               it shares no file pointer or lock with any other
+//               stream, so any number of them may be read in
+//               parallel; and it supports arbitrary seeks.
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDAEXPRESS IMappedStream : public istream {
+public:
+  INLINE IMappedStream();
+  INLINE IMappedStream(const MappedFile *file, const unsigned char *start, size_t size);
+
+#if _MSC_VER >= 1800
+  INLINE IMappedStream(const IMappedStream &copy) = delete;
+#endif
+
+  INLINE IMappedStream &open(const MappedFile *file, const unsigned char *start, size_t size);
+  INLINE IMappedStream &close();
+
+private:
+  MappedStreamBuf _buf;
+};
+
+#include "mappedStream.I"
+
+#endif
@@ -0,0 +1,145 @@
+// Filename: mappedStreamBuf.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "mappedStreamBuf.h"
+
+////////////////////////////////////////////////////////////////////
+//     Function: MappedStreamBuf::Constructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+MappedStreamBuf::
+MappedStreamBuf() {
+  setg(NULL, NULL, NULL);
+  setp(NULL, NULL);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MappedStreamBuf::Destructor
+//       Access: Public, Virtual
+//  Description:
+////////////////////////////////////////////////////////////////////
+MappedStreamBuf::
+~MappedStreamBuf() {
+  close();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MappedStreamBuf::open
+//       Access: Public
+//  Description: Starts reading the size bytes beginning at start,
+//               which must lie within the indicated file's mapping.
+//               A reference to the file is kept, so that the mapping
+//               outlives the stream.
+////////////////////////////////////////////////////////////////////
+void MappedStreamBuf::
+open(const MappedFile *file, const unsigned char *start, size_t size) {
+  nassertv(file != (MappedFile *)NULL && file->is_valid());
+  nassertv(start >= file->get_data() &&
+           start + size <= file->get_data() + file->get_size());
+  _file = file;
+
+  // The get area is never written to; streambuf just insists on
+  // non-const pointers.
+  char *begin = (char *)start;
+  setg(begin, begin, begin + size);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MappedStreamBuf::close
+//       Access: Public
+//  Description: Empties the stream, and releases the reference to
+//               the file.
+////////////////////////////////////////////////////////////////////
+void MappedStreamBuf::
+close() {
+  setg(NULL, NULL, NULL);
+  _file = NULL;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MappedStreamBuf::seekoff
+//       Access: Public, Virtual
+//  Description: Implements seeking within the stream.
+////////////////////////////////////////////////////////////////////
+streampos MappedStreamBuf::
+seekoff(streamoff off, ios_seekdir dir, ios_openmode which) {
+  if ((which & ios::in) == 0) {
+    return -1;
+  }
+
+  streamoff size = egptr() - eback();
+  streamoff pos;
+  switch (dir) {
+  case ios::beg:
+    pos = off;
+    break;
+
+  case ios::cur:
+    pos = (gptr() - eback()) + off;
+    break;
+
+  case ios::end:
+    pos = size + off;
+    break;
+
+  default:
+    return -1;
+  }
+
+  if (pos < 0 || pos > size) {
+    return -1;
+  }
+
+  setg(eback(), eback() + pos, egptr());
+  return pos;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MappedStreamBuf::seekpos
+//       Access: Public, Virtual
+//  Description: A variant on seekoff() to implement seeking within a
+//               stream.
+////////////////////////////////////////////////////////////////////
+streampos MappedStreamBuf::
+seekpos(streampos pos, ios_openmode which) {
+  return seekoff(pos, ios::beg, which);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MappedStreamBuf::showmanyc
+//       Access: Protected, Virtual
+//  Description: Returns the number of characters that remain to be
+//               read.
+////////////////////////////////////////////////////////////////////
+streamsize MappedStreamBuf::
+showmanyc() {
+  return egptr() - gptr();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: MappedStreamBuf::underflow
+//       Access: Protected, Virtual
+//  Description: Called by the system istream implementation when its
+//               internal buffer needs more characters.  Since the
+//               whole range is already in the buffer, this can only
+//               mean the end of the stream.
+////////////////////////////////////////////////////////////////////
+int MappedStreamBuf::
+underflow() {
+  if (gptr() < egptr()) {
+    return (unsigned char)*gptr();
+  }
+  return EOF;
+}
@@ -0,0 +1,47 @@
+// Filename: mappedStreamBuf.h
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef MAPPEDSTREAMBUF_H
+#define MAPPEDSTREAMBUF_H
+
+#include "pandabase.h"
+#include "mappedFile.h"
+#include "pointerTo.h"
+
+////////////////////////////////////////////////////////////////////
+//       Class : MappedStreamBuf
+// Description : The streambuf object that implements IMappedStream.
+//               Its get area is simply the mapped range itself, so
+//               nothing is ever copied into an intermediate buffer.
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDAEXPRESS MappedStreamBuf : public streambuf {
+public:
+  MappedStreamBuf();
+  virtual ~MappedStreamBuf();
+
+  void open(const MappedFile *file, const unsigned char *start, size_t size);
+  void close();
+
+  virtual streampos seekoff(streamoff off, ios_seekdir dir, ios_openmode which);
+  virtual streampos seekpos(streampos pos, ios_openmode which);
+
+protected:
+  virtual streamsize showmanyc();
+  virtual int underflow();
+
+private:
+  CPT(MappedFile) _file;
+};
+
+#endif
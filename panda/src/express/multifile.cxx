@@ -20,6 +20,7 @@
 #include "datagram.h"
 #include "zStream.h"
 #include "encryptStream.h"
+#include "mappedStream.h"
 #include "virtualFileSystem.h"
 #include "virtualFile.h"
 
@@ -117,6 +118,7 @@ Multifile() :
   
   _read = (IStreamWrapper *)NULL;
   _write = (ostream *)NULL;
+  _mapped_start = 0;
   _offset = 0;
   _owns_stream = false;
   _next_index = 0;
@@ -208,6 +210,23 @@ open_read(const Filename &multifile_name, const streampos &offset) {
   _owns_stream = true;
   _multifile_name = multifile_name;
   _offset = offset;
+
+  // If the Multifile resides, uncompressed, within a file on disk,
+  // map that file too.  The stream is still used to read the index.
+  SubfileInfo info;
+  if (multifile_mmap && vfile->get_system_info(info)) {
+    PT(MappedFile) mapping = new MappedFile;
+    if (mapping->open(info.get_filename()) &&
+        (streamsize)info.get_start() + info.get_size() <= (streamsize)mapping->get_size()) {
+      _mapping = mapping;
+      _mapped_start = (size_t)info.get_start();
+    } else {
+      express_cat.debug()
+        << "Unable to map " << info.get_filename()
+        << "; reading " << multifile_name << " via its stream.\n";
+    }
+  }
+
   return read_index();
 }
 
@@ -394,6 +413,8 @@ close() {
 
   _read = (IStreamWrapper *)NULL;
   _write = (ostream *)NULL;
+  _mapping = NULL;
+  _mapped_start = 0;
   _offset = 0;
   _owns_stream = false;
   _next_index = 0;
@@ -2195,6 +2216,7 @@ read_subfile(int index, pvector<unsigned char> &result) {
   result.reserve(subfile->_uncompressed_length);
 
   bool success = true;
+  const unsigned char *mapped_data;
   if (subfile->_flags & (SF_encrypted | SF_compressed)) {
     // If the subfile is encrypted or compressed, we can't read it
     // directly.  Fall back to the generic implementation.
@@ -2206,6 +2228,11 @@ read_subfile(int index, pvector<unsigned char> &result) {
     success = VirtualFile::simple_read_file(in, result);
     close_read_subfile(in);
 
+  } else if ((mapped_data = get_mapped_data(subfile)) != (const unsigned char *)NULL) {
+    // If the Multifile is mapped, a plain subfile is simply a range
+    // of memory.
+    result.insert(result.end(), mapped_data, mapped_data + subfile->_data_length);
+
   } else {
     // But if the subfile is just a plain file, we can just read the
     // data directly from the Multifile, without paying the cost of an
@@ -2245,6 +2272,33 @@ read_subfile(int index, pvector<unsigned char> &result) {
   return true;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: Multifile::get_subfile_mapped_data
+//       Access: Public
+//  Description: If the Multifile is mapped into memory, and the
+//               indicated subfile is neither compressed nor
+//               encrypted, returns a pointer to its
+//               get_subfile_length() bytes of data, which may be read
+//               directly, without copying and without locking.
+//               Otherwise, returns NULL, and the subfile must be read
+//               with read_subfile() or open_read_subfile() instead.
+//
+//               The pointer remains valid until the Multifile is
+//               closed, provided that the file on disk is not
+//               truncated in the meantime; see multifile-mmap.
+////////////////////////////////////////////////////////////////////
+const unsigned char *Multifile::
+get_subfile_mapped_data(int index) {
+  nassertr(is_read_valid(), NULL);
+  nassertr(index >= 0 && index < (int)_subfiles.size(), NULL);
+  Subfile *subfile = _subfiles[index];
+
+  if ((subfile->_flags & (SF_encrypted | SF_compressed)) != 0) {
+    return NULL;
+  }
+  return get_mapped_data(subfile);
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: Multifile::pad_to_streampos
 //       Access: Private
@@ -2335,11 +2389,19 @@ open_read_subfile(Subfile *subfile) {
            subfile->_source_filename.empty(), NULL);
 
   // Return an ISubStream object that references into the open
-  // Multifile istream.
+  // Multifile istream; or, if the Multifile is mapped, an
+  // IMappedStream that reads straight from memory, without sharing
+  // the Multifile's file pointer and lock.
   nassertr(subfile->_data_start != (streampos)0, NULL);
-  istream *stream = 
-    new ISubStream(_read, _offset + subfile->_data_start,
-                   _offset + subfile->_data_start + (streampos)subfile->_data_length); 
+  istream *stream;
+  const unsigned char *data = get_mapped_data(subfile);
+  if (data != (const unsigned char *)NULL) {
+    stream = new IMappedStream(_mapping, data, subfile->_data_length);
+  } else {
+    stream =
+      new ISubStream(_read, _offset + subfile->_data_start,
+                     _offset + subfile->_data_start + (streampos)subfile->_data_length);
+  }
   
   if ((subfile->_flags & SF_encrypted) != 0) {
 #ifndef HAVE_OPENSSL
@@ -2391,6 +2453,43 @@ open_read_subfile(Subfile *subfile) {
   return stream;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: Multifile::get_mapped_data
+//       Access: Private
+//  Description: Returns a pointer to the raw data of the indicated
+//               subfile, exactly as it is stored in the Multifile
+//               (that is, before decryption and decompression), if
+//               the Multifile is mapped; or NULL otherwise.
+////////////////////////////////////////////////////////////////////
+const unsigned char *Multifile::
+get_mapped_data(const Subfile *subfile) const {
+  if (_mapping == (MappedFile *)NULL ||
+      subfile->_source != (istream *)NULL ||
+      !subfile->_source_filename.empty()) {
+    return NULL;
+  }
+
+  streamsize start = (streamsize)_mapped_start + (streamsize)_offset +
+    (streamsize)subfile->_data_start;
+  streamsize end = start + (streamsize)subfile->_data_length;
+  if (end > (streamsize)_mapping->get_size()) {
+    // The index points past the end of the file.
+    return NULL;
+  }
+
+  if (!_mapping->check_size((size_t)end)) {
+    // Someone has truncated the file since we mapped it; touching
+    // the missing pages would raise SIGBUS.  The stream will report
+    // an ordinary read error instead.
+    express_cat.warning()
+      << _mapping->get_filename() << " has been truncated; reading "
+      << subfile->_name << " via its stream.\n";
+    return NULL;
+  }
+
+  return _mapping->get_data() + (size_t)start;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: Multifile::standardize_subfile_name
 //       Access: Private
@@ -20,6 +20,8 @@
 #include "config_express.h"
 #include "streamWrapper.h"
 #include "subStream.h"
+#include "mappedFile.h"
+#include "pointerTo.h"
 #include "filename.h"
 #include "ordered_vector.h"
 #include "indirectLess.h"
@@ -54,6 +56,7 @@ PUBLISHED:
 
   INLINE bool is_read_valid() const;
   INLINE bool is_write_valid() const;
+  INLINE bool is_mapped() const;
   INLINE bool needs_repack() const;
 
   INLINE time_t get_timestamp() const;
@@ -158,6 +161,7 @@ public:
 
   bool read_subfile(int index, string &result);
   bool read_subfile(int index, pvector<unsigned char> &result);
+  const unsigned char *get_subfile_mapped_data(int index);
 
 private:
   enum SubfileFlags {
@@ -211,6 +215,7 @@ private:
 
   void add_new_subfile(Subfile *subfile, int compression_level);
   istream *open_read_subfile(Subfile *subfile);
+  const unsigned char *get_mapped_data(const Subfile *subfile) const;
   string standardize_subfile_name(const string &subfile_name) const;
 
   void clear_subfiles();
@@ -236,6 +241,12 @@ private:
   streampos _offset;
   IStreamWrapper *_read;
   ostream *_write;
+
+  // If the Multifile was opened for reading from a file on disk, and
+  // multifile-mmap is true, this maps the whole disk file; the
+  // Multifile itself begins at _mapped_start within it.
+  PT(MappedFile) _mapping;
+  size_t _mapped_start;
   bool _owns_stream;
   streampos _next_index;
   streampos _last_index;
@@ -4,6 +4,7 @@
 #include "compress_string.cxx"
 #include "copy_stream.cxx"
 #include "datagram.cxx"
+#include "datagramBufferPool.cxx"
 #include "datagramGenerator.cxx"
 #include "datagramIterator.cxx"
 #include "datagramSink.cxx"
@@ -13,6 +14,8 @@
 #include "fileReference.cxx"
 #include "hashGeneratorBase.cxx"
 #include "hashVal.cxx"
+#include "mappedFile.cxx"
+#include "mappedStreamBuf.cxx"
 #include "memoryInfo.cxx"
 #include "memoryUsage.cxx"
 #include "memoryUsagePointerCounts.cxx"
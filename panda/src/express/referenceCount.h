@@ -64,6 +64,8 @@ public:
   INLINE void weak_unref(WeakPointerToVoid *ptv);
 
 protected:
+  INLINE bool try_unref(int ref_count) const;
+
   bool do_test_ref_count_integrity() const;
   bool do_test_ref_count_nonzero() const;
 
@@ -0,0 +1,141 @@
+// Filename: test_multifile_mmap.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pandabase.h"
+#include "multifile.h"
+#include "load_prc_file.h"
+#include "filename.h"
+#include "trueClock.h"
+
+// This program writes a temporary Multifile full of random subfiles,
+// some of them compressed, and reads them all back twice: once with
+// multifile-mmap enabled, and once without.  It checks that every
+// subfile reads back correctly both ways, via read_subfile() and via
+// open_read_subfile() (with a seek to the middle, for the uncompressed
+// subfiles), and reports the time taken by each.
+
+static const int num_subfiles = 200;
+static const int max_subfile_size = 1 << 20;
+static const int num_passes = 5;
+
+static string
+make_contents(int i) {
+  // A mix of random and repetitive bytes, so that the compressed
+  // subfiles actually compress.
+  size_t size = (size_t)((i * 7919) % max_subfile_size) + i;
+  string contents(size, '\0');
+  unsigned int seed = i * 2654435761u;
+  for (size_t j = 0; j < size; ++j) {
+    seed = seed * 1103515245u + 12345u;
+    contents[j] = (j & 0x100) ? (char)(j & 0x7f) : (char)(seed >> 16);
+  }
+  return contents;
+}
+
+// Reads every subfile of the named Multifile num_passes times,
+// checks the contents, and returns the average number of
+// milliseconds per pass.
+static double
+read_all(const Filename &filename, const pvector<string> &contents,
+         bool mmap, bool &ok) {
+  load_prc_file_data("", mmap ? "multifile-mmap 1" : "multifile-mmap 0");
+
+  PT(Multifile) mf = new Multifile;
+  if (!mf->open_read(filename)) {
+    nout << "Unable to open " << filename << "\n";
+    ok = false;
+    return 0.0;
+  }
+  if (mf->is_mapped() != mmap) {
+    nout << filename << (mmap ? " was not mapped!\n" : " was mapped!\n");
+    ok = false;
+  }
+
+  TrueClock *true_clock = TrueClock::get_global_ptr();
+  double start = true_clock->get_short_time();
+
+  for (int pass = 0; pass < num_passes; ++pass) {
+    for (int i = 0; i < num_subfiles; ++i) {
+      ostringstream strm;
+      strm << "subfile_" << i;
+      int index = mf->find_subfile(strm.str());
+      const string &expected = contents[i];
+
+      string data;
+      if (index < 0 || !mf->read_subfile(index, data) || data != expected) {
+        nout << "  " << strm.str() << " read incorrectly!\n";
+        ok = false;
+        continue;
+      }
+
+      // Seek to the middle of the subfile, and read the rest.  A
+      // compressed stream can't seek, so read all of it instead.
+      istream *in = mf->open_read_subfile(index);
+      size_t half = 0;
+      if (!mf->is_subfile_compressed(index)) {
+        half = expected.size() / 2;
+        in->seekg(half);
+      }
+      string rest(expected.size() - half, '\0');
+      in->read(&rest[0], rest.size());
+      if (in->gcount() != (streamsize)rest.size() ||
+          rest != expected.substr(half)) {
+        nout << "  " << strm.str() << " streamed incorrectly!\n";
+        ok = false;
+      }
+      Multifile::close_read_subfile(in);
+    }
+  }
+
+  double elapsed = true_clock->get_short_time() - start;
+  mf->close();
+  return elapsed * 1000.0 / num_passes;
+}
+
+int
+main(int argc, char *argv[]) {
+  Filename filename = Filename::temporary("", "mmap_test_", ".mf");
+  filename.set_binary();
+
+  pvector<string> contents;
+  pvector<istringstream *> streams;
+  {
+    PT(Multifile) mf = new Multifile;
+    if (!mf->open_write(filename)) {
+      nout << "Unable to write " << filename << "\n";
+      return 1;
+    }
+    for (int i = 0; i < num_subfiles; ++i) {
+      contents.push_back(make_contents(i));
+      streams.push_back(new istringstream(contents.back()));
+
+      ostringstream strm;
+      strm << "subfile_" << i;
+      mf->add_subfile(strm.str(), streams.back(), (i % 3 == 0) ? 6 : 0);
+    }
+    mf->close();
+  }
+  for (size_t i = 0; i < streams.size(); ++i) {
+    delete streams[i];
+  }
+
+  bool ok = true;
+  double stream_ms = read_all(filename, contents, false, ok);
+  double mmap_ms = read_all(filename, contents, true, ok);
+  nout << num_subfiles << " subfiles: " << stream_ms << " ms via stream, "
+       << mmap_ms << " ms mapped, " << stream_ms / mmap_ms << "x\n";
+
+  filename.unlink();
+  return ok ? 0 : 1;
+}
@@ -90,6 +90,15 @@ read_file(const Filename &file, bool do_uncompress,
     return false;
   }
 
+  // Better yet, if the Multifile is mapped into memory, we can copy
+  // the data straight out of the mapping.
+  const unsigned char *data = _multifile->get_subfile_mapped_data(subfile_index);
+  if (data != (const unsigned char *)NULL) {
+    size_t length = _multifile->get_subfile_length(subfile_index);
+    result.assign(data, data + length);
+    return true;
+  }
+
   return _multifile->read_subfile(subfile_index, result);
 }
 
@@ -13,6 +13,7 @@
 ////////////////////////////////////////////////////////////////////
 
 #include "virtualFileSimple.h"
+#include "virtualFileSystem.h"
 #include "virtualFileMount.h"
 #include "virtualFileList.h"
 #include "dcast.h"
@@ -110,6 +111,7 @@ is_writable() const {
 ////////////////////////////////////////////////////////////////////
 bool VirtualFileSimple::
 delete_file() {
+  forget_prefetched_file();
   return _mount->delete_file(_local_filename);
 }
 
@@ -132,6 +134,12 @@ delete_file() {
 ////////////////////////////////////////////////////////////////////
 bool VirtualFileSimple::
 rename_file(VirtualFile *new_file) {
+  VirtualFileSystem *vfs = get_file_system();
+  if (vfs->has_prefetched_files()) {
+    vfs->forget_prefetched_file(get_filename());
+    vfs->forget_prefetched_file(new_file->get_filename());
+  }
+
   if (new_file->is_of_type(VirtualFileSimple::get_class_type())) {
     VirtualFileSimple *new_file_simple = DCAST(VirtualFileSimple, new_file);
     if (new_file_simple->_mount == _mount) {
@@ -165,6 +173,11 @@ rename_file(VirtualFile *new_file) {
 ////////////////////////////////////////////////////////////////////
 bool VirtualFileSimple::
 copy_file(VirtualFile *new_file) {
+  VirtualFileSystem *vfs = get_file_system();
+  if (vfs->has_prefetched_files()) {
+    vfs->forget_prefetched_file(new_file->get_filename());
+  }
+
   if (new_file->is_of_type(VirtualFileSimple::get_class_type())) {
     VirtualFileSimple *new_file_simple = DCAST(VirtualFileSimple, new_file);
     if (new_file_simple->_mount == _mount) {
@@ -235,6 +248,21 @@ open_read_file(bool auto_unwrap) const {
     local_filename.set_binary();
   }
 
+  VirtualFileSystem *vfs = get_file_system();
+  if (vfs->has_prefetched_files()) {
+    pvector<unsigned char> data;
+    if (vfs->take_prefetched_file(get_filename(), do_uncompress, data)) {
+      // The file has already been read for us.  We pay for one more
+      // copy into the stream, but that is still much cheaper than
+      // going back to the disk and decompressing it again.
+      string contents;
+      if (!data.empty()) {
+        contents.assign((const char *)&data[0], data.size());
+      }
+      return new istringstream(contents);
+    }
+  }
+
   return _mount->open_read_file(local_filename, do_uncompress);
 }
 
@@ -267,6 +295,8 @@ close_read_file(istream *stream) const {
 ////////////////////////////////////////////////////////////////////
 ostream *VirtualFileSimple::
 open_write_file(bool auto_wrap, bool truncate) {
+  forget_prefetched_file();
+
   // Will we be automatically wrapping a .pz file?
   bool do_compress = (_implicit_pz_file || (auto_wrap && _local_filename.get_extension() == "pz"));
 
@@ -289,6 +319,7 @@ open_write_file(bool auto_wrap, bool truncate) {
 ////////////////////////////////////////////////////////////////////
 ostream *VirtualFileSimple::
 open_append_file() {
+  forget_prefetched_file();
   return _mount->open_append_file(_local_filename);
 }
 
@@ -304,6 +335,9 @@ open_append_file() {
 void VirtualFileSimple::
 close_write_file(ostream *stream) {
   _mount->close_write_file(stream);
+
+  // A prefetch may have read the file while it was being written.
+  forget_prefetched_file();
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -316,6 +350,7 @@ close_write_file(ostream *stream) {
 ////////////////////////////////////////////////////////////////////
 iostream *VirtualFileSimple::
 open_read_write_file(bool truncate) {
+  forget_prefetched_file();
   return _mount->open_read_write_file(_local_filename, truncate);
 }
 
@@ -329,6 +364,7 @@ open_read_write_file(bool truncate) {
 ////////////////////////////////////////////////////////////////////
 iostream *VirtualFileSimple::
 open_read_append_file() {
+  forget_prefetched_file();
   return _mount->open_read_append_file(_local_filename);
 }
 
@@ -344,6 +380,9 @@ open_read_append_file() {
 void VirtualFileSimple::
 close_read_write_file(iostream *stream) {
   _mount->close_read_write_file(stream);
+
+  // A prefetch may have read the file while it was being written.
+  forget_prefetched_file();
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -414,7 +453,10 @@ bool VirtualFileSimple::
 atomic_compare_and_exchange_contents(string &orig_contents,
                                      const string &old_contents, 
                                      const string &new_contents) {
-  return _mount->atomic_compare_and_exchange_contents(_local_filename, orig_contents, old_contents, new_contents);
+  forget_prefetched_file();
+  bool okflag = _mount->atomic_compare_and_exchange_contents(_local_filename, orig_contents, old_contents, new_contents);
+  forget_prefetched_file();
+  return okflag;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -446,6 +488,12 @@ read_file(pvector<unsigned char> &result, bool auto_unwrap) const {
     local_filename.set_binary();
   }
 
+  VirtualFileSystem *vfs = get_file_system();
+  if (vfs->has_prefetched_files() &&
+      vfs->take_prefetched_file(get_filename(), do_uncompress, result)) {
+    return true;
+  }
+
   return _mount->read_file(local_filename, do_uncompress, result);
 }
 
@@ -457,6 +505,8 @@ read_file(pvector<unsigned char> &result, bool auto_unwrap) const {
 ////////////////////////////////////////////////////////////////////
 bool VirtualFileSimple::
 write_file(const unsigned char *data, size_t data_size, bool auto_wrap) {
+  forget_prefetched_file();
+
   // Will we be automatically wrapping a .pz file?
   bool do_compress = (_implicit_pz_file || (auto_wrap && _local_filename.get_extension() == "pz"));
 
@@ -466,7 +516,76 @@ write_file(const unsigned char *data, size_t data_size, bool auto_wrap) {
     local_filename.set_binary();
   }
 
-  return _mount->write_file(local_filename, do_compress, data, data_size);
+  bool okflag = _mount->write_file(local_filename, do_compress, data, data_size);
+
+  // Forget it again, in case a prefetch read the file while we were
+  // writing it.
+  forget_prefetched_file();
+  return okflag;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: VirtualFileSimple::prefetch
+//       Access: Public
+//  Description: Reads the entire contents of the file, decompressing
+//               it if necessary, and stores it in the
+//               VirtualFileSystem's prefetch cache, to be returned by
+//               the next call to read_file() or open_read_file().
+//               See VirtualFileSystem::prefetch_file().
+////////////////////////////////////////////////////////////////////
+bool VirtualFileSimple::
+prefetch(bool auto_unwrap) const {
+  VirtualFileSystem *vfs = get_file_system();
+
+  // Will we be automatically unwrapping a .pz file?
+  bool do_uncompress = (_implicit_pz_file || (auto_unwrap && _local_filename.get_extension() == "pz"));
+
+  Filename filename = get_filename();
+  if (vfs->has_prefetched_file(filename, do_uncompress)) {
+    return true;
+  }
+
+  Filename local_filename(_local_filename);
+  if (do_uncompress) {
+    // .pz files are always binary, of course.
+    local_filename.set_binary();
+  } else {
+    // We know how big the file will be, so we can tell without
+    // reading it whether it will fit.
+    streamsize size = get_file_size();
+    if ((PN_int64)size + (PN_int64)vfs->get_prefetch_size() > vfs->vfs_prefetch_limit) {
+      return false;
+    }
+  }
+
+  // If the file is written or anything is mounted while we are
+  // reading it, store_prefetched_file() will throw away what we read.
+  unsigned int mount_seq = vfs->get_mount_seq();
+  unsigned int write_seq = vfs->begin_prefetch(filename);
+
+  pvector<unsigned char> data;
+  if (!_mount->read_file(local_filename, do_uncompress, data)) {
+    vfs->end_prefetch(filename);
+    return false;
+  }
+
+  return vfs->store_prefetched_file(filename, do_uncompress, mount_seq,
+                                    write_seq, data);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: VirtualFileSimple::forget_prefetched_file
+//       Access: Private
+//  Description: Removes this file from the VirtualFileSystem's
+//               prefetch cache, if it is there, because it is about
+//               to be modified, or has just been.
+////////////////////////////////////////////////////////////////////
+void VirtualFileSimple::
+forget_prefetched_file() const {
+  VirtualFileSystem *vfs = get_file_system();
+  if (vfs->has_prefetched_files()) {
+    vfs->forget_prefetched_file(get_filename());
+  }
 }
 
 ////////////////////////////////////////////////////////////////////
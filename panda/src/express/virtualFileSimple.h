@@ -69,11 +69,15 @@ public:
   virtual bool read_file(pvector<unsigned char> &result, bool auto_unwrap) const;
   virtual bool write_file(const unsigned char *data, size_t data_size, bool auto_wrap);
 
+  bool prefetch(bool auto_unwrap) const;
+
 protected:
   virtual bool scan_local_directory(VirtualFileList *file_list, 
                                     const ov_set<string> &mount_points) const;
 
 private:
+  void forget_prefetched_file() const;
+
   VirtualFileMount *_mount;
   Filename _local_filename;
   bool _implicit_pz_file;
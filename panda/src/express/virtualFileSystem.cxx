@@ -65,10 +65,21 @@ VirtualFileSystem() :
             "will implicitly retrieve a file named 'dirname/mytex.jpg' "
             "within the multifile /c/files/foo.mf, even if the multifile "
             "has not already been mounted.  This makes all of your multifiles "
-            "act like directories."))
+            "act like directories.")),
+  vfs_prefetch_limit
+  ("vfs-prefetch-limit", 64 * 1024 * 1024,
+   PRC_DESC("The maximum number of bytes of file data that may be held in "
+            "memory by VirtualFileSystem::prefetch_file(), waiting to be "
+            "read.  Files that are prefetched once the limit has been "
+            "reached are not kept, and will be read from disk in the "
+            "usual way when they are needed.  Set this to 0 to disable "
+            "prefetching."))
 {
   _cwd = "/";
   _mount_seq = 0;
+  _prefetch_size = 0;
+  _num_prefetched = 0;
+  _num_pending_prefetches = 0;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -1107,6 +1118,101 @@ close_read_write_file(iostream *stream) {
   }
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: VirtualFileSystem::prefetch_file
+//       Access: Published
+//  Description: Reads the entire contents of the indicated file into
+//               memory, decompressing it if necessary, so that the
+//               next call to read_file() or open_read_file() for the
+//               same file can return the data immediately, without
+//               touching the disk again.  The data is released as
+//               soon as it has been read once.
+//
+//               This is intended to be called from a thread other
+//               than the one that will eventually read the file;
+//               see Loader::prefetch_file(), which does this on a
+//               pool of threads.  auto_unwrap should be the same
+//               value that will be passed to read_file() or
+//               open_read_file() later.
+//
+//               Returns true if the file is now in the cache, or
+//               false if it could not be read, or if there is no
+//               room for it within vfs-prefetch-limit.
+////////////////////////////////////////////////////////////////////
+bool VirtualFileSystem::
+prefetch_file(const Filename &filename, bool auto_unwrap) {
+  PT(VirtualFile) file = get_file(filename, false);
+  if (file == (VirtualFile *)NULL ||
+      !file->is_of_type(VirtualFileSimple::get_class_type())) {
+    return false;
+  }
+
+  VirtualFileSimple *simple = DCAST(VirtualFileSimple, file);
+  return simple->prefetch(auto_unwrap);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: VirtualFileSystem::is_prefetched
+//       Access: Published
+//  Description: Returns true if the indicated file has been read by
+//               prefetch_file(), and is waiting in memory to be read
+//               again.
+////////////////////////////////////////////////////////////////////
+bool VirtualFileSystem::
+is_prefetched(const Filename &filename) const {
+  if (!has_prefetched_files()) {
+    return false;
+  }
+  PT(VirtualFile) file = get_file(filename, true);
+  if (file == (VirtualFile *)NULL) {
+    return false;
+  }
+  Filename name = file->get_filename();
+  return has_prefetched_file(name, false) || has_prefetched_file(name, true);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: VirtualFileSystem::get_num_prefetched_files
+//       Access: Published
+//  Description: Returns the number of files that have been read by
+//               prefetch_file() and not yet read by the application.
+////////////////////////////////////////////////////////////////////
+int VirtualFileSystem::
+get_num_prefetched_files() const {
+  return (int)AtomicAdjust::get(_num_prefetched);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: VirtualFileSystem::get_prefetch_size
+//       Access: Published
+//  Description: Returns the total number of bytes held by the files
+//               that have been read by prefetch_file() and not yet
+//               read by the application.  This will not exceed
+//               vfs-prefetch-limit.
+////////////////////////////////////////////////////////////////////
+size_t VirtualFileSystem::
+get_prefetch_size() const {
+  ((VirtualFileSystem *)this)->_prefetch_lock.acquire();
+  size_t size = _prefetch_size;
+  ((VirtualFileSystem *)this)->_prefetch_lock.release();
+  return size;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: VirtualFileSystem::clear_prefetch_cache
+//       Access: Published
+//  Description: Discards all of the files that have been read by
+//               prefetch_file() and not yet read by the application.
+////////////////////////////////////////////////////////////////////
+void VirtualFileSystem::
+clear_prefetch_cache() {
+  _prefetch_lock.acquire();
+  _prefetched_files.clear();
+  _prefetch_size = 0;
+  AtomicAdjust::set(_num_prefetched, 0);
+  _prefetch_lock.release();
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: VirtualFileSystem::atomic_compare_and_exchange_contents
 //       Access: Public
@@ -1184,6 +1290,236 @@ scan_mount_points(vector_string &names, const Filename &path) const {
 }
 
         
+////////////////////////////////////////////////////////////////////
+//     Function: VirtualFileSystem::has_prefetched_file
+//       Access: Public
+//  Description: Returns true if the indicated file, which should be
+//               the full filename returned by
+//               VirtualFile::get_filename(), is waiting in the
+//               prefetch cache with the indicated decompression.
+////////////////////////////////////////////////////////////////////
+bool VirtualFileSystem::
+has_prefetched_file(const Filename &filename, bool do_uncompress) const {
+  if (!has_prefetched_files()) {
+    return false;
+  }
+
+  ((VirtualFileSystem *)this)->_prefetch_lock.acquire();
+  bool found = (_prefetched_files.find(PrefetchKey(filename, do_uncompress)) != _prefetched_files.end());
+  ((VirtualFileSystem *)this)->_prefetch_lock.release();
+  return found;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: VirtualFileSystem::begin_prefetch
+//       Access: Public
+//  Description: Called before the indicated file is read for the
+//               prefetch cache.  Returns the file's write sequence
+//               number, which must be passed to
+//               store_prefetched_file() along with the data.  If the
+//               file cannot be read after all, end_prefetch() must
+//               be called instead.
+////////////////////////////////////////////////////////////////////
+unsigned int VirtualFileSystem::
+begin_prefetch(const Filename &filename) {
+  _prefetch_lock.acquire();
+  PendingPrefetches::iterator pi = _pending_prefetches.find(filename);
+  if (pi == _pending_prefetches.end()) {
+    PendingPrefetch pending;
+    pending._count = 0;
+    pending._write_seq = 0;
+    pi = _pending_prefetches.insert(PendingPrefetches::value_type(filename, pending)).first;
+  }
+  ++(*pi).second._count;
+  unsigned int write_seq = (*pi).second._write_seq;
+  AtomicAdjust::inc(_num_pending_prefetches);
+  _prefetch_lock.release();
+  return write_seq;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: VirtualFileSystem::end_prefetch
+//       Access: Public
+//  Description: Called instead of store_prefetched_file() if a file
+//               passed to begin_prefetch() could not be read.
+////////////////////////////////////////////////////////////////////
+void VirtualFileSystem::
+end_prefetch(const Filename &filename) {
+  _prefetch_lock.acquire();
+  do_end_prefetch(filename);
+  _prefetch_lock.release();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: VirtualFileSystem::store_prefetched_file
+//       Access: Public
+//  Description: Adds the contents of the indicated file to the
+//               prefetch cache.  mount_seq should be the value
+//               returned by get_mount_seq() before the file was read;
+//               if anything has been mounted or unmounted since, the
+//               data may not belong to this filename any more, and
+//               it is not kept.  Similarly, write_seq should be the
+//               value returned by begin_prefetch(); if the file has
+//               been written since, the data is out of date, and it
+//               is not kept.
+//
+//               The data is swapped out of the pvector, which is
+//               left empty, if it is kept.  Returns true if the file
+//               is in the cache, false if there was no room for it.
+////////////////////////////////////////////////////////////////////
+bool VirtualFileSystem::
+store_prefetched_file(const Filename &filename, bool do_uncompress,
+                      unsigned int mount_seq, unsigned int write_seq,
+                      pvector<unsigned char> &data) {
+  unsigned int current_mount_seq = get_mount_seq();
+
+  _prefetch_lock.acquire();
+  if (do_end_prefetch(filename) != write_seq || 
+      mount_seq != current_mount_seq) {
+    // The file was written, or the mounts changed, while we were
+    // reading it.
+    _prefetch_lock.release();
+    if (express_cat->is_debug()) {
+      express_cat->debug()
+        << "Not prefetching " << filename << "; it changed while being read.\n";
+    }
+    return false;
+  }
+
+  PrefetchKey key(filename, do_uncompress);
+  if (_prefetched_files.find(key) != _prefetched_files.end()) {
+    // Someone else got here first.
+    _prefetch_lock.release();
+    return true;
+  }
+
+  // The files are prefetched in the order they will be needed, so
+  // when the cache is full, it's the newcomer that gets turned away,
+  // rather than any of the files that are already waiting.
+  size_t limit = (size_t)max(vfs_prefetch_limit.get_value(), (PN_int64)0);
+  if (_prefetch_size + data.size() > limit) {
+    _prefetch_lock.release();
+    if (express_cat->is_debug()) {
+      express_cat->debug()
+        << "No room to prefetch " << filename << " (" << data.size()
+        << " bytes)\n";
+    }
+    return false;
+  }
+
+  PrefetchedFile &file = _prefetched_files[key];
+  file._mount_seq = mount_seq;
+  file._data.swap(data);
+  _prefetch_size += file._data.size();
+  AtomicAdjust::inc(_num_prefetched);
+  _prefetch_lock.release();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: VirtualFileSystem::take_prefetched_file
+//       Access: Public
+//  Description: If the indicated file is waiting in the prefetch
+//               cache, removes it from the cache, fills result with
+//               its contents, and returns true.  Otherwise, returns
+//               false, and the file must be read in the usual way.
+////////////////////////////////////////////////////////////////////
+bool VirtualFileSystem::
+take_prefetched_file(const Filename &filename, bool do_uncompress,
+                     pvector<unsigned char> &result) {
+  if (!has_prefetched_files()) {
+    return false;
+  }
+
+  unsigned int mount_seq = get_mount_seq();
+
+  _prefetch_lock.acquire();
+  PrefetchedFiles::iterator fi = _prefetched_files.find(PrefetchKey(filename, do_uncompress));
+  if (fi == _prefetched_files.end()) {
+    _prefetch_lock.release();
+    return false;
+  }
+
+  // If the mounts have changed since the file was prefetched, it may
+  // not be the same file any more; throw it away.
+  PrefetchedFile &file = (*fi).second;
+  _prefetch_size -= file._data.size();
+  bool valid = (file._mount_seq == mount_seq);
+  if (valid) {
+    result.swap(file._data);
+  }
+  _prefetched_files.erase(fi);
+  AtomicAdjust::dec(_num_prefetched);
+  _prefetch_lock.release();
+
+  return valid;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: VirtualFileSystem::forget_prefetched_file
+//       Access: Public
+//  Description: Removes the indicated file from the prefetch cache,
+//               if it is there.  This is called whenever the file is
+//               modified.  If the file is being prefetched right now,
+//               that data will not be kept, either.
+////////////////////////////////////////////////////////////////////
+void VirtualFileSystem::
+forget_prefetched_file(const Filename &filename) {
+  if (!has_prefetched_files()) {
+    return;
+  }
+
+  _prefetch_lock.acquire();
+  PendingPrefetches::iterator pi = _pending_prefetches.find(filename);
+  if (pi != _pending_prefetches.end()) {
+    ++(*pi).second._write_seq;
+  }
+  for (int i = 0; i < 2; ++i) {
+    PrefetchedFiles::iterator fi = _prefetched_files.find(PrefetchKey(filename, i != 0));
+    if (fi != _prefetched_files.end()) {
+      _prefetch_size -= (*fi).second._data.size();
+      _prefetched_files.erase(fi);
+      AtomicAdjust::dec(_num_prefetched);
+    }
+  }
+  _prefetch_lock.release();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: VirtualFileSystem::do_end_prefetch
+//       Access: Private
+//  Description: The implementation of end_prefetch(); this assumes
+//               the _prefetch_lock is already held.  Returns the
+//               file's write sequence number, as of the end of the
+//               prefetch.
+////////////////////////////////////////////////////////////////////
+unsigned int VirtualFileSystem::
+do_end_prefetch(const Filename &filename) {
+  PendingPrefetches::iterator pi = _pending_prefetches.find(filename);
+  nassertr(pi != _pending_prefetches.end(), 0);
+  unsigned int write_seq = (*pi).second._write_seq;
+  --(*pi).second._count;
+  if ((*pi).second._count == 0) {
+    _pending_prefetches.erase(pi);
+  }
+  AtomicAdjust::dec(_num_pending_prefetches);
+  return write_seq;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: VirtualFileSystem::get_mount_seq
+//       Access: Public
+//  Description: Returns a number that changes every time anything is
+//               mounted or unmounted.
+////////////////////////////////////////////////////////////////////
+unsigned int VirtualFileSystem::
+get_mount_seq() const {
+  ((VirtualFileSystem *)this)->_lock.acquire();
+  unsigned int mount_seq = _mount_seq;
+  ((VirtualFileSystem *)this)->_lock.release();
+  return mount_seq;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: VirtualFileSystem::parse_options
 //       Access: Public, Static
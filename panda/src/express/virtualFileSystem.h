@@ -26,6 +26,9 @@
 #include "config_express.h"
 #include "mutexImpl.h"
 #include "pvector.h"
+#include "pmap.h"
+#include "atomicAdjust.h"
+#include "configVariableInt64.h"
 
 class Multifile;
 class VirtualFileComposite;
@@ -111,6 +114,12 @@ PUBLISHED:
   BLOCKING iostream *open_read_append_file(const Filename &filename);
   BLOCKING static void close_read_write_file(iostream *stream);
 
+  BLOCKING bool prefetch_file(const Filename &filename, bool auto_unwrap = true);
+  bool is_prefetched(const Filename &filename) const;
+  int get_num_prefetched_files() const;
+  size_t get_prefetch_size() const;
+  void clear_prefetch_cache();
+
 public:
   // We provide Python versions of these as efficient extension methods, above.
   BLOCKING INLINE string read_file(const Filename &filename, bool auto_unwrap) const;
@@ -124,6 +133,18 @@ public:
   INLINE bool write_file(const Filename &filename, const unsigned char *data, size_t data_size, bool auto_wrap);
 
   void scan_mount_points(vector_string &names, const Filename &path) const;
+
+  INLINE bool has_prefetched_files() const;
+  bool has_prefetched_file(const Filename &filename, bool do_uncompress) const;
+  unsigned int begin_prefetch(const Filename &filename);
+  void end_prefetch(const Filename &filename);
+  bool store_prefetched_file(const Filename &filename, bool do_uncompress,
+                             unsigned int mount_seq, unsigned int write_seq,
+                             pvector<unsigned char> &data);
+  bool take_prefetched_file(const Filename &filename, bool do_uncompress,
+                            pvector<unsigned char> &result);
+  void forget_prefetched_file(const Filename &filename);
+  unsigned int get_mount_seq() const;
  
   static void parse_options(const string &options,
                             int &flags, string &password);
@@ -147,6 +168,7 @@ public:
   ConfigVariableBool vfs_case_sensitive;
   ConfigVariableBool vfs_implicit_pz;
   ConfigVariableBool vfs_implicit_mf;
+  ConfigVariableInt64 vfs_prefetch_limit;
 
 private:
   Filename normalize_mount_point(const Filename &mount_point) const;
@@ -158,6 +180,7 @@ private:
                       const Filename &original_filename, bool implicit_pz_file,
                       int open_flags) const;
   bool consider_mount_mf(const Filename &filename);
+  unsigned int do_end_prefetch(const Filename &filename);
 
   MutexImpl _lock;
   typedef pvector<PT(VirtualFileMount) > Mounts;
@@ -166,6 +189,35 @@ private:
 
   Filename _cwd;
 
+  // The files that have been read ahead by prefetch_file(), waiting
+  // to be read by the application.  Each one is keyed on its
+  // filename within the VirtualFileSystem, and whether it was
+  // decompressed on the way in.
+  class PrefetchedFile {
+  public:
+    unsigned int _mount_seq;
+    pvector<unsigned char> _data;
+  };
+  typedef pair<Filename, bool> PrefetchKey;
+  typedef pmap<PrefetchKey, PrefetchedFile> PrefetchedFiles;
+  PrefetchedFiles _prefetched_files;
+  size_t _prefetch_size;
+  AtomicAdjust::Integer _num_prefetched;
+
+  // The files that are being read by prefetch_file() right now.
+  // Each has a count of the prefetches in progress, and a number that
+  // changes whenever the file is written, so that a prefetch that
+  // raced with a write can tell its data is stale.
+  class PendingPrefetch {
+  public:
+    int _count;
+    unsigned int _write_seq;
+  };
+  typedef pmap<Filename, PendingPrefetch> PendingPrefetches;
+  PendingPrefetches _pending_prefetches;
+  AtomicAdjust::Integer _num_pending_prefetches;
+  MutexImpl _prefetch_lock;
+
   static VirtualFileSystem *_global_ptr;
 };
 
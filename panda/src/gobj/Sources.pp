@@ -253,3 +253,32 @@
 
 #end test_bin_target
 
+#begin test_bin_target
+  #define TARGET test_skinning
+  #define LOCAL_LIBS \
+    p3gobj p3putil
+
+  #define SOURCES \
+    test_skinning.cxx
+
+#end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_bam_payload
+  #define LOCAL_LIBS \
+    p3gobj p3putil
+
+  #define SOURCES \
+    test_bam_payload.cxx
+
+#end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_bam_mmap
+  #define LOCAL_LIBS \
+    p3gobj p3putil
+
+  #define SOURCES \
+    test_bam_mmap.cxx
+
+#end test_bin_target
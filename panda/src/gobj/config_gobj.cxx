@@ -313,6 +313,16 @@ ConfigVariableBool vertex_animation_align_16
           "impacts only vertex formats created within Panda subsystems; custom "
           "vertex formats are not affected."));
 
+ConfigVariableBool fast_cpu_skinning
+("fast-cpu-skinning", true,
+ PRC_DESC("Set this true to use a specialized code path, vectorized where "
+          "the platform allows it, when soft-skinned vertices are animated "
+          "on the CPU and the vertex format is the common case of float32 "
+          "vertices and normals with a single uint16 transform_blend index.  "
+          "Other formats always use the general-purpose code path.  This "
+          "should only need to be set false to compare the results of the "
+          "two code paths."));
+
 ConfigVariableEnum<AutoTextureScale> textures_power_2
 ("textures-power-2", ATS_down,
  PRC_DESC("Specify whether textures should automatically be constrained to "
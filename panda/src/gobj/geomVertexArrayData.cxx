@@ -20,6 +20,7 @@
 #include "bamWriter.h"
 #include "pset.h"
 #include "config_gobj.h"
+#include "config_util.h"
 #include "pStatTimer.h"
 #include "configVariableInt.h"
 #include "simpleAllocator.h"
@@ -534,6 +535,23 @@ finalize(BamReader *manager) {
 
   PT(BamAuxData) aux_data = (BamAuxData *)manager->get_aux_data(this, "");
   if (aux_data != (BamAuxData *)NULL) {
+    if (aux_data->_payload != (BamPayload *)NULL) {
+      // Collect the data from the payload record.  If it hasn't been
+      // decoded yet, this will decode it now, or wait for the thread
+      // that is already decoding it.
+      const unsigned char *data = aux_data->_payload->get_data();
+      if (data != (const unsigned char *)NULL &&
+          aux_data->_payload->get_size() == cdata->_buffer.get_size()) {
+        memcpy(cdata->_buffer.get_write_pointer(), data, cdata->_buffer.get_size());
+      } else {
+        gobj_cat.error()
+          << "Unable to decode vertex data for " << *this << "\n";
+        memset(cdata->_buffer.get_write_pointer(), 0, cdata->_buffer.get_size());
+        manager->set_error();
+      }
+      aux_data->_payload = NULL;
+    }
+
     if (aux_data->_endian_reversed) {
       // Now is the time to endian-reverse the data.
       VertexDataBuffer new_buffer(cdata->_buffer.get_size());
@@ -613,7 +631,31 @@ write_datagram(BamWriter *manager, Datagram &dg, void *extra_data) const {
 
   dg.add_uint32(_buffer.get_size());
 
-  if (manager->get_file_endian() == BamWriter::BE_native) {
+  // Large arrays are written to a separate payload record, which the
+  // reader can decode in the background.
+  bool use_payload = (bam_payload_threshold > 0 &&
+                      _buffer.get_size() >= (size_t)bam_payload_threshold);
+  dg.add_bool(use_payload);
+
+  if (use_payload) {
+    bool written;
+    if (manager->get_file_endian() == BamWriter::BE_native) {
+      written = manager->write_payload(_buffer.get_read_pointer(true), _buffer.get_size());
+    } else {
+      // These may be too large for alloca().
+      VertexDataBuffer new_buffer(_buffer.get_size());
+      array_data->reverse_data_endianness(new_buffer.get_write_pointer(), _buffer.get_read_pointer(true), _buffer.get_size());
+      written = manager->write_payload(new_buffer.get_read_pointer(true), _buffer.get_size());
+    }
+    if (!written) {
+      // The reader will be expecting a payload record that isn't
+      // there, so the whole stream is now unusable.
+      gobj_cat.error()
+        << "Unable to write vertex data for " << *array_data << "\n";
+      manager->set_error();
+    }
+
+  } else if (manager->get_file_endian() == BamWriter::BE_native) {
     // For native endianness, we only have to write the data directly.
     dg.append_data(_buffer.get_read_pointer(true), _buffer.get_size());
 
@@ -636,6 +678,7 @@ void GeomVertexArrayData::CData::
 fillin(DatagramIterator &scan, BamReader *manager, void *extra_data) {
   GeomVertexArrayData *array_data = (GeomVertexArrayData *)extra_data;
   _usage_hint = (UsageHint)scan.get_uint8();
+  PT(BamPayload) payload;
 
   if (manager->get_file_minor_ver() < 8) {
     // Before bam version 6.8, the array data was a PTA_uchar.
@@ -648,18 +691,62 @@ fillin(DatagramIterator &scan, BamReader *manager, void *extra_data) {
   } else {
     // Now, the array data is just stored directly.
     size_t size = scan.get_uint32();
-    _buffer.unclean_realloc(size);
-    _buffer.set_size(size);
 
-    const unsigned char *source_data = 
-      (const unsigned char *)scan.get_datagram().get_data();
-    memcpy(_buffer.get_write_pointer(), source_data + scan.get_current_index(), size);
-    scan.skip_bytes(size);
+    bool has_payload = false;
+    if (manager->get_file_minor_ver() >= 39) {
+      // As of bam version 6.39, large arrays may be stored in a
+      // payload record instead.
+      has_payload = scan.get_bool();
+      if (has_payload) {
+        payload = manager->read_payload();
+        if (payload != (BamPayload *)NULL && payload->get_size() != size) {
+          gobj_cat.error()
+            << "Vertex data payload has " << payload->get_size()
+            << " bytes, expected " << size << "\n";
+          payload = NULL;
+        }
+        if (payload == (BamPayload *)NULL) {
+          manager->set_error();
+        }
+      }
+    }
+
+    if (payload != (BamPayload *)NULL &&
+        payload->get_mapping() != (MappedFile *)NULL &&
+        manager->get_file_endian() == BamReader::BE_native &&
+        ((size_t)payload->get_data() % sizeof(PN_float64)) == 0) {
+      // The payload is in a memory mapping of the bam file, in the
+      // form we need and suitably aligned, so we can use it in place.
+      // It will be copied only if the array is modified.
+      _buffer.set_mapped_data(payload->get_mapping(), payload->get_data(), size);
+      payload = NULL;
+
+    } else {
+      _buffer.unclean_realloc(size);
+      _buffer.set_size(size);
+
+      if (!has_payload) {
+        const unsigned char *source_data = 
+          (const unsigned char *)scan.get_datagram().get_data();
+        memcpy(_buffer.get_write_pointer(), source_data + scan.get_current_index(), size);
+        scan.skip_bytes(size);
+
+      } else if (payload == (BamPayload *)NULL) {
+        // The payload was missing or unusable; the error has been
+        // reported already.
+        memset(_buffer.get_write_pointer(), 0, size);
+      }
+    }
   }
 
   bool endian_reversed = false;
 
-  if (manager->get_file_endian() != BamReader::BE_native) {
+  if (payload != (BamPayload *)NULL) {
+    // The data won't be in the buffer until finalize(), so any
+    // endian conversion has to wait until then too.
+    endian_reversed = (manager->get_file_endian() != BamReader::BE_native);
+
+  } else if (manager->get_file_endian() != BamReader::BE_native) {
     // For non-native endian files, we have to convert the data.  
 
     if (array_data->_array_format == (GeomVertexArrayFormat *)NULL) {
@@ -676,9 +763,10 @@ fillin(DatagramIterator &scan, BamReader *manager, void *extra_data) {
     }
   }
 
-  if (endian_reversed) {
+  if (endian_reversed || payload != (BamPayload *)NULL) {
     PT(BamAuxData) aux_data = new BamAuxData;
     aux_data->_endian_reversed = endian_reversed;
+    aux_data->_payload = payload;
     manager->set_aux_data(array_data, "", aux_data);
   }
 
@@ -33,6 +33,7 @@
 #include "vertexDataBuffer.h"
 #include "config_gobj.h"
 #include "bamReader.h"
+#include "bamPayload.h"
 
 class PreparedGraphicsObjects;
 class VertexBufferContext;
@@ -147,6 +148,10 @@ private:
     // set true to indicate the data must be endian-reversed in
     // finalize().
     bool _endian_reversed;
+
+    // If the data was stored in a payload record, it may still be
+    // decoding; it is copied into the buffer in finalize().
+    PT(BamPayload) _payload;
   };
 
   // This is the data that must be cycled between pipeline stages.
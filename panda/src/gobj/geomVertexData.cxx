@@ -21,8 +21,20 @@
 #include "bamReader.h"
 #include "bamWriter.h"
 #include "pset.h"
+#include "epvector.h"
 #include "indent.h"
 
+// The SSE2 versions of the skinning functions used by
+// do_skin_float32() perform the same IEEE operations, in the same
+// order, as the LMatrix4f methods they replace.  (With -ffast-math,
+// the compiler may still reorder the LMatrix4f methods, so the results
+// can differ in the last bit.)
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+#define GEOMVERTEXDATA_SSE2
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#endif
+
 TypeHandle GeomVertexData::_type_handle;
 TypeHandle GeomVertexData::CDataCache::_type_handle;
 TypeHandle GeomVertexData::CacheEntry::_type_handle;
@@ -1672,6 +1684,12 @@ update_animated_vertices(GeomVertexData::CData *cdata, Thread *current_thread) {
       return;
     }
 
+    if (fast_cpu_skinning &&
+        do_skin_float32(cdata, blend_array_index, new_data, tb_table,
+                        current_thread)) {
+      return;
+    }
+
     CPT(GeomVertexArrayFormat) blend_array_format = orig_format->get_array(blend_array_index);
 
     if (blend_array_format->get_stride() == 2 &&
@@ -1922,26 +1940,7 @@ do_transform_vector_column(const GeomVertexFormat *format, GeomVertexRewriter &d
   LMatrix4 xform;
   bool normalize = false;
   if (data_column->get_contents() == C_normal) {
-    // This is to preserve perpendicularity to the surface.
-    LVecBase3 scale, shear, hpr;
-    if (decompose_matrix(mat.get_upper_3(), scale, shear, hpr) &&
-        IS_NEARLY_EQUAL(scale[0], scale[1]) &&
-        IS_NEARLY_EQUAL(scale[0], scale[2])) {
-      if (scale[0] == 1) {
-        // No scale to worry about.
-        xform = mat;
-      } else {
-        // Simply take the uniform scale out of the transformation.
-        // Not sure if it might be better to just normalize?
-        compose_matrix(xform, LVecBase3(1, 1, 1), shear, hpr, LVecBase3::zero());
-      }
-    } else {
-      // There is a non-uniform scale, so we need to do all this to
-      // preserve orthogonality to the surface.
-      xform.invert_from(mat);
-      xform.transpose_in_place();
-      normalize = true;
-    }
+    normalize = get_normal_xform(mat, xform);
   } else {
     xform = mat;
   }
@@ -1986,6 +1985,257 @@ do_transform_vector_column(const GeomVertexFormat *format, GeomVertexRewriter &d
   }
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexData::get_normal_xform
+//       Access: Private, Static
+//  Description: Computes the matrix that should be applied to a
+//               normal vector in place of the indicated vertex
+//               transform, so that the normal remains perpendicular
+//               to the surface.  Returns true if the transformed
+//               normals must also be normalized, or false if the
+//               matrix preserves their length.
+////////////////////////////////////////////////////////////////////
+bool GeomVertexData::
+get_normal_xform(const LMatrix4 &mat, LMatrix4 &xform) {
+  LVecBase3 scale, shear, hpr;
+  if (decompose_matrix(mat.get_upper_3(), scale, shear, hpr) &&
+      IS_NEARLY_EQUAL(scale[0], scale[1]) &&
+      IS_NEARLY_EQUAL(scale[0], scale[2])) {
+    if (scale[0] == 1) {
+      // No scale to worry about.
+      xform = mat;
+    } else {
+      // Simply take the uniform scale out of the transformation.
+      // Not sure if it might be better to just normalize?
+      compose_matrix(xform, LVecBase3(1, 1, 1), shear, hpr, LVecBase3::zero());
+    }
+    return false;
+  }
+
+  // There is a non-uniform scale, so we need to do all this to
+  // preserve orthogonality to the surface.
+  xform.invert_from(mat);
+  xform.transpose_in_place();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: skin_point3f
+//  Description: Transforms the three floats at v as a point.  The
+//               SSE2 version performs the same operations, in the
+//               same order, as LMatrix4f::xform_point().
+////////////////////////////////////////////////////////////////////
+static INLINE void
+skin_point3f(float *v, const LMatrix4f &matf) {
+#ifdef GEOMVERTEXDATA_SSE2
+  const float *m = matf.get_data();
+  __m128 r = _mm_mul_ps(_mm_set1_ps(v[0]), _mm_loadu_ps(m));
+  r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(v[1]), _mm_loadu_ps(m + 4)));
+  r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(v[2]), _mm_loadu_ps(m + 8)));
+  r = _mm_add_ps(r, _mm_loadu_ps(m + 12));
+  _mm_storel_pi((__m64 *)v, r);
+  _mm_store_ss(v + 2, _mm_movehl_ps(r, r));
+#else
+  *(LPoint3f *)v *= matf;
+#endif  // GEOMVERTEXDATA_SSE2
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: skin_vector3f
+//  Description: Transforms the three floats at v as a vector, in the
+//               same way as LMatrix4f::xform_vec().
+////////////////////////////////////////////////////////////////////
+static INLINE void
+skin_vector3f(float *v, const LMatrix4f &matf) {
+#ifdef GEOMVERTEXDATA_SSE2
+  const float *m = matf.get_data();
+  __m128 r = _mm_mul_ps(_mm_set1_ps(v[0]), _mm_loadu_ps(m));
+  r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(v[1]), _mm_loadu_ps(m + 4)));
+  r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(v[2]), _mm_loadu_ps(m + 8)));
+  _mm_storel_pi((__m64 *)v, r);
+  _mm_store_ss(v + 2, _mm_movehl_ps(r, r));
+#else
+  *(LVector3f *)v *= matf;
+#endif  // GEOMVERTEXDATA_SSE2
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: skin_vecbase4f
+//  Description: Transforms the four floats at v, in the same way as
+//               LMatrix4f::xform().
+////////////////////////////////////////////////////////////////////
+static INLINE void
+skin_vecbase4f(float *v, const LMatrix4f &matf) {
+#ifdef GEOMVERTEXDATA_SSE2
+  const float *m = matf.get_data();
+  __m128 r = _mm_mul_ps(_mm_set1_ps(v[0]), _mm_loadu_ps(m));
+  r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(v[1]), _mm_loadu_ps(m + 4)));
+  r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(v[2]), _mm_loadu_ps(m + 8)));
+  r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(v[3]), _mm_loadu_ps(m + 12)));
+  _mm_storeu_ps(v, r);
+#else
+  *(LVecBase4f *)v *= matf;
+#endif  // GEOMVERTEXDATA_SSE2
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: GeomVertexData::do_skin_float32
+//       Access: Private
+//  Description: A fast path for update_animated_vertices(), for the
+//               common case in which the transform_blend column is a
+//               single uint16 index and all of the animated columns
+//               are 3- or 4-component float32.  Each TransformBlend
+//               is converted to a float matrix just once, rather than
+//               once for each run of vertices that shares it, and the
+//               vertices are then transformed directly in the array
+//               buffers.  Vertices whose blends interleave, as they
+//               do in a typical soft-skinned mesh, benefit most.
+//
+//               Returns true if the vertices have been transformed,
+//               or false if the formats are not suitable, in which
+//               case nothing has been modified.
+////////////////////////////////////////////////////////////////////
+bool GeomVertexData::
+do_skin_float32(const CData *cdata, int blend_array_index,
+                GeomVertexData *new_data,
+                const TransformBlendTable *tb_table,
+                Thread *current_thread) {
+  const GeomVertexFormat *orig_format = cdata->_format;
+  const GeomVertexColumn *blend_column =
+    orig_format->get_column(InternalName::get_transform_blend());
+  if (blend_column == (GeomVertexColumn *)NULL ||
+      blend_column->get_numeric_type() != NT_uint16 ||
+      blend_column->get_num_components() != 1) {
+    return false;
+  }
+
+  const GeomVertexFormat *new_format = new_data->get_format();
+  int num_points = new_format->get_num_points();
+  int num_vectors = new_format->get_num_vectors();
+  int ci;
+  for (ci = 0; ci < num_points + num_vectors; ++ci) {
+    const InternalName *name = (ci < num_points) ?
+      new_format->get_point(ci) : new_format->get_vector(ci - num_points);
+    const GeomVertexColumn *column = new_format->get_column(name);
+    if (column == (GeomVertexColumn *)NULL ||
+        column->get_numeric_type() != NT_float32 ||
+        (column->get_num_values() != 3 && column->get_num_values() != 4)) {
+      return false;
+    }
+  }
+
+  // Convert each of the blends to a float matrix up front.  The
+  // normal matrices are only computed if there is a normal column.
+  int num_blends = tb_table->get_num_blends();
+  epvector<LMatrix4f> mats(num_blends);
+  epvector<LMatrix4f> normal_mats;
+  pvector<bool> normalize;
+  int bi;
+  for (bi = 0; bi < num_blends; ++bi) {
+    LMatrix4 mat;
+    tb_table->get_blend(bi).get_blend(mat, current_thread);
+    mats[bi] = LCAST(float, mat);
+  }
+
+  CPT(GeomVertexArrayDataHandle) blend_array_handle =
+    cdata->_arrays[blend_array_index].get_read_pointer()->get_handle(current_thread);
+  const unsigned char *blendt = blend_array_handle->get_read_pointer(true);
+  blendt += blend_column->get_start();
+  size_t blend_stride = orig_format->get_array(blend_array_index)->get_stride();
+
+  const SparseArray &rows = tb_table->get_rows();
+  int num_subranges = rows.get_num_subranges();
+
+  for (ci = 0; ci < num_points + num_vectors; ++ci) {
+    bool is_point = (ci < num_points);
+    const InternalName *name = is_point ?
+      new_format->get_point(ci) : new_format->get_vector(ci - num_points);
+    const GeomVertexColumn *column = new_format->get_column(name);
+    int num_values = column->get_num_values();
+
+    const LMatrix4f *col_mats = &mats[0];
+    bool is_normal = (!is_point && column->get_contents() == C_normal);
+    if (is_normal) {
+      if (normal_mats.empty()) {
+        normal_mats.resize(num_blends);
+        normalize.resize(num_blends);
+        for (bi = 0; bi < num_blends; ++bi) {
+          LMatrix4 mat, xform;
+          tb_table->get_blend(bi).get_blend(mat, current_thread);
+          normalize[bi] = get_normal_xform(mat, xform);
+          normal_mats[bi] = LCAST(float, xform);
+        }
+      }
+      col_mats = &normal_mats[0];
+    }
+
+    int array_index = new_format->get_array_with(name);
+    PT(GeomVertexArrayDataHandle) handle =
+      new_data->modify_array(array_index)->modify_handle(current_thread);
+    unsigned char *datat = handle->get_write_pointer();
+    datat += column->get_start();
+    size_t stride = new_format->get_array(array_index)->get_stride();
+
+    for (int i = 0; i < num_subranges; ++i) {
+      int begin = rows.get_subrange_begin(i);
+      int end = rows.get_subrange_end(i);
+      nassertr(begin < end, true);
+
+      const unsigned char *bp = blendt + begin * blend_stride;
+      unsigned char *dp = datat + begin * stride;
+      int j;
+
+      if (is_normal) {
+        // As in table_xform_normal3f(), the fourth component of a
+        // normal that must be normalized is left alone.
+        for (j = begin; j < end; ++j) {
+          bi = *(const PN_uint16 *)bp;
+          nassertr(bi < num_blends, true);
+          if (normalize[bi]) {
+            skin_vector3f((float *)dp, col_mats[bi]);
+            ((LNormalf *)dp)->normalize();
+          } else if (num_values == 3) {
+            skin_vector3f((float *)dp, col_mats[bi]);
+          } else {
+            skin_vecbase4f((float *)dp, col_mats[bi]);
+          }
+          bp += blend_stride;
+          dp += stride;
+        }
+
+      } else if (num_values == 4) {
+        for (j = begin; j < end; ++j) {
+          bi = *(const PN_uint16 *)bp;
+          nassertr(bi < num_blends, true);
+          skin_vecbase4f((float *)dp, col_mats[bi]);
+          bp += blend_stride;
+          dp += stride;
+        }
+
+      } else if (is_point) {
+        for (j = begin; j < end; ++j) {
+          bi = *(const PN_uint16 *)bp;
+          nassertr(bi < num_blends, true);
+          skin_point3f((float *)dp, col_mats[bi]);
+          bp += blend_stride;
+          dp += stride;
+        }
+
+      } else {
+        for (j = begin; j < end; ++j) {
+          bi = *(const PN_uint16 *)bp;
+          nassertr(bi < num_blends, true);
+          skin_vector3f((float *)dp, col_mats[bi]);
+          bp += blend_stride;
+          dp += stride;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: GeomVertexData::table_xform_point3f
 //       Access: Private, Static
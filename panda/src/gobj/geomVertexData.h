@@ -337,6 +337,11 @@ private:
                                  const LMatrix4 &mat, int begin_row, int end_row);
   void do_transform_vector_column(const GeomVertexFormat *format, GeomVertexRewriter &data,
                                   const LMatrix4 &mat, int begin_row, int end_row);
+  static bool get_normal_xform(const LMatrix4 &mat, LMatrix4 &xform);
+  bool do_skin_float32(const CData *cdata, int blend_array_index,
+                       GeomVertexData *new_data,
+                       const TransformBlendTable *tb_table,
+                       Thread *current_thread);
   static void table_xform_point3f(unsigned char *datat, size_t num_rows,
                                   size_t stride, const LMatrix4f &matf);
   static void table_xform_normal3f(unsigned char *datat, size_t num_rows,
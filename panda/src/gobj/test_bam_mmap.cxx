@@ -0,0 +1,212 @@
+// Filename: test_bam_mmap.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pandabase.h"
+#include "geomVertexData.h"
+#include "geomVertexFormat.h"
+#include "geomVertexWriter.h"
+#include "geomVertexReader.h"
+#include "config_gobj.h"
+#include "config_util.h"
+#include "bamReader.h"
+#include "bamWriter.h"
+#include "datagramInputFile.h"
+#include "datagramOutputFile.h"
+#include "temporaryFile.h"
+#include "trueClock.h"
+#include "randomizer.h"
+
+// This program writes a number of large vertex tables to a bam file
+// on disk, and reads them back twice: once with bam-mmap disabled,
+// so that the vertices are copied into memory, and once with it
+// enabled, so that they are used in place from a mapping of the file.
+// It reports the time taken for each, and checks that they produce
+// the same vertices.  It then modifies one of the mapped tables, to
+// check that the change is made to a private copy, and neither the
+// file nor another table loaded from it sees it.
+
+static const int num_tables = 64;
+static const int num_rows = 20000;
+
+typedef pvector< PT(GeomVertexData) > Tables;
+
+// Makes a table of random vertices with normals and texcoords.
+static PT(GeomVertexData)
+make_table(Randomizer &random) {
+  PT(GeomVertexData) vdata = new GeomVertexData
+    ("table", GeomVertexFormat::get_v3n3t2(), GeomEnums::UH_static);
+  vdata->set_num_rows(num_rows);
+
+  GeomVertexWriter vertex(vdata, InternalName::get_vertex());
+  GeomVertexWriter normal(vdata, InternalName::get_normal());
+  GeomVertexWriter texcoord(vdata, InternalName::get_texcoord());
+  for (int i = 0; i < num_rows; ++i) {
+    vertex.add_data3(random.random_real(100.0), random.random_real(100.0),
+                     random.random_real(100.0));
+    normal.add_data3(0.0f, 0.0f, 1.0f);
+    texcoord.add_data2(random.random_real(1.0), random.random_real(1.0));
+  }
+  return vdata;
+}
+
+// Writes all of the tables to the indicated bam file.
+static bool
+write_tables(const Filename &filename, const Tables &tables) {
+  DatagramOutputFile dout;
+  if (!dout.open(filename)) {
+    return false;
+  }
+  BamWriter writer(&dout);
+  if (!writer.init()) {
+    return false;
+  }
+  for (Tables::const_iterator ti = tables.begin(); ti != tables.end(); ++ti) {
+    if (!writer.write_object(*ti)) {
+      return false;
+    }
+  }
+  dout.close();
+  return true;
+}
+
+// Reads the tables back from the bam file, and returns the number of
+// milliseconds taken.  Returns -1 on failure.
+static double
+read_tables(const Filename &filename, Tables &tables) {
+  TrueClock *true_clock = TrueClock::get_global_ptr();
+  double start = true_clock->get_short_time();
+
+  DatagramInputFile din;
+  if (!din.open(filename)) {
+    return -1.0;
+  }
+  BamReader reader(&din);
+  if (!reader.init()) {
+    return -1.0;
+  }
+  for (int i = 0; i < num_tables; ++i) {
+    TypedWritable *object = reader.read_object();
+    if (object == (TypedWritable *)NULL ||
+        !object->is_of_type(GeomVertexData::get_class_type())) {
+      return -1.0;
+    }
+    tables.push_back(DCAST(GeomVertexData, object));
+  }
+  if (!reader.resolve()) {
+    return -1.0;
+  }
+
+  return (true_clock->get_short_time() - start) * 1000.0;
+}
+
+// Returns true if the two tables contain exactly the same vertex
+// data.
+static bool
+compare_table(const GeomVertexData *a, const GeomVertexData *b) {
+  CPT(GeomVertexArrayDataHandle) ha = a->get_array(0)->get_handle();
+  CPT(GeomVertexArrayDataHandle) hb = b->get_array(0)->get_handle();
+  return (ha->get_data_size_bytes() == hb->get_data_size_bytes() &&
+          memcmp(ha->get_read_pointer(true), hb->get_read_pointer(true),
+                 ha->get_data_size_bytes()) == 0);
+}
+
+// Returns true if the two sets of tables contain exactly the same
+// vertex data.
+static bool
+compare_tables(const Tables &a, const Tables &b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t ti = 0; ti < a.size(); ++ti) {
+    if (!compare_table(a[ti], b[ti])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int
+main(int argc, char *argv[]) {
+  Randomizer random(1);
+  Tables tables;
+  for (int i = 0; i < num_tables; ++i) {
+    tables.push_back(make_table(random));
+  }
+
+  PT(TemporaryFile) tfile = new TemporaryFile(Filename::temporary("", "mmap", ".bam"));
+  Filename filename = tfile->get_filename();
+  filename.set_binary();
+
+  bam_payload_threshold = 16384;
+  bam_compress_payloads = false;
+  if (!write_tables(filename, tables)) {
+    nout << "Unable to write " << filename << ".\n";
+    return 1;
+  }
+
+  Tables copied_tables, mapped_tables, mapped_tables2;
+  bam_mmap = false;
+  double copied_ms = read_tables(filename, copied_tables);
+  bam_mmap = true;
+  double mapped_ms = read_tables(filename, mapped_tables);
+  double mapped_ms2 = read_tables(filename, mapped_tables2);
+  if (copied_ms < 0.0 || mapped_ms < 0.0 || mapped_ms2 < 0.0) {
+    nout << "Unable to read " << filename << ".\n";
+    return 1;
+  }
+
+  nout << num_tables << " tables of " << num_rows << " rows:\n"
+       << "  copied: " << copied_ms << " ms\n"
+       << "  mapped: " << mapped_ms << " ms\n";
+
+  bool ok = true;
+  if (!compare_tables(tables, copied_tables)) {
+    nout << "  The copied tables differ!\n";
+    ok = false;
+  }
+  if (!compare_tables(tables, mapped_tables)) {
+    nout << "  The mapped tables differ!\n";
+    ok = false;
+  }
+
+  // Now modify the first row of one of the mapped tables.
+  {
+    GeomVertexWriter vertex(mapped_tables[0], InternalName::get_vertex());
+    vertex.set_data3(-1.0f, -2.0f, -3.0f);
+  }
+  GeomVertexReader vertex(mapped_tables[0], InternalName::get_vertex());
+  if (!vertex.get_data3().almost_equal(LVecBase3(-1.0f, -2.0f, -3.0f))) {
+    nout << "  The modified table was not changed!\n";
+    ok = false;
+  }
+  if (compare_table(mapped_tables[0], tables[0])) {
+    nout << "  The modified table still matches the original!\n";
+    ok = false;
+  }
+
+  // The other table, loaded from the same file, must not see the
+  // change, and neither should a fresh load of the file.
+  Tables reloaded_tables;
+  if (read_tables(filename, reloaded_tables) < 0.0) {
+    nout << "Unable to reload " << filename << ".\n";
+    return 1;
+  }
+  if (!compare_tables(tables, mapped_tables2) ||
+      !compare_tables(tables, reloaded_tables)) {
+    nout << "  The change was written through to the file!\n";
+    ok = false;
+  }
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,182 @@
+// Filename: test_bam_payload.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pandabase.h"
+#include "geomVertexData.h"
+#include "geomVertexFormat.h"
+#include "geomVertexWriter.h"
+#include "config_gobj.h"
+#include "config_util.h"
+#include "bamReader.h"
+#include "bamWriter.h"
+#include "datagramInputFile.h"
+#include "datagramOutputFile.h"
+#include "trueClock.h"
+#include "randomizer.h"
+
+// This program writes a number of large vertex tables to an
+// in-memory bam stream, once with the vertices stored inline in the
+// object datagrams, and once with bam-compress-payloads enabled, so
+// that each table is stored in a compressed payload record.  It
+// reports the size of each stream and the time taken to read it back,
+// and checks that every vertex comes back unchanged.
+//
+// The payloads are decoded with the number of threads given on the
+// command line (the default is 4).  Run it with 0 to compare against
+// decoding them on the main thread.
+
+static const int num_tables = 64;
+static const int num_rows = 20000;
+
+typedef pvector< PT(GeomVertexData) > Tables;
+
+// Makes a grid of vertices with normals and texcoords, as a terrain
+// tile might have.  Such data compresses reasonably well.
+static PT(GeomVertexData)
+make_table(Randomizer &random) {
+  PT(GeomVertexData) vdata = new GeomVertexData
+    ("grid", GeomVertexFormat::get_v3n3t2(), GeomEnums::UH_static);
+  vdata->set_num_rows(num_rows);
+
+  GeomVertexWriter vertex(vdata, InternalName::get_vertex());
+  GeomVertexWriter normal(vdata, InternalName::get_normal());
+  GeomVertexWriter texcoord(vdata, InternalName::get_texcoord());
+  for (int i = 0; i < num_rows; ++i) {
+    int x = i % 100;
+    int y = i / 100;
+    vertex.add_data3(x, y, random.random_int(16) * 0.25f);
+    normal.add_data3(0.0f, 0.0f, 1.0f);
+    texcoord.add_data2(x / 100.0f, y / 100.0f);
+  }
+  return vdata;
+}
+
+// Writes all of the tables to a bam stream, and returns it.
+static string
+write_tables(const Tables &tables) {
+  ostringstream out;
+  DatagramOutputFile dout;
+  dout.open(out);
+  BamWriter writer(&dout);
+  if (!writer.init()) {
+    return string();
+  }
+  for (Tables::const_iterator ti = tables.begin(); ti != tables.end(); ++ti) {
+    if (!writer.write_object(*ti)) {
+      return string();
+    }
+  }
+  dout.close();
+  return out.str();
+}
+
+// Reads the tables back from the bam stream, and returns the number
+// of milliseconds taken.  Returns -1 on failure.
+static double
+read_tables(const string &bam_data, Tables &tables) {
+  istringstream in(bam_data);
+  DatagramInputFile din;
+  din.open(in);
+
+  TrueClock *true_clock = TrueClock::get_global_ptr();
+  double start = true_clock->get_short_time();
+
+  BamReader reader(&din);
+  if (!reader.init()) {
+    return -1.0;
+  }
+  for (int i = 0; i < num_tables; ++i) {
+    TypedWritable *object = reader.read_object();
+    if (object == (TypedWritable *)NULL ||
+        !object->is_of_type(GeomVertexData::get_class_type())) {
+      return -1.0;
+    }
+    tables.push_back(DCAST(GeomVertexData, object));
+  }
+  if (!reader.resolve()) {
+    return -1.0;
+  }
+
+  return (true_clock->get_short_time() - start) * 1000.0;
+}
+
+// Returns true if the two sets of tables contain exactly the same
+// vertex data.
+static bool
+compare_tables(const Tables &a, const Tables &b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t ti = 0; ti < a.size(); ++ti) {
+    CPT(GeomVertexArrayDataHandle) ha = a[ti]->get_array(0)->get_handle();
+    CPT(GeomVertexArrayDataHandle) hb = b[ti]->get_array(0)->get_handle();
+    if (ha->get_data_size_bytes() != hb->get_data_size_bytes() ||
+        memcmp(ha->get_read_pointer(true), hb->get_read_pointer(true),
+               ha->get_data_size_bytes()) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int
+main(int argc, char *argv[]) {
+  bam_decode_threads = (argc > 1) ? atoi(argv[1]) : 4;
+
+  Randomizer random(1);
+  Tables tables;
+  for (int i = 0; i < num_tables; ++i) {
+    tables.push_back(make_table(random));
+  }
+
+  bam_payload_threshold = 0;
+  bam_compress_payloads = false;
+  string inline_data = write_tables(tables);
+
+  bam_payload_threshold = 16384;
+  bam_compress_payloads = true;
+  string payload_data = write_tables(tables);
+
+  if (inline_data.empty() || payload_data.empty()) {
+    nout << "Unable to write the tables.\n";
+    return 1;
+  }
+
+  Tables inline_tables, payload_tables;
+  double inline_ms = read_tables(inline_data, inline_tables);
+  double payload_ms = read_tables(payload_data, payload_tables);
+  if (inline_ms < 0.0 || payload_ms < 0.0) {
+    nout << "Unable to read the tables.\n";
+    return 1;
+  }
+
+  nout << num_tables << " tables of " << num_rows << " rows, "
+       << (int)bam_decode_threads << " decode threads:\n"
+       << "  inline: " << inline_data.size() << " bytes, "
+       << inline_ms << " ms\n"
+       << "  payloads: " << payload_data.size() << " bytes, "
+       << payload_ms << " ms\n";
+
+  bool ok = true;
+  if (!compare_tables(tables, inline_tables)) {
+    nout << "  The inline tables differ!\n";
+    ok = false;
+  }
+  if (!compare_tables(tables, payload_tables)) {
+    nout << "  The payload tables differ!\n";
+    ok = false;
+  }
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,220 @@
+// Filename: test_skinning.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pandabase.h"
+#include "geom.h"
+#include "geomVertexData.h"
+#include "geomVertexFormat.h"
+#include "geomVertexArrayFormat.h"
+#include "geomVertexReader.h"
+#include "geomVertexWriter.h"
+#include "transformBlendTable.h"
+#include "userVertexTransform.h"
+#include "internalName.h"
+#include "config_gobj.h"
+#include "trueClock.h"
+#include "randomizer.h"
+#include "thread.h"
+#include "epvector.h"
+
+// This program measures the time spent animating a soft-skinned mesh
+// on the CPU, with fast-cpu-skinning off and then on.  It also checks
+// that both settings produce the same vertices and normals, to within
+// rounding error, with the columns interleaved in one array and with
+// each in an array of its own, and with vertex-animation-align-16 off
+// and on.  (The two paths perform the same operations in the same
+// order, but a build with -ffast-math may round the general path
+// differently.)
+
+static const int num_rows = 20000;
+static const int num_joints = 40;
+static const int num_blends = 300;
+static const int num_frames = 50;
+static const float tolerance = 1.0e-5f;
+
+typedef pvector< PT(UserVertexTransform) > Joints;
+
+// Each combination of interleaved and vertex-animation-align-16 must
+// be a different format, since a format remembers its post-animated
+// format once it has been computed.  The aligned formats are made
+// distinct by also carrying texcoords, which are not animated.
+static CPT(GeomVertexFormat)
+make_format(bool interleaved, bool aligned) {
+  PT(GeomVertexArrayFormat) vertices = new GeomVertexArrayFormat;
+  vertices->add_column(InternalName::get_vertex(), 3,
+                       Geom::NT_float32, Geom::C_point);
+  PT(GeomVertexArrayFormat) normals = vertices;
+  PT(GeomVertexArrayFormat) blends = vertices;
+  if (!interleaved) {
+    normals = new GeomVertexArrayFormat;
+    blends = new GeomVertexArrayFormat;
+  }
+  normals->add_column(InternalName::get_normal(), 3,
+                      Geom::NT_float32, Geom::C_normal);
+  blends->add_column(InternalName::get_transform_blend(), 1,
+                     Geom::NT_uint16, Geom::C_index);
+  if (aligned) {
+    vertices->add_column(InternalName::get_texcoord(), 2,
+                         Geom::NT_float32, Geom::C_texcoord);
+  }
+
+  PT(GeomVertexFormat) format = new GeomVertexFormat(vertices);
+  if (!interleaved) {
+    format->add_array(normals);
+    format->add_array(blends);
+  }
+  GeomVertexAnimationSpec animation;
+  animation.set_panda();
+  format->set_animation(animation);
+  return GeomVertexFormat::register_format(format);
+}
+
+static PT(GeomVertexData)
+make_mesh(const GeomVertexFormat *format, Joints &joints) {
+  Randomizer random(1);
+  PT(TransformBlendTable) table = new TransformBlendTable;
+  pvector<int> blend_indices;
+  for (int bi = 0; bi < num_blends; ++bi) {
+    // Between one and four joints influence each blend.
+    TransformBlend blend;
+    int num_weights = 1 + bi % 4;
+    for (int w = 0; w < num_weights; ++w) {
+      blend.add_transform(joints[random.random_int(num_joints)],
+                          0.1 + random.random_real(1.0));
+    }
+    blend.normalize_weights();
+    blend_indices.push_back(table->add_blend(blend));
+  }
+  table->set_rows(SparseArray::lower_on(num_rows));
+
+  PT(GeomVertexData) data =
+    new GeomVertexData("mesh", format, Geom::UH_static);
+  data->set_num_rows(num_rows);
+  data->set_transform_blend_table(table);
+
+  GeomVertexWriter vertex(data, InternalName::get_vertex());
+  GeomVertexWriter normal(data, InternalName::get_normal());
+  GeomVertexWriter blend(data, InternalName::get_transform_blend());
+  for (int i = 0; i < num_rows; ++i) {
+    vertex.add_data3(random.random_real(2.0) - 1.0,
+                     random.random_real(2.0) - 1.0,
+                     random.random_real(2.0) - 1.0);
+    LVector3 n(random.random_real(2.0) - 1.0,
+               random.random_real(2.0) - 1.0,
+               random.random_real(2.0) - 1.0);
+    n.normalize();
+    normal.add_data3(n);
+
+    // Neighboring vertices usually, but not always, share a blend.
+    blend.add_data1i(blend_indices[(i / 3 + (i % 7 == 0 ? 17 : 0)) % num_blends]);
+  }
+  return data;
+}
+
+// Poses the joints for the indicated frame.  Some of the joints are
+// given a non-uniform scale, which requires the normals to be
+// renormalized.
+static void
+pose_joints(Joints &joints, int frame) {
+  for (int j = 0; j < num_joints; ++j) {
+    LMatrix4 mat =
+      LMatrix4::rotate_mat(frame * 3.0f + j * 10.0f, LVector3(1, j % 3, 1)) *
+      LMatrix4::translate_mat(j * 0.1f, frame * 0.01f, 0);
+    if (j % 4 == 0) {
+      mat = LMatrix4::scale_mat(1.0f, 1.5f, 0.75f) * mat;
+    } else if (j % 4 == 1) {
+      mat = LMatrix4::scale_mat(2.0f) * mat;
+    }
+    joints[j]->set_matrix(mat);
+  }
+}
+
+// Animates the mesh over num_frames frames, appending every animated
+// vertex and normal to results.  Returns the average number of
+// milliseconds per frame spent in animate_vertices().
+static double
+run(GeomVertexData *data, Joints &joints, bool fast,
+    epvector<LVecBase4f> &results) {
+  fast_cpu_skinning = fast;
+
+  Thread *current_thread = Thread::get_current_thread();
+  TrueClock *true_clock = TrueClock::get_global_ptr();
+  double total_time = 0.0;
+  for (int frame = 0; frame < num_frames; ++frame) {
+    pose_joints(joints, frame);
+
+    double start = true_clock->get_short_time();
+    CPT(GeomVertexData) animated = data->animate_vertices(true, current_thread);
+    total_time += true_clock->get_short_time() - start;
+
+    GeomVertexReader vertex(animated, InternalName::get_vertex());
+    GeomVertexReader normal(animated, InternalName::get_normal());
+    while (!vertex.is_at_end()) {
+      results.push_back(vertex.get_data4f());
+      results.push_back(normal.get_data4f());
+    }
+  }
+
+  return total_time * 1000.0 / num_frames;
+}
+
+// Returns true if the two lists of results match, to within the
+// tolerance.
+static bool
+same_results(const epvector<LVecBase4f> &a, const epvector<LVecBase4f> &b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (!a[i].almost_equal(b[i], tolerance)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int
+main(int argc, char *argv[]) {
+  Joints joints;
+  for (int j = 0; j < num_joints; ++j) {
+    ostringstream strm;
+    strm << "joint" << j;
+    joints.push_back(new UserVertexTransform(strm.str()));
+  }
+
+  bool ok = true;
+  for (int align = 0; align < 2; ++align) {
+    vertex_animation_align_16 = (align != 0);
+
+    for (int interleaved = 0; interleaved < 2; ++interleaved) {
+      CPT(GeomVertexFormat) format = make_format(interleaved != 0, align != 0);
+      PT(GeomVertexData) data = make_mesh(format, joints);
+
+      epvector<LVecBase4f> reference, results;
+      double base_ms = run(data, joints, false, reference);
+      double ms = run(data, joints, true, results);
+
+      nout << (interleaved ? "interleaved" : "separate arrays")
+           << (align ? ", aligned" : "") << ": "
+           << base_ms << " ms per frame general, "
+           << ms << " ms fast, " << base_ms / ms << "x\n";
+      if (!same_results(reference, results)) {
+        nout << "  Fast results differ from the general results!\n";
+        ok = false;
+      }
+    }
+  }
+
+  return ok ? 0 : 1;
+}
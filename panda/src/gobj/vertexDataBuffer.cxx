@@ -44,6 +44,10 @@ operator = (const VertexDataBuffer &copy) {
   _size = copy._size;
   _reserved_size = copy._size;
   _block = copy._block;
+
+  // A mapped buffer may be shared freely, since it is read-only.
+  _mapped_data = copy._mapped_data;
+  _mapping = copy._mapping;
   nassertv(_reserved_size >= _size);
 }
 
@@ -62,19 +66,55 @@ swap(VertexDataBuffer &other) {
   size_t size = _size;
   size_t reserved_size = _reserved_size;
   PT(VertexDataBlock) block = _block;
+  const unsigned char *mapped_data = _mapped_data;
+  PT(MappedFile) mapping = _mapping;
 
   _resident_data = other._resident_data;
   _size = other._size;
   _reserved_size = other._reserved_size;
   _block = other._block;
+  _mapped_data = other._mapped_data;
+  _mapping = other._mapping;
 
   other._resident_data = resident_data;
   other._size = size;
   other._reserved_size = reserved_size;
   other._block = block;
+  other._mapped_data = mapped_data;
+  other._mapping = mapping;
   nassertv(_reserved_size >= _size);
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: VertexDataBuffer::set_mapped_data
+//       Access: Public
+//  Description: Makes the buffer reference size bytes of the
+//               indicated mapped file directly, starting at data,
+//               rather than keeping a copy of its own.  The buffer
+//               keeps a reference to the mapping, so that it remains
+//               valid for as long as the buffer needs it.
+//
+//               This is used to load vertex data from a bam file
+//               without copying it.  The data is copied into
+//               independent memory the first time the buffer is
+//               modified, so the mapping is never written to.
+////////////////////////////////////////////////////////////////////
+void VertexDataBuffer::
+set_mapped_data(MappedFile *mapping, const unsigned char *data, size_t size) {
+  LightMutexHolder holder(_lock);
+  nassertv(mapping != (MappedFile *)NULL && mapping->is_valid());
+  nassertv(data >= mapping->get_data() &&
+           data + size <= mapping->get_data() + mapping->get_size());
+
+  do_unclean_realloc(0);
+  if (size != 0) {
+    _mapped_data = data;
+    _mapping = mapping;
+    _size = size;
+    _reserved_size = size;
+  }
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: VertexDataBuffer::do_clean_realloc
 //       Access: Private
@@ -135,8 +175,10 @@ do_unclean_realloc(size_t reserved_size) {
         << this << ".unclean_realloc(" << reserved_size << ")\n";
     }
 
-    // If we're paged out, discard the page.
+    // If we're paged out or mapped, discard the page or mapping.
     _block = NULL;
+    _mapped_data = NULL;
+    _mapping = NULL;
         
     if (_resident_data != (unsigned char *)NULL) {
       nassertv(_reserved_size != 0);
@@ -177,6 +219,11 @@ do_page_out(VertexDataBook &book) {
     // We're already paged out.
     return;
   }
+  if (_mapped_data != (const unsigned char *)NULL) {
+    // We're mapped from a file, which is as good as paged out; the
+    // operating system can discard these pages whenever it likes.
+    return;
+  }
   nassertv(_resident_data != (unsigned char *)NULL);
 
   if (_size == 0) {
@@ -208,9 +255,10 @@ do_page_out(VertexDataBook &book) {
 ////////////////////////////////////////////////////////////////////
 //     Function: VertexDataBuffer::do_page_in
 //       Access: Private
-//  Description: Moves the buffer off of its current page and into
-//               independent memory.  If the page is not already
-//               resident, it is forced resident first.
+//  Description: Moves the buffer off of its current page, or out of
+//               its mapped file, and into independent memory.  If the
+//               page is not already resident, it is forced resident
+//               first.
 //
 //               Assumes the lock is already held.
 ////////////////////////////////////////////////////////////////////
@@ -221,12 +269,21 @@ do_page_in() {
     return;
   }
 
-  nassertv(_block != (VertexDataBlock *)NULL);
+  nassertv(_block != (VertexDataBlock *)NULL ||
+           _mapped_data != (const unsigned char *)NULL);
   nassertv(_reserved_size == _size);
 
   get_class_type().inc_memory_usage(TypeHandle::MC_array, (int)_size);
   _resident_data = (unsigned char *)PANDA_MALLOC_ARRAY(_size);
   nassertv(_resident_data != (unsigned char *)NULL);
   
-  memcpy(_resident_data, _block->get_pointer(true), _size);
+  if (_mapped_data != (const unsigned char *)NULL) {
+    // This is the copy-on-write of a mapped buffer.  From now on, we
+    // have our own copy, and no longer need the mapping.
+    memcpy(_resident_data, _mapped_data, _size);
+    _mapped_data = NULL;
+    _mapping = NULL;
+  } else {
+    memcpy(_resident_data, _block->get_pointer(true), _size);
+  }
 }
@@ -20,6 +20,7 @@
 #include "vertexDataBlock.h"
 #include "pointerTo.h"
 #include "virtualFile.h"
+#include "mappedFile.h"
 #include "pStatCollector.h"
 #include "lightMutex.h"
 #include "lightMutexHolder.h"
@@ -29,7 +30,7 @@
 // Description : A block of bytes that stores the actual raw vertex
 //               data referenced by a GeomVertexArrayData object.
 //
-//               At any point, a buffer may be in any of two states:
+//               At any point, a buffer may be in any of three states:
 //
 //               independent - the buffer's memory is resident, and
 //               owned by the VertexDataBuffer object itself (in
@@ -44,12 +45,21 @@
 //               read-only.  In this state, _reserved_size will always
 //               equal _size.
 //
+//               mapped - the buffer's memory is part of a file that
+//               has been mapped into memory, typically the bam file
+//               it was loaded from, and is kept alive by _mapping.
+//               The operating system pages it in from the file as
+//               needed.  This memory is strictly read-only.  In this
+//               state, too, _reserved_size will always equal _size.
+//
 //               VertexDataBuffers start out in independent state.
 //               They get moved to paged state when their owning
 //               GeomVertexArrayData objects get evicted from the
 //               _independent_lru.  They can get moved back to
 //               independent state if they are modified
 //               (e.g. get_write_pointer() or realloc() is called).
+//               A mapped buffer is likewise copied into independent
+//               memory the first time it is modified.
 //
 //               The idea is to keep the highly dynamic and
 //               frequently-modified VertexDataBuffers resident in
@@ -78,6 +88,10 @@ public:
 
   INLINE void page_out(VertexDataBook &book);
 
+  void set_mapped_data(MappedFile *mapping, const unsigned char *data,
+                       size_t size);
+  INLINE bool is_mapped() const;
+
   void swap(VertexDataBuffer &other);
 
 private:
@@ -91,6 +105,8 @@ private:
   size_t _size;
   size_t _reserved_size;
   PT(VertexDataBlock) _block;
+  const unsigned char *_mapped_data;
+  PT(MappedFile) _mapping;
   LightMutex _lock;
 
 public:
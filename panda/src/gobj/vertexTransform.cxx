@@ -17,9 +17,11 @@
 #include "bamWriter.h"
 #include "indent.h"
 #include "transformTable.h"
+#include "lightMutexHolder.h"
 
 PipelineCycler<VertexTransform::CData> VertexTransform::_global_cycler;
 UpdateSeq VertexTransform::_next_modified;
+LightMutex VertexTransform::_next_modified_lock;
 
 TypeHandle VertexTransform::_type_handle;
 
@@ -114,9 +116,16 @@ write(ostream &out, int indent_level) const {
 //               TransformBlend::get_modified() is easy to determine.
 //               It is similar to Geom::get_modified(), but it is in a
 //               different space.
+//
+//               This may be called by several threads at once, for
+//               instance when a CharacterUpdater animates characters
+//               in parallel, so it is serialized by its own lock; the
+//               global cycler provides no lock of its own unless
+//               pipelining is compiled in.
 ////////////////////////////////////////////////////////////////////
 UpdateSeq VertexTransform::
 get_next_modified(Thread *current_thread) {
+  LightMutexHolder holder(_next_modified_lock);
   CDWriter cdatag(_global_cycler, true, current_thread);
   ++_next_modified;
   cdatag->_modified = _next_modified;
@@ -24,6 +24,7 @@
 #include "cycleDataReader.h"
 #include "cycleDataWriter.h"
 #include "pipelineCycler.h"
+#include "lightMutex.h"
 
 class TransformTable;
 
@@ -82,6 +83,7 @@ private:
 
   static PipelineCycler<CData> _global_cycler;
   static UpdateSeq _next_modified;
+  static LightMutex _next_modified_lock;
 
 public:
   virtual void write_datagram(BamWriter *manager, Datagram &dg);
@@ -128,3 +128,24 @@ remove_gsg(GraphicsStateGuardianBase *gsg) {
     }
   }
 }
+
+////////////////////////////////////////////////////////////////////
+//     Function: GraphicsStateGuardianBase::draw_geom_instances
+//       Access: Public, Virtual
+//  Description: Draws num_instances copies of the same Geom, all with
+//               the same state, but each with the corresponding
+//               transform from the transforms array, if the GSG is
+//               able to do this more efficiently than drawing each
+//               one separately.
+//
+//               Returns true if the instances have been drawn, or
+//               false if they have not, in which case the caller
+//               should draw each one in the usual way.  This default
+//               implementation always returns false.
+////////////////////////////////////////////////////////////////////
+bool GraphicsStateGuardianBase::
+draw_geom_instances(const Geom *, const GeomMunger *,
+                    const GeomVertexData *, const RenderState *,
+                    const TransformState * const *, int, bool, Thread *) {
+  return false;
+}
@@ -211,6 +211,13 @@ public:
   virtual bool draw_points(const GeomPrimitivePipelineReader *reader, bool force)=0;
   virtual void end_draw_primitives()=0;
 
+  virtual bool draw_geom_instances(const Geom *geom, const GeomMunger *munger,
+                                   const GeomVertexData *vertex_data,
+                                   const RenderState *state,
+                                   const TransformState * const *transforms,
+                                   int num_instances, bool force,
+                                   Thread *current_thread);
+
   virtual bool framebuffer_copy_to_texture
   (Texture *tex, int view, int z, const DisplayRegion *dr, const RenderBuffer &rb)=0;
   virtual bool framebuffer_copy_to_ram
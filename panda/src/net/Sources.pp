@@ -107,6 +107,36 @@
 
 #end test_bin_target
 
+#begin test_bin_target
+  #define TARGET test_epoll_reader
+  #define LOCAL_LIBS p3net
+  #define OTHER_LIBS $[OTHER_LIBS] p3pystub
+
+  #define SOURCES \
+    test_epoll_reader.cxx
+
+#end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_tcp_writev
+  #define LOCAL_LIBS p3net
+  #define OTHER_LIBS $[OTHER_LIBS] p3pystub
+
+  #define SOURCES \
+    test_tcp_writev.cxx
+
+#end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_udp_batch
+  #define LOCAL_LIBS p3net
+  #define OTHER_LIBS $[OTHER_LIBS] p3pystub
+
+  #define SOURCES \
+    test_udp_batch.cxx
+
+#end test_bin_target
+
 #begin test_bin_target
   #define TARGET test_raw_server
   #define LOCAL_LIBS p3net
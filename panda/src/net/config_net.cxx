@@ -143,6 +143,15 @@ ConfigVariableEnum<ThreadPriority> net_thread_priority
  PRC_DESC("The default thread priority when creating threaded readers "
           "or writers."));
 
+ConfigVariableBool net_use_epoll
+("net-use-epoll", false,
+ PRC_DESC("Set this true to have ConnectionReaders (and listeners) wait "
+          "for activity with epoll instead of select(), on Linux.  This "
+          "removes the select() limit on the number of sockets, and lets "
+          "the reader threads wait independently, each on its own share "
+          "of the sockets.  It has no effect on other platforms, and only "
+          "applies to readers created after it is set."));
+
 
 ////////////////////////////////////////////////////////////////////
 //     Function: init_libnet
@@ -23,6 +23,21 @@
 #include "configVariableEnum.h"
 #include "threadPriority.h"
 
+// recvmmsg() and sendmmsg(), which read and write a batch of UDP
+// datagrams in one system call, are available in glibc 2.14 and
+// later.
+#if defined(IS_LINUX) && defined(__GLIBC__) && !defined(CPPPARSER)
+#if __GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 14)
+#define HAVE_MMSG 1
+#endif
+#endif
+
+// writev(), which writes several buffers to a socket in one system
+// call, is available everywhere but Windows.
+#if !defined(_WIN32) && !defined(CPPPARSER)
+#define HAVE_WRITEV 1
+#endif
+
 // Configure variables for net package.
 
 NotifyCategoryDecl(net, EXPCL_PANDA_NET, EXPTP_PANDA_NET);
@@ -38,6 +53,7 @@ extern ConfigVariableInt net_max_read_per_epoch;
 extern ConfigVariableInt net_max_write_per_epoch;
 
 extern ConfigVariableEnum<ThreadPriority> net_thread_priority;
+extern EXPCL_PANDA_NET ConfigVariableBool net_use_epoll;
 
 extern EXPCL_PANDA_NET void init_libnet();
 
@@ -25,7 +25,21 @@
 #include "socket_ip.h"
 #include "socket_tcp.h"
 #include "socket_udp.h"
+#include "socket_fdset.h"
 #include "dcast.h"
+#include "pvector.h"
+
+#if defined(HAVE_MMSG) || defined(HAVE_WRITEV)
+#include <errno.h>
+#endif
+
+#ifdef HAVE_WRITEV
+#include <sys/uio.h>
+#include <limits.h>
+#ifndef IOV_MAX
+#define IOV_MAX 16
+#endif
+#endif  // HAVE_WRITEV
 
 
 ////////////////////////////////////////////////////////////////////
@@ -205,12 +219,32 @@ consider_flush() {
 //       Access: Published
 //  Description: Sends the most recently queued TCP datagram(s) now.
 //               This only has meaning if set_collect_tcp() has been
-//               set to true.
+//               set to true, or if the socket has been made
+//               non-blocking, in which case a previous send may
+//               have left some data queued that the socket could
+//               not yet take.  This waits until all of it has been
+//               sent.
 ////////////////////////////////////////////////////////////////////
 bool Connection::
 flush() {
   LightReMutexHolder holder(_write_mutex);
-  return do_flush();
+  if (!do_flush()) {
+    return false;
+  }
+
+  while (!_queued_data.empty()) {
+    // The socket is non-blocking, and is still full.  Wait for room.
+    Socket_fdset fdset;
+    fdset.setForSocket(*_socket);
+    if (fdset.WaitForWrite(true) < 0 && GETERROR() != EINTR) {
+      return check_send_error(false);
+    }
+    if (!do_flush()) {
+      return false;
+    }
+  }
+
+  return true;
 }
 
 /*
@@ -367,8 +401,9 @@ send_datagram(const NetDatagram &datagram, int tcp_header_size) {
     LightReMutexHolder holder(_write_mutex);
     DatagramUDPHeader header(datagram);
     string data;
+    data.reserve(datagram_udp_header_size + datagram.get_length());
     data += header.get_header();
-    data += datagram.get_message();
+    data.append((const char *)datagram.get_data(), datagram.get_length());
     
     if (net_cat.is_debug()) {
       header.verify_datagram(datagram);
@@ -408,7 +443,7 @@ send_datagram(const NetDatagram &datagram, int tcp_header_size) {
 
   LightReMutexHolder holder(_write_mutex);
   _queued_data += header.get_header();
-  _queued_data += datagram.get_message();
+  _queued_data.append((const char *)datagram.get_data(), datagram.get_length());
   _queued_count++;
   
   if (net_cat.is_debug()) {
@@ -439,22 +474,24 @@ send_raw_datagram(const NetDatagram &datagram) {
     Socket_UDP *udp;
     DCAST_INTO_R(udp, _socket, false);
 
-    string data = datagram.get_message();
+    // Send the datagram's own buffer, rather than a copy of it.
+    const char *data = (const char *)datagram.get_data();
+    int data_size = (int)datagram.get_length();
 
     LightReMutexHolder holder(_write_mutex);
     Socket_Address addr = datagram.get_address().get_addr();
-    bool okflag = udp->SendTo(data, addr);
+    bool okflag = udp->SendTo(data, data_size, addr);
 #if defined(HAVE_THREADS) && defined(SIMPLE_THREADS)
     while (!okflag && udp->GetLastError() == LOCAL_BLOCKING_ERROR && udp->Active()) {
       Thread::force_yield();
-      okflag = udp->SendTo(data, addr);
+      okflag = udp->SendTo(data, data_size, addr);
     }
 #endif  // SIMPLE_THREADS
     
     if (net_cat.is_spam()) {
       net_cat.spam()
         << "Sent UDP datagram with " 
-        << data.size() << " bytes to " << (void *)this 
+        << data_size << " bytes to " << (void *)this 
         << ", ok = " << okflag << "\n";
     }
 
@@ -463,7 +500,7 @@ send_raw_datagram(const NetDatagram &datagram) {
 
   // We might queue up TCP packets for later sending.
   LightReMutexHolder holder(_write_mutex);
-  _queued_data += datagram.get_message();
+  _queued_data.append((const char *)datagram.get_data(), datagram.get_length());
   _queued_count++;
 
   if (!_collect_tcp || 
@@ -474,11 +511,277 @@ send_raw_datagram(const NetDatagram &datagram) {
   return true;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: Connection::send_udp_batch
+//       Access: Private
+//  Description: This method is intended only to be called by
+//               ConnectionWriter.  It writes the indicated run of
+//               datagrams, in order, to this connection's UDP socket,
+//               with as few system calls as the platform allows.  If
+//               raw is true, the datagrams are sent without headers.
+//               Returns true if all of them were sent.
+////////////////////////////////////////////////////////////////////
+bool Connection::
+send_udp_batch(const NetDatagram *datagrams, int num_datagrams, bool raw) {
+  nassertr(_socket != (Socket_IP *)NULL, false);
+
+#ifdef HAVE_MMSG
+  Socket_UDP *udp;
+  DCAST_INTO_R(udp, _socket, false);
+
+  // Collect the headers first, so their storage doesn't move while we
+  // point into it.
+  pvector<string> headers(num_datagrams);
+  pvector<Socket_Address> addrs(num_datagrams);
+  pvector<struct iovec> iovecs(num_datagrams * 2);
+  pvector<struct mmsghdr> msgs(num_datagrams);
+  memset(&msgs[0], 0, num_datagrams * sizeof(struct mmsghdr));
+
+  int bytes_to_send = 0;
+  for (int i = 0; i < num_datagrams; ++i) {
+    const NetDatagram &datagram = datagrams[i];
+    if (!raw) {
+      DatagramUDPHeader header(datagram);
+      headers[i] = header.get_header();
+      if (net_cat.is_debug()) {
+        header.verify_datagram(datagram);
+      }
+    }
+    addrs[i] = datagram.get_address().get_addr();
+
+    iovecs[i * 2].iov_base = (void *)headers[i].data();
+    iovecs[i * 2].iov_len = headers[i].size();
+    iovecs[i * 2 + 1].iov_base = (void *)datagram.get_data();
+    iovecs[i * 2 + 1].iov_len = datagram.get_length();
+    bytes_to_send += (int)(headers[i].size() + datagram.get_length());
+
+    msgs[i].msg_hdr.msg_iov = &iovecs[i * 2];
+    msgs[i].msg_hdr.msg_iovlen = 2;
+    msgs[i].msg_hdr.msg_name = &addrs[i].GetAddressInfo();
+    msgs[i].msg_hdr.msg_namelen = sizeof(Socket_Address::AddressType);
+  }
+
+  LightReMutexHolder holder(_write_mutex);
+  int num_sent = 0;
+  while (num_sent < num_datagrams) {
+    int result = sendmmsg(udp->GetSocket(), &msgs[num_sent],
+                          num_datagrams - num_sent, 0);
+    if (result > 0) {
+      num_sent += result;
+    } else if (result < 0 && errno == EINTR) {
+      continue;
+#if defined(HAVE_THREADS) && defined(SIMPLE_THREADS)
+    } else if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) &&
+               udp->Active()) {
+      Thread::force_yield();
+#endif  // SIMPLE_THREADS
+    } else {
+      break;
+    }
+  }
+
+  if (net_cat.is_spam()) {
+    net_cat.spam()
+      << "Sent batch of " << num_sent << " of " << num_datagrams
+      << " UDP datagrams with " << bytes_to_send << " bytes to "
+      << (void *)this << "\n";
+  }
+
+  return check_send_error(num_sent == num_datagrams);
+
+#else  // HAVE_MMSG
+  bool okflag = true;
+  for (int i = 0; i < num_datagrams; ++i) {
+    if (raw) {
+      okflag = send_raw_datagram(datagrams[i]) && okflag;
+    } else {
+      okflag = send_datagram(datagrams[i], 0) && okflag;
+    }
+  }
+  return okflag;
+#endif  // HAVE_MMSG
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: Connection::send_datagram_list
+//       Access: Private
+//  Description: This method is intended only to be called by
+//               ConnectionWriter.  It writes the indicated datagrams,
+//               in order, to this connection's TCP socket.  If gather
+//               is false, each is sent as a separate datagram, with
+//               its own header; if it is true, they are pieces of a
+//               single datagram, sent with one header for the lot.
+//
+//               Where possible, the headers and the datagrams' own
+//               buffers are written with a single writev() call,
+//               without being copied together first.  If
+//               collect-tcp is in effect, they are instead queued up
+//               with the other data waiting to be sent.  If the
+//               socket is non-blocking and cannot take all of the
+//               data at once, the rest is queued up in the same way.
+////////////////////////////////////////////////////////////////////
+bool Connection::
+send_datagram_list(const Datagram *const *datagrams, int num_datagrams,
+                   int tcp_header_size, bool gather) {
+  nassertr(_socket != (Socket_IP *)NULL, false);
+  Socket_TCP *tcp;
+  DCAST_INTO_R(tcp, _socket, false);
+
+  size_t total_size = 0;
+  for (int i = 0; i < num_datagrams; ++i) {
+    size_t size = datagrams[i]->get_length();
+    if (!gather && tcp_header_size == 2 && size >= 0x10000) {
+      net_cat.error()
+        << "Attempt to send TCP datagram of " << size
+        << " bytes--too long!\n";
+      nassert_raise("Datagram too long");
+      return false;
+    }
+    total_size += size;
+  }
+  if (gather && tcp_header_size == 2 && total_size >= 0x10000) {
+    net_cat.error()
+      << "Attempt to send TCP datagram of " << total_size
+      << " bytes--too long!\n";
+    nassert_raise("Datagram too long");
+    return false;
+  }
+
+  pvector<string> headers;
+  if (gather) {
+    headers.push_back(DatagramTCPHeader(total_size, tcp_header_size).get_header());
+  } else {
+    headers.reserve(num_datagrams);
+    for (int i = 0; i < num_datagrams; ++i) {
+      headers.push_back(DatagramTCPHeader(datagrams[i]->get_length(), tcp_header_size).get_header());
+    }
+  }
+
+  LightReMutexHolder holder(_write_mutex);
+
+#ifdef HAVE_WRITEV
+  if (!_collect_tcp) {
+    // Anything still queued from before must go out first.
+    string sending_data;
+    _queued_data.swap(sending_data);
+    _queued_count = 0;
+    _queued_data_start = TrueClock::get_global_ptr()->get_short_time();
+
+    pvector<struct iovec> iovecs;
+    iovecs.reserve(num_datagrams + headers.size() + 1);
+    if (!sending_data.empty()) {
+      struct iovec iov;
+      iov.iov_base = (void *)sending_data.data();
+      iov.iov_len = sending_data.size();
+      iovecs.push_back(iov);
+    }
+    for (int i = 0; i < num_datagrams; ++i) {
+      struct iovec iov;
+      if (i < (int)headers.size() && !headers[i].empty()) {
+        iov.iov_base = (void *)headers[i].data();
+        iov.iov_len = headers[i].size();
+        iovecs.push_back(iov);
+      }
+      if (datagrams[i]->get_length() != 0) {
+        iov.iov_base = (void *)datagrams[i]->get_data();
+        iov.iov_len = datagrams[i]->get_length();
+        iovecs.push_back(iov);
+      }
+    }
+
+    if (net_cat.is_spam()) {
+      net_cat.spam()
+        << "Sending " << num_datagrams << " TCP datagram(s) with "
+        << sending_data.size() + total_size + headers.size() * tcp_header_size
+        << " total bytes in " << iovecs.size() << " pieces to "
+        << (void *)this << "\n";
+    }
+
+    // writev() may write only part of the data, or only part of a
+    // piece; keep going until it has all gone.
+    bool okflag = true;
+    size_t first = 0;
+    while (first < iovecs.size()) {
+      int count = (int)min(iovecs.size() - first, (size_t)IOV_MAX);
+      ssize_t bytes_sent = writev(tcp->GetSocket(), &iovecs[first], count);
+      if (bytes_sent < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+#if defined(HAVE_THREADS) && defined(SIMPLE_THREADS)
+          if (tcp->Active()) {
+            Thread::force_yield();
+            continue;
+          }
+#endif  // SIMPLE_THREADS
+          // The socket is non-blocking, and its send buffer is full.
+          // That is not an error; keep the rest of the data queued,
+          // just as do_flush() does.
+          for (size_t i = first; i < iovecs.size(); ++i) {
+            _queued_data.append((const char *)iovecs[i].iov_base,
+                                iovecs[i].iov_len);
+          }
+          ++_queued_count;
+          if (net_cat.is_debug()) {
+            net_cat.debug()
+              << "Socket would block; queued " << _queued_data.size()
+              << " bytes for " << (void *)this << "\n";
+          }
+          break;
+        }
+        okflag = false;
+        break;
+
+      } else if (bytes_sent == 0) {
+        okflag = false;
+        break;
+      }
+
+      size_t remaining = (size_t)bytes_sent;
+      while (first < iovecs.size() && remaining >= iovecs[first].iov_len) {
+        remaining -= iovecs[first].iov_len;
+        ++first;
+      }
+      if (remaining != 0) {
+        iovecs[first].iov_base = (char *)iovecs[first].iov_base + remaining;
+        iovecs[first].iov_len -= remaining;
+      }
+    }
+
+    return check_send_error(okflag);
+  }
+#endif  // HAVE_WRITEV
+
+  // Otherwise, queue up the data, to be sent with anything else that
+  // is waiting.
+  for (int i = 0; i < num_datagrams; ++i) {
+    if (i < (int)headers.size()) {
+      _queued_data += headers[i];
+    }
+    _queued_data.append((const char *)datagrams[i]->get_data(),
+                        datagrams[i]->get_length());
+  }
+  _queued_count += gather ? 1 : num_datagrams;
+
+  if (!_collect_tcp || 
+      TrueClock::get_global_ptr()->get_short_time() - _queued_data_start >= _collect_tcp_interval) {
+    return do_flush();
+  }
+
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: Connection::do_flush
 //       Access: Private
 //  Description: The private implementation of flush(), this assumes
 //               the _write_mutex is already held.
+//
+//               If the socket is non-blocking and cannot take all of
+//               the data now, the rest is left queued, to be sent
+//               ahead of the next datagram, or by the next
+//               consider_flush() or flush().
 ////////////////////////////////////////////////////////////////////
 bool Connection::
 do_flush() {
@@ -531,6 +834,19 @@ do_flush() {
 #else  // SIMPLE_THREADS
   int data_sent = tcp->SendData(sending_data);
   bool okflag = (data_sent == (int)sending_data.size());
+  if (!okflag && (data_sent > 0 || 
+                  (data_sent < 0 && tcp->GetLastError() == LOCAL_BLOCKING_ERROR))) {
+    // The socket is non-blocking, and its send buffer is full.  That
+    // is not an error; keep the rest of the data queued.
+    _queued_data.assign(sending_data, (size_t)max(data_sent, 0), string::npos);
+    _queued_count = 1;
+    if (net_cat.is_debug()) {
+      net_cat.debug()
+        << "Socket would block; queued " << _queued_data.size()
+        << " bytes for " << (void *)this << "\n";
+    }
+    return true;
+  }
 
 #endif  // SIMPLE_THREADS
 
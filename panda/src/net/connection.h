@@ -22,6 +22,7 @@
 
 class Socket_IP;
 class ConnectionManager;
+class Datagram;
 class NetDatagram;
 
 ////////////////////////////////////////////////////////////////////
@@ -62,6 +63,11 @@ PUBLISHED:
 private:
   bool send_datagram(const NetDatagram &datagram, int tcp_header_size);
   bool send_raw_datagram(const NetDatagram &datagram);
+  bool send_udp_batch(const NetDatagram *datagrams, int num_datagrams,
+                      bool raw);
+  bool send_datagram_list(const Datagram *const *datagrams,
+                          int num_datagrams, int tcp_header_size,
+                          bool gather);
   bool do_flush();
   bool check_send_error(bool okflag);
 
@@ -28,9 +28,11 @@
 #include <Iphlpapi.h> // For GetAdaptersAddresses()
 #elif defined(ANDROID)
 #include <net/if.h>
+#include <poll.h>
 #elif !defined(CPPPARSER)
 #include <net/if.h>
 #include <ifaddrs.h>
+#include <poll.h>
 #endif
 
 ////////////////////////////////////////////////////////////////////
@@ -259,6 +261,31 @@ open_TCP_server_rendezvous(const NetAddress &address, int backlog) {
   return connection;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: wait_for_connect
+//  Description: Checks, without blocking, whether a non-blocking
+//               connect() on the socket has finished.  Returns
+//               nonzero if it has, 0 if it is still pending.
+//
+//               select() cannot watch a socket numbered FD_SETSIZE
+//               or above, which a process with many connections may
+//               well be given, so poll() is used where it exists.
+////////////////////////////////////////////////////////////////////
+static int
+wait_for_connect(Socket_TCP *socket) {
+#if defined(WIN32_VC) || defined(WIN64_VC)
+  Socket_fdset fset;
+  fset.setForSocket(*socket);
+  return fset.WaitForWrite(true, 0);
+#else
+  struct pollfd pfd;
+  pfd.fd = socket->GetSocket();
+  pfd.events = POLLOUT;
+  pfd.revents = 0;
+  return poll(&pfd, 1, 0);
+#endif
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: ConnectionManager::open_TCP_client_connection
 //       Access: Published
@@ -279,9 +306,7 @@ open_TCP_client_connection(const NetAddress &address, int timeout_ms) {
     TrueClock *clock = TrueClock::get_global_ptr();
     double start = clock->get_short_time();
     Thread::force_yield();
-    Socket_fdset fset;
-    fset.setForSocket(*socket);
-    int ready = fset.WaitForWrite(true, 0);
+    int ready = wait_for_connect(socket);
     while (ready == 0) {
       double elapsed = clock->get_short_time() - start;
       if (elapsed * 1000.0 > timeout_ms) {
@@ -290,8 +315,7 @@ open_TCP_client_connection(const NetAddress &address, int timeout_ms) {
         break;
       }
       Thread::force_yield();
-      fset.setForSocket(*socket);
-      ready = fset.WaitForWrite(true, 0);
+      ready = wait_for_connect(socket);
     }
   }
 
@@ -28,8 +28,61 @@
 #include "atomicAdjust.h"
 #include "config_downloader.h"
 
+#if defined(IS_LINUX)
+#include <unistd.h>
+#include <errno.h>
+#endif
+
 static const int read_buffer_size = maximum_udp_datagram + datagram_udp_header_size;
 
+// The maximum number of events to collect from epoll at once.
+static const int epoll_max_events = 256;
+
+////////////////////////////////////////////////////////////////////
+//       Class : ConnectionReader::UdpRing
+// Description : A preallocated set of buffers into which a batch of
+//               UDP datagrams may be read with a single recvmmsg()
+//               call.
+////////////////////////////////////////////////////////////////////
+class ConnectionReader::UdpRing {
+public:
+  UdpRing(int size);
+
+  int _size;
+  pvector<char> _buffers;
+  pvector<Socket_Address> _addresses;
+#ifdef HAVE_MMSG
+  pvector<struct iovec> _iovecs;
+  pvector<struct mmsghdr> _msgs;
+#endif
+};
+
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionReader::UdpRing::Constructor
+//       Access: Public
+//  Description: Allocates buffers for the indicated number of
+//               datagrams, and points the message headers at them.
+////////////////////////////////////////////////////////////////////
+ConnectionReader::UdpRing::
+UdpRing(int size) :
+  _size(size),
+  _buffers(size * read_buffer_size),
+  _addresses(size)
+{
+#ifdef HAVE_MMSG
+  _iovecs.resize(size);
+  _msgs.resize(size);
+  memset(&_msgs[0], 0, size * sizeof(struct mmsghdr));
+  for (int i = 0; i < size; ++i) {
+    _iovecs[i].iov_base = &_buffers[i * read_buffer_size];
+    _iovecs[i].iov_len = read_buffer_size;
+    _msgs[i].msg_hdr.msg_iov = &_iovecs[i];
+    _msgs[i].msg_hdr.msg_iovlen = 1;
+    _msgs[i].msg_hdr.msg_name = &_addresses[i].GetAddressInfo();
+  }
+#endif  // HAVE_MMSG
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: ConnectionReader::SocketInfo::Constructor
 //       Access: Public
@@ -41,6 +94,20 @@ SocketInfo(const PT(Connection) &connection) :
 {
   _busy = false;
   _error = false;
+  _index = -1;
+  _shard = -1;
+  _removed = false;
+  _udp_ring = NULL;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionReader::SocketInfo::Destructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+ConnectionReader::SocketInfo::
+~SocketInfo() {
+  delete _udp_ring;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -63,6 +130,22 @@ get_socket() const {
   return _connection->get_socket();
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionReader::SocketInfo::get_udp_ring
+//       Access: Public
+//  Description: Returns the buffers for reading a batch of the
+//               indicated number of datagrams from this socket,
+//               allocating them if necessary.
+////////////////////////////////////////////////////////////////////
+ConnectionReader::UdpRing *ConnectionReader::SocketInfo::
+get_udp_ring(int size) {
+  if (_udp_ring == (UdpRing *)NULL || _udp_ring->_size != size) {
+    delete _udp_ring;
+    _udp_ring = new UdpRing(size);
+  }
+  return _udp_ring;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: ConnectionReader::ReaderThread::Constructor
 //       Access: Public
@@ -88,6 +171,19 @@ thread_main() {
   _reader->thread_run(_thread_index);
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionReader::Shard::Constructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+ConnectionReader::Shard::
+Shard() {
+  _epoll_fd = -1;
+  _num_sockets = 0;
+  _next_event = 0;
+  _num_events = 0;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: ConnectionReader::Constructor
 //       Access: Published
@@ -116,6 +212,7 @@ ConnectionReader(ConnectionManager *manager, int num_threads,
 
   _raw_mode = false;
   _tcp_header_size = tcp_header_size;
+  _udp_batch_size = 1;
   _polling = (num_threads <= 0);
 
   _shutdown = false;
@@ -125,6 +222,11 @@ ConnectionReader(ConnectionManager *manager, int num_threads,
 
   _currently_polling_thread = -1;
 
+  _use_epoll = false;
+  if (net_use_epoll) {
+    init_epoll(max(num_threads, 1));
+  }
+
   string reader_thread_name = thread_name;
   if (thread_name.empty()) {
     reader_thread_name = "ReaderThread";
@@ -172,6 +274,22 @@ ConnectionReader::
       sinfo->_connection.clear();
     }
   }
+
+  Shards::iterator shi;
+  for (shi = _shards.begin(); shi != _shards.end(); ++shi) {
+    Shard &shard = (*shi);
+    for (si = shard._removed_sockets.begin(); 
+         si != shard._removed_sockets.end(); 
+         ++si) {
+      SocketInfo *sinfo = (*si);
+      if (!sinfo->_busy) {
+        delete sinfo;
+      } else {
+        sinfo->_connection.clear();
+      }
+    }
+  }
+  close_epoll();
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -198,15 +316,19 @@ add_connection(Connection *connection) {
   LightMutexHolder holder(_sockets_mutex);
 
   // Make sure it's not already on the _sockets list.
-  Sockets::const_iterator si;
-  for (si = _sockets.begin(); si != _sockets.end(); ++si) {
-    if ((*si)->_connection == connection) {
-      // Whoops, already there.
-      return false;
-    }
+  if (_connection_sockets.find(connection) != _connection_sockets.end()) {
+    // Whoops, already there.
+    return false;
   }
 
-  _sockets.push_back(new SocketInfo(connection));
+  SocketInfo *sinfo = new SocketInfo(connection);
+  sinfo->_index = (int)_sockets.size();
+  _sockets.push_back(sinfo);
+  _connection_sockets[connection] = sinfo;
+
+  if (_use_epoll) {
+    add_to_shard(sinfo);
+  }
 
   return true;
 }
@@ -226,18 +348,26 @@ bool ConnectionReader::
 remove_connection(Connection *connection) {
   LightMutexHolder holder(_sockets_mutex);
 
-  // Walk through the list of sockets to find the one we're removing.
-  Sockets::iterator si;
-  si = _sockets.begin();
-  while (si != _sockets.end() && (*si)->_connection != connection) {
-    ++si;
-  }
-  if (si == _sockets.end()) {
+  ConnectionSockets::iterator ci = _connection_sockets.find(connection);
+  if (ci == _connection_sockets.end()) {
     return false;
   }
-
-  _removed_sockets.push_back(*si);
-  _sockets.erase(si);
+  SocketInfo *sinfo = (*ci).second;
+  _connection_sockets.erase(ci);
+
+  // Fill the hole in _sockets with the last socket in the list.
+  nassertr(_sockets[sinfo->_index] == sinfo, false);
+  SocketInfo *last = _sockets.back();
+  _sockets[sinfo->_index] = last;
+  last->_index = sinfo->_index;
+  _sockets.pop_back();
+
+  sinfo->_removed = true;
+  if (_use_epoll) {
+    remove_from_shard(sinfo);
+  } else {
+    _removed_sockets.push_back(sinfo);
+  }
 
   return true;
 }
@@ -257,19 +387,13 @@ bool ConnectionReader::
 is_connection_ok(Connection *connection) {
   LightMutexHolder holder(_sockets_mutex);
 
-  // Walk through the list of sockets to find the one we're asking
-  // about.
-  Sockets::iterator si;
-  si = _sockets.begin();
-  while (si != _sockets.end() && (*si)->_connection != connection) {
-    ++si;
-  }
-  if (si == _sockets.end()) {
+  ConnectionSockets::const_iterator ci = _connection_sockets.find(connection);
+  if (ci == _connection_sockets.end()) {
     // Don't know that connection.
     return false;
   }
 
-  SocketInfo *sinfo = (*si);
+  SocketInfo *sinfo = (*ci).second;
   bool is_ok = !sinfo->_error;
 
   return is_ok;
@@ -393,6 +517,37 @@ get_tcp_header_size() const {
   return _tcp_header_size;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionReader::set_udp_batch_size
+//       Access: Published
+//  Description: Sets the maximum number of datagrams to read from a
+//               UDP socket at once.  If this is greater than 1, and
+//               the platform supports it, all of the datagrams
+//               waiting on a UDP socket, up to this number, are read
+//               with a single recvmmsg() call into buffers kept for
+//               the socket, which saves a system call per datagram
+//               when they arrive quickly.  They are then passed to
+//               receive_datagram() one at a time, as usual.
+//
+//               The default is 1, which reads each datagram with a
+//               separate call.
+////////////////////////////////////////////////////////////////////
+void ConnectionReader::
+set_udp_batch_size(int udp_batch_size) {
+  _udp_batch_size = max(udp_batch_size, 1);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionReader::get_udp_batch_size
+//       Access: Published
+//  Description: Returns the current setting of the UDP batch size.
+//               See set_udp_batch_size().
+////////////////////////////////////////////////////////////////////
+int ConnectionReader::
+get_udp_batch_size() const {
+  return _udp_batch_size;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: ConnectionReader::shutdown
 //       Access: Published
@@ -484,6 +639,10 @@ finish_socket(SocketInfo *sinfo) {
   // By marking the SocketInfo nonbusy, we make it available for
   // future polls.
   sinfo->_busy = false;
+
+  if (_use_epoll) {
+    rearm_socket(sinfo);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -519,6 +678,12 @@ process_incoming_data(SocketInfo *sinfo) {
 ////////////////////////////////////////////////////////////////////
 bool ConnectionReader::
 process_incoming_udp_data(SocketInfo *sinfo) {
+#ifdef HAVE_MMSG
+  if (_udp_batch_size > 1) {
+    return process_incoming_udp_batch(sinfo, false);
+  }
+#endif  // HAVE_MMSG
+
   Socket_UDP *socket;
   DCAST_INTO_R(socket, sinfo->get_socket(), false);
   Socket_Address addr;
@@ -734,6 +899,12 @@ process_incoming_tcp_data(SocketInfo *sinfo) {
 ////////////////////////////////////////////////////////////////////
 bool ConnectionReader::
 process_raw_incoming_udp_data(SocketInfo *sinfo) {
+#ifdef HAVE_MMSG
+  if (_udp_batch_size > 1) {
+    return process_incoming_udp_batch(sinfo, true);
+  }
+#endif  // HAVE_MMSG
+
   Socket_UDP *socket;
   DCAST_INTO_R(socket, sinfo->get_socket(), false);
   Socket_Address addr;
@@ -842,6 +1013,106 @@ process_raw_incoming_tcp_data(SocketInfo *sinfo) {
   return true;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionReader::process_incoming_udp_batch
+//       Access: Protected
+//  Description: Reads all of the datagrams waiting on a UDP socket,
+//               up to the UDP batch size, with a single system call,
+//               and passes them to receive_datagram() in order.  If
+//               raw is true, the datagrams are not expected to have
+//               headers.
+////////////////////////////////////////////////////////////////////
+bool ConnectionReader::
+process_incoming_udp_batch(SocketInfo *sinfo, bool raw) {
+#ifdef HAVE_MMSG
+  Socket_UDP *socket;
+  DCAST_INTO_R(socket, sinfo->get_socket(), false);
+  UdpRing *ring = sinfo->get_udp_ring(_udp_batch_size);
+
+  for (int i = 0; i < ring->_size; ++i) {
+    // recvmmsg() replaces these with the actual sizes.
+    ring->_msgs[i].msg_hdr.msg_namelen = sizeof(Socket_Address::AddressType);
+  }
+
+  int num_read = recvmmsg(socket->GetSocket(), &ring->_msgs[0], ring->_size,
+                          MSG_DONTWAIT, NULL);
+  if (num_read < 0) {
+    finish_socket(sinfo);
+    // As in GetPacket(), there may just be nothing to read after all.
+    return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+
+  } else if (num_read == 0) {
+    // The socket was closed (!).  This shouldn't happen with a UDP
+    // connection.  Oh well.  Report that and return.
+    if (_manager != (ConnectionManager *)NULL) {
+      _manager->connection_reset(sinfo->_connection, 0);
+    }
+    finish_socket(sinfo);
+    return false;
+  }
+
+  // Copy the datagrams out of the ring before we finish the socket,
+  // since another thread may then read into it.
+  pvector<NetDatagram> datagrams;
+  datagrams.reserve(num_read);
+  for (int i = 0; i < num_read; ++i) {
+    char *buffer = &ring->_buffers[i * read_buffer_size];
+    int bytes_read = (int)ring->_msgs[i].msg_len;
+
+    if (raw) {
+      datagrams.push_back(NetDatagram(buffer, bytes_read));
+
+    } else {
+      if (bytes_read < datagram_udp_header_size) {
+        net_cat.error()
+          << "Did not read entire header, discarding UDP datagram.\n";
+        continue;
+      }
+
+      DatagramUDPHeader header(buffer);
+      NetDatagram datagram(buffer + datagram_udp_header_size,
+                           bytes_read - datagram_udp_header_size);
+      if (!header.verify_datagram(datagram)) {
+        net_cat.error()
+          << "Ignoring invalid UDP datagram.\n";
+        continue;
+      }
+      datagrams.push_back(datagram);
+    }
+
+    NetDatagram &datagram = datagrams.back();
+    datagram.set_connection(sinfo->_connection);
+    datagram.set_address(NetAddress(ring->_addresses[i]));
+  }
+
+  finish_socket(sinfo);
+
+  if (_shutdown) {
+    return false;
+  }
+
+  if (net_cat.is_spam()) {
+    net_cat.spam()
+      << "Received batch of " << datagrams.size() << " UDP datagrams on " 
+      << (void *)sinfo->_connection << "\n";
+  }
+
+  pvector<NetDatagram>::const_iterator di;
+  for (di = datagrams.begin(); di != datagrams.end(); ++di) {
+    receive_datagram(*di);
+  }
+
+  return true;
+
+#else  // HAVE_MMSG
+  if (raw) {
+    return process_raw_incoming_udp_data(sinfo);
+  } else {
+    return process_incoming_udp_data(sinfo);
+  }
+#endif  // HAVE_MMSG
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: ConnectionReader::thread_run
 //       Access: Private
@@ -879,6 +1150,11 @@ thread_run(int thread_index) {
 ////////////////////////////////////////////////////////////////////
 ConnectionReader::SocketInfo *ConnectionReader::
 get_next_available_socket(bool allow_block, int current_thread_index) {
+  if (_use_epoll) {
+    // A polling reader has only the one shard.
+    return get_next_epoll_socket(allow_block, max(current_thread_index, 0));
+  }
+
   // Go to sleep on the select() mutex.  This guarantees that only one
   // thread is in this function at a time.
   MutexHolder holder(_select_mutex);
@@ -1016,3 +1292,230 @@ accumulate_fdset(Socket_fdset &fdset) {
     }
   }
 }
+
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionReader::init_epoll
+//       Access: Private
+//  Description: Creates the indicated number of epoll instances, one
+//               for each thread.  If epoll is not available, leaves
+//               _use_epoll false, so that select() is used instead.
+////////////////////////////////////////////////////////////////////
+void ConnectionReader::
+init_epoll(int num_shards) {
+#ifdef IS_LINUX
+  _shards.resize(num_shards);
+  for (int i = 0; i < num_shards; ++i) {
+    Shard &shard = _shards[i];
+    shard._epoll_fd = epoll_create(epoll_max_events);
+    if (shard._epoll_fd < 0) {
+      net_cat.warning()
+        << "Unable to create epoll instance, using select() instead.\n";
+      close_epoll();
+      return;
+    }
+    shard._events.resize(epoll_max_events);
+  }
+  _use_epoll = true;
+
+#else  // IS_LINUX
+  if (net_cat.is_debug()) {
+    net_cat.debug()
+      << "epoll is not available on this platform.\n";
+  }
+#endif  // IS_LINUX
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionReader::close_epoll
+//       Access: Private
+//  Description: Closes the epoll instances created by init_epoll().
+////////////////////////////////////////////////////////////////////
+void ConnectionReader::
+close_epoll() {
+#ifdef IS_LINUX
+  Shards::iterator shi;
+  for (shi = _shards.begin(); shi != _shards.end(); ++shi) {
+    if ((*shi)._epoll_fd >= 0) {
+      close((*shi)._epoll_fd);
+    }
+  }
+#endif  // IS_LINUX
+  _shards.clear();
+  _use_epoll = false;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionReader::get_next_epoll_socket
+//       Access: Private
+//  Description: The epoll equivalent of get_next_available_socket().
+//               Returns the next socket in the indicated shard known
+//               to have activity, or NULL if no activity is detected
+//               within the timeout interval.  Only the shard's own
+//               thread may call this.
+//
+//               Each socket is registered with EPOLLONESHOT, so that
+//               once it has been reported it is not reported again
+//               until finish_socket() rearms it; this corresponds to
+//               the _busy flag in the select() case.
+////////////////////////////////////////////////////////////////////
+ConnectionReader::SocketInfo *ConnectionReader::
+get_next_epoll_socket(bool allow_block, int shard_index) {
+#ifdef IS_LINUX
+  nassertr(shard_index >= 0 && shard_index < (int)_shards.size(), NULL);
+  Shard &shard = _shards[shard_index];
+
+  if (!_shutdown && shard._next_event >= shard._num_events) {
+    // We have handed out all of the sockets from the previous wait.
+    // That means we can't be holding on to any sockets that have
+    // been removed since, so this is a fine time to delete them.
+    {
+      LightMutexHolder holder(_sockets_mutex);
+      if (!shard._removed_sockets.empty()) {
+        Sockets still_busy_sockets;
+        Sockets::iterator si;
+        for (si = shard._removed_sockets.begin(); 
+             si != shard._removed_sockets.end(); 
+             ++si) {
+          SocketInfo *sinfo = (*si);
+          if (sinfo->_busy) {
+            still_busy_sockets.push_back(sinfo);
+          } else {
+            delete sinfo;
+          }
+        }
+        shard._removed_sockets.swap(still_busy_sockets);
+      }
+    }
+
+    // Now wait for more noise.
+    int timeout = (int)(get_net_max_block() * 1000.0);
+    if (!allow_block) {
+      timeout = 0;
+    }
+#if defined(HAVE_THREADS) && defined(SIMPLE_THREADS)
+    timeout = 0;
+#endif
+
+    int num_events = 
+      epoll_wait(shard._epoll_fd, &shard._events[0], (int)shard._events.size(),
+                 timeout);
+    shard._next_event = 0;
+    shard._num_events = max(num_events, 0);
+    if (num_events < 0) {
+      if (errno != EINTR) {
+        net_cat.error()
+          << "epoll_wait failed: " << strerror(errno) << "\n";
+      }
+      Thread::force_yield();
+      return (SocketInfo *)NULL;
+    }
+  }
+
+  // Return the next socket that hasn't been removed in the meantime.
+  while (!_shutdown && shard._next_event < shard._num_events) {
+    SocketInfo *sinfo = 
+      (SocketInfo *)shard._events[shard._next_event].data.ptr;
+    ++shard._next_event;
+
+    LightMutexHolder holder(_sockets_mutex);
+    if (!sinfo->_removed) {
+      sinfo->_busy = true;
+      return sinfo;
+    }
+  }
+#endif  // IS_LINUX
+
+  return (SocketInfo *)NULL;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionReader::add_to_shard
+//       Access: Private
+//  Description: Assigns a newly-added socket to the shard with the
+//               fewest sockets, and registers it with that shard's
+//               epoll instance.  Assumes _sockets_mutex is held.
+////////////////////////////////////////////////////////////////////
+void ConnectionReader::
+add_to_shard(SocketInfo *sinfo) {
+#ifdef IS_LINUX
+  int best = 0;
+  for (int i = 1; i < (int)_shards.size(); ++i) {
+    if (_shards[i]._num_sockets < _shards[best]._num_sockets) {
+      best = i;
+    }
+  }
+
+  Shard &shard = _shards[best];
+  sinfo->_shard = best;
+  ++shard._num_sockets;
+
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN | EPOLLONESHOT;
+  event.data.ptr = sinfo;
+  if (epoll_ctl(shard._epoll_fd, EPOLL_CTL_ADD, 
+                sinfo->get_socket()->GetSocket(), &event) != 0) {
+    net_cat.error()
+      << "Unable to add socket to epoll: " << strerror(errno) << "\n";
+    sinfo->_error = true;
+  }
+#endif  // IS_LINUX
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionReader::remove_from_shard
+//       Access: Private
+//  Description: Unregisters a removed socket from its shard's epoll
+//               instance, and queues it to be deleted by the shard's
+//               thread.  Assumes _sockets_mutex is held.
+////////////////////////////////////////////////////////////////////
+void ConnectionReader::
+remove_from_shard(SocketInfo *sinfo) {
+#ifdef IS_LINUX
+  nassertv(sinfo->_shard >= 0 && sinfo->_shard < (int)_shards.size());
+  Shard &shard = _shards[sinfo->_shard];
+  --shard._num_sockets;
+
+  // Kernels before 2.6.9 require a non-NULL event, even though it
+  // is ignored.
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  epoll_ctl(shard._epoll_fd, EPOLL_CTL_DEL, 
+            sinfo->get_socket()->GetSocket(), &event);
+
+  shard._removed_sockets.push_back(sinfo);
+#endif  // IS_LINUX
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionReader::rearm_socket
+//       Access: Private
+//  Description: Called by finish_socket() to make a socket available
+//               to epoll again, after it has been reported once.  If
+//               there is still data waiting on the socket, it will be
+//               reported again right away.
+////////////////////////////////////////////////////////////////////
+void ConnectionReader::
+rearm_socket(SocketInfo *sinfo) {
+#ifdef IS_LINUX
+  if (sinfo->_shard < 0) {
+    // This is a temporary SocketInfo, as in flush_read_connection().
+    return;
+  }
+
+  // We must check _removed while holding the lock, or we might
+  // re-register the descriptor after it has been removed and closed,
+  // and perhaps reused for a different socket.
+  LightMutexHolder holder(_sockets_mutex);
+  if (sinfo->_removed || sinfo->_error) {
+    return;
+  }
+
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN | EPOLLONESHOT;
+  event.data.ptr = sinfo;
+  epoll_ctl(_shards[sinfo->_shard]._epoll_fd, EPOLL_CTL_MOD, 
+            sinfo->get_socket()->GetSocket(), &event);
+#endif  // IS_LINUX
+}
@@ -24,9 +24,14 @@
 #include "lightMutex.h"
 #include "pvector.h"
 #include "pset.h"
+#include "pmap.h"
 #include "socket_fdset.h"
 #include "atomicAdjust.h"
 
+#if defined(IS_LINUX) && !defined(CPPPARSER)
+#include <sys/epoll.h>
+#endif
+
 class NetDatagram;
 class ConnectionManager;
 class Socket_Address;
@@ -53,6 +58,14 @@ class Socket_IP;
 //               ConnectionListener derives from this class, extending
 //               it to accept connections on a rendezvous socket
 //               rather than read datagrams.
+//
+//               On Linux, if net-use-epoll is set, the reader waits
+//               on epoll instead of select().  In this case, each
+//               thread has an epoll instance of its own, and each
+//               socket is assigned to one of the threads when it is
+//               added, so that the threads do not contend with each
+//               other to wait for noise, and there is no limit on the
+//               number of sockets.
 ////////////////////////////////////////////////////////////////////
 class EXPCL_PANDA_NET ConnectionReader {
 PUBLISHED:
@@ -80,6 +93,7 @@ PUBLISHED:
   ConnectionManager *get_manager() const;
   INLINE bool is_polling() const;
   int get_num_threads() const;
+  INLINE bool get_use_epoll() const;
 
   void set_raw_mode(bool mode);
   bool get_raw_mode() const;
@@ -87,23 +101,42 @@ PUBLISHED:
   void set_tcp_header_size(int tcp_header_size);
   int get_tcp_header_size() const;
 
+  void set_udp_batch_size(int udp_batch_size);
+  int get_udp_batch_size() const;
+
   void shutdown();
 
 protected:
   virtual void flush_read_connection(Connection *connection);
   virtual void receive_datagram(const NetDatagram &datagram)=0;
 
+  class UdpRing;
+
   class SocketInfo {
   public:
     SocketInfo(const PT(Connection) &connection);
+    ~SocketInfo();
     bool is_udp() const;
     Socket_IP *get_socket() const;
+    UdpRing *get_udp_ring(int size);
 
     PT(Connection) _connection;
     bool _busy;
     bool _error;
+
+    // The index of this socket within _sockets, and the epoll shard
+    // it has been assigned to, if any.
+    int _index;
+    int _shard;
+    bool _removed;
+
+    // The buffers for reading a batch of datagrams at once from a UDP
+    // socket, allocated the first time they are needed.  Since only
+    // one thread at a time reads a given socket, they need no lock.
+    UdpRing *_udp_ring;
   };
   typedef pvector<SocketInfo *> Sockets;
+  typedef phash_map<Connection *, SocketInfo *, pointer_hash> ConnectionSockets;
 
   void clear_manager();
   void finish_socket(SocketInfo *sinfo);
@@ -113,6 +146,7 @@ protected:
   virtual bool process_incoming_tcp_data(SocketInfo *sinfo);
   virtual bool process_raw_incoming_udp_data(SocketInfo *sinfo);
   virtual bool process_raw_incoming_tcp_data(SocketInfo *sinfo);
+  bool process_incoming_udp_batch(SocketInfo *sinfo, bool raw);
 
 protected:
   ConnectionManager *_manager;
@@ -120,6 +154,7 @@ protected:
   // These structures track the total set of sockets (connections) we
   // know about.
   Sockets _sockets;
+  ConnectionSockets _connection_sockets;
   // This is the list of recently-removed sockets.  We can't actually
   // delete them until they're no longer _busy.
   Sockets _removed_sockets;
@@ -135,9 +170,17 @@ private:
   void rebuild_select_list();
   void accumulate_fdset(Socket_fdset &fdset);
 
+  void init_epoll(int num_shards);
+  void close_epoll();
+  SocketInfo *get_next_epoll_socket(bool allow_block, int shard_index);
+  void add_to_shard(SocketInfo *sinfo);
+  void remove_from_shard(SocketInfo *sinfo);
+  void rearm_socket(SocketInfo *sinfo);
+
 private:
   bool _raw_mode;
   int _tcp_header_size;
+  int _udp_batch_size;
   bool _shutdown;
 
   class ReaderThread : public Thread {
@@ -169,6 +212,30 @@ private:
   // contains -1 if no thread is so waiting.
   AtomicAdjust::Integer _currently_polling_thread;
 
+  // When epoll is in use, there is one of these for each thread (or
+  // just one, for a polling reader).  Each shard is only ever waited
+  // on by its own thread, so it needs no lock of its own, except for
+  // the members shared with add_connection() and remove_connection(),
+  // which are protected by _sockets_mutex.
+  class Shard {
+  public:
+    Shard();
+
+    int _epoll_fd;
+    int _num_sockets;
+    // Sockets removed from this shard, to be deleted by its thread
+    // once it can no longer be holding an event for them.
+    Sockets _removed_sockets;
+#if defined(IS_LINUX) && !defined(CPPPARSER)
+    pvector<struct epoll_event> _events;
+#endif
+    int _next_event;
+    int _num_events;
+  };
+  typedef pvector<Shard> Shards;
+  Shards _shards;
+  bool _use_epoll;
+
   friend class ConnectionManager;
   friend class ReaderThread;
 };
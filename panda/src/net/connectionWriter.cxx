@@ -75,6 +75,7 @@ ConnectionWriter(ConnectionManager *manager, int num_threads,
 
   _raw_mode = false;
   _tcp_header_size = tcp_header_size;
+  _udp_batch_size = 1;
   _immediate = (num_threads <= 0);
   _shutdown = false;
 
@@ -178,7 +179,11 @@ send(const Datagram &datagram, const PT(Connection) &connection, bool block) {
       return connection->send_datagram(copy, _tcp_header_size);
     }
   } else {
+#ifdef USE_MOVE_SEMANTICS
+    return _queue.insert(move(copy), block);
+#else
     return _queue.insert(copy, block);
+#endif
   }
 }
 
@@ -228,10 +233,122 @@ send(const Datagram &datagram, const PT(Connection) &connection,
       return connection->send_datagram(copy, _tcp_header_size);
     }
   } else {
+#ifdef USE_MOVE_SEMANTICS
+    return _queue.insert(move(copy), block);
+#else
     return _queue.insert(copy, block);
+#endif
   }
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionWriter::send_list
+//       Access: Public
+//  Description: Enqueues a list of datagrams for transmittal, in
+//               order, on the indicated TCP socket, each with its own
+//               header as if it had been passed to send() in turn.
+//
+//               If the ConnectionWriter is immediate, the headers and
+//               datagrams are written together with a single writev()
+//               call where possible, without first being copied into
+//               one buffer.  A threaded ConnectionWriter queues them
+//               individually; see set_udp_batch_size() to have its
+//               threads write them together.
+//
+//               Returns true if successful, false if there was an
+//               error, as for send().  If the queue fills up part way
+//               through the list, and block is false, the rest of the
+//               list is not sent.
+////////////////////////////////////////////////////////////////////
+bool ConnectionWriter::
+send_list(const pvector<Datagram> &datagrams,
+          const PT(Connection) &connection, bool block) {
+  nassertr(!_shutdown, false);
+  nassertr(connection != (Connection *)NULL, false);
+  nassertr(connection->get_socket()->is_exact_type(Socket_TCP::get_class_type()), false);
+
+  if (datagrams.empty()) {
+    return true;
+  }
+
+  if (_immediate) {
+    pvector<const Datagram *> pointers;
+    pointers.reserve(datagrams.size());
+    pvector<Datagram>::const_iterator di;
+    for (di = datagrams.begin(); di != datagrams.end(); ++di) {
+      pointers.push_back(&(*di));
+    }
+    return connection->send_datagram_list(&pointers[0], (int)pointers.size(),
+                                          _raw_mode ? 0 : _tcp_header_size,
+                                          false);
+  }
+
+  pvector<Datagram>::const_iterator di;
+  for (di = datagrams.begin(); di != datagrams.end(); ++di) {
+    NetDatagram copy(*di);
+    copy.set_connection(connection);
+#ifdef USE_MOVE_SEMANTICS
+    if (!_queue.insert(move(copy), block)) {
+#else
+    if (!_queue.insert(copy, block)) {
+#endif
+      return false;
+    }
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionWriter::send_gathered
+//       Access: Public
+//  Description: Enqueues a single datagram, made up of the indicated
+//               pieces one after another, for transmittal on the
+//               indicated TCP socket.  This is the same as appending
+//               the pieces together into one datagram and passing it
+//               to send(), but on an immediate ConnectionWriter it
+//               avoids the copy: the pieces are written straight from
+//               their own buffers, behind one header, with a single
+//               writev() call where possible.
+//
+//               A threaded ConnectionWriter must still put the pieces
+//               together to queue them.
+////////////////////////////////////////////////////////////////////
+bool ConnectionWriter::
+send_gathered(const pvector<Datagram> &pieces,
+              const PT(Connection) &connection, bool block) {
+  nassertr(!_shutdown, false);
+  nassertr(connection != (Connection *)NULL, false);
+  nassertr(connection->get_socket()->is_exact_type(Socket_TCP::get_class_type()), false);
+
+  if (_immediate) {
+    pvector<const Datagram *> pointers;
+    pointers.reserve(pieces.size());
+    pvector<Datagram>::const_iterator pi;
+    for (pi = pieces.begin(); pi != pieces.end(); ++pi) {
+      pointers.push_back(&(*pi));
+    }
+    Datagram empty;
+    if (pointers.empty()) {
+      pointers.push_back(&empty);
+    }
+    return connection->send_datagram_list(&pointers[0], (int)pointers.size(),
+                                          _raw_mode ? 0 : _tcp_header_size,
+                                          true);
+  }
+
+  NetDatagram datagram;
+  pvector<Datagram>::const_iterator pi;
+  for (pi = pieces.begin(); pi != pieces.end(); ++pi) {
+    datagram.append_data((*pi).get_data(), (*pi).get_length());
+  }
+  datagram.set_connection(connection);
+#ifdef USE_MOVE_SEMANTICS
+  return _queue.insert(move(datagram), block);
+#else
+  return _queue.insert(datagram, block);
+#endif
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: ConnectionWriter::is_valid_for_udp
 //       Access: Public
@@ -331,6 +448,42 @@ get_tcp_header_size() const {
   return _tcp_header_size;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionWriter::set_udp_batch_size
+//       Access: Published
+//  Description: Sets the maximum number of datagrams a writer thread
+//               will take from the queue at once.  If this is greater
+//               than 1, consecutive datagrams queued for the same
+//               connection are written together with a single
+//               system call, where the platform supports it:
+//               sendmmsg() for UDP, or writev() for TCP.  This saves
+//               a system call per datagram when many are sent
+//               quickly.
+//
+//               This has no effect on an immediate ConnectionWriter
+//               (one with no threads), since it never has more than
+//               one datagram to send at a time.  The default is 1.
+//
+//               This may be changed at any time; a thread that is
+//               already waiting on the queue applies the new setting
+//               after it has sent the next datagram.
+////////////////////////////////////////////////////////////////////
+void ConnectionWriter::
+set_udp_batch_size(int udp_batch_size) {
+  AtomicAdjust::set(_udp_batch_size, max(udp_batch_size, 1));
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionWriter::get_udp_batch_size
+//       Access: Published
+//  Description: Returns the current setting of the UDP batch size.
+//               See set_udp_batch_size().
+////////////////////////////////////////////////////////////////////
+int ConnectionWriter::
+get_udp_batch_size() const {
+  return (int)AtomicAdjust::get(_udp_batch_size);
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: ConnectionWriter::shutdown
 //       Access: Published
@@ -383,13 +536,71 @@ void ConnectionWriter::
 thread_run(int thread_index) {
   nassertv(!_immediate);
 
-  NetDatagram datagram;
-  while (_queue.extract(datagram)) {
-    if (_raw_mode) {
-      datagram.get_connection()->send_raw_datagram(datagram);
+  pvector<NetDatagram> datagrams;
+  while (true) {
+    // The batch size may have been changed since the last pass.
+    int udp_batch_size = (int)AtomicAdjust::get(_udp_batch_size);
+    if (udp_batch_size > 1) {
+      if (_queue.extract_batch(datagrams, udp_batch_size) == 0) {
+        return;
+      }
+      send_batch(datagrams);
+      datagrams.clear();
+
     } else {
-      datagram.get_connection()->send_datagram(datagram, _tcp_header_size);
+      NetDatagram datagram;
+      if (!_queue.extract(datagram)) {
+        return;
+      }
+      if (_raw_mode) {
+        datagram.get_connection()->send_raw_datagram(datagram);
+      } else {
+        datagram.get_connection()->send_datagram(datagram, _tcp_header_size);
+      }
     }
     Thread::consider_yield();
   }
 }
+
+////////////////////////////////////////////////////////////////////
+//     Function: ConnectionWriter::send_batch
+//       Access: Private
+//  Description: Sends a batch of datagrams taken from the queue, in
+//               order.  Each run of consecutive datagrams for the
+//               same connection is sent with one call: sendmmsg() for
+//               UDP, or writev() for TCP.
+////////////////////////////////////////////////////////////////////
+void ConnectionWriter::
+send_batch(const pvector<NetDatagram> &datagrams) {
+  size_t num_datagrams = datagrams.size();
+  size_t i = 0;
+  while (i < num_datagrams) {
+    Connection *connection = datagrams[i].get_connection();
+    size_t j = i + 1;
+    while (j < num_datagrams && datagrams[j].get_connection() == connection) {
+      ++j;
+    }
+
+    Socket_IP *socket = connection->get_socket();
+    if (socket == (Socket_IP *)NULL) {
+      // The connection has been closed; let send_datagram() report it.
+      for (size_t k = i; k < j; ++k) {
+        connection->send_datagram(datagrams[k], _tcp_header_size);
+      }
+
+    } else if (socket->is_exact_type(Socket_UDP::get_class_type())) {
+      connection->send_udp_batch(&datagrams[i], (int)(j - i), _raw_mode);
+
+    } else {
+      pvector<const Datagram *> pointers;
+      pointers.reserve(j - i);
+      for (size_t k = i; k < j; ++k) {
+        pointers.push_back(&datagrams[k]);
+      }
+      connection->send_datagram_list(&pointers[0], (int)pointers.size(),
+                                     _raw_mode ? 0 : _tcp_header_size,
+                                     false);
+    }
+    i = j;
+  }
+}
@@ -21,6 +21,7 @@
 #include "pointerTo.h"
 #include "thread.h"
 #include "pvector.h"
+#include "atomicAdjust.h"
 
 class ConnectionManager;
 class NetAddress;
@@ -56,6 +57,16 @@ PUBLISHED:
 
   bool is_valid_for_udp(const Datagram &datagram) const;
 
+public:
+  bool send_list(const pvector<Datagram> &datagrams,
+                 const PT(Connection) &connection,
+                 bool block = false);
+  bool send_gathered(const pvector<Datagram> &pieces,
+                     const PT(Connection) &connection,
+                     bool block = false);
+
+PUBLISHED:
+
   ConnectionManager *get_manager() const;
   bool is_immediate() const;
   int get_num_threads() const;
@@ -66,6 +77,9 @@ PUBLISHED:
   void set_tcp_header_size(int tcp_header_size);
   int get_tcp_header_size() const;
 
+  void set_udp_batch_size(int udp_batch_size);
+  int get_udp_batch_size() const;
+
   void shutdown();
 
 protected:
@@ -73,6 +87,7 @@ protected:
 
 private:
   void thread_run(int thread_index);
+  void send_batch(const pvector<NetDatagram> &datagrams);
   bool send_datagram(const NetDatagram &datagram);
 
 protected:
@@ -81,6 +96,10 @@ protected:
 private:
   bool _raw_mode;
   int _tcp_header_size;
+
+  // This may be changed while the threads are running, so each
+  // thread re-reads it before it takes anything from the queue.
+  AtomicAdjust::Integer _udp_batch_size;
   DatagramQueue _queue;
   bool _shutdown;
 
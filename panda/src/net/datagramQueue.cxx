@@ -80,21 +80,36 @@ bool DatagramQueue::
 insert(const NetDatagram &data, bool block) {
   MutexHolder holder(_cvlock);
 
-  bool enqueue_ok = ((int)_queue.size() < _max_queue_size);
-  if (block) {
-    while (!enqueue_ok && !_shutdown) {
-      _cv.wait();
-      enqueue_ok = ((int)_queue.size() < _max_queue_size);
-    }
+  bool enqueue_ok = wait_for_room(block);
+  if (enqueue_ok) {
+    _queue.push_back(data);
   }
+  _cv.notify();  // Only need to wake up one thread.
+
+  return enqueue_ok;
+}
+
+#ifdef USE_MOVE_SEMANTICS
+////////////////////////////////////////////////////////////////////
+//     Function: DatagramQueue::insert
+//       Access: Public
+//  Description: This flavor of insert() moves the datagram onto the
+//               queue, instead of copying it, leaving the original
+//               empty.
+////////////////////////////////////////////////////////////////////
+bool DatagramQueue::
+insert(NetDatagram &&data, bool block) {
+  MutexHolder holder(_cvlock);
 
+  bool enqueue_ok = wait_for_room(block);
   if (enqueue_ok) {
-    _queue.push_back(data);
+    _queue.push_back(move(data));
   }
   _cv.notify();  // Only need to wake up one thread.
 
   return enqueue_ok;
 }
+#endif  // USE_MOVE_SEMANTICS
 
 
 ////////////////////////////////////////////////////////////////////
@@ -132,7 +147,11 @@ extract(NetDatagram &result) {
   }
 
   nassertr(!_queue.empty(), false);
+#ifdef USE_MOVE_SEMANTICS
+  result = move(_queue.front());
+#else
   result = _queue.front();
+#endif
   _queue.pop_front();
 
   // Wake up any threads waiting to stuff things into the queue.
@@ -141,6 +160,52 @@ extract(NetDatagram &result) {
   return true;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: DatagramQueue::extract_batch
+//       Access: Public
+//  Description: Extracts up to max_count datagrams from the head of
+//               the queue, replacing the contents of result.  Like
+//               extract(), this blocks until at least one datagram
+//               is available; it then takes whatever else is already
+//               waiting, up to the limit, without waiting further.
+//
+//               The return value is the number of datagrams
+//               extracted, or 0 if the queue was destroyed while
+//               waiting.
+////////////////////////////////////////////////////////////////////
+int DatagramQueue::
+extract_batch(pvector<NetDatagram> &result, int max_count) {
+  // As in extract(), don't hold any connection pointers while we
+  // sleep.
+  result.clear();
+
+  MutexHolder holder(_cvlock);
+
+  while (_queue.empty() && !_shutdown) {
+    _cv.wait();
+  }
+
+  if (_shutdown) {
+    return 0;
+  }
+
+  nassertr(!_queue.empty(), 0);
+  int count = min((int)_queue.size(), max(max_count, 1));
+  result.reserve(count);
+  for (int i = 0; i < count; ++i) {
+#ifdef USE_MOVE_SEMANTICS
+    result.push_back(move(_queue.front()));
+#else
+    result.push_back(_queue.front());
+#endif
+    _queue.pop_front();
+  }
+
+  _cv.notify_all();
+
+  return count;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: DatagramQueue::set_max_queue_size
 //       Access: Public
@@ -181,3 +246,23 @@ get_current_queue_size() const {
   int size = _queue.size();
   return size;
 }
+
+////////////////////////////////////////////////////////////////////
+//     Function: DatagramQueue::wait_for_room
+//       Access: Private
+//  Description: Returns true if there is room on the queue for
+//               another datagram.  If block is true, waits for room
+//               first, unless the queue is shut down.  Assumes the
+//               lock is already held.
+////////////////////////////////////////////////////////////////////
+bool DatagramQueue::
+wait_for_room(bool block) {
+  bool enqueue_ok = ((int)_queue.size() < _max_queue_size);
+  if (block) {
+    while (!enqueue_ok && !_shutdown) {
+      _cv.wait();
+      enqueue_ok = ((int)_queue.size() < _max_queue_size);
+    }
+  }
+  return enqueue_ok;
+}
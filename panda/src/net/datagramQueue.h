@@ -21,6 +21,7 @@
 #include "pmutex.h"
 #include "conditionVarFull.h"
 #include "pdeque.h"
+#include "pvector.h"
 
 ////////////////////////////////////////////////////////////////////
 //       Class : DatagramQueue
@@ -35,13 +36,19 @@ public:
   void shutdown();
 
   bool insert(const NetDatagram &data, bool block = false);
+#ifdef USE_MOVE_SEMANTICS
+  bool insert(NetDatagram &&data, bool block = false);
+#endif
   bool extract(NetDatagram &result);
+  int extract_batch(pvector<NetDatagram> &result, int max_count);
 
   void set_max_queue_size(int max_size);
   int get_max_queue_size() const;
   int get_current_queue_size() const;
 
 private:
+  bool wait_for_room(bool block);
+
   Mutex _cvlock;
   ConditionVarFull _cv;  // signaled when queue contents change.
 
@@ -27,32 +27,19 @@
 ////////////////////////////////////////////////////////////////////
 DatagramTCPHeader::
 DatagramTCPHeader(const NetDatagram &datagram, int header_size) {
-  const string &str = datagram.get_message();
-  switch (header_size) {
-  case 0:
-    break;
-
-  case datagram_tcp16_header_size:
-    {
-      PN_uint16 size = str.length();
-      nassertv(size == str.length());
-      _header.add_uint16(size);
-    }
-    break;
-
-  case datagram_tcp32_header_size:
-    {
-      PN_uint32 size = str.length();
-      nassertv(size == str.length());
-      _header.add_uint32(size);
-    }
-    break;
-
-  default:
-    nassertv(false);
-  }
+  set_datagram_size(datagram.get_length(), header_size);
+}
 
-  nassertv((int)_header.get_length() == header_size);
+////////////////////////////////////////////////////////////////////
+//     Function: DatagramTCPHeader::Constructor
+//       Access: Public
+//  Description: This constructor creates a header for a datagram of
+//               the indicated size, which may be sent in several
+//               pieces.
+////////////////////////////////////////////////////////////////////
+DatagramTCPHeader::
+DatagramTCPHeader(size_t datagram_size, int header_size) {
+  set_datagram_size(datagram_size, header_size);
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -128,3 +115,38 @@ verify_datagram(const NetDatagram &datagram, int header_size) const {
 
   return false;
 }
+
+////////////////////////////////////////////////////////////////////
+//     Function: DatagramTCPHeader::set_datagram_size
+//       Access: Private
+//  Description: Fills in the header for a datagram of the indicated
+//               size.
+////////////////////////////////////////////////////////////////////
+void DatagramTCPHeader::
+set_datagram_size(size_t datagram_size, int header_size) {
+  switch (header_size) {
+  case 0:
+    break;
+
+  case datagram_tcp16_header_size:
+    {
+      PN_uint16 size = datagram_size;
+      nassertv(size == datagram_size);
+      _header.add_uint16(size);
+    }
+    break;
+
+  case datagram_tcp32_header_size:
+    {
+      PN_uint32 size = datagram_size;
+      nassertv(size == datagram_size);
+      _header.add_uint32(size);
+    }
+    break;
+
+  default:
+    nassertv(false);
+  }
+
+  nassertv((int)_header.get_length() == header_size);
+}
@@ -38,6 +38,7 @@ class NetDatagram;
 class EXPCL_PANDA_NET DatagramTCPHeader {
 public:
   DatagramTCPHeader(const NetDatagram &datagram, int header_size);
+  DatagramTCPHeader(size_t datagram_size, int header_size);
   DatagramTCPHeader(const void *data, int header_size);
 
   int get_datagram_size(int header_size) const;
@@ -46,6 +47,8 @@ public:
   bool verify_datagram(const NetDatagram &datagram, int header_size) const;
 
 private:
+  void set_datagram_size(size_t datagram_size, int header_size);
+
   // The actual data for the header is stored (somewhat recursively)
   // in its own NetDatagram object.  This is just for convenience of
   // packing and unpacking the header.
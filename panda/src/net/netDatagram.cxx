@@ -83,6 +83,35 @@ operator = (const NetDatagram &copy) {
   _address = copy._address;
 }
 
+#ifdef USE_MOVE_SEMANTICS
+////////////////////////////////////////////////////////////////////
+//     Function: NetDatagram::Move Constructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+NetDatagram::
+NetDatagram(NetDatagram &&from) NOEXCEPT :
+  Datagram(move(from)),
+  _connection(move(from._connection)),
+  _address(from._address)
+{
+}
+#endif  // USE_MOVE_SEMANTICS
+
+#ifdef USE_MOVE_SEMANTICS
+////////////////////////////////////////////////////////////////////
+//     Function: NetDatagram::Move Assignment Operator
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+void NetDatagram::
+operator = (NetDatagram &&from) NOEXCEPT {
+  Datagram::operator = (move(from));
+  _connection = move(from._connection);
+  _address = from._address;
+}
+#endif  // USE_MOVE_SEMANTICS
+
 ////////////////////////////////////////////////////////////////////
 //     Function: NetDatagram::clear
 //       Access: Public, Virtual
@@ -49,6 +49,11 @@ PUBLISHED:
   void operator = (const Datagram &copy);
   void operator = (const NetDatagram &copy);
 
+#ifdef USE_MOVE_SEMANTICS
+  NetDatagram(NetDatagram &&from) NOEXCEPT;
+  void operator = (NetDatagram &&from) NOEXCEPT;
+#endif
+
   virtual void clear();
 
   void set_connection(const PT(Connection) &connection);
@@ -96,7 +96,11 @@ get_data(Datagram &result) {
   if (!get_thing(nd)) {
     return false;
   }
+#ifdef USE_MOVE_SEMANTICS
+  result = move(nd);
+#else
   result = nd;
+#endif
   return true;
 }
 
@@ -0,0 +1,192 @@
+// Filename: test_epoll_reader.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pandabase.h"
+
+#include "queuedConnectionManager.h"
+#include "queuedConnectionListener.h"
+#include "queuedConnectionReader.h"
+#include "connectionWriter.h"
+#include "netAddress.h"
+#include "connection.h"
+#include "netDatagram.h"
+#include "datagramIterator.h"
+#include "config_net.h"
+#include "trueClock.h"
+#include "thread.h"
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+// This program opens a number of TCP clients to a server on the
+// loopback interface, all within this process, and measures how
+// quickly a threaded QueuedConnectionReader receives a datagram sent
+// by every client, over several rounds.  It reports the throughput,
+// and the average and worst latency from send to get_data().
+//
+// It runs once with net-use-epoll, and once with select(), unless
+// there are too many sockets for select() to handle.
+//
+// The process needs two descriptors per client; you may need to raise
+// the limit (ulimit -n) to run it with the default of 10000 clients.
+// If the limit is lower, fewer clients are opened.
+
+static const int num_rounds = 10;
+static const double round_timeout = 10.0;
+
+// Descriptors to leave free for the epoll instances, the listener,
+// and whatever else the process has open.
+static const int spare_descriptors = 64;
+
+typedef pvector< PT(Connection) > Connections;
+
+// Accepts any connections waiting on the listener.
+static void
+accept_clients(QueuedConnectionListener &listener, Connections &servers) {
+  while (listener.new_connection_available()) {
+    PT(Connection) rendezvous;
+    NetAddress address;
+    PT(Connection) new_connection;
+    if (listener.get_new_connection(rendezvous, address, new_connection)) {
+      servers.push_back(new_connection);
+    }
+  }
+}
+
+// Sends a datagram from every client to the server, num_rounds times,
+// and reads them all back.  Returns false if any datagrams went
+// missing.
+static bool
+run_benchmark(QueuedConnectionManager &cm, const Connections &clients,
+              const Connections &servers, bool use_epoll, int num_threads) {
+  net_use_epoll.set_value(use_epoll);
+  QueuedConnectionReader reader(&cm, num_threads);
+  Connections::const_iterator ci;
+  for (ci = servers.begin(); ci != servers.end(); ++ci) {
+    reader.add_connection(*ci);
+  }
+  ConnectionWriter writer(&cm, 0);
+
+  TrueClock *true_clock = TrueClock::get_global_ptr();
+  double start = true_clock->get_short_time();
+  int num_received = 0;
+  double total_latency = 0.0;
+  double max_latency = 0.0;
+
+  for (int round = 0; round < num_rounds; ++round) {
+    for (ci = clients.begin(); ci != clients.end(); ++ci) {
+      NetDatagram datagram;
+      datagram.add_float64(true_clock->get_short_time());
+      writer.send(datagram, *ci);
+    }
+
+    int expected = (int)clients.size() * (round + 1);
+    double stop = true_clock->get_short_time() + round_timeout;
+    while (num_received < expected && true_clock->get_short_time() < stop) {
+      if (!reader.data_available()) {
+        Thread::force_yield();
+        continue;
+      }
+      NetDatagram datagram;
+      if (reader.get_data(datagram)) {
+        DatagramIterator scan(datagram);
+        double latency = true_clock->get_short_time() - scan.get_float64();
+        total_latency += latency;
+        max_latency = max(max_latency, latency);
+        ++num_received;
+      }
+    }
+  }
+
+  double elapsed = true_clock->get_short_time() - start;
+  int num_sent = (int)clients.size() * num_rounds;
+
+  nout << (reader.get_use_epoll() ? "  epoll:  " : "  select: ")
+       << num_received << " of " << num_sent << " datagrams in "
+       << elapsed * 1000.0 << " ms, "
+       << (int)(num_received / elapsed) << " per second, latency "
+       << (num_received != 0 ? total_latency * 1000.0 / num_received : 0.0)
+       << " ms average, " << max_latency * 1000.0 << " ms worst\n";
+
+  return (num_received == num_sent);
+}
+
+int
+main(int argc, char *argv[]) {
+  int num_clients = (argc > 1) ? atoi(argv[1]) : 10000;
+  int num_threads = (argc > 2) ? atoi(argv[2]) : 4;
+  int port = (argc > 3) ? atoi(argv[3]) : 9099;
+
+#ifndef _WIN32
+  struct rlimit limit;
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY) {
+    int max_clients = ((int)limit.rlim_cur - spare_descriptors) / 2;
+    if (num_clients > max_clients) {
+      nout << "Limited to " << max_clients << " clients by ulimit -n.\n";
+      num_clients = max_clients;
+    }
+  }
+#endif
+
+  QueuedConnectionManager cm;
+  PT(Connection) rendezvous = cm.open_TCP_server_rendezvous(port, 1024);
+  if (rendezvous.is_null()) {
+    nout << "Cannot grab port " << port << ".\n";
+    return 1;
+  }
+
+  QueuedConnectionListener listener(&cm, 0);
+  listener.add_connection(rendezvous);
+
+  NetAddress host;
+  host.set_host("127.0.0.1", port);
+
+  Connections clients, servers;
+  for (int i = 0; i < num_clients; ++i) {
+    PT(Connection) client = cm.open_TCP_client_connection(host, 5000);
+    if (client.is_null()) {
+      nout << "Could only open " << i << " clients; try raising ulimit -n.\n";
+      break;
+    }
+    clients.push_back(client);
+    accept_clients(listener, servers);
+  }
+
+  TrueClock *true_clock = TrueClock::get_global_ptr();
+  double stop = true_clock->get_short_time() + round_timeout;
+  while (servers.size() < clients.size() && true_clock->get_short_time() < stop) {
+    accept_clients(listener, servers);
+    Thread::force_yield();
+  }
+  if (clients.empty() || servers.size() != clients.size()) {
+    nout << "Accepted " << servers.size() << " of " << clients.size()
+         << " clients.\n";
+    return 1;
+  }
+
+  nout << clients.size() << " clients, " << num_threads
+       << " reader threads, " << num_rounds << " rounds:\n";
+
+  bool ok = run_benchmark(cm, clients, servers, true, num_threads);
+
+  // select() can't watch descriptors numbered FD_SETSIZE or above.
+  if ((int)clients.size() * 2 + 16 < FD_SETSIZE) {
+    ok = run_benchmark(cm, clients, servers, false, num_threads) && ok;
+  } else {
+    nout << "  select: skipped, too many sockets\n";
+  }
+
+  return ok ? 0 : 1;
+}
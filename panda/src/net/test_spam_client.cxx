@@ -18,6 +18,7 @@
 #include "netAddress.h"
 #include "connection.h"
 #include "netDatagram.h"
+#include "datagramBufferPool.h"
 #include "clockObject.h"
 #include "datagram_ui.h"
 #include "thread.h"
@@ -100,6 +101,11 @@ main(int argc, char *argv[]) {
     if ((now - last_reported_time) > report_interval) {
       nout << "Sent " << num_sent << ", received "
            << num_received << " datagrams.\n";
+
+      // Report how many datagram buffers had to be allocated, versus
+      // reused from the pool, since the last report.
+      DatagramBufferPool::write(nout);
+      DatagramBufferPool::reset_stats();
       last_reported_time = now;
     }
 
@@ -0,0 +1,216 @@
+// Filename: test_tcp_writev.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pandabase.h"
+
+#include "queuedConnectionManager.h"
+#include "queuedConnectionListener.h"
+#include "queuedConnectionReader.h"
+#include "connectionWriter.h"
+#include "netAddress.h"
+#include "connection.h"
+#include "netDatagram.h"
+#include "datagramIterator.h"
+#include "trueClock.h"
+#include "thread.h"
+
+// This program sends many small datagrams over a TCP connection on
+// the loopback interface, as an AI server sends field updates, in
+// ticks of a fixed number of datagrams.  It sends them once with a
+// separate ConnectionWriter::send() per datagram, and once with a
+// single send_list() per tick, and reports the time spent sending
+// each way.  It then sends one datagram in several pieces with
+// send_gathered().  Finally, it sends more than the socket buffers
+// can hold over a non-blocking socket, while the receiving end is not
+// reading, and then calls flush().  It checks that every datagram
+// arrives intact and in order.
+
+static const int num_ticks = 100;
+static const double receive_timeout = 10.0;
+
+// Makes the indicated datagram of a tick, which looks something like
+// a field update.
+static Datagram
+make_update(int tick, int i) {
+  Datagram dg;
+  dg.add_uint16(24);
+  dg.add_uint32(100000 + i);
+  dg.add_uint16(tick);
+  dg.add_int16(i);
+  dg.add_float32(i * 0.5f);
+  return dg;
+}
+
+// Reads the datagrams of a tick back from the reader, and returns the
+// number that arrived intact and in order.
+static int
+receive_tick(QueuedConnectionReader &reader, int tick, int per_tick) {
+  TrueClock *true_clock = TrueClock::get_global_ptr();
+  double stop = true_clock->get_short_time() + receive_timeout;
+  int num_ok = 0;
+  int num_received = 0;
+  while (num_received < per_tick && true_clock->get_short_time() < stop) {
+    if (!reader.data_available()) {
+      Thread::force_yield();
+      continue;
+    }
+    NetDatagram datagram;
+    if (reader.get_data(datagram)) {
+      if (make_update(tick, num_received) == datagram) {
+        ++num_ok;
+      }
+      ++num_received;
+    }
+  }
+  return num_ok;
+}
+
+// Sends num_ticks ticks of datagrams, either one at a time or a tick
+// at a time, and reports the time spent sending.  Returns false if
+// any datagram went missing.
+static bool
+run_benchmark(ConnectionWriter &writer, QueuedConnectionReader &reader,
+              Connection *client, int per_tick, bool use_list) {
+  TrueClock *true_clock = TrueClock::get_global_ptr();
+  double send_time = 0.0;
+  int num_ok = 0;
+
+  for (int tick = 0; tick < num_ticks; ++tick) {
+    pvector<Datagram> updates;
+    updates.reserve(per_tick);
+    for (int i = 0; i < per_tick; ++i) {
+      updates.push_back(make_update(tick, i));
+    }
+
+    double start = true_clock->get_short_time();
+    if (use_list) {
+      writer.send_list(updates, client);
+    } else {
+      for (int i = 0; i < per_tick; ++i) {
+        writer.send(updates[i], client);
+      }
+    }
+    send_time += true_clock->get_short_time() - start;
+
+    num_ok += receive_tick(reader, tick, per_tick);
+  }
+
+  int num_sent = num_ticks * per_tick;
+  nout << (use_list ? "  send_list: " : "  send:      ")
+       << num_ok << " of " << num_sent << " datagrams, "
+       << send_time * 1000.0 << " ms sending, "
+       << send_time * 1000000000.0 / num_sent << " ns per datagram\n";
+
+  return (num_ok == num_sent);
+}
+
+int
+main(int argc, char *argv[]) {
+  int per_tick = (argc > 1) ? atoi(argv[1]) : 1000;
+  int port = (argc > 2) ? atoi(argv[2]) : 9099;
+
+  QueuedConnectionManager cm;
+  PT(Connection) rendezvous = cm.open_TCP_server_rendezvous(port, 5);
+  if (rendezvous.is_null()) {
+    nout << "Cannot grab port " << port << ".\n";
+    return 1;
+  }
+
+  QueuedConnectionListener listener(&cm, 0);
+  listener.add_connection(rendezvous);
+
+  NetAddress host;
+  host.set_host("127.0.0.1", port);
+  PT(Connection) client = cm.open_TCP_client_connection(host, 5000);
+  if (client.is_null()) {
+    nout << "Cannot connect to port " << port << ".\n";
+    return 1;
+  }
+
+  PT(Connection) server;
+  TrueClock *true_clock = TrueClock::get_global_ptr();
+  double stop = true_clock->get_short_time() + receive_timeout;
+  while (server.is_null() && true_clock->get_short_time() < stop) {
+    if (listener.new_connection_available()) {
+      PT(Connection) rv;
+      NetAddress address;
+      listener.get_new_connection(rv, address, server);
+    } else {
+      Thread::force_yield();
+    }
+  }
+  if (server.is_null()) {
+    nout << "The connection was not accepted.\n";
+    return 1;
+  }
+
+  QueuedConnectionReader reader(&cm, 1);
+  reader.add_connection(server);
+  ConnectionWriter writer(&cm, 0);
+
+  nout << num_ticks << " ticks of " << per_tick << " datagrams:\n";
+  bool ok = run_benchmark(writer, reader, client, per_tick, false);
+  ok = run_benchmark(writer, reader, client, per_tick, true) && ok;
+
+  // A datagram sent in pieces should arrive as the pieces put
+  // together.
+  pvector<Datagram> pieces;
+  Datagram whole;
+  for (int i = 0; i < 10; ++i) {
+    Datagram piece = make_update(num_ticks, i);
+    whole.append_data(piece.get_data(), piece.get_length());
+    pieces.push_back(piece);
+  }
+  writer.send_gathered(pieces, client);
+
+  NetDatagram received;
+  stop = true_clock->get_short_time() + receive_timeout;
+  while (!reader.data_available() && true_clock->get_short_time() < stop) {
+    Thread::force_yield();
+  }
+  if (!reader.get_data(received) || whole != received) {
+    nout << "  The gathered datagram did not arrive intact!\n";
+    ok = false;
+  }
+
+  // Whatever a non-blocking socket cannot take at once must stay
+  // queued, not reset the connection, and must all go out on
+  // flush().
+  reader.remove_connection(server);
+  server->set_recv_buffer_size(4096);
+  client->set_send_buffer_size(4096);
+  client->get_socket()->SetNonBlocking();
+
+  pvector<Datagram> updates;
+  for (int i = 0; i < per_tick; ++i) {
+    updates.push_back(make_update(num_ticks + 1, i));
+  }
+  bool sent = writer.send_list(updates, client);
+  for (int i = 0; i < per_tick; ++i) {
+    sent = writer.send(make_update(num_ticks + 2, i), client) && sent;
+  }
+  reader.add_connection(server);
+  sent = client->flush() && sent;
+
+  int num_ok = receive_tick(reader, num_ticks + 1, per_tick);
+  num_ok += receive_tick(reader, num_ticks + 2, per_tick);
+  nout << "  non-blocking: " << num_ok << " of " << per_tick * 2
+       << " datagrams\n";
+  if (!sent || num_ok != per_tick * 2) {
+    nout << "  The datagrams sent without blocking did not all arrive!\n";
+    ok = false;
+  }
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,138 @@
+// Filename: test_udp_batch.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pandabase.h"
+
+#include "queuedConnectionManager.h"
+#include "queuedConnectionReader.h"
+#include "connectionWriter.h"
+#include "netAddress.h"
+#include "connection.h"
+#include "netDatagram.h"
+#include "datagramIterator.h"
+#include "config_net.h"
+#include "trueClock.h"
+#include "thread.h"
+
+// This program sends a stream of small UDP datagrams to itself over
+// the loopback interface, through a threaded ConnectionWriter and a
+// threaded QueuedConnectionReader, and reports how many packets per
+// second get through.  It runs once with a UDP batch size of 1, so
+// that each datagram is read and written with its own system call,
+// and once with the batch size given on the command line (the default
+// is 32), so that they are read with recvmmsg() and written with
+// sendmmsg().  It also checks that the datagrams arrive intact.
+//
+// UDP may drop datagrams if the receiver falls behind; the number
+// lost is reported, but only corrupted datagrams are treated as a
+// failure.
+
+static const double idle_timeout = 1.0;
+
+// Sends num_datagrams datagrams from the client to the server, with
+// the indicated batch size on both ends.  Returns false if any
+// datagram arrived damaged, or none arrived at all.
+static bool
+run_benchmark(QueuedConnectionManager &cm, Connection *client,
+              Connection *server, const NetAddress &server_address,
+              int num_datagrams, int batch_size) {
+  QueuedConnectionReader reader(&cm, 1);
+  reader.set_udp_batch_size(batch_size);
+  reader.add_connection(server);
+
+  ConnectionWriter writer(&cm, 1);
+  writer.set_udp_batch_size(batch_size);
+  writer.set_max_queue_size(num_datagrams);
+
+  TrueClock *true_clock = TrueClock::get_global_ptr();
+  double start = true_clock->get_short_time();
+
+  for (int i = 0; i < num_datagrams; ++i) {
+    NetDatagram datagram;
+    datagram.add_uint32(i);
+    datagram.add_uint32(~i);
+    writer.send(datagram, client, server_address, true);
+  }
+
+  int num_received = 0;
+  int num_damaged = 0;
+  int last_index = -1;
+  double last_received = true_clock->get_short_time();
+  while (num_received < num_datagrams &&
+         true_clock->get_short_time() - last_received < idle_timeout) {
+    if (!reader.data_available()) {
+      Thread::force_yield();
+      continue;
+    }
+    NetDatagram datagram;
+    if (reader.get_data(datagram)) {
+      last_received = true_clock->get_short_time();
+      DatagramIterator scan(datagram);
+      int index = (int)scan.get_uint32();
+      int check = (int)scan.get_uint32();
+      if (datagram.get_length() != 8 || check != ~index || index <= last_index) {
+        ++num_damaged;
+      }
+      last_index = index;
+      ++num_received;
+    }
+  }
+
+  double elapsed = last_received - start;
+  writer.shutdown();
+  reader.shutdown();
+
+  nout << "  batch size " << batch_size << ": "
+       << num_received << " of " << num_datagrams << " datagrams in "
+       << elapsed * 1000.0 << " ms, "
+       << (int)(num_received / elapsed) << " per second";
+  if (num_damaged != 0) {
+    nout << ", " << num_damaged << " damaged";
+  }
+  nout << "\n";
+
+  return (num_received != 0 && num_damaged == 0);
+}
+
+int
+main(int argc, char *argv[]) {
+  int num_datagrams = (argc > 1) ? atoi(argv[1]) : 200000;
+  int batch_size = (argc > 2) ? atoi(argv[2]) : 32;
+  int port = (argc > 3) ? atoi(argv[3]) : 9099;
+
+  QueuedConnectionManager cm;
+  PT(Connection) server = cm.open_UDP_connection(port);
+  if (server.is_null()) {
+    nout << "Cannot grab UDP port " << port << ".\n";
+    return 1;
+  }
+  server->set_recv_buffer_size(4 * 1024 * 1024);
+
+  PT(Connection) client = cm.open_UDP_connection();
+  if (client.is_null()) {
+    nout << "Cannot open UDP client.\n";
+    return 1;
+  }
+
+  NetAddress server_address;
+  server_address.set_host("127.0.0.1", port);
+
+  nout << num_datagrams << " datagrams over loopback:\n";
+  bool ok = run_benchmark(cm, client, server, server_address,
+                          num_datagrams, 1);
+  ok = run_benchmark(cm, client, server, server_address,
+                     num_datagrams, batch_size) && ok;
+
+  return ok ? 0 : 1;
+}
@@ -46,6 +46,7 @@
     depthOffsetAttrib.I depthOffsetAttrib.h \
     depthTestAttrib.I depthTestAttrib.h \
     depthWriteAttrib.I depthWriteAttrib.h \
+    filePrefetchRequest.I filePrefetchRequest.h \
     findApproxLevelEntry.I findApproxLevelEntry.h \
     findApproxPath.I findApproxPath.h \
     fog.I fog.h \
@@ -155,6 +156,7 @@
     depthOffsetAttrib.cxx \
     depthTestAttrib.cxx \
     depthWriteAttrib.cxx \
+    filePrefetchRequest.cxx \
     findApproxLevelEntry.cxx \
     findApproxPath.cxx \
     fog.cxx \
@@ -258,6 +260,7 @@
     depthOffsetAttrib.I depthOffsetAttrib.h \
     depthTestAttrib.I depthTestAttrib.h \
     depthWriteAttrib.I depthWriteAttrib.h \
+    filePrefetchRequest.I filePrefetchRequest.h \
     fog.I fog.h \
     fogAttrib.I fogAttrib.h \
     geomDrawCallbackData.I geomDrawCallbackData.h \
@@ -349,3 +352,47 @@
   #define OTHER_LIBS $[OTHER_LIBS] p3pystub
 
 #end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_compose_threads
+
+  #define SOURCES \
+    test_compose_threads.cxx
+
+  #define LOCAL_LIBS $[LOCAL_LIBS] p3pgraph
+  #define OTHER_LIBS $[OTHER_LIBS] p3pystub
+
+#end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_file_prefetch
+
+  #define SOURCES \
+    test_file_prefetch.cxx
+
+  #define LOCAL_LIBS $[LOCAL_LIBS] p3pgraph
+  #define OTHER_LIBS $[OTHER_LIBS] p3pystub
+
+#end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_bam_streaming
+
+  #define SOURCES \
+    test_bam_streaming.cxx
+
+  #define LOCAL_LIBS $[LOCAL_LIBS] p3pgraph
+  #define OTHER_LIBS $[OTHER_LIBS] p3pystub
+
+#end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_bam_cache
+
+  #define SOURCES \
+    test_bam_cache.cxx
+
+  #define LOCAL_LIBS $[LOCAL_LIBS] p3pgraph
+  #define OTHER_LIBS $[OTHER_LIBS] p3pystub
+
+#end test_bin_target
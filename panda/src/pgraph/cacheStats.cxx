@@ -23,9 +23,10 @@
 ////////////////////////////////////////////////////////////////////
 void CacheStats::
 init() {
+  _total_cache_size = 0;
+
 #ifndef NDEBUG
   reset(ClockObject::get_global_clock()->get_real_time());
-  _total_cache_size = 0;
   _num_states = 0;
 
   _cache_report = ConfigVariableBool("cache-report", false);
@@ -42,11 +43,12 @@ init() {
 void CacheStats::
 reset(double now) {
 #ifndef NDEBUG
-  _cache_hits = 0;
+  AtomicAdjust::set(_cache_hits, 0);
   _cache_misses = 0;
   _cache_adds = 0;
   _cache_new_adds = 0;
   _cache_dels = 0;
+  _cache_evictions = 0;
   _last_reset = now;
 #endif  // NDEBUG
 }
@@ -59,10 +61,10 @@ reset(double now) {
 void CacheStats::
 write(ostream &out, const char *name) const {
 #ifndef NDEBUG
-  out << name << " cache: " << _cache_hits << " hits, " 
+  out << name << " cache: " << AtomicAdjust::get(_cache_hits) << " hits, " 
       << _cache_misses << " misses\n"
       << _cache_adds + _cache_new_adds << "(" << _cache_new_adds << ") adds(new), "
-      << _cache_dels << " dels, "
+      << _cache_dels << " dels (" << _cache_evictions << " evicted), "
       << _total_cache_size << " / " << _num_states << " = "
       << (double)_total_cache_size / (double)_num_states 
       << " average cache size\n";
@@ -18,6 +18,7 @@
 #include "pandabase.h"
 #include "clockObject.h"
 #include "pnotify.h"
+#include "atomicAdjust.h"
 
 ////////////////////////////////////////////////////////////////////
 //       Class : CacheStats
@@ -36,17 +37,26 @@ public:
   INLINE void inc_misses();
   INLINE void inc_adds(bool is_new);
   INLINE void inc_dels();
+  INLINE void inc_evictions();
   INLINE void add_total_size(int count);
   INLINE void add_num_states(int count);
 
+  INLINE int get_total_size() const;
+
 private:
+  // This one is maintained even in a production build, since it is
+  // needed to enforce transform-cache-budget.
+  int _total_cache_size;
+
 #ifndef NDEBUG
-  int _cache_hits;
+  // Hits are counted while holding only a shard lock, so this one is
+  // adjusted atomically.
+  AtomicAdjust::Integer _cache_hits;
   int _cache_misses;
   int _cache_adds;
   int _cache_new_adds;
   int _cache_dels;
-  int _total_cache_size;
+  int _cache_evictions;
   int _num_states;
   double _last_reset;
 
@@ -38,6 +38,7 @@
 #include "depthTestAttrib.h"
 #include "depthWriteAttrib.h"
 #include "findApproxLevelEntry.h"
+#include "filePrefetchRequest.h"
 #include "fog.h"
 #include "fogAttrib.h"
 #include "geomDrawCallbackData.h"
@@ -208,6 +209,23 @@ ConfigVariableBool transform_cache
           "transforms, but imposes some overhead for maintaining the "
           "cache itself."));
 
+ConfigVariableInt transform_cache_max_entries
+("transform-cache-max-entries", 0,
+ PRC_DESC("The maximum number of entries that will be kept in each "
+          "TransformState's composition cache, and separately in its "
+          "invert composition cache.  When a cache grows beyond this, "
+          "its least-recently-used entries (approximately) are evicted.  "
+          "Set this to 0 to allow the caches to grow without limit."));
+
+ConfigVariableInt transform_cache_budget
+("transform-cache-budget", 0,
+ PRC_DESC("The maximum total number of composition cache entries that "
+          "will be kept among all TransformStates.  When this is "
+          "exceeded, approximately least-recently-used entries are "
+          "evicted from the caches of the various TransformStates in "
+          "turn.  Set cache-report true to see the resulting hit rate "
+          "and eviction count.  Set this to 0 for no global limit."));
+
 ConfigVariableBool state_cache
 ("state-cache", true,
  PRC_DESC("Set this true to enable the cache of RenderState objects, "
@@ -410,6 +428,7 @@ init_libpgraph() {
   DepthTestAttrib::init_type();
   DepthWriteAttrib::init_type();
   FindApproxLevelEntry::init_type();
+  FilePrefetchRequest::init_type();
   Fog::init_type();
   FogAttrib::init_type();
   GeomDrawCallbackData::init_type();
@@ -46,6 +46,8 @@ extern ConfigVariableBool auto_break_cycles;
 extern EXPCL_PANDA_PGRAPH ConfigVariableBool garbage_collect_states;
 extern ConfigVariableDouble garbage_collect_states_rate;
 extern ConfigVariableBool transform_cache;
+extern ConfigVariableInt transform_cache_max_entries;
+extern ConfigVariableInt transform_cache_budget;
 extern ConfigVariableBool state_cache;
 extern ConfigVariableBool uniquify_transforms;
 extern ConfigVariableBool uniquify_states;
@@ -0,0 +1,61 @@
+// Filename: filePrefetchRequest.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "filePrefetchRequest.h"
+#include "virtualFileSystem.h"
+#include "config_util.h"
+
+TypeHandle FilePrefetchRequest::_type_handle;
+
+////////////////////////////////////////////////////////////////////
+//     Function: FilePrefetchRequest::Constructor
+//       Access: Published
+//  Description: Create a new FilePrefetchRequest, and add it to the
+//               task manager on the Loader's prefetch task chain to
+//               begin an asynchronous read.  Normally you would just
+//               call Loader::prefetch_file() instead.
+////////////////////////////////////////////////////////////////////
+FilePrefetchRequest::
+FilePrefetchRequest(const string &name, const Filename &filename,
+                    bool auto_unwrap) :
+  AsyncTask(name),
+  _filename(filename),
+  _auto_unwrap(auto_unwrap),
+  _is_ready(false),
+  _success(false)
+{
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: FilePrefetchRequest::do_task
+//       Access: Protected, Virtual
+//  Description: Performs the task: that is, reads the one file.
+////////////////////////////////////////////////////////////////////
+AsyncTask::DoneStatus FilePrefetchRequest::
+do_task() {
+  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+
+  // A relative filename is looked up along the model path, the same
+  // way the Loader would look for it.
+  Filename filename = _filename;
+  if (filename.is_local()) {
+    vfs->resolve_filename(filename, get_model_path());
+  }
+
+  _success = vfs->prefetch_file(filename, _auto_unwrap);
+  _is_ready = true;
+
+  // Don't continue the task; we're done.
+  return DS_done;
+}
@@ -0,0 +1,76 @@
+// Filename: filePrefetchRequest.h
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef FILEPREFETCHREQUEST_H
+#define FILEPREFETCHREQUEST_H
+
+#include "pandabase.h"
+
+#include "asyncTask.h"
+#include "filename.h"
+
+////////////////////////////////////////////////////////////////////
+//       Class : FilePrefetchRequest
+// Description : A class object that manages a single asynchronous
+//               file prefetch request.  The file is read and
+//               decompressed by one of the Loader's prefetch threads
+//               into the VirtualFileSystem's prefetch cache, so that
+//               a subsequent read of the same file on the main thread
+//               can return immediately.  See Loader::prefetch_file().
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDA_PGRAPH FilePrefetchRequest : public AsyncTask {
+public:
+  ALLOC_DELETED_CHAIN(FilePrefetchRequest);
+
+PUBLISHED:
+  FilePrefetchRequest(const string &name,
+                      const Filename &filename,
+                      bool auto_unwrap);
+
+  INLINE const Filename &get_filename() const;
+  INLINE bool get_auto_unwrap() const;
+
+  INLINE bool is_ready() const;
+  INLINE bool get_success() const;
+
+protected:
+  virtual DoneStatus do_task();
+
+private:
+  Filename _filename;
+  bool _auto_unwrap;
+  bool _is_ready;
+  bool _success;
+
+public:
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    AsyncTask::init_type();
+    register_type(_type_handle, "FilePrefetchRequest",
+                  AsyncTask::get_class_type());
+    }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "filePrefetchRequest.I"
+
+#endif
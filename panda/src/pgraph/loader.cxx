@@ -19,6 +19,7 @@
 #include "modelPool.h"
 #include "modelLoadRequest.h"
 #include "modelSaveRequest.h"
+#include "filePrefetchRequest.h"
 #include "config_express.h"
 #include "config_util.h"
 #include "virtualFileSystem.h"
@@ -71,6 +72,28 @@ Loader(const string &name) :
                 "also specify 'normal', 'high', or 'urgent'."));
     chain->set_thread_priority(loader_thread_priority);
   }
+
+  _prefetch_chain = name + "_prefetch";
+
+  if (_task_manager->find_task_chain(_prefetch_chain) == NULL) {
+    PT(AsyncTaskChain) chain = _task_manager->make_task_chain(_prefetch_chain);
+
+    ConfigVariableInt loader_prefetch_threads
+      ("loader-prefetch-threads", 4,
+       PRC_DESC("The number of threads that will be started by the Loader class "
+                "to read and decompress files requested by prefetch_file().  "
+                "These threads will only be started if prefetch_file() is "
+                "used.  Since most of the time is spent decompressing, or "
+                "waiting on the disk, several files can usefully be read at "
+                "once."));
+    chain->set_num_threads(loader_prefetch_threads);
+
+    ConfigVariableEnum<ThreadPriority> loader_prefetch_thread_priority
+      ("loader-prefetch-thread-priority", TP_low,
+       PRC_DESC("The default thread priority to assign to the threads created "
+                "for prefetching files."));
+    chain->set_thread_priority(loader_prefetch_thread_priority);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -98,6 +121,70 @@ make_async_save_request(const Filename &filename, const LoaderOptions &options,
                               filename, options, node, this);
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: Loader::prefetch_file
+//       Access: Published
+//  Description: Begins reading the indicated file in the background,
+//               on one of the Loader's prefetch threads, into the
+//               VirtualFileSystem's prefetch cache.  A compressed
+//               file is decompressed at the same time.  This function
+//               returns immediately.
+//
+//               Once the file has been read, the next call to
+//               VirtualFileSystem::read_file() or open_read_file()
+//               for the same file, from any thread, is satisfied
+//               from memory.  This is intended to be called with the
+//               list of files that will be needed shortly, for
+//               instance for the next level, so that loading them
+//               does not have to wait on the disk.  The total size of
+//               the prefetched files is limited by
+//               vfs-prefetch-limit.
+//
+//               The returned task may be polled to see when the file
+//               has been read; or call wait_for_prefetch() to wait
+//               for all outstanding prefetches.
+////////////////////////////////////////////////////////////////////
+PT(AsyncTask) Loader::
+prefetch_file(const Filename &filename, bool auto_unwrap) {
+  PT(AsyncTask) request =
+    new FilePrefetchRequest(string("prefetch:")+filename.get_basename(),
+                            filename, auto_unwrap);
+  request->set_task_chain(_prefetch_chain);
+  _task_manager->add(request);
+  return request;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: Loader::prefetch_files
+//       Access: Public
+//  Description: Calls prefetch_file() for each of the indicated
+//               files, in order.  The files are read by several
+//               threads at once, but they are started in the order
+//               given, so the files that are needed first should be
+//               listed first.
+////////////////////////////////////////////////////////////////////
+void Loader::
+prefetch_files(const pvector<Filename> &filenames, bool auto_unwrap) {
+  pvector<Filename>::const_iterator fi;
+  for (fi = filenames.begin(); fi != filenames.end(); ++fi) {
+    prefetch_file(*fi, auto_unwrap);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: Loader::wait_for_prefetch
+//       Access: Published
+//  Description: Blocks until all of the files requested by
+//               prefetch_file() have been read.
+////////////////////////////////////////////////////////////////////
+void Loader::
+wait_for_prefetch() {
+  AsyncTaskChain *chain = _task_manager->find_task_chain(_prefetch_chain);
+  if (chain != (AsyncTaskChain *)NULL) {
+    chain->wait_for_tasks();
+  }
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: Loader::load_bam_stream
 //       Access: Published
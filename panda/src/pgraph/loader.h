@@ -99,12 +99,19 @@ PUBLISHED:
                                         PandaNode *node);
   INLINE void save_async(AsyncTask *request);
 
+  PT(AsyncTask) prefetch_file(const Filename &filename, bool auto_unwrap = true);
+  INLINE const string &get_prefetch_task_chain() const;
+  BLOCKING void wait_for_prefetch();
+
   BLOCKING PT(PandaNode) load_bam_stream(istream &in);
 
   virtual void output(ostream &out) const;
 
   INLINE static Loader *get_global_ptr();
 
+public:
+  void prefetch_files(const pvector<Filename> &filenames, bool auto_unwrap = true);
+
 private:
   PT(PandaNode) load_file(const Filename &filename, const LoaderOptions &options) const;
   PT(PandaNode) try_load_file(const Filename &pathname, const LoaderOptions &options,
@@ -119,6 +126,7 @@ private:
 
   PT(AsyncTaskManager) _task_manager;
   string _task_chain;
+  string _prefetch_chain;
 
   static void load_file_types();
   static bool _file_types_loaded;
@@ -39,10 +39,10 @@
 #include "py_panda.h"
 
 LightReMutex *RenderState::_states_lock = NULL;
-RenderState::States *RenderState::_states = NULL;
+RenderState::StateShard *RenderState::_shards = NULL;
+int RenderState::_num_shards = 0;
 const RenderState *RenderState::_empty_state = NULL;
 UpdateSeq RenderState::_last_cycle_detect;
-int RenderState::_garbage_index = 0;
 
 PStatCollector RenderState::_cache_update_pcollector("*:State Cache:Update");
 PStatCollector RenderState::_garbage_collect_pcollector("*:State Cache:Garbage Collect");
@@ -71,7 +71,7 @@ RenderState() :
   _auto_shader_state(NULL),
   _lock("RenderState")
 {
-  if (_states == (States *)NULL) {
+  if (_shards == (StateShard *)NULL) {
     init_states();
   }
   _saved_entry = -1;
@@ -405,66 +405,34 @@ compose(const RenderState *other) const {
     return do_compose(other);
   }
 
-  LightReMutexHolder holder(*_states_lock);
-
   // Is this composition already cached?
-  int index = _composition_cache.find(other);
-  if (index != -1) {
-    Composition &comp = ((RenderState *)this)->_composition_cache.modify_data(index);
-    if (comp._result == (const RenderState *)NULL) {
-      // Well, it wasn't cached already, but we already had an entry
-      // (probably created for the reverse direction), so use the same
-      // entry to store the new result.
-      CPT(RenderState) result = do_compose(other);
-      comp._result = result;
-
-      if (result != (const RenderState *)this) {
-        // See the comments below about the need to up the reference
-        // count only when the result is not the same as this.
-        result->cache_ref();
-      }
+  CPT(RenderState) result;
+  {
+    // Our shard's lock is enough to read our cache; see _states_lock.
+    LightReMutexHolder holder(get_shard(this)._lock);
+    int index = _composition_cache.find(other);
+    if (index != -1) {
+      const Composition &comp = _composition_cache.get_data(index);
+      result = comp._result;
+    }
+    if (result != (RenderState *)NULL) {
+      _cache_stats.inc_hits();
     }
-    // Here's the cache!
-    _cache_stats.inc_hits();
-    return comp._result;
-  }
-  _cache_stats.inc_misses();
-
-  // We need to make a new cache entry, both in this object and in the
-  // other object.  We make both records so the other RenderState
-  // object will know to delete the entry from this object when it
-  // destructs, and vice-versa.
-
-  // The cache entry in this object is the only one that indicates the
-  // result; the other will be NULL for now.
-  CPT(RenderState) result = do_compose(other);
-
-  _cache_stats.add_total_size(1);
-  _cache_stats.inc_adds(_composition_cache.get_size() == 0);
-
-  ((RenderState *)this)->_composition_cache[other]._result = result;
-
-  if (other != this) {
-    _cache_stats.add_total_size(1);
-    _cache_stats.inc_adds(other->_composition_cache.get_size() == 0);
-    ((RenderState *)other)->_composition_cache[this]._result = NULL;
   }
 
-  if (result != (const RenderState *)this) {
-    // If the result of compose() is something other than this,
-    // explicitly increment the reference count.  We have to be sure
-    // to decrement it again later, when the composition entry is
-    // removed from the cache.
-    result->cache_ref();
-
-    // (If the result was just this again, we still store the
-    // result, but we don't increment the reference count, since
-    // that would be a self-referential leak.)
+  if (result != (RenderState *)NULL) {
+    // Success!
+    return result;
   }
 
-  _cache_stats.maybe_report("RenderState");
+  // Not in the cache.  Compute a new result.  It's important that we
+  // don't hold the lock while we do this, or we lose the benefit of
+  // parallelization.
+  result = do_compose(other);
 
-  return result;
+  // It's OK to cast away the constness of this pointer, because the
+  // cache is a transparent property of the class.
+  return ((RenderState *)this)->store_compose(other, result);
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -500,63 +468,34 @@ invert_compose(const RenderState *other) const {
     return do_invert_compose(other);
   }
 
-  LightReMutexHolder holder(*_states_lock);
-
   // Is this composition already cached?
-  int index = _invert_composition_cache.find(other);
-  if (index != -1) {
-    Composition &comp = ((RenderState *)this)->_invert_composition_cache.modify_data(index);
-    if (comp._result == (const RenderState *)NULL) {
-      // Well, it wasn't cached already, but we already had an entry
-      // (probably created for the reverse direction), so use the same
-      // entry to store the new result.
-      CPT(RenderState) result = do_invert_compose(other);
-      comp._result = result;
-
-      if (result != (const RenderState *)this) {
-        // See the comments below about the need to up the reference
-        // count only when the result is not the same as this.
-        result->cache_ref();
-      }
+  CPT(RenderState) result;
+  {
+    // Our shard's lock is enough to read our cache; see _states_lock.
+    LightReMutexHolder holder(get_shard(this)._lock);
+    int index = _invert_composition_cache.find(other);
+    if (index != -1) {
+      const Composition &comp = _invert_composition_cache.get_data(index);
+      result = comp._result;
+    }
+    if (result != (RenderState *)NULL) {
+      _cache_stats.inc_hits();
     }
-    // Here's the cache!
-    _cache_stats.inc_hits();
-    return comp._result;
   }
-  _cache_stats.inc_misses();
 
-  // We need to make a new cache entry, both in this object and in the
-  // other object.  We make both records so the other RenderState
-  // object will know to delete the entry from this object when it
-  // destructs, and vice-versa.
-
-  // The cache entry in this object is the only one that indicates the
-  // result; the other will be NULL for now.
-  CPT(RenderState) result = do_invert_compose(other);
-
-  _cache_stats.add_total_size(1);
-  _cache_stats.inc_adds(_invert_composition_cache.get_size() == 0);
-  ((RenderState *)this)->_invert_composition_cache[other]._result = result;
-
-  if (other != this) {
-    _cache_stats.add_total_size(1);
-    _cache_stats.inc_adds(other->_invert_composition_cache.get_size() == 0);
-    ((RenderState *)other)->_invert_composition_cache[this]._result = NULL;
+  if (result != (RenderState *)NULL) {
+    // Success!
+    return result;
   }
 
-  if (result != (const RenderState *)this) {
-    // If the result of compose() is something other than this,
-    // explicitly increment the reference count.  We have to be sure
-    // to decrement it again later, when the composition entry is
-    // removed from the cache.
-    result->cache_ref();
+  // Not in the cache.  Compute a new result.  It's important that we
+  // don't hold the lock while we do this, or we lose the benefit of
+  // parallelization.
+  result = do_invert_compose(other);
 
-    // (If the result was just this again, we still store the
-    // result, but we don't increment the reference count, since
-    // that would be a self-referential leak.)
-  }
-
-  return result;
+  // It's OK to cast away the constness of this pointer, because the
+  // cache is a transparent property of the class.
+  return ((RenderState *)this)->store_invert_compose(other, result);
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -694,13 +633,29 @@ unref() const {
   // without garbage collection in effect.  In this case we will pull
   // the object out of the cache when its reference count goes to 0.
 
-  // We always have to grab the lock, since we will definitely need to
-  // be holding it if we happen to drop the reference count to 0.
-  // Having to grab the lock at every call to unref() is a big
-  // limiting factor on parallelization.
+  // We need to be holding the lock if we happen to drop the reference
+  // count to 0, or to leave only the references held by the cache,
+  // since then we must check for a cycle.  Otherwise, we can drop the
+  // reference without the lock, as long as no other thread changes
+  // the count before we do.  We allow one reference of slack in the
+  // cache count, since the thread holding the lock may be partway
+  // through cache_ref() or cache_unref(), which adjust the two counts
+  // one after the other.
+  bool check_cycles = (auto_break_cycles && uniquify_states);
+  while (true) {
+    int ref_count = get_ref_count();
+    int min_count = check_cycles ? get_cache_ref_count() + 2 : 1;
+    if (ref_count <= min_count) {
+      break;
+    }
+    if (try_unref(ref_count)) {
+      return true;
+    }
+  }
+
   LightReMutexHolder holder(*_states_lock);
 
-  if (auto_break_cycles && uniquify_states) {
+  if (check_cycles) {
     if (get_cache_ref_count() > 0 &&
         get_ref_count() == get_cache_ref_count() + 1) {
       // If we are about to remove the one reference that is not in the
@@ -711,15 +666,32 @@ unref() const {
     }
   }
 
-  if (ReferenceCount::unref()) {
+  // If we are in the global object pool, return_unique() may find us
+  // and ref us at any moment while holding only our shard's lock, so
+  // we need to hold that lock too while we drop the reference count.
+  LightReMutex *shard_lock = NULL;
+  if (_saved_entry != -1) {
+    shard_lock = &get_shard(this)._lock;
+    shard_lock->acquire();
+  }
+
+  bool still_referenced = ReferenceCount::unref();
+  if (!still_referenced) {
+    // The reference count has just reached zero.  Make sure the
+    // object is removed from the global object pool, before anyone
+    // else finds it and tries to ref it.
+    ((RenderState *)this)->release_new();
+  }
+
+  if (shard_lock != (LightReMutex *)NULL) {
+    shard_lock->release();
+  }
+
+  if (still_referenced) {
     // The reference count is still nonzero.
     return true;
   }
 
-  // The reference count has just reached zero.  Make sure the object
-  // is removed from the global object pool, before anyone else finds
-  // it and tries to ref it.
-  ((RenderState *)this)->release_new();
   ((RenderState *)this)->remove_cache_pointers();
 
   return false;
@@ -826,11 +798,16 @@ get_max_priority() {
 ////////////////////////////////////////////////////////////////////
 int RenderState::
 get_num_states() {
-  if (_states == (States *)NULL) {
+  if (_shards == (StateShard *)NULL) {
     return 0;
   }
-  LightReMutexHolder holder(*_states_lock);
-  return _states->get_num_entries();
+  int num_states = 0;
+  for (int i = 0; i < _num_shards; ++i) {
+    StateShard &shard = _shards[i];
+    LightReMutexHolder shard_holder(shard._lock);
+    num_states += shard._states.get_num_entries();
+  }
+  return num_states;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -853,7 +830,7 @@ get_num_states() {
 ////////////////////////////////////////////////////////////////////
 int RenderState::
 get_num_unused_states() {
-  if (_states == (States *)NULL) {
+  if (_shards == (StateShard *)NULL) {
     return 0;
   }
   LightReMutexHolder holder(*_states_lock);
@@ -863,40 +840,45 @@ get_num_unused_states() {
   typedef pmap<const RenderState *, int> StateCount;
   StateCount state_count;
 
-  int size = _states->get_size();
-  for (int si = 0; si < size; ++si) {
-    if (!_states->has_element(si)) {
-      continue;
-    }
-    const RenderState *state = _states->get_key(si);
-
-    int i;
-    int cache_size = state->_composition_cache.get_size();
-    for (i = 0; i < cache_size; ++i) {
-      if (state->_composition_cache.has_element(i)) {
-        const RenderState *result = state->_composition_cache.get_data(i)._result;
-        if (result != (const RenderState *)NULL && result != state) {
-          // Here's a RenderState that's recorded in the cache.
-          // Count it.
-          pair<StateCount::iterator, bool> ir =
-            state_count.insert(StateCount::value_type(result, 1));
-          if (!ir.second) {
-            // If the above insert operation fails, then it's already in
-            // the cache; increment its value.
-            (*(ir.first)).second++;
+  for (int shi = 0; shi < _num_shards; ++shi) {
+    StateShard &shard = _shards[shi];
+    LightReMutexHolder shard_holder(shard._lock);
+
+    int size = shard._states.get_size();
+    for (int si = 0; si < size; ++si) {
+      if (!shard._states.has_element(si)) {
+        continue;
+      }
+      const RenderState *state = shard._states.get_key(si);
+
+      int i;
+      int cache_size = state->_composition_cache.get_size();
+      for (i = 0; i < cache_size; ++i) {
+        if (state->_composition_cache.has_element(i)) {
+          const RenderState *result = state->_composition_cache.get_data(i)._result;
+          if (result != (const RenderState *)NULL && result != state) {
+            // Here's a RenderState that's recorded in the cache.
+            // Count it.
+            pair<StateCount::iterator, bool> ir =
+              state_count.insert(StateCount::value_type(result, 1));
+            if (!ir.second) {
+              // If the above insert operation fails, then it's already in
+              // the cache; increment its value.
+              (*(ir.first)).second++;
+            }
           }
         }
       }
-    }
-    cache_size = state->_invert_composition_cache.get_size();
-    for (i = 0; i < cache_size; ++i) {
-      if (state->_invert_composition_cache.has_element(i)) {
-        const RenderState *result = state->_invert_composition_cache.get_data(i)._result;
-        if (result != (const RenderState *)NULL && result != state) {
-          pair<StateCount::iterator, bool> ir =
-            state_count.insert(StateCount::value_type(result, 1));
-          if (!ir.second) {
-            (*(ir.first)).second++;
+      cache_size = state->_invert_composition_cache.get_size();
+      for (i = 0; i < cache_size; ++i) {
+        if (state->_invert_composition_cache.has_element(i)) {
+          const RenderState *result = state->_invert_composition_cache.get_data(i)._result;
+          if (result != (const RenderState *)NULL && result != state) {
+            pair<StateCount::iterator, bool> ir =
+              state_count.insert(StateCount::value_type(result, 1));
+            if (!ir.second) {
+              (*(ir.first)).second++;
+            }
           }
         }
       }
@@ -951,13 +933,13 @@ get_num_unused_states() {
 ////////////////////////////////////////////////////////////////////
 int RenderState::
 clear_cache() {
-  if (_states == (States *)NULL) {
+  if (_shards == (StateShard *)NULL) {
     return 0;
   }
   LightReMutexHolder holder(*_states_lock);
 
   PStatTimer timer(_cache_update_pcollector);
-  int orig_size = _states->get_num_entries();
+  int orig_size = get_num_states();
 
   // First, we need to copy the entire set of states to a temporary
   // vector, reference-counting each object.  That way we can walk
@@ -968,13 +950,18 @@ clear_cache() {
     TempStates temp_states;
     temp_states.reserve(orig_size);
 
-    int size = _states->get_size();
-    for (int si = 0; si < size; ++si) {
-      if (!_states->has_element(si)) {
-        continue;
+    for (int shi = 0; shi < _num_shards; ++shi) {
+      StateShard &shard = _shards[shi];
+      LightReMutexHolder shard_holder(shard._lock);
+
+      int size = shard._states.get_size();
+      for (int si = 0; si < size; ++si) {
+        if (!shard._states.has_element(si)) {
+          continue;
+        }
+        const RenderState *state = shard._states.get_key(si);
+        temp_states.push_back(state);
       }
-      const RenderState *state = _states->get_key(si);
-      temp_states.push_back(state);
     }
 
     // Now it's safe to walk through the list, destroying the cache
@@ -983,6 +970,7 @@ clear_cache() {
     TempStates::iterator ti;
     for (ti = temp_states.begin(); ti != temp_states.end(); ++ti) {
       RenderState *state = (RenderState *)(*ti).p();
+      LightReMutexHolder state_holder(get_shard(state)._lock);
 
       int i;
       int cache_size = (int)state->_composition_cache.get_size();
@@ -1017,7 +1005,7 @@ clear_cache() {
     // held only within the various objects' caches will go away.
   }
 
-  int new_size = _states->get_num_entries();
+  int new_size = get_num_states();
   return orig_size - new_size;
 }
 
@@ -1038,61 +1026,22 @@ int RenderState::
 garbage_collect() {
   int num_attribs = RenderAttrib::garbage_collect();
 
-  if (_states == (States *)NULL || !garbage_collect_states) {
+  if (_shards == (StateShard *)NULL || !garbage_collect_states) {
     return num_attribs;
   }
   LightReMutexHolder holder(*_states_lock);
 
   PStatTimer timer(_garbage_collect_pcollector);
-  int orig_size = _states->get_num_entries();
 
-  // How many elements to process this pass?
-  int size = _states->get_size();
-  int num_this_pass = int(size * garbage_collect_states_rate);
-  if (num_this_pass <= 0) {
-    return num_attribs;
+  // Each shard is collected in turn, holding only that shard's lock,
+  // so that other threads may continue to create states in the other
+  // shards meanwhile.
+  int num_states = 0;
+  for (int i = 0; i < _num_shards; ++i) {
+    num_states += _shards[i].garbage_collect();
   }
-  num_this_pass = min(num_this_pass, size);
-  int stop_at_element = (_garbage_index + num_this_pass) % size;
-
-  int num_elements = 0;
-  int si = _garbage_index;
-  do {
-    if (_states->has_element(si)) {
-      ++num_elements;
-      RenderState *state = (RenderState *)_states->get_key(si);
-      if (auto_break_cycles && uniquify_states) {
-        if (state->get_cache_ref_count() > 0 &&
-            state->get_ref_count() == state->get_cache_ref_count()) {
-          // If we have removed all the references to this state not in
-          // the cache, leaving only references in the cache, then we
-          // need to check for a cycle involving this RenderState and
-          // break it if it exists.
-          state->detect_and_break_cycles();
-        }
-      }
 
-      if (state->get_ref_count() == 1) {
-        // This state has recently been unreffed to 1 (the one we
-        // added when we stored it in the cache).  Now it's time to
-        // delete it.  This is safe, because we're holding the
-        // _states_lock, so it's not possible for some other thread to
-        // find the state in the cache and ref it while we're doing
-        // this.
-        state->release_new();
-        state->remove_cache_pointers();
-        state->cache_unref();
-        delete state;
-      }
-    }
-
-    si = (si + 1) % size;
-  } while (si != stop_at_element);
-  _garbage_index = si;
-  nassertr(_states->validate(), 0);
-
-  int new_size = _states->get_num_entries();
-  return orig_size - new_size + num_attribs;
+  return num_states + num_attribs;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -1106,14 +1055,20 @@ void RenderState::
 clear_munger_cache() {
   LightReMutexHolder holder(*_states_lock);
 
-  int size = _states->get_size();
-  for (int si = 0; si < size; ++si) {
-    if (!_states->has_element(si)) {
-      continue;
+  for (int shi = 0; shi < _num_shards; ++shi) {
+    StateShard &shard = _shards[shi];
+    LightReMutexHolder shard_holder(shard._lock);
+
+    int size = shard._states.get_size();
+    for (int si = 0; si < size; ++si) {
+      if (!shard._states.has_element(si)) {
+        continue;
+      }
+      RenderState *state = (RenderState *)(shard._states.get_key(si));
+      LightMutexHolder state_holder(state->_lock);
+      state->_mungers.clear();
+      state->_last_mi = -1;
     }
-    RenderState *state = (RenderState *)(_states->get_key(si));
-    state->_mungers.clear();
-    state->_last_mi = -1;
   }
 }
 
@@ -1137,7 +1092,7 @@ clear_munger_cache() {
 ////////////////////////////////////////////////////////////////////
 void RenderState::
 list_cycles(ostream &out) {
-  if (_states == (States *)NULL) {
+  if (_shards == (StateShard *)NULL) {
     return;
   }
   LightReMutexHolder holder(*_states_lock);
@@ -1146,63 +1101,68 @@ list_cycles(ostream &out) {
   VisitedStates visited;
   CompositionCycleDesc cycle_desc;
 
-  int size = _states->get_size();
-  for (int si = 0; si < size; ++si) {
-    if (!_states->has_element(si)) {
-      continue;
-    }
-    const RenderState *state = _states->get_key(si);
-
-    bool inserted = visited.insert(state).second;
-    if (inserted) {
-      ++_last_cycle_detect;
-      if (r_detect_cycles(state, state, 1, _last_cycle_detect, &cycle_desc)) {
-        // This state begins a cycle.
-        CompositionCycleDesc::reverse_iterator csi;
-
-        out << "\nCycle detected of length " << cycle_desc.size() + 1 << ":\n"
-            << "state " << (void *)state << ":" << state->get_ref_count()
-            << " =\n";
-        state->write(out, 2);
-        for (csi = cycle_desc.rbegin(); csi != cycle_desc.rend(); ++csi) {
-          const CompositionCycleDescEntry &entry = (*csi);
-          if (entry._inverted) {
-            out << "invert composed with ";
-          } else {
-            out << "composed with ";
-          }
-          out << (const void *)entry._obj << ":" << entry._obj->get_ref_count()
-              << " " << *entry._obj << "\n"
-              << "produces " << (const void *)entry._result << ":"
-              << entry._result->get_ref_count() << " =\n";
-          entry._result->write(out, 2);
-          visited.insert(entry._result);
-        }
+  for (int shi = 0; shi < _num_shards; ++shi) {
+    StateShard &shard = _shards[shi];
+    LightReMutexHolder shard_holder(shard._lock);
+
+    int size = shard._states.get_size();
+    for (int si = 0; si < size; ++si) {
+      if (!shard._states.has_element(si)) {
+        continue;
+      }
+      const RenderState *state = shard._states.get_key(si);
 
-        cycle_desc.clear();
-      } else {
+      bool inserted = visited.insert(state).second;
+      if (inserted) {
         ++_last_cycle_detect;
-        if (r_detect_reverse_cycles(state, state, 1, _last_cycle_detect, &cycle_desc)) {
+        if (r_detect_cycles(state, state, 1, _last_cycle_detect, &cycle_desc)) {
           // This state begins a cycle.
-          CompositionCycleDesc::iterator csi;
+          CompositionCycleDesc::reverse_iterator csi;
 
-          out << "\nReverse cycle detected of length " << cycle_desc.size() + 1 << ":\n"
-              << "state ";
-          for (csi = cycle_desc.begin(); csi != cycle_desc.end(); ++csi) {
+          out << "\nCycle detected of length " << cycle_desc.size() + 1 << ":\n"
+              << "state " << (void *)state << ":" << state->get_ref_count()
+              << " =\n";
+          state->write(out, 2);
+          for (csi = cycle_desc.rbegin(); csi != cycle_desc.rend(); ++csi) {
             const CompositionCycleDescEntry &entry = (*csi);
-            out << (const void *)entry._result << ":"
+            if (entry._inverted) {
+              out << "invert composed with ";
+            } else {
+              out << "composed with ";
+            }
+            out << (const void *)entry._obj << ":" << entry._obj->get_ref_count()
+                << " " << *entry._obj << "\n"
+                << "produces " << (const void *)entry._result << ":"
                 << entry._result->get_ref_count() << " =\n";
             entry._result->write(out, 2);
-            out << (const void *)entry._obj << ":"
-                << entry._obj->get_ref_count() << " =\n";
-            entry._obj->write(out, 2);
             visited.insert(entry._result);
           }
-          out << (void *)state << ":"
-              << state->get_ref_count() << " =\n";
-          state->write(out, 2);
 
           cycle_desc.clear();
+        } else {
+          ++_last_cycle_detect;
+          if (r_detect_reverse_cycles(state, state, 1, _last_cycle_detect, &cycle_desc)) {
+            // This state begins a cycle.
+            CompositionCycleDesc::iterator csi;
+
+            out << "\nReverse cycle detected of length " << cycle_desc.size() + 1 << ":\n"
+                << "state ";
+            for (csi = cycle_desc.begin(); csi != cycle_desc.end(); ++csi) {
+              const CompositionCycleDescEntry &entry = (*csi);
+              out << (const void *)entry._result << ":"
+                  << entry._result->get_ref_count() << " =\n";
+              entry._result->write(out, 2);
+              out << (const void *)entry._obj << ":"
+                  << entry._obj->get_ref_count() << " =\n";
+              entry._obj->write(out, 2);
+              visited.insert(entry._result);
+            }
+            out << (void *)state << ":"
+                << state->get_ref_count() << " =\n";
+            state->write(out, 2);
+
+            cycle_desc.clear();
+          }
         }
       }
     }
@@ -1219,21 +1179,26 @@ list_cycles(ostream &out) {
 ////////////////////////////////////////////////////////////////////
 void RenderState::
 list_states(ostream &out) {
-  if (_states == (States *)NULL) {
+  if (_shards == (StateShard *)NULL) {
     out << "0 states:\n";
     return;
   }
   LightReMutexHolder holder(*_states_lock);
 
-  out << _states->get_num_entries() << " states:\n";
+  out << get_num_states() << " states:\n";
 
-  int size = _states->get_size();
-  for (int si = 0; si < size; ++si) {
-    if (!_states->has_element(si)) {
-      continue;
+  for (int shi = 0; shi < _num_shards; ++shi) {
+    StateShard &shard = _shards[shi];
+    LightReMutexHolder shard_holder(shard._lock);
+
+    int size = shard._states.get_size();
+    for (int si = 0; si < size; ++si) {
+      if (!shard._states.has_element(si)) {
+        continue;
+      }
+      const RenderState *state = shard._states.get_key(si);
+      state->write(out, 2);
     }
-    const RenderState *state = _states->get_key(si);
-    state->write(out, 2);
   }
 }
 
@@ -1249,59 +1214,17 @@ list_states(ostream &out) {
 ////////////////////////////////////////////////////////////////////
 bool RenderState::
 validate_states() {
-  if (_states == (States *)NULL) {
+  if (_shards == (StateShard *)NULL) {
     return true;
   }
 
   PStatTimer timer(_state_validate_pcollector);
 
   LightReMutexHolder holder(*_states_lock);
-  if (_states->is_empty()) {
-    return true;
-  }
-
-  if (!_states->validate()) {
-    pgraph_cat.error()
-      << "RenderState::_states cache is invalid!\n";
-    return false;
-  }
-
-  int size = _states->get_size();
-  int si = 0;
-  while (si < size && !_states->has_element(si)) {
-    ++si;
-  }
-  nassertr(si < size, false);
-  nassertr(_states->get_key(si)->get_ref_count() >= 0, false);
-  int snext = si;
-  ++snext;
-  while (snext < size && !_states->has_element(snext)) {
-    ++snext;
-  }
-  while (snext < size) {
-    nassertr(_states->get_key(snext)->get_ref_count() >= 0, false);
-    const RenderState *ssi = _states->get_key(si);
-    const RenderState *ssnext = _states->get_key(snext);
-    int c = ssi->compare_to(*ssnext);
-    int ci = ssnext->compare_to(*ssi);
-    if ((ci < 0) != (c > 0) ||
-        (ci > 0) != (c < 0) ||
-        (ci == 0) != (c == 0)) {
-      pgraph_cat.error()
-        << "RenderState::compare_to() not defined properly!\n";
-      pgraph_cat.error(false)
-        << "(a, b): " << c << "\n";
-      pgraph_cat.error(false)
-        << "(b, a): " << ci << "\n";
-      ssi->write(pgraph_cat.error(false), 2);
-      ssnext->write(pgraph_cat.error(false), 2);
+  for (int i = 0; i < _num_shards; ++i) {
+    if (!_shards[i].validate()) {
       return false;
     }
-    si = snext;
-    ++snext;
-    while (snext < size && !_states->has_element(snext)) {
-      ++snext;
-    }
   }
 
   return true;
@@ -1522,51 +1445,65 @@ return_unique(RenderState *state) {
   }
 #endif
 
-  LightReMutexHolder holder(*_states_lock);
-
-  if (state->_saved_entry != -1) {
-    // This state is already in the cache.
-    //nassertr(_states->find(state) == state->_saved_entry, pt_state);
-    return state;
-  }
-
   // Ensure each of the individual attrib pointers has been uniquified
-  // before we add the state to the cache.
+  // before we add the state to the cache.  This changes the state's
+  // hash, so it must be done before we look for its shard.  It's not
+  // normally needed, so we simply borrow _states_lock to protect the
+  // attribs while we do it.
   if (!uniquify_attribs && !state->is_empty()) {
-    SlotMask mask = state->_filled_slots;
-    int slot = mask.get_lowest_on_bit();
-    while (slot >= 0) {
-      Attribute &attrib = state->_attributes[slot];
-      nassertd(attrib._attrib != (RenderAttrib *)NULL) continue;
-      attrib._attrib = attrib._attrib->get_unique();
-      mask.clear_bit(slot);
-      slot = mask.get_lowest_on_bit();
+    LightReMutexHolder holder(*_states_lock);
+    if (state->_saved_entry == -1) {
+      SlotMask mask = state->_filled_slots;
+      int slot = mask.get_lowest_on_bit();
+      while (slot >= 0) {
+        Attribute &attrib = state->_attributes[slot];
+        nassertd(attrib._attrib != (RenderAttrib *)NULL) continue;
+        attrib._attrib = attrib._attrib->get_unique();
+        mask.clear_bit(slot);
+        slot = mask.get_lowest_on_bit();
+      }
     }
   }
 
-  int si = _states->find(state);
-  if (si != -1) {
-    // There's an equivalent state already in the set.  Return it.
-    // The state that was passed may be newly created and therefore
-    // may not be automatically deleted.  Do that if necessary.
-    if (state->get_ref_count() == 0) {
-      delete state;
+  CPT(RenderState) result;
+  {
+    StateShard &shard = get_shard(state);
+    LightReMutexHolder holder(shard._lock);
+
+    if (state->_saved_entry != -1) {
+      // This state is already in the cache.
+      //nassertr(shard._states.find(state) == state->_saved_entry, state);
+      return state;
     }
-    return _states->get_key(si);
-  }
 
-  // Not already in the set; add it.
-  if (garbage_collect_states) {
-    // If we'll be garbage collecting states explicitly, we'll
-    // increment the reference count when we store it in the cache, so
-    // that it won't be deleted while it's in it.
-    state->cache_ref();
+    int si = shard._states.find(state);
+    if (si == -1) {
+      // Not already in the set; add it.
+      if (garbage_collect_states) {
+        // If we'll be garbage collecting states explicitly, we'll
+        // increment the reference count when we store it in the cache,
+        // so that it won't be deleted while it's in it.
+        state->cache_ref();
+      }
+      si = shard._states.store(state, Empty());
+
+      // Save the index and return the input state.
+      state->_saved_entry = si;
+      return state;
+    }
+
+    // There's an equivalent state already in the set.
+    result = shard._states.get_key(si);
   }
-  si = _states->store(state, Empty());
 
-  // Save the index and return the input state.
-  state->_saved_entry = si;
-  return state;
+  // The state that was passed may be newly created and therefore may
+  // not be automatically deleted.  Do that if necessary.  We must not
+  // be holding the shard lock at this point, since the destructor
+  // grabs _states_lock.
+  if (state->get_ref_count() == 0) {
+    delete state;
+  }
+  return result;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -1628,6 +1565,84 @@ do_compose(const RenderState *other) const {
   return return_new(new_state);
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: RenderState::store_compose
+//       Access: Private
+//  Description: Stores the result of a composition in the cache.
+//               Returns the stored result (it may be a different
+//               object than the one passed in, due to another thread
+//               having computed the composition first).
+////////////////////////////////////////////////////////////////////
+CPT(RenderState) RenderState::
+store_compose(const RenderState *other, const RenderState *result) {
+  // Empty state should have already been screened.
+  nassertr(!is_empty(), other);
+  nassertr(!other->is_empty(), this);
+
+  LightReMutexHolder holder(*_states_lock);
+
+  // We are about to modify both our cache and the other state's, so
+  // we need their shard locks too; see _states_lock.
+  LightReMutexHolder shard_holder(get_shard(this)._lock);
+  LightReMutexHolder other_shard_holder(get_shard(other)._lock);
+
+  // Is this composition already cached?
+  int index = _composition_cache.find(other);
+  if (index != -1) {
+    Composition &comp = _composition_cache.modify_data(index);
+    if (comp._result == (const RenderState *)NULL) {
+      // Well, it wasn't cached already, but we already had an entry
+      // (probably created for the reverse direction), so use the same
+      // entry to store the new result.
+      comp._result = result;
+
+      if (result != (const RenderState *)this) {
+        // See the comments below about the need to up the reference
+        // count only when the result is not the same as this.
+        result->cache_ref();
+      }
+    }
+    // Here's the cache!
+    _cache_stats.inc_hits();
+    return comp._result;
+  }
+  _cache_stats.inc_misses();
+
+  // We need to make a new cache entry, both in this object and in the
+  // other object.  We make both records so the other RenderState
+  // object will know to delete the entry from this object when it
+  // destructs, and vice-versa.
+
+  // The cache entry in this object is the only one that indicates the
+  // result; the other will be NULL for now.
+  _cache_stats.add_total_size(1);
+  _cache_stats.inc_adds(_composition_cache.get_size() == 0);
+
+  _composition_cache[other]._result = result;
+
+  if (other != this) {
+    _cache_stats.add_total_size(1);
+    _cache_stats.inc_adds(other->_composition_cache.get_size() == 0);
+    ((RenderState *)other)->_composition_cache[this]._result = NULL;
+  }
+
+  if (result != (const RenderState *)this) {
+    // If the result of do_compose() is something other than this,
+    // explicitly increment the reference count.  We have to be sure
+    // to decrement it again later, when the composition entry is
+    // removed from the cache.
+    result->cache_ref();
+
+    // (If the result was just this again, we still store the
+    // result, but we don't increment the reference count, since
+    // that would be a self-referential leak.)
+  }
+
+  _cache_stats.maybe_report("RenderState");
+
+  return result;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: RenderState::do_invert_compose
 //       Access: Private
@@ -1670,6 +1685,81 @@ do_invert_compose(const RenderState *other) const {
   return return_new(new_state);
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: RenderState::store_invert_compose
+//       Access: Private
+//  Description: Stores the result of a composition in the cache.
+//               Returns the stored result (it may be a different
+//               object than the one passed in, due to another thread
+//               having computed the composition first).
+////////////////////////////////////////////////////////////////////
+CPT(RenderState) RenderState::
+store_invert_compose(const RenderState *other, const RenderState *result) {
+  // Empty state should have already been screened.
+  nassertr(!is_empty(), other);
+  nassertr(other != this, _empty_state);
+
+  LightReMutexHolder holder(*_states_lock);
+
+  // We are about to modify both our cache and the other state's, so
+  // we need their shard locks too; see _states_lock.
+  LightReMutexHolder shard_holder(get_shard(this)._lock);
+  LightReMutexHolder other_shard_holder(get_shard(other)._lock);
+
+  // Is this composition already cached?
+  int index = _invert_composition_cache.find(other);
+  if (index != -1) {
+    Composition &comp = _invert_composition_cache.modify_data(index);
+    if (comp._result == (const RenderState *)NULL) {
+      // Well, it wasn't cached already, but we already had an entry
+      // (probably created for the reverse direction), so use the same
+      // entry to store the new result.
+      comp._result = result;
+
+      if (result != (const RenderState *)this) {
+        // See the comments below about the need to up the reference
+        // count only when the result is not the same as this.
+        result->cache_ref();
+      }
+    }
+    // Here's the cache!
+    _cache_stats.inc_hits();
+    return comp._result;
+  }
+  _cache_stats.inc_misses();
+
+  // We need to make a new cache entry, both in this object and in the
+  // other object.  We make both records so the other RenderState
+  // object will know to delete the entry from this object when it
+  // destructs, and vice-versa.
+
+  // The cache entry in this object is the only one that indicates the
+  // result; the other will be NULL for now.
+  _cache_stats.add_total_size(1);
+  _cache_stats.inc_adds(_invert_composition_cache.get_size() == 0);
+  _invert_composition_cache[other]._result = result;
+
+  if (other != this) {
+    _cache_stats.add_total_size(1);
+    _cache_stats.inc_adds(other->_invert_composition_cache.get_size() == 0);
+    ((RenderState *)other)->_invert_composition_cache[this]._result = NULL;
+  }
+
+  if (result != (const RenderState *)this) {
+    // If the result of compose() is something other than this,
+    // explicitly increment the reference count.  We have to be sure
+    // to decrement it again later, when the composition entry is
+    // removed from the cache.
+    result->cache_ref();
+
+    // (If the result was just this again, we still store the
+    // result, but we don't increment the reference count, since
+    // that would be a self-referential leak.)
+  }
+
+  return result;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: RenderState::detect_and_break_cycles
 //       Access: Private
@@ -1867,9 +1957,11 @@ release_new() {
   nassertv(_states_lock->debug_is_locked());
 
   if (_saved_entry != -1) {
-    //nassertv(_states->find(this) == _saved_entry);
-    _saved_entry = _states->find(this);
-    _states->remove_element(_saved_entry);
+    StateShard &shard = get_shard(this);
+    LightReMutexHolder holder(shard._lock);
+    //nassertv(shard._states.find(this) == _saved_entry);
+    _saved_entry = shard._states.find(this);
+    shard._states.remove_element(_saved_entry);
     _saved_entry = -1;
   }
 }
@@ -1939,40 +2031,48 @@ remove_cache_pointers() {
 
     // We hold a copy of the composition result so we can dereference
     // it later.
-    Composition comp = _composition_cache.get_data(i);
-
-    // Now we can remove the element from our cache.  We do this now,
-    // rather than later, before any other RenderState objects have
-    // had a chance to destruct, so we are confident that our iterator
-    // is still valid.
-    _composition_cache.remove_element(i);
-    _cache_stats.add_total_size(-1);
-    _cache_stats.inc_dels();
-
-    if (other != this) {
-      int oi = other->_composition_cache.find(this);
-
-      // We may or may not still be listed in the other's cache (it
-      // might be halfway through pulling entries out, from within its
-      // own destructor).
-      if (oi != -1) {
-        // Hold a copy of the other composition result, too.
-        Composition ocomp = other->_composition_cache.get_data(oi);
-
-        other->_composition_cache.remove_element(oi);
-        _cache_stats.add_total_size(-1);
-        _cache_stats.inc_dels();
-
-        // It's finally safe to let our held pointers go away.  This may
-        // have cascading effects as other RenderState objects are
-        // destructed, but there will be no harm done if they destruct
-        // now.
-        if (ocomp._result != (const RenderState *)NULL && ocomp._result != other) {
-          cache_unref_delete(ocomp._result);
+    Composition comp;
+    Composition ocomp;
+    {
+      // Other threads may be reading either cache while holding only
+      // its shard lock; see _states_lock.
+      LightReMutexHolder shard_holder(get_shard(this)._lock);
+      LightReMutexHolder other_shard_holder(get_shard(other)._lock);
+      comp = _composition_cache.get_data(i);
+
+      // Now we can remove the element from our cache.  We do this now,
+      // rather than later, before any other RenderState objects have
+      // had a chance to destruct, so we are confident that our iterator
+      // is still valid.
+      _composition_cache.remove_element(i);
+      _cache_stats.add_total_size(-1);
+      _cache_stats.inc_dels();
+
+      if (other != this) {
+        int oi = other->_composition_cache.find(this);
+
+        // We may or may not still be listed in the other's cache (it
+        // might be halfway through pulling entries out, from within its
+        // own destructor).
+        if (oi != -1) {
+          // Hold a copy of the other composition result, too.
+          ocomp = other->_composition_cache.get_data(oi);
+
+          other->_composition_cache.remove_element(oi);
+          _cache_stats.add_total_size(-1);
+          _cache_stats.inc_dels();
         }
       }
     }
 
+    // It's finally safe to let our held pointers go away.  This may
+    // have cascading effects as other RenderState objects are
+    // destructed, but there will be no harm done if they destruct
+    // now.
+    if (ocomp._result != (const RenderState *)NULL && ocomp._result != other) {
+      cache_unref_delete(ocomp._result);
+    }
+
     // It's finally safe to let our held pointers go away.  (See
     // comment above.)
     if (comp._result != (const RenderState *)NULL && comp._result != this) {
@@ -1989,22 +2089,28 @@ remove_cache_pointers() {
 
     RenderState *other = (RenderState *)_invert_composition_cache.get_key(i);
     nassertv(other != this);
-    Composition comp = _invert_composition_cache.get_data(i);
-    _invert_composition_cache.remove_element(i);
-    _cache_stats.add_total_size(-1);
-    _cache_stats.inc_dels();
-    if (other != this) {
-      int oi = other->_invert_composition_cache.find(this);
-      if (oi != -1) {
-        Composition ocomp = other->_invert_composition_cache.get_data(oi);
-        other->_invert_composition_cache.remove_element(oi);
-        _cache_stats.add_total_size(-1);
-        _cache_stats.inc_dels();
-        if (ocomp._result != (const RenderState *)NULL && ocomp._result != other) {
-          cache_unref_delete(ocomp._result);
+    Composition comp;
+    Composition ocomp;
+    {
+      LightReMutexHolder shard_holder(get_shard(this)._lock);
+      LightReMutexHolder other_shard_holder(get_shard(other)._lock);
+      comp = _invert_composition_cache.get_data(i);
+      _invert_composition_cache.remove_element(i);
+      _cache_stats.add_total_size(-1);
+      _cache_stats.inc_dels();
+      if (other != this) {
+        int oi = other->_invert_composition_cache.find(this);
+        if (oi != -1) {
+          ocomp = other->_invert_composition_cache.get_data(oi);
+          other->_invert_composition_cache.remove_element(oi);
+          _cache_stats.add_total_size(-1);
+          _cache_stats.inc_dels();
         }
       }
     }
+    if (ocomp._result != (const RenderState *)NULL && ocomp._result != other) {
+      cache_unref_delete(ocomp._result);
+    }
     if (comp._result != (const RenderState *)NULL && comp._result != this) {
       cache_unref_delete(comp._result);
     }
@@ -2146,7 +2252,23 @@ update_pstats(int old_referenced_bits, int new_referenced_bits) {
 ////////////////////////////////////////////////////////////////////
 void RenderState::
 init_states() {
-  _states = new States;
+  // This variable is declared here, rather than in config_pgraph, so
+  // that it is guaranteed to be constructed by the time we get here
+  // at static init time.
+  ConfigVariableInt state_table_shards
+    ("state-table-shards", 16,
+     PRC_DESC("The number of separately-locked shards into which the "
+              "global tables of unique RenderStates and TransformStates "
+              "are divided.  More shards reduce lock contention when "
+              "many threads are creating and composing states at once.  "
+              "This is rounded up to a power of 2, and is only "
+              "consulted once, at startup."));
+
+  _num_shards = 1;
+  while (_num_shards < state_table_shards) {
+    _num_shards <<= 1;
+  }
+  _shards = new StateShard[_num_shards];
 
   // TODO: we should have a global Panda mutex to allow us to safely
   // create _states_lock without a startup race condition.  For the
@@ -2161,10 +2283,144 @@ init_states() {
   // that it is declared globally, and lives forever.
   RenderState *state = new RenderState;
   state->local_object();
-  state->_saved_entry = _states->store(state, Empty());
+  state->_saved_entry = get_shard(state)._states.store(state, Empty());
   _empty_state = state;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: RenderState::StateShard::Constructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+RenderState::StateShard::
+StateShard() :
+  _lock("RenderState::StateShard"),
+  _garbage_index(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: RenderState::StateShard::garbage_collect
+//       Access: Public
+//  Description: Performs a garbage-collection pass over this shard of
+//               the global state table, and returns the number of
+//               states freed.  The caller must already be holding
+//               _states_lock.
+////////////////////////////////////////////////////////////////////
+int RenderState::StateShard::
+garbage_collect() {
+  nassertr(_states_lock->debug_is_locked(), 0);
+  LightReMutexHolder holder(_lock);
+
+  int orig_size = _states.get_num_entries();
+
+  // How many elements to process this pass?
+  int size = _states.get_size();
+  int num_this_pass = int(size * garbage_collect_states_rate);
+  if (num_this_pass <= 0) {
+    return 0;
+  }
+  num_this_pass = min(num_this_pass, size);
+  int stop_at_element = (_garbage_index + num_this_pass) % size;
+
+  int si = _garbage_index;
+  do {
+    if (_states.has_element(si)) {
+      RenderState *state = (RenderState *)_states.get_key(si);
+      if (auto_break_cycles && uniquify_states) {
+        if (state->get_cache_ref_count() > 0 &&
+            state->get_ref_count() == state->get_cache_ref_count()) {
+          // If we have removed all the references to this state not in
+          // the cache, leaving only references in the cache, then we
+          // need to check for a cycle involving this RenderState and
+          // break it if it exists.
+          state->detect_and_break_cycles();
+        }
+      }
+
+      if (state->get_ref_count() == 1) {
+        // This state has recently been unreffed to 1 (the one we
+        // added when we stored it in the cache).  Now it's time to
+        // delete it.  This is safe, because we're holding this
+        // shard's lock, so it's not possible for some other thread to
+        // find the state in the table and ref it while we're doing
+        // this.
+        state->release_new();
+        state->remove_cache_pointers();
+        state->cache_unref();
+        delete state;
+      }
+    }
+
+    si = (si + 1) % size;
+  } while (si != stop_at_element);
+  _garbage_index = si;
+  nassertr(_states.validate(), 0);
+
+  int new_size = _states.get_num_entries();
+  return orig_size - new_size;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: RenderState::StateShard::validate
+//       Access: Public
+//  Description: Does the work of validate_states() for this shard of
+//               the global state table.
+////////////////////////////////////////////////////////////////////
+bool RenderState::StateShard::
+validate() {
+  LightReMutexHolder holder(_lock);
+  if (_states.is_empty()) {
+    return true;
+  }
+
+  if (!_states.validate()) {
+    pgraph_cat.error()
+      << "RenderState::_states shard is invalid!\n";
+    return false;
+  }
+
+  int size = _states.get_size();
+  int si = 0;
+  while (si < size && !_states.has_element(si)) {
+    ++si;
+  }
+  nassertr(si < size, false);
+  nassertr(_states.get_key(si)->get_ref_count() >= 0, false);
+  int snext = si;
+  ++snext;
+  while (snext < size && !_states.has_element(snext)) {
+    ++snext;
+  }
+  while (snext < size) {
+    nassertr(_states.get_key(snext)->get_ref_count() >= 0, false);
+    const RenderState *ssi = _states.get_key(si);
+    const RenderState *ssnext = _states.get_key(snext);
+    int c = ssi->compare_to(*ssnext);
+    int ci = ssnext->compare_to(*ssi);
+    if ((ci < 0) != (c > 0) ||
+        (ci > 0) != (c < 0) ||
+        (ci == 0) != (c == 0)) {
+      pgraph_cat.error()
+        << "RenderState::compare_to() not defined properly!\n";
+      pgraph_cat.error(false)
+        << "(a, b): " << c << "\n";
+      pgraph_cat.error(false)
+        << "(b, a): " << ci << "\n";
+      ssi->write(pgraph_cat.error(false), 2);
+      ssnext->write(pgraph_cat.error(false), 2);
+      return false;
+    }
+    si = snext;
+    ++snext;
+    while (snext < size && !_states.has_element(snext)) {
+      ++snext;
+    }
+  }
+
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: RenderState::register_with_read_factory
 //       Access: Public, Static
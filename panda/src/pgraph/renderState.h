@@ -196,7 +196,9 @@ private:
   static CPT(RenderState) return_new(RenderState *state);
   static CPT(RenderState) return_unique(RenderState *state);
   CPT(RenderState) do_compose(const RenderState *other) const;
+  CPT(RenderState) store_compose(const RenderState *other, const RenderState *result);
   CPT(RenderState) do_invert_compose(const RenderState *other) const;
+  CPT(RenderState) store_invert_compose(const RenderState *other, const RenderState *result);
   void detect_and_break_cycles();
   static bool r_detect_cycles(const RenderState *start_state,
                               const RenderState *current_state,
@@ -230,19 +232,47 @@ public:
   mutable CPT(RenderAttrib) _generated_shader;
 
 private:
-  // This mutex protects _states.  It also protects any modification
-  // to the cache, which is encoded in _composition_cache and
-  // _invert_composition_cache.
+  // This mutex protects any modification to the cache, which is
+  // encoded in _composition_cache and _invert_composition_cache.  To
+  // modify a state's caches, a thread must hold both _states_lock and
+  // the lock of the StateShard the state hashes to; to read them, it
+  // need hold only one of these, so that a cache hit needs only the
+  // shard lock.  The global set of states itself is protected by the
+  // lock within each StateShard.  A thread that holds _states_lock
+  // may go on to acquire one or more shard locks; a thread that
+  // doesn't may hold only one shard lock at a time, and must not wait
+  // on any other lock while it does.
   static LightReMutex *_states_lock;
   class Empty {
   };
   typedef SimpleHashMap<const RenderState *, Empty, indirect_compare_to_hash<const RenderState *> > States;
-  static States *_states;
+
+  // The global set of unique RenderStates is divided into a number
+  // of shards, according to the hash of each state, so that threads
+  // creating unrelated states don't all contend for the same lock.
+  class StateShard {
+  public:
+    StateShard();
+    int garbage_collect();
+    bool validate();
+
+    LightReMutex _lock;
+    States _states;
+
+    // This keeps track of our current position through the garbage
+    // collection cycle within this shard.
+    int _garbage_index;
+  };
+  INLINE static StateShard &get_shard(const RenderState *state);
+
+  static StateShard *_shards;
+  static int _num_shards;
   static const RenderState *_empty_state;
 
   // This iterator records the entry corresponding to this
-  // RenderState object in the above global set.  We keep the index
-  // around so we can remove it when the RenderState destructs.
+  // RenderState object in its shard of the above global set.  We
+  // keep the index around so we can remove it when the RenderState
+  // destructs.
   int _saved_entry;
 
   // This data structure manages the job of caching the composition of
@@ -273,7 +303,8 @@ private:
   // to look up the GSG in the RenderState pointer than vice-versa,
   // since there are likely to be far fewer GSG's than RenderStates.
   // The code to manage this map lives in
-  // GraphicsStateGuardian::get_geom_munger().
+  // GraphicsStateGuardian::get_geom_munger().  It is protected by
+  // _lock, since several cull threads may share it.
   typedef WeakKeyHashMap<GraphicsStateGuardianBase, PT(GeomMunger) > Mungers;
   mutable Mungers _mungers;
   mutable int _last_mi;
@@ -282,10 +313,6 @@ private:
   UpdateSeq _cycle_detect;
   static UpdateSeq _last_cycle_detect;
 
-  // This keeps track of our current position through the garbage
-  // collection cycle.
-  static int _garbage_index;
-
   static PStatCollector _cache_update_pcollector;
   static PStatCollector _garbage_collect_pcollector;
   static PStatCollector _state_compose_pcollector;
@@ -142,30 +142,33 @@ get_invert_composition_cache() const {
 PyObject *Extension<RenderState>::
 get_states() {
   extern struct Dtool_PyTypedObject Dtool_RenderState;
-  if (RenderState::_states == (RenderState::States *)NULL) {
+  if (RenderState::_shards == (RenderState::StateShard *)NULL) {
     return PyList_New(0);
   }
   LightReMutexHolder holder(*RenderState::_states_lock);
 
-  size_t num_states = RenderState::_states->get_num_entries();
-  PyObject *list = PyList_New(num_states);
-  size_t i = 0;
+  // Other threads may still be adding states to the shards while we
+  // walk through them, so we can't know the final count in advance.
+  PyObject *list = PyList_New(0);
 
-  int size = RenderState::_states->get_size();
-  for (int si = 0; si < size; ++si) {
-    if (!RenderState::_states->has_element(si)) {
-      continue;
+  for (int shi = 0; shi < RenderState::_num_shards; ++shi) {
+    RenderState::StateShard &shard = RenderState::_shards[shi];
+    LightReMutexHolder shard_holder(shard._lock);
+
+    int size = shard._states.get_size();
+    for (int si = 0; si < size; ++si) {
+      if (!shard._states.has_element(si)) {
+        continue;
+      }
+      const RenderState *state = shard._states.get_key(si);
+      state->ref();
+      PyObject *a = 
+        DTool_CreatePyInstanceTyped((void *)state, Dtool_RenderState, 
+                                    true, true, state->get_type_index());
+      PyList_Append(list, a);
+      Py_DECREF(a);
     }
-    const RenderState *state = RenderState::_states->get_key(si);
-    state->ref();
-    PyObject *a = 
-      DTool_CreatePyInstanceTyped((void *)state, Dtool_RenderState, 
-                                  true, true, state->get_type_index());
-    nassertr(i < num_states, list);
-    PyList_SET_ITEM(list, i, a);
-    ++i;
   }
-  nassertr(i == num_states, list);
   return list;
 }
 
@@ -0,0 +1,236 @@
+// Filename: test_bam_cache.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pandabase.h"
+#include "config_pgraph.h"
+#include "bamCache.h"
+#include "bamCacheRecord.h"
+#include "pandaNode.h"
+#include "nodePath.h"
+#include "virtualFileSystem.h"
+#include "thread.h"
+#include "randomizer.h"
+
+// This program exercises a content-addressed BamCache in a temporary
+// directory.  It stores the same scene for two different source
+// files, and checks that the scene is stored only once; it checks
+// that lookups find the cached scenes, that a modified source file
+// is not served stale, and that many threads can look up the same
+// file at once; and finally it sets a small size limit, and checks
+// that the least recently used files are evicted to keep within it.
+
+static const int num_leaves = 100;
+static const int num_threads = 8;
+static const int num_lookups = 50;
+
+// Makes a scene with a transform on each leaf.  Scenes made from the
+// same seed are identical.
+static PT(PandaNode)
+make_scene(int seed) {
+  Randomizer random(seed);
+  PT(PandaNode) root = new PandaNode("root");
+  NodePath root_np(root);
+  for (int i = 0; i < num_leaves; ++i) {
+    NodePath leaf = root_np.attach_new_node("leaf");
+    leaf.set_pos(random.random_real(100.0), random.random_real(100.0),
+                 random.random_real(100.0));
+  }
+  return root;
+}
+
+// Writes a stand-in source file.
+static Filename
+make_source(const Filename &dirname, const string &basename,
+            const string &contents) {
+  Filename filename(dirname, basename);
+  VirtualFileSystem::get_global_ptr()->write_file(filename, contents, false);
+  return filename;
+}
+
+// Stores the scene in the cache for the indicated source file.
+static bool
+store_scene(BamCache &cache, const Filename &source, PandaNode *scene) {
+  PT(BamCacheRecord) record = cache.lookup(source, "bam");
+  if (record == (BamCacheRecord *)NULL) {
+    return false;
+  }
+  record->add_dependent_file(source);
+  record->set_data(scene, scene);
+  return cache.store(record);
+}
+
+// Returns the number of leaves of the cached scene for the indicated
+// source file, or -1 if it is not in the cache.
+static int
+lookup_scene(BamCache &cache, const Filename &source) {
+  PT(BamCacheRecord) record = cache.lookup(source, "bam");
+  if (record == (BamCacheRecord *)NULL || !record->has_data()) {
+    return -1;
+  }
+  PandaNode *scene = DCAST(PandaNode, record->get_data());
+  return scene->get_num_children();
+}
+
+// Returns the number of files in the indicated directory, and adds
+// up their sizes.
+static int
+count_files(const Filename &dirname, streamsize &total_size) {
+  PT(VirtualFileList) files = VirtualFileSystem::get_global_ptr()->scan_directory(dirname);
+  int count = 0;
+  if (files != (VirtualFileList *)NULL) {
+    for (int i = 0; i < files->get_num_files(); ++i) {
+      VirtualFile *file = files->get_file(i);
+      if (file->is_regular_file() && file->get_filename().get_extension() == "bam") {
+        total_size += file->get_file_size();
+        ++count;
+      }
+    }
+  }
+  return count;
+}
+
+// Deletes the indicated directory and everything in it.
+static void
+delete_tree(const Filename &dirname) {
+  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+  PT(VirtualFileList) files = vfs->scan_directory(dirname);
+  if (files != (VirtualFileList *)NULL) {
+    for (int i = 0; i < files->get_num_files(); ++i) {
+      VirtualFile *file = files->get_file(i);
+      if (file->is_directory()) {
+        delete_tree(file->get_filename());
+      } else {
+        vfs->delete_file(file->get_filename());
+      }
+    }
+  }
+  vfs->delete_file(dirname);
+}
+
+// A thread that looks up the same source file over and over.
+class LookupThread : public Thread {
+public:
+  LookupThread(BamCache *cache, const Filename &source) :
+    Thread("LookupThread", "LookupThread"),
+    _cache(cache), _source(source), _num_found(0) { }
+
+  virtual void thread_main() {
+    for (int i = 0; i < num_lookups; ++i) {
+      if (lookup_scene(*_cache, _source) == num_leaves) {
+        ++_num_found;
+      }
+    }
+  }
+
+  BamCache *_cache;
+  Filename _source;
+  int _num_found;
+};
+
+int
+main(int argc, char *argv[]) {
+  init_libpgraph();
+  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+
+  Filename dirname = Filename::temporary("", "bamcache");
+  Filename cache_dir(dirname, "cache");
+  Filename content_dir(cache_dir, "content");
+  if (!vfs->make_directory_full(cache_dir)) {
+    nout << "Unable to create " << cache_dir << "\n";
+    return 1;
+  }
+
+  BamCache cache;
+  cache.set_content_addressed(true);
+  cache.set_cache_max_kbytes(0);
+  cache.set_root(cache_dir);
+
+  bool ok = true;
+
+  // The same scene, cached for two different source files, should
+  // be stored only once.
+  Filename source_a = make_source(dirname, "a.egg", "a");
+  Filename source_b = make_source(dirname, "b.egg", "b");
+  PT(PandaNode) scene = make_scene(1);
+  if (!store_scene(cache, source_a, scene) ||
+      !store_scene(cache, source_b, scene)) {
+    nout << "Unable to store the scene.\n";
+    return 1;
+  }
+  streamsize content_size = 0;
+  if (count_files(content_dir, content_size) != 1 ||
+      cache.get_num_shared_stores() != 1) {
+    nout << "  The identical scenes were not stored only once!\n";
+    ok = false;
+  }
+
+  cache.reset_stats();
+  if (lookup_scene(cache, source_a) != num_leaves ||
+      lookup_scene(cache, source_b) != num_leaves ||
+      cache.get_num_hits() != 2) {
+    nout << "  The cached scenes were not found!\n";
+    ok = false;
+  }
+
+  // Once the source file changes, its cached scene is stale.
+  make_source(dirname, "a.egg", "a modified");
+  if (lookup_scene(cache, source_a) != -1 || cache.get_num_misses() != 1) {
+    nout << "  A stale scene was returned!\n";
+    ok = false;
+  }
+
+  // Many threads can read the cache at once.
+  pvector< PT(LookupThread) > threads;
+  for (int i = 0; i < num_threads; ++i) {
+    PT(LookupThread) thread = new LookupThread(&cache, source_b);
+    threads.push_back(thread);
+    thread->start(TP_normal, true);
+  }
+  for (int i = 0; i < num_threads; ++i) {
+    threads[i]->join();
+    if (threads[i]->_num_found != num_lookups) {
+      nout << "  Only " << threads[i]->_num_found << " of " << num_lookups
+           << " lookups in a thread found the scene!\n";
+      ok = false;
+    }
+  }
+
+  // Now store a number of different scenes under a small size limit.
+  // The oldest files should be removed to make room.
+  int max_kbytes = (int)(content_size * 4 / 1024) + 1;
+  cache.set_cache_max_kbytes(max_kbytes);
+  for (int i = 0; i < 10; ++i) {
+    ostringstream strm;
+    strm << "scene" << i << ".egg";
+    Filename source = make_source(dirname, strm.str(), strm.str());
+    PT(PandaNode) scene = make_scene(i + 2);
+    if (!store_scene(cache, source, scene)) {
+      nout << "Unable to store " << source << ".\n";
+      return 1;
+    }
+  }
+  streamsize total_size = 0;
+  count_files(cache_dir, total_size);
+  count_files(content_dir, total_size);
+  if (cache.get_num_evictions() == 0 || total_size / 1024 > max_kbytes) {
+    nout << "  " << total_size << " bytes remain in the cache, with a limit of "
+         << max_kbytes << "K!\n";
+    ok = false;
+  }
+
+  cache.write_stats(nout);
+
+  delete_tree(dirname);
+  return ok ? 0 : 1;
+}
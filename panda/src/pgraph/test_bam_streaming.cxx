@@ -0,0 +1,247 @@
+// Filename: test_bam_streaming.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pandabase.h"
+#include "config_pgraph.h"
+#include "bamReader.h"
+#include "bamReaderCallbackData.h"
+#include "bamWriter.h"
+#include "datagramInputFile.h"
+#include "datagramOutputFile.h"
+#include "callbackObject.h"
+#include "pandaNode.h"
+#include "nodePath.h"
+#include "trueClock.h"
+#include "randomizer.h"
+#include "memoryUsage.h"
+
+// This program writes a large scene graph to an in-memory bam stream,
+// and reads it back twice: once in the normal way, and once with
+// BamReader::set_streaming() enabled.  For each, it reports the total
+// read time, the time until the first complete node is available to
+// the caller, the peak number of objects the BamReader held waiting
+// for their pointers to be resolved, and the peak heap memory
+// allocated during the read, as reported by MemoryUsage.  It also
+// checks that both reads produce the same scene, and that in
+// streaming mode the BamReader no longer holds a reference to the
+// nodes it has handed over.
+
+static const int num_groups = 200;
+static const int num_leaves = 100;
+static const int num_colors = 50;
+
+// A DatagramGenerator that passes through the datagrams of another
+// one, while keeping track of how many objects the BamReader is
+// holding unresolved, and of the most heap memory in use.
+class SamplingGenerator : public DatagramGenerator {
+public:
+  SamplingGenerator(DatagramGenerator *source) :
+    _source(source), _reader(NULL), _peak_unresolved(0),
+    _peak_heap(MemoryUsage::get_total_size()) { }
+
+  virtual bool get_datagram(Datagram &data) {
+    if (_reader != (BamReader *)NULL) {
+      _peak_unresolved = max(_peak_unresolved, _reader->get_num_unresolved_objects());
+    }
+    _peak_heap = max(_peak_heap, MemoryUsage::get_total_size());
+    return _source->get_datagram(data);
+  }
+  virtual bool is_eof() { return _source->is_eof(); }
+  virtual bool is_error() { return _source->is_error(); }
+
+  DatagramGenerator *_source;
+  BamReader *_reader;
+  int _peak_unresolved;
+  size_t _peak_heap;
+};
+
+// The ready callback, which notes the time at which the first
+// PandaNode is handed over.
+class ReadyCallback : public CallbackObject {
+public:
+  ReadyCallback(double start) :
+    _start(start), _first_node_ms(-1.0), _num_nodes(0) { }
+  ALLOC_DELETED_CHAIN(ReadyCallback);
+
+  virtual void do_callback(CallbackData *cbdata) {
+    BamReaderCallbackData *data = DCAST(BamReaderCallbackData, cbdata);
+    TypedWritable *object = data->get_object();
+    if (object != (TypedWritable *)NULL &&
+        object->is_of_type(PandaNode::get_class_type())) {
+      if (_num_nodes == 0) {
+        _first_node_ms = (TrueClock::get_global_ptr()->get_short_time() - _start) * 1000.0;
+      }
+      ++_num_nodes;
+    }
+  }
+
+  double _start;
+  double _first_node_ms;
+  int _num_nodes;
+};
+
+// Makes a two-level scene graph, with a transform on every leaf and
+// a color shared among many leaves.
+static PT(PandaNode)
+make_scene(Randomizer &random) {
+  PT(PandaNode) root = new PandaNode("root");
+  NodePath root_np(root);
+  for (int gi = 0; gi < num_groups; ++gi) {
+    NodePath group = root_np.attach_new_node("group");
+    for (int li = 0; li < num_leaves; ++li) {
+      NodePath leaf = group.attach_new_node("leaf");
+      leaf.set_pos(random.random_real(100.0), random.random_real(100.0),
+                   random.random_real(100.0));
+      int ci = random.random_int(num_colors);
+      leaf.set_color(ci / (PN_stdfloat)num_colors, 0.5f, 0.5f, 1.0f);
+    }
+  }
+  return root;
+}
+
+// Reads the scene back from the indicated bam data, and returns it.
+// Fills in the timing and bookkeeping statistics, including the
+// reference count of the first leaf while the BamReader still
+// exists.
+static PT(PandaNode)
+read_scene(const string &bam_data, bool streaming, double &total_ms,
+           double &first_node_ms, int &peak_unresolved, int &num_ready,
+           size_t &peak_heap, int &leaf_ref_count) {
+  istringstream in(bam_data);
+  DatagramInputFile din;
+  din.open(in);
+  size_t base_heap = MemoryUsage::get_total_size();
+  SamplingGenerator source(&din);
+
+  TrueClock *true_clock = TrueClock::get_global_ptr();
+  double start = true_clock->get_short_time();
+
+  BamReader reader(&source);
+  source._reader = &reader;
+  if (!reader.init()) {
+    return NULL;
+  }
+
+  PT(ReadyCallback) callback = new ReadyCallback(start);
+  reader.set_streaming(streaming);
+  reader.set_ready_callback(callback);
+
+  TypedWritable *object;
+  ReferenceCount *ref_ptr;
+  if (!reader.read_object(object, ref_ptr) || !reader.resolve()) {
+    return NULL;
+  }
+  PT(PandaNode) root = DCAST(PandaNode, object);
+
+  total_ms = (true_clock->get_short_time() - start) * 1000.0;
+  first_node_ms = streaming ? callback->_first_node_ms : total_ms;
+  peak_unresolved = source._peak_unresolved;
+  num_ready = callback->_num_nodes;
+  peak_heap = max(source._peak_heap, MemoryUsage::get_total_size()) - base_heap;
+  leaf_ref_count = root->get_child(0)->get_child(0)->get_ref_count();
+  return root;
+}
+
+// Returns true if the two scenes have the same structure, with the
+// same transforms and states on each node.
+static bool
+compare_scenes(const NodePath &a, const NodePath &b) {
+  if (a.get_name() != b.get_name() ||
+      a.get_transform() != b.get_transform() ||
+      a.get_state() != b.get_state() ||
+      a.get_num_children() != b.get_num_children()) {
+    return false;
+  }
+  for (int i = 0; i < a.get_num_children(); ++i) {
+    if (!compare_scenes(a.get_child(i), b.get_child(i))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int
+main(int argc, char *argv[]) {
+  init_libpgraph();
+
+  Randomizer random(1);
+  PT(PandaNode) scene = make_scene(random);
+
+  ostringstream out;
+  {
+    DatagramOutputFile dout;
+    dout.open(out);
+    BamWriter writer(&dout);
+    if (!writer.init() || !writer.write_object(scene)) {
+      nout << "Unable to write the scene.\n";
+      return 1;
+    }
+  }
+  string bam_data = out.str();
+
+  int num_nodes = 1 + num_groups + num_groups * num_leaves;
+  nout << num_nodes << " nodes, " << bam_data.size() << " bytes:\n";
+
+  double total_ms, first_node_ms;
+  int peak_unresolved, num_ready;
+  size_t peak_heap;
+  int normal_leaf_refs, streamed_leaf_refs;
+
+  PT(PandaNode) normal = read_scene(bam_data, false, total_ms, first_node_ms,
+                                    peak_unresolved, num_ready, peak_heap,
+                                    normal_leaf_refs);
+  if (normal == (PandaNode *)NULL) {
+    nout << "Unable to read the scene.\n";
+    return 1;
+  }
+  nout << "  normal: " << total_ms << " ms total, "
+       << first_node_ms << " ms to first node, "
+       << peak_unresolved << " objects unresolved at peak, "
+       << peak_heap / 1024 << " KB peak heap\n";
+
+  PT(PandaNode) streamed = read_scene(bam_data, true, total_ms, first_node_ms,
+                                      peak_unresolved, num_ready, peak_heap,
+                                      streamed_leaf_refs);
+  if (streamed == (PandaNode *)NULL) {
+    nout << "Unable to read the scene in streaming mode.\n";
+    return 1;
+  }
+  nout << "  streaming: " << total_ms << " ms total, "
+       << first_node_ms << " ms to first node, "
+       << peak_unresolved << " objects unresolved at peak, "
+       << peak_heap / 1024 << " KB peak heap, "
+       << num_ready << " nodes handed over early\n";
+
+  bool ok = true;
+  if (!compare_scenes(NodePath(normal), NodePath(streamed))) {
+    nout << "  The scenes differ!\n";
+    ok = false;
+  }
+
+  // Every node should have been handed over, including the root,
+  // which its children refer back to.
+  if (num_ready != num_nodes) {
+    nout << "  Expected " << num_nodes << " nodes handed over.\n";
+    ok = false;
+  }
+
+  // The streaming reader should have let go of the nodes it handed
+  // over, rather than holding them until it is destroyed.
+  if (streamed_leaf_refs >= normal_leaf_refs) {
+    nout << "  The streaming reader still holds a reference to each node.\n";
+    ok = false;
+  }
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+// Filename: test_compose_threads.cxx
+// Created by:  agent (17Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pandabase.h"
+#include "transformState.h"
+#include "renderState.h"
+#include "colorAttrib.h"
+#include "colorScaleAttrib.h"
+#include "thread.h"
+#include "trueClock.h"
+#include "randomizer.h"
+#include "load_prc_file.h"
+
+// This program measures how well TransformState and RenderState
+// creation and composition scale with the number of threads doing it
+// at once.  Each thread repeatedly builds short chains of transforms
+// and states, drawn from a palette large enough that many of them are
+// new (and must be interned) and many are already in the cache.  See
+// state-table-shards.
+//
+// Usage: test_compose_threads [max-threads [garbage-collect-states]]
+// The second argument is 0 or 1, so that both ways of releasing
+// states from the cache can be measured.
+
+static const int num_iterations = 20000;
+static const int palette_size = 500;
+
+class ComposeThread : public Thread {
+public:
+  ComposeThread(int seed) :
+    Thread("compose", "compose"),
+    _seed(seed) {}
+
+  virtual void thread_main() {
+    Randomizer random(_seed);
+    for (int i = 0; i < num_iterations; ++i) {
+      CPT(TransformState) transform = TransformState::make_identity();
+      CPT(RenderState) state = RenderState::make_empty();
+      for (int j = 0; j < 4; ++j) {
+        int p = random.random_int(palette_size);
+        transform = transform->compose
+          (TransformState::make_pos_hpr(LVecBase3(p, 0, j),
+                                        LVecBase3(0, 0, p % 90)));
+
+        PN_stdfloat c = (PN_stdfloat)p / (PN_stdfloat)palette_size;
+        if (j & 1) {
+          state = state->compose
+            (RenderState::make(ColorAttrib::make_flat(LColor(c, 1, 1, 1))));
+        } else {
+          state = state->compose
+            (RenderState::make(ColorScaleAttrib::make(LVecBase4(1, c, 1, 1))));
+        }
+      }
+      transform->invert_compose(TransformState::make_pos(LVecBase3(i % palette_size, 0, 0)));
+    }
+  }
+
+private:
+  int _seed;
+};
+
+static double
+run(int num_threads) {
+  typedef pvector< PT(ComposeThread) > Threads;
+  Threads threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.push_back(new ComposeThread(i + 1));
+  }
+
+  TrueClock *clock = TrueClock::get_global_ptr();
+  double start = clock->get_short_time();
+
+  Threads::iterator ti;
+  for (ti = threads.begin(); ti != threads.end(); ++ti) {
+    (*ti)->start(TP_normal, true);
+  }
+  for (ti = threads.begin(); ti != threads.end(); ++ti) {
+    (*ti)->join();
+  }
+
+  double elapsed = clock->get_short_time() - start;
+
+  // Clean up between runs, so each one starts with an empty cache.
+  TransformState::clear_cache();
+  RenderState::clear_cache();
+  TransformState::garbage_collect();
+  RenderState::garbage_collect();
+
+  return elapsed;
+}
+
+int
+main(int argc, char *argv[]) {
+  int max_threads = 8;
+  if (argc > 1) {
+    max_threads = atoi(argv[1]);
+  }
+  if (argc > 2) {
+    load_prc_file_data("", string("garbage-collect-states ") + argv[2]);
+  }
+  if (!Thread::is_threading_supported()) {
+    nout << "Threading support is not compiled in; results will not scale.\n";
+  }
+
+  for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+    double elapsed = run(num_threads);
+    double ops = (double)num_threads * num_iterations / elapsed;
+    nout << num_threads << " threads: " << elapsed * 1000.0 << " ms, "
+         << ops << " chains per second, "
+         << TransformState::get_num_states() << " transforms, "
+         << RenderState::get_num_states() << " states left\n";
+  }
+
+  if (!TransformState::validate_states() || !RenderState::validate_states()) {
+    nout << "State tables are invalid!\n";
+    return 1;
+  }
+
+  Thread::prepare_for_exit();
+  return 0;
+}
@@ -0,0 +1,183 @@
+// Filename: test_file_prefetch.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pandabase.h"
+#include "loader.h"
+#include "virtualFileSystem.h"
+#include "filename.h"
+#include "trueClock.h"
+#include "randomizer.h"
+
+// This program writes a set of compressed files into a temporary
+// directory, and then reads them back twice: once synchronously, one
+// at a time, and once after handing the list to
+// Loader::prefetch_files(), which reads and decompresses them on the
+// prefetch threads.  It reports the time for each, and checks that
+// the prefetched data is identical, that the cache is emptied as the
+// files are read, that vfs-prefetch-limit is respected, and that a
+// file that is rewritten, either after it was prefetched or while it
+// was being read, is not served stale from the cache.
+
+static const int num_files = 32;
+static const int file_size = 2 * 1024 * 1024;
+
+// Fills data with bytes that compress moderately well, so that
+// decompression takes a realistic amount of time.
+static void
+make_data(Randomizer &random, pvector<unsigned char> &data) {
+  data.resize(file_size);
+  for (int i = 0; i < file_size; ++i) {
+    data[i] = (unsigned char)(random.random_int(16) + (i / 4096) % 64);
+  }
+}
+
+// Reads all of the files, and returns the number of milliseconds
+// taken.  Returns -1 if any of them does not match its original
+// contents.
+static double
+read_all(VirtualFileSystem *vfs, const pvector<Filename> &filenames,
+         const pvector<pvector<unsigned char> > &contents) {
+  TrueClock *true_clock = TrueClock::get_global_ptr();
+  double start = true_clock->get_short_time();
+
+  bool ok = true;
+  for (int i = 0; i < num_files; ++i) {
+    pvector<unsigned char> data;
+    if (!vfs->read_file(filenames[i], data, true) || data != contents[i]) {
+      nout << "  " << filenames[i] << " does not match!\n";
+      ok = false;
+    }
+  }
+
+  double elapsed = (true_clock->get_short_time() - start) * 1000.0;
+  return ok ? elapsed : -1.0;
+}
+
+int
+main(int argc, char *argv[]) {
+  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+  Loader *loader = Loader::get_global_ptr();
+  TrueClock *true_clock = TrueClock::get_global_ptr();
+
+  Filename dirname = Filename::temporary("", "prefetch");
+  if (!vfs->make_directory(dirname)) {
+    nout << "Unable to create " << dirname << "\n";
+    return 1;
+  }
+
+  Randomizer random(1);
+  pvector<Filename> filenames;
+  pvector<pvector<unsigned char> > contents(num_files);
+  for (int i = 0; i < num_files; ++i) {
+    ostringstream strm;
+    strm << "file" << i << ".bin.pz";
+    Filename filename(dirname, strm.str());
+    filename.set_binary();
+    make_data(random, contents[i]);
+    if (!vfs->write_file(filename, &contents[i][0], contents[i].size(), true)) {
+      nout << "Unable to write " << filename << "\n";
+      return 1;
+    }
+    filenames.push_back(filename);
+  }
+
+  bool ok = true;
+
+  double sync_ms = read_all(vfs, filenames, contents);
+  nout << num_files << " files of " << file_size << " bytes: "
+       << sync_ms << " ms to read synchronously\n";
+
+  // Make sure everything fits for the timing run.
+  vfs->vfs_prefetch_limit.set_value((PN_int64)num_files * file_size);
+
+  double start = true_clock->get_short_time();
+  loader->prefetch_files(filenames);
+  loader->wait_for_prefetch();
+  double prefetch_ms = (true_clock->get_short_time() - start) * 1000.0;
+
+  if (vfs->get_num_prefetched_files() != num_files ||
+      !vfs->is_prefetched(filenames[0])) {
+    nout << "  only " << vfs->get_num_prefetched_files()
+         << " files were prefetched!\n";
+    ok = false;
+  }
+
+  double cached_ms = read_all(vfs, filenames, contents);
+  nout << "  " << prefetch_ms << " ms to prefetch, then " << cached_ms
+       << " ms to read, " << sync_ms / (prefetch_ms + cached_ms) << "x\n";
+  if (cached_ms < 0.0 || sync_ms < 0.0) {
+    ok = false;
+  }
+
+  if (vfs->get_num_prefetched_files() != 0 || vfs->get_prefetch_size() != 0) {
+    nout << "  the cache was not emptied by reading the files!\n";
+    ok = false;
+  }
+
+  // Now allow only three files' worth; the rest should be turned away,
+  // and read from disk in the usual way.
+  size_t limit = 3 * file_size;
+  vfs->vfs_prefetch_limit.set_value((PN_int64)limit);
+  loader->prefetch_files(filenames);
+  loader->wait_for_prefetch();
+  if (vfs->get_num_prefetched_files() != 3 || vfs->get_prefetch_size() > limit) {
+    nout << "  " << vfs->get_num_prefetched_files() << " files, "
+         << vfs->get_prefetch_size() << " bytes prefetched with a limit of "
+         << limit << "!\n";
+    ok = false;
+  }
+  if (read_all(vfs, filenames, contents) < 0.0) {
+    ok = false;
+  }
+
+  // A file that is modified after it has been prefetched must not be
+  // returned from the cache.
+  loader->prefetch_files(filenames);
+  loader->wait_for_prefetch();
+  make_data(random, contents[0]);
+  vfs->write_file(filenames[0], &contents[0][0], contents[0].size(), true);
+  if (vfs->is_prefetched(filenames[0])) {
+    nout << "  a rewritten file is still in the cache!\n";
+    ok = false;
+  }
+  if (read_all(vfs, filenames, contents) < 0.0) {
+    ok = false;
+  }
+
+  // Nor must a file that is written while a prefetch is reading it.
+  // This does by hand what VirtualFileSimple::prefetch() does, with
+  // the write landing between the read and the store.
+  Filename name = vfs->get_file(filenames[1])->get_filename();
+  unsigned int write_seq = vfs->begin_prefetch(name);
+  unsigned int mount_seq = vfs->get_mount_seq();
+  pvector<unsigned char> stale = contents[1];
+  make_data(random, contents[1]);
+  vfs->write_file(filenames[1], &contents[1][0], contents[1].size(), true);
+  if (vfs->store_prefetched_file(name, true, mount_seq, write_seq, stale) ||
+      vfs->is_prefetched(filenames[1])) {
+    nout << "  a file written during its prefetch is in the cache!\n";
+    ok = false;
+  }
+  if (read_all(vfs, filenames, contents) < 0.0) {
+    ok = false;
+  }
+
+  vfs->clear_prefetch_cache();
+  for (int i = 0; i < num_files; ++i) {
+    vfs->delete_file(filenames[i]);
+  }
+  vfs->delete_file(dirname);
+
+  return ok ? 0 : 1;
+}
@@ -27,12 +27,15 @@
 #include "py_panda.h"
 
 LightReMutex *TransformState::_states_lock = NULL;
-TransformState::States *TransformState::_states = NULL;
+TransformState::StateShard *TransformState::_shards = NULL;
+int TransformState::_num_shards = 0;
 CPT(TransformState) TransformState::_identity_state;
 CPT(TransformState) TransformState::_invalid_state;
 UpdateSeq TransformState::_last_cycle_detect;
-int TransformState::_garbage_index = 0;
 bool TransformState::_uniquify_matrix = true;
+AtomicAdjust::Integer TransformState::_cache_clock = 0;
+int TransformState::_cache_hand_shard = 0;
+int TransformState::_cache_hand_index = 0;
 
 PStatCollector TransformState::_cache_update_pcollector("*:State Cache:Update");
 PStatCollector TransformState::_garbage_collect_pcollector("*:State Cache:Garbage Collect");
@@ -59,7 +62,7 @@ TypeHandle TransformState::_type_handle;
 ////////////////////////////////////////////////////////////////////
 TransformState::
 TransformState() : _lock("TransformState") {
-  if (_states == (States *)NULL) {
+  if (_shards == (StateShard *)NULL) {
     init_states();
   }
   _saved_entry = -1;
@@ -679,11 +682,16 @@ compose(const TransformState *other) const {
   // Is this composition already cached?
   CPT(TransformState) result;
   {
-    LightReMutexHolder holder(*_states_lock);
+    // Our shard's lock is enough to read our cache, and to stamp the
+    // entry; see _states_lock.
+    LightReMutexHolder holder(get_shard(this)._lock);
     int index = _composition_cache.find(other);
     if (index != -1) {
-      const Composition &comp = _composition_cache.get_data(index);
+      Composition &comp = ((TransformState *)this)->_composition_cache.modify_data(index);
       result = comp._result;
+      if (result != (TransformState *)NULL) {
+        comp._last_use = (unsigned int)AtomicAdjust::get(_cache_clock);
+      }
     }
     if (result != (TransformState *)NULL) {
       _cache_stats.inc_hits();
@@ -746,15 +754,18 @@ invert_compose(const TransformState *other) const {
     return do_invert_compose(other);
   }
 
-  LightReMutexHolder holder(*_states_lock);
-
   CPT(TransformState) result;
   {
-    LightReMutexHolder holder(*_states_lock);
+    // Our shard's lock is enough to read our cache, and to stamp the
+    // entry; see _states_lock.
+    LightReMutexHolder holder(get_shard(this)._lock);
     int index = _invert_composition_cache.find(other);
     if (index != -1) {
-      const Composition &comp = _invert_composition_cache.get_data(index);
+      Composition &comp = ((TransformState *)this)->_invert_composition_cache.modify_data(index);
       result = comp._result;
+      if (result != (TransformState *)NULL) {
+        comp._last_use = (unsigned int)AtomicAdjust::get(_cache_clock);
+      }
     }
     if (result != (TransformState *)NULL) {
       _cache_stats.inc_hits();
@@ -798,13 +809,29 @@ unref() const {
   // without garbage collection in effect.  In this case we will pull
   // the object out of the cache when its reference count goes to 0.
 
-  // We always have to grab the lock, since we will definitely need to
-  // be holding it if we happen to drop the reference count to 0.
-  // Having to grab the lock at every call to unref() is a big
-  // limiting factor on parallelization.
+  // We need to be holding the lock if we happen to drop the reference
+  // count to 0, or to leave only the references held by the cache,
+  // since then we must check for a cycle.  Otherwise, we can drop the
+  // reference without the lock, as long as no other thread changes
+  // the count before we do.  We allow one reference of slack in the
+  // cache count, since the thread holding the lock may be partway
+  // through cache_ref() or cache_unref(), which adjust the two counts
+  // one after the other.
+  bool check_cycles = (auto_break_cycles && uniquify_transforms);
+  while (true) {
+    int ref_count = get_ref_count();
+    int min_count = check_cycles ? get_cache_ref_count() + 2 : 1;
+    if (ref_count <= min_count) {
+      break;
+    }
+    if (try_unref(ref_count)) {
+      return true;
+    }
+  }
+
   LightReMutexHolder holder(*_states_lock);
 
-  if (auto_break_cycles && uniquify_transforms) {
+  if (check_cycles) {
     if (get_cache_ref_count() > 0 &&
         get_ref_count() == get_cache_ref_count() + 1) {
       // If we are about to remove the one reference that is not in the
@@ -815,15 +842,32 @@ unref() const {
     }
   }
 
-  if (ReferenceCount::unref()) {
+  // If we are in the global object pool, return_unique() may find us
+  // and ref us at any moment while holding only our shard's lock, so
+  // we need to hold that lock too while we drop the reference count.
+  LightReMutex *shard_lock = NULL;
+  if (_saved_entry != -1) {
+    shard_lock = &get_shard(this)._lock;
+    shard_lock->acquire();
+  }
+
+  bool still_referenced = ReferenceCount::unref();
+  if (!still_referenced) {
+    // The reference count has just reached zero.  Make sure the
+    // object is removed from the global object pool, before anyone
+    // else finds it and tries to ref it.
+    ((TransformState *)this)->release_new();
+  }
+
+  if (shard_lock != (LightReMutex *)NULL) {
+    shard_lock->release();
+  }
+
+  if (still_referenced) {
     // The reference count is still nonzero.
     return true;
   }
 
-  // The reference count has just reached zero.  Make sure the object
-  // is removed from the global object pool, before anyone else finds
-  // it and tries to ref it.
-  ((TransformState *)this)->release_new();
   ((TransformState *)this)->remove_cache_pointers();
 
   return false;
@@ -1014,11 +1058,16 @@ write_composition_cache(ostream &out, int indent_level) const {
 ////////////////////////////////////////////////////////////////////
 int TransformState::
 get_num_states() {
-  if (_states == (States *)NULL) {
+  if (_shards == (StateShard *)NULL) {
     return 0;
   }
-  LightReMutexHolder holder(*_states_lock);
-  return _states->get_num_entries();
+  int num_states = 0;
+  for (int i = 0; i < _num_shards; ++i) {
+    StateShard &shard = _shards[i];
+    LightReMutexHolder shard_holder(shard._lock);
+    num_states += shard._states.get_num_entries();
+  }
+  return num_states;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -1041,7 +1090,7 @@ get_num_states() {
 ////////////////////////////////////////////////////////////////////
 int TransformState::
 get_num_unused_states() {
-  if (_states == (States *)NULL) {
+  if (_shards == (StateShard *)NULL) {
     return 0;
   }
   LightReMutexHolder holder(*_states_lock);
@@ -1052,40 +1101,45 @@ get_num_unused_states() {
   typedef pmap<const TransformState *, int> StateCount;
   StateCount state_count;
 
-  int size = _states->get_size();
-  for (int si = 0; si < size; ++si) {
-    if (!_states->has_element(si)) {
-      continue;
-    }
-    const TransformState *state = _states->get_key(si);
-
-    int i;
-    int cache_size = state->_composition_cache.get_size();
-    for (i = 0; i < cache_size; ++i) {
-      if (state->_composition_cache.has_element(i)) {
-        const TransformState *result = state->_composition_cache.get_data(i)._result;
-        if (result != (const TransformState *)NULL && result != state) {
-          // Here's a TransformState that's recorded in the cache.
-          // Count it.
-          pair<StateCount::iterator, bool> ir =
-            state_count.insert(StateCount::value_type(result, 1));
-          if (!ir.second) {
-            // If the above insert operation fails, then it's already in
-            // the cache; increment its value.
-            (*(ir.first)).second++;
+  for (int shi = 0; shi < _num_shards; ++shi) {
+    StateShard &shard = _shards[shi];
+    LightReMutexHolder shard_holder(shard._lock);
+
+    int size = shard._states.get_size();
+    for (int si = 0; si < size; ++si) {
+      if (!shard._states.has_element(si)) {
+        continue;
+      }
+      const TransformState *state = shard._states.get_key(si);
+
+      int i;
+      int cache_size = state->_composition_cache.get_size();
+      for (i = 0; i < cache_size; ++i) {
+        if (state->_composition_cache.has_element(i)) {
+          const TransformState *result = state->_composition_cache.get_data(i)._result;
+          if (result != (const TransformState *)NULL && result != state) {
+            // Here's a TransformState that's recorded in the cache.
+            // Count it.
+            pair<StateCount::iterator, bool> ir =
+              state_count.insert(StateCount::value_type(result, 1));
+            if (!ir.second) {
+              // If the above insert operation fails, then it's already in
+              // the cache; increment its value.
+              (*(ir.first)).second++;
+            }
           }
         }
       }
-    }
-    cache_size = state->_invert_composition_cache.get_size();
-    for (i = 0; i < cache_size; ++i) {
-      if (state->_invert_composition_cache.has_element(i)) {
-        const TransformState *result = state->_invert_composition_cache.get_data(i)._result;
-        if (result != (const TransformState *)NULL && result != state) {
-          pair<StateCount::iterator, bool> ir =
-            state_count.insert(StateCount::value_type(result, 1));
-          if (!ir.second) {
-            (*(ir.first)).second++;
+      cache_size = state->_invert_composition_cache.get_size();
+      for (i = 0; i < cache_size; ++i) {
+        if (state->_invert_composition_cache.has_element(i)) {
+          const TransformState *result = state->_invert_composition_cache.get_data(i)._result;
+          if (result != (const TransformState *)NULL && result != state) {
+            pair<StateCount::iterator, bool> ir =
+              state_count.insert(StateCount::value_type(result, 1));
+            if (!ir.second) {
+              (*(ir.first)).second++;
+            }
           }
         }
       }
@@ -1140,13 +1194,13 @@ get_num_unused_states() {
 ////////////////////////////////////////////////////////////////////
 int TransformState::
 clear_cache() {
-  if (_states == (States *)NULL) {
+  if (_shards == (StateShard *)NULL) {
     return 0;
   }
   LightReMutexHolder holder(*_states_lock);
 
   PStatTimer timer(_cache_update_pcollector);
-  int orig_size = _states->get_num_entries();
+  int orig_size = get_num_states();
 
   // First, we need to copy the entire set of states to a temporary
   // vector, reference-counting each object.  That way we can walk
@@ -1157,13 +1211,18 @@ clear_cache() {
     TempStates temp_states;
     temp_states.reserve(orig_size);
 
-    int size = _states->get_size();
-    for (int si = 0; si < size; ++si) {
-      if (!_states->has_element(si)) {
-        continue;
+    for (int shi = 0; shi < _num_shards; ++shi) {
+      StateShard &shard = _shards[shi];
+      LightReMutexHolder shard_holder(shard._lock);
+
+      int size = shard._states.get_size();
+      for (int si = 0; si < size; ++si) {
+        if (!shard._states.has_element(si)) {
+          continue;
+        }
+        const TransformState *state = shard._states.get_key(si);
+        temp_states.push_back(state);
       }
-      const TransformState *state = _states->get_key(si);
-      temp_states.push_back(state);
     }
 
     // Now it's safe to walk through the list, destroying the cache
@@ -1172,6 +1231,7 @@ clear_cache() {
     TempStates::iterator ti;
     for (ti = temp_states.begin(); ti != temp_states.end(); ++ti) {
       TransformState *state = (TransformState *)(*ti).p();
+      LightReMutexHolder state_holder(get_shard(state)._lock);
 
       int i;
       int cache_size = (int)state->_composition_cache.get_size();
@@ -1206,7 +1266,7 @@ clear_cache() {
     // held only within the various objects' caches will go away.
   }
 
-  int new_size = _states->get_num_entries();
+  int new_size = get_num_states();
   return orig_size - new_size;
 }
 
@@ -1222,61 +1282,22 @@ clear_cache() {
 ////////////////////////////////////////////////////////////////////
 int TransformState::
 garbage_collect() {
-  if (_states == (States *)NULL || !garbage_collect_states) {
+  if (_shards == (StateShard *)NULL || !garbage_collect_states) {
     return 0;
   }
   LightReMutexHolder holder(*_states_lock);
 
   PStatTimer timer(_garbage_collect_pcollector);
-  int orig_size = _states->get_num_entries();
 
-  // How many elements to process this pass?
-  int size = _states->get_size();
-  int num_this_pass = int(size * garbage_collect_states_rate);
-  if (num_this_pass <= 0) {
-    return 0;
+  // Each shard is collected in turn, holding only that shard's lock,
+  // so that other threads may continue to create transforms in the
+  // other shards meanwhile.
+  int num_states = 0;
+  for (int i = 0; i < _num_shards; ++i) {
+    num_states += _shards[i].garbage_collect();
   }
-  num_this_pass = min(num_this_pass, size);
-  int stop_at_element = (_garbage_index + num_this_pass) % size;
-
-  int num_elements = 0;
-  int si = _garbage_index;
-  do {
-    if (_states->has_element(si)) {
-      ++num_elements;
-      TransformState *state = (TransformState *)_states->get_key(si);
-      if (auto_break_cycles && uniquify_transforms) {
-        if (state->get_cache_ref_count() > 0 &&
-            state->get_ref_count() == state->get_cache_ref_count()) {
-          // If we have removed all the references to this state not in
-          // the cache, leaving only references in the cache, then we
-          // need to check for a cycle involving this TransformState and
-          // break it if it exists.
-          state->detect_and_break_cycles();
-        }
-      }
-
-      if (state->get_ref_count() == 1) {
-        // This state has recently been unreffed to 1 (the one we
-        // added when we stored it in the cache).  Now it's time to
-        // delete it.  This is safe, because we're holding the
-        // _states_lock, so it's not possible for some other thread to
-        // find the state in the cache and ref it while we're doing
-        // this.
-        state->release_new();
-        state->remove_cache_pointers();
-        state->cache_unref();
-        delete state;
-      }
-    }
-
-    si = (si + 1) % size;
-  } while (si != stop_at_element);
-  _garbage_index = si;
-  nassertr(_states->validate(), 0);
 
-  int new_size = _states->get_num_entries();
-  return orig_size - new_size;
+  return num_states;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -1299,7 +1320,7 @@ garbage_collect() {
 ////////////////////////////////////////////////////////////////////
 void TransformState::
 list_cycles(ostream &out) {
-  if (_states == (States *)NULL) {
+  if (_shards == (StateShard *)NULL) {
     return;
   }
   LightReMutexHolder holder(*_states_lock);
@@ -1308,63 +1329,68 @@ list_cycles(ostream &out) {
   VisitedStates visited;
   CompositionCycleDesc cycle_desc;
 
-  int size = _states->get_size();
-  for (int si = 0; si < size; ++si) {
-    if (!_states->has_element(si)) {
-      continue;
-    }
-    const TransformState *state = _states->get_key(si);
-
-    bool inserted = visited.insert(state).second;
-    if (inserted) {
-      ++_last_cycle_detect;
-      if (r_detect_cycles(state, state, 1, _last_cycle_detect, &cycle_desc)) {
-        // This state begins a cycle.
-        CompositionCycleDesc::reverse_iterator csi;
-
-        out << "\nCycle detected of length " << cycle_desc.size() + 1 << ":\n"
-            << "state " << (void *)state << ":" << state->get_ref_count()
-            << " =\n";
-        state->write(out, 2);
-        for (csi = cycle_desc.rbegin(); csi != cycle_desc.rend(); ++csi) {
-          const CompositionCycleDescEntry &entry = (*csi);
-          if (entry._inverted) {
-            out << "invert composed with ";
-          } else {
-            out << "composed with ";
-          }
-          out << (const void *)entry._obj << ":" << entry._obj->get_ref_count()
-              << " " << *entry._obj << "\n"
-              << "produces " << (const void *)entry._result << ":"
-              << entry._result->get_ref_count() << " =\n";
-          entry._result->write(out, 2);
-          visited.insert(entry._result);
-        }
+  for (int shi = 0; shi < _num_shards; ++shi) {
+    StateShard &shard = _shards[shi];
+    LightReMutexHolder shard_holder(shard._lock);
 
-        cycle_desc.clear();
-      } else {
+    int size = shard._states.get_size();
+    for (int si = 0; si < size; ++si) {
+      if (!shard._states.has_element(si)) {
+        continue;
+      }
+      const TransformState *state = shard._states.get_key(si);
+
+      bool inserted = visited.insert(state).second;
+      if (inserted) {
         ++_last_cycle_detect;
-        if (r_detect_reverse_cycles(state, state, 1, _last_cycle_detect, &cycle_desc)) {
+        if (r_detect_cycles(state, state, 1, _last_cycle_detect, &cycle_desc)) {
           // This state begins a cycle.
-          CompositionCycleDesc::iterator csi;
+          CompositionCycleDesc::reverse_iterator csi;
 
-          out << "\nReverse cycle detected of length " << cycle_desc.size() + 1 << ":\n"
-              << "state ";
-          for (csi = cycle_desc.begin(); csi != cycle_desc.end(); ++csi) {
+          out << "\nCycle detected of length " << cycle_desc.size() + 1 << ":\n"
+              << "state " << (void *)state << ":" << state->get_ref_count()
+              << " =\n";
+          state->write(out, 2);
+          for (csi = cycle_desc.rbegin(); csi != cycle_desc.rend(); ++csi) {
             const CompositionCycleDescEntry &entry = (*csi);
-            out << (const void *)entry._result << ":"
+            if (entry._inverted) {
+              out << "invert composed with ";
+            } else {
+              out << "composed with ";
+            }
+            out << (const void *)entry._obj << ":" << entry._obj->get_ref_count()
+                << " " << *entry._obj << "\n"
+                << "produces " << (const void *)entry._result << ":"
                 << entry._result->get_ref_count() << " =\n";
             entry._result->write(out, 2);
-            out << (const void *)entry._obj << ":"
-                << entry._obj->get_ref_count() << " =\n";
-            entry._obj->write(out, 2);
             visited.insert(entry._result);
           }
-          out << (void *)state << ":"
-              << state->get_ref_count() << " =\n";
-          state->write(out, 2);
 
           cycle_desc.clear();
+        } else {
+          ++_last_cycle_detect;
+          if (r_detect_reverse_cycles(state, state, 1, _last_cycle_detect, &cycle_desc)) {
+            // This state begins a cycle.
+            CompositionCycleDesc::iterator csi;
+
+            out << "\nReverse cycle detected of length " << cycle_desc.size() + 1 << ":\n"
+                << "state ";
+            for (csi = cycle_desc.begin(); csi != cycle_desc.end(); ++csi) {
+              const CompositionCycleDescEntry &entry = (*csi);
+              out << (const void *)entry._result << ":"
+                  << entry._result->get_ref_count() << " =\n";
+              entry._result->write(out, 2);
+              out << (const void *)entry._obj << ":"
+                  << entry._obj->get_ref_count() << " =\n";
+              entry._obj->write(out, 2);
+              visited.insert(entry._result);
+            }
+            out << (void *)state << ":"
+                << state->get_ref_count() << " =\n";
+            state->write(out, 2);
+
+            cycle_desc.clear();
+          }
         }
       }
     }
@@ -1381,21 +1407,26 @@ list_cycles(ostream &out) {
 ////////////////////////////////////////////////////////////////////
 void TransformState::
 list_states(ostream &out) {
-  if (_states == (States *)NULL) {
+  if (_shards == (StateShard *)NULL) {
     out << "0 states:\n";
     return;
   }
   LightReMutexHolder holder(*_states_lock);
 
-  out << _states->get_num_entries() << " states:\n";
+  out << get_num_states() << " states:\n";
 
-  int size = _states->get_size();
-  for (int si = 0; si < size; ++si) {
-    if (!_states->has_element(si)) {
-      continue;
+  for (int shi = 0; shi < _num_shards; ++shi) {
+    StateShard &shard = _shards[shi];
+    LightReMutexHolder shard_holder(shard._lock);
+
+    int size = shard._states.get_size();
+    for (int si = 0; si < size; ++si) {
+      if (!shard._states.has_element(si)) {
+        continue;
+      }
+      const TransformState *state = shard._states.get_key(si);
+      state->write(out, 2);
     }
-    const TransformState *state = _states->get_key(si);
-    state->write(out, 2);
   }
 }
 
@@ -1411,60 +1442,17 @@ list_states(ostream &out) {
 ////////////////////////////////////////////////////////////////////
 bool TransformState::
 validate_states() {
-  if (_states == (States *)NULL) {
+  if (_shards == (StateShard *)NULL) {
     return true;
   }
 
   PStatTimer timer(_transform_validate_pcollector);
 
   LightReMutexHolder holder(*_states_lock);
-  if (_states->is_empty()) {
-    return true;
-  }
-
-  if (!_states->validate()) {
-    pgraph_cat.error()
-      << "TransformState::_states cache is invalid!\n";
-    return false;
-  }
-
-  int size = _states->get_size();
-  int si = 0;
-  while (si < size && !_states->has_element(si)) {
-    ++si;
-  }
-  nassertr(si < size, false);
-  nassertr(_states->get_key(si)->get_ref_count() >= 0, false);
-  int snext = si;
-  ++snext;
-  while (snext < size && !_states->has_element(snext)) {
-    ++snext;
-  }
-  while (snext < size) {
-    nassertr(_states->get_key(snext)->get_ref_count() >= 0, false);
-    const TransformState *ssi = _states->get_key(si);
-    if (!ssi->validate_composition_cache()) {
-      return false;
-    }
-    const TransformState *ssnext = _states->get_key(snext);
-    bool c = (*ssi) == (*ssnext);
-    bool ci = (*ssnext) == (*ssi);
-    if (c != ci) {
-      pgraph_cat.error()
-        << "TransformState::operator == () not defined properly!\n";
-      pgraph_cat.error(false)
-        << "(a, b): " << c << "\n";
-      pgraph_cat.error(false)
-        << "(b, a): " << ci << "\n";
-      ssi->write(pgraph_cat.error(false), 2);
-      ssnext->write(pgraph_cat.error(false), 2);
+  for (int i = 0; i < _num_shards; ++i) {
+    if (!_shards[i].validate()) {
       return false;
     }
-    si = snext;
-    ++snext;
-    while (snext < size && !_states->has_element(snext)) {
-      ++snext;
-    }
   }
 
   return true;
@@ -1482,7 +1470,16 @@ validate_states() {
 ////////////////////////////////////////////////////////////////////
 void TransformState::
 init_states() {
-  _states = new States;
+  // This variable is declared here, rather than in config_pgraph, so
+  // that it is guaranteed to be constructed by the time we get here
+  // at static init time.  It is shared with RenderState.
+  ConfigVariableInt state_table_shards("state-table-shards", 16);
+
+  _num_shards = 1;
+  while (_num_shards < state_table_shards) {
+    _num_shards <<= 1;
+  }
+  _shards = new StateShard[_num_shards];
 
   ConfigVariableBool uniquify_matrix
   ("uniquify-matrix", true,
@@ -1506,6 +1503,141 @@ init_states() {
   nassertv(Thread::get_current_thread() == Thread::get_main_thread());
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: TransformState::StateShard::Constructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+TransformState::StateShard::
+StateShard() :
+  _lock("TransformState::StateShard"),
+  _garbage_index(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: TransformState::StateShard::garbage_collect
+//       Access: Public
+//  Description: Performs a garbage-collection pass over this shard of
+//               the global state table, and returns the number of
+//               states freed.  The caller must already be holding
+//               _states_lock.
+////////////////////////////////////////////////////////////////////
+int TransformState::StateShard::
+garbage_collect() {
+  nassertr(_states_lock->debug_is_locked(), 0);
+  LightReMutexHolder holder(_lock);
+
+  int orig_size = _states.get_num_entries();
+
+  // How many elements to process this pass?
+  int size = _states.get_size();
+  int num_this_pass = int(size * garbage_collect_states_rate);
+  if (num_this_pass <= 0) {
+    return 0;
+  }
+  num_this_pass = min(num_this_pass, size);
+  int stop_at_element = (_garbage_index + num_this_pass) % size;
+
+  int si = _garbage_index;
+  do {
+    if (_states.has_element(si)) {
+      TransformState *state = (TransformState *)_states.get_key(si);
+      if (auto_break_cycles && uniquify_transforms) {
+        if (state->get_cache_ref_count() > 0 &&
+            state->get_ref_count() == state->get_cache_ref_count()) {
+          // If we have removed all the references to this state not in
+          // the cache, leaving only references in the cache, then we
+          // need to check for a cycle involving this TransformState and
+          // break it if it exists.
+          state->detect_and_break_cycles();
+        }
+      }
+
+      if (state->get_ref_count() == 1) {
+        // This state has recently been unreffed to 1 (the one we
+        // added when we stored it in the cache).  Now it's time to
+        // delete it.  This is safe, because we're holding this
+        // shard's lock, so it's not possible for some other thread to
+        // find the state in the table and ref it while we're doing
+        // this.
+        state->release_new();
+        state->remove_cache_pointers();
+        state->cache_unref();
+        delete state;
+      }
+    }
+
+    si = (si + 1) % size;
+  } while (si != stop_at_element);
+  _garbage_index = si;
+  nassertr(_states.validate(), 0);
+
+  int new_size = _states.get_num_entries();
+  return orig_size - new_size;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: TransformState::StateShard::validate
+//       Access: Public
+//  Description: Does the work of validate_states() for this shard of
+//               the global state table.
+////////////////////////////////////////////////////////////////////
+bool TransformState::StateShard::
+validate() {
+  LightReMutexHolder holder(_lock);
+  if (_states.is_empty()) {
+    return true;
+  }
+
+  if (!_states.validate()) {
+    pgraph_cat.error()
+      << "TransformState::_states shard is invalid!\n";
+    return false;
+  }
+
+  int size = _states.get_size();
+  int si = 0;
+  while (si < size && !_states.has_element(si)) {
+    ++si;
+  }
+  nassertr(si < size, false);
+  nassertr(_states.get_key(si)->get_ref_count() >= 0, false);
+  int snext = si;
+  ++snext;
+  while (snext < size && !_states.has_element(snext)) {
+    ++snext;
+  }
+  while (snext < size) {
+    nassertr(_states.get_key(snext)->get_ref_count() >= 0, false);
+    const TransformState *ssi = _states.get_key(si);
+    if (!ssi->validate_composition_cache()) {
+      return false;
+    }
+    const TransformState *ssnext = _states.get_key(snext);
+    bool c = (*ssi) == (*ssnext);
+    bool ci = (*ssnext) == (*ssi);
+    if (c != ci) {
+      pgraph_cat.error()
+        << "TransformState::operator == () not defined properly!\n";
+      pgraph_cat.error(false)
+        << "(a, b): " << c << "\n";
+      pgraph_cat.error(false)
+        << "(b, a): " << ci << "\n";
+      ssi->write(pgraph_cat.error(false), 2);
+      ssnext->write(pgraph_cat.error(false), 2);
+      return false;
+    }
+    si = snext;
+    ++snext;
+    while (snext < size && !_states.has_element(snext)) {
+      ++snext;
+    }
+  }
+
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: TransformState::return_new
 //       Access: Private, Static
@@ -1554,22 +1686,26 @@ return_unique(TransformState *state) {
 
   PStatTimer timer(_transform_new_pcollector);
 
-  LightReMutexHolder holder(*_states_lock);
+  // Save the state in a local PointerTo so that it will be freed at
+  // the end of this function if no one else uses it.  This must be
+  // declared before the shard lock is grabbed, so that it is not
+  // destructed until after the lock has been released; the
+  // destructor grabs _states_lock.
+  CPT(TransformState) pt_state = state;
+
+  StateShard &shard = get_shard(state);
+  LightReMutexHolder holder(shard._lock);
 
   if (state->_saved_entry != -1) {
     // This state is already in the cache.
-    //nassertr(_states->find(state) == state->_saved_entry, state);
-    return state;
+    //nassertr(shard._states.find(state) == state->_saved_entry, state);
+    return pt_state;
   }
 
-  // Save the state in a local PointerTo so that it will be freed at
-  // the end of this function if no one else uses it.
-  CPT(TransformState) pt_state = state;
-
-  int si = _states->find(state);
+  int si = shard._states.find(state);
   if (si != -1) {
     // There's an equivalent state already in the set.  Return it.
-    return _states->get_key(si);
+    return shard._states.get_key(si);
   }
 
   // Not already in the set; add it.
@@ -1579,7 +1715,7 @@ return_unique(TransformState *state) {
     // that it won't be deleted while it's in it.
     state->cache_ref();
   }
-  si = _states->store(state, Empty());
+  si = shard._states.store(state, Empty());
 
   // Save the index and return the input state.
   state->_saved_entry = si;
@@ -1688,56 +1824,79 @@ store_compose(const TransformState *other, const TransformState *result) {
 
   LightReMutexHolder holder(*_states_lock);
 
-  // Is this composition already cached?
-  int index = _composition_cache.find(other);
-  if (index != -1) {
-    Composition &comp = _composition_cache.modify_data(index);
-    if (comp._result == (const TransformState *)NULL) {
-      // Well, it wasn't cached already, but we already had an entry
-      // (probably created for the reverse direction), so use the same
-      // entry to store the new result.
-      comp._result = result;
-
-      if (result != (const TransformState *)this) {
-        // See the comments below about the need to up the reference
-        // count only when the result is not the same as this.
-        result->cache_ref();
+  {
+    // We are about to modify both our cache and the other state's, so
+    // we need their shard locks too; see _states_lock.
+    LightReMutexHolder shard_holder(get_shard(this)._lock);
+    LightReMutexHolder other_shard_holder(get_shard(other)._lock);
+
+    // Is this composition already cached?
+    int index = _composition_cache.find(other);
+    if (index != -1) {
+      Composition &comp = _composition_cache.modify_data(index);
+      if (comp._result == (const TransformState *)NULL) {
+        // Well, it wasn't cached already, but we already had an entry
+        // (probably created for the reverse direction), so use the same
+        // entry to store the new result.
+        comp._result = result;
+        comp._last_use = advance_cache_clock();
+
+        if (result != (const TransformState *)this) {
+          // See the comments below about the need to up the reference
+          // count only when the result is not the same as this.
+          result->cache_ref();
+        }
       }
+      // Here's the cache!
+      _cache_stats.inc_hits();
+      return comp._result;
     }
-    // Here's the cache!
-    _cache_stats.inc_hits();
-    return comp._result;
-  }
-  _cache_stats.inc_misses();
+    _cache_stats.inc_misses();
 
-  // We need to make a new cache entry, both in this object and in the
-  // other object.  We make both records so the other TransformState
-  // object will know to delete the entry from this object when it
-  // destructs, and vice-versa.
+    // We need to make a new cache entry, both in this object and in the
+    // other object.  We make both records so the other TransformState
+    // object will know to delete the entry from this object when it
+    // destructs, and vice-versa.
 
-  // The cache entry in this object is the only one that indicates the
-  // result; the other will be NULL for now.
-  _cache_stats.add_total_size(1);
-  _cache_stats.inc_adds(_composition_cache.get_size() == 0);
+    // The cache entry in this object is the only one that indicates the
+    // result; the other will be NULL for now.
+    _cache_stats.add_total_size(1);
+    _cache_stats.inc_adds(_composition_cache.get_size() == 0);
 
-  _composition_cache[other]._result = result;
+    unsigned int now = advance_cache_clock();
+    Composition &comp = _composition_cache[other];
+    comp._result = result;
+    comp._last_use = now;
 
-  if (other != this) {
-    _cache_stats.add_total_size(1);
-    _cache_stats.inc_adds(other->_composition_cache.get_size() == 0);
-    ((TransformState *)other)->_composition_cache[this]._result = NULL;
-  }
+    if (other != this) {
+      _cache_stats.add_total_size(1);
+      _cache_stats.inc_adds(other->_composition_cache.get_size() == 0);
+      Composition &ocomp = ((TransformState *)other)->_composition_cache[this];
+      ocomp._result = NULL;
+      ocomp._last_use = now;
+    }
 
-  if (result != (TransformState *)this) {
-    // If the result of do_compose() is something other than this,
-    // explicitly increment the reference count.  We have to be sure
-    // to decrement it again later, when the composition entry is
-    // removed from the cache.
-    result->cache_ref();
+    if (result != (TransformState *)this) {
+      // If the result of do_compose() is something other than this,
+      // explicitly increment the reference count.  We have to be sure
+      // to decrement it again later, when the composition entry is
+      // removed from the cache.
+      result->cache_ref();
 
-    // (If the result was just this again, we still store the
-    // result, but we don't increment the reference count, since
-    // that would be a self-referential leak.)
+      // (If the result was just this again, we still store the
+      // result, but we don't increment the reference count, since
+      // that would be a self-referential leak.)
+    }
+  }
+
+  if (transform_cache_max_entries > 0) {
+    limit_cache(&TransformState::_composition_cache, transform_cache_max_entries);
+    if (other != this) {
+      ((TransformState *)other)->limit_cache(&TransformState::_composition_cache, transform_cache_max_entries);
+    }
+  }
+  if (transform_cache_budget > 0) {
+    enforce_cache_budget();
   }
 
   _cache_stats.maybe_report("TransformState");
@@ -1766,58 +1925,328 @@ store_invert_compose(const TransformState *other, const TransformState *result)
 
   LightReMutexHolder holder(*_states_lock);
 
-  // Is this composition already cached?
-  int index = _invert_composition_cache.find(other);
-  if (index != -1) {
-    Composition &comp = ((TransformState *)this)->_invert_composition_cache.modify_data(index);
-    if (comp._result == (const TransformState *)NULL) {
-      // Well, it wasn't cached already, but we already had an entry
-      // (probably created for the reverse direction), so use the same
-      // entry to store the new result.
-      comp._result = result;
-
-      if (result != (const TransformState *)this) {
-        // See the comments below about the need to up the reference
-        // count only when the result is not the same as this.
-        result->cache_ref();
+  {
+    // We are about to modify both our cache and the other state's, so
+    // we need their shard locks too; see _states_lock.
+    LightReMutexHolder shard_holder(get_shard(this)._lock);
+    LightReMutexHolder other_shard_holder(get_shard(other)._lock);
+
+    // Is this composition already cached?
+    int index = _invert_composition_cache.find(other);
+    if (index != -1) {
+      Composition &comp = ((TransformState *)this)->_invert_composition_cache.modify_data(index);
+      if (comp._result == (const TransformState *)NULL) {
+        // Well, it wasn't cached already, but we already had an entry
+        // (probably created for the reverse direction), so use the same
+        // entry to store the new result.
+        comp._result = result;
+        comp._last_use = advance_cache_clock();
+
+        if (result != (const TransformState *)this) {
+          // See the comments below about the need to up the reference
+          // count only when the result is not the same as this.
+          result->cache_ref();
+        }
+      }
+      // Here's the cache!
+      _cache_stats.inc_hits();
+      return comp._result;
+    }
+    _cache_stats.inc_misses();
+
+    // We need to make a new cache entry, both in this object and in the
+    // other object.  We make both records so the other TransformState
+    // object will know to delete the entry from this object when it
+    // destructs, and vice-versa.
+
+    // The cache entry in this object is the only one that indicates the
+    // result; the other will be NULL for now.
+    _cache_stats.add_total_size(1);
+    _cache_stats.inc_adds(_invert_composition_cache.get_size() == 0);
+
+    unsigned int now = advance_cache_clock();
+    Composition &comp = _invert_composition_cache[other];
+    comp._result = result;
+    comp._last_use = now;
+
+    if (other != this) {
+      _cache_stats.add_total_size(1);
+      _cache_stats.inc_adds(other->_invert_composition_cache.get_size() == 0);
+      Composition &ocomp = ((TransformState *)other)->_invert_composition_cache[this];
+      ocomp._result = NULL;
+      ocomp._last_use = now;
+    }
+
+    if (result != (TransformState *)this) {
+      // If the result of compose() is something other than this,
+      // explicitly increment the reference count.  We have to be sure
+      // to decrement it again later, when the composition entry is
+      // removed from the cache.
+      result->cache_ref();
+
+      // (If the result was just this again, we still store the
+      // result, but we don't increment the reference count, since
+      // that would be a self-referential leak.)
+    }
+  }
+
+  if (transform_cache_max_entries > 0) {
+    limit_cache(&TransformState::_invert_composition_cache, transform_cache_max_entries);
+    if (other != this) {
+      ((TransformState *)other)->limit_cache(&TransformState::_invert_composition_cache, transform_cache_max_entries);
+    }
+  }
+  if (transform_cache_budget > 0) {
+    enforce_cache_budget();
+  }
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: TransformState::find_cache_victim
+//       Access: Private
+//  Description: Chooses an entry of the indicated composition cache
+//               to evict, by sampling a handful of entries and
+//               returning the index of the one least recently used.
+//               The entry and its companion in the other state are
+//               considered together, since they are evicted together.
+//               Fills age with the number of cache operations since
+//               the chosen entry was last used.  Returns -1 if the
+//               cache is empty.
+//
+//               This is an approximation of true LRU, but it doesn't
+//               cost anything to maintain on a cache hit beyond
+//               stamping the entry.  _states_lock must be held.
+////////////////////////////////////////////////////////////////////
+int TransformState::
+find_cache_victim(CacheMember cache, unsigned int &age) const {
+  static const int num_samples = 5;
+
+  const CompositionCache &table = this->*cache;
+  if (table.is_empty()) {
+    return -1;
+  }
+
+  // Start sampling at a pseudo-random slot, so that we don't always
+  // favor the entries at the beginning of the table.
+  unsigned int now = (unsigned int)AtomicAdjust::get(_cache_clock);
+  int size = table.get_size();
+  int i = (int)((now * 2654435761U) % (unsigned int)size);
+
+  int best = -1;
+  int num_sampled = 0;
+  for (int n = 0; n < size && num_sampled < num_samples; ++n) {
+    if (table.has_element(i)) {
+      const TransformState *other = table.get_key(i);
+
+      // A cache hit may stamp _last_use while holding only the shard
+      // lock, so we need that lock to read it.
+      LightReMutexHolder shard_holder(get_shard(this)._lock);
+      unsigned int entry_age = now - table.get_data(i)._last_use;
+
+      if (other != this) {
+        LightReMutexHolder other_shard_holder(get_shard(other)._lock);
+        int oi = (other->*cache).find(this);
+        if (oi != -1) {
+          unsigned int other_age = now - (other->*cache).get_data(oi)._last_use;
+          entry_age = min(entry_age, other_age);
+        }
+      }
+
+      if (best == -1 || entry_age > age) {
+        best = i;
+        age = entry_age;
       }
+      ++num_sampled;
     }
-    // Here's the cache!
-    _cache_stats.inc_hits();
-    return comp._result;
+    i = (i + 1) % size;
   }
-  _cache_stats.inc_misses();
 
-  // We need to make a new cache entry, both in this object and in the
-  // other object.  We make both records so the other TransformState
-  // object will know to delete the entry from this object when it
-  // destructs, and vice-versa.
+  return best;
+}
 
-  // The cache entry in this object is the only one that indicates the
-  // result; the other will be NULL for now.
-  _cache_stats.add_total_size(1);
-  _cache_stats.inc_adds(_invert_composition_cache.get_size() == 0);
-  _invert_composition_cache[other]._result = result;
+////////////////////////////////////////////////////////////////////
+//     Function: TransformState::evict_cache_entry
+//       Access: Private
+//  Description: Removes the indicated entry from the indicated
+//               composition cache, along with its companion entry in
+//               the other state's cache, and releases the results
+//               they held.  _states_lock must be held.
+////////////////////////////////////////////////////////////////////
+void TransformState::
+evict_cache_entry(CacheMember cache, int index) {
+  nassertv(_states_lock->debug_is_locked());
 
-  if (other != this) {
-    _cache_stats.add_total_size(1);
-    _cache_stats.inc_adds(other->_invert_composition_cache.get_size() == 0);
-    ((TransformState *)other)->_invert_composition_cache[this]._result = NULL;
+  // As in remove_cache_pointers(), we must remove both entries before
+  // we let go of either result, since releasing a result may cause
+  // other TransformStates to destruct and modify these caches.
+  CompositionCache &table = this->*cache;
+  TransformState *other = (TransformState *)table.get_key(index);
+  const TransformState *result;
+  const TransformState *oresult = NULL;
+  {
+    LightReMutexHolder shard_holder(get_shard(this)._lock);
+    LightReMutexHolder other_shard_holder(get_shard(other)._lock);
+
+    result = table.get_data(index)._result;
+    table.remove_element(index);
+    _cache_stats.add_total_size(-1);
+    _cache_stats.inc_dels();
+    _cache_stats.inc_evictions();
+
+    if (other != this) {
+      CompositionCache &otable = other->*cache;
+      int oi = otable.find(this);
+      if (oi != -1) {
+        oresult = otable.get_data(oi)._result;
+        otable.remove_element(oi);
+        _cache_stats.add_total_size(-1);
+        _cache_stats.inc_dels();
+        _cache_stats.inc_evictions();
+      }
+    }
   }
 
-  if (result != (TransformState *)this) {
-    // If the result of compose() is something other than this,
-    // explicitly increment the reference count.  We have to be sure
-    // to decrement it again later, when the composition entry is
-    // removed from the cache.
-    result->cache_ref();
+  if (oresult != (const TransformState *)NULL && oresult != other) {
+    cache_unref_delete(oresult);
+  }
+  if (result != (const TransformState *)NULL && result != this) {
+    cache_unref_delete(result);
+  }
+}
 
-    // (If the result was just this again, we still store the
-    // result, but we don't increment the reference count, since
-    // that would be a self-referential leak.)
+////////////////////////////////////////////////////////////////////
+//     Function: TransformState::limit_cache
+//       Access: Private
+//  Description: Evicts entries from the indicated composition cache
+//               until it holds no more than max_entries.  See
+//               transform-cache-max-entries.  _states_lock must be
+//               held.
+////////////////////////////////////////////////////////////////////
+void TransformState::
+limit_cache(CacheMember cache, int max_entries) {
+  CompositionCache &table = this->*cache;
+  while ((int)table.get_num_entries() > max_entries) {
+    unsigned int age;
+    int index = find_cache_victim(cache, age);
+    nassertv(index != -1);
+    evict_cache_entry(cache, index);
   }
+}
 
-  return result;
+////////////////////////////////////////////////////////////////////
+//     Function: TransformState::enforce_cache_budget
+//       Access: Private, Static
+//  Description: Evicts composition cache entries, across all
+//               TransformStates, until the total number of entries
+//               is within transform-cache-budget.  Each eviction
+//               chooses the least recently used of several entries
+//               sampled from a few states, found by sweeping a hand
+//               around the global state table.  _states_lock must be
+//               held.
+////////////////////////////////////////////////////////////////////
+void TransformState::
+enforce_cache_budget() {
+  nassertv(_states_lock->debug_is_locked());
+
+  static const int max_candidates = 4;
+
+  // We bound the work done by any one call, in case the budget can't
+  // be met at all (for instance, because the states holding the
+  // entries aren't in the global table).  Since each pass evicts a
+  // pair of entries, and each store adds no more than that, this is
+  // plenty to keep up.
+  static const int max_passes = 16;
+
+  int budget = transform_cache_budget;
+  for (int pass = 0;
+       pass < max_passes && _cache_stats.get_total_size() > budget;
+       ++pass) {
+    CPT(TransformState) candidates[max_candidates];
+    int num_candidates = get_cache_candidates(candidates, max_candidates);
+    if (num_candidates == 0) {
+      return;
+    }
+
+    TransformState *victim = NULL;
+    CacheMember victim_cache = NULL;
+    int victim_index = -1;
+    unsigned int victim_age = 0;
+    for (int ci = 0; ci < num_candidates; ++ci) {
+      TransformState *state = (TransformState *)candidates[ci].p();
+      unsigned int age;
+      int index = state->find_cache_victim(&TransformState::_composition_cache, age);
+      if (index != -1 && (victim == NULL || age > victim_age)) {
+        victim = state;
+        victim_cache = &TransformState::_composition_cache;
+        victim_index = index;
+        victim_age = age;
+      }
+      index = state->find_cache_victim(&TransformState::_invert_composition_cache, age);
+      if (index != -1 && (victim == NULL || age > victim_age)) {
+        victim = state;
+        victim_cache = &TransformState::_invert_composition_cache;
+        victim_index = index;
+        victim_age = age;
+      }
+    }
+
+    if (victim != (TransformState *)NULL) {
+      victim->evict_cache_entry(victim_cache, victim_index);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: TransformState::get_cache_candidates
+//       Access: Private, Static
+//  Description: Advances the eviction hand around the global state
+//               table, filling candidates with up to max_candidates
+//               states that have something in their composition
+//               caches.  Returns the number of candidates found,
+//               which may be fewer if the hand doesn't turn them up
+//               within a reasonable number of slots.  _states_lock
+//               must be held.
+////////////////////////////////////////////////////////////////////
+int TransformState::
+get_cache_candidates(CPT(TransformState) candidates[], int max_candidates) {
+  static const int max_scan = 256;
+
+  int num_candidates = 0;
+  int num_scanned = 0;
+  while (num_candidates < max_candidates && num_scanned < max_scan) {
+    StateShard &shard = _shards[_cache_hand_shard];
+    {
+      // While we hold the shard's lock, every state in it is safe to
+      // ref; see unref().
+      LightReMutexHolder holder(shard._lock);
+      int size = shard._states.get_size();
+      while (_cache_hand_index < size &&
+             num_candidates < max_candidates && num_scanned < max_scan) {
+        if (shard._states.has_element(_cache_hand_index)) {
+          const TransformState *state = shard._states.get_key(_cache_hand_index);
+          if (!state->_composition_cache.is_empty() ||
+              !state->_invert_composition_cache.is_empty()) {
+            candidates[num_candidates] = state;
+            ++num_candidates;
+          }
+        }
+        ++_cache_hand_index;
+        ++num_scanned;
+      }
+      if (_cache_hand_index < size) {
+        continue;
+      }
+    }
+
+    // Move on to the next shard.
+    _cache_hand_index = 0;
+    _cache_hand_shard = (_cache_hand_shard + 1) % _num_shards;
+    ++num_scanned;
+  }
+
+  return num_candidates;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -2148,9 +2577,11 @@ release_new() {
   nassertv(_states_lock->debug_is_locked());
 
   if (_saved_entry != -1) {
-    //nassertv(_states->find(this) == _saved_entry);
-    _saved_entry = _states->find(this);
-    _states->remove_element(_saved_entry);
+    StateShard &shard = get_shard(this);
+    LightReMutexHolder holder(shard._lock);
+    //nassertv(shard._states.find(this) == _saved_entry);
+    _saved_entry = shard._states.find(this);
+    shard._states.remove_element(_saved_entry);
     _saved_entry = -1;
   }
 }
@@ -2212,40 +2643,48 @@ remove_cache_pointers() {
 
     // We hold a copy of the composition result so we can dereference
     // it later.
-    Composition comp = _composition_cache.get_data(i);
-
-    // Now we can remove the element from our cache.  We do this now,
-    // rather than later, before any other TransformState objects have
-    // had a chance to destruct, so we are confident that our iterator
-    // is still valid.
-    _composition_cache.remove_element(i);
-    _cache_stats.add_total_size(-1);
-    _cache_stats.inc_dels();
-
-    if (other != this) {
-      int oi = other->_composition_cache.find(this);
-
-      // We may or may not still be listed in the other's cache (it
-      // might be halfway through pulling entries out, from within its
-      // own destructor).
-      if (oi != -1) {
-        // Hold a copy of the other composition result, too.
-        Composition ocomp = other->_composition_cache.get_data(oi);
-
-        other->_composition_cache.remove_element(oi);
-        _cache_stats.add_total_size(-1);
-        _cache_stats.inc_dels();
-
-        // It's finally safe to let our held pointers go away.  This may
-        // have cascading effects as other TransformState objects are
-        // destructed, but there will be no harm done if they destruct
-        // now.
-        if (ocomp._result != (const TransformState *)NULL && ocomp._result != other) {
-          cache_unref_delete(ocomp._result);
+    Composition comp;
+    Composition ocomp;
+    {
+      // Other threads may be reading either cache while holding only
+      // its shard lock; see _states_lock.
+      LightReMutexHolder shard_holder(get_shard(this)._lock);
+      LightReMutexHolder other_shard_holder(get_shard(other)._lock);
+      comp = _composition_cache.get_data(i);
+
+      // Now we can remove the element from our cache.  We do this now,
+      // rather than later, before any other TransformState objects have
+      // had a chance to destruct, so we are confident that our iterator
+      // is still valid.
+      _composition_cache.remove_element(i);
+      _cache_stats.add_total_size(-1);
+      _cache_stats.inc_dels();
+
+      if (other != this) {
+        int oi = other->_composition_cache.find(this);
+
+        // We may or may not still be listed in the other's cache (it
+        // might be halfway through pulling entries out, from within its
+        // own destructor).
+        if (oi != -1) {
+          // Hold a copy of the other composition result, too.
+          ocomp = other->_composition_cache.get_data(oi);
+
+          other->_composition_cache.remove_element(oi);
+          _cache_stats.add_total_size(-1);
+          _cache_stats.inc_dels();
         }
       }
     }
 
+    // It's finally safe to let our held pointers go away.  This may
+    // have cascading effects as other TransformState objects are
+    // destructed, but there will be no harm done if they destruct
+    // now.
+    if (ocomp._result != (const TransformState *)NULL && ocomp._result != other) {
+      cache_unref_delete(ocomp._result);
+    }
+
     // It's finally safe to let our held pointers go away.  (See
     // comment above.)
     if (comp._result != (const TransformState *)NULL && comp._result != this) {
@@ -2262,22 +2701,28 @@ remove_cache_pointers() {
 
     TransformState *other = (TransformState *)_invert_composition_cache.get_key(i);
     nassertv(other != this);
-    Composition comp = _invert_composition_cache.get_data(i);
-    _invert_composition_cache.remove_element(i);
-    _cache_stats.add_total_size(-1);
-    _cache_stats.inc_dels();
-    if (other != this) {
-      int oi = other->_invert_composition_cache.find(this);
-      if (oi != -1) {
-        Composition ocomp = other->_invert_composition_cache.get_data(oi);
-        other->_invert_composition_cache.remove_element(oi);
-        _cache_stats.add_total_size(-1);
-        _cache_stats.inc_dels();
-        if (ocomp._result != (const TransformState *)NULL && ocomp._result != other) {
-          cache_unref_delete(ocomp._result);
+    Composition comp;
+    Composition ocomp;
+    {
+      LightReMutexHolder shard_holder(get_shard(this)._lock);
+      LightReMutexHolder other_shard_holder(get_shard(other)._lock);
+      comp = _invert_composition_cache.get_data(i);
+      _invert_composition_cache.remove_element(i);
+      _cache_stats.add_total_size(-1);
+      _cache_stats.inc_dels();
+      if (other != this) {
+        int oi = other->_invert_composition_cache.find(this);
+        if (oi != -1) {
+          ocomp = other->_invert_composition_cache.get_data(oi);
+          other->_invert_composition_cache.remove_element(oi);
+          _cache_stats.add_total_size(-1);
+          _cache_stats.inc_dels();
         }
       }
     }
+    if (ocomp._result != (const TransformState *)NULL && ocomp._result != other) {
+      cache_unref_delete(ocomp._result);
+    }
     if (comp._result != (const TransformState *)NULL && comp._result != this) {
       cache_unref_delete(comp._result);
     }
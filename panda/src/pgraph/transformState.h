@@ -28,6 +28,7 @@
 #include "lightReMutexHolder.h"
 #include "lightMutex.h"
 #include "lightMutexHolder.h"
+#include "atomicAdjust.h"
 #include "config_pgraph.h"
 #include "deletedChain.h"
 #include "simpleHashMap.h"
@@ -252,20 +253,49 @@ private:
   void remove_cache_pointers();
 
 private:
-  // This mutex protects _states.  It also protects any modification
-  // to the cache, which is encoded in _composition_cache and
-  // _invert_composition_cache.
+  // This mutex protects any modification to the cache, which is
+  // encoded in _composition_cache and _invert_composition_cache.  To
+  // modify a state's caches, a thread must hold both _states_lock and
+  // the lock of the StateShard the state hashes to; to read them, it
+  // need hold only one of these, so that a cache hit needs only the
+  // shard lock.  The global set of states itself is protected by the
+  // lock within each StateShard.  A thread that holds _states_lock
+  // may go on to acquire one or more shard locks; a thread that
+  // doesn't may hold only one shard lock at a time, and must not wait
+  // on any other lock while it does.
   static LightReMutex *_states_lock;
   class Empty {
   };
   typedef SimpleHashMap<const TransformState *, Empty, indirect_equals_hash<const TransformState *> > States;
-  static States *_states;
+
+  // The global set of unique TransformStates is divided into a
+  // number of shards, according to the hash of each state, so that
+  // threads creating unrelated transforms don't all contend for the
+  // same lock.  See state-table-shards.
+  class StateShard {
+  public:
+    StateShard();
+    int garbage_collect();
+    bool validate();
+
+    LightReMutex _lock;
+    States _states;
+
+    // This keeps track of our current position through the garbage
+    // collection cycle within this shard.
+    int _garbage_index;
+  };
+  INLINE static StateShard &get_shard(const TransformState *state);
+
+  static StateShard *_shards;
+  static int _num_shards;
   static CPT(TransformState) _identity_state;
   static CPT(TransformState) _invalid_state;
 
   // This iterator records the entry corresponding to this
-  // TransformState object in the above global set.  We keep the index
-  // around so we can remove it when the TransformState destructs.
+  // TransformState object in its shard of the above global set.  We
+  // keep the index around so we can remove it when the
+  // TransformState destructs.
   int _saved_entry;
 
   // This data structure manages the job of caching the composition of
@@ -286,20 +316,42 @@ private:
     // _result is reference counted if and only if it is not the same
     // pointer as this.
     const TransformState *_result;
+
+    // The value of _cache_clock when this entry was last stored or
+    // returned, for choosing entries to evict.
+    unsigned int _last_use;
   };
 
   typedef SimpleHashMap<const TransformState *, Composition, pointer_hash> CompositionCache;
   CompositionCache _composition_cache;
   CompositionCache _invert_composition_cache;
 
+  // These enforce transform-cache-max-entries and
+  // transform-cache-budget.  The CacheMember indicates which of the
+  // above two caches is meant.
+  typedef CompositionCache TransformState::*CacheMember;
+  int find_cache_victim(CacheMember cache, unsigned int &age) const;
+  void evict_cache_entry(CacheMember cache, int index);
+  void limit_cache(CacheMember cache, int max_entries);
+  static void enforce_cache_budget();
+  INLINE static unsigned int advance_cache_clock();
+  static int get_cache_candidates(CPT(TransformState) candidates[],
+                                  int max_candidates);
+
+  // This counts cache stores, as a cheap measure of time for
+  // approximating least-recently-used eviction.  It is advanced only
+  // while holding _states_lock, but cache hits read it without.
+  static AtomicAdjust::Integer _cache_clock;
+
+  // This is the position within the global state table at which
+  // enforce_cache_budget() will next look for entries to evict.
+  static int _cache_hand_shard;
+  static int _cache_hand_index;
+
   // This is used to mark nodes as we visit them to detect cycles.
   UpdateSeq _cycle_detect;
   static UpdateSeq _last_cycle_detect;
 
-  // This keeps track of our current position through the garbage
-  // collection cycle.
-  static int _garbage_index;
-
   static bool _uniquify_matrix;
 
   static PStatCollector _cache_update_pcollector;
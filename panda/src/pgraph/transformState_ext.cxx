@@ -150,30 +150,33 @@ get_invert_composition_cache() const {
 PyObject *Extension<TransformState>::
 get_states() {
   extern struct Dtool_PyTypedObject Dtool_TransformState;
-  if (TransformState::_states == (TransformState::States *)NULL) {
+  if (TransformState::_shards == (TransformState::StateShard *)NULL) {
     return PyList_New(0);
   }
   LightReMutexHolder holder(*TransformState::_states_lock);
 
-  size_t num_states = TransformState::_states->get_num_entries();
-  PyObject *list = PyList_New(num_states);
-  size_t i = 0;
+  // Other threads may still be adding states to the shards while we
+  // walk through them, so we can't know the final count in advance.
+  PyObject *list = PyList_New(0);
 
-  int size = TransformState::_states->get_size();
-  for (int si = 0; si < size; ++si) {
-    if (!TransformState::_states->has_element(si)) {
-      continue;
+  for (int shi = 0; shi < TransformState::_num_shards; ++shi) {
+    TransformState::StateShard &shard = TransformState::_shards[shi];
+    LightReMutexHolder shard_holder(shard._lock);
+
+    int size = shard._states.get_size();
+    for (int si = 0; si < size; ++si) {
+      if (!shard._states.has_element(si)) {
+        continue;
+      }
+      const TransformState *state = shard._states.get_key(si);
+      state->ref();
+      PyObject *a = 
+        DTool_CreatePyInstanceTyped((void *)state, Dtool_TransformState, 
+                                    true, true, state->get_type_index());
+      PyList_Append(list, a);
+      Py_DECREF(a);
     }
-    const TransformState *state = TransformState::_states->get_key(si);
-    state->ref();
-    PyObject *a = 
-      DTool_CreatePyInstanceTyped((void *)state, Dtool_TransformState, 
-                                  true, true, state->get_type_index());
-    nassertr(i < num_states, list);
-    PyList_SET_ITEM(list, i, a);
-    ++i;
   }
-  nassertr(i == num_states, list);
   return list;
 }
 
@@ -187,25 +190,30 @@ get_states() {
 PyObject *Extension<TransformState>::
 get_unused_states() {
   extern struct Dtool_PyTypedObject Dtool_TransformState;
-  if (TransformState::_states == (TransformState::States *)NULL) {
+  if (TransformState::_shards == (TransformState::StateShard *)NULL) {
     return PyList_New(0);
   }
   LightReMutexHolder holder(*TransformState::_states_lock);
 
   PyObject *list = PyList_New(0);
-  int size = TransformState::_states->get_size();
-  for (int si = 0; si < size; ++si) {
-    if (!TransformState::_states->has_element(si)) {
-      continue;
-    }
-    const TransformState *state = TransformState::_states->get_key(si);
-    if (state->get_cache_ref_count() == state->get_ref_count()) {
-      state->ref();
-      PyObject *a = 
-        DTool_CreatePyInstanceTyped((void *)state, Dtool_TransformState, 
-                                    true, true, state->get_type_index());
-      PyList_Append(list, a);
-      Py_DECREF(a);
+  for (int shi = 0; shi < TransformState::_num_shards; ++shi) {
+    TransformState::StateShard &shard = TransformState::_shards[shi];
+    LightReMutexHolder shard_holder(shard._lock);
+
+    int size = shard._states.get_size();
+    for (int si = 0; si < size; ++si) {
+      if (!shard._states.has_element(si)) {
+        continue;
+      }
+      const TransformState *state = shard._states.get_key(si);
+      if (state->get_cache_ref_count() == state->get_ref_count()) {
+        state->ref();
+        PyObject *a = 
+          DTool_CreatePyInstanceTyped((void *)state, Dtool_TransformState, 
+                                      true, true, state->get_type_index());
+        PyList_Append(list, a);
+        Py_DECREF(a);
+      }
     }
   }
   return list;
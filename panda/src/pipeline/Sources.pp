@@ -286,3 +286,16 @@
     test_setjmp.cxx
 
 #end test_bin_target
+
+
+#begin test_bin_target
+  #define TARGET test_pipeline_cycle
+  #define LOCAL_LIBS $[LOCAL_LIBS] p3pipeline
+  #define OTHER_LIBS \
+   p3interrogatedb:c p3dconfig:c p3dtoolbase:c p3prc:c \
+   p3dtoolutil:c p3dtool:m p3dtoolconfig:m p3pystub
+
+  #define SOURCES \
+    test_pipeline_cycle.cxx
+
+#end test_bin_target
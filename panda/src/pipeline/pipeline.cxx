@@ -90,10 +90,11 @@ cycle() {
       << "Beginning the pipeline cycle\n";
   }
 
+  Thread *current_thread = Thread::get_current_thread();
   pvector< PT(CycleData) > saved_cdatas;
   saved_cdatas.reserve(_num_dirty_cyclers);
   {
-    ReMutexHolder holder(_lock);
+    ReMutexHolder holder(_lock, current_thread);
     if (_num_stages == 1) {
       // No need to cycle if there's only one stage.
       nassertv(_dirty._next == &_dirty);
@@ -109,74 +110,25 @@ cycle() {
     prev_dirty.take_list(_dirty);
     _num_dirty_cyclers = 0;
 
-    switch (_num_stages) {
-    case 2:
-      while (prev_dirty._next != &prev_dirty) {
-        PipelineCyclerTrueImpl *cycler = (PipelineCyclerTrueImpl *)prev_dirty._next;
-        cycler->remove_from_list();
-        ReMutexHolder holder2(cycler->_lock);
-        
-        // We save the result of cycle(), so that we can defer the
-        // side-effects that might occur when CycleDatas destruct, at
-        // least until the end of this loop.
-        saved_cdatas.push_back(cycler->cycle_2());
-        
-        if (cycler->_dirty) {
-          // The cycler is still dirty after cycling.  Keep it on the
-          // dirty list for next time.
-          cycler->insert_before(&_dirty);
-          ++_num_dirty_cyclers;
-        } else {
-          // The cycler is now clean.  Add it back to the clean list.
-          cycler->insert_before(&_clean);
-#ifdef DEBUG_THREADS
-          inc_cycler_type(_dirty_cycler_types, cycler->get_parent_type(), -1);
-#endif
-        }
-      }
-      break;
+    // The cyclers that come out clean are collected on now_clean,
+    // and moved onto the clean list all at once at the end.
+    PipelineCyclerLinks now_clean;
+    now_clean.make_head();
 
-    case 3:
-      while (prev_dirty._next != &prev_dirty) {
-        PipelineCyclerTrueImpl *cycler = (PipelineCyclerTrueImpl *)prev_dirty._next;
-        cycler->remove_from_list();
-        ReMutexHolder holder2(cycler->_lock);
-        
-        saved_cdatas.push_back(cycler->cycle_3());
-        
-        if (cycler->_dirty) {
-          cycler->insert_before(&_dirty);
-          ++_num_dirty_cyclers;
-        } else {
-          cycler->insert_before(&_clean);
-#ifdef DEBUG_THREADS
-          inc_cycler_type(_dirty_cycler_types, cycler->get_parent_type(), -1);
-#endif
-        }
-      }
-      break;
+    // Any cycler that is locked by another thread at the moment is
+    // set aside on busy, rather than waiting for it right away.  We
+    // come back to those after all of the others have been cycled,
+    // by which time the other thread has most likely let go.
+    PipelineCyclerLinks busy;
+    busy.make_head();
+
+    cycle_list(prev_dirty, now_clean, &busy, saved_cdatas, current_thread);
+    cycle_list(busy, now_clean, NULL, saved_cdatas, current_thread);
+
+    _clean.append_list(now_clean);
+    now_clean.clear_head();
+    busy.clear_head();
 
-    default:
-      while (prev_dirty._next != &prev_dirty) {
-        PipelineCyclerTrueImpl *cycler = (PipelineCyclerTrueImpl *)prev_dirty._next;
-        cycler->remove_from_list();
-        ReMutexHolder holder2(cycler->_lock);
-        
-        saved_cdatas.push_back(cycler->cycle());
-        
-        if (cycler->_dirty) {
-          cycler->insert_before(&_dirty);
-          ++_num_dirty_cyclers;
-        } else {
-          cycler->insert_before(&_clean);
-#ifdef DEBUG_THREADS
-          inc_cycler_type(_dirty_cycler_types, cycler->get_parent_type(), -1);
-#endif
-        }
-      }
-      break;
-    }
-      
     // Now we're ready for the next frame.
     prev_dirty.clear_head();
     _cycling = false;
@@ -196,6 +148,78 @@ cycle() {
 #endif  // THREADED_PIPELINE
 }
 
+#ifdef THREADED_PIPELINE
+////////////////////////////////////////////////////////////////////
+//     Function: Pipeline::cycle_list
+//       Access: Private
+//  Description: Cycles each of the cyclers on the indicated list,
+//               leaving the list empty.  The cyclers that are still
+//               dirty afterwards are moved back to the dirty list,
+//               and the ones that are now clean to now_clean.  The
+//               previous CycleData pointers are saved in saved_cdatas,
+//               so that they are not destructed while we hold the
+//               lock.
+//
+//               If busy is not NULL, a cycler whose lock cannot be
+//               acquired immediately is moved to busy instead, and
+//               left for a later call; otherwise, we wait for it.
+//               Either way, each cycler's own lock is still taken
+//               while the Pipeline's lock is held, so a thread that
+//               holds a cycler for a long time still delays the end
+//               of the cycle; it just no longer delays the cyclers
+//               behind it.
+//
+//               It is assumed the lock is held during this call.
+////////////////////////////////////////////////////////////////////
+void Pipeline::
+cycle_list(PipelineCyclerLinks &list, PipelineCyclerLinks &now_clean,
+           PipelineCyclerLinks *busy, pvector< PT(CycleData) > &saved_cdatas,
+           Thread *current_thread) {
+  while (list._next != &list) {
+    PipelineCyclerTrueImpl *cycler = (PipelineCyclerTrueImpl *)list._next;
+    cycler->remove_from_list();
+
+    if (busy != (PipelineCyclerLinks *)NULL) {
+      if (!cycler->_lock.try_acquire(current_thread)) {
+        cycler->insert_before(busy);
+        continue;
+      }
+    } else {
+      cycler->_lock.acquire(current_thread);
+    }
+
+    switch (_num_stages) {
+    case 2:
+      saved_cdatas.push_back(cycler->cycle_2());
+      break;
+
+    case 3:
+      saved_cdatas.push_back(cycler->cycle_3());
+      break;
+
+    default:
+      saved_cdatas.push_back(cycler->cycle());
+      break;
+    }
+
+    if (cycler->_dirty) {
+      // The cycler is still dirty after cycling.  Keep it on the
+      // dirty list for next time.
+      cycler->insert_before(&_dirty);
+      ++_num_dirty_cyclers;
+    } else {
+      // The cycler is now clean.
+      cycler->insert_before(&now_clean);
+#ifdef DEBUG_THREADS
+      inc_cycler_type(_dirty_cycler_types, cycler->get_parent_type(), -1);
+#endif
+    }
+
+    cycler->_lock.release();
+  }
+}
+#endif  // THREADED_PIPELINE
+
 ////////////////////////////////////////////////////////////////////
 //     Function: Pipeline::set_num_stages
 //       Access: Public
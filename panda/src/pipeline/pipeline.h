@@ -21,9 +21,13 @@
 #include "pset.h"
 #include "reMutex.h"
 #include "reMutexHolder.h"
+#include "pvector.h"
+#include "pointerTo.h"
 #include "selectThreadImpl.h"  // for THREADED_PIPELINE definition
 
 struct PipelineCyclerTrueImpl;
+class CycleData;
+class Thread;
 
 ////////////////////////////////////////////////////////////////////
 //       Class : Pipeline
@@ -74,6 +78,11 @@ private:
   static Pipeline *_render_pipeline;
 
 #ifdef THREADED_PIPELINE
+  void cycle_list(PipelineCyclerLinks &list, PipelineCyclerLinks &now_clean,
+                  PipelineCyclerLinks *busy,
+                  pvector< PT(CycleData) > &saved_cdatas,
+                  Thread *current_thread);
+
   PipelineCyclerLinks _clean;
   PipelineCyclerLinks _dirty;
 
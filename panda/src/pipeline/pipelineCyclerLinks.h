@@ -45,6 +45,7 @@ protected:
   INLINE void insert_before(PipelineCyclerLinks *node);
 
   INLINE void take_list(PipelineCyclerLinks &other);
+  INLINE void append_list(PipelineCyclerLinks &other);
 
   PipelineCyclerLinks *_prev, *_next;
 #endif
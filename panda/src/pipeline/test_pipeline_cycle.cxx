@@ -0,0 +1,165 @@
+// Filename: test_pipeline_cycle.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pandabase.h"
+#include "pipeline.h"
+#include "pipelineCycler.h"
+#include "cycleData.h"
+#include "thread.h"
+#include "trueClock.h"
+
+// This program measures the cost of Pipeline::cycle() against the
+// number of dirty cyclers, with two and three pipeline stages.  It
+// also checks that a cycler that is locked by another thread while
+// the pipeline cycles is still cycled, once it is released.
+
+static const int num_cycles = 20;
+
+class CData : public CycleData {
+public:
+  CData() : _value(0) {}
+  CData(const CData &copy) : CycleData(copy), _value(copy._value) {}
+  virtual CycleData *make_copy() const {
+    return new CData(*this);
+  }
+
+  int _value;
+};
+
+typedef PipelineCycler<CData> Cycler;
+
+#ifdef THREADED_PIPELINE
+// Holds one cycler's lock for a little while, to make it busy when
+// the pipeline is cycled.
+class HoldThread : public Thread {
+public:
+  HoldThread(Cycler *cycler) :
+    Thread("hold", "hold"),
+    _cycler(cycler),
+    _holding(false) {}
+
+  virtual void thread_main() {
+    Thread *current_thread = Thread::get_current_thread();
+    _cycler->acquire(current_thread);
+    _holding = true;
+    Thread::sleep(0.05);
+    _cycler->release();
+  }
+
+  Cycler *_cycler;
+  volatile bool _holding;
+};
+
+// Writes a new value into stage 0 of each cycler, which makes each
+// one dirty.
+static void
+dirty_all(pvector<Cycler *> &cyclers, int value, Thread *current_thread) {
+  for (size_t i = 0; i < cyclers.size(); ++i) {
+    CData *cdata = cyclers[i]->write(current_thread);
+    cdata->_value = value;
+    cyclers[i]->release_write(cdata);
+  }
+}
+
+// Checks that the last stage of each cycler has caught up to value.
+static bool
+check_all(pvector<Cycler *> &cyclers, int num_stages, int value) {
+  for (size_t i = 0; i < cyclers.size(); ++i) {
+    if (cyclers[i]->read_stage_unlocked(num_stages - 1)->_value != value) {
+      return false;
+    }
+  }
+  return true;
+}
+#endif  // THREADED_PIPELINE
+
+int
+main(int argc, char *argv[]) {
+#ifndef THREADED_PIPELINE
+  nout << "Threaded pipelining is not compiled in.\n";
+  return 0;
+
+#else  // THREADED_PIPELINE
+  Thread *current_thread = Thread::get_current_thread();
+  TrueClock *true_clock = TrueClock::get_global_ptr();
+  bool ok = true;
+
+  static const int counts[] = { 1000, 10000, 100000 };
+  static const int num_counts = sizeof(counts) / sizeof(int);
+
+  for (int num_stages = 2; num_stages <= 3; ++num_stages) {
+    for (int ci = 0; ci < num_counts; ++ci) {
+      Pipeline pipeline("bench", num_stages);
+      pvector<Cycler *> cyclers;
+      for (int i = 0; i < counts[ci]; ++i) {
+        cyclers.push_back(new Cycler(&pipeline));
+      }
+
+      double elapsed = 0.0;
+      for (int n = 1; n <= num_cycles; ++n) {
+        dirty_all(cyclers, n, current_thread);
+        if (pipeline.get_num_dirty_cyclers() != counts[ci]) {
+          nout << "  only " << pipeline.get_num_dirty_cyclers()
+               << " cyclers are dirty!\n";
+          ok = false;
+        }
+
+        // It takes num_stages - 1 cycles for the new value to reach
+        // the end of the pipeline; only the first one is timed.
+        double start = true_clock->get_short_time();
+        pipeline.cycle();
+        elapsed += true_clock->get_short_time() - start;
+        for (int s = 2; s < num_stages; ++s) {
+          pipeline.cycle();
+        }
+
+        if (pipeline.get_num_dirty_cyclers() != 0 ||
+            !check_all(cyclers, num_stages, n)) {
+          nout << "  the cyclers were not all cycled!\n";
+          ok = false;
+        }
+      }
+
+      double us = elapsed * 1000000.0 / num_cycles;
+      nout << num_stages << " stages, " << counts[ci] << " dirty cyclers: "
+           << us << " us per cycle, " << us * 1000.0 / counts[ci]
+           << " ns per cycler\n";
+
+      // Now cycle once while one of the cyclers is held by another
+      // thread.
+      dirty_all(cyclers, -1, current_thread);
+      PT(HoldThread) thread = new HoldThread(cyclers[counts[ci] / 2]);
+      thread->start(TP_normal, true);
+      while (!thread->_holding) {
+        Thread::force_yield();
+      }
+      for (int s = 1; s < num_stages; ++s) {
+        pipeline.cycle();
+      }
+      thread->join();
+      if (pipeline.get_num_dirty_cyclers() != 0 ||
+          !check_all(cyclers, num_stages, -1)) {
+        nout << "  a busy cycler was not cycled!\n";
+        ok = false;
+      }
+
+      for (size_t i = 0; i < cyclers.size(); ++i) {
+        delete cyclers[i];
+      }
+    }
+  }
+
+  return ok ? 0 : 1;
+#endif  // THREADED_PIPELINE
+}
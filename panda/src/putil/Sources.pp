@@ -16,8 +16,10 @@
     bamCacheIndex.h bamCacheIndex.I \
     bamCacheRecord.h bamCacheRecord.I \
     bamEnums.h \
-    bamReader.I bamReader.N bamReader.h bamReaderParam.I \
-    bamReaderParam.h \
+    bamPayload.h bamPayload.I \
+    bamReader.I bamReader.N bamReader.h \
+    bamReaderCallbackData.h bamReaderCallbackData.I \
+    bamReaderParam.I bamReaderParam.h \
     bamWriter.I bamWriter.h \
     bitArray.I bitArray.h \
     bitMask.I bitMask.h \
@@ -82,7 +84,8 @@
     bamCacheIndex.cxx \
     bamCacheRecord.cxx \
     bamEnums.cxx \
-    bamReader.cxx bamReaderParam.cxx \
+    bamPayload.cxx \
+    bamReader.cxx bamReaderCallbackData.cxx bamReaderParam.cxx \
     bamWriter.cxx \
     bitArray.cxx \
     bitMask.cxx \
@@ -130,7 +133,10 @@
     bamCacheIndex.h bamCacheIndex.I \
     bamCacheRecord.h bamCacheRecord.I \
     bamEnums.h \
-    bamReader.I bamReader.h bamReaderParam.I bamReaderParam.h \
+    bamPayload.h bamPayload.I \
+    bamReader.I bamReader.h \
+    bamReaderCallbackData.h bamReaderCallbackData.I \
+    bamReaderParam.I bamReaderParam.h \
     bamWriter.I bamWriter.h \
     bitArray.I bitArray.h \
     bitMask.I bitMask.h \
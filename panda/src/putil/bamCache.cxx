@@ -27,6 +27,9 @@
 #include "configVariableString.h"
 #include "configVariableFilename.h"
 #include "virtualFileSystem.h"
+#include "trueClock.h"
+#include "thread.h"
+#include <algorithm>
 
 BamCache *BamCache::_global_ptr = NULL;
 
@@ -40,8 +43,11 @@ BamCache() :
   _active(true),
   _read_only(false),
   _index(new BamCacheIndex),
-  _index_stale_since(0)
+  _index_stale_since(0),
+  _content_size(0)
 {
+  reset_stats();
+
   ConfigVariableFilename model_cache_dir
     ("model-cache-dir", Filename(),
      PRC_DESC("The full path to a directory, local to this computer, in which "
@@ -78,12 +84,22 @@ BamCache() :
     ("model-cache-max-kbytes", 10485760,
      PRC_DESC("This is the maximum size of the model cache, in kilobytes."));
 
+  ConfigVariableBool model_cache_content_addressed
+    ("model-cache-content-addressed", false,
+     PRC_DESC("Set this true to store the model cache by content hash, "
+              "without a shared index file.  Identical cached objects are "
+              "then stored only once, and many threads and processes may "
+              "use the same model-cache-dir at once with little "
+              "contention.  The least recently used files are removed "
+              "when the cache exceeds model-cache-max-kbytes."));
+
   _cache_models = model_cache_models;
   _cache_textures = model_cache_textures;
   _cache_compressed_textures = model_cache_compressed_textures;
 
   _flush_time = model_cache_flush;
   _max_kbytes = model_cache_max_kbytes;
+  _content_addressed = model_cache_content_addressed;
 
   if (!model_cache_dir.empty()) {
     set_root(model_cache_dir);
@@ -129,12 +145,49 @@ set_root(const Filename &root) {
   delete _index;
   _index = new BamCacheIndex;
   _index_stale_since = 0;
-  read_index();
+  if (_content_addressed) {
+    // There is no index; check_cache_size() finds out how big the
+    // cache is by scanning it.
+    _content_size = -1;
+  } else {
+    read_index();
+  }
   check_cache_size();
 
   nassertv(vfs->is_directory(_root));
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: BamCache::set_content_addressed
+//       Access: Published
+//  Description: Changes the way the cache is stored on disk.  If this
+//               is true, each cached object is stored in a file named
+//               by the hash of its contents, so that identical objects
+//               are stored only once, and each source file gets a
+//               small record file of its own that refers to it.
+//               There is no shared index, and cached objects are
+//               read and written without holding the cache's lock, so
+//               many threads and processes may use the cache at once.
+//
+//               If this is false, the cache is stored in the
+//               traditional way, with each object in the same file as
+//               its record, and a shared index of all of the records.
+//
+//               Either mode can read the files written by the other.
+////////////////////////////////////////////////////////////////////
+void BamCache::
+set_content_addressed(bool flag) {
+  ReMutexHolder holder(_lock);
+  if (flag == _content_addressed) {
+    return;
+  }
+  flush_index();
+  _content_addressed = flag;
+  if (!_root.empty()) {
+    set_root(_root);
+  }
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: BamCache::lookup
 //       Access: Published
@@ -159,9 +212,79 @@ set_root(const Filename &root) {
 ////////////////////////////////////////////////////////////////////
 PT(BamCacheRecord) BamCache::
 lookup(const Filename &source_filename, const string &cache_extension) {
+  TrueClock *true_clock = TrueClock::get_global_ptr();
+  double start = true_clock->get_short_time();
+
+  PT(BamCacheRecord) record;
+  if (get_content_addressed()) {
+    // The files of a content-addressed cache are safe to read without
+    // holding the lock, so that several threads may load from the
+    // cache at once.
+    record = do_lookup(source_filename, cache_extension);
+
+  } else {
+    ReMutexHolder holder(_lock);
+    consider_flush_index();
+    record = do_lookup(source_filename, cache_extension);
+  }
+
+  double elapsed = true_clock->get_short_time() - start;
+
   ReMutexHolder holder(_lock);
-  consider_flush_index();
+  if (record != (BamCacheRecord *)NULL) {
+    if (record->has_data()) {
+      ++_num_hits;
+    } else {
+      ++_num_misses;
+    }
+  }
+  _total_lookup_time += elapsed;
+  _max_lookup_time = max(_max_lookup_time, elapsed);
+
+  return record;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamCache::store
+//       Access: Published
+//  Description: Flushes a cache entry to disk.  You must have
+//               retrieved the cache record via a prior call to
+//               lookup(), and then stored the data via
+//               record->set_data().  Returns true on success, false
+//               on failure.
+////////////////////////////////////////////////////////////////////
+bool BamCache::
+store(BamCacheRecord *record) {
+  TrueClock *true_clock = TrueClock::get_global_ptr();
+  double start = true_clock->get_short_time();
+
+  bool success;
+  if (get_content_addressed()) {
+    success = store_content(record);
+  } else {
+    success = store_indexed(record);
+  }
+
+  double elapsed = true_clock->get_short_time() - start;
+
+  ReMutexHolder holder(_lock);
+  if (success) {
+    ++_num_stores;
+  }
+  _total_store_time += elapsed;
+
+  return success;
+}
 
+////////////////////////////////////////////////////////////////////
+//     Function: BamCache::do_lookup
+//       Access: Private
+//  Description: The implementation of lookup().  For a
+//               content-addressed cache, this is called without
+//               holding the lock.
+////////////////////////////////////////////////////////////////////
+PT(BamCacheRecord) BamCache::
+do_lookup(const Filename &source_filename, const string &cache_extension) {
   VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
 
   Filename source_pathname(source_filename);
@@ -182,16 +305,15 @@ lookup(const Filename &source_filename, const string &cache_extension) {
 }
 
 ////////////////////////////////////////////////////////////////////
-//     Function: BamCache::store
-//       Access: Published
-//  Description: Flushes a cache entry to disk.  You must have
-//               retrieved the cache record via a prior call to
-//               lookup(), and then stored the data via
-//               record->set_data().  Returns true on success, false
-//               on failure.
+//     Function: BamCache::store_indexed
+//       Access: Private
+//  Description: The implementation of store() for a cache that is not
+//               content-addressed.  The record and its object are
+//               written to the same file, which is added to the
+//               index.
 ////////////////////////////////////////////////////////////////////
 bool BamCache::
-store(BamCacheRecord *record) {
+store_indexed(BamCacheRecord *record) {
   VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
   ReMutexHolder holder(_lock);
   nassertr(!record->_cache_pathname.empty(), false);
@@ -248,15 +370,7 @@ store(BamCacheRecord *record) {
       return false;
     }
 
-    TypeRegistry *type_registry = TypeRegistry::ptr();
-    TypeHandle texture_type = type_registry->find_type("Texture");
-    if (record->get_data()->is_of_type(texture_type)) {
-      // Texture objects write the actual texture image.
-      writer.set_file_texture_mode(BamWriter::BTM_rawdata);
-    } else {
-      // Any other kinds of objects write texture references.
-      writer.set_file_texture_mode(BamWriter::BTM_fullpath);
-    }
+    writer.set_file_texture_mode(get_texture_mode(record->get_data()));
 
     if (!writer.write_object(record)) {
       util_cat.error()
@@ -297,6 +411,102 @@ store(BamCacheRecord *record) {
   return true;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: BamCache::store_content
+//       Access: Private
+//  Description: The implementation of store() for a
+//               content-addressed cache.  The object is written to a
+//               file named for the hash of its contents, unless an
+//               identical file is already there, and the record is
+//               written to a file of its own that refers to it.
+//
+//               The lock is held only to update the bookkeeping
+//               afterwards; the files themselves are written to
+//               temporary names and moved into place, so that other
+//               threads and processes never see them half-written.
+////////////////////////////////////////////////////////////////////
+bool BamCache::
+store_content(BamCacheRecord *record) {
+  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+  nassertr(!record->_cache_pathname.empty(), false);
+  nassertr(record->has_data(), false);
+
+  Filename root;
+  {
+    ReMutexHolder holder(_lock);
+    if (_read_only) {
+      return false;
+    }
+    root = _root;
+  }
+
+#ifndef NDEBUG
+  // Ensure that the cache_pathname is within the _root directory tree.
+  Filename rel_pathname(record->_cache_pathname);
+  rel_pathname.make_relative_to(root, false);
+  nassertr(rel_pathname.is_local(), false);
+#endif  // NDEBUG
+
+  string data;
+  if (!write_bam_data(data, record->get_data())) {
+    util_cat.error()
+      << "Unable to write object data for " << record->_cache_pathname << "\n";
+    return false;
+  }
+
+  string content_hash = hash_content(data);
+  Filename cache_pathname = Filename::binary_filename(record->_cache_pathname);
+  Filename content_pathname = 
+    get_content_pathname(root, content_hash, cache_pathname.get_extension());
+
+  streamsize added_size = 0;
+  bool shared = false;
+  PT(VirtualFile) content_file = vfs->get_file(content_pathname);
+  if (content_file != (VirtualFile *)NULL &&
+      content_file->get_file_size() == (streamsize)data.size()) {
+    // Someone has already stored an identical object.  We only need
+    // to mark it as recently used.
+    content_pathname.touch();
+    shared = true;
+
+  } else {
+    vfs->make_directory_full(content_pathname.get_dirname());
+    if (!write_file_atomically(content_pathname, data, false)) {
+      util_cat.error()
+        << "Could not write cache file: " << content_pathname << "\n";
+      ReMutexHolder holder(_lock);
+      emergency_read_only();
+      return false;
+    }
+    added_size += (streamsize)data.size();
+  }
+
+  record->_recorded_time = time(NULL);
+  record->_content_hash = content_hash;
+
+  // Now write the record by itself, into its own file.
+  if (!write_bam_data(data, record) ||
+      !write_file_atomically(cache_pathname, data, true)) {
+    util_cat.error()
+      << "Could not write cache file: " << cache_pathname << "\n";
+    record->_content_hash = string();
+    return false;
+  }
+  record->_record_size = (streamsize)data.size();
+  added_size += record->_record_size;
+
+  ReMutexHolder holder(_lock);
+  if (shared) {
+    ++_num_shared_stores;
+  }
+  if (_content_size >= 0) {
+    _content_size += added_size;
+  }
+  check_cache_size();
+
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: BamCache::emergency_read_only
 //       Access: Private
@@ -395,6 +605,49 @@ list_index(ostream &out, int indent_level) const {
   _index->write(out, indent_level);
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: BamCache::reset_stats
+//       Access: Published
+//  Description: Resets all of the statistics reported by
+//               get_num_hits() and friends to zero.
+////////////////////////////////////////////////////////////////////
+void BamCache::
+reset_stats() {
+  ReMutexHolder holder(_lock);
+  _num_hits = 0;
+  _num_misses = 0;
+  _num_stores = 0;
+  _num_shared_stores = 0;
+  _num_evictions = 0;
+  _total_lookup_time = 0.0;
+  _max_lookup_time = 0.0;
+  _total_store_time = 0.0;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamCache::write_stats
+//       Access: Published
+//  Description: Writes a summary of the statistics about the use of
+//               the cache to the indicated output stream.
+////////////////////////////////////////////////////////////////////
+void BamCache::
+write_stats(ostream &out) const {
+  ReMutexHolder holder(_lock);
+  int num_lookups = _num_hits + _num_misses;
+  out << "BamCache " << _root << ":\n"
+      << "  " << _num_hits << " hits, " << _num_misses << " misses";
+  if (num_lookups != 0) {
+    out << " (" << (_num_hits * 100 / num_lookups) << "% hits), "
+        << (_total_lookup_time * 1000.0 / num_lookups) << " ms average lookup, "
+        << (_max_lookup_time * 1000.0) << " ms longest";
+  }
+  out << "\n"
+      << "  " << _num_stores << " stores (" << _num_shared_stores
+      << " shared with identical objects), "
+      << (_total_store_time * 1000.0) << " ms total\n"
+      << "  " << _num_evictions << " files evicted\n";
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: BamCache::read_index
 //       Access: Private
@@ -632,6 +885,11 @@ rebuild_index() {
 ////////////////////////////////////////////////////////////////////
 void BamCache::
 add_to_index(const BamCacheRecord *record) {
+  if (_content_addressed) {
+    // A content-addressed cache has no index.
+    return;
+  }
+
   PT(BamCacheRecord) new_record = record->make_copy();
 
   if (_index->add_record(new_record)) {
@@ -648,6 +906,10 @@ add_to_index(const BamCacheRecord *record) {
 ////////////////////////////////////////////////////////////////////
 void BamCache::
 remove_from_index(const Filename &source_pathname) {
+  if (_content_addressed) {
+    return;
+  }
+
   if (_index->remove_record(source_pathname)) {
     mark_index_stale();
   }
@@ -661,6 +923,11 @@ remove_from_index(const Filename &source_pathname) {
 ////////////////////////////////////////////////////////////////////
 void BamCache::
 check_cache_size() {
+  if (_content_addressed) {
+    check_content_size();
+    return;
+  }
+
   if (_index->_cache_size == 0) {
     // 0 means no limit.
     return;
@@ -958,7 +1225,19 @@ do_read_record(const Filename &cache_pathname, bool read_data) {
     TypedWritable *ptr;
     ReferenceCount *ref_ptr;
 
-    if (reader.read_object(ptr, ref_ptr)) {
+    if (!record->_content_hash.empty()) {
+      // The object is in a file of its own, named for its contents.
+      Filename content_pathname = 
+        get_content_pathname(cache_pathname.get_dirname(), record->_content_hash,
+                             cache_pathname.get_extension());
+      if (do_read_content(content_pathname, record)) {
+        // Update the modification times, which are used to decide
+        // which files were least recently used.
+        content_pathname.touch();
+        cache_pathname.touch();
+      }
+
+    } else if (reader.read_object(ptr, ref_ptr)) {
       if (!reader.resolve()) {
         if (util_cat.is_debug()) {
           util_cat.debug()
@@ -984,6 +1263,364 @@ do_read_record(const Filename &cache_pathname, bool read_data) {
   return record;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: BamCache::check_content_size
+//       Access: Private
+//  Description: The implementation of check_cache_size() for a
+//               content-addressed cache.  Assumes the lock is held.
+////////////////////////////////////////////////////////////////////
+void BamCache::
+check_content_size() {
+  if (_max_kbytes <= 0 || _root.empty()) {
+    // 0 means no limit.
+    return;
+  }
+
+  if (_content_size < 0) {
+    // We haven't looked at the cache yet.
+    ContentFiles files;
+    _content_size = scan_content(files);
+  }
+
+  if (_content_size / 1024 > _max_kbytes) {
+    evict_content();
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamCache::evict_content
+//       Access: Private
+//  Description: Removes the least recently used files from a
+//               content-addressed cache, until it is comfortably
+//               below its size limit.  Assumes the lock is held.
+//
+//               Only one process at a time does this, so that they
+//               don't all rush to delete the same files; if another
+//               process is already at it, this does nothing.
+////////////////////////////////////////////////////////////////////
+void BamCache::
+evict_content() {
+  string token;
+  if (!acquire_evict_lock(token)) {
+    return;
+  }
+
+  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+  ContentFiles files;
+  _content_size = scan_content(files);
+  sort(files.begin(), files.end());
+
+  // Leave some room, so that we don't have to do this again right
+  // away.
+  streamsize target_size = (streamsize)_max_kbytes * 1024 / 10 * 9;
+
+  ContentFiles::const_iterator fi;
+  for (fi = files.begin(); 
+       fi != files.end() && _content_size > target_size; 
+       ++fi) {
+    if (util_cat.is_debug()) {
+      util_cat.debug()
+        << "Deleting " << (*fi)._pathname
+        << " to keep cache size below " << _max_kbytes << "K\n";
+    }
+    if (vfs->delete_file((*fi)._pathname)) {
+      _content_size -= (*fi)._size;
+      ++_num_evictions;
+    }
+  }
+
+  release_evict_lock(token);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamCache::acquire_evict_lock
+//       Access: Private
+//  Description: Attempts to claim the right to evict files from a
+//               content-addressed cache, for this thread.  Returns
+//               true on success, filling token with the contents to
+//               pass to release_evict_lock() later; or false if
+//               another thread or process holds it.
+//
+//               The claim is recorded in a small file in the cache
+//               directory, which is updated with the os-provided
+//               file lock, like index_name.txt.  A claim that is more
+//               than a minute old is assumed to have been abandoned
+//               by a process that crashed.
+////////////////////////////////////////////////////////////////////
+bool BamCache::
+acquire_evict_lock(string &token) const {
+  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+  Filename lock_pathname(_root, Filename("evict_lock.txt"));
+
+  // The atomic exchange does not truncate the file, so the contents
+  // are always padded to the same length.
+  static const size_t token_size = 63;
+
+  // If the file doesn't exist yet, no one has claimed it; the
+  // exchange below will create it.
+  string orig_contents;
+  if (!vfs->atomic_read_contents(lock_pathname, orig_contents)) {
+    orig_contents = string();
+  }
+
+  time_t now = time(NULL);
+  vector_string words;
+  extract_words(orig_contents, words);
+  if (words.size() == 2) {
+    int timestamp;
+    if (string_to_int(words[1], timestamp) && now - (time_t)timestamp < 60) {
+      // Someone else is busy evicting.
+      return false;
+    }
+  }
+
+  ostringstream strm;
+  strm << Thread::get_current_thread()->get_unique_id() << " " << now;
+  token = strm.str();
+  token.resize(token_size, ' ');
+  token += "\n";
+
+  string actual_contents;
+  return vfs->atomic_compare_and_exchange_contents
+    (lock_pathname, actual_contents, orig_contents, token);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamCache::release_evict_lock
+//       Access: Private
+//  Description: Releases a claim made by acquire_evict_lock().
+////////////////////////////////////////////////////////////////////
+void BamCache::
+release_evict_lock(const string &token) const {
+  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+  Filename lock_pathname(_root, Filename("evict_lock.txt"));
+
+  string free_token = "free";
+  free_token.resize(token.size() - 1, ' ');
+  free_token += "\n";
+
+  string actual_contents;
+  vfs->atomic_compare_and_exchange_contents
+    (lock_pathname, actual_contents, token, free_token);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamCache::scan_content
+//       Access: Private
+//  Description: Fills files with the list of record and object files
+//               in a content-addressed cache, and returns their total
+//               size.  Temporary files, and the files that belong to
+//               the cache as a whole, are not included.
+////////////////////////////////////////////////////////////////////
+streamsize BamCache::
+scan_content(ContentFiles &files) const {
+  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+  streamsize total_size = 0;
+
+  Filename dirnames[2] = {
+    _root,
+    Filename(_root, Filename("content")),
+  };
+
+  for (int di = 0; di < 2; ++di) {
+    PT(VirtualFileList) contents = vfs->scan_directory(dirnames[di]);
+    if (contents == (VirtualFileList *)NULL) {
+      continue;
+    }
+
+    int num_files = contents->get_num_files();
+    for (int i = 0; i < num_files; ++i) {
+      VirtualFile *file = contents->get_file(i);
+      if (!file->is_regular_file()) {
+        continue;
+      }
+      string extension = file->get_filename().get_extension();
+      if (extension == "tmp" || extension == "txt" || extension == "boo") {
+        continue;
+      }
+
+      ContentFile content_file;
+      content_file._pathname = file->get_filename();
+      content_file._timestamp = file->get_timestamp();
+      content_file._size = file->get_file_size();
+      files.push_back(content_file);
+      total_size += content_file._size;
+    }
+  }
+
+  return total_size;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamCache::do_read_content
+//       Access: Private, Static
+//  Description: Reads the cached object from the indicated file of a
+//               content-addressed cache, and stores it on the
+//               record.  Returns true on success.
+//
+//               The object must be stored before the BamReader is
+//               destroyed; otherwise the reader would release the
+//               last reference to it.
+////////////////////////////////////////////////////////////////////
+bool BamCache::
+do_read_content(const Filename &content_pathname, BamCacheRecord *record) {
+  DatagramInputFile din;
+  if (!din.open(content_pathname)) {
+    if (util_cat.is_debug()) {
+      util_cat.debug()
+        << "Could not read cache file: " << content_pathname << "\n";
+    }
+    return false;
+  }
+
+  string head;
+  if (!din.read_header(head, _bam_header.size()) || head != _bam_header) {
+    if (util_cat.is_debug()) {
+      util_cat.debug()
+        << content_pathname << " is not a cache file.\n";
+    }
+    return false;
+  }
+
+  BamReader reader(&din);
+  if (!reader.init()) {
+    return false;
+  }
+
+  TypedWritable *ptr;
+  ReferenceCount *ref_ptr;
+  if (!reader.read_object(ptr, ref_ptr) || ptr == (TypedWritable *)NULL) {
+    return false;
+  }
+
+  if (!reader.resolve()) {
+    if (util_cat.is_debug()) {
+      util_cat.debug()
+        << "Unable to fully resolve cached object in " << content_pathname << "\n";
+    }
+    if (ref_ptr == (ReferenceCount *)NULL) {
+      delete ptr;
+    }
+    return false;
+  }
+
+  record->set_data(ptr, ref_ptr);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamCache::get_texture_mode
+//       Access: Private, Static
+//  Description: Returns the texture mode with which the indicated
+//               object should be written to the cache.
+////////////////////////////////////////////////////////////////////
+BamEnums::BamTextureMode BamCache::
+get_texture_mode(TypedWritable *object) {
+  TypeRegistry *type_registry = TypeRegistry::ptr();
+  TypeHandle texture_type = type_registry->find_type("Texture");
+  if (object->is_of_type(texture_type)) {
+    // Texture objects write the actual texture image.
+    return BamWriter::BTM_rawdata;
+  } else {
+    // Any other kinds of objects write texture references.
+    return BamWriter::BTM_fullpath;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamCache::write_bam_data
+//       Access: Private, Static
+//  Description: Writes the indicated object, and everything it
+//               references, to a complete cache file image in
+//               memory.  Returns true on success.
+////////////////////////////////////////////////////////////////////
+bool BamCache::
+write_bam_data(string &data, TypedWritable *object) {
+  ostringstream strm;
+  DatagramOutputFile dout;
+  if (!dout.open(strm) || !dout.write_header(_bam_header)) {
+    return false;
+  }
+
+  {
+    BamWriter writer(&dout);
+    if (!writer.init()) {
+      return false;
+    }
+    writer.set_file_texture_mode(get_texture_mode(object));
+    if (!writer.write_object(object)) {
+      return false;
+    }
+  }
+
+  dout.close();
+  data = strm.str();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamCache::write_file_atomically
+//       Access: Private, Static
+//  Description: Writes the indicated data to a temporary file, and
+//               then moves it into place, so that no one attempts to
+//               read the file while it is in the process of being
+//               written.  If replace is false and the file already
+//               exists, it is left alone; this is used for files
+//               named for their contents.  Returns true on success.
+////////////////////////////////////////////////////////////////////
+bool BamCache::
+write_file_atomically(const Filename &pathname, const string &data,
+                      bool replace) {
+  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+
+  Thread *current_thread = Thread::get_current_thread();
+  string extension = current_thread->get_unique_id() + string(".tmp");
+  Filename temp_pathname = pathname;
+  temp_pathname.set_extension(extension);
+  temp_pathname.set_binary();
+
+  if (!vfs->write_file(temp_pathname, data, false)) {
+    vfs->delete_file(temp_pathname);
+    return false;
+  }
+
+  if (!vfs->rename_file(temp_pathname, pathname) && vfs->exists(temp_pathname)) {
+    // On Windows, we can't rename over an existing file.
+    if (!replace && vfs->exists(pathname)) {
+      // Someone else got there first.
+      vfs->delete_file(temp_pathname);
+      return true;
+    }
+    vfs->delete_file(pathname);
+    if (!vfs->rename_file(temp_pathname, pathname)) {
+      util_cat.error()
+        << "Unable to rename " << temp_pathname << " to " 
+        << pathname << "\n";
+      vfs->delete_file(temp_pathname);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamCache::get_content_pathname
+//       Access: Private, Static
+//  Description: Returns the full pathname to the file in which a
+//               content-addressed cache stores an object with the
+//               indicated hash.
+////////////////////////////////////////////////////////////////////
+Filename BamCache::
+get_content_pathname(const Filename &root, const string &content_hash,
+                     const string &extension) {
+  Filename content_pathname(Filename(root, Filename("content")), 
+                            Filename(content_hash));
+  content_pathname.set_extension(extension);
+  content_pathname.set_binary();
+  return content_pathname;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: BamCache::hash_filename
 //       Access: Private, Static
@@ -1017,6 +1654,34 @@ hash_filename(const string &filename) {
 #endif  // HAVE_OPENSSL
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: BamCache::hash_content
+//       Access: Private, Static
+//  Description: Returns the name to use for the file in which a
+//               content-addressed cache stores the indicated data.
+////////////////////////////////////////////////////////////////////
+string BamCache::
+hash_content(const string &data) {
+  ostringstream strm;
+#ifdef HAVE_OPENSSL
+  HashVal hv;
+  hv.hash_string(data);
+  hv.output_hex(strm);
+
+#else  // HAVE_OPENSSL
+  // Without OpenSSL, use a 64-bit FNV-1a hash.  We include the
+  // length as well, to make a collision that much less likely.
+  PN_uint64 hash = 14695981039346656037ULL;
+  for (string::const_iterator si = data.begin(); si != data.end(); ++si) {
+    hash = (hash ^ (unsigned char)(*si)) * 1099511628211ULL;
+  }
+  strm << hex << setw(16) << setfill('0') << hash 
+       << "_" << data.size();
+
+#endif  // HAVE_OPENSSL
+  return strm.str();
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: BamCache::make_global
 //       Access: Private, Static
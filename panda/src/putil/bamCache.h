@@ -17,6 +17,7 @@
 
 #include "pandabase.h"
 #include "bamCacheRecord.h"
+#include "bamEnums.h"
 #include "pointerTo.h"
 #include "filename.h"
 #include "pmap.h"
@@ -43,6 +44,17 @@ class BamCacheIndex;
 //               the same index, and without relying too heavily on
 //               low-level os-provided file locks (which work poorly
 //               with C++ iostreams).
+//
+//               Alternatively, the cache may be content-addressed
+//               (see set_content_addressed()).  In this mode, there
+//               is no index: each cache record is a small file of its
+//               own, which names the file that holds the cached
+//               object by the hash of its contents, so that
+//               identical objects cached for different source files
+//               are stored only once.  Records and objects may be
+//               read by many threads and processes at once, and the
+//               least recently used files are removed when the cache
+//               exceeds its size limit.
 ////////////////////////////////////////////////////////////////////
 class EXPCL_PANDA_PUTIL BamCache {
 PUBLISHED:
@@ -73,6 +85,9 @@ PUBLISHED:
   INLINE void set_read_only(bool ro);
   INLINE bool get_read_only() const;
 
+  void set_content_addressed(bool flag);
+  INLINE bool get_content_addressed() const;
+
   PT(BamCacheRecord) lookup(const Filename &source_filename,
                             const string &cache_extension);
   bool store(BamCacheRecord *record);
@@ -82,6 +97,17 @@ PUBLISHED:
 
   void list_index(ostream &out, int indent_level = 0) const;
 
+  INLINE int get_num_hits() const;
+  INLINE int get_num_misses() const;
+  INLINE int get_num_stores() const;
+  INLINE int get_num_shared_stores() const;
+  INLINE int get_num_evictions() const;
+  INLINE double get_total_lookup_time() const;
+  INLINE double get_max_lookup_time() const;
+  INLINE double get_total_store_time() const;
+  void reset_stats();
+  void write_stats(ostream &out) const;
+
   INLINE static BamCache *get_global_ptr();
 
 private:
@@ -97,6 +123,15 @@ private:
 
   void check_cache_size();
 
+  PT(BamCacheRecord) do_lookup(const Filename &source_filename,
+                               const string &cache_extension);
+  bool store_indexed(BamCacheRecord *record);
+  bool store_content(BamCacheRecord *record);
+  void check_content_size();
+  void evict_content();
+  bool acquire_evict_lock(string &token) const;
+  void release_evict_lock(const string &token) const;
+
   void emergency_read_only();
 
   static BamCacheIndex *do_read_index(const Filename &index_pathname);
@@ -109,10 +144,34 @@ private:
                                  int pass);
   static PT(BamCacheRecord) do_read_record(const Filename &cache_pathname,
                                            bool read_data);
+  static bool do_read_content(const Filename &content_pathname,
+                              BamCacheRecord *record);
+  static BamEnums::BamTextureMode get_texture_mode(TypedWritable *object);
+  static bool write_bam_data(string &data, TypedWritable *object);
+  static bool write_file_atomically(const Filename &pathname,
+                                    const string &data, bool replace);
+  static Filename get_content_pathname(const Filename &root,
+                                       const string &content_hash,
+                                       const string &extension);
 
   static string hash_filename(const string &filename);
+  static string hash_content(const string &data);
   static void make_global();
 
+  // This is used by evict_content() to sort the files in a
+  // content-addressed cache from least to most recently used.
+  class ContentFile {
+  public:
+    INLINE bool operator < (const ContentFile &other) const;
+
+    Filename _pathname;
+    time_t _timestamp;
+    streamsize _size;
+  };
+  typedef pvector<ContentFile> ContentFiles;
+
+  streamsize scan_content(ContentFiles &files) const;
+
   bool _active;
   bool _cache_models;
   bool _cache_textures;
@@ -121,6 +180,7 @@ private:
   Filename _root;
   int _flush_time;
   int _max_kbytes;
+  bool _content_addressed;
   static BamCache *_global_ptr;
 
   BamCacheIndex *_index;
@@ -129,6 +189,20 @@ private:
   Filename _index_pathname;
   string _index_ref_contents;
 
+  // The total size of the files in a content-addressed cache, as of
+  // the last time we scanned it, plus whatever we have added since.
+  streamsize _content_size;
+
+  // Statistics about the use of the cache.
+  int _num_hits;
+  int _num_misses;
+  int _num_stores;
+  int _num_shared_stores;
+  int _num_evictions;
+  double _total_lookup_time;
+  double _max_lookup_time;
+  double _total_store_time;
+
   ReMutex _lock;
 };
 
@@ -70,6 +70,7 @@ BamCacheRecord(const BamCacheRecord &copy) :
   _recorded_time(copy._recorded_time),
   _record_size(copy._record_size),
   _source_timestamp(copy._source_timestamp),
+  _content_hash(copy._content_hash),
   _ptr(NULL),
   _ref_ptr(NULL),
   _record_access_time(copy._record_access_time)
@@ -211,6 +212,10 @@ write(ostream &out, int indent_level) const {
     << "source " << format_timestamp(_source_timestamp) << "\n";
   indent(out, indent_level)
     << "recorded " << format_timestamp(_recorded_time) << "\n";
+  if (!_content_hash.empty()) {
+    indent(out, indent_level)
+      << "content " << _content_hash << "\n";
+  }
 
   indent(out, indent_level)
     << _files.size() << " dependent files.\n";
@@ -288,6 +293,8 @@ write_datagram(BamWriter *manager, Datagram &dg) {
     dg.add_uint32(file._timestamp);
     dg.add_uint64(file._size);
   }
+
+  dg.add_string(_content_hash);
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -341,4 +348,8 @@ fillin(DatagramIterator &scan, BamReader *manager) {
       _source_timestamp = file._timestamp;
     }
   }
+
+  if (manager->get_file_minor_ver() >= 40) {
+    _content_hash = scan.get_string();
+  }
 }
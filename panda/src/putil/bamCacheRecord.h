@@ -54,6 +54,7 @@ PUBLISHED:
   INLINE const Filename &get_cache_filename() const;
   INLINE time_t get_source_timestamp() const;
   INLINE time_t get_recorded_time() const;
+  INLINE const string &get_content_hash() const;
 
   INLINE int get_num_dependent_files() const;
   INLINE const Filename &get_dependent_pathname(int n) const;
@@ -96,6 +97,11 @@ private:
 
   typedef pvector<DependentFile> DependentFiles;
   DependentFiles _files;
+
+  // In a content-addressed cache, this names the file that holds the
+  // cached object.  Otherwise, it is empty, and the object follows
+  // the record in the same file.
+  string _content_hash;
   
   // The following are not recorded to disk; they are preserved
   // in-memory only for the current session.
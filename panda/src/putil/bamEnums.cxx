@@ -69,6 +69,9 @@ operator << (ostream &out, BamEnums::BamObjectCode boc) {
 
   case BamEnums::BOC_file_data:
     return out << "file_data";
+
+  case BamEnums::BOC_payload:
+    return out << "payload";
   }
 
   return out << "**invalid BamEnums::BamObjectCode value: (" << (int)boc << ")**";
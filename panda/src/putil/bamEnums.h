@@ -48,13 +48,17 @@ PUBLISHED:
   // level.  BOC_remove lists object ID's that have been deallocated
   // on the sender end.  BOC_file_data may appear at any level and
   // indicates the following datagram contains auxiliary file data
-  // that may be referenced by a later object.
+  // that may be referenced by a later object.  BOC_payload is
+  // similar, but the following datagram contains a large,
+  // self-contained block of data (such as vertex data) belonging to
+  // the next object, which may be decoded on another thread.
   enum BamObjectCode {
     BOC_push,
     BOC_pop,
     BOC_adjunct,
     BOC_remove,
     BOC_file_data,
+    BOC_payload,
   };
 
   // This enum is used to control how textures are written to a bam
@@ -0,0 +1,331 @@
+// Filename: bamPayload.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "bamPayload.h"
+#include "config_util.h"
+#include "mutexHolder.h"
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+BamPayload::DecodePool *BamPayload::DecodePool::_global_ptr = NULL;
+Mutex BamPayload::DecodePool::_global_lock("BamPayload::DecodePool::_global_lock");
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamPayload::Constructor
+//       Access: Public
+//  Description: Creates a payload from the indicated datagram, which
+//               was read from the bam file, and will decode to size
+//               bytes.  Raw data is ready immediately; other data must
+//               be decoded first.
+////////////////////////////////////////////////////////////////////
+BamPayload::
+BamPayload(Method method, size_t size, const Datagram &body) :
+  _method(method),
+  _size(size),
+  _body(body),
+  _mapped_data(NULL),
+  _error(false),
+  _state(method == M_raw ? S_ready : S_pending),
+  _cvar(_lock)
+{
+  if (_method == M_raw && _body.get_length() != _size) {
+    bam_cat.error()
+      << "Payload data is " << _body.get_length() << " bytes, expected "
+      << _size << ".\n";
+    _error = true;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamPayload::Constructor
+//       Access: Public
+//  Description: Creates a raw payload that references size bytes of
+//               the indicated mapping directly, starting at data.
+////////////////////////////////////////////////////////////////////
+BamPayload::
+BamPayload(size_t size, MappedFile *mapping, const unsigned char *data) :
+  _method(M_raw),
+  _size(size),
+  _mapping(mapping),
+  _mapped_data(data),
+  _error(false),
+  _state(S_ready),
+  _cvar(_lock)
+{
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamPayload::Destructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+BamPayload::
+~BamPayload() {
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamPayload::is_ready
+//       Access: Public
+//  Description: Returns true if the data has been decoded, so that
+//               get_data() will return immediately.
+////////////////////////////////////////////////////////////////////
+bool BamPayload::
+is_ready() const {
+  MutexHolder holder(_lock);
+  return (_state == S_ready);
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamPayload::start_decode
+//       Access: Public
+//  Description: Hands the payload to the pool of decode threads, if
+//               it needs decoding and there are any such threads.
+//               This is called by the BamReader as soon as it reads
+//               the payload.
+////////////////////////////////////////////////////////////////////
+void BamPayload::
+start_decode() {
+  if (_state != S_pending) {
+    return;
+  }
+
+  DecodePool *pool = DecodePool::get_global_ptr();
+  if (pool->has_threads()) {
+    pool->add_payload(this);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamPayload::get_data
+//       Access: Public
+//  Description: Returns the decoded data, which is get_size() bytes
+//               long.  If it has not yet been decoded, decodes it in
+//               the current thread; if it is being decoded by another
+//               thread, waits for it to finish.  Returns NULL if the
+//               data could not be decoded.
+////////////////////////////////////////////////////////////////////
+const unsigned char *BamPayload::
+get_data() {
+  decode_now();
+
+  {
+    MutexHolder holder(_lock);
+    while (_state != S_ready) {
+      _cvar.wait();
+    }
+  }
+
+  if (_error) {
+    return NULL;
+  }
+  if (_mapped_data != (const unsigned char *)NULL) {
+    return _mapped_data;
+  }
+  if (_method == M_raw) {
+    return (const unsigned char *)_body.get_data();
+  }
+  if (_data.empty()) {
+    static const unsigned char empty = 0;
+    return &empty;
+  }
+  return &_data[0];
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamPayload::encode
+//       Access: Public, Static
+//  Description: Fills body with the indicated data, as it should be
+//               written to the bam file, and sets method to indicate
+//               how it was stored.  If compress is true, the data is
+//               compressed, unless that would not make it smaller.
+//               Returns true on success.
+////////////////////////////////////////////////////////////////////
+bool BamPayload::
+encode(Method &method, Datagram &body, const unsigned char *data,
+       size_t size, bool compress) {
+  body.clear();
+
+#ifdef HAVE_ZLIB
+  if (compress) {
+    uLongf dest_len = compressBound((uLong)size);
+    pvector<unsigned char> dest(max(dest_len, (uLongf)1));
+    int result = compress2(&dest[0], &dest_len, data, (uLong)size, 6);
+    if (result == Z_OK && dest_len < size) {
+      method = M_zlib;
+      body.append_data(&dest[0], dest_len);
+      return true;
+    }
+  }
+#endif  // HAVE_ZLIB
+
+  method = M_raw;
+  body.append_data(data, size);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamPayload::decode_now
+//       Access: Private
+//  Description: Decodes the data in the current thread, unless it is
+//               already decoded or being decoded by another thread.
+////////////////////////////////////////////////////////////////////
+void BamPayload::
+decode_now() {
+  {
+    MutexHolder holder(_lock);
+    if (_state != S_pending) {
+      return;
+    }
+    _state = S_decoding;
+  }
+
+  do_decode();
+
+  MutexHolder holder(_lock);
+  _state = S_ready;
+  _cvar.notify_all();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamPayload::do_decode
+//       Access: Private
+//  Description: Does the work of decoding the data.  This is called
+//               with _state set to S_decoding, so no other thread
+//               will touch the data in the meantime.
+////////////////////////////////////////////////////////////////////
+void BamPayload::
+do_decode() {
+  switch (_method) {
+  case M_raw:
+    break;
+
+  case M_zlib:
+#ifdef HAVE_ZLIB
+    {
+      _data.resize(_size);
+      uLongf dest_len = (uLongf)_size;
+      int result = uncompress(_data.empty() ? NULL : &_data[0], &dest_len,
+                              (const Bytef *)_body.get_data(),
+                              (uLong)_body.get_length());
+      if (result != Z_OK || dest_len != _size) {
+        bam_cat.error()
+          << "Unable to decompress payload data.\n";
+        _error = true;
+      }
+    }
+#else
+    bam_cat.error()
+      << "Cannot decompress payload data without zlib.\n";
+    _error = true;
+#endif  // HAVE_ZLIB
+
+    // We don't need the compressed data any more.
+    _body.clear();
+    break;
+
+  default:
+    bam_cat.error()
+      << "Invalid payload method " << (int)_method << ".\n";
+    _error = true;
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamPayload::DecodePool::Constructor
+//       Access: Public
+//  Description: Starts the indicated number of decode threads.
+////////////////////////////////////////////////////////////////////
+BamPayload::DecodePool::
+DecodePool(int num_threads) :
+  _cvar(_lock)
+{
+  for (int i = 0; i < num_threads; ++i) {
+    ostringstream strm;
+    strm << "BamDecode-" << i;
+    PT(DecodeThread) thread = new DecodeThread(strm.str(), this);
+    if (!thread->start(TP_normal, false)) {
+      // Threading isn't available; the payloads will be decoded as
+      // they are needed.
+      break;
+    }
+    _threads.push_back(thread);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamPayload::DecodePool::add_payload
+//       Access: Public
+//  Description: Queues the payload to be decoded by the next
+//               available thread.
+////////////////////////////////////////////////////////////////////
+void BamPayload::DecodePool::
+add_payload(BamPayload *payload) {
+  MutexHolder holder(_lock);
+  _queue.push_back(payload);
+  _cvar.notify();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamPayload::DecodePool::get_global_ptr
+//       Access: Public, Static
+//  Description: Returns the pool of decode threads, creating it if
+//               necessary.  This may be called by several
+//               BamReaders on different threads at once.
+////////////////////////////////////////////////////////////////////
+BamPayload::DecodePool *BamPayload::DecodePool::
+get_global_ptr() {
+  MutexHolder holder(_global_lock);
+  if (_global_ptr == (DecodePool *)NULL) {
+    _global_ptr = new DecodePool(max((int)bam_decode_threads, 0));
+  }
+  return _global_ptr;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamPayload::DecodeThread::Constructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+BamPayload::DecodeThread::
+DecodeThread(const string &name, DecodePool *pool) :
+  Thread(name, "BamDecode"),
+  _pool(pool)
+{
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamPayload::DecodeThread::thread_main
+//       Access: Public, Virtual
+//  Description: Decodes payloads from the queue, for as long as the
+//               program runs.  A payload that has been picked up by
+//               the thread that needs it in the meantime is skipped.
+////////////////////////////////////////////////////////////////////
+void BamPayload::DecodeThread::
+thread_main() {
+  while (true) {
+    PT(BamPayload) payload;
+    {
+      MutexHolder holder(_pool->_lock);
+      while (_pool->_queue.empty()) {
+        _pool->_cvar.wait();
+      }
+      payload = _pool->_queue.front();
+      _pool->_queue.pop_front();
+    }
+
+    payload->decode_now();
+  }
+}
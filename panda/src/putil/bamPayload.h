@@ -0,0 +1,135 @@
+// Filename: bamPayload.h
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef BAMPAYLOAD_H
+#define BAMPAYLOAD_H
+
+#include "pandabase.h"
+#include "referenceCount.h"
+#include "datagram.h"
+#include "pvector.h"
+#include "pdeque.h"
+#include "pointerTo.h"
+#include "pmutex.h"
+#include "conditionVar.h"
+#include "conditionVarFull.h"
+#include "thread.h"
+#include "mappedFile.h"
+
+////////////////////////////////////////////////////////////////////
+//       Class : BamPayload
+// Description : A large, self-contained block of data, such as the
+//               vertices of a GeomVertexArrayData, that was written
+//               to a bam file in its own BOC_payload record ahead of
+//               the object that owns it.  See BamWriter::write_payload()
+//               and BamReader::read_payload().
+//
+//               Since the block does not depend on any other object
+//               in the file, it may be decoded (that is,
+//               decompressed) on one of a pool of threads while the
+//               BamReader goes on reading the objects that follow
+//               it.  The object that owns it should defer calling
+//               get_data() as long as it can, normally until
+//               finalize().
+//
+//               Raw payloads read from a file on disk may instead
+//               reference the data in a memory mapping of the file,
+//               which the owning object may keep, rather than copying
+//               the data; see get_mapping().
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDA_PUTIL BamPayload : public ReferenceCount {
+public:
+  // The way the data is stored in the bam file.
+  enum Method {
+    M_raw,
+    M_zlib,
+  };
+
+  BamPayload(Method method, size_t size, const Datagram &body);
+  BamPayload(size_t size, MappedFile *mapping, const unsigned char *data);
+  ~BamPayload();
+
+  INLINE Method get_method() const;
+  INLINE size_t get_size() const;
+  INLINE MappedFile *get_mapping() const;
+
+  bool is_ready() const;
+  void start_decode();
+  const unsigned char *get_data();
+
+  static bool encode(Method &method, Datagram &body,
+                     const unsigned char *data, size_t size,
+                     bool compress);
+
+private:
+  void decode_now();
+  void do_decode();
+
+  Method _method;
+  size_t _size;
+  Datagram _body;
+  PT(MappedFile) _mapping;
+  const unsigned char *_mapped_data;
+  pvector<unsigned char> _data;
+  bool _error;
+
+  enum State {
+    S_pending,
+    S_decoding,
+    S_ready,
+  };
+  State _state;
+  Mutex _lock;
+  ConditionVarFull _cvar;
+
+  // This is the pool of threads, shared by all BamReaders, that
+  // decode payloads in the background.  It is created the first time
+  // it is needed, with bam-decode-threads threads.
+  class DecodeThread;
+  class DecodePool {
+  public:
+    DecodePool(int num_threads);
+
+    void add_payload(BamPayload *payload);
+    INLINE bool has_threads() const;
+
+    static DecodePool *get_global_ptr();
+
+  private:
+    typedef pdeque<PT(BamPayload)> Queue;
+    Queue _queue;
+    Mutex _lock;
+    ConditionVar _cvar;
+
+    typedef pvector<PT(DecodeThread)> Threads;
+    Threads _threads;
+
+    static DecodePool *_global_ptr;
+    static Mutex _global_lock;
+    friend class DecodeThread;
+  };
+
+  class DecodeThread : public Thread {
+  public:
+    DecodeThread(const string &name, DecodePool *pool);
+    virtual void thread_main();
+
+  private:
+    DecodePool *_pool;
+  };
+};
+
+#include "bamPayload.I"
+
+#endif
@@ -17,6 +17,7 @@
 
 #include "bam.h"
 #include "bamReader.h"
+#include "bamReaderCallbackData.h"
 #include "datagramIterator.h"
 #include "config_util.h"
 #include "pipelineCyclerBase.h"
@@ -50,6 +51,10 @@ BamReader(DatagramGenerator *source)
   _pta_id = -1;
   _long_object_id = false;
   _long_pta_id = false;
+  _streaming = false;
+  _stream_reads = 0;
+  _stream_root_id = 0;
+  _error = false;
 }
 
 
@@ -273,6 +278,7 @@ read_object(TypedWritable *&ptr, ReferenceCount *&ref_ptr) {
 
   // First, read the base object.
   int object_id = p_read_object();
+  _stream_root_id = object_id;
 
   // Now that object might have included some pointers to other
   // objects, which may still need to be read.  And those objects
@@ -284,12 +290,18 @@ read_object(TypedWritable *&ptr, ReferenceCount *&ref_ptr) {
   while (_num_extra_objects > 0) {
     p_read_object();
     _num_extra_objects--;
+    if (_streaming) {
+      stream_resolve();
+    }
   }
 
   // Beginning with 6.21, we use explicit nesting commands to know
   // when we're done.
   while (_nesting_level > start_level) {
     p_read_object();
+    if (_streaming) {
+      stream_resolve();
+    }
   }
 
   // Now look up the pointer of the object we read first.  It should
@@ -347,115 +359,21 @@ read_object(TypedWritable *&ptr, ReferenceCount *&ref_ptr) {
 //               The return value is true if all objects have been
 //               resolved, or false if some objects are still
 //               outstanding (in which case you will need to call
-//               resolve() again later).
+//               resolve() again later).  It is also false if any
+//               object reported an error via set_error() while it
+//               was being read or finalized.
 ////////////////////////////////////////////////////////////////////
 bool BamReader::
 resolve() {
-  bool all_completed;
-  bool any_completed_this_pass;
-
-  do {
-    if (bam_cat.is_spam()) {
-      bam_cat.spam()
-        << "resolve pass begin\n";
-    }
-    all_completed = true;
-    any_completed_this_pass = false;
-    
-    ObjectPointers::iterator oi;
-    oi = _object_pointers.begin();
-    while (oi != _object_pointers.end()) {
-      int object_id = (*oi).first;
-      PointerReference &pref = (*oi).second;
-
-      CreatedObjs::iterator ci = _created_objs.find(object_id);
-      nassertr(ci != _created_objs.end(), false);
-
-      CreatedObj &created_obj = (*ci).second;
-      
-      TypedWritable *object_ptr = created_obj._ptr;
-
-      // Update _now_creating, so a call to get_int_tag() from within
-      // complete_pointers() will come to the right place.
-      CreatedObjs::iterator was_creating = _now_creating;
-      _now_creating = ci;
-      
-      if (resolve_object_pointers(object_ptr, pref)) {
-        // Now remove this object from the list of things that need
-        // completion.  We have to be a bit careful when deleting things
-        // from the STL container while we are traversing it.
-        ObjectPointers::iterator old = oi;
-        ++oi;
-        _object_pointers.erase(old);
-        any_completed_this_pass = true;
-        
-        // Does the pointer need to change?
-        if (created_obj._change_this_ref != NULL) {
-          // Reference-counting variant.
-          TypedWritableReferenceCount *object_ref_ptr = (TypedWritableReferenceCount *)object_ptr;
-          nassertr(created_obj._ref_ptr == NULL || created_obj._ref_ptr == object_ref_ptr, false);
-          PT(TypedWritableReferenceCount) new_ptr = created_obj._change_this_ref(object_ref_ptr, this);
-          if (new_ptr != object_ref_ptr) {
-            // Also update the reverse
-            vector_int &old_refs = _created_objs_by_pointer[object_ptr];
-            vector_int &new_refs = _created_objs_by_pointer[new_ptr];
-            for (vector_int::const_iterator oi = old_refs.begin();
-                 oi != old_refs.end();
-                 ++oi) {
-              new_refs.push_back(*oi);
-            }
-            _created_objs_by_pointer.erase(object_ptr);
-
-            // Remove the pointer from the finalize list (the new
-            // pointer presumably doesn't require finalizing).
-            _finalize_list.erase(object_ptr);
-          }
-          created_obj.set_ptr(new_ptr, new_ptr);
-          created_obj._change_this = NULL;
-          created_obj._change_this_ref = NULL;
-
-        } else if (created_obj._change_this != NULL) {
-          // Non-reference-counting variant.
-          TypedWritable *new_ptr = created_obj._change_this(object_ptr, this);
-          if (new_ptr != object_ptr) {
-            // Also update the reverse
-            vector_int &old_refs = _created_objs_by_pointer[object_ptr];
-            vector_int &new_refs = _created_objs_by_pointer[new_ptr];
-            for (vector_int::const_iterator oi = old_refs.begin();
-                 oi != old_refs.end();
-                 ++oi) {
-              new_refs.push_back(*oi);
-            }
-            _created_objs_by_pointer.erase(object_ptr);
-
-            // Remove the pointer from the finalize list (the new
-            // pointer presumably doesn't require finalizing).
-            _finalize_list.erase(object_ptr);
-          }
-          created_obj.set_ptr(new_ptr, new_ptr->as_reference_count());
-          created_obj._change_this = NULL;
-          created_obj._change_this_ref = NULL;
-        }
-        
-      } else {
-        // Couldn't complete this object yet; it'll wait for next time.
-        ++oi;
-        all_completed = false;
-      }
-
-      _now_creating = was_creating;
-    }
-
-    if (bam_cat.is_spam()) {
-      bam_cat.spam()
-        << "resolve pass end: all_completed = " << all_completed
-        << " any_completed_this_pass = " << any_completed_this_pass
-        << "\n";
-    }
-  } while (!all_completed && any_completed_this_pass);
+  bool all_completed = do_resolve();
 
   if (all_completed) {
     finalize();
+    if (_error) {
+      bam_cat.error()
+        << "Some objects could not be read correctly.\n";
+      return false;
+    }
   } else {
     // Report all the uncompleted objects for no good reason.  This
     // will probably have to come out later when we have cases in
@@ -671,6 +589,31 @@ read_pointer(DatagramIterator &scan) {
     pref._cycler_pointers[_reading_cycler].push_back(object_id);
   }
 
+  if (_streaming && object_id != 0 && object_id != requestor_id) {
+    // A pointer to an object that has already been created, such as a
+    // node's pointer back to its parent, is recorded separately; see
+    // stream_completed().
+    CreatedObjs::const_iterator ci = _created_objs.find(object_id);
+    if (ci != _created_objs.end() && (*ci).second._created) {
+      pref._back_referenced.push_back(object_id);
+    } else {
+      pref._referenced.push_back(object_id);
+    }
+
+    // Also remember that this object now has one more referrer that
+    // must store its pointer before we can hand it off.
+    StreamCounts::iterator ri =
+      _stream_referrers.insert(StreamCounts::value_type(object_id, 0)).first;
+    if ((*ri).second >= 0) {
+      ++(*ri).second;
+    }
+
+    // And one more that must be finalized before we can release its
+    // aux data.
+    ++_stream_unfinalized[object_id];
+    _stream_referenced[requestor_id].push_back(object_id);
+  }
+
   // If the object ID is zero (which indicates a NULL pointer), we
   // don't have to do anything else.
   if (object_id != 0) {
@@ -742,6 +685,42 @@ read_file_data(SubfileInfo &info) {
   _file_data_records.pop_front();
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: BamReader::read_payload
+//       Access: Public
+//  Description: Returns the next block of payload data, as written by
+//               a matching call to BamWriter::write_payload().  The
+//               data may still be decoding on another thread; the
+//               caller should hold on to the BamPayload, and call
+//               get_data() on it as late as possible, e.g. in
+//               finalize().
+////////////////////////////////////////////////////////////////////
+PT(BamPayload) BamReader::
+read_payload() {
+  // As with read_file_data(), the payload records precede the object
+  // that owns them, in the same order as the calls to
+  // read_payload().
+  nassertr(!_payloads.empty(), NULL);
+  PT(BamPayload) payload = _payloads.front();
+  _payloads.pop_front();
+  return payload;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamReader::set_error
+//       Access: Public
+//  Description: May be called by an object's fillin() or finalize()
+//               method to indicate that its data could not be
+//               restored correctly, for instance because a payload
+//               record was missing or corrupt.  The object is still
+//               returned, but the next call to resolve() will
+//               return false.
+////////////////////////////////////////////////////////////////////
+void BamReader::
+set_error() {
+  _error = true;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: BamReader::read_cdata
 //       Access: Public
@@ -1102,8 +1081,17 @@ free_object_ids(DatagramIterator &scan) {
           << " before removing from table.\n";
       }
 
-      _created_objs_by_pointer.erase((*ci).second._ptr);
+      // An object handed off in streaming mode was already removed
+      // from the reverse lookup, and its address may since have been
+      // reused.
+      StreamCounts::const_iterator ri = _stream_referrers.find(object_id);
+      if (ri == _stream_referrers.end() || (*ri).second != -1) {
+        _created_objs_by_pointer.erase((*ci).second._ptr);
+      }
       _created_objs.erase(ci);
+      _stream_referrers.erase(object_id);
+      _stream_unfinalized.erase(object_id);
+      _stream_referenced.erase(object_id);
     }
   }
 }
@@ -1223,6 +1211,45 @@ p_read_object() {
 
     return p_read_object();
 
+  case BOC_payload:
+    // Similar to the above, but we read the data now, and start it
+    // decoding in the background, if it needs to be decoded.
+    {
+      BamPayload::Method method = (BamPayload::Method)scan.get_uint8();
+      size_t size = scan.get_uint32();
+
+      // If the data is stored raw in a file on disk, we may not need
+      // to read it at all, but can simply point into a mapping of
+      // the file.
+      PT(BamPayload) payload;
+      PT(MappedFile) mapping;
+      const unsigned char *mapped_data;
+      size_t mapped_size;
+      if (method == BamPayload::M_raw && bam_mmap &&
+          _source->map_datagram(mapping, mapped_data, mapped_size)) {
+        if (mapped_size != size) {
+          bam_cat.error()
+            << "Payload data is " << mapped_size << " bytes, expected "
+            << size << ".\n";
+          return 0;
+        }
+        payload = new BamPayload(size, mapping, mapped_data);
+
+      } else {
+        Datagram body;
+        if (!get_datagram(body)) {
+          bam_cat.error()
+            << "Failed to read payload data.\n";
+          return 0;
+        }
+        payload = new BamPayload(method, size, body);
+        payload->start_decode();
+      }
+      _payloads.push_back(payload);
+    }
+
+    return p_read_object();
+
   default:
     bam_cat.error()
       << "Encountered invalid BamObjectCode 0x" << hex << (int)boc << dec << ".\n";
@@ -1344,6 +1371,15 @@ p_read_object() {
       
       _created_objs_by_pointer[created_obj._ptr].push_back(object_id);
 
+      if (_streaming && object != (TypedWritable *)NULL &&
+          _object_pointers.find(object_id) == _object_pointers.end() &&
+          created_obj._change_this == NULL &&
+          created_obj._change_this_ref == NULL) {
+        // This object has no pointers to wait for, so it is already
+        // complete.
+        stream_fully_complete(object_id);
+      }
+
       // Just some sanity checks
       if (object == (TypedWritable *)NULL) {
         if (bam_cat.is_debug()) {
@@ -1471,6 +1507,14 @@ resolve_object_pointers(TypedWritable *object,
             // It's not yet complete itself.
             is_complete = false;
             
+          } else if (child_obj.was_deleted()) {
+            // It was handed off in streaming mode, and the
+            // application has since let it go.
+            bam_cat.error()
+              << "Object " << child_id
+              << " was deleted after it was read, but is referenced again.\n";
+            references.push_back((TypedWritable *)NULL);
+
           } else {
             // Yes, it's ready.
             references.push_back(child_obj._ptr);
@@ -1561,6 +1605,14 @@ resolve_cycler_pointers(PipelineCyclerBase *cycler,
             // It's not yet complete itself.
             is_complete = false;
             
+          } else if (child_obj.was_deleted()) {
+            // It was handed off in streaming mode, and the
+            // application has since let it go.
+            bam_cat.error()
+              << "Object " << child_id
+              << " was deleted after it was read, but is referenced again.\n";
+            references.push_back((TypedWritable *)NULL);
+
           } else {
             // Yes, it's ready.
             references.push_back(child_obj._ptr);
@@ -1592,6 +1644,142 @@ resolve_cycler_pointers(PipelineCyclerBase *cycler,
   return false;
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: BamReader::do_resolve
+//       Access: Private
+//  Description: The implementation of resolve(), without the final
+//               call to finalize().  Makes repeated passes through
+//               the objects still waiting for their pointers, calling
+//               complete_pointers() on each one that can be
+//               completed, until no more progress is made.  Returns
+//               true if all objects have been completed.
+////////////////////////////////////////////////////////////////////
+bool BamReader::
+do_resolve() {
+  bool all_completed;
+  bool any_completed_this_pass;
+
+  // In streaming mode, we record the objects completed, along with
+  // the objects each one references, and process them after all of
+  // the passes are done.
+  StreamCompletedList completed;
+
+  do {
+    if (bam_cat.is_spam()) {
+      bam_cat.spam()
+        << "resolve pass begin\n";
+    }
+    all_completed = true;
+    any_completed_this_pass = false;
+    
+    ObjectPointers::iterator oi;
+    oi = _object_pointers.begin();
+    while (oi != _object_pointers.end()) {
+      int object_id = (*oi).first;
+      PointerReference &pref = (*oi).second;
+
+      CreatedObjs::iterator ci = _created_objs.find(object_id);
+      nassertr(ci != _created_objs.end(), false);
+
+      CreatedObj &created_obj = (*ci).second;
+      
+      TypedWritable *object_ptr = created_obj._ptr;
+
+      // Update _now_creating, so a call to get_int_tag() from within
+      // complete_pointers() will come to the right place.
+      CreatedObjs::iterator was_creating = _now_creating;
+      _now_creating = ci;
+      
+      if (resolve_object_pointers(object_ptr, pref)) {
+        if (_streaming) {
+          completed.push_back(StreamCompleted());
+          completed.back()._object_id = object_id;
+          completed.back()._referenced.swap(pref._referenced);
+          completed.back()._back_referenced.swap(pref._back_referenced);
+        }
+
+        // Now remove this object from the list of things that need
+        // completion.  We have to be a bit careful when deleting things
+        // from the STL container while we are traversing it.
+        ObjectPointers::iterator old = oi;
+        ++oi;
+        _object_pointers.erase(old);
+        any_completed_this_pass = true;
+        
+        // Does the pointer need to change?
+        if (created_obj._change_this_ref != NULL) {
+          // Reference-counting variant.
+          TypedWritableReferenceCount *object_ref_ptr = (TypedWritableReferenceCount *)object_ptr;
+          nassertr(created_obj._ref_ptr == NULL || created_obj._ref_ptr == object_ref_ptr, false);
+          PT(TypedWritableReferenceCount) new_ptr = created_obj._change_this_ref(object_ref_ptr, this);
+          if (new_ptr != object_ref_ptr) {
+            // Also update the reverse
+            vector_int &old_refs = _created_objs_by_pointer[object_ptr];
+            vector_int &new_refs = _created_objs_by_pointer[new_ptr];
+            for (vector_int::const_iterator oi = old_refs.begin();
+                 oi != old_refs.end();
+                 ++oi) {
+              new_refs.push_back(*oi);
+            }
+            _created_objs_by_pointer.erase(object_ptr);
+
+            // Remove the pointer from the finalize list (the new
+            // pointer presumably doesn't require finalizing).
+            _finalize_list.erase(object_ptr);
+          }
+          created_obj.set_ptr(new_ptr, new_ptr);
+          created_obj._change_this = NULL;
+          created_obj._change_this_ref = NULL;
+
+        } else if (created_obj._change_this != NULL) {
+          // Non-reference-counting variant.
+          TypedWritable *new_ptr = created_obj._change_this(object_ptr, this);
+          if (new_ptr != object_ptr) {
+            // Also update the reverse
+            vector_int &old_refs = _created_objs_by_pointer[object_ptr];
+            vector_int &new_refs = _created_objs_by_pointer[new_ptr];
+            for (vector_int::const_iterator oi = old_refs.begin();
+                 oi != old_refs.end();
+                 ++oi) {
+              new_refs.push_back(*oi);
+            }
+            _created_objs_by_pointer.erase(object_ptr);
+
+            // Remove the pointer from the finalize list (the new
+            // pointer presumably doesn't require finalizing).
+            _finalize_list.erase(object_ptr);
+          }
+          created_obj.set_ptr(new_ptr, new_ptr->as_reference_count());
+          created_obj._change_this = NULL;
+          created_obj._change_this_ref = NULL;
+        }
+        
+      } else {
+        // Couldn't complete this object yet; it'll wait for next time.
+        ++oi;
+        all_completed = false;
+      }
+
+      _now_creating = was_creating;
+    }
+
+    if (bam_cat.is_spam()) {
+      bam_cat.spam()
+        << "resolve pass end: all_completed = " << all_completed
+        << " any_completed_this_pass = " << any_completed_this_pass
+        << "\n";
+    }
+  } while (!all_completed && any_completed_this_pass);
+
+  StreamCompletedList::const_iterator si;
+  for (si = completed.begin(); si != completed.end(); ++si) {
+    stream_completed((*si)._object_id, (*si)._referenced,
+                     (*si)._back_referenced);
+  }
+
+  return all_completed;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: BamReader::finalize
 //       Access: Private
@@ -1617,10 +1805,17 @@ finalize() {
         << ")\n";
     }
     object->finalize(this);
-    _aux_data.erase(object);
     fi = _finalize_list.begin();
   }
 
+  // Everything is finalized now, including any objects that were
+  // still waiting on a reference cycle in streaming mode.
+  _stream_pending.clear();
+  _stream_waiters.clear();
+  _stream_completion_waiters.clear();
+  _stream_unfinalized.clear();
+  _stream_referenced.clear();
+
   // Now clear the aux data of all objects, except the NULL object.
   if (!_aux_data.empty()) {
     AuxDataTable::iterator ti = _aux_data.find((TypedWritable *)NULL);
@@ -1641,6 +1836,333 @@ finalize() {
   }
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: BamReader::stream_resolve
+//       Access: Private
+//  Description: Called in streaming mode after each object is read
+//               within read_object(), to resolve whatever pointers
+//               can be resolved so far.  A resolve pass costs time in
+//               proportion to the number of objects still waiting,
+//               so we only make one after reading at least as many
+//               new objects as that; this keeps the total cost
+//               linear in the size of the file.
+////////////////////////////////////////////////////////////////////
+void BamReader::
+stream_resolve() {
+  ++_stream_reads;
+  if (_stream_reads >= (int)_object_pointers.size()) {
+    _stream_reads = 0;
+    do_resolve();
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamReader::stream_completed
+//       Access: Private
+//  Description: Called in streaming mode when complete_pointers() has
+//               been called on the indicated object.  The object has
+//               now stored its pointers to each of the referenced
+//               objects, which may make them ready; and the object
+//               itself is fully complete once all of them are fully
+//               complete.
+//
+//               The back_referenced objects are those that had
+//               already been created when the pointer was read.  For
+//               these, we only wait for the object itself to be
+//               completed, not everything it references; otherwise
+//               every node would wait for its parent, which would in
+//               turn be waiting for its children.
+////////////////////////////////////////////////////////////////////
+void BamReader::
+stream_completed(int object_id, const vector_int &referenced,
+                 const vector_int &back_referenced) {
+  stream_release_referrer(referenced);
+  stream_release_referrer(back_referenced);
+
+  int num_pending = 0;
+
+  vector_int::const_iterator ri;
+  for (ri = referenced.begin(); ri != referenced.end(); ++ri) {
+    if (!is_fully_complete(*ri)) {
+      ++num_pending;
+      _stream_waiters[*ri].push_back(object_id);
+    }
+  }
+  for (ri = back_referenced.begin(); ri != back_referenced.end(); ++ri) {
+    if (!is_completed(*ri)) {
+      ++num_pending;
+      _stream_completion_waiters[*ri].push_back(object_id);
+    }
+  }
+
+  if (num_pending == 0) {
+    stream_fully_complete(object_id);
+  } else {
+    _stream_pending[object_id] = num_pending;
+  }
+
+  // Now release anything that was waiting only for this object to be
+  // completed.
+  StreamWaiters::iterator wi = _stream_completion_waiters.find(object_id);
+  if (wi != _stream_completion_waiters.end()) {
+    vector_int waiters;
+    waiters.swap((*wi).second);
+    _stream_completion_waiters.erase(wi);
+    stream_release_waiters(waiters);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamReader::stream_release_referrer
+//       Access: Private
+//  Description: Called in streaming mode when an object that has read
+//               pointers to each of the indicated objects has stored
+//               them, to note that the objects each have one fewer
+//               referrer to wait for.
+////////////////////////////////////////////////////////////////////
+void BamReader::
+stream_release_referrer(const vector_int &referenced) {
+  vector_int::const_iterator ri;
+  for (ri = referenced.begin(); ri != referenced.end(); ++ri) {
+    StreamCounts::iterator ci = _stream_referrers.find(*ri);
+    if (ci != _stream_referrers.end() && (*ci).second > 0) {
+      --(*ci).second;
+      if ((*ci).second == 0) {
+        stream_check_ready(*ri);
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamReader::stream_release_waiters
+//       Access: Private
+//  Description: Called in streaming mode when an object that each of
+//               the indicated objects was waiting on has become
+//               complete.  Any of them that are no longer waiting on
+//               anything else become fully complete.
+////////////////////////////////////////////////////////////////////
+void BamReader::
+stream_release_waiters(const vector_int &waiters) {
+  vector_int::const_iterator wi;
+  for (wi = waiters.begin(); wi != waiters.end(); ++wi) {
+    StreamCounts::iterator pi = _stream_pending.find(*wi);
+    nassertv(pi != _stream_pending.end());
+    --(*pi).second;
+    if ((*pi).second == 0) {
+      _stream_pending.erase(pi);
+      stream_fully_complete(*wi);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamReader::stream_fully_complete
+//       Access: Private
+//  Description: Called in streaming mode when the indicated object,
+//               and everything it references, has been completed.
+//               This may in turn make fully complete any objects that
+//               were waiting only for this one.
+////////////////////////////////////////////////////////////////////
+void BamReader::
+stream_fully_complete(int object_id) {
+  vector_int work;
+  work.push_back(object_id);
+
+  while (!work.empty()) {
+    int id = work.back();
+    work.pop_back();
+
+    stream_check_ready(id);
+
+    StreamWaiters::iterator wi = _stream_waiters.find(id);
+    if (wi != _stream_waiters.end()) {
+      vector_int waiters;
+      waiters.swap((*wi).second);
+      _stream_waiters.erase(wi);
+
+      // We don't call stream_release_waiters() here, to avoid
+      // recursing once for each level of the scene graph.
+      vector_int::const_iterator ii;
+      for (ii = waiters.begin(); ii != waiters.end(); ++ii) {
+        StreamCounts::iterator pi = _stream_pending.find(*ii);
+        nassertv(pi != _stream_pending.end());
+        --(*pi).second;
+        if ((*pi).second == 0) {
+          _stream_pending.erase(pi);
+          work.push_back(*ii);
+        }
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamReader::stream_check_ready
+//       Access: Private
+//  Description: Called in streaming mode whenever the indicated
+//               object might have become ready: that is, it is fully
+//               complete, and each of the objects that has
+//               referenced it has stored its pointer.  If it is
+//               ready, finalizes it now and passes it to the ready
+//               callback.
+//
+//               An object that has never been referenced (normally
+//               the root object returned by read_object()) is never
+//               ready; it is left to be finalized by resolve().
+////////////////////////////////////////////////////////////////////
+void BamReader::
+stream_check_ready(int object_id) {
+  StreamCounts::iterator ri = _stream_referrers.find(object_id);
+  if (ri == _stream_referrers.end() || (*ri).second != 0 ||
+      !is_fully_complete(object_id)) {
+    return;
+  }
+
+  // Mark it handed off, so that later referrers don't count.
+  (*ri).second = -1;
+
+  CreatedObjs::iterator ci = _created_objs.find(object_id);
+  nassertv(ci != _created_objs.end());
+  TypedWritable *object = (*ci).second._ptr;
+  if (object == (TypedWritable *)NULL) {
+    return;
+  }
+
+  finalize_now(object);
+  stream_finalized(object_id);
+
+  if (_ready_callback != (CallbackObject *)NULL) {
+    // Finalizing the object may have changed its pointer.
+    ci = _created_objs.find(object_id);
+    nassertv(ci != _created_objs.end());
+    BamReaderCallbackData cbdata(this, (*ci).second._ptr, (*ci).second._ref_ptr);
+    _ready_callback->do_callback(&cbdata);
+  }
+
+  // The object is the application's now; unless it is the one we
+  // will return from read_object(), we don't need to keep it alive
+  // any longer, only to remember where it is in case a later
+  // record refers back to it.  Its pointer won't change again, so we
+  // don't need the reverse lookup either--which we must not keep in
+  // any case, since the address may be reused once the object is
+  // deleted.
+  ci = _created_objs.find(object_id);
+  nassertv(ci != _created_objs.end());
+  CreatedObj &created_obj = (*ci).second;
+  CreatedObjsByPointer::iterator pi = _created_objs_by_pointer.find(created_obj._ptr);
+  if (pi != _created_objs_by_pointer.end()) {
+    vector_int &ids = (*pi).second;
+    ids.erase(std::remove(ids.begin(), ids.end(), object_id), ids.end());
+    if (ids.empty()) {
+      _created_objs_by_pointer.erase(pi);
+    }
+  }
+  if (object_id != _stream_root_id) {
+    created_obj.release_ref();
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamReader::stream_finalized
+//       Access: Private
+//  Description: Called in streaming mode when the indicated object
+//               has been finalized and handed off.  Releases its own
+//               aux data, if all of its referrers have also been
+//               finalized, and that of any object it references for
+//               which it was the last referrer to be finalized.
+//
+//               The aux data of objects that are finalized by
+//               finalize() instead, such as those in a reference
+//               cycle, is released there, at the end of the read.
+////////////////////////////////////////////////////////////////////
+void BamReader::
+stream_finalized(int object_id) {
+  if (_stream_unfinalized.find(object_id) == _stream_unfinalized.end()) {
+    stream_release_aux_data(object_id);
+  }
+
+  StreamWaiters::iterator wi = _stream_referenced.find(object_id);
+  if (wi == _stream_referenced.end()) {
+    return;
+  }
+  vector_int referenced;
+  referenced.swap((*wi).second);
+  _stream_referenced.erase(wi);
+
+  vector_int::const_iterator ri;
+  for (ri = referenced.begin(); ri != referenced.end(); ++ri) {
+    StreamCounts::iterator ui = _stream_unfinalized.find(*ri);
+    nassertv(ui != _stream_unfinalized.end() && (*ui).second > 0);
+    --(*ui).second;
+    if ((*ui).second == 0) {
+      _stream_unfinalized.erase(ui);
+
+      // If the referenced object has not been handed off yet, its
+      // aux data is released when it is.
+      StreamCounts::const_iterator hi = _stream_referrers.find(*ri);
+      if (hi != _stream_referrers.end() && (*hi).second == -1) {
+        stream_release_aux_data(*ri);
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamReader::stream_release_aux_data
+//       Access: Private
+//  Description: Called in streaming mode to remove the aux data of
+//               the indicated object, once it and all of its
+//               referrers have been finalized.
+////////////////////////////////////////////////////////////////////
+void BamReader::
+stream_release_aux_data(int object_id) {
+  if (_aux_data.empty()) {
+    return;
+  }
+  CreatedObjs::const_iterator ci = _created_objs.find(object_id);
+  if (ci != _created_objs.end() && (*ci).second._ptr != (TypedWritable *)NULL) {
+    _aux_data.erase((*ci).second._ptr);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamReader::is_completed
+//       Access: Private
+//  Description: Returns true if the indicated object has been
+//               created, all of its own pointers have been completed,
+//               and its pointer will not change again.
+////////////////////////////////////////////////////////////////////
+bool BamReader::
+is_completed(int object_id) const {
+  CreatedObjs::const_iterator ci = _created_objs.find(object_id);
+  if (ci == _created_objs.end()) {
+    return false;
+  }
+  const CreatedObj &created_obj = (*ci).second;
+  if (!created_obj._created ||
+      created_obj._change_this != NULL ||
+      created_obj._change_this_ref != NULL) {
+    return false;
+  }
+
+  return (_object_pointers.find(object_id) == _object_pointers.end());
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamReader::is_fully_complete
+//       Access: Private
+//  Description: Returns true if the indicated object has been
+//               created, its pointer will not change again, and it
+//               and all of the objects it references (as far as
+//               streaming mode knows) have been completed.
+////////////////////////////////////////////////////////////////////
+bool BamReader::
+is_fully_complete(int object_id) const {
+  return (is_completed(object_id) &&
+          _stream_pending.find(object_id) == _stream_pending.end());
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: BamReader::AuxData::Destructor
 //       Access: Public, Virtual
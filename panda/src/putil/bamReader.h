@@ -21,6 +21,7 @@
 #include "typedWritable.h"
 #include "typedWritableReferenceCount.h"
 #include "pointerTo.h"
+#include "weakPointerTo.h"
 #include "datagramGenerator.h"
 #include "datagramIterator.h"
 #include "bamReaderParam.h"
@@ -35,6 +36,9 @@
 #include "dcast.h"
 #include "pipelineCyclerBase.h"
 #include "referenceCount.h"
+#include "callbackObject.h"
+#include "bamPayload.h"
+#include "pvector.h"
 
 #include <algorithm>
 
@@ -143,6 +147,12 @@ PUBLISHED:
 
   INLINE const LoaderOptions &get_loader_options() const;
   INLINE void set_loader_options(const LoaderOptions &options);
+
+  INLINE void set_streaming(bool streaming);
+  INLINE bool get_streaming() const;
+  INLINE void set_ready_callback(CallbackObject *callback);
+  INLINE CallbackObject *get_ready_callback() const;
+  INLINE int get_num_unresolved_objects() const;
   
   TypedWritable *read_object();
   bool read_object(TypedWritable *&ptr, ReferenceCount *&ref_ptr);
@@ -168,6 +178,8 @@ public:
   void skip_pointer(DatagramIterator &scan);
 
   void read_file_data(SubfileInfo &info);
+  PT(BamPayload) read_payload();
+  void set_error();
 
   void read_cdata(DatagramIterator &scan, PipelineCyclerBase &cycler);
   void read_cdata(DatagramIterator &scan, PipelineCyclerBase &cycler,
@@ -212,8 +224,21 @@ private:
   bool resolve_object_pointers(TypedWritable *object, PointerReference &pref);
   bool resolve_cycler_pointers(PipelineCyclerBase *cycler, const vector_int &pointer_ids,
                                bool require_fully_complete);
+  bool do_resolve();
   void finalize();
 
+  void stream_resolve();
+  void stream_completed(int object_id, const vector_int &referenced,
+                        const vector_int &back_referenced);
+  void stream_release_referrer(const vector_int &referenced);
+  void stream_release_waiters(const vector_int &waiters);
+  void stream_fully_complete(int object_id);
+  void stream_check_ready(int object_id);
+  void stream_finalized(int object_id);
+  void stream_release_aux_data(int object_id);
+  bool is_completed(int object_id) const;
+  bool is_fully_complete(int object_id) const;
+
   INLINE bool get_datagram(Datagram &datagram);
 
 public:
@@ -235,6 +260,10 @@ private:
   bool _long_object_id;
   bool _long_pta_id;
 
+  // This is set by set_error() when an object could not be restored
+  // correctly; it makes resolve() report failure.
+  bool _error;
+
   // This maps the type index numbers encountered within the Bam file
   // to actual TypeHandles.
   typedef phash_map<int, TypeHandle, int_hash> IndexMap;
@@ -249,11 +278,19 @@ private:
     INLINE CreatedObj();
     INLINE ~CreatedObj();
     INLINE void set_ptr(TypedWritable *ptr, ReferenceCount *ref_ptr);
+    INLINE void release_ref();
+    INLINE bool was_deleted() const;
 
   public:
     bool _created;
     TypedWritable *_ptr;
     ReferenceCount *_ref_ptr;
+
+    // In streaming mode, the reference above is released once the
+    // object has been handed to the ready callback; this then
+    // tells us whether the object is still around, in case the file
+    // refers to it again.
+    WPT(ReferenceCount) _weak_ref_ptr;
     ChangeThisFunc _change_this;
     ChangeThisRefFunc _change_this_ref;
   };
@@ -285,6 +322,14 @@ private:
     CyclerPointers _cycler_pointers;
     IntTags _int_tags;
     AuxTags _aux_tags;
+
+    // In streaming mode, these also list every object ID passed to
+    // read_pointer(), including those within cyclers, so we can tell
+    // when everything this object references is complete.  Pointers
+    // to objects that had already been created are listed in
+    // _back_referenced.
+    vector_int _referenced;
+    vector_int _back_referenced;
   };
   typedef phash_map<int, PointerReference, int_hash> ObjectPointers;
   ObjectPointers _object_pointers;
@@ -300,6 +345,53 @@ private:
   // when reading bam versions of 6.20 or higher.
   int _nesting_level;
 
+  // These are used only in streaming mode; see set_streaming().
+  // _stream_reads counts the objects read since the last incremental
+  // resolve pass.
+  bool _streaming;
+  PT(CallbackObject) _ready_callback;
+  int _stream_reads;
+
+  // The object read_object() is reading and will return, which we
+  // keep a reference to even after it has been handed off.
+  int _stream_root_id;
+
+  // This maps an object ID to the number of objects that have read a
+  // pointer to it and have not yet been completed, or to -1 once the
+  // object has been handed to the ready callback.
+  typedef phash_map<int, int, int_hash> StreamCounts;
+  StreamCounts _stream_referrers;
+
+  // This maps a completed object ID to the number of objects it
+  // references that it is still waiting on; and each of those
+  // objects to the list of object ID's that are waiting for it to be
+  // fully complete (or, for back references, merely completed).
+  // Objects within a reference cycle never leave these tables until
+  // finalize() is called.
+  StreamCounts _stream_pending;
+  typedef phash_map<int, vector_int, int_hash> StreamWaiters;
+  StreamWaiters _stream_waiters;
+  StreamWaiters _stream_completion_waiters;
+
+  // An object's aux data may still be wanted by the objects that
+  // reference it, when they are finalized (for instance, GeomNode
+  // stores "hold_state" on each RenderState), so it is kept until all
+  // of them have been.  This maps each object ID to the number of its
+  // referrers that have not yet been finalized, and each referrer
+  // that has not yet been finalized to the objects it references.
+  StreamCounts _stream_unfinalized;
+  StreamWaiters _stream_referenced;
+
+  // This is used by do_resolve() to record the objects completed in
+  // streaming mode.
+  class StreamCompleted {
+  public:
+    int _object_id;
+    vector_int _referenced;
+    vector_int _back_referenced;
+  };
+  typedef pvector<StreamCompleted> StreamCompletedList;
+
   // This is the set of all objects that registered themselves for
   // finalization.
   typedef phash_set<TypedWritable *, pointer_hash> Finalize;
@@ -317,6 +409,12 @@ private:
   typedef pdeque<SubfileInfo> FileDataRecords;
   FileDataRecords _file_data_records;
 
+  // Similarly, this is the queue of payload records we have read,
+  // which may still be decoding on other threads, and which a
+  // subsequent object will request.
+  typedef pdeque<PT(BamPayload) > Payloads;
+  Payloads _payloads;
+
   // This is used internally to record all of the new types created
   // on-the-fly to satisfy bam requirements.  We keep track of this
   // just so we can suppress warning messages from attempts to create
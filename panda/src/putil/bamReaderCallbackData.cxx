@@ -0,0 +1,32 @@
+// Filename: bamReaderCallbackData.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "bamReaderCallbackData.h"
+#include "typedWritable.h"
+
+TypeHandle BamReaderCallbackData::_type_handle;
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamReaderCallbackData::output
+//       Access: Published, Virtual
+//  Description:
+////////////////////////////////////////////////////////////////////
+void BamReaderCallbackData::
+output(ostream &out) const {
+  out << get_type() << "(";
+  if (_object != (TypedWritable *)NULL) {
+    out << _object->get_type() << " " << (void *)_object;
+  }
+  out << ")";
+}
@@ -0,0 +1,73 @@
+// Filename: bamReaderCallbackData.h
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef BAMREADERCALLBACKDATA_H
+#define BAMREADERCALLBACKDATA_H
+
+#include "pandabase.h"
+#include "callbackData.h"
+
+class BamReader;
+class TypedWritable;
+class ReferenceCount;
+
+////////////////////////////////////////////////////////////////////
+//       Class : BamReaderCallbackData
+// Description : This specialization on CallbackData is passed to the
+//               ready callback of a streaming BamReader, each time
+//               one of the objects it is reading, along with
+//               everything that object references, has been
+//               completely read, resolved, and finalized.  See
+//               BamReader::set_ready_callback().
+////////////////////////////////////////////////////////////////////
+class EXPCL_PANDA_PUTIL BamReaderCallbackData : public CallbackData {
+public:
+  INLINE BamReaderCallbackData(BamReader *manager, TypedWritable *object,
+                               ReferenceCount *ref_ptr);
+
+PUBLISHED:
+  virtual void output(ostream &out) const;
+
+  INLINE BamReader *get_manager() const;
+  INLINE TypedWritable *get_object() const;
+
+public:
+  INLINE ReferenceCount *get_ref_ptr() const;
+
+private:
+  BamReader *_manager;
+  TypedWritable *_object;
+  ReferenceCount *_ref_ptr;
+
+public:
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    CallbackData::init_type();
+    register_type(_type_handle, "BamReaderCallbackData",
+                  CallbackData::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "bamReaderCallbackData.I"
+
+#endif
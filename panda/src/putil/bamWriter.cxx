@@ -20,6 +20,7 @@
 #include "bam.h"
 #include "bamWriter.h"
 #include "bamReader.h"
+#include "bamPayload.h"
 #include "lightMutexHolder.h"
 
 #include <algorithm>
@@ -36,6 +37,7 @@ BamWriter(DatagramSink *target) :
   ++_writing_seq;
   _next_boc = BOC_adjunct;
   _needs_init = true;
+  _error = false;
 
   // Initialize the next object and PTA ID's.  These start counting at
   // 1, since 0 is reserved for NULL.
@@ -152,6 +154,12 @@ bool BamWriter::
 write_object(const TypedWritable *object) {
   nassertr(_target != NULL, false);
 
+  if (_error) {
+    // A previous object was not written completely, so the rest of
+    // the stream cannot be read back reliably.
+    return false;
+  }
+
   // Increment the _writing_seq, so we can check for newly stale
   // objects during this operation.
   ++_writing_seq;
@@ -384,6 +392,82 @@ write_file_data(SubfileInfo &result, const SubfileInfo &source) {
   // out in the same order and queued up in the BamReader.
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: BamWriter::write_payload
+//       Access: Public
+//  Description: Writes a large, self-contained block of data, such as
+//               a table of vertices, in its own payload record.  Like
+//               write_file_data(), this is written to the bam stream
+//               ahead of the datagram of the object that is being
+//               written, and it must be balanced by a matching call
+//               to BamReader::read_payload() on restore.  The reader
+//               may decode the data on another thread while it goes
+//               on reading the following objects.
+//
+//               The data is compressed if bam-compress-payloads is
+//               set; otherwise it is aligned within the file, so
+//               that it may be mapped directly into memory when it is
+//               read.  Returns true on success.
+////////////////////////////////////////////////////////////////////
+bool BamWriter::
+write_payload(const unsigned char *data, size_t size) {
+  BamPayload::Method method;
+  Datagram body;
+  if (!BamPayload::encode(method, body, data, size, bam_compress_payloads)) {
+    return false;
+  }
+
+  // We precede the data with a singleton datagram that contains the
+  // BOC_payload token, the method, and the size of the decoded data.
+  Datagram dg;
+  dg.add_uint8(BOC_payload);
+  dg.add_uint8(method);
+  dg.add_uint32(size);
+
+  if (method == BamPayload::M_raw) {
+    // Pad the header so that the raw data will begin on a 16-byte
+    // boundary within the file, so that a reader that maps the file
+    // can use the data in place.  Each datagram is preceded by its
+    // 4-byte length.  The reader ignores the padding.
+    static const size_t alignment = 16;
+    streampos pos = _target->get_file_pos();
+    if (pos > 0) {
+      size_t data_start = (size_t)pos + 4 + dg.get_length() + 4;
+      dg.pad_bytes((alignment - data_start % alignment) % alignment);
+    }
+  }
+
+  if (!_target->put_datagram(dg)) {
+    util_cat.error()
+      << "Unable to write data to output.\n";
+    return false;
+  }
+
+  // Then we write the data itself, as its own followup datagram.
+  if (!_target->put_datagram(body)) {
+    util_cat.error()
+      << "Unable to write payload data to output.\n";
+    return false;
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: BamWriter::set_error
+//       Access: Public
+//  Description: May be called by an object's write_datagram() method
+//               to indicate that it could not be written completely,
+//               for instance because write_payload() failed.  The
+//               current call to write_object() will then return
+//               false, as will all subsequent calls, since the bam
+//               stream can no longer be read back reliably.
+////////////////////////////////////////////////////////////////////
+void BamWriter::
+set_error() {
+  _error = true;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: BamWriter::write_cdata
 //       Access: Public
@@ -720,6 +804,11 @@ flush_queue() {
       // writing or something like that, so it's more convenient to
       // cheat and define it as a non-const method.
       ((TypedWritable *)object)->write_datagram(this, dg);
+      if (_error) {
+        util_cat.error()
+          << "Unable to write " << type << " object to output.\n";
+        return false;
+      }
 
       (*si).second._written_seq = _writing_seq;
       (*si).second._modified = object->get_bam_modified();
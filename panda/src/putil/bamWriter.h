@@ -99,6 +99,8 @@ public:
 
   void write_file_data(SubfileInfo &result, const Filename &filename);
   void write_file_data(SubfileInfo &result, const SubfileInfo &source);
+  bool write_payload(const unsigned char *data, size_t size);
+  void set_error();
 
   void write_cdata(Datagram &packet, const PipelineCyclerBase &cycler);
   void write_cdata(Datagram &packet, const PipelineCyclerBase &cycler,
@@ -173,6 +175,10 @@ private:
   DatagramSink *_target;
   bool _needs_init;
 
+  // This is set by set_error() when an object could not be written
+  // completely; once it is set, write_object() always fails.
+  bool _error;
+
   friend class TypedWritable;
 };
 
@@ -17,6 +17,7 @@
 #include "bamCacheIndex.h"
 #include "bamCacheRecord.h"
 #include "bamReader.h"
+#include "bamReaderCallbackData.h"
 #include "bamReaderParam.h"
 #include "bitArray.h"
 #include "bitMask.h"
@@ -79,6 +80,41 @@ ConfigVariableEnum<BamEnums::BamTextureMode> bam_texture_mode
  PRC_DESC("Set this to specify how textures should be written into Bam files."
           "See the panda source or documentation for available options."));
 
+ConfigVariableInt bam_payload_threshold
+("bam-payload-threshold", 0,
+ PRC_DESC("If this is nonzero, blocks of vertex data at least this many "
+          "bytes long are written to bam files in separate payload "
+          "records, which can be decoded on the bam-decode-threads while "
+          "the rest of the file is read.  The default, 0, writes all "
+          "vertex data inline, as in older bam files."));
+
+ConfigVariableBool bam_compress_payloads
+("bam-compress-payloads", false,
+ PRC_DESC("Set this true to compress the payload records written to bam "
+          "files with zlib.  This makes the files smaller, at the cost of "
+          "decompressing them again when they are read, which is done on "
+          "the bam-decode-threads if there are any."));
+
+ConfigVariableInt bam_decode_threads
+("bam-decode-threads", 0,
+ PRC_DESC("The number of threads to start for decoding bam payload records "
+          "in the background while the rest of the bam file is read.  If "
+          "this is 0, each payload is decoded by the thread that reads it, "
+          "when it is needed."));
+
+ConfigVariableBool bam_mmap
+("bam-mmap", false,
+ PRC_DESC("Set this true to allow the uncompressed payload records of a bam "
+          "file read from disk (or from an uncompressed subfile of a "
+          "Multifile) to be used in place, via a memory mapping of the "
+          "file, rather than copied into memory.  Vertex data loaded this "
+          "way is only copied if it is modified.  The file must not be "
+          "truncated or rewritten while any of its data is still in use: "
+          "on most platforms, touching vertex data from a truncated file "
+          "crashes the program with SIGBUS.  On Windows, the file cannot "
+          "be replaced or deleted while it is mapped, which may prevent "
+          "the BamCache from updating its cache files."));
+
 ConfigureFn(config_util) {
   init_libputil();
 }
@@ -179,6 +215,7 @@ init_libputil() {
   BamCacheIndex::init_type();
   BamCacheRecord::init_type();
   BamReaderAuxData::init_type();
+  BamReaderCallbackData::init_type();
   BamReaderParam::init_type();
   BitArray::init_type();
   BitMask16::init_type("BitMask16");
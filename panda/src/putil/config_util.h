@@ -20,6 +20,8 @@
 #include "configVariableSearchPath.h"
 #include "configVariableEnum.h"
 #include "configVariableDouble.h"
+#include "configVariableInt.h"
+#include "configVariableBool.h"
 #include "bamEnums.h"
 #include "dconfig.h"
 
@@ -38,6 +40,10 @@ NotifyCategoryDecl(bam, EXPCL_PANDA_PUTIL, EXPTP_PANDA_PUTIL);
 extern EXPCL_PANDA_PUTIL ConfigVariableEnum<BamEnums::BamEndian> bam_endian;
 extern EXPCL_PANDA_PUTIL ConfigVariableBool bam_stdfloat_double;
 extern EXPCL_PANDA_PUTIL ConfigVariableEnum<BamEnums::BamTextureMode> bam_texture_mode;
+extern EXPCL_PANDA_PUTIL ConfigVariableInt bam_payload_threshold;
+extern EXPCL_PANDA_PUTIL ConfigVariableBool bam_compress_payloads;
+extern EXPCL_PANDA_PUTIL ConfigVariableInt bam_decode_threads;
+extern EXPCL_PANDA_PUTIL ConfigVariableBool bam_mmap;
 
 BEGIN_PUBLISH
 EXPCL_PANDA_PUTIL ConfigVariableSearchPath &get_model_path();
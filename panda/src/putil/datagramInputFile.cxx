@@ -98,6 +98,10 @@ close() {
 
   _read_first_datagram = false;
   _error = false;
+
+  _checked_mapping = false;
+  _mapping.clear();
+  _mapped_start = 0;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -383,3 +387,107 @@ get_file_pos() {
   }
   return _in->tellg();
 }
+
+////////////////////////////////////////////////////////////////////
+//     Function: DatagramInputFile::map_datagram
+//       Access: Public, Virtual
+//  Description: Skips over the next datagram without extracting it,
+//               and instead returns a pointer to its contents within
+//               a memory-mapped view of the file.  This is only
+//               possible when the file was opened by name, and its
+//               contents are stored on disk as they are read (that
+//               is, not compressed or encrypted).
+//
+//               Returns true on success, or false if the datagram
+//               cannot be mapped, in which case nothing is consumed.
+////////////////////////////////////////////////////////////////////
+bool DatagramInputFile::
+map_datagram(PT(MappedFile) &mapping, const unsigned char *&data,
+             size_t &size) {
+  nassertr(_in != (istream *)NULL, false);
+
+  if (!_checked_mapping) {
+    _checked_mapping = true;
+    open_mapping();
+  }
+  if (_mapping == (MappedFile *)NULL) {
+    return false;
+  }
+
+  streampos pos = _in->tellg();
+  if (pos < 0) {
+    return false;
+  }
+  const unsigned char *mapped_data = _mapping->get_data();
+  size_t mapped_size = _mapping->get_size();
+  size_t start = _mapped_start + (size_t)pos;
+
+  // Read the size of the upcoming datagram from the stream, and make
+  // sure the mapping agrees with it, as a check that we are really
+  // looking at the same bytes.
+  unsigned char length_bytes[4];
+  _in->read((char *)length_bytes, 4);
+  if (_in->fail() || _in->eof() || start + 4 > mapped_size ||
+      memcmp(length_bytes, mapped_data + start, 4) != 0) {
+    if (util_cat.is_debug()) {
+      util_cat.debug()
+        << "Mapping of " << _filename << " does not match the stream.\n";
+    }
+    _in->clear();
+    _in->seekg(pos);
+    _mapping.clear();
+    return false;
+  }
+
+  size_t num_bytes = (size_t)length_bytes[0] | ((size_t)length_bytes[1] << 8) |
+    ((size_t)length_bytes[2] << 16) | ((size_t)length_bytes[3] << 24);
+  if (num_bytes == (PN_uint32)-1 || start + 4 + num_bytes > mapped_size) {
+    // We don't bother to map the rare 64-bit sized datagrams.
+    _in->seekg(pos);
+    return false;
+  }
+
+  _read_first_datagram = true;
+  _in->seekg(num_bytes, ios::cur);
+
+  mapping = _mapping;
+  data = mapped_data + start + 4;
+  size = num_bytes;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: DatagramInputFile::open_mapping
+//       Access: Private
+//  Description: Maps the file on disk that contains this stream, if
+//               there is one, for the benefit of map_datagram().
+////////////////////////////////////////////////////////////////////
+void DatagramInputFile::
+open_mapping() {
+  if (_vfile == (VirtualFile *)NULL) {
+    return;
+  }
+
+  // A .pz file is decompressed as it is read, so the bytes on disk
+  // are not the bytes of the stream.
+  if (_vfile->get_filename().get_extension() == "pz") {
+    return;
+  }
+
+  SubfileInfo info;
+  if (!_vfile->get_system_info(info)) {
+    return;
+  }
+
+  PT(MappedFile) mapping = new MappedFile;
+  if (mapping->open(info.get_filename()) &&
+      (size_t)info.get_start() + info.get_size() <= mapping->get_size()) {
+    _mapping = mapping;
+    _mapped_start = (size_t)info.get_start();
+  } else {
+    if (util_cat.is_debug()) {
+      util_cat.debug()
+        << "Unable to map " << info.get_filename() << "\n";
+    }
+  }
+}
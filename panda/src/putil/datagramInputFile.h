@@ -52,7 +52,14 @@ PUBLISHED:
   virtual VirtualFile *get_vfile();
   virtual streampos get_file_pos();
 
+public:
+  virtual bool map_datagram(PT(MappedFile) &mapping,
+                            const unsigned char *&data, size_t &size);
+
 private:
+  void open_mapping();
+
+
   bool _read_first_datagram;
   bool _error;
   CPT(FileReference) _file;
@@ -61,6 +68,13 @@ private:
   bool _owns_in;
   Filename _filename;
   time_t _timestamp;
+
+  // A read-only view of the file on disk that contains the stream,
+  // if it could be mapped.  It is opened the first time
+  // map_datagram() is called.
+  bool _checked_mapping;
+  PT(MappedFile) _mapping;
+  size_t _mapped_start;
 };
 
 #include "datagramInputFile.I"
@@ -4,7 +4,9 @@
 #include "bamCacheIndex.cxx"
 #include "bamCacheRecord.cxx"
 #include "bamEnums.cxx"
+#include "bamPayload.cxx"
 #include "bamReader.cxx"
+#include "bamReaderCallbackData.cxx"
 #include "bamReaderParam.cxx"
 #include "bamWriter.cxx"
 #include "bitArray.cxx"
@@ -25,7 +25,9 @@
     tinySDLGraphicsWindow.h tinySDLGraphicsWindow.I \
     tinyGraphicsBuffer.h tinyGraphicsBuffer.I \
     tinyGraphicsStateGuardian.h tinyGraphicsStateGuardian.I \
+    tinyOcclusionQueryContext.I tinyOcclusionQueryContext.h \
     tinyTextureContext.I tinyTextureContext.h \
+    tinyTileRasterizer.I tinyTileRasterizer.h \
     tinyWinGraphicsPipe.I tinyWinGraphicsPipe.h \
     tinyWinGraphicsWindow.h tinyWinGraphicsWindow.I \
     tinyXGraphicsPipe.I tinyXGraphicsPipe.h \
@@ -58,11 +60,13 @@
     tinyGeomMunger.cxx \
     tinyGraphicsBuffer.cxx \
     tinyGraphicsStateGuardian.cxx \
+    tinyOcclusionQueryContext.cxx \
     tinyOffscreenGraphicsPipe.cxx \
     tinyOsxGraphicsPipe.cxx \
     tinySDLGraphicsPipe.cxx \
     tinySDLGraphicsWindow.cxx \
     tinyTextureContext.cxx \
+    tinyTileRasterizer.cxx \
     tinyWinGraphicsPipe.cxx \
     tinyWinGraphicsWindow.cxx \
     tinyXGraphicsPipe.cxx \
@@ -75,3 +79,44 @@
 
 #end lib_target
 
+
+#begin test_bin_target
+  #define TARGET test_instancing
+  #define LOCAL_LIBS \
+    p3tinydisplay p3display p3cull p3pgraph
+
+  #define SOURCES \
+    test_instancing.cxx
+
+#end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_tile_rasterizer
+  #define LOCAL_LIBS \
+    p3tinydisplay p3display p3pgraph
+
+  #define SOURCES \
+    test_tile_rasterizer.cxx
+
+#end test_bin_target
+
+
+#begin test_bin_target
+  #define TARGET test_span_fill
+  #define LOCAL_LIBS \
+    p3tinydisplay p3mathutil
+
+  #define SOURCES \
+    test_span_fill.cxx
+
+#end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_hierarchical_z
+  #define LOCAL_LIBS \
+    p3tinydisplay p3mathutil
+
+  #define SOURCES \
+    test_hierarchical_z.cxx
+
+#end test_bin_target
@@ -26,6 +26,7 @@
 #include "tinyGraphicsStateGuardian.h"
 #include "tinyGeomMunger.h"
 #include "tinyTextureContext.h"
+#include "tinyOcclusionQueryContext.h"
 #include "graphicsPipeSelection.h"
 #include "dconfig.h"
 #include "pandaSystem.h"
@@ -74,6 +75,45 @@ ConfigVariableBool td_perspective_textures
             "textures on the tinydisplay software renderer, for a small "
             "performance gain."));
 
+ConfigVariableInt td_render_threads
+  ("td-render-threads", 0,
+   PRC_DESC("Set this to a number greater than 1 to have the tinydisplay "
+            "software renderer rasterize its triangles on that many "
+            "threads.  The triangles are collected into horizontal bands "
+            "of the screen as they are drawn, and each band is filled by "
+            "one thread when the frame is finished, or when the frame "
+            "buffer is needed sooner.  The rendered image is the same "
+            "either way.  The Pixels counters in PStats are not "
+            "reliable in this mode."));
+
+ConfigVariableInt td_tile_height
+  ("td-tile-height", 32,
+   PRC_DESC("The number of rows in each of the bands of the screen that "
+            "are rasterized in parallel when td-render-threads is "
+            "greater than 1.  Smaller bands balance the work better "
+            "between threads, at the cost of drawing the edges of each "
+            "large triangle once per band.  This is rounded up to a "
+            "multiple of 8."));
+
+ConfigVariableBool td_simd
+  ("td-simd", true,
+   PRC_DESC("Set this true to allow the tinydisplay software renderer to "
+            "use its SSE2 code paths, where they have been compiled in, "
+            "to fill untextured spans four pixels at a time and to "
+            "bilinear filter textures.  Set it false to use only the "
+            "plain C code, for instance to compare their speed; the "
+            "rendered image is the same either way."));
+
+ConfigVariableBool td_hierarchical_z
+  ("td-hierarchical-z", true,
+   PRC_DESC("Set this true to have the tinydisplay software renderer keep "
+            "the nearest-guaranteed depth of each 8x8 tile of the depth "
+            "buffer, and use it to reject triangles, and rows of "
+            "triangles, that are certain to be hidden behind what has "
+            "already been drawn, without testing each pixel.  This helps "
+            "most when the scene is drawn roughly front to back.  The "
+            "rendered image is the same either way."));
+
 ////////////////////////////////////////////////////////////////////
 //     Function: init_libtinydisplay
 //  Description: Initializes the library.  This must be called at
@@ -94,6 +134,7 @@ init_libtinydisplay() {
   TinyGraphicsStateGuardian::init_type();
   TinyGeomMunger::init_type();
   TinyTextureContext::init_type();
+  TinyOcclusionQueryContext::init_type();
 
   PandaSystem *ps = PandaSystem::get_global_ptr();
   ps->add_system("TinyPanda");
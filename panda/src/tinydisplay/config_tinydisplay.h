@@ -34,5 +34,9 @@ extern ConfigVariableInt td_texture_ram;
 extern ConfigVariableBool td_ignore_mipmaps;
 extern ConfigVariableBool td_ignore_clamp;
 extern ConfigVariableBool td_perspective_textures;
+extern ConfigVariableInt td_render_threads;
+extern ConfigVariableInt td_tile_height;
+extern ConfigVariableBool td_simd;
+extern ConfigVariableBool td_hierarchical_z;
 
 #endif
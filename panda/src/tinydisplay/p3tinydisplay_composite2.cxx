@@ -4,11 +4,13 @@
 #include "tinyOsxGraphicsPipe.h"
 
 #include "tinyGraphicsStateGuardian.cxx"
+#include "tinyOcclusionQueryContext.cxx"
 #include "tinyOffscreenGraphicsPipe.cxx"
 #include "tinyOsxGraphicsPipe.cxx"
 #include "tinySDLGraphicsPipe.cxx"
 #include "tinySDLGraphicsWindow.cxx"
 #include "tinyTextureContext.cxx"
+#include "tinyTileRasterizer.cxx"
 #include "tinyWinGraphicsPipe.cxx"
 #include "tinyWinGraphicsWindow.cxx"
 #include "tinyXGraphicsPipe.cxx"
@@ -0,0 +1,161 @@
+// Filename: test_hierarchical_z.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pandabase.h"
+#include "zbuffer.h"
+#include "ztriangle_table.h"
+#include "pvector.h"
+#include "trueClock.h"
+#include "randomizer.h"
+
+// This program measures the effect of the coarse depth buffer on the
+// tinydisplay triangle functions, by filling a deep stack of
+// overlapping triangles, drawn front to back and then back to front,
+// with zb_use_hiz off and on.  Now and then a triangle is drawn
+// without the depth test, which may push depth values farther away.
+// It checks that both settings produce exactly the same pixels, and
+// that the pixel counts used for occlusion queries are the same.
+
+static const int x_size = 1920;
+static const int y_size = 1080;
+static const int num_triangles = 10000;
+static const int num_passes = 3;
+
+// A triangle to draw, with random position and colors, and a depth
+// that depends on its position in the list.
+struct Triangle {
+  ZBufferPoint _p[3];
+  bool _depth_test;
+};
+
+static void
+make_triangles(Randomizer &random, bool front_to_back,
+               pvector<Triangle> &triangles) {
+  triangles.resize(num_triangles);
+  for (int i = 0; i < num_triangles; ++i) {
+    int cx = random.random_int(x_size);
+    int cy = random.random_int(y_size);
+    int step = (int)((PN_int64)i * 0x10000000 / num_triangles);
+    int cz = 0x20000000 + (front_to_back ? -step : step) +
+      random.random_int(0x1000000);
+    for (int vi = 0; vi < 3; ++vi) {
+      ZBufferPoint &p = triangles[i]._p[vi];
+      memset(&p, 0, sizeof(p));
+      p.x = max(min(cx + random.random_int(600) - 300, x_size - 1), 0);
+      p.y = max(min(cy + random.random_int(600) - 300, y_size - 1), 0);
+      p.z = cz + random.random_int(0x100000);
+      p.r = random.random_int(ZB_POINT_RED_MAX + 1);
+      p.g = random.random_int(ZB_POINT_GREEN_MAX + 1);
+      p.b = random.random_int(ZB_POINT_BLUE_MAX + 1);
+      p.a = random.random_int(ZB_POINT_ALPHA_MAX + 1);
+    }
+    triangles[i]._depth_test = (i % 97) != 0;
+  }
+}
+
+// Clears the buffer, fills all of the triangles num_passes times, and
+// returns the average number of milliseconds per pass.  The opaque,
+// smooth-shaded, untextured fill functions are used, indexed as
+// [depth write][color write][alpha test][depth test][texture filter]
+// [shade model][texturing]; if counting is true, the depth-tested
+// triangles go through the counting store function that an occlusion
+// query would install, and the number of pixels counted in the last
+// pass is stored in count.
+static double
+fill(ZBuffer *zb, const pvector<Triangle> &triangles, bool counting,
+     unsigned int &count) {
+  ZB_fillTriangleFunc fill_tri = fill_tri_funcs[0][0][0][1][0][2][0];
+  if (counting) {
+    zb->store_pix_func = ZB_store_pixel_count_store;
+    fill_tri = fill_tri_funcs[0][2][0][1][0][2][0];
+  }
+  ZB_fillTriangleFunc fill_tri_no_test = fill_tri_funcs[0][0][0][0][0][2][0];
+
+  TrueClock *true_clock = TrueClock::get_global_ptr();
+  double elapsed = 0.0;
+
+  for (int pass = 0; pass < num_passes; ++pass) {
+    ZB_clear(zb, 1, 0, 1, 0);
+    zb->occlusion_count = 0;
+
+    double start = true_clock->get_short_time();
+    for (int i = 0; i < num_triangles; ++i) {
+      // The fill functions may modify the points.
+      Triangle tri = triangles[i];
+      (*(tri._depth_test ? fill_tri : fill_tri_no_test))
+        (zb, &tri._p[0], &tri._p[1], &tri._p[2]);
+    }
+    elapsed += true_clock->get_short_time() - start;
+  }
+
+  count = zb->occlusion_count;
+  return elapsed * 1000.0 / num_passes;
+}
+
+// Compares the color and depth buffers of the two ZBuffers, and
+// returns the number of pixels that differ.
+static int
+count_differences(const ZBuffer *a, const ZBuffer *b) {
+  int num_different = 0;
+  for (int i = 0; i < x_size * y_size; ++i) {
+    if (a->pbuf[i] != b->pbuf[i] || a->zbuf[i] != b->zbuf[i]) {
+      ++num_different;
+    }
+  }
+  return num_different;
+}
+
+int
+main(int argc, char *argv[]) {
+  Randomizer random(1);
+
+  ZBuffer *zb_plain = ZB_open(x_size, y_size, ZB_MODE_RGBA, 0, NULL, NULL, NULL);
+  ZBuffer *zb_hiz = ZB_open(x_size, y_size, ZB_MODE_RGBA, 0, NULL, NULL, NULL);
+
+  bool ok = true;
+
+  static const char *order_names[] = { "back_to_front", "front_to_back" };
+  for (int order = 0; order < 2; ++order) {
+    pvector<Triangle> triangles;
+    make_triangles(random, order != 0, triangles);
+
+    for (int counting = 0; counting < 2; ++counting) {
+      unsigned int plain_count, hiz_count;
+      zb_use_hiz = 0;
+      double plain_ms = fill(zb_plain, triangles, counting != 0, plain_count);
+      zb_use_hiz = 1;
+      double hiz_ms = fill(zb_hiz, triangles, counting != 0, hiz_count);
+
+      nout << order_names[order] << (counting ? " (counting)" : "") << ": "
+           << plain_ms << " ms plain, " << hiz_ms << " ms hierarchical, "
+           << plain_ms / hiz_ms << "x\n";
+
+      int num_different = count_differences(zb_plain, zb_hiz);
+      if (num_different != 0) {
+        nout << "  " << num_different << " pixels differ!\n";
+        ok = false;
+      }
+      if (plain_count != hiz_count) {
+        nout << "  counted " << plain_count << " pixels plain, but "
+             << hiz_count << " hierarchical!\n";
+        ok = false;
+      }
+    }
+  }
+
+  ZB_close(zb_plain);
+  ZB_close(zb_hiz);
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,188 @@
+// Filename: test_instancing.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pandabase.h"
+#include "tinyOffscreenGraphicsPipe.h"
+#include "config_tinydisplay.h"
+#include "graphicsEngine.h"
+#include "graphicsOutput.h"
+#include "displayRegion.h"
+#include "frameBufferProperties.h"
+#include "windowProperties.h"
+#include "camera.h"
+#include "perspectiveLens.h"
+#include "geomNode.h"
+#include "geomTriangles.h"
+#include "geomVertexWriter.h"
+#include "nodePath.h"
+#include "pnmImage.h"
+#include "config_cull.h"
+#include "trueClock.h"
+#include "randomizer.h"
+
+// This program renders a forest of copies of the same Geom, with the
+// same state, in an offscreen tinydisplay buffer, first with
+// cull-instancing off and then on.  It reports the time spent on each
+// frame, and checks that both settings render exactly the same image.
+
+static const int buffer_size = 256;
+static const int num_trees = 3000;
+static const int num_frames = 20;
+
+// Makes a simple four-sided pyramid, with a different color at each
+// vertex.
+static PT(Geom)
+make_tree() {
+  PT(GeomVertexData) data = new GeomVertexData
+    ("tree", GeomVertexFormat::get_v3c4(), Geom::UH_static);
+  GeomVertexWriter vertex(data, InternalName::get_vertex());
+  GeomVertexWriter color(data, InternalName::get_color());
+  vertex.add_data3(-0.5f, -0.5f, 0.0f);
+  vertex.add_data3(0.5f, -0.5f, 0.0f);
+  vertex.add_data3(0.5f, 0.5f, 0.0f);
+  vertex.add_data3(-0.5f, 0.5f, 0.0f);
+  vertex.add_data3(0.0f, 0.0f, 2.0f);
+  color.add_data4(0.1f, 0.3f, 0.1f, 1.0f);
+  color.add_data4(0.1f, 0.5f, 0.1f, 1.0f);
+  color.add_data4(0.2f, 0.6f, 0.2f, 1.0f);
+  color.add_data4(0.1f, 0.4f, 0.1f, 1.0f);
+  color.add_data4(0.6f, 0.9f, 0.6f, 1.0f);
+
+  PT(GeomTriangles) tris = new GeomTriangles(Geom::UH_static);
+  for (int i = 0; i < 4; ++i) {
+    tris->add_vertices(i, (i + 1) % 4, 4);
+  }
+  tris->add_vertices(0, 2, 1);
+  tris->add_vertices(0, 3, 2);
+
+  PT(Geom) geom = new Geom(data);
+  geom->add_primitive(tris);
+  return geom;
+}
+
+// Scatters num_trees copies of the tree across a field in front of
+// the camera.  Each copy is a separate GeomNode, but they all share
+// the same Geom and the same state.
+static NodePath
+make_forest() {
+  NodePath forest("forest");
+  PT(Geom) tree = make_tree();
+  CPT(RenderState) state = RenderState::make_empty();
+
+  Randomizer random(1);
+  for (int i = 0; i < num_trees; ++i) {
+    PT(GeomNode) node = new GeomNode("tree");
+    node->add_geom(tree, state);
+    NodePath np = forest.attach_new_node(node);
+    np.set_pos(random.random_real(200.0) - 100.0,
+               20.0 + random.random_real(200.0), -2.0);
+    np.set_h(random.random_real(90.0));
+    np.set_scale(0.5 + random.random_real(1.0));
+  }
+  return forest;
+}
+
+// Renders num_frames frames, returning the average number of
+// milliseconds per frame, and stores the final frame in image.
+static double
+run(GraphicsEngine *engine, GraphicsOutput *buffer, bool instancing,
+    PNMImage &image) {
+  cull_instancing = instancing;
+
+  // Render one frame first, so that both runs start with the Geom
+  // and its munged vertex data already prepared.
+  engine->render_frame();
+
+  TrueClock *true_clock = TrueClock::get_global_ptr();
+  double start = true_clock->get_short_time();
+  for (int frame = 0; frame < num_frames; ++frame) {
+    engine->render_frame();
+  }
+  engine->sync_frame();
+  double elapsed = true_clock->get_short_time() - start;
+
+  buffer->get_screenshot(image);
+  return elapsed * 1000.0 / num_frames;
+}
+
+int
+main(int argc, char *argv[]) {
+  init_libtinydisplay();
+
+  PT(GraphicsPipe) pipe = new TinyOffscreenGraphicsPipe;
+  PT(GraphicsEngine) engine = new GraphicsEngine;
+
+  FrameBufferProperties fb_prop;
+  fb_prop.set_rgb_color(true);
+  fb_prop.set_depth_bits(16);
+  GraphicsOutput *buffer =
+    engine->make_output(pipe, "buffer", 0, fb_prop,
+                        WindowProperties::size(buffer_size, buffer_size),
+                        GraphicsPipe::BF_refuse_window);
+  if (buffer == (GraphicsOutput *)NULL) {
+    nout << "Unable to open an offscreen tinydisplay buffer.\n";
+    return 1;
+  }
+
+  NodePath render("render");
+  make_forest().reparent_to(render);
+
+  PT(Camera) camera = new Camera("camera");
+  camera->set_lens(new PerspectiveLens);
+  NodePath camera_np = render.attach_new_node(camera);
+  camera_np.set_pos(0.0f, 0.0f, 3.0f);
+  camera_np.set_p(-5.0f);
+  camera->set_scene(render);
+
+  DisplayRegion *dr = buffer->make_display_region();
+  dr->set_camera(camera_np);
+
+  PNMImage reference, result;
+  double base_ms = run(engine, buffer, false, reference);
+  double ms = run(engine, buffer, true, result);
+  nout << num_trees << " trees: " << base_ms << " ms per frame without "
+       << "instancing, " << ms << " ms with, " << base_ms / ms << "x\n";
+
+  bool ok = true;
+  if (reference.get_x_size() != buffer_size ||
+      result.get_x_size() != buffer_size) {
+    nout << "  Unable to read back the rendered images!\n";
+    ok = false;
+
+  } else {
+    int num_drawn = 0;
+    int num_different = 0;
+    for (int y = 0; y < buffer_size; ++y) {
+      for (int x = 0; x < buffer_size; ++x) {
+        if (reference.get_xel(x, y) != reference.get_xel(0, 0)) {
+          ++num_drawn;
+        }
+        if (reference.get_xel(x, y) != result.get_xel(x, y)) {
+          ++num_different;
+        }
+      }
+    }
+    if (num_drawn == 0) {
+      nout << "  No trees were drawn!\n";
+      ok = false;
+    }
+    if (num_different != 0) {
+      nout << "  " << num_different << " pixels differ with instancing!\n";
+      ok = false;
+    }
+  }
+
+  engine->remove_all_windows();
+  return ok ? 0 : 1;
+}
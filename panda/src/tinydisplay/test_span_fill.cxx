@@ -0,0 +1,227 @@
+// Filename: test_span_fill.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pandabase.h"
+#include "zbuffer.h"
+#include "ztriangle_table.h"
+#include "pvector.h"
+#include "trueClock.h"
+#include "randomizer.h"
+
+// This program measures the raw fill rate of the tinydisplay triangle
+// functions, and the speed of its bilinear texture filters, with the
+// SSE2 code paths enabled and disabled.  It calls the fill functions
+// directly on a ZBuffer, so none of the rest of the renderer is
+// involved, and checks that both paths produce exactly the same
+// pixels.
+
+static const int x_size = 1920;
+static const int y_size = 1080;
+static const int num_triangles = 2000;
+static const int num_passes = 5;
+static const int num_lookups = 4000000;
+
+static const int tex_bits = 8;
+
+// A triangle to draw, with random position, depth and colors.
+struct Triangle {
+  ZBufferPoint _p[3];
+};
+
+static void
+make_triangles(Randomizer &random, pvector<Triangle> &triangles) {
+  triangles.resize(num_triangles);
+  for (int i = 0; i < num_triangles; ++i) {
+    int cx = random.random_int(x_size);
+    int cy = random.random_int(y_size);
+    for (int vi = 0; vi < 3; ++vi) {
+      ZBufferPoint &p = triangles[i]._p[vi];
+      memset(&p, 0, sizeof(p));
+      p.x = max(min(cx + random.random_int(400) - 200, x_size - 1), 0);
+      p.y = max(min(cy + random.random_int(400) - 200, y_size - 1), 0);
+      p.z = random.random_int(0x3fffffff);
+      p.r = random.random_int(ZB_POINT_RED_MAX + 1);
+      p.g = random.random_int(ZB_POINT_GREEN_MAX + 1);
+      p.b = random.random_int(ZB_POINT_BLUE_MAX + 1);
+      p.a = random.random_int(ZB_POINT_ALPHA_MAX + 1);
+    }
+  }
+}
+
+// Clears the buffer, fills all of the triangles with the indicated
+// function num_passes times, and returns the average number of
+// milliseconds per pass.
+static double
+fill(ZBuffer *zb, ZB_fillTriangleFunc fill_tri,
+     const pvector<Triangle> &triangles) {
+  TrueClock *true_clock = TrueClock::get_global_ptr();
+  double elapsed = 0.0;
+
+  for (int pass = 0; pass < num_passes; ++pass) {
+    ZB_clear(zb, 1, 0, 1, 0);
+
+    double start = true_clock->get_short_time();
+    for (int i = 0; i < num_triangles; ++i) {
+      // The fill functions may modify the points.
+      Triangle tri = triangles[i];
+      (*fill_tri)(zb, &tri._p[0], &tri._p[1], &tri._p[2]);
+    }
+    elapsed += true_clock->get_short_time() - start;
+  }
+
+  return elapsed * 1000.0 / num_passes;
+}
+
+// Calls the indicated texture lookup function num_lookups times with
+// random coordinates, and returns the number of milliseconds taken.
+// The xor of all the results is stored in checksum.
+static double
+lookup(ZTextureDef *texture_def, ZB_lookupTextureFunc func,
+       const pvector<int> &coords, PIXEL &checksum) {
+  TrueClock *true_clock = TrueClock::get_global_ptr();
+  double start = true_clock->get_short_time();
+
+  PIXEL result = 0;
+  for (int i = 0; i < num_lookups; ++i) {
+    const int *c = &coords[i * 4];
+    result ^= (*func)(texture_def, c[0], c[1], c[2], c[3]);
+  }
+
+  checksum = result;
+  return (true_clock->get_short_time() - start) * 1000.0;
+}
+
+// Compares the color and depth buffers of the two ZBuffers, and
+// returns the number of pixels that differ.
+static int
+count_differences(const ZBuffer *a, const ZBuffer *b) {
+  int num_different = 0;
+  for (int i = 0; i < x_size * y_size; ++i) {
+    if (a->pbuf[i] != b->pbuf[i] || a->zbuf[i] != b->zbuf[i]) {
+      ++num_different;
+    }
+  }
+  return num_different;
+}
+
+int
+main(int argc, char *argv[]) {
+#ifndef ZB_SSE2
+  nout << "The SSE2 code paths are not compiled in.\n";
+#endif
+
+  Randomizer random(1);
+  pvector<Triangle> triangles;
+  make_triangles(random, triangles);
+
+  ZBuffer *zb_plain = ZB_open(x_size, y_size, ZB_MODE_RGBA, 0, NULL, NULL, NULL);
+  ZBuffer *zb_simd = ZB_open(x_size, y_size, ZB_MODE_RGBA, 0, NULL, NULL, NULL);
+
+  bool ok = true;
+
+  // The opaque, depth-tested, depth-writing variants of the untextured
+  // fill functions, indexed as [depth write][color write][alpha test]
+  // [depth test][texture filter][shade model][texturing].
+  static const char *shade_names[] = { "white", "flat", "smooth" };
+  for (int shade = 0; shade < 3; ++shade) {
+    ZB_fillTriangleFunc fill_tri = fill_tri_funcs[0][0][0][1][0][shade][0];
+
+    zb_use_simd = 0;
+    double plain_ms = fill(zb_plain, fill_tri, triangles);
+    zb_use_simd = 1;
+    double simd_ms = fill(zb_simd, fill_tri, triangles);
+
+    nout << shade_names[shade] << "_untextured: "
+         << plain_ms << " ms plain, " << simd_ms << " ms SSE2, "
+         << plain_ms / simd_ms << "x\n";
+
+    int num_different = count_differences(zb_plain, zb_simd);
+    if (num_different != 0) {
+      nout << "  " << num_different << " pixels differ!\n";
+      ok = false;
+    }
+  }
+
+  ZB_close(zb_plain);
+  ZB_close(zb_simd);
+
+  // Now make a random texture, with a full set of mipmap levels, in
+  // the same layout the GSG uses.
+  int tex_size = 1 << tex_bits;
+  pvector<PIXEL> pixmap(tex_size * tex_size);
+  for (int i = 0; i < tex_size * tex_size; ++i) {
+    pixmap[i] = (PIXEL)random.random_int(0x10000) << 16 | (PIXEL)random.random_int(0x10000);
+  }
+
+  ZTextureLevel levels[MAX_MIPMAP_LEVELS];
+  for (int level = 0; level < MAX_MIPMAP_LEVELS; ++level) {
+    int bits = max(tex_bits - level, 0);
+    ZTextureLevel &dest = levels[level];
+    dest.pixmap = &pixmap[0];
+    dest.s_mask = ((1 << (bits + ZB_POINT_ST_FRAC_BITS)) - (1 << ZB_POINT_ST_FRAC_BITS)) << level;
+    dest.t_mask = dest.s_mask;
+    dest.s_shift = (ZB_POINT_ST_FRAC_BITS + level);
+    dest.t_shift = (ZB_POINT_ST_FRAC_BITS - bits + level);
+  }
+
+  ZTextureDef texture_def;
+  memset(&texture_def, 0, sizeof(texture_def));
+  texture_def.levels = levels;
+
+  // Each lookup is s, t, level, level_dx, with level_dx limited as
+  // DO_CALC_MIPMAP_LEVEL() would limit it.
+  pvector<int> coords(num_lookups * 4);
+  for (int i = 0; i < num_lookups; ++i) {
+    int level = 1 + random.random_int(tex_bits - 1);
+    coords[i * 4] = random.random_int(0x7fffffff);
+    coords[i * 4 + 1] = random.random_int(0x7fffffff);
+    coords[i * 4 + 2] = level;
+    coords[i * 4 + 3] = random.random_int(1 << (level - 1 + ZB_POINT_ST_FRAC_BITS));
+  }
+
+#ifdef ZB_SSE2
+  static const char *filter_names[] = { "bilinear", "mipmap_bilinear", "mipmap_trilinear" };
+  static const ZB_lookupTextureFunc plain_funcs[] = {
+    &lookup_texture_bilinear,
+    &lookup_texture_mipmap_bilinear,
+    &lookup_texture_mipmap_trilinear,
+  };
+  static const ZB_lookupTextureFunc simd_funcs[] = {
+    &lookup_texture_bilinear_sse2,
+    &lookup_texture_mipmap_bilinear_sse2,
+    &lookup_texture_mipmap_trilinear_sse2,
+  };
+  for (int fi = 0; fi < 3; ++fi) {
+    PIXEL plain_checksum, simd_checksum;
+    double plain_ms = lookup(&texture_def, plain_funcs[fi], coords, plain_checksum);
+    double simd_ms = lookup(&texture_def, simd_funcs[fi], coords, simd_checksum);
+    nout << filter_names[fi] << ": "
+         << plain_ms << " ms plain, " << simd_ms << " ms SSE2, "
+         << plain_ms / simd_ms << "x\n";
+
+    // Compare every lookup exactly, not just the checksum.
+    for (int i = 0; i < num_lookups; ++i) {
+      const int *c = &coords[i * 4];
+      if ((*plain_funcs[fi])(&texture_def, c[0], c[1], c[2], c[3]) !=
+          (*simd_funcs[fi])(&texture_def, c[0], c[1], c[2], c[3])) {
+        nout << "  lookup " << i << " differs!\n";
+        ok = false;
+        break;
+      }
+    }
+  }
+#endif  // ZB_SSE2
+
+  return ok ? 0 : 1;
+}
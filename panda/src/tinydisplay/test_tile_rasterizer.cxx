@@ -0,0 +1,190 @@
+// Filename: test_tile_rasterizer.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "pandabase.h"
+#include "tinyOffscreenGraphicsPipe.h"
+#include "config_tinydisplay.h"
+#include "graphicsEngine.h"
+#include "graphicsOutput.h"
+#include "displayRegion.h"
+#include "frameBufferProperties.h"
+#include "windowProperties.h"
+#include "camera.h"
+#include "perspectiveLens.h"
+#include "geomNode.h"
+#include "geomTriangles.h"
+#include "geomVertexWriter.h"
+#include "transparencyAttrib.h"
+#include "nodePath.h"
+#include "pnmImage.h"
+#include "trueClock.h"
+#include "randomizer.h"
+
+// This program renders a 1080p offscreen frame full of large,
+// overlapping, partly transparent triangles with tinydisplay, first
+// with the ordinary single-threaded rasterizer and then with
+// td-render-threads set to increasing values.  It reports the time
+// per frame for each, and checks that every one renders exactly the
+// same image.
+
+static const int x_size = 1920;
+static const int y_size = 1080;
+static const int num_triangles = 2000;
+static const int num_frames = 10;
+
+// Makes a Geom with num_triangles randomly placed, randomly colored
+// triangles in front of the camera.
+static PT(Geom)
+make_triangles(Randomizer &random) {
+  PT(GeomVertexData) data = new GeomVertexData
+    ("triangles", GeomVertexFormat::get_v3c4(), Geom::UH_static);
+  GeomVertexWriter vertex(data, InternalName::get_vertex());
+  GeomVertexWriter color(data, InternalName::get_color());
+
+  PT(GeomTriangles) tris = new GeomTriangles(Geom::UH_static);
+  for (int i = 0; i < num_triangles; ++i) {
+    LPoint3 center(random.random_real(16.0) - 8.0,
+                   10.0 + random.random_real(20.0),
+                   random.random_real(9.0) - 4.5);
+    for (int vi = 0; vi < 3; ++vi) {
+      vertex.add_data3(center + LVector3(random.random_real(4.0) - 2.0,
+                                         random.random_real(4.0) - 2.0,
+                                         random.random_real(4.0) - 2.0));
+      color.add_data4(random.random_real(1.0), random.random_real(1.0),
+                      random.random_real(1.0),
+                      0.5 + random.random_real(0.5));
+    }
+    tris->add_next_vertices(3);
+  }
+
+  PT(Geom) geom = new Geom(data);
+  geom->add_primitive(tris);
+  return geom;
+}
+
+// Opens a new offscreen buffer with the indicated number of render
+// threads, renders num_frames frames of the scene into it, and
+// returns the average number of milliseconds per frame.  The final
+// frame is stored in image.
+static double
+run(const NodePath &scene, int num_threads, PNMImage &image) {
+  // The GSG reads this when it is created.
+  td_render_threads = num_threads;
+
+  PT(GraphicsPipe) pipe = new TinyOffscreenGraphicsPipe;
+  PT(GraphicsEngine) engine = new GraphicsEngine;
+
+  FrameBufferProperties fb_prop;
+  fb_prop.set_rgba_bits(8, 8, 8, 8);
+  fb_prop.set_depth_bits(16);
+  GraphicsOutput *buffer =
+    engine->make_output(pipe, "buffer", 0, fb_prop,
+                        WindowProperties::size(x_size, y_size),
+                        GraphicsPipe::BF_refuse_window);
+  if (buffer == (GraphicsOutput *)NULL) {
+    nout << "Unable to open an offscreen tinydisplay buffer.\n";
+    return 0.0;
+  }
+
+  PT(Camera) camera = new Camera("camera");
+  PT(PerspectiveLens) lens = new PerspectiveLens;
+  lens->set_aspect_ratio((PN_stdfloat)x_size / (PN_stdfloat)y_size);
+  camera->set_lens(lens);
+  NodePath camera_np = scene.attach_new_node(camera);
+  camera->set_scene(scene);
+
+  DisplayRegion *dr = buffer->make_display_region();
+  dr->set_camera(camera_np);
+
+  // Render one frame first, so that the Geom is already munged.
+  engine->render_frame();
+
+  TrueClock *true_clock = TrueClock::get_global_ptr();
+  double start = true_clock->get_short_time();
+  for (int frame = 0; frame < num_frames; ++frame) {
+    engine->render_frame();
+  }
+  engine->sync_frame();
+  double elapsed = true_clock->get_short_time() - start;
+
+  buffer->get_screenshot(image);
+  engine->remove_all_windows();
+  camera_np.remove_node();
+
+  return elapsed * 1000.0 / num_frames;
+}
+
+int
+main(int argc, char *argv[]) {
+  init_libtinydisplay();
+
+  Randomizer random(1);
+  NodePath scene("scene");
+
+  // The opaque triangles test the depth buffer; the transparent ones,
+  // drawn afterwards without depth writes, test that the triangles
+  // within each band are drawn in their original order.
+  PT(GeomNode) opaque = new GeomNode("opaque");
+  opaque->add_geom(make_triangles(random));
+  scene.attach_new_node(opaque);
+
+  PT(GeomNode) transparent = new GeomNode("transparent");
+  transparent->add_geom(make_triangles(random));
+  NodePath transparent_np = scene.attach_new_node(transparent);
+  transparent_np.set_transparency(TransparencyAttrib::M_alpha);
+  transparent_np.set_depth_write(false);
+  transparent_np.set_bin("fixed", 0);
+
+  PNMImage reference;
+  double base_ms = run(scene, 1, reference);
+  nout << x_size << "x" << y_size << ", " << num_triangles * 2
+       << " triangles: " << base_ms << " ms per frame with 1 thread\n";
+  if (reference.get_x_size() != x_size || reference.get_y_size() != y_size) {
+    nout << "  Unable to read back the rendered image!\n";
+    return 1;
+  }
+
+  bool ok = true;
+  static const int thread_counts[] = { 2, 4, 8, 16 };
+  static const int num_counts = sizeof(thread_counts) / sizeof(int);
+  for (int ci = 0; ci < num_counts; ++ci) {
+    int num_threads = thread_counts[ci];
+    PNMImage result;
+    double ms = run(scene, num_threads, result);
+    nout << "  " << num_threads << " threads: " << ms << " ms per frame, "
+         << base_ms / ms << "x\n";
+
+    if (result.get_x_size() != x_size || result.get_y_size() != y_size) {
+      nout << "  Unable to read back the rendered image!\n";
+      ok = false;
+      continue;
+    }
+
+    int num_different = 0;
+    for (int y = 0; y < y_size; ++y) {
+      for (int x = 0; x < x_size; ++x) {
+        if (reference.get_xel(x, y) != result.get_xel(x, y)) {
+          ++num_different;
+        }
+      }
+    }
+    if (num_different != 0) {
+      nout << "  " << num_different << " pixels differ with "
+           << num_threads << " threads!\n";
+      ok = false;
+    }
+  }
+
+  return ok ? 0 : 1;
+}
@@ -15,6 +15,7 @@
 #include "tinyGraphicsStateGuardian.h"
 #include "tinyGeomMunger.h"
 #include "tinyTextureContext.h"
+#include "tinyOcclusionQueryContext.h"
 #include "config_tinydisplay.h"
 #include "pStatTimer.h"
 #include "geomVertexReader.h"
@@ -70,6 +71,7 @@ TinyGraphicsStateGuardian(GraphicsEngine *engine, GraphicsPipe *pipe,
   _current_frame_buffer = NULL;
   _aux_frame_buffer = NULL;
   _c = NULL;
+  _tiles = NULL;
   _vertices = NULL;
   _vertices_size = 0;
 }
@@ -118,6 +120,14 @@ reset() {
   _c->draw_triangle_front = gl_draw_triangle_fill;
   _c->draw_triangle_back = gl_draw_triangle_fill;
 
+  zb_use_simd = td_simd ? 1 : 0;
+  zb_use_hiz = td_hierarchical_z ? 1 : 0;
+
+  if (td_render_threads > 1 && Thread::is_threading_supported()) {
+    _tiles = new TinyTileRasterizer(td_render_threads, td_tile_height);
+    _c->tile_rasterizer = _tiles;
+  }
+
   _supported_geom_rendering =
     Geom::GR_point |
     Geom::GR_indexed_other |
@@ -126,6 +136,7 @@ reset() {
 
   _max_texture_dimension = (1 << ZB_POINT_ST_FRAC_BITS);
   _max_texture_stages = MAX_TEXTURE_STAGES;
+  _supports_occlusion_query = true;
   _max_lights = MAX_LIGHTS;
 
   _color_scale_via_lighting = false;
@@ -152,6 +163,11 @@ reset() {
 ////////////////////////////////////////////////////////////////////
 void TinyGraphicsStateGuardian::
 free_pointers() {
+  if (_tiles != (TinyTileRasterizer *)NULL) {
+    delete _tiles;
+    _tiles = NULL;
+  }
+
   if (_aux_frame_buffer != (ZBuffer *)NULL) {
     ZB_close(_aux_frame_buffer);
     _aux_frame_buffer = NULL;
@@ -176,6 +192,11 @@ void TinyGraphicsStateGuardian::
 close_gsg() {
   GraphicsStateGuardian::close_gsg();
 
+  if (_tiles != (TinyTileRasterizer *)NULL) {
+    delete _tiles;
+    _tiles = NULL;
+  }
+
   if (_c != (GLContext *)NULL) {
     glClose(_c);
     _c = NULL;
@@ -256,6 +277,7 @@ clear(DrawableRegion *clearable) {
     clear_z = true;
   }
 
+  flush_tiles();
   ZB_clear_viewport(_c->zb, clear_z, z, clear_color, color,
                     _c->viewport.xmin, _c->viewport.ymin,
                     _c->viewport.xsize, _c->viewport.ysize);
@@ -286,6 +308,7 @@ prepare_display_region(DisplayRegionPipelineReader *dr) {
     if (_aux_frame_buffer == (ZBuffer *)NULL) {
       _aux_frame_buffer = ZB_open(xsize, ysize, ZB_MODE_RGBA, 0, 0, 0, 0);
     } else if (_aux_frame_buffer->xsize < xsize || _aux_frame_buffer->ysize < ysize) {
+      flush_tiles();
       ZB_resize(_aux_frame_buffer, NULL,
                 max(_aux_frame_buffer->xsize, xsize),
                 max(_aux_frame_buffer->ysize, ysize));
@@ -450,6 +473,7 @@ end_scene() {
     int fb_xsize = int(xsize * pixel_factor);
     int fb_ysize = int(ysize * pixel_factor);
 
+    flush_tiles();
     ZB_zoomFrameBuffer(_current_frame_buffer, xmin, ymin, xsize, ysize,
                        _aux_frame_buffer, 0, 0, fb_xsize, fb_ysize);
     _c->zb = _current_frame_buffer;
@@ -473,6 +497,7 @@ end_scene() {
 ////////////////////////////////////////////////////////////////////
 void TinyGraphicsStateGuardian::
 end_frame(Thread *current_thread) {
+  flush_tiles();
   GraphicsStateGuardian::end_frame(current_thread);
 
 #ifndef NDEBUG
@@ -886,6 +911,34 @@ begin_draw_primitives(const GeomPipelineReader *geom_reader,
     color_write_state = 3;    // coff
   }
 
+  if (_current_occlusion_query != (OcclusionQueryContext *)NULL) {
+    // While an occlusion query is active, every pixel goes through a
+    // store function that counts it before storing it the same way
+    // the chosen triangle function would have.
+    switch (color_write_state) {
+    case 0:
+      _c->zb->store_pix_func = ZB_store_pixel_count_store;
+      break;
+    case 1:
+      _c->zb->store_pix_func = ZB_store_pixel_count_blend;
+      break;
+    case 2:
+      _c->zb->occlusion_store_pix_func = _c->zb->store_pix_func;
+      _c->zb->store_pix_func = ZB_store_pixel_count_general;
+      break;
+    case 3:
+      _c->zb->store_pix_func = ZB_store_pixel_count_off;
+      break;
+    case 4:
+      _c->zb->store_pix_func = ZB_store_pixel_count_sstore;
+      break;
+    case 5:
+      _c->zb->store_pix_func = ZB_store_pixel_count_sblend;
+      break;
+    }
+    color_write_state = 2;     // cgeneral
+  }
+
   int alpha_test_state = 0;   // anone
   const AlphaTestAttrib *target_alpha_test = DCAST(AlphaTestAttrib, _target_rs->get_attrib_def(AlphaTestAttrib::get_class_slot()));
   switch (target_alpha_test->get_mode()) {
@@ -961,6 +1014,10 @@ begin_draw_primitives(const GeomPipelineReader *geom_reader,
 
   _c->zb_fill_tri = fill_tri_funcs[depth_write_state][color_write_state][alpha_test_state][depth_test_state][texfilter_state][shade_model_state][texturing_state];
 
+  if (_tiles != (TinyTileRasterizer *)NULL) {
+    _tiles->set_state(_c->zb);
+  }
+
 #ifdef DO_PSTATS
   pixel_count_white_untextured = 0;
   pixel_count_flat_untextured = 0;
@@ -1213,6 +1270,7 @@ draw_tristrips(const GeomPrimitivePipelineReader *reader, bool force) {
 bool TinyGraphicsStateGuardian::
 draw_lines(const GeomPrimitivePipelineReader *reader, bool force) {
   PStatTimer timer(_draw_primitive_pcollector, reader->get_current_thread());
+  flush_tiles();
 #ifndef NDEBUG
   if (tinydisplay_cat.is_spam()) {
     tinydisplay_cat.spam() << "draw_lines: " << *(reader->get_object()) << "\n";
@@ -1292,6 +1350,7 @@ draw_lines(const GeomPrimitivePipelineReader *reader, bool force) {
 bool TinyGraphicsStateGuardian::
 draw_points(const GeomPrimitivePipelineReader *reader, bool force) {
   PStatTimer timer(_draw_primitive_pcollector, reader->get_current_thread());
+  flush_tiles();
 #ifndef NDEBUG
   if (tinydisplay_cat.is_spam()) {
     tinydisplay_cat.spam() << "draw_points: " << *(reader->get_object()) << "\n";
@@ -1386,6 +1445,58 @@ end_draw_primitives() {
   GraphicsStateGuardian::end_draw_primitives();
 }
 
+////////////////////////////////////////////////////////////////////
+//     Function: TinyGraphicsStateGuardian::begin_occlusion_query
+//       Access: Public, Virtual
+//  Description: Begins a new occlusion query.  After this call, you
+//               may call begin_draw_primitives() and
+//               draw_triangles()/draw_whatever() repeatedly.
+//               Eventually, you should call end_occlusion_query()
+//               before the end of the frame; that will return a new
+//               OcclusionQueryContext object that will tell you how
+//               many pixels represented by the bracketed geometry
+//               passed the depth test.
+//
+//               Only triangles are counted; points and lines are
+//               drawn, but not counted.  The triangles are drawn
+//               immediately, rather than by the td-render-threads
+//               rasterizer, for the duration of the query.
+////////////////////////////////////////////////////////////////////
+void TinyGraphicsStateGuardian::
+begin_occlusion_query() {
+  nassertv(_current_occlusion_query == (OcclusionQueryContext *)NULL);
+
+  // The query must see the depth buffer as it stands, with all of
+  // the triangles drawn before it.
+  flush_tiles();
+  _c->tile_rasterizer = NULL;
+
+  _c->zb->occlusion_count = 0;
+  _current_occlusion_query = new TinyOcclusionQueryContext;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: TinyGraphicsStateGuardian::end_occlusion_query
+//       Access: Public, Virtual
+//  Description: Ends a previous call to begin_occlusion_query().
+//               This call returns the OcclusionQueryContext object
+//               that will (eventually) report the number of pixels
+//               that passed the depth test between the call to
+//               begin_occlusion_query() and end_occlusion_query().
+////////////////////////////////////////////////////////////////////
+PT(OcclusionQueryContext) TinyGraphicsStateGuardian::
+end_occlusion_query() {
+  nassertr(_current_occlusion_query != (OcclusionQueryContext *)NULL, NULL);
+  PT(OcclusionQueryContext) result = _current_occlusion_query;
+  _current_occlusion_query = NULL;
+
+  DCAST(TinyOcclusionQueryContext, result)->_num_fragments =
+    (int)_c->zb->occlusion_count;
+  _c->tile_rasterizer = _tiles;
+
+  return result;
+}
+
 ////////////////////////////////////////////////////////////////////
 //     Function: TinyGraphicsStateGuardian::framebuffer_copy_to_texture
 //       Access: Public, Virtual
@@ -1400,6 +1511,7 @@ framebuffer_copy_to_texture(Texture *tex, int view, int z,
                             const DisplayRegion *dr,
                             const RenderBuffer &rb) {
   nassertr(tex != NULL && dr != NULL, false);
+  flush_tiles();
 
   int xo, yo, w, h;
   dr->get_region_pixels_i(xo, yo, w, h);
@@ -1451,6 +1563,7 @@ framebuffer_copy_to_ram(Texture *tex, int view, int z,
                         const DisplayRegion *dr,
                         const RenderBuffer &rb) {
   nassertr(tex != NULL && dr != NULL, false);
+  flush_tiles();
 
   int xo, yo, w, h;
   dr->get_region_pixels_i(xo, yo, w, h);
@@ -1802,6 +1915,9 @@ void TinyGraphicsStateGuardian::
 release_texture(TextureContext *tc) {
   TinyTextureContext *gtc = DCAST(TinyTextureContext, tc);
 
+  // A recorded triangle may still be using this texture.
+  flush_tiles();
+
   _texturing_state = 0;  // just in case
 
   GLTexture *gltex = &gtc->_gltex;
@@ -2122,11 +2238,14 @@ do_issue_render_mode() {
     break;
 
   case RenderModeAttrib::M_wireframe:
+    // Lines are drawn directly into the frame buffer.
+    flush_tiles();
     _c->draw_triangle_front = gl_draw_triangle_line;
     _c->draw_triangle_back = gl_draw_triangle_line;
     break;
 
   case RenderModeAttrib::M_point:
+    flush_tiles();
     _c->draw_triangle_front = gl_draw_triangle_point;
     _c->draw_triangle_back = gl_draw_triangle_point;
     break;
@@ -2520,6 +2639,7 @@ apply_texture(TextureContext *tc) {
 bool TinyGraphicsStateGuardian::
 upload_texture(TinyTextureContext *gtc, bool force, bool uses_mipmaps) {
   Texture *tex = gtc->get_texture();
+  flush_tiles();
 
   if (_effective_incomplete_render && !force) {
     if (!tex->has_ram_image() && tex->might_have_ram_image() &&
@@ -2658,6 +2778,7 @@ upload_texture(TinyTextureContext *gtc, bool force, bool uses_mipmaps) {
 bool TinyGraphicsStateGuardian::
 upload_simple_texture(TinyTextureContext *gtc) {
   PStatTimer timer(_load_texture_pcollector);
+  flush_tiles();
   Texture *tex = gtc->get_texture();
   nassertr(tex != (Texture *)NULL, false);
 
@@ -3228,6 +3349,11 @@ get_tex_filter_func(SamplerState::FilterType filter) {
     return &lookup_texture_nearest;
 
   case SamplerState::FT_linear:
+#ifdef ZB_SSE2
+    if (zb_use_simd) {
+      return &lookup_texture_bilinear_sse2;
+    }
+#endif
     return &lookup_texture_bilinear;
 
   case SamplerState::FT_nearest_mipmap_nearest:
@@ -3237,9 +3363,19 @@ get_tex_filter_func(SamplerState::FilterType filter) {
     return &lookup_texture_mipmap_linear;
 
   case SamplerState::FT_linear_mipmap_nearest:
+#ifdef ZB_SSE2
+    if (zb_use_simd) {
+      return &lookup_texture_mipmap_bilinear_sse2;
+    }
+#endif
     return &lookup_texture_mipmap_bilinear;
 
   case SamplerState::FT_linear_mipmap_linear:
+#ifdef ZB_SSE2
+    if (zb_use_simd) {
+      return &lookup_texture_mipmap_trilinear_sse2;
+    }
+#endif
     return &lookup_texture_mipmap_trilinear;
 
   default:
@@ -23,6 +23,7 @@
 #include "zmath.h"
 #include "zbuffer.h"
 #include "zgl.h"
+#include "tinyTileRasterizer.h"
 #include "geomVertexReader.h"
 
 class TinyTextureContext;
@@ -81,6 +82,9 @@ public:
                            bool force);
   virtual void end_draw_primitives();
 
+  virtual void begin_occlusion_query();
+  virtual PT(OcclusionQueryContext) end_occlusion_query();
+
   virtual bool framebuffer_copy_to_texture
   (Texture *tex, int view, int z, const DisplayRegion *dr, const RenderBuffer &rb);
   virtual bool framebuffer_copy_to_ram
@@ -135,6 +139,7 @@ private:
   static ZB_texWrapFunc get_tex_wrap_func(SamplerState::WrapMode wrap_mode);
 
   INLINE void clear_light_state();
+  INLINE void flush_tiles();
 
   // Methods used to generate texture coordinates.
   class TexCoordData {
@@ -160,6 +165,9 @@ private:
 
   GLContext *_c;
 
+  // Allocated by reset() when td-render-threads is greater than 1.
+  TinyTileRasterizer *_tiles;
+
   enum ColorMaterialFlags {
     CMF_ambient   = 0x001,
     CMF_diffuse   = 0x002,
@@ -0,0 +1,40 @@
+// Filename: tinyOcclusionQueryContext.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "tinyOcclusionQueryContext.h"
+
+TypeHandle TinyOcclusionQueryContext::_type_handle;
+
+////////////////////////////////////////////////////////////////////
+//     Function: TinyOcclusionQueryContext::is_answer_ready
+//       Access: Public, Virtual
+//  Description: Returns true if the query's answer is ready, false
+//               otherwise.  It always is, for a software renderer.
+////////////////////////////////////////////////////////////////////
+bool TinyOcclusionQueryContext::
+is_answer_ready() const {
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: TinyOcclusionQueryContext::get_num_fragments
+//       Access: Public, Virtual
+//  Description: Returns the number of fragments (pixels) of the
+//               triangles drawn during the query that passed the
+//               alpha and depth tests.
+////////////////////////////////////////////////////////////////////
+int TinyOcclusionQueryContext::
+get_num_fragments() const {
+  return _num_fragments;
+}
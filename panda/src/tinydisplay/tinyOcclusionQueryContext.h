@@ -0,0 +1,59 @@
+// Filename: tinyOcclusionQueryContext.h
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef TINYOCCLUSIONQUERYCONTEXT_H
+#define TINYOCCLUSIONQUERYCONTEXT_H
+
+#include "pandabase.h"
+#include "occlusionQueryContext.h"
+#include "deletedChain.h"
+
+////////////////////////////////////////////////////////////////////
+//       Class : TinyOcclusionQueryContext
+// Description : The result of an occlusion query on the tinydisplay
+//               software renderer.  Since the triangles are drawn
+//               immediately, the answer is already known by the time
+//               end_occlusion_query() returns it.
+////////////////////////////////////////////////////////////////////
+class EXPCL_TINYDISPLAY TinyOcclusionQueryContext : public OcclusionQueryContext {
+public:
+  INLINE TinyOcclusionQueryContext();
+  ALLOC_DELETED_CHAIN(TinyOcclusionQueryContext);
+
+  virtual bool is_answer_ready() const;
+  virtual int get_num_fragments() const;
+
+  int _num_fragments;
+
+public:
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    OcclusionQueryContext::init_type();
+    register_type(_type_handle, "TinyOcclusionQueryContext",
+                  OcclusionQueryContext::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "tinyOcclusionQueryContext.I"
+
+#endif
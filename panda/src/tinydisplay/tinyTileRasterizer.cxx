@@ -0,0 +1,300 @@
+// Filename: tinyTileRasterizer.cxx
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#include "tinyTileRasterizer.h"
+#include "mutexHolder.h"
+#include "pStatTimer.h"
+#include "pnotify.h"
+
+PStatCollector TinyTileRasterizer::_flush_pcollector("Draw:Flush tiles");
+PStatCollector TinyTileRasterizer::_band_pcollector("Draw:Rasterize tiles");
+PStatCollector TinyTileRasterizer::_wait_pcollector("Wait:Tiles");
+
+////////////////////////////////////////////////////////////////////
+//     Function: TinyTileRasterizer::Constructor
+//       Access: Public
+//  Description: Creates a rasterizer that will divide the screen
+//               into bands of band_height rows each, and rasterize
+//               them with up to num_threads threads, counting the
+//               thread that calls flush().  The helper threads are
+//               not started until they are first needed.
+//
+//               band_height is rounded up to a whole number of
+//               coarse depth tiles, so that no two threads ever
+//               update the same tile.
+////////////////////////////////////////////////////////////////////
+TinyTileRasterizer::
+TinyTileRasterizer(int num_threads, int band_height) :
+  _num_threads(max(num_threads, 1)),
+  _band_height((max(band_height, 1) + ZB_HIZ_TILE_SIZE - 1) & ~(ZB_HIZ_TILE_SIZE - 1)),
+  _zb(NULL),
+  _state_stale(true),
+  _workers_started(false),
+  _cv_work(_lock),
+  _cv_done(_lock),
+  _next_band(0),
+  _bands_pending(0),
+  _terminate(false)
+{
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: TinyTileRasterizer::Destructor
+//       Access: Public
+//  Description: Stops the helper threads.  Any triangles that have
+//               not yet been flushed are discarded.
+////////////////////////////////////////////////////////////////////
+TinyTileRasterizer::
+~TinyTileRasterizer() {
+  terminate_workers();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: TinyTileRasterizer::add_triangle
+//       Access: Public
+//  Description: Records a triangle, already transformed to screen
+//               coordinates and clipped to the frame buffer, to be
+//               filled with the indicated function and the state
+//               most recently passed to set_state() when flush() is
+//               next called.
+////////////////////////////////////////////////////////////////////
+void TinyTileRasterizer::
+add_triangle(ZB_fillTriangleFunc fill_tri,
+             const ZBufferPoint *p0, const ZBufferPoint *p1,
+             const ZBufferPoint *p2) {
+  nassertv(_zb != (ZBuffer *)NULL);
+
+  if (_state_stale) {
+    // Successive Geoms are frequently drawn with exactly the same
+    // state; in that case they can share the same copy.
+    if (_states.empty() ||
+        memcmp(&_states.back(), _zb, sizeof(ZBuffer)) != 0) {
+      _states.push_back(*_zb);
+    }
+    _state_stale = false;
+  }
+
+  // The fill functions draw every row from the topmost vertex to the
+  // bottommost vertex, inclusive.
+  int ymin = max(min(p0->y, min(p1->y, p2->y)), 0);
+  int ymax = max(p0->y, max(p1->y, p2->y));
+  if (ymax < ymin) {
+    return;
+  }
+  int first_band = ymin / _band_height;
+  int last_band = ymax / _band_height;
+  if (last_band >= (int)_bands.size()) {
+    _bands.resize(last_band + 1);
+  }
+
+  int index = (int)_triangles.size();
+  _triangles.push_back(Triangle());
+  Triangle &tri = _triangles.back();
+  tri._fill_tri = fill_tri;
+  tri._state = (int)_states.size() - 1;
+  tri._p0 = *p0;
+  tri._p1 = *p1;
+  tri._p2 = *p2;
+
+  for (int bi = first_band; bi <= last_band; ++bi) {
+    _bands[bi].push_back(index);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: TinyTileRasterizer::flush
+//       Access: Public
+//  Description: Rasterizes all of the triangles recorded since the
+//               last flush, and returns when they have all been
+//               drawn.  The bands are handed out to the helper
+//               threads and the current thread alike, as each one
+//               finishes its previous band.
+////////////////////////////////////////////////////////////////////
+void TinyTileRasterizer::
+flush() {
+  if (_triangles.empty()) {
+    return;
+  }
+
+  Thread *current_thread = Thread::get_current_thread();
+  PStatTimer timer(_flush_pcollector, current_thread);
+
+  if (!_workers_started) {
+    start_workers();
+  }
+
+  {
+    MutexHolder holder(_lock, current_thread);
+    _next_band = 0;
+    _bands_pending = (int)_bands.size();
+    _cv_work.notify_all();
+
+    // This thread draws bands too, rather than sitting idle.
+    do_bands(current_thread);
+
+    while (_bands_pending > 0) {
+      PStatTimer timer(_wait_pcollector, current_thread);
+      _cv_done.wait();
+    }
+  }
+
+  // Keep the allocated space for the next frame.
+  Bands::iterator bi;
+  for (bi = _bands.begin(); bi != _bands.end(); ++bi) {
+    (*bi).clear();
+  }
+  _triangles.clear();
+  _states.clear();
+  _state_stale = true;
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: TinyTileRasterizer::do_bands
+//       Access: Private
+//  Description: Draws bands from the current flush until there are
+//               none left to start.  Assumes _lock is held; it is
+//               released while each band is drawn.
+////////////////////////////////////////////////////////////////////
+void TinyTileRasterizer::
+do_bands(Thread *current_thread) {
+  nassertv(_lock.debug_is_locked());
+
+  while (_bands_pending > 0 && _next_band < _bands.size()) {
+    int bi = (int)_next_band;
+    ++_next_band;
+
+    _lock.release();
+    draw_band(bi);
+    _lock.acquire();
+
+    --_bands_pending;
+    nassertv(_bands_pending >= 0);
+    if (_bands_pending == 0) {
+      _cv_done.notify_all();
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: TinyTileRasterizer::draw_band
+//       Access: Private
+//  Description: Draws all of the triangles that touch the indicated
+//               band, in order, writing only to the band's rows.
+////////////////////////////////////////////////////////////////////
+void TinyTileRasterizer::
+draw_band(int bi) const {
+  const TriangleIndices &indices = _bands[bi];
+  if (indices.empty()) {
+    return;
+  }
+
+  ZBuffer zb;
+  int state = -1;
+
+  TriangleIndices::const_iterator ii;
+  for (ii = indices.begin(); ii != indices.end(); ++ii) {
+    const Triangle &tri = _triangles[*ii];
+    if (tri._state != state) {
+      state = tri._state;
+      zb = _states[state];
+      zb.band_ymin = bi * _band_height;
+      zb.band_ymax = zb.band_ymin + _band_height;
+    }
+
+    // The fill functions may scribble on the points, so each band
+    // must work on its own copy.
+    ZBufferPoint p0 = tri._p0;
+    ZBufferPoint p1 = tri._p1;
+    ZBufferPoint p2 = tri._p2;
+    (*tri._fill_tri)(&zb, &p0, &p1, &p2);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: TinyTileRasterizer::start_workers
+//       Access: Private
+//  Description: Starts the helper threads, the first time flush() is
+//               called.
+////////////////////////////////////////////////////////////////////
+void TinyTileRasterizer::
+start_workers() {
+  _workers_started = true;
+
+  for (int i = 1; i < _num_threads; ++i) {
+    ostringstream strm;
+    strm << "TileWorker-" << i;
+    PT(TileWorker) worker = new TileWorker(strm.str(), this);
+    if (!worker->start(TP_normal, true)) {
+      // Couldn't start a thread; do with what we have.
+      break;
+    }
+    _workers.push_back(worker);
+  }
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: TinyTileRasterizer::terminate_workers
+//       Access: Private
+//  Description: Stops and joins all of the helper threads.
+////////////////////////////////////////////////////////////////////
+void TinyTileRasterizer::
+terminate_workers() {
+  {
+    MutexHolder holder(_lock);
+    _terminate = true;
+    _cv_work.notify_all();
+  }
+
+  Workers::iterator wi;
+  for (wi = _workers.begin(); wi != _workers.end(); ++wi) {
+    (*wi)->join();
+  }
+  _workers.clear();
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: TinyTileRasterizer::TileWorker::Constructor
+//       Access: Public
+//  Description:
+////////////////////////////////////////////////////////////////////
+TinyTileRasterizer::TileWorker::
+TileWorker(const string &name, TinyTileRasterizer *tiles) :
+  Thread(name, "TileWorker"),
+  _tiles(tiles)
+{
+}
+
+////////////////////////////////////////////////////////////////////
+//     Function: TinyTileRasterizer::TileWorker::thread_main
+//       Access: Public, Virtual
+//  Description: The main loop for a helper thread.  It waits for
+//               flush() to be called, and helps to draw the bands.
+////////////////////////////////////////////////////////////////////
+void TinyTileRasterizer::TileWorker::
+thread_main() {
+  Thread *current_thread = Thread::get_current_thread();
+
+  MutexHolder holder(_tiles->_lock);
+  while (!_tiles->_terminate) {
+    if (_tiles->_bands_pending > 0 &&
+        _tiles->_next_band < _tiles->_bands.size()) {
+      PStatTimer timer(_band_pcollector, current_thread);
+      _tiles->do_bands(current_thread);
+
+    } else {
+      PStatTimer timer(_wait_pcollector, current_thread);
+      _tiles->_cv_work.wait();
+    }
+  }
+}
@@ -0,0 +1,123 @@
+// Filename: tinyTileRasterizer.h
+// Created by:  agent (18Oct26)
+//
+////////////////////////////////////////////////////////////////////
+//
+// PANDA 3D SOFTWARE
+// Copyright (c) Carnegie Mellon University.  All rights reserved.
+//
+// All use of this software is subject to the terms of the revised BSD
+// license.  You should have received a copy of this license along
+// with this source code in a file named "LICENSE."
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef TINYTILERASTERIZER_H
+#define TINYTILERASTERIZER_H
+
+#include "pandabase.h"
+#include "zbuffer.h"
+#include "pvector.h"
+#include "pmutex.h"
+#include "conditionVarFull.h"
+#include "thread.h"
+#include "pointerTo.h"
+#include "pStatCollector.h"
+
+////////////////////////////////////////////////////////////////////
+//       Class : TinyTileRasterizer
+// Description : This object defers the rasterization of triangles in
+//               the tinydisplay renderer, so that it may be spread
+//               across several threads.
+//
+//               Each triangle that would have been filled by
+//               gl_draw_triangle_fill() is instead recorded, along
+//               with a copy of the ZBuffer state it was to be drawn
+//               with, and sorted into horizontal bands of the screen
+//               according to the rows it covers.  When flush() is
+//               called, each band is rasterized by one thread, which
+//               draws that band's triangles in their original order
+//               using the ordinary fill functions, limited to the
+//               band's rows.  Since no two threads ever write to the
+//               same row, the result is identical to drawing the
+//               triangles one at a time.
+//
+//               The GSG must call flush() before anything else reads
+//               or writes the frame buffer, or changes any texture
+//               that a recorded triangle might refer to.
+////////////////////////////////////////////////////////////////////
+class EXPCL_TINYDISPLAY TinyTileRasterizer {
+public:
+  TinyTileRasterizer(int num_threads, int band_height);
+  ~TinyTileRasterizer();
+
+  INLINE int get_num_threads() const;
+  INLINE int get_band_height() const;
+  INLINE bool is_empty() const;
+
+  INLINE void set_state(const ZBuffer *zb);
+  void add_triangle(ZB_fillTriangleFunc fill_tri,
+                    const ZBufferPoint *p0, const ZBufferPoint *p1,
+                    const ZBufferPoint *p2);
+  void flush();
+
+private:
+  void do_bands(Thread *current_thread);
+  void draw_band(int bi) const;
+  void start_workers();
+  void terminate_workers();
+
+  class Triangle {
+  public:
+    ZB_fillTriangleFunc _fill_tri;
+    int _state;
+    ZBufferPoint _p0, _p1, _p2;
+  };
+
+  int _num_threads;
+  int _band_height;
+
+  // The ZBuffer that will be snapshotted for the next triangle, if
+  // _state_stale is true.
+  const ZBuffer *_zb;
+  bool _state_stale;
+
+  typedef pvector<ZBuffer> States;
+  States _states;
+  typedef pvector<Triangle> Triangles;
+  Triangles _triangles;
+
+  // For each band, the indices of the triangles that touch it, in
+  // drawing order.
+  typedef pvector<int> TriangleIndices;
+  typedef pvector<TriangleIndices> Bands;
+  Bands _bands;
+
+  class TileWorker : public Thread {
+  public:
+    TileWorker(const string &name, TinyTileRasterizer *tiles);
+    virtual void thread_main();
+
+    TinyTileRasterizer *_tiles;
+  };
+  typedef pvector< PT(TileWorker) > Workers;
+  Workers _workers;
+  bool _workers_started;
+
+  // These members are protected by _lock.  A flush is in progress
+  // while _next_band < _bands.size() or _bands_pending > 0.
+  Mutex _lock;
+  ConditionVarFull _cv_work;
+  ConditionVarFull _cv_done;
+  size_t _next_band;
+  int _bands_pending;
+  bool _terminate;
+
+  static PStatCollector _flush_pcollector;
+  static PStatCollector _band_pcollector;
+  static PStatCollector _wait_pcollector;
+};
+
+#include "tinyTileRasterizer.I"
+
+#endif
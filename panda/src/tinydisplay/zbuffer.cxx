@@ -24,6 +24,36 @@ int pixel_count_smooth_multitex2;
 int pixel_count_smooth_multitex3;
 #endif  // DO_PSTATS
 
+// Set this to 0 to use only the plain C inner loops, even when the
+// SSE2 versions are compiled in.
+int zb_use_simd = 1;
+
+// Set this to 0 to stop testing triangles against the coarse depth
+// buffer.  The coarse depth buffer is still kept up to date.
+int zb_use_hiz = 1;
+
+// (Re)allocates the coarse depth buffer to match the size of the
+// depth buffer.
+static void
+ZB_hiz_alloc(ZBuffer *zb) {
+  // gl_free() does not accept NULL.
+  if (zb->hiz != NULL) {
+    gl_free(zb->hiz);
+  }
+  if (zb->hiz_stale != NULL) {
+    gl_free(zb->hiz_stale);
+  }
+
+  zb->hiz_xsize = (zb->xsize + ZB_HIZ_TILE_SIZE - 1) >> ZB_HIZ_TILE_BITS;
+  zb->hiz_ysize = (zb->ysize + ZB_HIZ_TILE_SIZE - 1) >> ZB_HIZ_TILE_BITS;
+  int num_tiles = zb->hiz_xsize * zb->hiz_ysize;
+
+  // Zero is less than any depth value, even before the depth buffer
+  // is first cleared.
+  zb->hiz = (ZPOINT *)gl_zalloc(num_tiles * sizeof(ZPOINT));
+  zb->hiz_stale = (unsigned char *)gl_zalloc(num_tiles);
+}
+
 ZBuffer *
 ZB_open(int xsize, int ysize, int mode,
         int nb_colors,
@@ -43,6 +73,8 @@ ZB_open(int xsize, int ysize, int mode,
 
   zb->xsize = xsize;
   zb->ysize = ysize;
+  zb->band_ymin = 0;
+  zb->band_ymax = ysize;
   zb->mode = mode;
   zb->linesize = (xsize * PSZB + 3) & ~3;
 
@@ -83,6 +115,8 @@ ZB_open(int xsize, int ysize, int mode,
     zb->pbuf = (PIXEL *)frame_buffer;
   }
 
+  ZB_hiz_alloc(zb);
+
   return zb;
  error:
   gl_free(zb);
@@ -100,6 +134,12 @@ ZB_close(ZBuffer * zb) {
     gl_free(zb->pbuf);
 
   gl_free(zb->zbuf);
+  if (zb->hiz != NULL) {
+    gl_free(zb->hiz);
+  }
+  if (zb->hiz_stale != NULL) {
+    gl_free(zb->hiz_stale);
+  }
   gl_free(zb);
 }
 
@@ -114,11 +154,14 @@ ZB_resize(ZBuffer * zb, void *frame_buffer, int xsize, int ysize) {
 
   zb->xsize = xsize;
   zb->ysize = ysize;
+  zb->band_ymin = 0;
+  zb->band_ymax = ysize;
   zb->linesize = (xsize * PSZB + 3) & ~3;
 
   size = zb->xsize * zb->ysize * sizeof(ZPOINT);
   gl_free(zb->zbuf);
   zb->zbuf = (ZPOINT *)gl_malloc(size);
+  ZB_hiz_alloc(zb);
 
   if (zb->frame_buffer_allocated)
     gl_free(zb->pbuf);
@@ -303,6 +346,9 @@ void ZB_zoomFrameBuffer(ZBuffer *dest, int dest_xmin, int dest_ymin, int dest_xs
       tz[tx] = fz[fx];
     }
   }
+
+  ZB_hiz_invalidate(dest, dest_xmin, dest_ymin,
+                    dest_xmin + dest_xsize - 1, dest_ymin + dest_ysize - 1);
 }
 
 
@@ -392,6 +438,10 @@ ZB_clear(ZBuffer * zb, int clear_z, ZPOINT z, int clear_color, PIXEL color) {
 
   if (clear_z) {
     memset(zb->zbuf, 0, zb->xsize * zb->ysize * sizeof(ZPOINT));
+
+    int num_tiles = zb->hiz_xsize * zb->hiz_ysize;
+    memset(zb->hiz, 0, num_tiles * sizeof(ZPOINT));
+    memset(zb->hiz_stale, 0, num_tiles);
   }
   if (clear_color) {
     pp = zb->pbuf;
@@ -420,6 +470,18 @@ ZB_clear_viewport(ZBuffer * zb, int clear_z, ZPOINT z, int clear_color, PIXEL co
       memset(zz, 0, xsize * sizeof(ZPOINT));
       zz += zb->xsize;
     }
+
+    // Every tile that overlaps the viewport now contains a zero.
+    if (xsize > 0 && ysize > 0) {
+      int tx_min = xmin >> ZB_HIZ_TILE_BITS;
+      int tx_max = (xmin + xsize - 1) >> ZB_HIZ_TILE_BITS;
+      int ty_max = (ymin + ysize - 1) >> ZB_HIZ_TILE_BITS;
+      for (int ty = ymin >> ZB_HIZ_TILE_BITS; ty <= ty_max; ++ty) {
+        int ti = ty * zb->hiz_xsize + tx_min;
+        memset(zb->hiz + ti, 0, (tx_max - tx_min + 1) * sizeof(ZPOINT));
+        memset(zb->hiz_stale + ti, 0, tx_max - tx_min + 1);
+      }
+    }
   }
   if (clear_color) {
     pp = zb->pbuf + xmin + ymin * (zb->linesize / PSZB);
@@ -430,6 +492,192 @@ ZB_clear_viewport(ZBuffer * zb, int clear_z, ZPOINT z, int clear_color, PIXEL co
   }
 }
 
+// Recomputes the coarse depth value of the indicated tile from the
+// depth buffer.
+static void
+ZB_hiz_refresh(ZBuffer *zb, int tx, int ty) {
+  int xmin = tx << ZB_HIZ_TILE_BITS;
+  int ymin = ty << ZB_HIZ_TILE_BITS;
+  int xsize = min(ZB_HIZ_TILE_SIZE, zb->xsize - xmin);
+  int ysize = min(ZB_HIZ_TILE_SIZE, zb->ysize - ymin);
+
+  ZPOINT zmin = ~(ZPOINT)0;
+  const ZPOINT *zz = zb->zbuf + xmin + ymin * zb->xsize;
+  for (int y = 0; y < ysize; ++y) {
+    for (int x = 0; x < xsize; ++x) {
+      zmin = min(zmin, zz[x]);
+    }
+    zz += zb->xsize;
+  }
+
+  int ti = ty * zb->hiz_xsize + tx;
+  zb->hiz[ti] = zmin;
+  zb->hiz_stale[ti] = 0;
+}
+
+// Compares the depth value z against the coarse depth buffer over
+// the rectangle (xmin, ymin) - (xmax, ymax), inclusive, which must lie
+// within the buffer.  Returns ZB_HIZ_HIDDEN if no pixel in the
+// rectangle has a depth value less than z, so that nothing at z or
+// farther could pass the depth test there; ZB_HIZ_VISIBLE if no tile
+// can rule that out; or ZB_HIZ_PARTIAL otherwise.  Any stale tiles in
+// the rectangle are brought up to date.
+int
+ZB_hiz_test(ZBuffer *zb, int xmin, int ymin, int xmax, int ymax, ZPOINT z) {
+  int tx_min = xmin >> ZB_HIZ_TILE_BITS;
+  int tx_max = xmax >> ZB_HIZ_TILE_BITS;
+  int ty_min = ymin >> ZB_HIZ_TILE_BITS;
+  int ty_max = ymax >> ZB_HIZ_TILE_BITS;
+
+  int num_hidden = 0;
+  for (int ty = ty_min; ty <= ty_max; ++ty) {
+    int ti = ty * zb->hiz_xsize + tx_min;
+    for (int tx = tx_min; tx <= tx_max; ++tx, ++ti) {
+      if (zb->hiz_stale[ti]) {
+        ZB_hiz_refresh(zb, tx, ty);
+      }
+      if (zb->hiz[ti] >= z) {
+        ++num_hidden;
+      }
+    }
+  }
+
+  if (num_hidden == 0) {
+    return ZB_HIZ_VISIBLE;
+  } else if (num_hidden == (tx_max - tx_min + 1) * (ty_max - ty_min + 1)) {
+    return ZB_HIZ_HIDDEN;
+  } else {
+    return ZB_HIZ_PARTIAL;
+  }
+}
+
+// Indicates that depth values within the rectangle (xmin, ymin) -
+// (xmax, ymax), inclusive, may have been changed, other than by
+// clearing them.  The coarse depth values of the tiles it overlaps
+// will be recomputed when they are next needed.
+void
+ZB_hiz_invalidate(ZBuffer *zb, int xmin, int ymin, int xmax, int ymax) {
+  xmin = max(xmin, 0);
+  ymin = max(ymin, 0);
+  xmax = min(xmax, zb->xsize - 1);
+  ymax = min(ymax, zb->ysize - 1);
+  if (xmin > xmax || ymin > ymax) {
+    return;
+  }
+
+  int tx_min = xmin >> ZB_HIZ_TILE_BITS;
+  int tx_max = xmax >> ZB_HIZ_TILE_BITS;
+  int ty_max = ymax >> ZB_HIZ_TILE_BITS;
+  for (int ty = ymin >> ZB_HIZ_TILE_BITS; ty <= ty_max; ++ty) {
+    memset(zb->hiz_stale + ty * zb->hiz_xsize + tx_min, 1, tx_max - tx_min + 1);
+  }
+}
+
+// Returns the leftmost and rightmost x at which the horizontal line
+// at y crosses the triangle p0, p1, p2, which must be sorted by y,
+// with p0->y <= y <= p2->y and p0->y < p2->y.
+static void
+ZB_hiz_span(const ZBufferPoint *p0, const ZBufferPoint *p1,
+            const ZBufferPoint *p2, int y, float &xl, float &xr) {
+  float x_long = p0->x + (float)(p2->x - p0->x) * (y - p0->y) / (p2->y - p0->y);
+  float x_short;
+  if (y < p1->y) {
+    x_short = p0->x + (float)(p1->x - p0->x) * (y - p0->y) / (p1->y - p0->y);
+  } else if (p2->y > p1->y) {
+    x_short = p1->x + (float)(p2->x - p1->x) * (y - p1->y) / (p2->y - p1->y);
+  } else {
+    // The bottom edge is horizontal, and y lies on it.
+    x_short = p1->x;
+  }
+  xl = min(x_long, x_short);
+  xr = max(x_long, x_short);
+}
+
+// Raises the coarse depth value of every tile within the current band
+// that is covered entirely by the triangle p0, p1, p2, which must be
+// sorted by y and has just been drawn with the depth test and with no
+// pixels rejected by the alpha test, to at least z.  z must be no
+// greater than any depth value the triangle could have produced.
+//
+// A tile counts as covered only if a one-pixel border around it lies
+// within the triangle too, since the scan may fall short of the
+// triangle's true edges by up to a pixel.
+void
+ZB_hiz_raise(ZBuffer *zb, const ZBufferPoint *p0, const ZBufferPoint *p1,
+             const ZBufferPoint *p2, ZPOINT z) {
+  int ymin = max(p0->y + 1, zb->band_ymin);
+  int ymax = min(p2->y - 1, zb->band_ymax - 1);
+  int ty_min = (ymin + ZB_HIZ_TILE_SIZE - 1) >> ZB_HIZ_TILE_BITS;
+  int ty_max = ((ymax + 1) >> ZB_HIZ_TILE_BITS) - 1;
+
+  for (int ty = ty_min; ty <= ty_max; ++ty) {
+    // The triangle is convex, so the tile and its border are within
+    // it if the rows just above and below it are.
+    int y = ty << ZB_HIZ_TILE_BITS;
+    float xl_top, xr_top, xl_bottom, xr_bottom;
+    ZB_hiz_span(p0, p1, p2, y - 1, xl_top, xr_top);
+    ZB_hiz_span(p0, p1, p2, y + ZB_HIZ_TILE_SIZE, xl_bottom, xr_bottom);
+    float xl = max(xl_top, xl_bottom) + 1.0f;
+    float xr = min(xr_top, xr_bottom) - (float)ZB_HIZ_TILE_SIZE;
+    if (xl > xr) {
+      continue;
+    }
+
+    int tx_min = max(((int)xl + ZB_HIZ_TILE_SIZE) >> ZB_HIZ_TILE_BITS, 0);
+    int tx_max = min((int)xr >> ZB_HIZ_TILE_BITS, zb->hiz_xsize - 1);
+    int ti = ty * zb->hiz_xsize + tx_min;
+    for (int tx = tx_min; tx <= tx_max; ++tx, ++ti) {
+      // Every pixel of the tile is now at least z, so this is true
+      // even of a stale tile.
+      if (zb->hiz_stale[ti] || zb->hiz[ti] < z) {
+        zb->hiz[ti] = z;
+        zb->hiz_stale[ti] = 0;
+      }
+    }
+  }
+}
+
+// The following functions are installed as the store_pix_func, with
+// the "cgeneral" triangle functions, while an occlusion query is
+// active.  They are called only for pixels that pass the alpha and
+// depth tests; each one counts the pixel, then stores it as the
+// triangle function that would otherwise have been chosen would.
+
+void
+ZB_store_pixel_count_off(ZBuffer *zb, PIXEL &result, int r, int g, int b, int a) {
+  ++zb->occlusion_count;
+}
+
+void
+ZB_store_pixel_count_store(ZBuffer *zb, PIXEL &result, int r, int g, int b, int a) {
+  ++zb->occlusion_count;
+  result = RGBA_TO_PIXEL(r, g, b, a);
+}
+
+void
+ZB_store_pixel_count_blend(ZBuffer *zb, PIXEL &result, int r, int g, int b, int a) {
+  ++zb->occlusion_count;
+  result = PIXEL_BLEND_RGB(result, r, g, b, a);
+}
+
+void
+ZB_store_pixel_count_sstore(ZBuffer *zb, PIXEL &result, int r, int g, int b, int a) {
+  ++zb->occlusion_count;
+  result = SRGBA_TO_PIXEL(r, g, b, a);
+}
+
+void
+ZB_store_pixel_count_sblend(ZBuffer *zb, PIXEL &result, int r, int g, int b, int a) {
+  ++zb->occlusion_count;
+  result = PIXEL_BLEND_SRGB(result, r, g, b, a);
+}
+
+void
+ZB_store_pixel_count_general(ZBuffer *zb, PIXEL &result, int r, int g, int b, int a) {
+  ++zb->occlusion_count;
+  (*zb->occlusion_store_pix_func)(zb, result, r, g, b, a);
+}
+
 #define ZB_ST_FRAC_HIGH (1 << ZB_POINT_ST_FRAC_BITS)
 #define ZB_ST_FRAC_MASK (ZB_ST_FRAC_HIGH - 1)
 
@@ -579,6 +827,108 @@ lookup_texture_mipmap_trilinear(ZTextureDef *texture_def, int s, int t, unsigned
   return RGBA_TO_PIXEL(r, g, b, a);
 }
 
+#ifdef ZB_SSE2
+// Computes LINEAR_FILTER() on each of the eight 16-bit components in
+// c1 and c2 at once, where inv_f holds ZB_ST_FRAC_HIGH - f.  Each
+// product is shifted down separately, exactly as the macro does, so
+// the result is the same to the bit.
+static inline __m128i
+linear_filter_sse2(__m128i c1, __m128i c2, __m128i f, __m128i inv_f) {
+  __m128i lo1 = _mm_mullo_epi16(c1, inv_f);
+  __m128i hi1 = _mm_mulhi_epu16(c1, inv_f);
+  __m128i lo2 = _mm_mullo_epi16(c2, f);
+  __m128i hi2 = _mm_mulhi_epu16(c2, f);
+
+  __m128i sum_lo =
+    _mm_add_epi32(_mm_srli_epi32(_mm_unpacklo_epi16(lo2, hi2), ZB_POINT_ST_FRAC_BITS),
+                  _mm_srli_epi32(_mm_unpacklo_epi16(lo1, hi1), ZB_POINT_ST_FRAC_BITS));
+  __m128i sum_hi =
+    _mm_add_epi32(_mm_srli_epi32(_mm_unpackhi_epi16(lo2, hi2), ZB_POINT_ST_FRAC_BITS),
+                  _mm_srli_epi32(_mm_unpackhi_epi16(lo1, hi1), ZB_POINT_ST_FRAC_BITS));
+
+  // SSE2 has only a signed 32-to-16-bit pack, so bias the values into
+  // the signed range first, and back out again afterwards.
+  const __m128i bias32 = _mm_set1_epi32(0x8000);
+  __m128i packed = _mm_packs_epi32(_mm_sub_epi32(sum_lo, bias32),
+                                   _mm_sub_epi32(sum_hi, bias32));
+  return _mm_add_epi16(packed, _mm_set1_epi16((short)0x8000));
+}
+
+// Computes BILINEAR_FILTER() on all four components of the four
+// texels, and returns the resulting pixel.
+static inline PIXEL
+bilinear_filter_sse2(PIXEL p1, PIXEL p2, PIXEL p3, PIXEL p4, int sf, int tf) {
+  const __m128i zero = _mm_setzero_si128();
+
+  // Unpacking against zero leaves each 8-bit component shifted up by
+  // 8, as PIXEL_R() and friends return it.
+  __m128i c13 = _mm_unpacklo_epi8(zero, _mm_set_epi32(0, 0, (int)p3, (int)p1));
+  __m128i c24 = _mm_unpacklo_epi8(zero, _mm_set_epi32(0, 0, (int)p4, (int)p2));
+
+  // Filter p1 with p2, and p3 with p4, across s...
+  __m128i h = linear_filter_sse2(c13, c24, _mm_set1_epi16((short)sf),
+                                 _mm_set1_epi16((short)(ZB_ST_FRAC_HIGH - sf)));
+
+  // ...then the two results with each other across t.
+  __m128i v = linear_filter_sse2(h, _mm_unpackhi_epi64(h, h),
+                                 _mm_set1_epi16((short)tf),
+                                 _mm_set1_epi16((short)(ZB_ST_FRAC_HIGH - tf)));
+
+  // RGBA_TO_PIXEL() keeps just the upper byte of each component.
+  v = _mm_srli_epi16(v, 8);
+  return (PIXEL)_mm_cvtsi128_si32(_mm_packus_epi16(v, v));
+}
+
+// An SSE2 implementation of lookup_texture_bilinear().
+PIXEL
+lookup_texture_bilinear_sse2(ZTextureDef *texture_def, int s, int t, unsigned int level, unsigned int level_dx) {
+  PIXEL p1, p2, p3, p4;
+
+  p1 = ZB_LOOKUP_TEXTURE_NEAREST(texture_def, s - ZB_ST_FRAC_HIGH, t - ZB_ST_FRAC_HIGH);
+  p2 = ZB_LOOKUP_TEXTURE_NEAREST(texture_def, s, t - ZB_ST_FRAC_HIGH);
+  p3 = ZB_LOOKUP_TEXTURE_NEAREST(texture_def, s - ZB_ST_FRAC_HIGH, t);
+  p4 = ZB_LOOKUP_TEXTURE_NEAREST(texture_def, s, t);
+
+  return bilinear_filter_sse2(p1, p2, p3, p4,
+                              s & ZB_ST_FRAC_MASK, t & ZB_ST_FRAC_MASK);
+}
+
+// An SSE2 implementation of lookup_texture_mipmap_bilinear().
+PIXEL
+lookup_texture_mipmap_bilinear_sse2(ZTextureDef *texture_def, int s, int t, unsigned int level, unsigned int level_dx) {
+  PIXEL p1, p2, p3, p4;
+
+  p1 = ZB_LOOKUP_TEXTURE_MIPMAP_NEAREST(texture_def, s - ZB_ST_FRAC_HIGH, t - ZB_ST_FRAC_HIGH, level);
+  p2 = ZB_LOOKUP_TEXTURE_MIPMAP_NEAREST(texture_def, s, t - ZB_ST_FRAC_HIGH, level);
+  p3 = ZB_LOOKUP_TEXTURE_MIPMAP_NEAREST(texture_def, s - ZB_ST_FRAC_HIGH, t, level);
+  p4 = ZB_LOOKUP_TEXTURE_MIPMAP_NEAREST(texture_def, s, t, level);
+
+  return bilinear_filter_sse2(p1, p2, p3, p4,
+                              (s >> level) & ZB_ST_FRAC_MASK,
+                              (t >> level) & ZB_ST_FRAC_MASK);
+}
+
+// An SSE2 implementation of lookup_texture_mipmap_trilinear().  Only
+// the two bilinear filters are vectorized; the final blend between
+// levels may need more than 16 bits per product, and is left to the
+// plain C macro.
+PIXEL
+lookup_texture_mipmap_trilinear_sse2(ZTextureDef *texture_def, int s, int t, unsigned int level, unsigned int level_dx) {
+  PIXEL p1a = lookup_texture_mipmap_bilinear_sse2(texture_def, s, t, level, level_dx);
+  level = max((int)level - 1, 0);
+  PIXEL p2a = lookup_texture_mipmap_bilinear_sse2(texture_def, s, t, level, level_dx);
+
+  int r, g, b, a;
+  unsigned int bitsize = level + ZB_POINT_ST_FRAC_BITS;
+  r = LINEAR_FILTER_BITSIZE(PIXEL_R(p2a), PIXEL_R(p1a), level_dx, bitsize);
+  g = LINEAR_FILTER_BITSIZE(PIXEL_G(p2a), PIXEL_G(p1a), level_dx, bitsize);
+  b = LINEAR_FILTER_BITSIZE(PIXEL_B(p2a), PIXEL_B(p1a), level_dx, bitsize);
+  a = LINEAR_FILTER_BITSIZE(PIXEL_A(p2a), PIXEL_A(p1a), level_dx, bitsize);
+
+  return RGBA_TO_PIXEL(r, g, b, a);
+}
+#endif  // ZB_SSE2
+
 
 // Apply the wrap mode to s and t coordinates by calling the generic
 // wrap mode function.
@@ -9,10 +9,46 @@
 #include "pbitops.h"
 #include "srgb_tables.h"
 
+/* Some of the inner loops are also written with SSE2 intrinsics, to
+   handle four pixels at a time, when the compiler targets SSE2.  They
+   are only used while zb_use_simd is nonzero; otherwise (and on other
+   CPU's) the plain C versions are used, which produce identical
+   results. */
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+#define ZB_SSE2
+#include <emmintrin.h>
+#endif
+
 typedef unsigned int ZPOINT;
 #define ZB_Z_BITS 20
 #define ZB_POINT_Z_FRAC_BITS 10  // These must add to < 32.
 
+/* The depth buffer is also summarized in square tiles of
+   ZB_HIZ_TILE_SIZE pixels, so that triangles hidden behind what has
+   already been drawn can be rejected without visiting each pixel.
+   The hiz value of a tile is never greater than any depth value
+   stored within it, unless the tile's hiz_stale flag is set, in which
+   case the value is recomputed before it is next used.  Since the
+   depth test only ever lets depth values grow, a depth-tested write
+   leaves hiz a valid (if pessimistic) bound; only writes that bypass
+   the depth test need to mark tiles stale.  Opaque triangles raise
+   the hiz of the tiles they cover entirely. */
+#define ZB_HIZ_TILE_BITS 3
+#define ZB_HIZ_TILE_SIZE (1 << ZB_HIZ_TILE_BITS)
+
+/* Triangles smaller than this many pixels, counting their bounding
+   box, are not worth testing against the tiles. */
+#define ZB_HIZ_MIN_AREA (ZB_HIZ_TILE_SIZE * ZB_HIZ_TILE_SIZE)
+
+/* Allowance, in depth buffer units, for the difference between a
+   triangle's interpolated depth and the depth of its vertices. */
+#define ZB_HIZ_Z_MARGIN 64
+
+/* The results of ZB_hiz_test(). */
+#define ZB_HIZ_VISIBLE 0
+#define ZB_HIZ_PARTIAL 1
+#define ZB_HIZ_HIDDEN 2
+
 /* The number of fractional bits below the S and T texture coords.
    The more we have, the more precise the texel calculation will be
    when we zoom into small details of a texture; but the greater
@@ -171,6 +207,20 @@ struct ZBuffer {
   int reference_alpha;
   int blend_r, blend_g, blend_b, blend_a;
   ZB_storePixelFunc store_pix_func;
+
+  /* only the rows band_ymin <= y < band_ymax are filled by the
+     triangle functions; see TinyTileRasterizer */
+  int band_ymin, band_ymax;
+
+  /* the coarse depth buffer; see ZB_HIZ_TILE_BITS */
+  ZPOINT *hiz;
+  unsigned char *hiz_stale;
+  int hiz_xsize, hiz_ysize;
+
+  /* the pixels that passed the depth test while an occlusion query was
+     active; see ZB_store_pixel_count_general() */
+  unsigned int occlusion_count;
+  ZB_storePixelFunc occlusion_store_pix_func;
 };
 
 struct ZBufferPoint {
@@ -187,6 +237,47 @@ struct ZBufferPoint {
   PN_stdfloat szb,tzb;
 };
 
+#ifdef ZB_SSE2
+/* Returns the values 0, d, 2d, 3d, to step an interpolated value
+   across four pixels. */
+static inline __m128i
+zb_ramp4(int d) {
+  unsigned int ud = (unsigned int)d;
+  return _mm_set_epi32((int)(ud * 3), (int)(ud * 2), (int)ud, 0);
+}
+
+/* Equivalent to RGBA_TO_PIXEL() on four pixels at once. */
+static inline __m128i
+zb_rgba4_to_pixel(__m128i r, __m128i g, __m128i b, __m128i a) {
+  __m128i pa = _mm_and_si128(_mm_slli_epi32(a, 16), _mm_set1_epi32((int)0xff000000));
+  __m128i pr = _mm_and_si128(_mm_slli_epi32(r, 8), _mm_set1_epi32(0xff0000));
+  __m128i pg = _mm_and_si128(g, _mm_set1_epi32(0xff00));
+  __m128i pb = _mm_srli_epi32(b, 8);
+  return _mm_or_si128(_mm_or_si128(pa, pr), _mm_or_si128(pg, pb));
+}
+
+/* Writes pix and z to each of the four pixels at pp and pz whose
+   current depth value is less than z, as the 'zless' depth test and
+   a plain store would do one pixel at a time. */
+static inline void
+zb_store4_zless(PIXEL *pp, ZPOINT *pz, __m128i pix, __m128i z) {
+  /* There is no unsigned compare in SSE2; flipping the sign bit of
+     both sides gives the same result with a signed compare. */
+  const __m128i sign = _mm_set1_epi32((int)0x80000000);
+  __m128i old_z = _mm_loadu_si128((const __m128i *)pz);
+  __m128i mask = _mm_cmplt_epi32(_mm_xor_si128(old_z, sign),
+                                 _mm_xor_si128(z, sign));
+  if (_mm_movemask_epi8(mask) == 0) {
+    return;
+  }
+  __m128i old_p = _mm_loadu_si128((const __m128i *)pp);
+  _mm_storeu_si128((__m128i *)pz, _mm_or_si128(_mm_and_si128(mask, z),
+                                               _mm_andnot_si128(mask, old_z)));
+  _mm_storeu_si128((__m128i *)pp, _mm_or_si128(_mm_and_si128(mask, pix),
+                                               _mm_andnot_si128(mask, old_p)));
+}
+#endif  /* ZB_SSE2 */
+
 /* zbuffer.c */
 
 #ifdef DO_PSTATS
@@ -211,6 +302,9 @@ extern int pixel_count_smooth_multitex3;
 
 #endif  // DO_PSTATS
 
+extern int zb_use_simd;
+extern int zb_use_hiz;
+
 ZBuffer *ZB_open(int xsize,int ysize,int mode,
                  int nb_colors,
                  unsigned char *color_indexes,
@@ -225,6 +319,34 @@ void ZB_clear(ZBuffer *zb, int clear_z, ZPOINT z, int clear_color, PIXEL color);
 void ZB_clear_viewport(ZBuffer * zb, int clear_z, ZPOINT z, int clear_color, PIXEL color,
                        int xmin, int ymin, int xsize, int ysize);
 
+int ZB_hiz_test(ZBuffer *zb, int xmin, int ymin, int xmax, int ymax, ZPOINT z);
+void ZB_hiz_invalidate(ZBuffer *zb, int xmin, int ymin, int xmax, int ymax);
+void ZB_hiz_raise(ZBuffer *zb, const ZBufferPoint *p0, const ZBufferPoint *p1,
+                  const ZBufferPoint *p2, ZPOINT z);
+
+/* Returns true if the tiles covering pixels xmin through xmax of row y
+   show that no depth value there is less than z.  This does not
+   recompute stale tiles; it is meant to be used only after
+   ZB_hiz_test() has been called on a rectangle enclosing the span. */
+static inline int
+ZB_hiz_span_hidden(const ZBuffer *zb, int xmin, int xmax, int y, ZPOINT z) {
+  const ZPOINT *hiz = zb->hiz + (y >> ZB_HIZ_TILE_BITS) * zb->hiz_xsize;
+  int tx_max = xmax >> ZB_HIZ_TILE_BITS;
+  for (int tx = xmin >> ZB_HIZ_TILE_BITS; tx <= tx_max; ++tx) {
+    if (hiz[tx] < z) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+void ZB_store_pixel_count_off(ZBuffer *zb, PIXEL &result, int r, int g, int b, int a);
+void ZB_store_pixel_count_store(ZBuffer *zb, PIXEL &result, int r, int g, int b, int a);
+void ZB_store_pixel_count_blend(ZBuffer *zb, PIXEL &result, int r, int g, int b, int a);
+void ZB_store_pixel_count_sstore(ZBuffer *zb, PIXEL &result, int r, int g, int b, int a);
+void ZB_store_pixel_count_sblend(ZBuffer *zb, PIXEL &result, int r, int g, int b, int a);
+void ZB_store_pixel_count_general(ZBuffer *zb, PIXEL &result, int r, int g, int b, int a);
+
 PIXEL lookup_texture_nearest(ZTextureDef *texture_def, int s, int t, unsigned int level, unsigned int level_dx);
 PIXEL lookup_texture_bilinear(ZTextureDef *texture_def, int s, int t, unsigned int level, unsigned int level_dx);
 PIXEL lookup_texture_mipmap_nearest(ZTextureDef *texture_def, int s, int t, unsigned int level, unsigned int level_dx);
@@ -232,6 +354,12 @@ PIXEL lookup_texture_mipmap_linear(ZTextureDef *texture_def, int s, int t, unsig
 PIXEL lookup_texture_mipmap_bilinear(ZTextureDef *texture_def, int s, int t, unsigned int level, unsigned int level_dx);
 PIXEL lookup_texture_mipmap_trilinear(ZTextureDef *texture_def, int s, int t, unsigned int level, unsigned int level_dx);
 
+#ifdef ZB_SSE2
+PIXEL lookup_texture_bilinear_sse2(ZTextureDef *texture_def, int s, int t, unsigned int level, unsigned int level_dx);
+PIXEL lookup_texture_mipmap_bilinear_sse2(ZTextureDef *texture_def, int s, int t, unsigned int level, unsigned int level_dx);
+PIXEL lookup_texture_mipmap_trilinear_sse2(ZTextureDef *texture_def, int s, int t, unsigned int level, unsigned int level_dx);
+#endif  /* ZB_SSE2 */
+
 PIXEL apply_wrap_general_minfilter(ZTextureDef *texture_def, int s, int t, unsigned int level, unsigned int level_dx);
 PIXEL apply_wrap_general_magfilter(ZTextureDef *texture_def, int s, int t, unsigned int level, unsigned int level_dx);
 
@@ -132,6 +132,7 @@ typedef struct GLTexture {
 } GLTexture;
 
 struct GLContext;
+class TinyTileRasterizer;
 
 typedef void (*gl_draw_triangle_func)(struct GLContext *c,
                                       GLVertex *p0,GLVertex *p1,GLVertex *p2);
@@ -180,6 +181,10 @@ typedef struct GLContext {
   gl_draw_triangle_func draw_triangle_front,draw_triangle_back;
   ZB_fillTriangleFunc zb_fill_tri;
 
+  /* if not NULL, filled triangles are handed to this object to be
+     rasterized later, in parallel */
+  TinyTileRasterizer *tile_rasterizer;
+
   /* current vertex state */
   V4 current_color;
   V4 current_normal;
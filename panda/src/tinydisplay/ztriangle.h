@@ -10,6 +10,7 @@
   int part, update_left, update_right;
 
   int nb_lines, dx1, dy1, tmp, dx2, dy2;
+  int y;
 
   int error, derror;
   int x1, dxdy_min, dxdy_max;
@@ -18,6 +19,11 @@
 
 #ifdef INTERP_Z
   int z1 = 0, dzdx = 0, dzdy = 0, dzdl_min = 0, dzdl_max = 0;
+  int bb_xmin, bb_xmax, bb_ymin, bb_ymax;
+#endif
+#if defined(INTERP_Z) && defined(ZCMP_LESS)
+  int hiz_ok = 0, hiz_state = ZB_HIZ_VISIBLE;
+  ZPOINT hiz_z = 0, hiz_dz = 0;
 #endif
 #ifdef INTERP_RGB
   int r1 = 0, drdx = 0, drdy = 0, drdl_min = 0, drdl_max = 0;
@@ -95,6 +101,36 @@
   d2 = (PN_stdfloat) (p2->z - p0->z);
   dzdx = (int) (fdy2 * d1 - fdy1 * d2);
   dzdy = (int) (fdx1 * d2 - fdx2 * d1);
+
+  /* the rows and columns this triangle may touch within the band */
+  bb_xmin = min(p0->x, min(p1->x, p2->x));
+  bb_xmax = max(p0->x, max(p1->x, p2->x));
+  bb_ymin = max(p0->y, zb->band_ymin);
+  bb_ymax = min(p2->y, zb->band_ymax - 1);
+#endif
+
+#if defined(INTERP_Z) && defined(ZCMP_LESS)
+  /* If the coarse depth buffer shows the whole triangle to be hidden,
+     we can stop right here.  Its nearest depth allows for the scan
+     straying up to a pixel outside its edges, and for interpolation
+     error; slivers, whose depth slopes are too imprecise for that,
+     and small triangles, which aren't worth the trouble, are not
+     tested at all. */
+  if (zb_use_hiz && bb_ymin <= bb_ymax &&
+      (p0->z | p1->z | p2->z) >= 0) {
+    PN_stdfloat bb_area = (PN_stdfloat)((bb_xmax - bb_xmin + 1) * (p2->y - p0->y + 1));
+    if (bb_area >= ZB_HIZ_MIN_AREA &&
+        bb_area * fz <= 16.0f && bb_area * fz >= -16.0f) {
+      hiz_ok = 1;
+      hiz_dz = ((ZPOINT)abs(dzdx) >> ZB_POINT_Z_FRAC_BITS) +
+        ((ZPOINT)abs(dzdy) >> ZB_POINT_Z_FRAC_BITS) + ZB_HIZ_Z_MARGIN;
+      hiz_z = ((ZPOINT)max(p0->z, max(p1->z, p2->z)) >> ZB_POINT_Z_FRAC_BITS) + hiz_dz;
+      hiz_state = ZB_hiz_test(zb, bb_xmin, bb_ymin, bb_xmax, bb_ymax, hiz_z);
+      if (hiz_state == ZB_HIZ_HIDDEN) {
+        return;
+      }
+    }
+  }
 #endif
 
 #ifdef INTERP_RGB
@@ -216,6 +252,7 @@
 
   DRAW_INIT();
 
+  y = p0->y;
   for(part=0;part<2;part++) {
     if (part == 0) {
       if (fz > 0) {
@@ -341,6 +378,15 @@
 
     while (nb_lines>0) {
       nb_lines--;
+      /* rows outside the current band still step the edges, but
+         are not filled */
+      if (y >= zb->band_ymin && y < zb->band_ymax
+#if defined(INTERP_Z) && defined(ZCMP_LESS)
+          /* a partly hidden triangle may still skip whole rows */
+          && (hiz_state != ZB_HIZ_PARTIAL ||
+              !ZB_hiz_span_hidden(zb, x1, x2 >> 16, y, hiz_z))
+#endif
+          )
 #ifndef DRAW_LINE
       /* generic draw line */
       {
@@ -395,10 +441,17 @@
         tzb=tzb1;
 #endif
         while (n>=3) {
-          PUT_PIXEL(0);
-          PUT_PIXEL(1);
-          PUT_PIXEL(2);
-          PUT_PIXEL(3);
+#ifdef PUT_PIXEL4
+          if (zb_use_simd) {
+            PUT_PIXEL4();
+          } else
+#endif
+          {
+            PUT_PIXEL(0);
+            PUT_PIXEL(1);
+            PUT_PIXEL(2);
+            PUT_PIXEL(3);
+          }
 #ifdef INTERP_Z
           pz+=4;
 #endif
@@ -483,8 +536,25 @@
       /* screen coordinates */
       pp1=(PIXEL *)((char *)pp1 + zb->linesize);
       pz1+=zb->xsize;
+      y++;
     }
   }
+
+#if defined(INTERP_Z) && defined(STORES_Z)
+#if defined(ZCMP_LESS) && defined(ACMP_NONE)
+  /* every pixel of the tiles entirely within the triangle is now at
+     least as near as the triangle's farthest point */
+  if (hiz_ok) {
+    ZPOINT zmin = (ZPOINT)min(p0->z, min(p1->z, p2->z)) >> ZB_POINT_Z_FRAC_BITS;
+    if (zmin > hiz_dz) {
+      ZB_hiz_raise(zb, p0, p1, p2, zmin - hiz_dz);
+    }
+  }
+#elif !defined(ZCMP_LESS)
+  /* without the depth test, depth values may have been lowered */
+  ZB_hiz_invalidate(zb, bb_xmin, bb_ymin, bb_xmax, bb_ymax);
+#endif
+#endif
 }
 
 #undef INTERP_Z
@@ -499,4 +569,6 @@
 #undef DRAW_INIT
 #undef DRAW_LINE  
 #undef PUT_PIXEL
+#undef DRAW_INIT4
+#undef PUT_PIXEL4
 #undef PIXEL_COUNT
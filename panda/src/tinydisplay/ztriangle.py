@@ -54,9 +54,14 @@ for i in range(len(ExtraOptions[0])):
 
 FullOptions = Options + ExtraOptions
 
+# The leading Options for which ztriangle_two.h may fill four pixels
+# at a time with SSE2: an opaque, depth-tested, depth-writing store,
+# the most common case by far.
+SimdOptions = [ 'zon', 'cstore', 'anone', 'zless' ]
+
 CodeTable = {
     # depth write
-    'zon' : '#define STORE_Z(zpix, z) (zpix) = (z)',
+    'zon' : '#define STORE_Z(zpix, z) (zpix) = (z)\n#define STORES_Z',
     'zoff' : '#define STORE_Z(zpix, z)',
 
     # color write
@@ -70,13 +75,13 @@ CodeTable = {
     'csblend' : '#define STORE_PIX(pix, rgb, r, g, b, a) (pix) = PIXEL_BLEND_SRGB(pix, r, g, b, a)',
 
     # alpha test
-    'anone' : '#define ACMP(zb, a) 1',
+    'anone' : '#define ACMP(zb, a) 1\n#define ACMP_NONE',
     'aless' : '#define ACMP(zb, a) (((int)(a)) < (zb)->reference_alpha)',
     'amore' : '#define ACMP(zb, a) (((int)(a)) > (zb)->reference_alpha)',
 
     # depth test
     'znone' : '#define ZCMP(zpix, z) 1',
-    'zless' : '#define ZCMP(zpix, z) ((ZPOINT)(zpix) < (ZPOINT)(z))',
+    'zless' : '#define ZCMP(zpix, z) ((ZPOINT)(zpix) < (ZPOINT)(z))\n#define ZCMP_LESS',
 
     # texture filters
     'tnearest' : '#define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)\n#define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ZB_LOOKUP_TEXTURE_NEAREST(texture_def, s, t)',
@@ -187,10 +192,17 @@ try:
     while True:
         openCode(count)
 
+        keywordList = []
         for i in range(len(ops)):
             keyword = Options[i][ops[i]]
+            keywordList.append(keyword)
             print >> code, CodeTable[keyword]
 
+        if keywordList[:4] == SimdOptions:
+            # This combination also gets the four-pixel SSE2 inner
+            # loops defined in ztriangle_two.h.
+            print >> code, '#define ZB_SIMD_OPAQUE'
+
         # This reference gets just the initial fname: omitting the
         # ExtraOptions, which are implicit in ztriangle_two.h.
         fname = getFname(ops)
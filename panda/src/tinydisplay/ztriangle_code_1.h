@@ -1,8 +1,10 @@
 /* This file is generated code--do not edit.  See ztriangle.py. */
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = (rgb)
 #define ACMP(zb, a) 1
+#define ACMP_NONE
 #define ZCMP(zpix, z) 1
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ZB_LOOKUP_TEXTURE_NEAREST(texture_def, s, t)
@@ -10,8 +12,10 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = (rgb)
 #define ACMP(zb, a) 1
+#define ACMP_NONE
 #define ZCMP(zpix, z) 1
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx) DO_CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define INTERP_MIPMAP
@@ -20,8 +24,10 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = (rgb)
 #define ACMP(zb, a) 1
+#define ACMP_NONE
 #define ZCMP(zpix, z) 1
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx) DO_CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define INTERP_MIPMAP
@@ -30,35 +36,48 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = (rgb)
 #define ACMP(zb, a) 1
+#define ACMP_NONE
 #define ZCMP(zpix, z) ((ZPOINT)(zpix) < (ZPOINT)(z))
+#define ZCMP_LESS
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ZB_LOOKUP_TEXTURE_NEAREST(texture_def, s, t)
+#define ZB_SIMD_OPAQUE
 #define FNAME(name) FB_triangle_zon_cstore_anone_zless_tnearest_ ## name
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = (rgb)
 #define ACMP(zb, a) 1
+#define ACMP_NONE
 #define ZCMP(zpix, z) ((ZPOINT)(zpix) < (ZPOINT)(z))
+#define ZCMP_LESS
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx) DO_CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define INTERP_MIPMAP
 #define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ZB_LOOKUP_TEXTURE_MIPMAP_NEAREST(texture_def, s, t, level)
+#define ZB_SIMD_OPAQUE
 #define FNAME(name) FB_triangle_zon_cstore_anone_zless_tmipmap_ ## name
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = (rgb)
 #define ACMP(zb, a) 1
+#define ACMP_NONE
 #define ZCMP(zpix, z) ((ZPOINT)(zpix) < (ZPOINT)(z))
+#define ZCMP_LESS
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx) DO_CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define INTERP_MIPMAP
 #define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ((level == 0) ? (texture_def)->tex_magfilter_func(texture_def, s, t, level, level_dx) : (texture_def)->tex_minfilter_func(texture_def, s, t, level, level_dx))
+#define ZB_SIMD_OPAQUE
 #define FNAME(name) FB_triangle_zon_cstore_anone_zless_tgeneral_ ## name
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = (rgb)
 #define ACMP(zb, a) (((int)(a)) < (zb)->reference_alpha)
 #define ZCMP(zpix, z) 1
@@ -68,6 +87,7 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = (rgb)
 #define ACMP(zb, a) (((int)(a)) < (zb)->reference_alpha)
 #define ZCMP(zpix, z) 1
@@ -78,6 +98,7 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = (rgb)
 #define ACMP(zb, a) (((int)(a)) < (zb)->reference_alpha)
 #define ZCMP(zpix, z) 1
@@ -88,18 +109,22 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = (rgb)
 #define ACMP(zb, a) (((int)(a)) < (zb)->reference_alpha)
 #define ZCMP(zpix, z) ((ZPOINT)(zpix) < (ZPOINT)(z))
+#define ZCMP_LESS
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ZB_LOOKUP_TEXTURE_NEAREST(texture_def, s, t)
 #define FNAME(name) FB_triangle_zon_cstore_aless_zless_tnearest_ ## name
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = (rgb)
 #define ACMP(zb, a) (((int)(a)) < (zb)->reference_alpha)
 #define ZCMP(zpix, z) ((ZPOINT)(zpix) < (ZPOINT)(z))
+#define ZCMP_LESS
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx) DO_CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define INTERP_MIPMAP
 #define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ZB_LOOKUP_TEXTURE_MIPMAP_NEAREST(texture_def, s, t, level)
@@ -107,9 +132,11 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = (rgb)
 #define ACMP(zb, a) (((int)(a)) < (zb)->reference_alpha)
 #define ZCMP(zpix, z) ((ZPOINT)(zpix) < (ZPOINT)(z))
+#define ZCMP_LESS
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx) DO_CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define INTERP_MIPMAP
 #define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ((level == 0) ? (texture_def)->tex_magfilter_func(texture_def, s, t, level, level_dx) : (texture_def)->tex_minfilter_func(texture_def, s, t, level, level_dx))
@@ -117,6 +144,7 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = (rgb)
 #define ACMP(zb, a) (((int)(a)) > (zb)->reference_alpha)
 #define ZCMP(zpix, z) 1
@@ -126,6 +154,7 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = (rgb)
 #define ACMP(zb, a) (((int)(a)) > (zb)->reference_alpha)
 #define ZCMP(zpix, z) 1
@@ -136,6 +165,7 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = (rgb)
 #define ACMP(zb, a) (((int)(a)) > (zb)->reference_alpha)
 #define ZCMP(zpix, z) 1
@@ -146,18 +176,22 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = (rgb)
 #define ACMP(zb, a) (((int)(a)) > (zb)->reference_alpha)
 #define ZCMP(zpix, z) ((ZPOINT)(zpix) < (ZPOINT)(z))
+#define ZCMP_LESS
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ZB_LOOKUP_TEXTURE_NEAREST(texture_def, s, t)
 #define FNAME(name) FB_triangle_zon_cstore_amore_zless_tnearest_ ## name
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = (rgb)
 #define ACMP(zb, a) (((int)(a)) > (zb)->reference_alpha)
 #define ZCMP(zpix, z) ((ZPOINT)(zpix) < (ZPOINT)(z))
+#define ZCMP_LESS
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx) DO_CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define INTERP_MIPMAP
 #define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ZB_LOOKUP_TEXTURE_MIPMAP_NEAREST(texture_def, s, t, level)
@@ -165,9 +199,11 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = (rgb)
 #define ACMP(zb, a) (((int)(a)) > (zb)->reference_alpha)
 #define ZCMP(zpix, z) ((ZPOINT)(zpix) < (ZPOINT)(z))
+#define ZCMP_LESS
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx) DO_CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define INTERP_MIPMAP
 #define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ((level == 0) ? (texture_def)->tex_magfilter_func(texture_def, s, t, level, level_dx) : (texture_def)->tex_minfilter_func(texture_def, s, t, level, level_dx))
@@ -175,8 +211,10 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = PIXEL_BLEND_RGB(pix, r, g, b, a)
 #define ACMP(zb, a) 1
+#define ACMP_NONE
 #define ZCMP(zpix, z) 1
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ZB_LOOKUP_TEXTURE_NEAREST(texture_def, s, t)
@@ -184,8 +222,10 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = PIXEL_BLEND_RGB(pix, r, g, b, a)
 #define ACMP(zb, a) 1
+#define ACMP_NONE
 #define ZCMP(zpix, z) 1
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx) DO_CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define INTERP_MIPMAP
@@ -194,8 +234,10 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = PIXEL_BLEND_RGB(pix, r, g, b, a)
 #define ACMP(zb, a) 1
+#define ACMP_NONE
 #define ZCMP(zpix, z) 1
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx) DO_CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define INTERP_MIPMAP
@@ -204,18 +246,24 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = PIXEL_BLEND_RGB(pix, r, g, b, a)
 #define ACMP(zb, a) 1
+#define ACMP_NONE
 #define ZCMP(zpix, z) ((ZPOINT)(zpix) < (ZPOINT)(z))
+#define ZCMP_LESS
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ZB_LOOKUP_TEXTURE_NEAREST(texture_def, s, t)
 #define FNAME(name) FB_triangle_zon_cblend_anone_zless_tnearest_ ## name
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = PIXEL_BLEND_RGB(pix, r, g, b, a)
 #define ACMP(zb, a) 1
+#define ACMP_NONE
 #define ZCMP(zpix, z) ((ZPOINT)(zpix) < (ZPOINT)(z))
+#define ZCMP_LESS
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx) DO_CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define INTERP_MIPMAP
 #define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ZB_LOOKUP_TEXTURE_MIPMAP_NEAREST(texture_def, s, t, level)
@@ -223,9 +271,12 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = PIXEL_BLEND_RGB(pix, r, g, b, a)
 #define ACMP(zb, a) 1
+#define ACMP_NONE
 #define ZCMP(zpix, z) ((ZPOINT)(zpix) < (ZPOINT)(z))
+#define ZCMP_LESS
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx) DO_CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define INTERP_MIPMAP
 #define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ((level == 0) ? (texture_def)->tex_magfilter_func(texture_def, s, t, level, level_dx) : (texture_def)->tex_minfilter_func(texture_def, s, t, level, level_dx))
@@ -233,6 +284,7 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = PIXEL_BLEND_RGB(pix, r, g, b, a)
 #define ACMP(zb, a) (((int)(a)) < (zb)->reference_alpha)
 #define ZCMP(zpix, z) 1
@@ -242,6 +294,7 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = PIXEL_BLEND_RGB(pix, r, g, b, a)
 #define ACMP(zb, a) (((int)(a)) < (zb)->reference_alpha)
 #define ZCMP(zpix, z) 1
@@ -252,6 +305,7 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = PIXEL_BLEND_RGB(pix, r, g, b, a)
 #define ACMP(zb, a) (((int)(a)) < (zb)->reference_alpha)
 #define ZCMP(zpix, z) 1
@@ -262,18 +316,22 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = PIXEL_BLEND_RGB(pix, r, g, b, a)
 #define ACMP(zb, a) (((int)(a)) < (zb)->reference_alpha)
 #define ZCMP(zpix, z) ((ZPOINT)(zpix) < (ZPOINT)(z))
+#define ZCMP_LESS
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ZB_LOOKUP_TEXTURE_NEAREST(texture_def, s, t)
 #define FNAME(name) FB_triangle_zon_cblend_aless_zless_tnearest_ ## name
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = PIXEL_BLEND_RGB(pix, r, g, b, a)
 #define ACMP(zb, a) (((int)(a)) < (zb)->reference_alpha)
 #define ZCMP(zpix, z) ((ZPOINT)(zpix) < (ZPOINT)(z))
+#define ZCMP_LESS
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx) DO_CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define INTERP_MIPMAP
 #define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ZB_LOOKUP_TEXTURE_MIPMAP_NEAREST(texture_def, s, t, level)
@@ -281,9 +339,11 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = PIXEL_BLEND_RGB(pix, r, g, b, a)
 #define ACMP(zb, a) (((int)(a)) < (zb)->reference_alpha)
 #define ZCMP(zpix, z) ((ZPOINT)(zpix) < (ZPOINT)(z))
+#define ZCMP_LESS
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx) DO_CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define INTERP_MIPMAP
 #define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ((level == 0) ? (texture_def)->tex_magfilter_func(texture_def, s, t, level, level_dx) : (texture_def)->tex_minfilter_func(texture_def, s, t, level, level_dx))
@@ -291,6 +351,7 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = PIXEL_BLEND_RGB(pix, r, g, b, a)
 #define ACMP(zb, a) (((int)(a)) > (zb)->reference_alpha)
 #define ZCMP(zpix, z) 1
@@ -300,6 +361,7 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = PIXEL_BLEND_RGB(pix, r, g, b, a)
 #define ACMP(zb, a) (((int)(a)) > (zb)->reference_alpha)
 #define ZCMP(zpix, z) 1
@@ -310,6 +372,7 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = PIXEL_BLEND_RGB(pix, r, g, b, a)
 #define ACMP(zb, a) (((int)(a)) > (zb)->reference_alpha)
 #define ZCMP(zpix, z) 1
@@ -320,18 +383,22 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = PIXEL_BLEND_RGB(pix, r, g, b, a)
 #define ACMP(zb, a) (((int)(a)) > (zb)->reference_alpha)
 #define ZCMP(zpix, z) ((ZPOINT)(zpix) < (ZPOINT)(z))
+#define ZCMP_LESS
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ZB_LOOKUP_TEXTURE_NEAREST(texture_def, s, t)
 #define FNAME(name) FB_triangle_zon_cblend_amore_zless_tnearest_ ## name
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = PIXEL_BLEND_RGB(pix, r, g, b, a)
 #define ACMP(zb, a) (((int)(a)) > (zb)->reference_alpha)
 #define ZCMP(zpix, z) ((ZPOINT)(zpix) < (ZPOINT)(z))
+#define ZCMP_LESS
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx) DO_CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define INTERP_MIPMAP
 #define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ZB_LOOKUP_TEXTURE_MIPMAP_NEAREST(texture_def, s, t, level)
@@ -339,9 +406,11 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) (pix) = PIXEL_BLEND_RGB(pix, r, g, b, a)
 #define ACMP(zb, a) (((int)(a)) > (zb)->reference_alpha)
 #define ZCMP(zpix, z) ((ZPOINT)(zpix) < (ZPOINT)(z))
+#define ZCMP_LESS
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx) DO_CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define INTERP_MIPMAP
 #define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ((level == 0) ? (texture_def)->tex_magfilter_func(texture_def, s, t, level, level_dx) : (texture_def)->tex_minfilter_func(texture_def, s, t, level, level_dx))
@@ -349,8 +418,10 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) zb->store_pix_func(zb, pix, r, g, b, a)
 #define ACMP(zb, a) 1
+#define ACMP_NONE
 #define ZCMP(zpix, z) 1
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ZB_LOOKUP_TEXTURE_NEAREST(texture_def, s, t)
@@ -358,8 +429,10 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) zb->store_pix_func(zb, pix, r, g, b, a)
 #define ACMP(zb, a) 1
+#define ACMP_NONE
 #define ZCMP(zpix, z) 1
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx) DO_CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define INTERP_MIPMAP
@@ -368,8 +441,10 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) zb->store_pix_func(zb, pix, r, g, b, a)
 #define ACMP(zb, a) 1
+#define ACMP_NONE
 #define ZCMP(zpix, z) 1
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx) DO_CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define INTERP_MIPMAP
@@ -378,18 +453,24 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) zb->store_pix_func(zb, pix, r, g, b, a)
 #define ACMP(zb, a) 1
+#define ACMP_NONE
 #define ZCMP(zpix, z) ((ZPOINT)(zpix) < (ZPOINT)(z))
+#define ZCMP_LESS
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ZB_LOOKUP_TEXTURE_NEAREST(texture_def, s, t)
 #define FNAME(name) FB_triangle_zon_cgeneral_anone_zless_tnearest_ ## name
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) zb->store_pix_func(zb, pix, r, g, b, a)
 #define ACMP(zb, a) 1
+#define ACMP_NONE
 #define ZCMP(zpix, z) ((ZPOINT)(zpix) < (ZPOINT)(z))
+#define ZCMP_LESS
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx) DO_CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define INTERP_MIPMAP
 #define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ZB_LOOKUP_TEXTURE_MIPMAP_NEAREST(texture_def, s, t, level)
@@ -397,9 +478,12 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) zb->store_pix_func(zb, pix, r, g, b, a)
 #define ACMP(zb, a) 1
+#define ACMP_NONE
 #define ZCMP(zpix, z) ((ZPOINT)(zpix) < (ZPOINT)(z))
+#define ZCMP_LESS
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx) DO_CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define INTERP_MIPMAP
 #define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ((level == 0) ? (texture_def)->tex_magfilter_func(texture_def, s, t, level, level_dx) : (texture_def)->tex_minfilter_func(texture_def, s, t, level, level_dx))
@@ -407,6 +491,7 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) zb->store_pix_func(zb, pix, r, g, b, a)
 #define ACMP(zb, a) (((int)(a)) < (zb)->reference_alpha)
 #define ZCMP(zpix, z) 1
@@ -416,6 +501,7 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) zb->store_pix_func(zb, pix, r, g, b, a)
 #define ACMP(zb, a) (((int)(a)) < (zb)->reference_alpha)
 #define ZCMP(zpix, z) 1
@@ -426,6 +512,7 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) zb->store_pix_func(zb, pix, r, g, b, a)
 #define ACMP(zb, a) (((int)(a)) < (zb)->reference_alpha)
 #define ZCMP(zpix, z) 1
@@ -436,18 +523,22 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) zb->store_pix_func(zb, pix, r, g, b, a)
 #define ACMP(zb, a) (((int)(a)) < (zb)->reference_alpha)
 #define ZCMP(zpix, z) ((ZPOINT)(zpix) < (ZPOINT)(z))
+#define ZCMP_LESS
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ZB_LOOKUP_TEXTURE_NEAREST(texture_def, s, t)
 #define FNAME(name) FB_triangle_zon_cgeneral_aless_zless_tnearest_ ## name
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) zb->store_pix_func(zb, pix, r, g, b, a)
 #define ACMP(zb, a) (((int)(a)) < (zb)->reference_alpha)
 #define ZCMP(zpix, z) ((ZPOINT)(zpix) < (ZPOINT)(z))
+#define ZCMP_LESS
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx) DO_CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define INTERP_MIPMAP
 #define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ZB_LOOKUP_TEXTURE_MIPMAP_NEAREST(texture_def, s, t, level)
@@ -455,9 +546,11 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) zb->store_pix_func(zb, pix, r, g, b, a)
 #define ACMP(zb, a) (((int)(a)) < (zb)->reference_alpha)
 #define ZCMP(zpix, z) ((ZPOINT)(zpix) < (ZPOINT)(z))
+#define ZCMP_LESS
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx) DO_CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define INTERP_MIPMAP
 #define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ((level == 0) ? (texture_def)->tex_magfilter_func(texture_def, s, t, level, level_dx) : (texture_def)->tex_minfilter_func(texture_def, s, t, level, level_dx))
@@ -465,6 +558,7 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) zb->store_pix_func(zb, pix, r, g, b, a)
 #define ACMP(zb, a) (((int)(a)) > (zb)->reference_alpha)
 #define ZCMP(zpix, z) 1
@@ -474,6 +568,7 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) zb->store_pix_func(zb, pix, r, g, b, a)
 #define ACMP(zb, a) (((int)(a)) > (zb)->reference_alpha)
 #define ZCMP(zpix, z) 1
@@ -484,6 +579,7 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) zb->store_pix_func(zb, pix, r, g, b, a)
 #define ACMP(zb, a) (((int)(a)) > (zb)->reference_alpha)
 #define ZCMP(zpix, z) 1
@@ -494,18 +590,22 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) zb->store_pix_func(zb, pix, r, g, b, a)
 #define ACMP(zb, a) (((int)(a)) > (zb)->reference_alpha)
 #define ZCMP(zpix, z) ((ZPOINT)(zpix) < (ZPOINT)(z))
+#define ZCMP_LESS
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ZB_LOOKUP_TEXTURE_NEAREST(texture_def, s, t)
 #define FNAME(name) FB_triangle_zon_cgeneral_amore_zless_tnearest_ ## name
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) zb->store_pix_func(zb, pix, r, g, b, a)
 #define ACMP(zb, a) (((int)(a)) > (zb)->reference_alpha)
 #define ZCMP(zpix, z) ((ZPOINT)(zpix) < (ZPOINT)(z))
+#define ZCMP_LESS
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx) DO_CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define INTERP_MIPMAP
 #define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ZB_LOOKUP_TEXTURE_MIPMAP_NEAREST(texture_def, s, t, level)
@@ -513,9 +613,11 @@
 #include "ztriangle_two.h"
 
 #define STORE_Z(zpix, z) (zpix) = (z)
+#define STORES_Z
 #define STORE_PIX(pix, rgb, r, g, b, a) zb->store_pix_func(zb, pix, r, g, b, a)
 #define ACMP(zb, a) (((int)(a)) > (zb)->reference_alpha)
 #define ZCMP(zpix, z) ((ZPOINT)(zpix) < (ZPOINT)(z))
+#define ZCMP_LESS
 #define CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx) DO_CALC_MIPMAP_LEVEL(mipmap_level, mipmap_dx, dsdx, dtdx)
 #define INTERP_MIPMAP
 #define ZB_LOOKUP_TEXTURE(texture_def, s, t, level, level_dx) ((level == 0) ? (texture_def)->tex_magfilter_func(texture_def, s, t, level, level_dx) : (texture_def)->tex_minfilter_func(texture_def, s, t, level, level_dx))
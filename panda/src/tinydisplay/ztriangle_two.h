@@ -1,7 +1,35 @@
+/* When the generated code selects an opaque, depth-tested store (see
+   ztriangle.py), the untextured functions below also define
+   PUT_PIXEL4(), which ztriangle.h uses to fill four pixels at a time
+   with SSE2 while zb_use_simd is set.  DRAW_INIT4() prepares the
+   per-triangle steps it needs. */
+#if defined(ZB_SSE2) && defined(ZB_SIMD_OPAQUE)
+#define ZB_SIMD_SPANS
+#endif
+
 static void
 FNAME(white_untextured) (ZBuffer *zb,
                          ZBufferPoint *p0,ZBufferPoint *p1,ZBufferPoint *p2)
 {
+#ifdef ZB_SIMD_SPANS
+  __m128i dz4;
+
+#define DRAW_INIT4()                            \
+  {                                             \
+    dz4 = zb_ramp4(dzdx);                       \
+  }
+
+#define PUT_PIXEL4()                                                    \
+  {                                                                     \
+    __m128i zz4 = _mm_srli_epi32(_mm_add_epi32(_mm_set1_epi32((int)z), dz4), \
+                                 ZB_POINT_Z_FRAC_BITS);                 \
+    zb_store4_zless(pp, pz, _mm_set1_epi32((int)0xffffffffUL), zz4);   \
+    z+=4*(unsigned int)dzdx;                                            \
+  }
+#else
+#define DRAW_INIT4()
+#endif  /* ZB_SIMD_SPANS */
+
 #define INTERP_Z
 
 #define EARLY_OUT()                             \
@@ -10,6 +38,7 @@ FNAME(white_untextured) (ZBuffer *zb,
 
 #define DRAW_INIT()                             \
   {                                             \
+    DRAW_INIT4();                               \
   }
  
 #define PUT_PIXEL(_a)                                                   \
@@ -34,6 +63,26 @@ FNAME(flat_untextured) (ZBuffer *zb,
   int color;
   int or0, og0, ob0, oa0;
 
+#ifdef ZB_SIMD_SPANS
+  __m128i dz4, color4;
+
+#define DRAW_INIT4()                            \
+  {                                             \
+    dz4 = zb_ramp4(dzdx);                       \
+    color4 = _mm_set1_epi32(color);             \
+  }
+
+#define PUT_PIXEL4()                                                    \
+  {                                                                     \
+    __m128i zz4 = _mm_srli_epi32(_mm_add_epi32(_mm_set1_epi32((int)z), dz4), \
+                                 ZB_POINT_Z_FRAC_BITS);                 \
+    zb_store4_zless(pp, pz, color4, zz4);                               \
+    z+=4*(unsigned int)dzdx;                                            \
+  }
+#else
+#define DRAW_INIT4()
+#endif  /* ZB_SIMD_SPANS */
+
 #define INTERP_Z
 
 #define EARLY_OUT()                             \
@@ -50,6 +99,7 @@ FNAME(flat_untextured) (ZBuffer *zb,
     ob0 = p2->b;                                \
     oa0 = p2->a;                                \
     color=RGBA_TO_PIXEL(or0, og0, ob0, oa0);    \
+    DRAW_INIT4();                               \
   }
  
 #define PUT_PIXEL(_a)                                   \
@@ -76,6 +126,38 @@ static void
 FNAME(smooth_untextured) (ZBuffer *zb,
                           ZBufferPoint *p0,ZBufferPoint *p1,ZBufferPoint *p2)
 {
+#ifdef ZB_SIMD_SPANS
+  __m128i dz4, dr4, dg4, db4, da4;
+
+#define DRAW_INIT4()                            \
+  {                                             \
+    dz4 = zb_ramp4(dzdx);                       \
+    dr4 = zb_ramp4(drdx);                       \
+    dg4 = zb_ramp4(dgdx);                       \
+    db4 = zb_ramp4(dbdx);                       \
+    da4 = zb_ramp4(dadx);                       \
+  }
+
+#define PUT_PIXEL4()                                                    \
+  {                                                                     \
+    __m128i zz4 = _mm_srli_epi32(_mm_add_epi32(_mm_set1_epi32((int)z), dz4), \
+                                 ZB_POINT_Z_FRAC_BITS);                 \
+    __m128i pix4 =                                                      \
+      zb_rgba4_to_pixel(_mm_add_epi32(_mm_set1_epi32((int)or1), dr4),   \
+                        _mm_add_epi32(_mm_set1_epi32((int)og1), dg4),   \
+                        _mm_add_epi32(_mm_set1_epi32((int)ob1), db4),   \
+                        _mm_add_epi32(_mm_set1_epi32((int)oa1), da4));  \
+    zb_store4_zless(pp, pz, pix4, zz4);                                 \
+    z+=4*(unsigned int)dzdx;                                            \
+    og1+=4*(unsigned int)dgdx;                                          \
+    or1+=4*(unsigned int)drdx;                                          \
+    ob1+=4*(unsigned int)dbdx;                                          \
+    oa1+=4*(unsigned int)dadx;                                          \
+  }
+#else
+#define DRAW_INIT4()
+#endif  /* ZB_SIMD_SPANS */
+
 #define INTERP_Z
 #define INTERP_RGB
 
@@ -94,6 +176,7 @@ FNAME(smooth_untextured) (ZBuffer *zb,
   
 #define DRAW_INIT()                             \
   {                                             \
+    DRAW_INIT4();                               \
   }
 
 #define PUT_PIXEL(_a)                                                   \
@@ -1001,10 +1084,16 @@ FNAME(smooth_multitex3) (ZBuffer *zb,
 }
 
 #undef ACMP
+#undef ACMP_NONE
 #undef ZCMP
 #undef STORE_PIX
 #undef STORE_Z
+#undef STORES_Z
+#undef ZCMP_LESS
 #undef FNAME
 #undef INTERP_MIPMAP
 #undef CALC_MIPMAP_LEVEL
 #undef ZB_LOOKUP_TEXTURE
+
+#undef ZB_SIMD_SPANS
+#undef ZB_SIMD_OPAQUE
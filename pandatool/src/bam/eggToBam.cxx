@@ -109,6 +109,18 @@ EggToBam() :
      "written exactly as they are, losslessly.",
      &EggToBam::dispatch_none, &_compression_off);
 
+  add_option
+    ("qa", "tolerance", 0,
+     "Store the joint animation tables in compressed form, which uses much "
+     "less memory once the bam file is loaded.  Tables that never change "
+     "are collapsed to a single value, and the rest are reduced to "
+     "quantized keyframes, such that no component of any joint differs "
+     "from the original by more than the indicated tolerance.  Rotations "
+     "are measured in degrees.  This is independent of -C, which affects "
+     "only the size of the bam file itself, and does not apply to the "
+     "compressed tables.",
+     &EggToBam::dispatch_double, &_has_quantize_anim, &_quantize_anim_tolerance);
+
   add_option
     ("rawtex", "", 0,
      "Record texture data directly in the bam file, instead of storing "
@@ -249,6 +261,13 @@ run() {
     compress_chan_quality = _compression_quality;
   }
 
+  if (_has_quantize_anim) {
+    // If the user specified -qa, have the egg loader compress the
+    // animation tables as it builds them.
+    egg_quantize_anim = true;
+    egg_quantize_anim_tolerance = _quantize_anim_tolerance;
+  }
+
   if (_ctex_quality != "default") {
     // Override the user's config file with the command-line parameter
     // for texture compression.